@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef AUDIO_CONVERT_H
+#define AUDIO_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio/tizen_audio_test.h"
+#include "common/test_pattern.h"
+
+#define AUDIO_CONVERT_BENCH_MS 500         // Minimum timed run per benchmark
+#define AUDIO_RESAMPLE_TAPS 32             // Filter taps per phase, a multiple of 8
+#define AUDIO_RESAMPLE_MAX_PHASES 1024     // Finest rate ratio, after reducing by the GCD
+#define AUDIO_RESAMPLE_BLOCK 1024          // Input frames filtered per pass
+#define AUDIO_RESAMPLE_MAX_THDN_DB -80.0   // Worse than this fails
+
+// Sample-format conversion, through left-justified 32-bit samples
+typedef struct {
+    audio_format_t from;
+    audio_format_t to;
+    uint32_t channels;
+    uint64_t samples;              // Converted in the timed run
+    double msamples_per_sec;
+    double max_error_lsb;          // Round trip, in LSBs of the narrower format
+    pattern_isa_t isa;
+} audio_convert_stats_t;
+
+// Polyphase resampling of a multichannel tone
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t channels;
+    uint32_t phases;               // Interpolation factor after reducing the ratio
+    uint32_t taps;
+    uint64_t frames;               // Input frames in the timed run
+    double mframes_per_sec;        // Input frames, including conversion to and from config->format
+    double realtime_factor;        // Multiples of in_rate one CPU sustains
+    double thd_n_db;               // Worst channel
+    pattern_isa_t isa;
+} audio_resample_stats_t;
+
+// Streaming resampler for interleaved float frames. Filter state carries
+// over between calls; the output lags the input by taps / 2 input frames.
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t channels;
+    uint32_t phases;               // L: output rate / GCD
+    uint32_t step;                 // M: input rate / GCD
+    uint32_t taps;
+    float *coefs;                  // phases x taps, reversed for a forward dot product
+    float *work;                   // Per channel: taps - 1 frames of history, then a block
+    uint32_t *out_index;           // Window start and phase of each output in a block
+    uint32_t *out_phase;
+    uint32_t phase;                // Next output's phase
+    uint32_t position;             // Next output's input index, from the next block's start
+} audio_resampler_t;
+
+// PCM layouts are interleaved. S24 is three packed bytes, as in
+// audio_buffer_t; the ALSA stream engine carries S24_LE in 32-bit
+// containers itself.
+bool audio_format_is_pcm(audio_format_t format);
+uint32_t audio_format_sample_size(audio_format_t format);
+uint32_t audio_format_bits(audio_format_t format);
+
+// count samples (frames x channels). Narrowing rounds to nearest and
+// saturates; widening is exact.
+bool audio_samples_to_s32(const void *src, audio_format_t format, int32_t *dst, size_t count);
+bool audio_samples_from_s32(const int32_t *src, void *dst, audio_format_t format, size_t count);
+bool audio_convert_samples(const void *src, audio_format_t src_format, void *dst, audio_format_t dst_format,
+                           size_t count);
+// Full scale is [-1, 1)
+bool audio_samples_to_float(const void *src, audio_format_t format, float *dst, size_t count);
+bool audio_samples_from_float(const float *src, void *dst, audio_format_t format, size_t count);
+
+bool audio_resampler_init(audio_resampler_t *resampler, uint32_t in_rate, uint32_t out_rate, uint32_t channels);
+void audio_resampler_free(audio_resampler_t *resampler);
+void audio_resampler_reset(audio_resampler_t *resampler);
+// Most frames one call can produce from in_frames
+size_t audio_resampler_max_output(const audio_resampler_t *resampler, size_t in_frames);
+// Consumes every input frame and returns the frames written to out
+size_t audio_resampler_process(audio_resampler_t *resampler, const float *in, size_t in_frames, float *out);
+
+// Kernels the conversions and filter run with; the 128-bit ones back
+// every wider pattern ISA
+pattern_isa_t audio_convert_isa(void);
+
+// Benchmarks config->format to target over config->channels and checks the
+// round trip
+bool test_audio_format_conversion(const audio_test_config_t *config, audio_format_t target,
+                                  audio_convert_stats_t *stats);
+// Resamples a tone per channel from config->sample_rate to out_rate, in
+// config->format, and measures throughput and THD+N
+bool test_audio_resampling(const audio_test_config_t *config, uint32_t out_rate, audio_resample_stats_t *stats);
+
+#endif /* AUDIO_CONVERT_H */
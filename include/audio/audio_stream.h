@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef AUDIO_STREAM_H
+#define AUDIO_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "audio/tizen_audio_test.h"
+#include "common/sweep.h"
+#include "common/trace.h"
+
+// Streaming engine defaults
+#define AUDIO_STREAM_PERIODS 4
+#define AUDIO_STREAM_DEFAULT_DURATION 5    // seconds
+#define AUDIO_LATENCY_IMPULSES 32
+#define AUDIO_SWEEP_DURATION 2             // seconds per sweep point
+
+// Sustained mmap streaming statistics
+typedef struct {
+    uint64_t frames;               // Frames committed through the mmap area
+    uint32_t xruns;                // Underruns (playback) or overruns (capture)
+    uint32_t wakeups;              // poll() wakeups that found frames to move
+    uint32_t period_size;          // Negotiated frames per period
+    uint32_t buffer_size;          // Negotiated frames per buffer
+    uint32_t rate;                 // Negotiated sample rate
+    double measured_rate;          // Hardware frames per second of monotonic time
+    double max_wakeup_ms;          // Longest gap between serviced wakeups
+    double peak_dbfs;              // Loudest captured sample (capture only)
+} audio_stream_stats_t;
+
+// Impulse round trip from the moment it is committed to playback until the
+// capture side hands it back
+typedef struct {
+    uint32_t impulses;             // Impulses sent
+    uint32_t detected;             // Impulses found in the capture stream
+    uint32_t xruns;                // Either direction; aborts the pending impulse
+    uint32_t period_size;          // Negotiated frames per period
+    uint32_t buffer_size;          // Negotiated frames per buffer
+    uint32_t rate;                 // Negotiated sample rate
+    double min_ms;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+    double path_ms;                // Converter and wiring delay alone, in frames
+    bool linked;                   // Streams started together; path_ms is valid
+} audio_latency_stats_t;
+
+// Runs one direction of hw:<device_index>,0 in MMAP_INTERLEAVED mode for
+// config->duration seconds, refilling or draining a period at a time
+bool test_audio_stream(uint32_t device_index, audio_device_type_t direction,
+                       const audio_test_config_t *config, audio_stream_stats_t *stats);
+
+// Needs the device's playback output looped back into its capture input
+// (a cable, a codec loopback route or snd-aloop)
+bool test_audio_loopback_latency(uint32_t device_index, const audio_test_config_t *config,
+                                 audio_latency_stats_t *stats);
+
+// Sweep point context; playback when the device has it, capture otherwise
+typedef struct {
+    uint32_t device_index;
+    audio_device_type_t direction;
+    audio_test_config_t config;
+} audio_sweep_context_t;
+
+// Rate x channels x format from the device's reported capabilities; the
+// point function reports the hardware frame rate it measured
+bool audio_sweep_init(sweep_t *sweep, uint32_t device_index, const audio_test_config_t *base);
+bool audio_sweep_stream_rate(void *context, const sweep_point_t *point, double *value);
+
+// Trace replayer for the PCM ops. Streams are reopened with their recorded
+// configuration and written from the trace mapping in mmap mode.
+bool audio_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns);
+void audio_trace_finish(void *context);
+
+#endif /* AUDIO_STREAM_H */
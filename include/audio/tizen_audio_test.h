@@ -102,7 +102,10 @@ typedef struct {
     audio_format_t format;        // Format for testing
     audio_channel_t channels;     // Channel configuration for testing
     uint32_t buffer_size;         // Buffer size for testing
+    uint32_t period_size;         // Frames per period (0: buffer_size / periods)
+    uint32_t periods;             // Periods per buffer (0: AUDIO_STREAM_PERIODS)
     uint32_t iterations;          // Number of test iterations
+    uint32_t duration;            // Streaming duration in seconds
     uint32_t timeout;             // Test timeout in milliseconds
 } audio_test_config_t;
 
@@ -139,7 +142,6 @@ bool test_audio_volume(uint32_t device_index, const audio_test_config_t *config)
 bool test_audio_mute(uint32_t device_index, const audio_test_config_t *config);
 bool test_audio_routing(uint32_t device_index, const audio_test_config_t *config);
 bool test_audio_compression(uint32_t device_index, const audio_test_config_t *config);
-bool test_audio_resampling(uint32_t device_index, const audio_test_config_t *config);
 bool test_audio_sync(uint32_t device_index, const audio_test_config_t *config);
 bool test_audio_interference(uint32_t device_index, const audio_test_config_t *config);
 
@@ -151,6 +153,7 @@ const char *audio_format_to_string(audio_format_t format);
 const char *audio_channel_to_string(audio_channel_t channels);
 const char *audio_device_type_to_string(audio_device_type_t type);
 const char *audio_feature_to_string(audio_feature_t feature);
+uint32_t audio_channel_count(audio_channel_t channels);
 audio_test_result_t convert_bool_to_test_result(bool result);
 
 #endif /* TIZEN_AUDIO_TEST_H */
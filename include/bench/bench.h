@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BENCH_MAX_CASES 128
+#define BENCH_MAX_SAMPLES 64
+#define BENCH_NAME_MAX 64
+
+// One benchmarked operation. run() repeats the operation iterations times
+// back to back, so the clock is read once per batch rather than once per
+// call and the harness costs the same however cheap the operation is.
+typedef struct {
+    const char *name;
+    bool (*setup)(void *context);             // Once before warmup, untimed; false skips the case
+    void (*run)(void *context, uint64_t iterations);
+    void (*teardown)(void *context);          // Once after the last sample, untimed
+    void *context;
+    uint64_t bytes;                           // Bytes processed per iteration, 0 if not a throughput case
+} bench_case_t;
+
+typedef struct {
+    char name[BENCH_NAME_MAX];
+    uint64_t iterations;                      // Per sample, from calibration
+    uint32_t samples;
+    double median_ns;                         // Per iteration
+    double mad_ns;                            // Median absolute deviation of the samples
+    double min_ns;
+    uint64_t bytes;
+} bench_result_t;
+
+typedef struct {
+    uint32_t samples;                         // Timed samples per case
+    uint64_t warmup_ns;                       // Untimed running before the first sample
+    uint64_t sample_ns;                       // Target length of one sample
+    const char *filter;                       // Substring a case name must contain, NULL for all
+} bench_config_t;
+
+// Warmup doubles as calibration: the batch grows until one takes
+// sample_ns, then keeps running until warmup_ns has passed. Each case is
+// reported as the median of its samples.
+void bench_init(const bench_config_t *config);
+bool bench_run(const bench_case_t *bench);
+void bench_skip(const char *name, const char *reason);
+const bench_result_t *bench_results(uint32_t *count);
+
+// Cost of one empty sample (clock reads and the call into run()), and
+// its largest share of any sample taken
+double bench_overhead_ns(void);
+double bench_overhead_ratio(void);
+
+// Baselines are JSON files written by a previous run on the same board. A
+// case regresses when its median is more than tolerance (a fraction)
+// slower than the baseline's and the difference is also well outside
+// both runs' spread. Returns the number of regressions, or -1 if the
+// baseline cannot be read.
+bool bench_save_baseline(const char *path);
+int bench_compare_baseline(const char *path, double tolerance);
+
+// Subsystem cases live in one unit each, since the subsystem headers
+// cannot all be included together
+void bench_drm_cases(void);
+void bench_video_cases(void);
+void bench_audio_cases(void);
+
+#endif /* BENCH_H */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CAP_CACHE_H
+#define CAP_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CAP_CACHE_MAX_ENTRIES 64
+#define CAP_CACHE_KEY_SIZE 256
+
+// On-disk cache of probed device capabilities. Entries are keyed by the
+// device node, the physical device behind it and its driver's version, so
+// a driver update or a device moving to another port simply misses. With
+// no file open every lookup misses and stores are dropped.
+bool cap_cache_open(const char *path);
+
+// Writes the file back if anything was stored, then forgets every entry
+void cap_cache_close(void);
+
+// Builds the key for a sysfs class node (e.g. /sys/class/video4linux/video0)
+// without touching the device itself. Fails if the node has no device.
+bool cap_cache_device_key(const char *sysfs_node, char *key, size_t size);
+
+// Copies the cached payload into data; a payload of another size (an older
+// build's structure) is a miss
+bool cap_cache_lookup(const char *key, void *data, size_t size);
+void cap_cache_store(const char *key, const void *data, size_t size);
+
+#endif /* CAP_CACHE_H */
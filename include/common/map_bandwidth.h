@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef MAP_BANDWIDTH_H
+#define MAP_BANDWIDTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAP_BANDWIDTH_PASSES 8
+
+// Sequential CPU access rates through one mapping, in bytes per second.
+// Write-combined or uncached mappings typically read 10-50x slower than
+// cached memory; cached_ratio makes that visible without a reference run.
+typedef struct {
+    double read_bps;
+    double write_bps;
+    double copy_bps;                  // memcpy from the mapping into cached memory
+    double cached_ratio;              // read_bps over the same read from malloc()ed memory
+    bool synced;                      // Passes were bracketed with DMA_BUF_IOCTL_SYNC
+} map_bandwidth_t;
+
+// Measures passes rounds of each access pattern over size bytes of map.
+// With a dma-buf fd, every pass sits between DMA_BUF_IOCTL_SYNC start and
+// end as a well-behaved CPU user would, and the sync cost is included.
+// dmabuf_fd -1 measures the mapping unsynced. The contents are overwritten.
+bool map_bandwidth_measure(void *map, size_t size, int dmabuf_fd, uint32_t passes, map_bandwidth_t *result);
+
+#endif /* MAP_BANDWIDTH_H */
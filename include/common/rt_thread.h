@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Scheduling policies
+typedef enum {
+    RT_POLICY_OTHER,          // Default time-sharing
+    RT_POLICY_FIFO,           // SCHED_FIFO
+    RT_POLICY_RR,             // SCHED_RR
+    RT_POLICY_MAX
+} rt_policy_t;
+
+#define RT_DEFAULT_PRIORITY 50
+
+// Streaming thread configuration
+typedef struct {
+    rt_policy_t policy;       // Scheduling policy
+    int priority;             // 1-99 for FIFO and RR, ignored otherwise
+    uint64_t cpu_mask;        // Bit per CPU, 0 inherits the caller's mask
+    bool lock_memory;         // mlockall() and a pre-faulted stack
+} rt_config_t;
+
+typedef bool (*rt_thread_fn_t)(void *arg);
+
+// True when the configuration asks for anything beyond the defaults
+bool rt_config_active(const rt_config_t *config);
+
+// Locks current and future mappings; once per process, before streaming
+bool rt_lock_memory(void);
+
+// Runs fn on a dedicated thread created with the requested policy and
+// affinity, and returns its result. An inactive configuration runs fn on
+// the calling thread. If the policy is refused for lack of privilege the
+// thread falls back to SCHED_OTHER; applied (optional) records what the
+// thread actually ran with.
+bool rt_thread_run(const rt_config_t *config, rt_thread_fn_t fn, void *arg, rt_config_t *applied);
+
+// Helpers
+bool rt_parse_policy(const char *name, rt_policy_t *policy);
+bool rt_parse_cpu_list(const char *list, uint64_t *cpu_mask);
+const char *rt_policy_to_string(rt_policy_t policy);
+void rt_config_describe(const rt_config_t *config, char *buffer, size_t size);
+
+#endif /* RT_THREAD_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SWEEP_MAX_AXES 4
+#define SWEEP_MAX_VALUES 32
+#define SWEEP_LABEL_SIZE 24
+
+// One dimension of a sweep. Values are opaque to the engine (a fourcc, a
+// modifier, width << 32 | height, a rate); labels are what gets printed.
+typedef struct {
+    char name[16];
+    uint32_t count;
+    uint64_t values[SWEEP_MAX_VALUES];
+    char labels[SWEEP_MAX_VALUES][SWEEP_LABEL_SIZE];
+} sweep_axis_t;
+
+typedef struct {
+    char title[64];
+    char units[16];                   // Of the measured value
+    sweep_axis_t axes[SWEEP_MAX_AXES];
+    uint32_t axis_count;
+} sweep_t;
+
+// One point of the cartesian product, one value per axis
+typedef struct {
+    uint32_t index;                   // Row-major, last axis fastest
+    uint64_t values[SWEEP_MAX_AXES];
+    const char *labels[SWEEP_MAX_AXES];
+} sweep_point_t;
+
+// Measures one point into value. Returning false marks the point
+// unsupported and the sweep moves on.
+typedef bool (*sweep_point_fn_t)(void *context, const sweep_point_t *point, double *value);
+
+typedef struct {
+    uint32_t point_count;
+    uint32_t measured;                // Points that returned a value
+    double *values;                   // NAN where unsupported
+} sweep_result_t;
+
+// Declaration
+void sweep_init(sweep_t *sweep, const char *title, const char *units);
+sweep_axis_t *sweep_add_axis(sweep_t *sweep, const char *name);
+bool sweep_axis_add(sweep_axis_t *axis, uint64_t value, const char *label);   // Ignores duplicates
+uint32_t sweep_point_count(const sweep_t *sweep);
+void sweep_get_point(const sweep_t *sweep, uint32_t index, sweep_point_t *point);
+
+// Visits every point in row-major order, so state the callback keeps for
+// the slow axes (an open device, pooled buffers) carries across the fast
+// ones
+bool sweep_run(const sweep_t *sweep, sweep_point_fn_t fn, void *context, sweep_result_t *result);
+void sweep_result_free(sweep_result_t *result);
+
+// One row per combination of the leading axes, the last axis across
+void sweep_print_matrix(const sweep_t *sweep, const sweep_result_t *result, FILE *out);
+
+#endif /* SWEEP_H */
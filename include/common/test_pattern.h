@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef TEST_PATTERN_H
+#define TEST_PATTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pattern types
+typedef enum {
+    PATTERN_SOLID,            // Every word holds the same value
+    PATTERN_GRADIENT,         // Word i holds value + i * step
+    PATTERN_CHECKSUM,         // Word i holds a position hash seeded by value
+    PATTERN_MAX
+} pattern_type_t;
+
+// Kernel implementations
+typedef enum {
+    PATTERN_ISA_SCALAR,       // Portable C
+    PATTERN_ISA_SSE2,         // x86 128-bit
+    PATTERN_ISA_AVX2,         // x86 256-bit
+    PATTERN_ISA_NEON,         // ARM 128-bit
+    PATTERN_ISA_MAX
+} pattern_isa_t;
+
+// Access flags
+#define PATTERN_FLAG_NONTEMPORAL 0x1   // Streaming stores/loads for write-combined mappings
+
+// Pattern description
+typedef struct {
+    pattern_type_t type;      // Pattern type
+    uint32_t value;           // Solid value, gradient start or checksum seed
+    uint32_t step;            // Gradient increment per word
+} test_pattern_t;
+
+// Patterns are defined over native-endian 32-bit words. first_word is the
+// index of the word at the start of the range, so a pitched surface can be
+// filled row by row and still carry one continuous pattern. Trailing bytes
+// take the leading bytes of the next word.
+
+// Kernel selection; runs automatically on first use. TVTS_PATTERN_ISA
+// (scalar, sse2, avx2, neon) overrides the runtime choice.
+void pattern_init(void);
+pattern_isa_t pattern_get_isa(void);
+bool pattern_set_isa(pattern_isa_t isa);
+
+// Fill and verify
+uint32_t pattern_word(const test_pattern_t *pattern, uint32_t index);
+bool pattern_fill(void *dst, size_t size, const test_pattern_t *pattern, uint32_t first_word, uint32_t flags);
+bool pattern_verify(const void *src, size_t size, const test_pattern_t *pattern, uint32_t first_word,
+                    uint32_t flags, size_t *mismatch_offset);
+
+// Helpers
+test_pattern_t pattern_solid(uint32_t value);
+test_pattern_t pattern_solid_byte(uint8_t value);
+const char *pattern_type_to_string(pattern_type_t type);
+const char *pattern_isa_to_string(pattern_isa_t isa);
+
+#endif /* TEST_PATTERN_H */
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "report/report_timing.h"
+
+// Session trace: every operation a run issues to its devices, when it
+// started and how long it took, so the same workload can be replayed on
+// another board or firmware build. The file starts with an 8 byte header
+// (magic, version, header size), then records of
+//   u8 op, u8 argc, zigzag varint start delta ns, varint duration ns,
+//   argc * varint argument, varint data length, data
+// Varints are unsigned LEB128; the start delta is signed because jobs on
+// other workers finish out of order. An op byte with TRACE_OP_PAYLOAD set
+// carries a payload id as its last argument instead of data. Each distinct
+// payload is stored once, in an earlier TRACE_OP_BLOB record whose bytes
+// start on a TRACE_BLOB_ALIGN boundary of the file, and replay hands out
+// pointers into the mapped file.
+#define TRACE_MAGIC "TVTQ"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 8
+#define TRACE_MAX_ARGS 12
+#define TRACE_MAX_OPS 128
+#define TRACE_BLOB_ALIGN 64
+#define TRACE_OP_PAYLOAD 0x80
+
+// An op's class, which picks its replayer, is bits 4-6 of its code
+typedef enum {
+    TRACE_CLASS_SESSION,
+    TRACE_CLASS_DRM,
+    TRACE_CLASS_VIDEO,
+    TRACE_CLASS_AUDIO,
+    TRACE_CLASS_MAX
+} trace_class_t;
+
+typedef enum {
+    // Session
+    TRACE_OP_BEGIN = 0x01,            // u64 wall clock start; data: hostname
+    TRACE_OP_BLOB = 0x02,             // u64 padding; data: padding, then the payload
+    TRACE_OP_JOB = 0x03,              // device index; data: job name and options
+    TRACE_OP_RESULT = 0x04,           // passed; data: test name
+
+    // DRM, on the display device
+    TRACE_OP_DRM_CREATE = 0x10,       // buffer, width, height, format, modifier, compression
+    TRACE_OP_DRM_DESTROY = 0x11,      // buffer
+    TRACE_OP_DRM_FILL = 0x12,         // buffer, solid, value, pattern type, step
+    TRACE_OP_DRM_FRAMEBUFFER = 0x13,  // buffer, fb
+    TRACE_OP_DRM_COMMIT = 0x14,       // plane type, fb (0: the original scanout), src w, h, crtc w, h,
+                                      // full state, flags, succeeded
+    TRACE_OP_DRM_FLIP = 0x15,         // Waiting for the last commit's flip event
+
+    // V4L2 mem-to-mem queues; queue is 0 for OUTPUT, 1 for CAPTURE
+    TRACE_OP_V4L2_OPEN = 0x20,        // session, device index, timeout ms
+    TRACE_OP_V4L2_CLOSE = 0x21,       // session
+    TRACE_OP_V4L2_FORMAT = 0x22,      // session, queue, fourcc, width, height, sizeimage, exact
+    TRACE_OP_V4L2_GET_FORMAT = 0x23,  // session, queue
+    TRACE_OP_V4L2_CONTROL = 0x24,     // session, id, value
+    TRACE_OP_V4L2_FRAMERATE = 0x25,   // session, fps
+    TRACE_OP_V4L2_SUBSCRIBE = 0x26,   // session, event type
+    TRACE_OP_V4L2_EVENT = 0x27,       // session, event type dequeued
+    TRACE_OP_V4L2_STOP = 0x28,        // session, encoder
+    TRACE_OP_V4L2_ALLOC = 0x29,       // session, queue, count
+    TRACE_OP_V4L2_STREAM = 0x2a,      // session, queue, on
+    TRACE_OP_V4L2_QBUF = 0x2b,        // session, queue, index, bytesused, timestamp us, [payload]
+    TRACE_OP_V4L2_DQBUF = 0x2c,       // session, queue, index, bytesused, flags
+    TRACE_OP_V4L2_WAIT = 0x2d,        // session, poll events
+
+    // ALSA PCM streams
+    TRACE_OP_PCM_OPEN = 0x30,         // stream, card, playback, format, channels, rate, periods,
+                                      // period size, buffer size (audio_test_config_t values)
+    TRACE_OP_PCM_CLOSE = 0x31,        // stream
+    TRACE_OP_PCM_START = 0x32,        // stream
+    TRACE_OP_PCM_LINK = 0x33,         // stream, stream started with it
+    TRACE_OP_PCM_WRITE = 0x34,        // stream, frames, payload
+    TRACE_OP_PCM_READ = 0x35          // stream, frames
+} trace_op_t;
+
+#define TRACE_ARGC(args) ((uint32_t)(sizeof(args) / sizeof((args)[0])))
+
+typedef struct {
+    trace_op_t op;
+    uint64_t start_ns;                // Since recording started
+    uint64_t duration_ns;
+    uint32_t argc;
+    uint64_t args[TRACE_MAX_ARGS];
+    const void *data;                 // Names and options, inside the mapping
+    size_t data_size;
+    const void *payload;              // Device payload, inside the mapping; NULL if none
+    size_t payload_size;
+} trace_record_t;
+
+// Recording. Hooks take trace_begin() just before the operation and only
+// record when it was nonzero, so a run without --record pays one load per
+// operation. Records are written when the operation returns, timed from
+// that start.
+bool trace_record_start(const char *path);
+void trace_record_stop(void);
+bool trace_recording(void);
+uint64_t trace_begin(void);
+// Names sessions, streams and buffers in the trace; never 0
+uint32_t trace_next_id(void);
+void trace_record(trace_op_t op, uint64_t start_ns, const uint64_t *args, uint32_t argc,
+                  const void *data, size_t size);
+// Payloads seen before are stored by reference to their first copy
+void trace_record_payload(trace_op_t op, uint64_t start_ns, const uint64_t *args, uint32_t argc,
+                          const void *payload, size_t size);
+
+// Reading
+typedef struct {
+    const void *data;
+    size_t size;
+} trace_blob_t;
+
+typedef struct {
+    const uint8_t *map;
+    size_t size;
+    size_t offset;                    // Next record
+    int64_t clock_ns;                 // Start of the last record read
+    trace_blob_t *blobs;
+    uint32_t blob_count;
+    uint32_t blob_capacity;
+    time_t start_time;
+    char device[64];                  // Hostname of the board that recorded it
+} trace_reader_t;
+
+bool trace_reader_open(const char *path, trace_reader_t *reader);
+// 1 with the next operation, 0 at a clean end, -1 if the trace is corrupt
+// or was cut off mid-record (a crash, a full disk); the records before it
+// have been returned already.
+int trace_reader_next(trace_reader_t *reader, trace_record_t *record);
+void trace_reader_close(trace_reader_t *reader);
+
+// Replay
+typedef enum {
+    TRACE_SPEED_RECORDED,             // Each operation at its recorded offset from the start
+    TRACE_SPEED_MAX                   // Back to back; only the devices hold it back
+} trace_speed_t;
+
+// Issues one recorded operation. duration_ns covers the same span the
+// recording hook timed; false if the device refused what it accepted
+// then. finish() releases whatever a cut-off trace left open.
+typedef struct {
+    bool (*replay)(void *context, const trace_record_t *record, uint64_t *duration_ns);
+    void (*finish)(void *context);
+    void *context;
+} trace_replayer_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t failed;                  // Replayed, and refused
+    uint64_t skipped;                 // No replayer for its subsystem in this build
+    uint64_t bytes;                   // Payload moved
+    report_histogram_t recorded;
+    report_histogram_t replayed;
+} trace_op_stats_t;
+
+typedef struct {
+    trace_speed_t speed;
+    char device[64];                  // Board that recorded the trace
+    time_t start_time;
+    uint64_t records;
+    uint32_t jobs;
+    uint32_t results;
+    uint32_t passed;                  // Results that passed when recorded
+    uint64_t recorded_ns;             // First operation's start to last one's end
+    uint64_t replayed_ns;
+    uint64_t late;                    // Issued after their recorded offset (recorded speed)
+    uint64_t max_lag_ns;
+    bool truncated;                   // A corrupt or cut-off record ended the replay early
+    trace_op_stats_t *ops[TRACE_MAX_OPS];   // NULL for ops the trace never used
+} trace_replay_stats_t;
+
+void trace_set_replayer(trace_class_t cls, const trace_replayer_t *replayer);
+bool trace_replay(const char *path, trace_speed_t speed, trace_replay_stats_t *stats);
+void trace_replay_stats_free(trace_replay_stats_t *stats);
+
+const char *trace_op_to_string(trace_op_t op);
+trace_class_t trace_op_class(trace_op_t op);
+
+#endif /* TRACE_H */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WORKER_MAX_RESOURCES 4
+#define WORKER_RESOURCE_ALL "*"   // Conflicts with every other job
+
+typedef bool (*worker_fn_t)(void *arg);
+
+// A unit of work and the resources it needs to itself. Two jobs naming the
+// same resource never overlap, and run in the order they were submitted.
+typedef struct {
+    char name[64];
+    char resources[WORKER_MAX_RESOURCES][32];
+    uint32_t resource_count;
+    worker_fn_t fn;
+    void *arg;
+
+    // Filled in by worker_pool_run()
+    bool result;
+    uint32_t duration_ms;
+} worker_job_t;
+
+void worker_job_init(worker_job_t *job, const char *name, worker_fn_t fn, void *arg);
+bool worker_job_add_resource(worker_job_t *job, const char *resource);
+
+// Runs every job on up to workers threads (0: one per online CPU) and
+// returns true if all of them succeeded. A single worker runs the jobs in
+// order on the calling thread.
+bool worker_pool_run(worker_job_t *jobs, uint32_t count, uint32_t workers);
+
+uint32_t worker_default_count(void);
+
+#endif /* WORKER_POOL_H */
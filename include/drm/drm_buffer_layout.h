@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#ifndef DRM_BUFFER_LAYOUT_H
+#define DRM_BUFFER_LAYOUT_H
+
+#include <stdint.h>
+#include "tizen_drm_test.h"
+
+// Layout calculation. A zero pitch selects the minimum tile-aligned pitch;
+// otherwise plane 0 uses the given pitch (e.g. from CREATE_DUMB) and the
+// chroma pitches are derived from it.
+bool drm_buffer_layout_init(drm_buffer_layout_t *layout, drm_format_t format, drm_modifier_t modifier,
+                            uint32_t width, uint32_t height, uint32_t pitch);
+uint32_t drm_format_plane_count(drm_format_t format);
+uint32_t drm_format_cpp(drm_format_t format, uint32_t plane);
+
+// Layout modifier for a fourcc modifier a device advertises; false when
+// there is no CPU layout for it
+bool drm_modifier_from_fourcc(uint64_t fourcc_mod, drm_modifier_t *modifier);
+
+// Per-plane solid patterns for an ARGB colour (BT.601 limited range for YUV)
+bool drm_format_solid_patterns(drm_format_t format, uint32_t argb, test_pattern_t patterns[DRM_MAX_PLANES]);
+
+// Plane access through the layout; mismatch_x is in bytes within the row
+bool drm_buffer_layout_fill(void *map, const drm_buffer_layout_t *layout, uint32_t plane,
+                            const test_pattern_t *pattern, uint32_t flags);
+bool drm_buffer_layout_verify(const void *map, const drm_buffer_layout_t *layout, uint32_t plane,
+                              const test_pattern_t *pattern, uint32_t flags,
+                              uint32_t *mismatch_x, uint32_t *mismatch_y);
+
+#endif /* DRM_BUFFER_LAYOUT_H */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef DRM_BUFFER_POOL_H
+#define DRM_BUFFER_POOL_H
+
+#include <stdint.h>
+#include "tizen_drm_test.h"
+
+// Pool limits
+#define DRM_BUFFER_POOL_BUCKETS 64
+#define DRM_BUFFER_POOL_MAX_IDLE 8
+#define DRM_BUFFER_POOL_MAX_BYTES (512u * 1024 * 1024)
+
+// Pool statistics
+typedef struct {
+    uint64_t hits;                // Acquires served from an idle buffer
+    uint64_t misses;              // Acquires that had to allocate
+    uint64_t evictions;           // Releases destroyed because the pool was full
+    uint32_t idle_buffers;        // Buffers currently parked in the pool
+    uint64_t idle_bytes;          // Memory held by parked buffers
+} drm_buffer_pool_stats_t;
+
+// Buffers are keyed by width/height/format/modifier and keep their GEM
+// handle, mapping and framebuffer while parked. Contents are not cleared
+// between users.
+drm_buffer_t *drm_buffer_pool_acquire(const test_config_t *config);
+void drm_buffer_pool_release(drm_buffer_t *buf);
+void drm_buffer_pool_trim(void);
+void drm_buffer_pool_get_stats(drm_buffer_pool_stats_t *stats);
+
+#endif /* DRM_BUFFER_POOL_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef DRM_DEVICE_H
+#define DRM_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "drm/drm_topology.h"
+
+#define DRM_DEVICE_PATH_MAX 64
+#define DRM_DEVICE_MAX 16
+
+// One open DRM node. Any number can be open at once: card0 for display,
+// card1 on a second GPU, renderD128 for an importer without KMS access.
+typedef struct drm_device {
+    int fd;
+    char path[DRM_DEVICE_PATH_MAX];
+    char driver[32];
+    int node_type;                    // DRM_NODE_PRIMARY or DRM_NODE_RENDER
+    bool atomic;                      // Atomic and universal plane client caps accepted
+    bool kms;                         // Topology was read; primary nodes with CRTCs only
+    bool dumb;                        // Can allocate dumb buffers
+    uint64_t prime;                   // DRM_PRIME_CAP_* bits
+    drm_topology_t topology;          // Empty unless kms
+    drm_format_set_t formats;         // Union over all planes, empty without planes
+} drm_device_t;
+
+// Opening reads the topology of primary nodes; a display-less GPU still
+// opens, with kms false. Buffers created on a device must be destroyed
+// before it is closed.
+bool drm_device_open(drm_device_t *device, const char *path);
+void drm_device_close(drm_device_t *device);
+
+// Node name without the directory, e.g. "renderD128"
+const char *drm_device_name(const drm_device_t *device);
+
+// card* and renderD* nodes under /dev/dri, sorted by name
+uint32_t drm_device_enumerate(char paths[][DRM_DEVICE_PATH_MAX], uint32_t max);
+
+#endif /* DRM_DEVICE_H */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef DRM_FENCE_H
+#define DRM_FENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "drm/drm_device.h"
+
+// Timeline syncobj. Points only move forward; a wait may start before the
+// point has a fence (WAIT_FOR_SUBMIT), which is how a consumer can sleep
+// on a frame the producer has not reached yet.
+typedef struct {
+    drm_device_t *device;
+    uint32_t handle;
+    uint32_t staging;                 // Binary syncobj for sync_file transfers
+} drm_timeline_t;
+
+bool drm_timeline_create(drm_timeline_t *timeline, drm_device_t *device);
+void drm_timeline_destroy(drm_timeline_t *timeline);
+bool drm_timeline_signal(drm_timeline_t *timeline, uint64_t point);
+uint64_t drm_timeline_query(drm_timeline_t *timeline);
+
+// 0 once point has signalled, -ETIME after timeout_ms, another negative
+// errno on failure
+int drm_timeline_wait(drm_timeline_t *timeline, uint64_t point, int timeout_ms);
+
+// sync_file bridging for IN_FENCE_FD and OUT_FENCE_PTR. Export returns a
+// new fd, or -1 if the point has no fence yet; import does not take fd.
+int drm_timeline_export_sync_file(drm_timeline_t *timeline, uint64_t point);
+bool drm_timeline_import_sync_file(drm_timeline_t *timeline, uint64_t point, int fd);
+
+// Waits for a sync_file to signal; same return convention as above
+int drm_sync_file_wait(int fd, int timeout_ms);
+
+#endif /* DRM_FENCE_H */
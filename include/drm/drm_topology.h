@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef DRM_TOPOLOGY_H
+#define DRM_TOPOLOGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <xf86drmMode.h>
+
+// Properties resolved to IDs once, at discovery. The same name on
+// different object types (e.g. CRTC_ID on planes and connectors) shares
+// one slot.
+typedef enum {
+    // Planes
+    DRM_PROP_FB_ID,
+    DRM_PROP_CRTC_ID,
+    DRM_PROP_SRC_X,
+    DRM_PROP_SRC_Y,
+    DRM_PROP_SRC_W,
+    DRM_PROP_SRC_H,
+    DRM_PROP_CRTC_X,
+    DRM_PROP_CRTC_Y,
+    DRM_PROP_CRTC_W,
+    DRM_PROP_CRTC_H,
+    DRM_PROP_TYPE,
+    DRM_PROP_IN_FORMATS,
+    DRM_PROP_IN_FENCE_FD,
+    DRM_PROP_ZPOS,
+    DRM_PROP_ROTATION,
+    // CRTCs
+    DRM_PROP_ACTIVE,
+    DRM_PROP_MODE_ID,
+    DRM_PROP_OUT_FENCE_PTR,
+    DRM_PROP_VRR_ENABLED,
+    DRM_PROP_GAMMA_LUT,
+    DRM_PROP_GAMMA_LUT_SIZE,
+    DRM_PROP_DEGAMMA_LUT,
+    DRM_PROP_CTM,
+    // Connectors
+    DRM_PROP_DPMS,
+    DRM_PROP_EDID,
+    DRM_PROP_LINK_STATUS,
+    DRM_PROP_COUNT
+} drm_prop_t;
+
+typedef struct {
+    uint32_t ids[DRM_PROP_COUNT];     // 0 when the object lacks the property
+    uint64_t values[DRM_PROP_COUNT];  // Value at discovery
+} drm_object_props_t;
+
+// Format x modifier pairs in an open-addressed hash set. Membership of a
+// format alone and of a modifier alone is recorded as well, so every
+// lookup is a single probe sequence.
+typedef struct {
+    uint32_t format;                  // 0 for a modifier-only entry
+    uint32_t used;
+    uint64_t modifier;                // DRM_FORMAT_MOD_INVALID for a format-only entry
+} drm_format_entry_t;
+
+typedef struct {
+    drm_format_entry_t *entries;
+    uint32_t capacity;                // Power of two
+    uint32_t count;
+    uint32_t pair_count;              // Distinct format x modifier pairs
+} drm_format_set_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t possible_crtcs;
+    uint32_t type;                    // DRM_PLANE_TYPE_*
+    drm_object_props_t props;
+    drm_format_set_t formats;         // From IN_FORMATS, else the legacy list as linear
+} drm_topology_plane_t;
+
+// Field names follow drmModeCrtc
+typedef struct {
+    uint32_t id;
+    uint32_t index;                   // Bit in possible_crtcs
+    uint32_t buffer_id;               // Framebuffer scanned out at discovery
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    bool mode_valid;
+    drmModeModeInfo mode;
+    drm_object_props_t props;
+} drm_topology_crtc_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t type;                    // DRM_MODE_CONNECTOR_*
+    uint32_t connection;              // DRM_MODE_CONNECTED, ...
+    uint32_t width_mm;
+    uint32_t height_mm;
+    uint32_t crtc_id;                 // CRTC driving it at discovery, 0 if none
+    uint32_t possible_crtcs;          // Union over its encoders
+    uint32_t mode_count;
+    drmModeModeInfo *modes;
+    drm_object_props_t props;
+} drm_topology_connector_t;
+
+typedef struct {
+    drm_topology_connector_t *connectors;
+    uint32_t connector_count;
+    drm_topology_crtc_t *crtcs;
+    uint32_t crtc_count;
+    drm_topology_plane_t *planes;
+    uint32_t plane_count;
+} drm_topology_t;
+
+// Discovery. Needs the universal planes (and, for the atomic properties,
+// atomic) client caps set first. Connectors are read without forcing a
+// probe.
+bool drm_topology_init(drm_topology_t *topology, int fd);
+void drm_topology_free(drm_topology_t *topology);
+
+// Lookups on the cached topology, no ioctls
+drm_topology_crtc_t *drm_topology_find_crtc(drm_topology_t *topology, uint32_t crtc_id);
+drm_topology_plane_t *drm_topology_find_plane(drm_topology_t *topology, uint32_t plane_id);
+drm_topology_plane_t *drm_topology_find_plane_for_crtc(drm_topology_t *topology, uint32_t crtc_index, uint32_t type);
+
+// Adds a cached property to an atomic request; -ENOENT when the object
+// does not have it
+int drm_atomic_add(drmModeAtomicReq *req, uint32_t object_id, const drm_object_props_t *props,
+                   drm_prop_t prop, uint64_t value);
+const char *drm_prop_name(drm_prop_t prop);
+
+// Format sets
+bool drm_format_set_add(drm_format_set_t *set, uint32_t format, uint64_t modifier);
+bool drm_format_set_merge(drm_format_set_t *dst, const drm_format_set_t *src);
+bool drm_format_set_has(const drm_format_set_t *set, uint32_t format, uint64_t modifier);
+bool drm_format_set_has_format(const drm_format_set_t *set, uint32_t format);
+bool drm_format_set_has_modifier(const drm_format_set_t *set, uint64_t modifier);
+void drm_format_set_free(drm_format_set_t *set);
+
+#endif /* DRM_TOPOLOGY_H */
@@ -7,12 +7,22 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <drm_fourcc.h>
+#include "common/test_pattern.h"
+#include "report/report_timing.h"
+#include "common/map_bandwidth.h"
+#include "common/sweep.h"
+#include "common/trace.h"
 
 // Test configuration
 #define TEST_WIDTH 1920
 #define TEST_HEIGHT 1080
 #define TEST_ITERATIONS 100
 #define TEST_TIMEOUT 5000
+#define TEST_FLIP_RING_SIZE 3
+#define TEST_FLIP_FRAMES 600
+#define TEST_BANDWIDTH_PASSES 8
+#define TEST_FENCE_MAX_DEPTH 4
+#define DRM_MAX_PLANES 4
 
 // Color formats
 typedef enum {
@@ -58,6 +68,8 @@ typedef enum {
     DRM_COMPRESSION_BC7 = 10
 } drm_compression_t;
 
+struct drm_device;
+
 // Test result codes
 typedef enum {
     TEST_PASS = 0,
@@ -76,6 +88,23 @@ typedef struct {
     uint32_t iterations;
 } test_config_t;
 
+// Buffer memory layout. Tiled planes store tile_height rows of a tile
+// column contiguously in tile_span-byte segments; tiles are row-major
+// unless tile_z_order is set.
+typedef struct {
+    uint32_t num_planes;
+    uint32_t pitches[DRM_MAX_PLANES];     // Bytes per row
+    uint32_t offsets[DRM_MAX_PLANES];     // Plane start within the object
+    uint32_t row_bytes[DRM_MAX_PLANES];   // Pixel bytes per row
+    uint32_t rows[DRM_MAX_PLANES];        // Pixel rows per plane
+    uint64_t modifier;                    // Fourcc modifier for AddFB2
+    uint32_t tile_width;                  // Tile width in bytes, 0 if linear
+    uint32_t tile_height;                 // Tile height in rows
+    uint32_t tile_span;                   // Contiguous bytes per tile row
+    bool tile_z_order;                    // Samsung Z-flip-Z order of 2x2 tile groups
+    uint32_t size;                        // Total footprint in bytes
+} drm_buffer_layout_t;
+
 // Buffer structure
 typedef struct {
     uint32_t handle;
@@ -86,6 +115,12 @@ typedef struct {
     void *map;
     uint32_t width;
     uint32_t height;
+    uint32_t pitch;
+    uint32_t fb_id;
+    bool imported;
+    drm_buffer_layout_t layout;
+    struct drm_device *device;            // Device the handle and fb_id belong to
+    uint32_t trace_id;                    // Name in a session trace; 0 if not recorded
 } drm_buffer_t;
 
 // Plane structure
@@ -117,6 +152,44 @@ typedef struct {
     uint32_t height_mm;
 } drm_connector_t;
 
+// Page flip benchmark statistics
+typedef struct {
+    uint32_t frames;
+    uint32_t missed_vblanks;
+    double fps;
+    double latency_p50_ms;
+    double latency_p99_ms;
+    double latency_max_ms;
+} drm_flip_stats_t;
+
+// Explicit-sync pipeline statistics at one depth
+typedef struct {
+    uint32_t depth;                       // Frames the producer may run ahead of scanout
+    uint32_t frames;
+    double fps;
+    uint32_t ready_frames;                // Already rendered when the consumer reached them
+    uint32_t producer_stalls;             // Renders held back by a release fence
+    report_histogram_t signal_to_wake;    // Acquire point signalled to consumer running
+    report_histogram_t release_wait;      // Producer blocked on a release fence
+    report_histogram_t commit_to_fence;   // Atomic commit to its OUT_FENCE signalling
+} drm_fence_stats_t;
+
+// One format x modifier pair shared from one device to another
+typedef struct {
+    uint32_t format;
+    uint64_t modifier;                    // Fourcc modifier
+    bool imported;                        // The importer accepted the dma-buf
+    bool verified;                        // Contents matched through both mappings
+    report_histogram_t import_ns;         // PRIME import plus mapping on the importer
+    double zero_copy_bps;                 // Importer reading the exporter's memory in place
+    double copy_bps;                      // Importer copying it into memory it owns
+} drm_cross_device_result_t;
+
+typedef void (*drm_cross_device_handler_t)(void *context, const drm_cross_device_result_t *result);
+
+// Scanout flip completion; user_data is what was passed to drm_scanout_queue()
+typedef void (*drm_scanout_handler_t)(void *context, void *user_data, uint64_t flip_ns);
+
 // DRM Feature Types
 typedef enum {
     DRM_FEATURE_BUFFER_SHARING,
@@ -149,15 +222,28 @@ typedef enum {
 // Test framework functions
 bool init_test_framework(void);
 void cleanup_test_framework(void);
+struct drm_device *drm_get_display_device(void);
 drm_buffer_t *create_drm_buffer(const test_config_t *config);
 void destroy_drm_buffer(drm_buffer_t *buf);
+bool add_drm_framebuffer(drm_buffer_t *buf);
 bool fill_drm_buffer(drm_buffer_t *buf, uint32_t color);
 bool verify_drm_buffer(drm_buffer_t *buf, uint32_t expected_color);
+bool fill_drm_buffer_pattern(drm_buffer_t *buf, const test_pattern_t *pattern);
+bool verify_drm_buffer_pattern(drm_buffer_t *buf, const test_pattern_t *pattern);
 bool export_gem_handle(drm_buffer_t *buf, uint32_t *handle);
 drm_buffer_t *import_gem_handle(uint32_t handle);
 int export_dma_buf(drm_buffer_t *buf, int *fd);
 drm_buffer_t *import_dma_buf(int fd);
-bool test_buffer_performance(const test_config_t *config, uint32_t *avg_time);
+
+// Buffers on an explicit device; the variants above use the display device
+drm_buffer_t *create_drm_buffer_on(struct drm_device *device, const test_config_t *config);
+drm_buffer_t *import_dma_buf_on(struct drm_device *device, int fd);
+
+// Frees a dma-buf import of an object this file did not create (another
+// device's buffer, a V4L2 capture buffer), closing its GEM handle too
+void destroy_foreign_import(drm_buffer_t *buf);
+bool test_buffer_performance(const test_config_t *config, report_histogram_t *export_import);
+bool test_buffer_bandwidth(const test_config_t *config, map_bandwidth_t *dumb, map_bandwidth_t *prime);
 bool test_format_conversion(const test_config_t *src_config, const test_config_t *dst_config);
 bool test_buffer_sharing(const test_config_t *config);
 bool test_plane_configuration(drm_plane_t *plane, const test_config_t *config);
@@ -165,9 +251,35 @@ bool test_crtc_configuration(drm_crtc_t *crtc, const test_config_t *config);
 bool test_connector_properties(drm_connector_t *connector);
 bool test_mode_setting(drm_mode_t *mode);
 bool test_vblank_handling(void);
+bool test_page_flip_throughput(const test_config_t *config, uint32_t ring_size, uint32_t frame_count, drm_flip_stats_t *stats);
+bool test_fence_pipeline(const test_config_t *config, uint32_t depth, uint32_t frame_count, drm_fence_stats_t *stats);
+uint32_t drm_get_refresh_rate(void);
+
+// Sweep of format x modifier x size from the display's advertised pairs
+// and the connector's modes; the point function measures fill throughput
+bool drm_sweep_init(sweep_t *sweep, const test_config_t *base);
+bool drm_sweep_fill_throughput(void *context, const sweep_point_t *point, double *value);
+
+// Scanout of externally produced buffers on the primary plane
+int drm_scanout_get_fd(void);
+bool drm_scanout_start(drm_buffer_t *buf);
+bool drm_scanout_queue(drm_buffer_t *buf, void *user_data);
+bool drm_scanout_dispatch(drm_scanout_handler_t handler, void *context);
+void drm_scanout_stop(void);
 bool test_sync_primitives(void);
 bool test_color_management(void);
 bool test_cross_device_sharing(const test_config_t *config);
+
+// Exports every format x modifier pair both devices advertise and imports
+// it on the other; handler gets one result per pair. False if any imported
+// pair failed verification or none could be shared.
+bool test_cross_device_dmabuf(struct drm_device *exporter, struct drm_device *importer,
+                              const test_config_t *config, drm_cross_device_handler_t handler,
+                              void *context);
 bool test_all_features(void);
 
+// Trace replayer for the DRM ops, on the display device
+bool drm_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns);
+void drm_trace_finish(void *context);
+
 #endif // TIZEN_DRM_TEST_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef REPORT_BINARY_H
+#define REPORT_BINARY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "report/test_report.h"
+
+// Append-only record log written by REPORT_FORMAT_BINARY. Every session
+// starts with an 8 byte header (magic, version, header size), then
+// records of { u16 type, u16 reserved, u32 payload length, payload }. All
+// integers are little-endian, doubles are IEEE-754 bit patterns, strings
+// are a u16 length and the bytes. Readers skip record types they do not
+// know, so new records need no version bump; changing an existing payload
+// does.
+#define REPORT_BINARY_MAGIC "TVTR"
+#define REPORT_BINARY_VERSION 1
+#define REPORT_BINARY_HEADER_SIZE 8
+#define REPORT_BINARY_RECORD_HEADER_SIZE 8
+#define REPORT_BINARY_MAX_RECORD (32 * 1024)
+
+typedef enum {
+    REPORT_RECORD_BEGIN = 1,     // i64 start, u8 flags, str title, description, device
+    REPORT_RECORD_TEST = 2,      // u8 subsystem, u8 result, u32 ms, i64 time, str name, message
+    REPORT_RECORD_METRIC = 3,    // u8 type, u8 flags, f64 value, str name, units, [distribution], [histogram]
+    REPORT_RECORD_PROPERTY = 4,  // str name, value
+    REPORT_RECORD_END = 5        // i64 end
+} report_record_type_t;
+
+// BEGIN flags
+#define REPORT_SESSION_TIMESTAMPS (1u << 0)
+#define REPORT_SESSION_METRICS (1u << 1)
+
+// METRIC flags
+#define REPORT_METRIC_DISTRIBUTION (1u << 0)   // u64 count, f64 min mean p50 p90 p99 p99.9 max
+#define REPORT_METRIC_HISTOGRAM (1u << 1)      // u64 count min max, f64 sum, u32 n, n * { u32 bucket, u32 count }
+
+// One BEGIN..END run of the test suite, as the reader saw it
+typedef struct {
+    time_t start_time;
+    time_t end_time;             // 0 if the log stops before END
+    uint32_t flags;
+    char title[128];
+    char description[256];
+    char device[64];             // Hostname of the board that wrote it
+} report_session_t;
+
+// Writer side, used by the report module's binary formatter
+void report_binary_write_begin(report_writer_t *writer, const test_report_t *report);
+void report_binary_write_test_result(report_writer_t *writer, const test_result_entry_t *entry);
+void report_binary_write_metric(report_writer_t *writer, const perf_metric_entry_t *metric,
+                                const report_histogram_t *histogram);
+void report_binary_write_property(report_writer_t *writer, const report_property_entry_t *property);
+void report_binary_write_end(report_writer_t *writer, const test_report_t *report);
+
+// Reader side. Callbacks may be NULL; strings and entries are only valid
+// during the call.
+typedef struct {
+    void (*begin)(void *context, const report_session_t *session);
+    void (*test_result)(void *context, const report_session_t *session, const test_result_entry_t *entry);
+    void (*metric)(void *context, const report_session_t *session, const perf_metric_entry_t *metric,
+                   const report_histogram_t *histogram);
+    void (*property)(void *context, const report_session_t *session, const char *name, const char *value);
+    void (*end)(void *context, const report_session_t *session);
+} report_binary_visitor_t;
+
+// Walks every session in the file. A log cut off mid-record (a crash) is
+// read up to its last complete record and still counts as success.
+bool report_binary_read(const char *path, const report_binary_visitor_t *visitor, void *context);
+
+#endif /* REPORT_BINARY_H */
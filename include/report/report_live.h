@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef REPORT_LIVE_H
+#define REPORT_LIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "report/report_timing.h"
+
+// Live metrics limits
+#define REPORT_LIVE_MAX_METRICS 64
+#define REPORT_LIVE_RING_SIZE 16384         // Events, power of two
+#define REPORT_LIVE_DRAIN_MS 100            // Exporter wakeup period
+#define REPORT_LIVE_DEFAULT_INTERVAL 10     // Snapshot period in seconds
+#define REPORT_LIVE_RATE_WINDOW_NS 1000000000ULL
+#define REPORT_LIVE_QUANTILE_WINDOW_NS (60ULL * 1000000000ULL)
+
+// Metric kinds, exposed as the matching Prometheus types
+typedef enum {
+    REPORT_LIVE_COUNTER,      // Monotonic total, updated by increments
+    REPORT_LIVE_GAUGE,        // Last value set
+    REPORT_LIVE_HISTOGRAM,    // Latency samples in ns, exposed as a summary in seconds
+                              // with quantiles over the last one to two minutes
+    REPORT_LIVE_KIND_MAX
+} report_live_kind_t;
+
+// Exporter configuration; either or both outputs may be set
+typedef struct {
+    char listen[128];         // "unix:/path", "/path", "host:port" or ":port"
+    char snapshot_file[256];  // Rewritten atomically every interval_s
+    uint32_t interval_s;      // Snapshot period, 0 for the default
+} report_live_config_t;
+
+// Handle for a metric registered while the exporter runs, -1 otherwise.
+// Every update call ignores -1, so hot loops need no check of their own.
+// Handles stay valid across a stop and a later start.
+typedef int report_live_id_t;
+
+// Publishes an event count as a per-second gauge once per window
+typedef struct {
+    report_live_id_t id;
+    uint64_t window_start_ns;
+    uint64_t events;
+} report_live_rate_t;
+
+// Exporter lifetime. Start before the workloads, stop after them; the
+// final state is written to the snapshot file on stop.
+bool report_live_start(const report_live_config_t *config);
+void report_live_stop(void);
+bool report_live_active(void);
+
+// Registration takes a lock and is meant for setup paths, not hot loops.
+// Registering an existing name/labels pair returns the same handle.
+// labels is a Prometheus label list without braces (e.g. "device=\"0\""),
+// or NULL.
+report_live_id_t report_live_register(const char *name, const char *labels,
+                                      report_live_kind_t kind, const char *help);
+
+// Appends name="value" to a label list, escaping backslash, double quote
+// and newline in the value; labels must be NUL terminated (empty to start)
+void report_live_label(char *labels, size_t size, const char *name, const char *value);
+
+// Lock-free, wait-free for a bounded number of producers; events are
+// dropped (and counted) rather than blocking when the ring is full
+void report_live_add(report_live_id_t id, uint64_t delta);
+void report_live_set(report_live_id_t id, double value);
+void report_live_observe_ns(report_live_id_t id, uint64_t ns);
+
+// Rate helpers
+void report_live_rate_init(report_live_rate_t *rate, report_live_id_t id);
+void report_live_rate_tick(report_live_rate_t *rate, uint64_t now_ns);
+
+#endif /* REPORT_LIVE_H */
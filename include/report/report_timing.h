@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef REPORT_TIMING_H
+#define REPORT_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Log-linear histogram of nanosecond samples, HDR style: values below
+// 2^REPORT_HISTOGRAM_SUB_BITS are exact, larger ones fall into one of
+// 2^(REPORT_HISTOGRAM_SUB_BITS-1) linear buckets per power of two, so any
+// recorded value is off by less than 1/64 of itself. Anything at or past
+// 2^REPORT_HISTOGRAM_MAX_BITS ns (about 39 hours) shares the top bucket.
+#define REPORT_HISTOGRAM_SUB_BITS 7
+#define REPORT_HISTOGRAM_MAX_BITS 47
+#define REPORT_HISTOGRAM_HALF (1u << (REPORT_HISTOGRAM_SUB_BITS - 1))
+#define REPORT_HISTOGRAM_BUCKETS \
+    ((REPORT_HISTOGRAM_MAX_BITS - REPORT_HISTOGRAM_SUB_BITS + 2) * REPORT_HISTOGRAM_HALF)
+
+typedef struct {
+    uint64_t count;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    double sum_ns;
+    uint32_t buckets[REPORT_HISTOGRAM_BUCKETS];
+} report_histogram_t;
+
+// Summary of a histogram, in whatever unit it was asked for
+typedef struct {
+    uint64_t count;
+    double min;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+} report_distribution_t;
+
+// Timer on CLOCK_MONOTONIC_RAW, which NTP slewing never touches
+typedef struct {
+    uint64_t start_ns;
+    bool done;
+} report_timer_t;
+
+void report_histogram_init(report_histogram_t *histogram);
+void report_histogram_record(report_histogram_t *histogram, uint64_t value_ns);
+void report_histogram_merge(report_histogram_t *dst, const report_histogram_t *src);
+uint64_t report_histogram_percentile(const report_histogram_t *histogram, double pct);
+double report_histogram_mean(const report_histogram_t *histogram);
+
+// Histogram metrics summarise nanosecond samples in microseconds
+#define REPORT_HISTOGRAM_UNIT_NS 1000.0
+
+// unit_ns is the size of the output unit, e.g. REPORT_HISTOGRAM_UNIT_NS
+void report_histogram_summarize(const report_histogram_t *histogram, double unit_ns,
+                                report_distribution_t *distribution);
+
+uint64_t report_time_now_ns(void);
+report_timer_t report_timer_begin(void);
+uint64_t report_timer_elapsed_ns(const report_timer_t *timer);
+
+// Records the elapsed time into histogram (optional) and returns it
+uint64_t report_timer_stop(report_timer_t *timer, report_histogram_t *histogram);
+
+// Times the statement or block that follows into histogram:
+//     REPORT_TIMED(&hist) { work(); }
+// Leaving the block with break, return or goto skips the sample.
+#define REPORT_TIMED(histogram) \
+    for (report_timer_t report_scope_timer_ = report_timer_begin(); \
+         !report_scope_timer_.done; \
+         report_timer_stop(&report_scope_timer_, (histogram)))
+
+#endif /* REPORT_TIMING_H */
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Records are formatted into one large userspace buffer and reach the file
+// in big write(2)s: when the buffer is half full, or at the first record
+// after REPORT_WRITER_FLUSH_MS has passed, so a crash or watchdog reboot
+// loses at most about a second of results
+#define REPORT_WRITER_BUFFER_SIZE (256 * 1024)
+#define REPORT_WRITER_FLUSH_MS 1000
+
+typedef struct {
+    int fd;
+    char *buffer;
+    size_t used;
+    uint64_t last_flush_ms;
+    uint64_t bytes_written;
+    bool failed;                 // A write failed; later output is dropped
+} report_writer_t;
+
+bool report_writer_open(report_writer_t *writer, const char *path, bool append);
+
+// Flushes, optionally fsync()s, and closes
+bool report_writer_close(report_writer_t *writer, bool sync);
+
+void report_writer_printf(report_writer_t *writer, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+void report_writer_write(report_writer_t *writer, const char *data, size_t length);
+void report_writer_puts(report_writer_t *writer, const char *s);
+void report_writer_putc(report_writer_t *writer, char c);
+
+// Escaped string output for the structured formats; the JSON one adds the
+// quotes, the CSV one only quotes when the field needs it
+void report_writer_json_string(report_writer_t *writer, const char *s);
+void report_writer_xml_string(report_writer_t *writer, const char *s);
+void report_writer_csv_string(report_writer_t *writer, const char *s);
+
+// Hands the buffer to the kernel now
+bool report_writer_flush(report_writer_t *writer);
+
+// Called after each record; flushes if the buffer or its age calls for it
+void report_writer_checkpoint(report_writer_t *writer);
+
+#endif /* REPORT_WRITER_H */
@@ -20,9 +20,13 @@
 #define TEST_REPORT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
+#include "report/report_timing.h"
+#include "report/report_writer.h"
 
 // Report format types
 typedef enum {
@@ -31,6 +35,7 @@ typedef enum {
     REPORT_FORMAT_HTML,       // HTML format
     REPORT_FORMAT_XML,        // XML format
     REPORT_FORMAT_CSV,        // CSV format
+    REPORT_FORMAT_BINARY,     // Record log, see report/report_binary.h
     REPORT_FORMAT_MAX
 } report_format_t;
 
@@ -67,6 +72,7 @@ typedef enum {
     METRIC_THROUGHPUT,        // Throughput in bytes/sec
     METRIC_LATENCY_MS,        // Latency in milliseconds
     METRIC_FRAME_RATE,        // Frame rate in FPS
+    METRIC_COUNT,             // Event count
     METRIC_MAX
 } metric_type_t;
 
@@ -85,11 +91,36 @@ typedef struct test_result_entry {
 typedef struct perf_metric_entry {
     char metric_name[128];                // Metric name
     metric_type_t type;                   // Metric type
-    double value;                         // Metric value
+    double value;                         // Metric value (the mean for distributions)
     char units[32];                       // Metric units
+    bool has_distribution;                // Per-sample detail below is valid
+    report_distribution_t distribution;   // Percentiles, in units
     struct perf_metric_entry *next;       // Next entry in linked list
 } perf_metric_entry_t;
 
+// Run environment entry structure (scheduling, kernel ISA, ...)
+typedef struct report_property_entry {
+    char name[64];                        // Property name
+    char value[256];                      // Property value
+    struct report_property_entry *next;   // Next entry in linked list
+} report_property_entry_t;
+
+// Chunked bump allocator that owns every entry of a report; appending an
+// entry only calls malloc() when the current chunk is full, and
+// report_destroy() frees the chunks, not the entries
+#define REPORT_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct report_arena_chunk {
+    struct report_arena_chunk *next;      // Previously filled chunk
+    size_t size;                          // Usable bytes after the header
+    size_t used;                          // Bytes handed out so far
+} report_arena_chunk_t;
+
+typedef struct {
+    report_arena_chunk_t *current;        // Chunk being filled
+    size_t chunks;                        // Chunks allocated so far
+} report_arena_t;
+
 // Test report configuration structure
 typedef struct {
     char report_file[256];                // Report file path
@@ -114,14 +145,24 @@ typedef struct {
     uint32_t skipped_tests;               // Number of skipped tests
     uint32_t error_tests;                 // Number of test errors
     test_result_entry_t *test_results;    // Test result entries
+    test_result_entry_t *test_results_tail;
     perf_metric_entry_t *perf_metrics;    // Performance metric entries
-    FILE *report_file;                    // Report file handle
+    perf_metric_entry_t *perf_metrics_tail;
+    report_property_entry_t *properties;  // Run environment entries
+    report_arena_t arena;                 // Backing store for all entries
+    report_writer_t writer;               // Buffered output, fed as entries arrive
+    bool writer_open;                     // Until finalised or destroyed
+    bool finalized;                       // report_generate() wrote the trailer
+    uint64_t streamed_records;            // Records serialised so far
+    pthread_mutex_t lock;                 // Serialises concurrent test jobs
 } test_report_t;
 
-// Function prototypes
+// Function prototypes; all of them may be called from concurrent test jobs
 
 // Report initialization/cleanup
 test_report_t *report_create(const char *title, const char *description, const report_config_t *config);
+test_report_t *report_create_at(const char *title, const char *description, const report_config_t *config,
+                                time_t start_time);
 void report_destroy(test_report_t *report);
 
 // Test result reporting
@@ -139,8 +180,24 @@ void report_add_time_metric(test_report_t *report, const char *metric_name, doub
 void report_add_throughput_metric(test_report_t *report, const char *metric_name, double bytes_per_sec);
 void report_add_latency_metric(test_report_t *report, const char *metric_name, double milliseconds);
 void report_add_frame_rate_metric(test_report_t *report, const char *metric_name, double fps);
+void report_add_count_metric(test_report_t *report, const char *metric_name, uint64_t count);
+
+// Distribution metrics keep min/mean/p50/p90/p99/p99.9/max, not just one value
+void report_add_distribution_metric(test_report_t *report, const char *metric_name, metric_type_t type,
+                                    const report_distribution_t *distribution, const char *units);
+void report_add_histogram_metric(test_report_t *report, const char *metric_name,
+                                 const report_histogram_t *histogram);
+
+// Replays an entry recorded elsewhere (e.g. a binary log) with its own
+// timestamp; histogram, if given, travels with the metric
+void report_import_test_result(test_report_t *report, const test_result_entry_t *entry);
+void report_import_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                          const report_histogram_t *histogram);
+
+// Run environment; setting an existing name replaces its value
+void report_set_property(test_report_t *report, const char *name, const char *value);
 
-// Report generation
+// Report generation; an end_time set beforehand is kept
 bool report_generate(test_report_t *report);
 bool report_generate_summary(test_report_t *report);
 void report_print_summary(test_report_t *report, FILE *output);
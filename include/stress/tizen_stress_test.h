@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef TIZEN_STRESS_TEST_H
+#define TIZEN_STRESS_TEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tizen_drm_test.h"
+#include "audio/audio_stream.h"
+#include "video/video_stream.h"
+#include "common/rt_thread.h"
+
+#define STRESS_DEFAULT_DURATION 30   // seconds per phase
+#define STRESS_FLIP_RING_SIZE 3
+
+// Workloads run alone and then all at once
+typedef enum {
+    STRESS_WORKLOAD_SCANOUT,         // Atomic page flips on the primary plane
+    STRESS_WORKLOAD_CAPTURE,         // V4L2 streaming capture
+    STRESS_WORKLOAD_PLAYBACK,        // ALSA mmap playback
+    STRESS_WORKLOAD_MAX
+} stress_workload_t;
+
+#define STRESS_WORKLOAD_BIT(w) (1u << (w))
+#define STRESS_WORKLOAD_ALL (STRESS_WORKLOAD_BIT(STRESS_WORKLOAD_MAX) - 1)
+
+typedef struct {
+    uint32_t duration;               // Seconds each phase runs for
+    uint32_t workloads;              // STRESS_WORKLOAD_BIT() mask
+    test_config_t scanout;           // 32bpp RGB; flips run at mode size
+    uint32_t video_device;
+    video_test_config_t capture;
+    uint32_t audio_device;
+    audio_test_config_t playback;
+    const rt_config_t *rt;           // Optional; each workload gets its own thread
+} stress_config_t;
+
+// One workload over one phase
+typedef struct {
+    bool ran;
+    bool passed;
+    uint32_t duration_ms;
+    drm_flip_stats_t flip;
+    video_stream_stats_t video;
+    audio_stream_stats_t audio;
+} stress_run_t;
+
+// Contended figures against the same workload running alone; positive
+// numbers are always worse
+typedef struct {
+    double flip_fps_drop_pct;
+    double flip_p99_increase_ms;
+    double flip_max_increase_ms;
+    double capture_fps_drop_pct;
+    double capture_drop_rate_alone;      // Dropped frames per second
+    double capture_drop_rate_combined;
+    double playback_xrun_rate_alone;     // Underruns per minute
+    double playback_xrun_rate_combined;
+    double playback_wakeup_increase_ms;
+} stress_degradation_t;
+
+typedef struct {
+    stress_run_t alone[STRESS_WORKLOAD_MAX];
+    stress_run_t combined[STRESS_WORKLOAD_MAX];
+    stress_degradation_t degradation;
+} stress_stats_t;
+
+// Needs init_test_framework(); the audio and video frameworks are taken
+// for the duration of the run
+bool test_concurrent_stress(const stress_config_t *config, stress_stats_t *stats);
+
+const char *stress_workload_to_string(stress_workload_t workload);
+
+#endif /* TIZEN_STRESS_TEST_H */
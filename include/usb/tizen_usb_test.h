@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "usb_discovery.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,9 +51,10 @@ typedef struct {
     bool run_wireless_tests;
     
     // Device identification
-    const char *test_device_path;  // Path to USB device (e.g., /dev/bus/usb/...)
+    const char *test_device_path;  // Path to USB device (e.g., /dev/sdb), NULL to use the discovered disk
     uint16_t vendor_id;           // USB vendor ID (0 for any)
     uint16_t product_id;          // USB product ID (0 for any)
+    const usb_device_entry_t *device; // The one device to test, NULL to find one by VID/PID
 } usb_test_config_t;
 
 /**
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef USB_DISCOVERY_H
+#define USB_DISCOVERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define USB_DISCOVERY_MAX_DEVICES 32
+#define USB_DISCOVERY_MAX_INTERFACES 8
+#define USB_DISCOVERY_ARRIVAL_WAIT_MS 5000 // For a device that is re-enumerating
+#define USB_DISCOVERY_RESCAN_MS 500        // Polling interval without hotplug support
+
+// One physical port's device. Slots are keyed by port path and never
+// reused for another port, so an index stays valid across replugs.
+typedef struct {
+    bool present;
+    uint32_t generation;               // Bumped on every arrival in this slot
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t device_class;              // bDeviceClass, 0 when classes are per interface
+    uint8_t interface_classes[USB_DISCOVERY_MAX_INTERFACES];
+    uint8_t interface_count;
+    uint8_t bus;
+    uint8_t address;
+    char port_path[32];                // sysfs name, e.g. 1-2.3
+    char sysfs_path[64];               // /sys/bus/usb/devices/1-2.3
+    char dev_node[32];                 // /dev/bus/usb/001/005
+    char block_node[32];               // /dev/sdX once a storage driver bound, else empty
+} usb_device_entry_t;
+
+// Reference counted; the first start registers the hotplug callback (or
+// scans once where libusb has no hotplug support) and the event thread.
+// Later starts return once that first enumeration is in the cache. Needs
+// libusb_init(NULL) first.
+bool usb_discovery_start(void);
+void usb_discovery_stop(void);
+
+// Slots ever used; usb_discovery_get() fails for ones whose device is gone
+uint32_t usb_discovery_count(void);
+bool usb_discovery_get(uint32_t index, usb_device_entry_t *entry);
+
+// The present device at this bus address. Addresses are reassigned on
+// every replug, so this finds a snapshotted entry again only while it is
+// the same attachment, whatever slot it lands in after a restart.
+bool usb_discovery_get_at(uint8_t bus, uint8_t address, usb_device_entry_t *entry);
+
+// First present device matching; 0 for vendor_id, product_id or
+// device_class matches anything. device_class matches bDeviceClass or any
+// interface class.
+bool usb_discovery_find(uint16_t vendor_id, uint16_t product_id, uint8_t device_class,
+                        usb_device_entry_t *entry);
+
+// As usb_discovery_find(), waiting up to timeout_ms for a match to arrive
+bool usb_discovery_wait(uint16_t vendor_id, uint16_t product_id, uint8_t device_class,
+                        uint32_t timeout_ms, usb_device_entry_t *entry);
+
+bool usb_device_has_class(const usb_device_entry_t *entry, uint8_t device_class);
+
+#endif /* USB_DISCOVERY_H */
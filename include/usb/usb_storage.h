@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef USB_STORAGE_H
+#define USB_STORAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "report/report_timing.h"
+
+#define USB_STORAGE_DEFAULT_BLOCK_SIZE 65536
+#define USB_STORAGE_DEFAULT_QUEUE_DEPTH 8
+#define USB_STORAGE_MAX_QUEUE_DEPTH 64
+#define USB_STORAGE_DEFAULT_DURATION 5     // seconds per run
+
+typedef enum {
+    USB_STORAGE_SG_IO,             // READ(10)/READ(16) through the sg node
+    USB_STORAGE_IO_URING,          // O_DIRECT block reads
+    USB_STORAGE_AIO                // O_DIRECT block reads, kernels without io_uring
+} usb_storage_engine_t;
+
+typedef enum {
+    USB_STORAGE_SEQUENTIAL,
+    USB_STORAGE_RANDOM
+} usb_storage_pattern_t;
+
+typedef struct {
+    const char *device_path;       // Block device (/dev/sdX) or its sg node (/dev/sgN)
+    uint32_t block_size;           // Bytes per request, a multiple of the logical block
+    uint32_t queue_depth;          // Requests kept in flight
+    uint32_t duration;             // Seconds per run
+} usb_storage_config_t;
+
+typedef struct {
+    usb_storage_engine_t engine;   // What actually ran
+    usb_storage_pattern_t pattern;
+    uint32_t block_size;
+    uint32_t queue_depth;          // After the engine's own limit
+    uint64_t requests;             // Completed without error
+    uint64_t bytes;
+    uint64_t read16;               // Requests past READ(10)'s 2 TiB reach
+    uint32_t errors;
+    double mbps;                   // 10^6 bytes per second
+    double iops;
+    report_histogram_t latency;    // Submission to completion
+} usb_storage_stats_t;
+
+// Logical block count and size from READ CAPACITY(10), or (16) when the
+// device is too large for it
+bool usb_storage_capacity(const char *device_path, uint64_t *blocks, uint32_t *logical_block_size);
+
+// SCSI reads issued asynchronously through the sg v3 write()/read()
+// interface, so queue_depth commands are really outstanding
+bool usb_storage_bench_sg(const usb_storage_config_t *config, usb_storage_pattern_t pattern,
+                          usb_storage_stats_t *stats);
+
+// O_DIRECT reads of the block device through io_uring, falling back to
+// Linux AIO where io_uring is missing or disabled
+bool usb_storage_bench_block(const usb_storage_config_t *config, usb_storage_pattern_t pattern,
+                             usb_storage_stats_t *stats);
+
+const char *usb_storage_engine_name(usb_storage_engine_t engine);
+const char *usb_storage_pattern_name(usb_storage_pattern_t pattern);
+
+#endif /* USB_STORAGE_H */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef USB_TRANSFER_H
+#define USB_TRANSFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "report/report_timing.h"
+
+#define USB_TRANSFER_MAX_TARGETS 16
+#define USB_TRANSFER_DEFAULT_DEPTH 4       // Transfers in flight per endpoint
+#define USB_TRANSFER_ISO_PACKETS 8         // Packets per isochronous transfer
+#define USB_TRANSFER_BULK_SIZE 65536
+#define USB_TRANSFER_DEFAULT_DURATION 5    // seconds
+
+struct libusb_device;
+
+typedef enum {
+    USB_ENDPOINT_ISOCHRONOUS = 1,          // Values match the descriptor's bmAttributes
+    USB_ENDPOINT_BULK = 2,
+    USB_ENDPOINT_INTERRUPT = 3
+} usb_endpoint_type_t;
+
+// One endpoint on one device, found by usb_transfer_find()
+typedef struct {
+    struct libusb_device *device;          // Referenced until usb_transfer_release()
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t bus;
+    uint8_t address;
+    uint8_t interface;
+    uint8_t alt_setting;                   // Isochronous endpoints live on a non-zero alt
+    uint8_t endpoint;                      // Address, bit 7 set for IN
+    usb_endpoint_type_t type;
+    uint32_t max_packet;                   // Bytes per service interval, high-bandwidth included
+    uint32_t interval_us;                  // Service interval at the device's speed
+} usb_transfer_target_t;
+
+typedef struct {
+    uint32_t depth;                        // Transfers kept in flight per endpoint
+    uint32_t iso_packets;                  // Packets per isochronous transfer
+    uint32_t bulk_size;                    // Bytes per bulk transfer
+    uint32_t duration;                     // Seconds
+} usb_transfer_config_t;
+
+typedef struct {
+    uint64_t transfers;                    // Completed transfers
+    uint64_t bytes;
+    uint64_t packets;                      // Isochronous packets completed
+    uint64_t missed_packets;               // Isochronous packets the host controller dropped
+    uint32_t errors;                       // Stalls, overflows and failed submissions
+    double bytes_per_sec;
+    double expected_bytes_per_sec;         // Isochronous: max_packet every interval
+    double jitter_us;                      // Std deviation of the interval between reports
+    report_histogram_t interval;           // Time between completions that carried data
+    bool disconnected;
+} usb_transfer_stats_t;
+
+// Up to max endpoints of the given type on interfaces of interface_class
+// (and, unless it is 0xFF, subclass; audio streaming is 0x01/0x02), one per
+// device. Interrupt and bulk endpoints are IN only; isochronous ones may be
+// OUT (a speaker), which is fed silence. vendor_id/product_id of 0 match
+// anything, as do bus/address of 0; a bound device passes its own pair so
+// an identical gadget on another port is left alone.
+uint32_t usb_transfer_find(uint8_t interface_class, uint8_t interface_subclass, usb_endpoint_type_t type,
+                           uint16_t vendor_id, uint16_t product_id, uint8_t bus, uint8_t address,
+                           usb_transfer_target_t *targets, uint32_t max);
+void usb_transfer_release(usb_transfer_target_t *targets, uint32_t count);
+
+// Claims every target's interface (detaching its kernel driver for the
+// run), keeps config->depth transfers in flight on each from one libusb
+// event thread, and reports per target. Stalled endpoints are cleared and
+// resumed from the calling thread. Runs on different devices may overlap.
+// Returns false only if nothing could be started.
+bool usb_transfer_run(const usb_transfer_target_t *targets, uint32_t count,
+                      const usb_transfer_config_t *config, usb_transfer_stats_t *stats);
+
+const char *usb_endpoint_type_name(usb_endpoint_type_t type);
+
+#endif /* USB_TRANSFER_H */
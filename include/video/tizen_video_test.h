@@ -21,6 +21,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "common/map_bandwidth.h"
 
 // Video formats
 typedef enum {
@@ -139,23 +140,20 @@ bool test_video_decoding(uint32_t device_index, const video_test_config_t *confi
 bool test_video_format_support(uint32_t device_index, const video_test_config_t *config);
 bool test_video_resolution(uint32_t device_index, const video_test_config_t *config);
 bool test_video_framerates(uint32_t device_index, const video_test_config_t *config);
-bool test_video_conversion(uint32_t device_index, const video_test_config_t *config, video_format_t target_format);
-bool test_video_scaling(uint32_t device_index, const video_test_config_t *config, uint32_t target_width, uint32_t target_height);
-bool test_video_rotation(uint32_t device_index, const video_test_config_t *config, uint32_t rotation_angle);
 bool test_video_compression(uint32_t device_index, const video_test_config_t *config);
 bool test_video_streaming(uint32_t device_index, const video_test_config_t *config);
 bool test_video_sync(uint32_t device_index, const video_test_config_t *config);
 
 // Performance testing
 bool test_video_capture_performance(uint32_t device_index, const video_test_config_t *config, uint32_t *avg_fps);
-bool test_video_encoding_performance(uint32_t device_index, const video_test_config_t *config, uint32_t *avg_fps);
-bool test_video_decoding_performance(uint32_t device_index, const video_test_config_t *config, uint32_t *avg_fps);
+bool test_video_buffer_bandwidth(uint32_t device_index, const video_test_config_t *config, map_bandwidth_t *result);
 
 // Comprehensive testing
 bool test_all_video_features(uint32_t device_index, const video_test_config_t *config);
 
 // Utilities
 const char *video_format_to_string(video_format_t format);
+uint32_t video_format_to_v4l2(video_format_t format);
 const char *video_device_type_to_string(video_device_type_t type);
 const char *video_feature_to_string(video_feature_t feature);
 video_test_result_t convert_bool_to_test_result(bool result);
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef VIDEO_CODEC_H
+#define VIDEO_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "video/tizen_video_test.h"
+#include "report/report_timing.h"
+
+#define VIDEO_CODEC_DEFAULT_BITRATE 4000000    // bits/s when config->bitrate is 0
+#define VIDEO_CODEC_BITSTREAM_BUFFER (2 * 1024 * 1024)
+
+// Encoder or decoder run through a mem-to-mem device
+typedef struct {
+    video_format_t codec;
+    uint32_t device_index;         // Node that ran it, which need not be the one asked for
+    uint32_t width;
+    uint32_t height;
+    uint32_t frames;               // Frames out of the CAPTURE queue
+    uint32_t output_buffers;       // Granted per queue
+    uint32_t capture_buffers;
+    double fps;                    // First queue to last dequeue
+    report_histogram_t latency;    // OUTPUT queue to the CAPTURE dequeue carrying its timestamp
+    uint64_t bytes;                // Bitstream produced (encode) or fed (decode)
+    uint32_t target_bitrate;       // bits/s asked for; 0 when decoding
+    double bitrate;                // bits/s at the nominal framerate
+    double bitrate_error;          // (bitrate - target) / target
+    uint32_t keyframes;
+    uint32_t errors;               // Buffers the driver flagged V4L2_BUF_FLAG_ERROR
+} video_codec_stats_t;
+
+// Elementary stream mapped from a file: Annex B H.264/H.265 split into
+// access units, or VP8/VP9 frames from an IVF container
+typedef struct {
+    video_format_t codec;
+    uint32_t width;                // From the IVF header; 0 for Annex B
+    uint32_t height;
+    const uint8_t *data;
+    size_t size;
+    size_t offset;                 // Start of the next frame
+    size_t map_size;
+} video_bitstream_t;
+
+bool video_bitstream_open(const char *path, video_bitstream_t *stream);
+void video_bitstream_close(video_bitstream_t *stream);
+// The next frame or access unit; false at the end of the stream
+bool video_bitstream_next(video_bitstream_t *stream, const uint8_t **frame, size_t *size);
+
+// Index of a mem-to-mem node that encodes (or decodes) codec: device_index
+// itself or, with scan, the first of /dev/video0..15 that does
+bool video_codec_find(uint32_t device_index, video_format_t codec, bool encoder, bool scan, uint32_t *found);
+
+// Encodes config->duration seconds of a moving test image at
+// config->framerate and config->bitrate, as fast as the device goes
+bool test_video_encoding_performance(uint32_t device_index, const video_test_config_t *config,
+                                     video_format_t codec, video_codec_stats_t *stats);
+// Decodes the whole of input_path
+bool test_video_decoding_performance(uint32_t device_index, const video_test_config_t *config,
+                                     const char *input_path, video_codec_stats_t *stats);
+
+#endif /* VIDEO_CODEC_H */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef VIDEO_CONVERT_H
+#define VIDEO_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "video/tizen_video_test.h"
+#include "common/test_pattern.h"
+
+#define VIDEO_CONVERT_MAX_PLANES 3
+#define VIDEO_CONVERT_BENCH_MS 500     // Minimum timed run per path
+#define VIDEO_CONVERT_MIN_PSNR 30.0    // dB; hardware output below this fails
+
+// A raw frame. Planes follow the V4L2 single-buffer layouts:
+// - RGB565 is little-endian 5:6:5, RGB888 bytes R G B, RGBA8888 bytes
+//   R G B A, ARGB8888 bytes A R G B.
+// - NV12 is a Y plane then interleaved UV at half size.
+// - YUV420 and YUV422 are Y, U and V planes, with chroma at half width
+//   (and half height for 4:2:0).
+// - YUYV and UYVY are packed 4:2:2.
+// YUV is BT.601 limited range.
+typedef struct {
+    video_format_t format;
+    uint32_t width;
+    uint32_t height;
+    uint8_t *planes[VIDEO_CONVERT_MAX_PLANES];
+    uint32_t strides[VIDEO_CONVERT_MAX_PLANES];
+    uint32_t plane_count;
+    size_t size;                   // Bytes from planes[0] to the end of the last plane
+    void *allocation;              // Owned by video_frame_alloc(), otherwise NULL
+} video_frame_t;
+
+typedef enum {
+    VIDEO_SCALE_BILINEAR,          // 2x2 taps on pixel centres
+    VIDEO_SCALE_AREA,              // Exact box coverage; best for downscaling
+    VIDEO_SCALE_MAX
+} video_scale_filter_t;
+
+// Reference path against an optional mem-to-mem device on the same job
+typedef struct {
+    uint32_t cpu_frames;
+    double cpu_mpix_per_sec;       // Output megapixels per second
+    double reference_psnr_db;      // Result taken back to the source, vs the source
+    bool hardware;                 // The device ran the same operation
+    uint32_t hw_frames;
+    double hw_mpix_per_sec;
+    double hw_psnr_db;             // Device output vs the reference output
+    pattern_isa_t isa;             // Kernels the reference ran with
+    uint32_t threads;              // Workers the reference ran on
+} video_convert_stats_t;
+
+// Frames
+bool video_format_is_raw(video_format_t format);
+size_t video_frame_size(video_format_t format, uint32_t width, uint32_t height, uint32_t stride);
+// Lays a frame over caller memory; stride 0 packs the rows
+bool video_frame_wrap(video_frame_t *frame, video_format_t format, uint32_t width, uint32_t height,
+                      void *data, uint32_t stride);
+bool video_frame_alloc(video_frame_t *frame, video_format_t format, uint32_t width, uint32_t height);
+void video_frame_free(video_frame_t *frame);
+// Copies the visible rows between two frames of the same format and size
+bool video_frame_copy(video_frame_t *dst, const video_frame_t *src);
+// Gradients, colour bars and fine detail, so filters and chroma siting show
+bool video_frame_fill_test_image(video_frame_t *frame);
+
+// Reference operations. Every one converts to dst->format on the way, and
+// runs in horizontal bands on the convert worker count.
+bool video_convert_frame(const video_frame_t *src, video_frame_t *dst);
+bool video_scale_frame(const video_frame_t *src, video_frame_t *dst, video_scale_filter_t filter);
+// Clockwise; dst is width x height swapped for 90 and 270
+bool video_rotate_frame(const video_frame_t *src, video_frame_t *dst, uint32_t angle);
+
+// Over the colour planes, in the frames' own colour space; INFINITY when
+// identical, negative if the frames cannot be compared
+double video_frame_psnr(const video_frame_t *a, const video_frame_t *b);
+
+// 0 (default): one per online CPU
+void video_convert_set_threads(uint32_t threads);
+// The 128-bit kernels back every wider pattern ISA
+pattern_isa_t video_convert_isa(void);
+
+// Benchmarks the reference from config->format at config's size, and the
+// same operation on device_index when it is a mem-to-mem device
+bool test_video_conversion(uint32_t device_index, const video_test_config_t *config, video_format_t target_format,
+                           video_convert_stats_t *stats);
+bool test_video_scaling(uint32_t device_index, const video_test_config_t *config, uint32_t target_width,
+                        uint32_t target_height, video_scale_filter_t filter, video_convert_stats_t *stats);
+bool test_video_rotation(uint32_t device_index, const video_test_config_t *config, uint32_t rotation_angle,
+                         video_convert_stats_t *stats);
+
+const char *video_scale_filter_to_string(video_scale_filter_t filter);
+
+#endif /* VIDEO_CONVERT_H */
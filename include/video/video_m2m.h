@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef VIDEO_M2M_H
+#define VIDEO_M2M_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "common/trace.h"
+
+#define VIDEO_M2M_MAX_BUFFERS 32
+#define VIDEO_M2M_DEFAULT_BUFFERS 4   // Per queue; enough to keep most codecs busy
+#define VIDEO_M2M_MAX_DEVICES 16      // /dev/video0..15 are searched
+
+typedef struct {
+    void *map;
+    size_t length;
+    bool queued;                   // Owned by the driver
+} video_m2m_buffer_t;
+
+// One side of the device: OUTPUT carries data into it, CAPTURE carries
+// results out. Formats are single-plane in both APIs.
+typedef struct {
+    uint32_t type;                 // V4L2_BUF_TYPE_VIDEO_{OUTPUT,CAPTURE}[_MPLANE]
+    uint32_t fourcc;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytesperline;
+    uint32_t sizeimage;            // Of the first plane
+    uint32_t planes;               // Per buffer; only the first is mapped
+    uint32_t count;                // Buffers granted
+    bool streaming;
+    video_m2m_buffer_t buffers[VIDEO_M2M_MAX_BUFFERS];
+} video_m2m_queue_t;
+
+typedef struct {
+    int fd;
+    uint32_t device_index;
+    bool mplane;
+    uint32_t timeout_ms;
+    video_m2m_queue_t output;
+    video_m2m_queue_t capture;
+    uint32_t trace_id;             // Session name in a trace; 0 if not recorded
+} video_m2m_t;
+
+// A buffer handed back by the driver
+typedef struct {
+    uint32_t index;
+    uint32_t bytesused;
+    uint32_t flags;                // V4L2_BUF_FLAG_*
+    uint64_t timestamp_us;         // Copied from OUTPUT to CAPTURE by the device
+} video_m2m_done_t;
+
+// Opens /dev/videoN if it is a mem-to-mem device. Others fail quietly.
+bool video_m2m_open(uint32_t device_index, uint32_t timeout_ms, video_m2m_t *m2m);
+void video_m2m_close(video_m2m_t *m2m);
+
+// Starting with device_index, the first mem-to-mem device whose OUTPUT side
+// takes output_fourcc and whose CAPTURE side produces capture_fourcc; 0
+// matches anything
+bool video_m2m_find(uint32_t device_index, uint32_t output_fourcc, uint32_t capture_fourcc,
+                    uint32_t timeout_ms, video_m2m_t *m2m);
+bool video_m2m_has_format(const video_m2m_t *m2m, const video_m2m_queue_t *queue, uint32_t fourcc);
+
+// S_FMT. Fails if the fourcc changes or, when exact, the size does; a
+// width or height of 0 leaves the size to the driver. sizeimage 0 lets the
+// driver size the buffers, which coded queues usually should not.
+bool video_m2m_set_format(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t fourcc, uint32_t width,
+                          uint32_t height, uint32_t sizeimage, bool exact);
+// Re-reads the queue's format, e.g. after a decoder's source change
+bool video_m2m_get_format(video_m2m_t *m2m, video_m2m_queue_t *queue);
+bool video_m2m_set_control(video_m2m_t *m2m, uint32_t id, int32_t value);
+bool video_m2m_get_control(video_m2m_t *m2m, uint32_t id, int32_t *value);
+// Nominal rate of the OUTPUT stream, which encoders budget bits against
+bool video_m2m_set_framerate(video_m2m_t *m2m, uint32_t fps);
+bool video_m2m_subscribe(video_m2m_t *m2m, uint32_t event_type);
+// True with the oldest pending event's type, false if none is pending
+bool video_m2m_next_event(video_m2m_t *m2m, uint32_t *event_type);
+// V4L2_ENC_CMD_STOP or V4L2_DEC_CMD_STOP: the device finishes what is
+// queued and flags its last CAPTURE buffer
+bool video_m2m_stop(video_m2m_t *m2m, bool encoder);
+
+// Requests and maps up to count buffers; count 0 releases them
+bool video_m2m_alloc(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t count);
+bool video_m2m_stream(video_m2m_t *m2m, video_m2m_queue_t *queue, bool on);
+bool video_m2m_queue(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t index, uint32_t bytesused,
+                     uint64_t timestamp_us);
+// 1 with a buffer in done, 0 when none is ready, -1 on error. errno is
+// EPIPE once the buffer flagged last has been dequeued.
+int video_m2m_dequeue(video_m2m_t *m2m, video_m2m_queue_t *queue, video_m2m_done_t *done);
+// Index of a buffer the driver does not hold, or -1
+int video_m2m_free_buffer(const video_m2m_queue_t *queue);
+// Polls until a buffer or event is ready and returns the poll events;
+// 0 on timeout, -1 on error
+int video_m2m_wait(video_m2m_t *m2m);
+
+const char *video_m2m_fourcc_to_string(uint32_t fourcc, char buffer[5]);
+
+// Trace replayer for the V4L2 ops. Sessions are reopened on the recorded
+// device index, and OUTPUT payloads are copied from the trace mapping
+// into the buffer before it is queued, outside the timed span.
+bool video_m2m_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns);
+void video_m2m_trace_finish(void *context);
+
+#endif /* VIDEO_M2M_H */
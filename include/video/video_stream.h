@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef VIDEO_STREAM_H
+#define VIDEO_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "video/tizen_video_test.h"
+#include "common/sweep.h"
+
+// Streaming engine defaults
+#define VIDEO_STREAM_BUFFERS 8
+#define VIDEO_STREAM_DEFAULT_DURATION 10   // seconds
+#define VIDEO_SWEEP_DURATION 2             // seconds per sweep point
+
+// Sustained capture statistics, from buffer sequence numbers and timestamps
+typedef struct {
+    uint32_t frames;               // Frames dequeued
+    uint32_t dropped_frames;       // Gaps in the driver's sequence numbers
+    uint32_t buffers;              // Buffers the driver granted
+    double avg_fps;                // Over the whole run
+    double low_1pct_fps;           // Average rate of the slowest 1% of intervals
+    double jitter_ms;              // Standard deviation of the frame interval
+    double max_interval_ms;        // Longest gap between frames
+    bool monotonic_timestamps;     // Driver timestamps, not dequeue times
+    bool adjusted;                 // S_FMT changed the requested format or size
+} video_stream_stats_t;
+
+// Keeps every buffer queued and dequeues with poll() for config->duration
+// seconds
+bool test_video_stream(uint32_t device_index, const video_test_config_t *config, video_stream_stats_t *stats);
+
+// Sweep point context; every point streams with config's framerate and
+// timeout for VIDEO_SWEEP_DURATION seconds
+typedef struct {
+    uint32_t device_index;
+    video_test_config_t config;
+} video_sweep_context_t;
+
+// Format x size from the device's reported formats and the common capture
+// sizes inside its limits; the point function reports average FPS
+bool video_sweep_init(sweep_t *sweep, uint32_t device_index, const video_test_config_t *base);
+bool video_sweep_stream_fps(void *context, const sweep_point_t *point, double *value);
+
+#endif /* VIDEO_STREAM_H */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef VIDEO_ZERO_COPY_H
+#define VIDEO_ZERO_COPY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "video/tizen_video_test.h"
+
+// Zero-copy capture modes
+typedef enum {
+    VIDEO_ZERO_COPY_DMABUF_IMPORT,  // DRM buffers captured into (V4L2_MEMORY_DMABUF)
+    VIDEO_ZERO_COPY_EXPBUF,         // V4L2 buffers scanned out by DRM (VIDIOC_EXPBUF)
+    VIDEO_ZERO_COPY_MAX
+} video_zero_copy_mode_t;
+
+// Camera-to-display statistics
+typedef struct {
+    uint32_t frames_captured;      // Frames dequeued from the capture device
+    uint32_t frames_displayed;     // Frames that reached the screen
+    uint32_t frames_skipped;       // Frames superseded before a flip was free
+    uint64_t copies_avoided;       // Frame copies a CPU path would have made
+    uint64_t bytes_not_copied;     // Bytes those copies would have moved
+    double latency_avg_ms;         // Capture timestamp to scanout vblank
+    double latency_p99_ms;
+    double latency_max_ms;
+} video_zero_copy_stats_t;
+
+// Streams config->iterations frames from the capture device to the primary
+// plane without CPU copies. The DRM test framework must be initialized.
+bool test_video_zero_copy(uint32_t device_index, const video_test_config_t *config,
+                          video_zero_copy_mode_t mode, video_zero_copy_stats_t *stats);
+const char *video_zero_copy_mode_to_string(video_zero_copy_mode_t mode);
+
+#endif /* VIDEO_ZERO_COPY_H */
@@ -3,6 +3,8 @@
 # Configuration
 TARGET="linux"
 DEBUG="false"
+BENCH="false"
+BENCH_BASELINE=""
 
 # Colors for output
 RED="\033[0;31m"
@@ -35,6 +37,8 @@ function usage() {
     echo "Options:"
     echo "  --target <target>    Target to build for (linux|tizen8|tizen9)"
     echo "  --debug              Build with debug symbols"
+    echo "  --bench [baseline]   Also run the framework microbenchmarks, failing on"
+    echo "                       a regression against the given baseline"
     echo "  --help               Show this help message"
     exit 0
 }
@@ -50,6 +54,14 @@ function parse_args() {
                 DEBUG="true"
                 shift
                 ;;
+            --bench)
+                BENCH="true"
+                if [[ -n $2 && $2 != --* ]]; then
+                    BENCH_BASELINE="$2"
+                    shift
+                fi
+                shift
+                ;;
             --help)
                 usage
                 ;;
@@ -142,6 +154,25 @@ function run_tests() {
     print_success "Tests completed successfully"
 }
 
+function run_benchmarks() {
+    local target=$1
+    local args=""
+    if [[ -n $BENCH_BASELINE ]]; then
+        args="--baseline=$BENCH_BASELINE"
+    fi
+    
+    print_info "Running benchmarks on $target"
+    
+    if [[ $target == "linux" ]]; then
+        make bench || print_error "Benchmark build failed"
+        ./test_bench $args || print_error "Benchmarks regressed"
+    else
+        sdb shell "/usr/bin/test_bench $args" || print_error "Benchmarks regressed"
+    fi
+    
+    print_success "Benchmarks completed successfully"
+}
+
 function main() {
     parse_args "$@"
     
@@ -160,6 +191,11 @@ function main() {
     
     # Run tests
     run_tests $TARGET
+    
+    # Run benchmarks
+    if [ "$BENCH" = "true" ]; then
+        run_benchmarks $TARGET
+    fi
 }
 
 main "$@"
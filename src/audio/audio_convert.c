@@ -0,0 +1,903 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "audio/audio_convert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIO_HAVE_X86 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && (!defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define AUDIO_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Samples pass through left-justified int32 in AUDIO_CONVERT_CHUNK pieces,
+// so a conversion between any two formats stays in L1
+#define AUDIO_CONVERT_CHUNK 1024
+#define RESAMPLE_ROLLOFF 0.90              // Passband edge, as a fraction of the lower Nyquist rate
+#define RESAMPLE_KAISER_BETA 8.0           // About 80 dB of stopband
+#define TONE_BASE_HZ 997.0                 // Channel c plays TONE_BASE_HZ * (1 + c / 2)
+#define TONE_AMPLITUDE 0.89                // -1 dBFS
+
+// Float samples scale by 2^31; the largest float below 2^31 is the top clip
+#define FLOAT_TO_S32_SCALE 2147483648.0f
+#define FLOAT_S32_MAX 2147483520.0f
+#define FLOAT_S32_MIN -2147483648.0f
+
+// 16- and 32-bit loads and stores, with an optional byte swap for the
+// big-endian formats, float conversion and the filter's dot product.
+// Narrowing rounds half up, ((x >> 15) + 1) >> 1 for S16, and saturates.
+typedef struct {
+    void (*s16_to_s32)(const uint8_t *src, int32_t *dst, size_t count, bool swap);
+    void (*s32_to_s16)(const int32_t *src, uint8_t *dst, size_t count, bool swap);
+    void (*load_s32)(const uint8_t *src, int32_t *dst, size_t count, bool swap);
+    void (*store_s32)(const int32_t *src, uint8_t *dst, size_t count, bool swap);
+    void (*s32_to_float)(const int32_t *src, float *dst, size_t count);
+    void (*float_to_s32)(const float *src, int32_t *dst, size_t count);
+    // count is a multiple of 4; lanes are summed as (0 + 2) + (1 + 3)
+    float (*dot)(const float *a, const float *b, size_t count);
+} audio_kernels_t;
+
+static inline uint16_t load_u16(const uint8_t *p, bool swap) {
+    return swap ? (uint16_t)((p[0] << 8) | p[1]) : (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void store_u16(uint8_t *p, uint16_t v, bool swap) {
+    p[swap ? 1 : 0] = (uint8_t)v;
+    p[swap ? 0 : 1] = (uint8_t)(v >> 8);
+}
+
+static void s16_to_s32_scalar(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)((uint32_t)load_u16(src + 2 * i, swap) << 16);
+    }
+}
+
+static void s32_to_s16_scalar(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = ((src[i] >> 15) + 1) >> 1;
+        store_u16(dst + 2 * i, (uint16_t)(v > INT16_MAX ? INT16_MAX : v), swap);
+    }
+}
+
+static void load_s32_scalar(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = src + 4 * i;
+        uint32_t v = swap ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]
+                          : ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+        dst[i] = (int32_t)v;
+    }
+}
+
+static void store_s32_scalar(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = (uint32_t)src[i];
+        uint8_t *p = dst + 4 * i;
+        for (int b = 0; b < 4; b++) {
+            p[swap ? 3 - b : b] = (uint8_t)(v >> (8 * b));
+        }
+    }
+}
+
+static void s32_to_float_scalar(const int32_t *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)src[i] * (1.0f / FLOAT_TO_S32_SCALE);
+    }
+}
+
+static void float_to_s32_scalar(const float *src, int32_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float v = src[i] * FLOAT_TO_S32_SCALE;
+        v = v > FLOAT_S32_MAX ? FLOAT_S32_MAX : v < FLOAT_S32_MIN ? FLOAT_S32_MIN : v;
+        dst[i] = (int32_t)lrintf(v);
+    }
+}
+
+static float dot_scalar(const float *a, const float *b, size_t count) {
+    float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0; i < count; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            acc[lane] += a[i + lane] * b[i + lane];
+        }
+    }
+    return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+}
+
+static const audio_kernels_t scalar_kernels = {
+    s16_to_s32_scalar, s32_to_s16_scalar, load_s32_scalar, store_s32_scalar,
+    s32_to_float_scalar, float_to_s32_scalar, dot_scalar
+};
+
+#ifdef AUDIO_HAVE_X86
+static inline __m128i swap16_sse2(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static inline __m128i swap32_sse2(__m128i v) {
+    return swap16_sse2(_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1));
+}
+
+static void s16_to_s32_sse2(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        if (swap) {
+            v = swap16_sse2(v);
+        }
+        // Interleaving zeros below each sample shifts it into the top half
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(zero, v));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(zero, v));
+    }
+    s16_to_s32_scalar(src + 2 * i, dst + i, count - i, swap);
+}
+
+static inline __m128i round_s16_sse2(__m128i v) {
+    const __m128i one = _mm_set1_epi32(1);
+    return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(v, 15), one), 1);
+}
+
+static void s32_to_s16_sse2(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = round_s16_sse2(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m128i hi = round_s16_sse2(_mm_loadu_si128((const __m128i *)(src + i + 4)));
+        __m128i v = _mm_packs_epi32(lo, hi);
+        if (swap) {
+            v = swap16_sse2(v);
+        }
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), v);
+    }
+    s32_to_s16_scalar(src + i, dst + 2 * i, count - i, swap);
+}
+
+static void load_s32_sse2(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        _mm_storeu_si128((__m128i *)(dst + i), swap ? swap32_sse2(v) : v);
+    }
+    load_s32_scalar(src + 4 * i, dst + i, count - i, swap);
+}
+
+static void store_s32_sse2(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), swap ? swap32_sse2(v) : v);
+    }
+    store_s32_scalar(src + i, dst + 4 * i, count - i, swap);
+}
+
+static void s32_to_float_sse2(const int32_t *src, float *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / FLOAT_TO_S32_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(v, scale));
+    }
+    s32_to_float_scalar(src + i, dst + i, count - i);
+}
+
+static void float_to_s32_sse2(const float *src, int32_t *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(FLOAT_TO_S32_SCALE);
+    const __m128 max = _mm_set1_ps(FLOAT_S32_MAX);
+    const __m128 min = _mm_set1_ps(FLOAT_S32_MIN);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        v = _mm_max_ps(_mm_min_ps(v, max), min);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_cvtps_epi32(v));
+    }
+    float_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+static float dot_sse2(const float *a, const float *b, size_t count) {
+    __m128 acc = _mm_setzero_ps();
+    for (size_t i = 0; i < count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    __m128 pairs = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+static const audio_kernels_t sse2_kernels = {
+    s16_to_s32_sse2, s32_to_s16_sse2, load_s32_sse2, store_s32_sse2,
+    s32_to_float_sse2, float_to_s32_sse2, dot_sse2
+};
+#endif /* AUDIO_HAVE_X86 */
+
+#ifdef AUDIO_HAVE_NEON
+static void s16_to_s32_neon(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t bytes = vld1q_u8(src + 2 * i);
+        int16x8_t v = vreinterpretq_s16_u8(swap ? vrev16q_u8(bytes) : bytes);
+        vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(v), 16));
+        vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(v), 16));
+    }
+    s16_to_s32_scalar(src + 2 * i, dst + i, count - i, swap);
+}
+
+static inline int16x4_t round_s16_neon(int32x4_t v) {
+    return vqmovn_s32(vshrq_n_s32(vaddq_s32(vshrq_n_s32(v, 15), vdupq_n_s32(1)), 1));
+}
+
+static void s32_to_s16_neon(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vcombine_s16(round_s16_neon(vld1q_s32(src + i)), round_s16_neon(vld1q_s32(src + i + 4)));
+        uint8x16_t bytes = vreinterpretq_u8_s16(v);
+        vst1q_u8(dst + 2 * i, swap ? vrev16q_u8(bytes) : bytes);
+    }
+    s32_to_s16_scalar(src + i, dst + 2 * i, count - i, swap);
+}
+
+static void load_s32_neon(const uint8_t *src, int32_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t bytes = vld1q_u8(src + 4 * i);
+        vst1q_s32(dst + i, vreinterpretq_s32_u8(swap ? vrev32q_u8(bytes) : bytes));
+    }
+    load_s32_scalar(src + 4 * i, dst + i, count - i, swap);
+}
+
+static void store_s32_neon(const int32_t *src, uint8_t *dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t bytes = vreinterpretq_u8_s32(vld1q_s32(src + i));
+        vst1q_u8(dst + 4 * i, swap ? vrev32q_u8(bytes) : bytes);
+    }
+    store_s32_scalar(src + i, dst + 4 * i, count - i, swap);
+}
+
+static void s32_to_float_neon(const int32_t *src, float *dst, size_t count) {
+    const float32x4_t scale = vdupq_n_f32(1.0f / FLOAT_TO_S32_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+    }
+    s32_to_float_scalar(src + i, dst + i, count - i);
+}
+
+static void float_to_s32_neon(const float *src, int32_t *dst, size_t count) {
+    size_t i = 0;
+#ifdef __aarch64__
+    // ARMv7 NEON only truncates; round to nearest needs AArch64
+    const float32x4_t scale = vdupq_n_f32(FLOAT_TO_S32_SCALE);
+    const float32x4_t max = vdupq_n_f32(FLOAT_S32_MAX);
+    const float32x4_t min = vdupq_n_f32(FLOAT_S32_MIN);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vmulq_f32(vld1q_f32(src + i), scale);
+        vst1q_s32(dst + i, vcvtnq_s32_f32(vmaxq_f32(vminq_f32(v, max), min)));
+    }
+#endif
+    float_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+static float dot_neon(const float *a, const float *b, size_t count) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < count; i += 4) {
+        acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    float32x2_t pairs = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+
+static const audio_kernels_t neon_kernels = {
+    s16_to_s32_neon, s32_to_s16_neon, load_s32_neon, store_s32_neon,
+    s32_to_float_neon, float_to_s32_neon, dot_neon
+};
+#endif /* AUDIO_HAVE_NEON */
+
+pattern_isa_t audio_convert_isa(void) {
+    switch (pattern_get_isa()) {
+#ifdef AUDIO_HAVE_X86
+        case PATTERN_ISA_SSE2:
+        case PATTERN_ISA_AVX2:
+            return PATTERN_ISA_SSE2;
+#endif
+#ifdef AUDIO_HAVE_NEON
+        case PATTERN_ISA_NEON:
+            return PATTERN_ISA_NEON;
+#endif
+        default:
+            return PATTERN_ISA_SCALAR;
+    }
+}
+
+static const audio_kernels_t *select_kernels(void) {
+    switch (audio_convert_isa()) {
+#ifdef AUDIO_HAVE_X86
+        case PATTERN_ISA_SSE2:
+            return &sse2_kernels;
+#endif
+#ifdef AUDIO_HAVE_NEON
+        case PATTERN_ISA_NEON:
+            return &neon_kernels;
+#endif
+        default:
+            return &scalar_kernels;
+    }
+}
+
+// Formats
+bool audio_format_is_pcm(audio_format_t format) {
+    return format <= AUDIO_FORMAT_PCM_S32BE;
+}
+
+uint32_t audio_format_sample_size(audio_format_t format) {
+    switch (format) {
+        case AUDIO_FORMAT_PCM_S8:
+        case AUDIO_FORMAT_PCM_U8:
+            return 1;
+        case AUDIO_FORMAT_PCM_S16LE:
+        case AUDIO_FORMAT_PCM_S16BE:
+            return 2;
+        case AUDIO_FORMAT_PCM_S24LE:
+        case AUDIO_FORMAT_PCM_S24BE:
+            return 3;
+        case AUDIO_FORMAT_PCM_S32LE:
+        case AUDIO_FORMAT_PCM_S32BE:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint32_t audio_format_bits(audio_format_t format) {
+    return audio_format_sample_size(format) * 8;
+}
+
+static bool format_is_big_endian(audio_format_t format) {
+    return format == AUDIO_FORMAT_PCM_S16BE || format == AUDIO_FORMAT_PCM_S24BE || format == AUDIO_FORMAT_PCM_S32BE;
+}
+
+static void s8_to_s32(const uint8_t *src, int32_t *dst, size_t count, uint8_t bias) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)((uint32_t)(uint8_t)(src[i] ^ bias) << 24);
+    }
+}
+
+static void s32_to_s8(const int32_t *src, uint8_t *dst, size_t count, uint8_t bias) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = ((src[i] >> 23) + 1) >> 1;
+        dst[i] = (uint8_t)(v > INT8_MAX ? INT8_MAX : v) ^ bias;
+    }
+}
+
+static void s24_to_s32(const uint8_t *src, int32_t *dst, size_t count, bool big_endian) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = src + 3 * i;
+        uint32_t v = big_endian ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)
+                                : ((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8);
+        dst[i] = (int32_t)v;
+    }
+}
+
+static void s32_to_s24(const int32_t *src, uint8_t *dst, size_t count, bool big_endian) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = ((src[i] >> 7) + 1) >> 1;
+        uint32_t u = (uint32_t)(v > 0x7FFFFF ? 0x7FFFFF : v);
+        uint8_t *p = dst + 3 * i;
+        p[big_endian ? 2 : 0] = (uint8_t)u;
+        p[1] = (uint8_t)(u >> 8);
+        p[big_endian ? 0 : 2] = (uint8_t)(u >> 16);
+    }
+}
+
+bool audio_samples_to_s32(const void *src, audio_format_t format, int32_t *dst, size_t count) {
+    const audio_kernels_t *kernels = select_kernels();
+    const uint8_t *p = src;
+    bool big_endian = format_is_big_endian(format);
+
+    switch (format) {
+        case AUDIO_FORMAT_PCM_S8:
+        case AUDIO_FORMAT_PCM_U8:
+            s8_to_s32(p, dst, count, format == AUDIO_FORMAT_PCM_U8 ? 0x80 : 0);
+            return true;
+        case AUDIO_FORMAT_PCM_S16LE:
+        case AUDIO_FORMAT_PCM_S16BE:
+            kernels->s16_to_s32(p, dst, count, big_endian);
+            return true;
+        case AUDIO_FORMAT_PCM_S24LE:
+        case AUDIO_FORMAT_PCM_S24BE:
+            s24_to_s32(p, dst, count, big_endian);
+            return true;
+        case AUDIO_FORMAT_PCM_S32LE:
+        case AUDIO_FORMAT_PCM_S32BE:
+            kernels->load_s32(p, dst, count, big_endian);
+            return true;
+        default:
+            fprintf(stderr, "Cannot convert %s samples\n", audio_format_to_string(format));
+            return false;
+    }
+}
+
+bool audio_samples_from_s32(const int32_t *src, void *dst, audio_format_t format, size_t count) {
+    const audio_kernels_t *kernels = select_kernels();
+    uint8_t *p = dst;
+    bool big_endian = format_is_big_endian(format);
+
+    switch (format) {
+        case AUDIO_FORMAT_PCM_S8:
+        case AUDIO_FORMAT_PCM_U8:
+            s32_to_s8(src, p, count, format == AUDIO_FORMAT_PCM_U8 ? 0x80 : 0);
+            return true;
+        case AUDIO_FORMAT_PCM_S16LE:
+        case AUDIO_FORMAT_PCM_S16BE:
+            kernels->s32_to_s16(src, p, count, big_endian);
+            return true;
+        case AUDIO_FORMAT_PCM_S24LE:
+        case AUDIO_FORMAT_PCM_S24BE:
+            s32_to_s24(src, p, count, big_endian);
+            return true;
+        case AUDIO_FORMAT_PCM_S32LE:
+        case AUDIO_FORMAT_PCM_S32BE:
+            kernels->store_s32(src, p, count, big_endian);
+            return true;
+        default:
+            fprintf(stderr, "Cannot convert to %s samples\n", audio_format_to_string(format));
+            return false;
+    }
+}
+
+bool audio_convert_samples(const void *src, audio_format_t src_format, void *dst, audio_format_t dst_format,
+                           size_t count) {
+    if (!audio_format_is_pcm(src_format) || !audio_format_is_pcm(dst_format)) {
+        fprintf(stderr, "Cannot convert %s to %s\n", audio_format_to_string(src_format),
+                audio_format_to_string(dst_format));
+        return false;
+    }
+    if (src_format == dst_format) {
+        memcpy(dst, src, count * audio_format_sample_size(src_format));
+        return true;
+    }
+
+    int32_t pivot[AUDIO_CONVERT_CHUNK];
+    const uint8_t *in = src;
+    uint8_t *out = dst;
+    uint32_t in_size = audio_format_sample_size(src_format);
+    uint32_t out_size = audio_format_sample_size(dst_format);
+    for (size_t done = 0; done < count; done += AUDIO_CONVERT_CHUNK) {
+        size_t n = count - done < AUDIO_CONVERT_CHUNK ? count - done : AUDIO_CONVERT_CHUNK;
+        audio_samples_to_s32(in + done * in_size, src_format, pivot, n);
+        audio_samples_from_s32(pivot, out + done * out_size, dst_format, n);
+    }
+    return true;
+}
+
+bool audio_samples_to_float(const void *src, audio_format_t format, float *dst, size_t count) {
+    if (!audio_format_is_pcm(format)) {
+        fprintf(stderr, "Cannot convert %s samples\n", audio_format_to_string(format));
+        return false;
+    }
+
+    const audio_kernels_t *kernels = select_kernels();
+    int32_t pivot[AUDIO_CONVERT_CHUNK];
+    const uint8_t *in = src;
+    uint32_t size = audio_format_sample_size(format);
+    for (size_t done = 0; done < count; done += AUDIO_CONVERT_CHUNK) {
+        size_t n = count - done < AUDIO_CONVERT_CHUNK ? count - done : AUDIO_CONVERT_CHUNK;
+        audio_samples_to_s32(in + done * size, format, pivot, n);
+        kernels->s32_to_float(pivot, dst + done, n);
+    }
+    return true;
+}
+
+bool audio_samples_from_float(const float *src, void *dst, audio_format_t format, size_t count) {
+    if (!audio_format_is_pcm(format)) {
+        fprintf(stderr, "Cannot convert to %s samples\n", audio_format_to_string(format));
+        return false;
+    }
+
+    const audio_kernels_t *kernels = select_kernels();
+    int32_t pivot[AUDIO_CONVERT_CHUNK];
+    uint8_t *out = dst;
+    uint32_t size = audio_format_sample_size(format);
+    for (size_t done = 0; done < count; done += AUDIO_CONVERT_CHUNK) {
+        size_t n = count - done < AUDIO_CONVERT_CHUNK ? count - done : AUDIO_CONVERT_CHUNK;
+        kernels->float_to_s32(src + done, pivot, n);
+        audio_samples_from_s32(pivot, out + done * size, format, n);
+    }
+    return true;
+}
+
+// Resampler
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+static double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc at L times the input rate, cut off below the lower
+// of the two Nyquist rates. Phase p holds taps p, p + L, p + 2L, ...,
+// reversed and normalised to unity gain.
+static void design_filter(audio_resampler_t *resampler) {
+    uint32_t phases = resampler->phases;
+    uint32_t taps = resampler->taps;
+    uint32_t length = phases * taps;
+    double center = (length - 1) / 2.0;
+    double ratio = (double)phases / resampler->step;
+    double cutoff = 0.5 * RESAMPLE_ROLLOFF * (ratio < 1.0 ? ratio : 1.0) / phases;
+    double window_norm = bessel_i0(RESAMPLE_KAISER_BETA);
+
+    for (uint32_t p = 0; p < phases; p++) {
+        float *coefs = resampler->coefs + (size_t)p * taps;
+        double sum = 0.0;
+        for (uint32_t q = 0; q < taps; q++) {
+            double t = p + (double)q * phases - center;
+            double sinc = t == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            double x = 2.0 * t / (length - 1);
+            double window = bessel_i0(RESAMPLE_KAISER_BETA * sqrt(1.0 - x * x > 0.0 ? 1.0 - x * x : 0.0)) /
+                            window_norm;
+            coefs[taps - 1 - q] = (float)(sinc * window);
+            sum += sinc * window;
+        }
+        for (uint32_t j = 0; j < taps; j++) {
+            coefs[j] = (float)(coefs[j] / sum);
+        }
+    }
+}
+
+static size_t work_stride(const audio_resampler_t *resampler) {
+    return resampler->taps - 1 + AUDIO_RESAMPLE_BLOCK;
+}
+
+bool audio_resampler_init(audio_resampler_t *resampler, uint32_t in_rate, uint32_t out_rate, uint32_t channels) {
+    memset(resampler, 0, sizeof(*resampler));
+    if (in_rate == 0 || out_rate == 0 || channels == 0) {
+        fprintf(stderr, "Cannot resample %u Hz to %u Hz over %u channels\n", in_rate, out_rate, channels);
+        return false;
+    }
+
+    uint32_t divisor = gcd(in_rate, out_rate);
+    resampler->in_rate = in_rate;
+    resampler->out_rate = out_rate;
+    resampler->channels = channels;
+    resampler->phases = out_rate / divisor;
+    resampler->step = in_rate / divisor;
+    resampler->taps = AUDIO_RESAMPLE_TAPS;
+    if (resampler->phases > AUDIO_RESAMPLE_MAX_PHASES) {
+        fprintf(stderr, "%u Hz to %u Hz needs %u filter phases; at most %u are supported\n", in_rate, out_rate,
+                resampler->phases, AUDIO_RESAMPLE_MAX_PHASES);
+        return false;
+    }
+
+    size_t outputs = audio_resampler_max_output(resampler, AUDIO_RESAMPLE_BLOCK);
+    resampler->coefs = malloc((size_t)resampler->phases * resampler->taps * sizeof(float));
+    resampler->work = calloc(work_stride(resampler) * channels, sizeof(float));
+    resampler->out_index = malloc(outputs * sizeof(uint32_t));
+    resampler->out_phase = malloc(outputs * sizeof(uint32_t));
+    if (!resampler->coefs || !resampler->work || !resampler->out_index || !resampler->out_phase) {
+        fprintf(stderr, "Cannot allocate the resampler\n");
+        audio_resampler_free(resampler);
+        return false;
+    }
+
+    design_filter(resampler);
+    return true;
+}
+
+void audio_resampler_free(audio_resampler_t *resampler) {
+    free(resampler->coefs);
+    free(resampler->work);
+    free(resampler->out_index);
+    free(resampler->out_phase);
+    resampler->coefs = resampler->work = NULL;
+    resampler->out_index = resampler->out_phase = NULL;
+}
+
+void audio_resampler_reset(audio_resampler_t *resampler) {
+    memset(resampler->work, 0, work_stride(resampler) * resampler->channels * sizeof(float));
+    resampler->phase = 0;
+    resampler->position = 0;
+}
+
+size_t audio_resampler_max_output(const audio_resampler_t *resampler, size_t in_frames) {
+    return (in_frames * resampler->phases + resampler->step - 1) / resampler->step + 1;
+}
+
+// Output n reads the taps input frames ending at floor(n * M / L), with
+// phase (n * M) mod L. The positions are worked out once per block and
+// shared by every channel.
+size_t audio_resampler_process(audio_resampler_t *resampler, const float *in, size_t in_frames, float *out) {
+    const audio_kernels_t *kernels = select_kernels();
+    uint32_t channels = resampler->channels;
+    uint32_t taps = resampler->taps;
+    size_t stride = work_stride(resampler);
+    size_t produced = 0;
+
+    while (in_frames > 0) {
+        uint32_t n = in_frames < AUDIO_RESAMPLE_BLOCK ? (uint32_t)in_frames : AUDIO_RESAMPLE_BLOCK;
+
+        uint32_t count = 0;
+        uint32_t index = resampler->position;
+        uint32_t phase = resampler->phase;
+        while (index < n) {
+            resampler->out_index[count] = index;
+            resampler->out_phase[count] = phase;
+            count++;
+            phase += resampler->step;
+            index += phase / resampler->phases;
+            phase %= resampler->phases;
+        }
+        resampler->position = index - n;
+        resampler->phase = phase;
+
+        for (uint32_t c = 0; c < channels; c++) {
+            float *work = resampler->work + c * stride;
+            float *block = work + taps - 1;
+            for (uint32_t i = 0; i < n; i++) {
+                block[i] = in[(size_t)i * channels + c];
+            }
+            for (uint32_t o = 0; o < count; o++) {
+                const float *coefs = resampler->coefs + (size_t)resampler->out_phase[o] * taps;
+                out[(produced + o) * channels + c] = kernels->dot(work + resampler->out_index[o], coefs, taps);
+            }
+            memmove(work, work + n, (taps - 1) * sizeof(float));
+        }
+
+        produced += count;
+        in += (size_t)n * channels;
+        in_frames -= n;
+    }
+    return produced;
+}
+
+// Benchmarks
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double tone_frequency(uint32_t channel) {
+    return TONE_BASE_HZ * (1.0 + channel / 2.0);
+}
+
+// A tone per channel plus low-level noise, so every bit of the wider
+// formats is exercised
+static void fill_test_signal(int32_t *samples, uint32_t frames, uint32_t channels, uint32_t rate) {
+    uint32_t seed = 0x12345678;
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            seed = seed * 1664525u + 1013904223u;
+            double noise = ((int32_t)seed >> 8) / 8388608.0;
+            double value = 0.8 * sin(2.0 * M_PI * tone_frequency(c) * i / rate) + 0.1 * noise;
+            samples[(size_t)i * channels + c] = (int32_t)lrint(value * 2147483647.0);
+        }
+    }
+}
+
+bool test_audio_format_conversion(const audio_test_config_t *config, audio_format_t target,
+                                  audio_convert_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->from = config->format;
+    stats->to = target;
+    stats->channels = audio_channel_count(config->channels);
+    stats->isa = audio_convert_isa();
+
+    if (!audio_format_is_pcm(config->format) || !audio_format_is_pcm(target)) {
+        fprintf(stderr, "Conversion needs PCM formats, not %s to %s\n", audio_format_to_string(config->format),
+                audio_format_to_string(target));
+        return false;
+    }
+
+    // One second of audio
+    uint32_t frames = config->sample_rate ? config->sample_rate : 48000;
+    size_t count = (size_t)frames * stats->channels;
+    int32_t *reference = malloc(count * sizeof(int32_t));
+    int32_t *returned = malloc(count * sizeof(int32_t));
+    uint8_t *src = malloc(count * audio_format_sample_size(config->format));
+    uint8_t *dst = malloc(count * audio_format_sample_size(target));
+    uint8_t *back = malloc(count * audio_format_sample_size(config->format));
+    bool result = reference && returned && src && dst && back;
+    if (!result) {
+        fprintf(stderr, "Cannot allocate conversion buffers\n");
+    }
+
+    if (result) {
+        fill_test_signal(reference, frames, stats->channels, frames);
+        audio_samples_from_s32(reference, src, config->format, count);
+        // What the source format can hold is the reference
+        audio_samples_to_s32(src, config->format, reference, count);
+
+        uint64_t start = get_monotonic_ns();
+        uint64_t elapsed = 0;
+        uint32_t runs = 0;
+        do {
+            audio_convert_samples(src, config->format, dst, target, count);
+            runs++;
+            elapsed = get_monotonic_ns() - start;
+        } while (elapsed < AUDIO_CONVERT_BENCH_MS * 1000000ULL || runs < config->iterations);
+        stats->samples = (uint64_t)runs * count;
+        stats->msamples_per_sec = stats->samples * 1e3 / elapsed;
+
+        audio_convert_samples(dst, target, back, config->format, count);
+        audio_samples_to_s32(back, config->format, returned, count);
+        uint32_t bits = audio_format_bits(target) < audio_format_bits(config->format) ? audio_format_bits(target)
+                                                                                      : audio_format_bits(config->format);
+        double lsb = ldexp(1.0, 32 - (int)bits);
+        for (size_t i = 0; i < count; i++) {
+            double error = fabs((double)returned[i] - reference[i]) / lsb;
+            stats->max_error_lsb = error > stats->max_error_lsb ? error : stats->max_error_lsb;
+        }
+
+        // Widening is lossless and narrowing rounds to nearest
+        if (stats->max_error_lsb > 0.5) {
+            fprintf(stderr, "%s to %s round trip is off by %.3f LSB\n", audio_format_to_string(config->format),
+                    audio_format_to_string(target), stats->max_error_lsb);
+            result = false;
+        }
+    }
+
+    free(reference);
+    free(returned);
+    free(src);
+    free(dst);
+    free(back);
+    return result;
+}
+
+// Least-squares fit of a sine at the channel's tone frequency; whatever
+// the fit leaves, DC included, is distortion plus noise
+static double channel_thd_n_db(const float *samples, uint32_t frames, uint32_t channels, uint32_t channel,
+                               uint32_t rate) {
+    double omega = 2.0 * M_PI * tone_frequency(channel) / rate;
+    double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+    for (uint32_t i = 0; i < frames; i++) {
+        double y = samples[(size_t)i * channels + channel];
+        double s = sin(omega * i);
+        double c = cos(omega * i);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += y * s;
+        yc += y * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+
+    double signal = 0.0, residual = 0.0;
+    for (uint32_t i = 0; i < frames; i++) {
+        double fit = a * sin(omega * i) + b * cos(omega * i);
+        double error = samples[(size_t)i * channels + channel] - fit;
+        signal += fit * fit;
+        residual += error * error;
+    }
+    if (signal <= 0.0) {
+        return 0.0;
+    }
+    return residual > 0.0 ? 10.0 * log10(residual / signal) : -INFINITY;
+}
+
+bool test_audio_resampling(const audio_test_config_t *config, uint32_t out_rate, audio_resample_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->in_rate = config->sample_rate ? config->sample_rate : 48000;
+    stats->out_rate = out_rate;
+    stats->channels = audio_channel_count(config->channels);
+    stats->isa = audio_convert_isa();
+
+    if (!audio_format_is_pcm(config->format)) {
+        fprintf(stderr, "Resampling needs a PCM format, not %s\n", audio_format_to_string(config->format));
+        return false;
+    }
+
+    audio_resampler_t resampler;
+    if (!audio_resampler_init(&resampler, stats->in_rate, out_rate, stats->channels)) {
+        return false;
+    }
+    stats->phases = resampler.phases;
+    stats->taps = resampler.taps;
+
+    // One second in, through float and back to config->format
+    uint32_t frames = stats->in_rate;
+    size_t in_count = (size_t)frames * stats->channels;
+    size_t out_count = audio_resampler_max_output(&resampler, frames) * stats->channels;
+    uint32_t size = audio_format_sample_size(config->format);
+    float *in_float = malloc(in_count * sizeof(float));
+    float *out_float = malloc(out_count * sizeof(float));
+    uint8_t *in_pcm = malloc(in_count * size);
+    uint8_t *out_pcm = malloc(out_count * size);
+    bool result = in_float && out_float && in_pcm && out_pcm;
+    if (!result) {
+        fprintf(stderr, "Cannot allocate resampling buffers\n");
+    }
+
+    if (result) {
+        for (uint32_t i = 0; i < frames; i++) {
+            for (uint32_t c = 0; c < stats->channels; c++) {
+                in_float[(size_t)i * stats->channels + c] =
+                    (float)(TONE_AMPLITUDE * sin(2.0 * M_PI * tone_frequency(c) * i / stats->in_rate));
+            }
+        }
+        audio_samples_from_float(in_float, in_pcm, config->format, in_count);
+
+        // Streams continuously, as a playback path would
+        uint64_t start = get_monotonic_ns();
+        uint64_t elapsed = 0;
+        uint32_t runs = 0;
+        do {
+            audio_samples_to_float(in_pcm, config->format, in_float, in_count);
+            size_t produced = audio_resampler_process(&resampler, in_float, frames, out_float);
+            audio_samples_from_float(out_float, out_pcm, config->format, produced * stats->channels);
+            runs++;
+            elapsed = get_monotonic_ns() - start;
+        } while (elapsed < AUDIO_CONVERT_BENCH_MS * 1000000ULL || runs < config->iterations);
+        stats->frames = (uint64_t)runs * frames;
+        stats->mframes_per_sec = stats->frames * 1e3 / elapsed;
+        stats->realtime_factor = stats->mframes_per_sec * 1e6 / stats->in_rate;
+
+        // One clean pass for the measurement, less the filter's start-up
+        audio_resampler_reset(&resampler);
+        audio_samples_to_float(in_pcm, config->format, in_float, in_count);
+        size_t produced = audio_resampler_process(&resampler, in_float, frames, out_float);
+        audio_samples_from_float(out_float, out_pcm, config->format, produced * stats->channels);
+        audio_samples_to_float(out_pcm, config->format, out_float, produced * stats->channels);
+
+        size_t settle = (size_t)resampler.taps * out_rate / stats->in_rate + 1;
+        if (produced <= 2 * settle) {
+            fprintf(stderr, "Only %zu frames out of the resampler\n", produced);
+            result = false;
+        }
+        stats->thd_n_db = -INFINITY;
+        for (uint32_t c = 0; result && c < stats->channels; c++) {
+            double thd_n = channel_thd_n_db(out_float + settle * stats->channels, (uint32_t)(produced - settle),
+                                            stats->channels, c, out_rate);
+            stats->thd_n_db = thd_n > stats->thd_n_db ? thd_n : stats->thd_n_db;
+        }
+        if (result && stats->thd_n_db > AUDIO_RESAMPLE_MAX_THDN_DB) {
+            fprintf(stderr, "%u Hz to %u Hz THD+N is %.1f dB\n", stats->in_rate, out_rate, stats->thd_n_db);
+            result = false;
+        }
+    }
+
+    free(in_float);
+    free(out_float);
+    free(in_pcm);
+    free(out_pcm);
+    audio_resampler_free(&resampler);
+    return result;
+}
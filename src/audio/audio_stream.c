@@ -0,0 +1,1094 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "audio/audio_stream.h"
+#include "report/report_live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <math.h>
+#include <time.h>
+#include <alsa/asoundlib.h>
+
+#define STREAM_TIMEOUT 5000       // 5 seconds
+#define TONE_FREQUENCY 1000.0
+#define TONE_LEVEL 0.25           // -12 dBFS
+#define IMPULSE_FRAMES 8
+#define IMPULSE_LEVEL 0.9
+#define IMPULSE_GAP_MS 100        // Lets the previous impulse ring out
+#define IMPULSE_TIMEOUT_MS 1000
+#define NOISE_WINDOW_MS 200
+#define FULL_SCALE 2147483647.0
+#define KERNEL_FRAMES 256         // Frames per sample kernel call
+
+// Samples are handled as full-scale 32-bit values; narrower formats keep the
+// top bits. write puts values[f] on every channel of frame f; levels sets
+// levels[f] to the magnitude of frame f's loudest channel. Both work on
+// whole interleaved frames, as the mmap areas are.
+typedef struct {
+    void (*write)(void *dst, const int32_t *values, size_t frames, unsigned int channels);
+    void (*levels)(const void *src, size_t frames, unsigned int channels, uint32_t *levels);
+} sample_kernels_t;
+
+typedef struct {
+    snd_pcm_t *pcm;
+    bool playback;
+    snd_pcm_format_t format;
+    unsigned int channels;
+    const sample_kernels_t *kernels;  // For format and channels
+    unsigned int rate;
+    snd_pcm_uframes_t period_size;
+    snd_pcm_uframes_t buffer_size;
+    uint64_t position;            // Frames committed since the last start
+    uint64_t committed;           // Frames committed over the whole run
+    uint32_t xruns;
+    bool restart;                 // Recovered from an xrun, needs starting again
+    struct pollfd *pfds;
+    unsigned int nfds;
+    report_live_id_t live_xruns;
+    report_live_id_t live_frames;
+    uint32_t trace_id;            // Name in a session trace; 0 if not recorded
+} pcm_stream_t;
+
+// Called with each contiguous chunk of the mmap area before it is committed
+typedef void (*area_handler_t)(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                               snd_pcm_uframes_t offset, snd_pcm_uframes_t frames, void *context);
+
+typedef struct {
+    double phase;
+    double step;
+    uint32_t peak;
+} stream_test_t;
+
+typedef struct {
+    pcm_stream_t playback;
+    pcm_stream_t capture;
+    bool linked;
+    int64_t threshold;            // 0 until the noise floor is known
+    uint32_t noise_peak;
+    uint64_t noise_frames;
+    bool emit;                    // Write the impulse into the next playback chunk
+    bool pending;                 // Impulse committed, not yet seen on capture
+    uint64_t impulse_frame;       // Playback position of the impulse
+    uint64_t impulse_ns;          // When it was committed
+    uint64_t next_ns;             // Earliest time for the next impulse
+    uint32_t aborted;
+    double *round_trip_ms;
+    double path_sum_ms;
+    uint32_t path_count;
+    audio_latency_stats_t *stats;
+} loopback_t;
+
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool to_alsa_format(audio_format_t format, snd_pcm_format_t *alsa_format) {
+    switch (format) {
+        case AUDIO_FORMAT_PCM_S16LE:
+            *alsa_format = SND_PCM_FORMAT_S16_LE;
+            return true;
+        case AUDIO_FORMAT_PCM_S24LE:
+            *alsa_format = SND_PCM_FORMAT_S24_LE;
+            return true;
+        case AUDIO_FORMAT_PCM_S32LE:
+            *alsa_format = SND_PCM_FORMAT_S32_LE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint8_t *area_sample(const snd_pcm_channel_area_t *area, snd_pcm_uframes_t frame) {
+    return (uint8_t *)area->addr + (area->first + frame * area->step) / 8;
+}
+
+// One pair per container and channel count, each with a constant sample
+// size, shift and frame stride so the loops vectorise; ch_n is the
+// fallback for other channel counts
+#define DEFINE_SAMPLE_KERNELS(fmt, type, shift, name, count)                                                   \
+    static void write_##fmt##_##name(void *dst, const int32_t *values, size_t frames, unsigned int channels) { \
+        type *out = dst;                                                                                       \
+        for (size_t f = 0; f < frames; f++) {                                                                  \
+            type sample = (type)(values[f] >> shift);                                                          \
+            for (unsigned int c = 0; c < (count); c++) {                                                       \
+                out[f * (count) + c] = sample;                                                                 \
+            }                                                                                                  \
+        }                                                                                                      \
+        (void)channels;                                                                                        \
+    }                                                                                                          \
+    static void levels_##fmt##_##name(const void *src, size_t frames, unsigned int channels,                   \
+                                      uint32_t *levels) {                                                      \
+        const type *in = src;                                                                                  \
+        for (size_t f = 0; f < frames; f++) {                                                                  \
+            uint32_t level = 0;                                                                                \
+            for (unsigned int c = 0; c < (count); c++) {                                                       \
+                uint32_t sample = (uint32_t)in[f * (count) + c] << shift;                                      \
+                uint32_t magnitude = (int32_t)sample < 0 ? 0u - sample : sample;                               \
+                level = magnitude > level ? magnitude : level;                                                 \
+            }                                                                                                  \
+            levels[f] = level;                                                                                 \
+        }                                                                                                      \
+        (void)channels;                                                                                        \
+    }
+
+#define DEFINE_FORMAT_KERNELS(fmt, type, shift)                 \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch1, 1)             \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch2, 2)             \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch3, 3)             \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch6, 6)             \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch8, 8)             \
+    DEFINE_SAMPLE_KERNELS(fmt, type, shift, ch_n, channels)
+
+#define FORMAT_KERNELS(fmt)                                                                            \
+    { { write_##fmt##_ch1, levels_##fmt##_ch1 }, { write_##fmt##_ch2, levels_##fmt##_ch2 },           \
+      { write_##fmt##_ch3, levels_##fmt##_ch3 }, { write_##fmt##_ch6, levels_##fmt##_ch6 },           \
+      { write_##fmt##_ch8, levels_##fmt##_ch8 }, { write_##fmt##_ch_n, levels_##fmt##_ch_n } }
+
+// S24_LE sits in the low three bytes of a 32-bit container
+DEFINE_FORMAT_KERNELS(s16, int16_t, 16)
+DEFINE_FORMAT_KERNELS(s24, int32_t, 8)
+DEFINE_FORMAT_KERNELS(s32, int32_t, 0)
+
+static const sample_kernels_t sample_kernels[3][6] = {
+    FORMAT_KERNELS(s16),
+    FORMAT_KERNELS(s24),
+    FORMAT_KERNELS(s32)
+};
+
+static const sample_kernels_t *select_sample_kernels(snd_pcm_format_t format, unsigned int channels) {
+    uint32_t row = format == SND_PCM_FORMAT_S16_LE ? 0 : format == SND_PCM_FORMAT_S24_LE ? 1 : 2;
+    uint32_t column;
+    switch (channels) {
+        case 1: column = 0; break;
+        case 2: column = 1; break;
+        case 3: column = 2; break;
+        case 6: column = 3; break;
+        case 8: column = 4; break;
+        default: column = 5; break;
+    }
+    return &sample_kernels[row][column];
+}
+
+// Interleaved access: channel 0's area addresses whole frames
+static void *chunk_frames(const snd_pcm_channel_area_t *areas, snd_pcm_uframes_t offset) {
+    return area_sample(&areas[0], offset);
+}
+
+static void silence_chunk(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                          snd_pcm_uframes_t offset, snd_pcm_uframes_t frames) {
+    snd_pcm_areas_silence(areas, offset, s->channels, frames, s->format);
+}
+
+// Unlike the old RW path, this sets the period explicitly: the period is
+// what poll() wakes us for, and with the period count it fixes the latency
+static bool set_pcm_params(pcm_stream_t *s, const audio_test_config_t *config) {
+    snd_pcm_hw_params_t *params;
+    snd_pcm_hw_params_alloca(&params);
+    snd_pcm_hw_params_any(s->pcm, params);
+
+    int err = snd_pcm_hw_params_set_access(s->pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set mmap access: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    if (!to_alsa_format(config->format, &s->format)) {
+        fprintf(stderr, "Unsupported format %s\n", audio_format_to_string(config->format));
+        return false;
+    }
+    err = snd_pcm_hw_params_set_format(s->pcm, params, s->format);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set format: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    s->channels = audio_channel_count(config->channels);
+    err = snd_pcm_hw_params_set_channels(s->pcm, params, s->channels);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set channels: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    s->rate = config->sample_rate;
+    err = snd_pcm_hw_params_set_rate_near(s->pcm, params, &s->rate, 0);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set sample rate: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    unsigned int periods = config->periods ? config->periods : AUDIO_STREAM_PERIODS;
+    snd_pcm_uframes_t period_size = config->period_size ? config->period_size : config->buffer_size / periods;
+    int dir = 0;
+    err = snd_pcm_hw_params_set_period_size_near(s->pcm, params, &period_size, &dir);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set period size: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    dir = 0;
+    err = snd_pcm_hw_params_set_periods_near(s->pcm, params, &periods, &dir);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set period count: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    err = snd_pcm_hw_params(s->pcm, params);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set parameters: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    snd_pcm_hw_params_get_period_size(params, &s->period_size, &dir);
+    snd_pcm_hw_params_get_buffer_size(params, &s->buffer_size);
+    s->kernels = select_sample_kernels(s->format, s->channels);
+
+    // Started explicitly, woken once per period, timestamped on the same
+    // clock as the rest of the suite
+    snd_pcm_sw_params_t *sw_params;
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(s->pcm, sw_params);
+
+    snd_pcm_uframes_t boundary = 0;
+    snd_pcm_sw_params_get_boundary(sw_params, &boundary);
+    snd_pcm_sw_params_set_start_threshold(s->pcm, sw_params, boundary);
+    snd_pcm_sw_params_set_avail_min(s->pcm, sw_params, s->period_size);
+    snd_pcm_sw_params_set_tstamp_mode(s->pcm, sw_params, SND_PCM_TSTAMP_ENABLE);
+    snd_pcm_sw_params_set_tstamp_type(s->pcm, sw_params, SND_PCM_TSTAMP_TYPE_MONOTONIC);
+
+    err = snd_pcm_sw_params(s->pcm, sw_params);
+    if (err < 0) {
+        fprintf(stderr, "Cannot set software parameters: %s\n", snd_strerror(err));
+        return false;
+    }
+
+    return true;
+}
+
+static bool open_stream(pcm_stream_t *s, uint32_t device_index, bool playback, const audio_test_config_t *config) {
+    char device_name[64];
+    snprintf(device_name, sizeof(device_name), "hw:%u,0", device_index);
+
+    uint64_t start = trace_begin();
+    memset(s, 0, sizeof(pcm_stream_t));
+    s->playback = playback;
+    s->live_xruns = -1;
+    s->live_frames = -1;
+
+    int err = snd_pcm_open(&s->pcm, device_name,
+                           playback ? SND_PCM_STREAM_PLAYBACK : SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK);
+    if (err < 0) {
+        fprintf(stderr, "Cannot open PCM device %s: %s\n", device_name, snd_strerror(err));
+        s->pcm = NULL;
+        return false;
+    }
+
+    if (!set_pcm_params(s, config)) {
+        return false;
+    }
+
+    int count = snd_pcm_poll_descriptors_count(s->pcm);
+    if (count <= 0) {
+        fprintf(stderr, "PCM device %s has no poll descriptors\n", device_name);
+        return false;
+    }
+    s->pfds = calloc((size_t)count, sizeof(struct pollfd));
+    if (!s->pfds) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+    s->nfds = (unsigned int)snd_pcm_poll_descriptors(s->pcm, s->pfds, (unsigned int)count);
+
+    char labels[64] = "";
+    report_live_label(labels, sizeof(labels), "device", device_name);
+    report_live_label(labels, sizeof(labels), "stream", playback ? "playback" : "capture");
+    s->live_xruns = report_live_register("tvts_audio_xruns_total", labels, REPORT_LIVE_COUNTER,
+                                         "Underruns (playback) or overruns (capture)");
+    s->live_frames = report_live_register("tvts_audio_frames_total", labels, REPORT_LIVE_COUNTER,
+                                          "Frames committed to the ring buffer");
+
+    if (start) {
+        s->trace_id = trace_next_id();
+        uint64_t args[] = { s->trace_id, device_index, playback, config->format, config->channels,
+                            config->sample_rate, config->periods, config->period_size, config->buffer_size };
+        trace_record(TRACE_OP_PCM_OPEN, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+static void close_stream(pcm_stream_t *s) {
+    uint64_t start = s->trace_id ? trace_begin() : 0;
+    if (s->pcm) {
+        snd_pcm_drop(s->pcm);
+        snd_pcm_close(s->pcm);
+        s->pcm = NULL;
+    }
+    if (start) {
+        uint64_t args[] = { s->trace_id };
+        trace_record(TRACE_OP_PCM_CLOSE, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    s->trace_id = 0;
+    free(s->pfds);
+    s->pfds = NULL;
+    s->nfds = 0;
+}
+
+static bool recover_stream(pcm_stream_t *s, int err) {
+    if (err == -EAGAIN) {
+        return true;
+    }
+    if (err == -EPIPE || err == -ESTRPIPE) {
+        s->xruns++;
+        report_live_add(s->live_xruns, 1);
+    }
+
+    int ret = snd_pcm_recover(s->pcm, err, 1);
+    if (ret < 0) {
+        fprintf(stderr, "%s stream cannot recover: %s\n",
+                s->playback ? "Playback" : "Capture", snd_strerror(ret));
+        return false;
+    }
+
+    s->restart = true;
+    return true;
+}
+
+// Moves everything the hardware has room for (playback) or has ready
+// (capture), one contiguous chunk of the ring at a time
+static bool service_stream(pcm_stream_t *s, area_handler_t handler, void *context) {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(s->pcm);
+    if (avail < 0) {
+        return recover_stream(s, (int)avail);
+    }
+
+    while (avail > 0) {
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t frames = (snd_pcm_uframes_t)avail;
+
+        int err = snd_pcm_mmap_begin(s->pcm, &areas, &offset, &frames);
+        if (err < 0) {
+            return recover_stream(s, err);
+        }
+
+        handler(s, areas, offset, frames, context);
+
+        uint64_t start = s->trace_id ? trace_begin() : 0;
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(s->pcm, offset, frames);
+        if (committed < 0 || (snd_pcm_uframes_t)committed != frames) {
+            return recover_stream(s, committed < 0 ? (int)committed : -EPIPE);
+        }
+        if (start) {
+            // Only the commit is timed; the chunk is what the handler produced
+            uint64_t args[] = { s->trace_id, frames };
+            if (s->playback) {
+                trace_record_payload(TRACE_OP_PCM_WRITE, start, args, TRACE_ARGC(args),
+                                     chunk_frames(areas, offset), (size_t)snd_pcm_frames_to_bytes(s->pcm, frames));
+            } else {
+                trace_record(TRACE_OP_PCM_READ, start, args, TRACE_ARGC(args), NULL, 0);
+            }
+        }
+
+        s->position += frames;
+        s->committed += frames;
+        report_live_add(s->live_frames, frames);
+        avail -= (snd_pcm_sframes_t)frames;
+    }
+
+    return true;
+}
+
+// Playback is primed with a full buffer first, so the first period boundary
+// has something behind it
+static bool prime_stream(pcm_stream_t *s, area_handler_t handler, void *context) {
+    s->restart = false;
+    s->position = 0;
+    if (s->playback && !service_stream(s, handler, context)) {
+        return false;
+    }
+    return true;
+}
+
+static bool start_stream(pcm_stream_t *s) {
+    uint64_t start = s->trace_id ? trace_begin() : 0;
+    int err = snd_pcm_start(s->pcm);
+    if (err < 0) {
+        fprintf(stderr, "Cannot start %s stream: %s\n",
+                s->playback ? "playback" : "capture", snd_strerror(err));
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { s->trace_id };
+        trace_record(TRACE_OP_PCM_START, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+// Hardware position at the driver's last pointer update: frames played out
+// of the buffer, or frames written into it
+static bool hw_position(pcm_stream_t *s, uint64_t *frames, uint64_t *timestamp_ns) {
+    snd_pcm_uframes_t avail;
+    snd_htimestamp_t ts;
+    if (snd_pcm_htimestamp(s->pcm, &avail, &ts) < 0 || (ts.tv_sec == 0 && ts.tv_nsec == 0)) {
+        return false;
+    }
+
+    if (s->playback) {
+        if (s->position + avail < s->buffer_size) {
+            return false;
+        }
+        *frames = s->position + avail - s->buffer_size;
+    } else {
+        *frames = s->position + avail;
+    }
+    *timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    return true;
+}
+
+static void tone_handler(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                         snd_pcm_uframes_t offset, snd_pcm_uframes_t frames, void *context) {
+    stream_test_t *test = context;
+    int32_t values[KERNEL_FRAMES];
+
+    for (snd_pcm_uframes_t done = 0; done < frames; done += KERNEL_FRAMES) {
+        size_t count = frames - done < KERNEL_FRAMES ? frames - done : KERNEL_FRAMES;
+        for (size_t f = 0; f < count; f++) {
+            values[f] = (int32_t)(sin(test->phase) * TONE_LEVEL * FULL_SCALE);
+            test->phase += test->step;
+            if (test->phase >= 2.0 * M_PI) {
+                test->phase -= 2.0 * M_PI;
+            }
+        }
+        s->kernels->write(chunk_frames(areas, offset + done), values, count, s->channels);
+    }
+}
+
+static void peak_handler(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                         snd_pcm_uframes_t offset, snd_pcm_uframes_t frames, void *context) {
+    stream_test_t *test = context;
+    uint32_t levels[KERNEL_FRAMES];
+
+    for (snd_pcm_uframes_t done = 0; done < frames; done += KERNEL_FRAMES) {
+        size_t count = frames - done < KERNEL_FRAMES ? frames - done : KERNEL_FRAMES;
+        s->kernels->levels(chunk_frames(areas, offset + done), count, s->channels, levels);
+        for (size_t f = 0; f < count; f++) {
+            if (levels[f] > test->peak) {
+                test->peak = levels[f];
+            }
+        }
+    }
+}
+
+bool test_audio_stream(uint32_t device_index, audio_device_type_t direction,
+                       const audio_test_config_t *config, audio_stream_stats_t *stats) {
+    if (!config || !stats || (direction != AUDIO_DEVICE_PLAYBACK && direction != AUDIO_DEVICE_CAPTURE)) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(audio_stream_stats_t));
+
+    pcm_stream_t s;
+    if (!open_stream(&s, device_index, direction == AUDIO_DEVICE_PLAYBACK, config)) {
+        close_stream(&s);
+        return false;
+    }
+    stats->period_size = (uint32_t)s.period_size;
+    stats->buffer_size = (uint32_t)s.buffer_size;
+    stats->rate = s.rate;
+
+    stream_test_t test = { .phase = 0.0, .step = 2.0 * M_PI * TONE_FREQUENCY / s.rate, .peak = 0 };
+    area_handler_t handler = s.playback ? tone_handler : peak_handler;
+    bool result = prime_stream(&s, handler, &test) && start_stream(&s);
+
+    uint32_t duration = config->duration ? config->duration : AUDIO_STREAM_DEFAULT_DURATION;
+    int timeout = config->timeout ? (int)config->timeout : STREAM_TIMEOUT;
+    uint64_t now_ns = get_monotonic_ns();
+    uint64_t end_ns = now_ns + (uint64_t)duration * 1000000000ULL;
+    uint64_t last_wakeup_ns = now_ns;
+    uint64_t first_frames = 0, first_ts = 0, last_frames = 0, last_ts = 0;
+    bool have_first = false;
+
+    while (result && now_ns < end_ns) {
+        int ret = poll(s.pfds, s.nfds, timeout);
+        if (ret < 0 && errno == EINTR) {
+            now_ns = get_monotonic_ns();
+            continue;
+        }
+        if (ret <= 0) {
+            fprintf(stderr, "No period within %d ms\n", timeout);
+            result = false;
+            break;
+        }
+
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(s.pcm, s.pfds, s.nfds, &revents);
+        now_ns = get_monotonic_ns();
+        if (!revents) {
+            continue;
+        }
+
+        uint64_t before = s.committed;
+        result = service_stream(&s, handler, &test);
+        if (result && s.restart) {
+            // Rate measurement restarts with the stream
+            have_first = false;
+            result = prime_stream(&s, handler, &test) && start_stream(&s);
+            continue;
+        }
+        if (s.committed == before) {
+            continue;
+        }
+
+        stats->wakeups++;
+        double gap_ms = (double)(now_ns - last_wakeup_ns) / 1000000.0;
+        if (stats->wakeups > 1 && gap_ms > stats->max_wakeup_ms) {
+            stats->max_wakeup_ms = gap_ms;
+        }
+        last_wakeup_ns = now_ns;
+
+        uint64_t frames, ts;
+        if (hw_position(&s, &frames, &ts)) {
+            if (!have_first) {
+                first_frames = frames;
+                first_ts = ts;
+                have_first = true;
+            }
+            last_frames = frames;
+            last_ts = ts;
+        }
+    }
+
+    stats->frames = s.committed;
+    stats->xruns = s.xruns;
+    if (have_first && last_ts > first_ts) {
+        stats->measured_rate = (double)(last_frames - first_frames) * 1000000000.0 / (double)(last_ts - first_ts);
+    }
+    if (!s.playback) {
+        stats->peak_dbfs = test.peak ? 20.0 * log10((double)test.peak / FULL_SCALE) : -120.0;
+    }
+
+    close_stream(&s);
+    return result && stats->frames > 0;
+}
+
+bool test_audio_playback(uint32_t device_index, const audio_test_config_t *config) {
+    audio_stream_stats_t stats;
+    bool result = test_audio_stream(device_index, AUDIO_DEVICE_PLAYBACK, config, &stats);
+    if (result && stats.xruns) {
+        fprintf(stderr, "Playback underran %u times\n", stats.xruns);
+    }
+    return result && stats.xruns == 0;
+}
+
+bool test_audio_capture(uint32_t device_index, const audio_test_config_t *config) {
+    audio_stream_stats_t stats;
+    bool result = test_audio_stream(device_index, AUDIO_DEVICE_CAPTURE, config, &stats);
+    if (result && stats.xruns) {
+        fprintf(stderr, "Capture overran %u times\n", stats.xruns);
+    }
+    return result && stats.xruns == 0;
+}
+
+// Silence, except for a short full-scale burst when one is due
+static void impulse_handler(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                            snd_pcm_uframes_t offset, snd_pcm_uframes_t frames, void *context) {
+    loopback_t *loop = context;
+
+    silence_chunk(s, areas, offset, frames);
+    if (!loop->emit || frames < IMPULSE_FRAMES) {
+        return;
+    }
+
+    int32_t values[IMPULSE_FRAMES];
+    for (uint32_t f = 0; f < IMPULSE_FRAMES; f++) {
+        values[f] = (int32_t)(IMPULSE_LEVEL * FULL_SCALE);
+    }
+    s->kernels->write(chunk_frames(areas, offset), values, IMPULSE_FRAMES, s->channels);
+
+    loop->emit = false;
+    loop->pending = true;
+    loop->impulse_frame = s->position;
+    loop->impulse_ns = get_monotonic_ns();
+}
+
+static void detect_handler(pcm_stream_t *s, const snd_pcm_channel_area_t *areas,
+                           snd_pcm_uframes_t offset, snd_pcm_uframes_t frames, void *context) {
+    loopback_t *loop = context;
+    uint32_t levels[KERNEL_FRAMES];
+
+    for (snd_pcm_uframes_t f = 0; f < frames; f++) {
+        if (f % KERNEL_FRAMES == 0) {
+            size_t count = frames - f < KERNEL_FRAMES ? frames - f : KERNEL_FRAMES;
+            s->kernels->levels(chunk_frames(areas, offset + f), count, s->channels, levels);
+        }
+        uint32_t level = levels[f % KERNEL_FRAMES];
+
+        // The first stretch of capture, with silence going out, sets the
+        // detection threshold well clear of the noise floor
+        if (loop->threshold == 0) {
+            if (level > loop->noise_peak) {
+                loop->noise_peak = level;
+            }
+            if (++loop->noise_frames >= (uint64_t)s->rate * NOISE_WINDOW_MS / 1000) {
+                loop->threshold = (int64_t)loop->noise_peak * 4;
+                if (loop->threshold < (int64_t)(FULL_SCALE / 16)) {
+                    loop->threshold = (int64_t)(FULL_SCALE / 16);
+                }
+            }
+            continue;
+        }
+
+        if (!loop->pending || (int64_t)level < loop->threshold) {
+            continue;
+        }
+
+        uint64_t now_ns = get_monotonic_ns();
+        audio_latency_stats_t *stats = loop->stats;
+        loop->round_trip_ms[stats->detected++] = (double)(now_ns - loop->impulse_ns) / 1000000.0;
+
+        uint64_t capture_frame = s->position + f;
+        if (loop->linked && capture_frame >= loop->impulse_frame) {
+            loop->path_sum_ms += (double)(capture_frame - loop->impulse_frame) * 1000.0 / s->rate;
+            loop->path_count++;
+        }
+
+        loop->pending = false;
+        loop->next_ns = now_ns + IMPULSE_GAP_MS * 1000000ULL;
+    }
+}
+
+// An xrun on either side breaks the frame alignment between the two, so
+// both are stopped and restarted together
+static bool restart_loopback(loopback_t *loop, bool initial) {
+    if (!initial) {
+        snd_pcm_drop(loop->playback.pcm);
+        snd_pcm_drop(loop->capture.pcm);
+        if (snd_pcm_prepare(loop->playback.pcm) < 0 || snd_pcm_prepare(loop->capture.pcm) < 0) {
+            fprintf(stderr, "Cannot prepare loopback streams\n");
+            return false;
+        }
+        if (loop->pending || loop->emit) {
+            loop->aborted++;
+        }
+        loop->pending = false;
+        loop->emit = false;
+    }
+
+    if (!prime_stream(&loop->capture, detect_handler, loop) ||
+        !prime_stream(&loop->playback, impulse_handler, loop)) {
+        return false;
+    }
+
+    // Linked streams start on the same hardware tick
+    if (loop->linked) {
+        return start_stream(&loop->playback);
+    }
+    return start_stream(&loop->capture) && start_stream(&loop->playback);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Nearest-rank percentile of a sorted array
+static double percentile(const double *sorted, uint32_t count, double p) {
+    uint32_t rank = (uint32_t)ceil(p * count);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static void summarize_latency(loopback_t *loop) {
+    audio_latency_stats_t *stats = loop->stats;
+    uint32_t count = stats->detected;
+    if (count == 0) {
+        return;
+    }
+
+    qsort(loop->round_trip_ms, count, sizeof(double), compare_double);
+    stats->min_ms = loop->round_trip_ms[0];
+    stats->p50_ms = percentile(loop->round_trip_ms, count, 0.50);
+    stats->p90_ms = percentile(loop->round_trip_ms, count, 0.90);
+    stats->p99_ms = percentile(loop->round_trip_ms, count, 0.99);
+    stats->max_ms = loop->round_trip_ms[count - 1];
+    if (loop->path_count) {
+        stats->path_ms = loop->path_sum_ms / loop->path_count;
+    }
+}
+
+bool test_audio_loopback_latency(uint32_t device_index, const audio_test_config_t *config,
+                                 audio_latency_stats_t *stats) {
+    if (!config || !stats) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(audio_latency_stats_t));
+
+    uint32_t impulses = config->iterations > 1 ? config->iterations : AUDIO_LATENCY_IMPULSES;
+    loopback_t loop;
+    memset(&loop, 0, sizeof(loop));
+    loop.stats = stats;
+    loop.round_trip_ms = calloc(impulses, sizeof(double));
+    if (!loop.round_trip_ms) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+
+    bool result = open_stream(&loop.playback, device_index, true, config) &&
+                  open_stream(&loop.capture, device_index, false, config);
+    if (result && loop.playback.rate != loop.capture.rate) {
+        fprintf(stderr, "Playback and capture settled on different rates (%u, %u)\n",
+                loop.playback.rate, loop.capture.rate);
+        result = false;
+    }
+
+    struct pollfd *pfds = NULL;
+    if (result) {
+        stats->period_size = (uint32_t)loop.playback.period_size;
+        stats->buffer_size = (uint32_t)loop.playback.buffer_size;
+        stats->rate = loop.playback.rate;
+
+        uint64_t start = loop.capture.trace_id ? trace_begin() : 0;
+        loop.linked = snd_pcm_link(loop.capture.pcm, loop.playback.pcm) == 0;
+        stats->linked = loop.linked;
+        if (start && loop.linked) {
+            uint64_t args[] = { loop.capture.trace_id, loop.playback.trace_id };
+            trace_record(TRACE_OP_PCM_LINK, start, args, TRACE_ARGC(args), NULL, 0);
+        }
+        if (!loop.linked) {
+            fprintf(stderr, "Cannot link playback and capture, path latency unavailable\n");
+        }
+
+        pfds = calloc(loop.playback.nfds + loop.capture.nfds, sizeof(struct pollfd));
+        result = pfds != NULL && restart_loopback(&loop, true);
+    }
+
+    int timeout = config->timeout ? (int)config->timeout : STREAM_TIMEOUT;
+
+    while (result && (stats->impulses < impulses || loop.pending || loop.emit)) {
+        memcpy(pfds, loop.playback.pfds, loop.playback.nfds * sizeof(struct pollfd));
+        memcpy(pfds + loop.playback.nfds, loop.capture.pfds, loop.capture.nfds * sizeof(struct pollfd));
+
+        int ret = poll(pfds, loop.playback.nfds + loop.capture.nfds, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            fprintf(stderr, "No period within %d ms\n", timeout);
+            result = false;
+            break;
+        }
+
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(loop.capture.pcm, pfds + loop.playback.nfds, loop.capture.nfds, &revents);
+        if (revents) {
+            result = service_stream(&loop.capture, detect_handler, &loop);
+        }
+
+        revents = 0;
+        snd_pcm_poll_descriptors_revents(loop.playback.pcm, pfds, loop.playback.nfds, &revents);
+        if (result && revents) {
+            result = service_stream(&loop.playback, impulse_handler, &loop);
+        }
+
+        if (result && (loop.playback.restart || loop.capture.restart)) {
+            result = restart_loopback(&loop, false);
+            continue;
+        }
+
+        uint64_t now_ns = get_monotonic_ns();
+        if (loop.pending && now_ns - loop.impulse_ns > IMPULSE_TIMEOUT_MS * 1000000ULL) {
+            fprintf(stderr, "Impulse %u not detected within %d ms\n", stats->impulses, IMPULSE_TIMEOUT_MS);
+            loop.pending = false;
+            loop.next_ns = now_ns;
+        }
+        if (loop.threshold && !loop.pending && !loop.emit &&
+            stats->impulses < impulses && now_ns >= loop.next_ns) {
+            loop.emit = true;
+            stats->impulses++;
+        }
+    }
+
+    stats->xruns = loop.playback.xruns + loop.capture.xruns;
+    summarize_latency(&loop);
+
+    if (loop.linked) {
+        snd_pcm_unlink(loop.capture.pcm);
+    }
+    close_stream(&loop.capture);
+    close_stream(&loop.playback);
+    free(pfds);
+    free(loop.round_trip_ms);
+
+    // Impulses lost to an xrun are accounted for separately; anything else
+    // missing means the loop is not wired
+    return result && stats->detected > 0 && stats->detected + loop.aborted >= stats->impulses;
+}
+
+bool test_audio_latency(uint32_t device_index, const audio_test_config_t *config, uint32_t *latency_ms) {
+    audio_latency_stats_t stats;
+    if (!latency_ms) {
+        return false;
+    }
+
+    bool result = test_audio_loopback_latency(device_index, config, &stats);
+    *latency_ms = (uint32_t)(stats.p50_ms + 0.5);
+    return result;
+}
+
+bool audio_sweep_init(sweep_t *sweep, uint32_t device_index, const audio_test_config_t *base) {
+    audio_device_info_t info;
+    if (!sweep || !base || !get_audio_device_info(device_index, &info)) {
+        return false;
+    }
+
+    sweep_init(sweep, "ALSA Stream Rate", "frames/s");
+    sweep_axis_t *rates = sweep_add_axis(sweep, "rate");
+    sweep_axis_t *channels = sweep_add_axis(sweep, "channels");
+    sweep_axis_t *formats = sweep_add_axis(sweep, "format");
+
+    char label[SWEEP_LABEL_SIZE];
+    for (uint32_t i = 0; i < info.sample_rate_count; i++) {
+        snprintf(label, sizeof(label), "%u", info.sample_rates[i]);
+        sweep_axis_add(rates, info.sample_rates[i], label);
+    }
+    for (uint32_t i = 0; i < info.channel_count; i++) {
+        sweep_axis_add(channels, info.channels[i], audio_channel_to_string(info.channels[i]));
+    }
+    for (uint32_t i = 0; i < info.format_count; i++) {
+        sweep_axis_add(formats, info.formats[i], audio_format_to_string(info.formats[i]));
+    }
+
+    return sweep_point_count(sweep) > 0;
+}
+
+// Each point reopens the PCM: hw_params cannot change on a prepared stream
+bool audio_sweep_stream_rate(void *context, const sweep_point_t *point, double *value) {
+    const audio_sweep_context_t *sweep_context = context;
+    audio_test_config_t config = sweep_context->config;
+    config.sample_rate = (uint32_t)point->values[0];
+    config.channels = (audio_channel_t)point->values[1];
+    config.format = (audio_format_t)point->values[2];
+    config.duration = AUDIO_SWEEP_DURATION;
+
+    // A rate the plugin resampled to is not the point being measured
+    audio_stream_stats_t stats;
+    if (!test_audio_stream(sweep_context->device_index, sweep_context->direction, &config, &stats) ||
+        stats.rate != config.sample_rate || stats.measured_rate <= 0.0) {
+        return false;
+    }
+
+    *value = stats.measured_rate;
+    return true;
+}
+
+// Trace replay. Writes copy the recorded chunk into the ring straight from
+// the trace mapping and time only the commits, as the recording did. A
+// chunk larger than the free space waits for the hardware; a ring that is
+// full but not yet started (a restart after an xrun) is started.
+typedef struct {
+    uint32_t trace_id;
+    pcm_stream_t stream;
+} replay_stream_t;
+
+static replay_stream_t *replay_streams = NULL;
+static uint32_t replay_stream_count = 0;
+static uint32_t replay_stream_capacity = 0;
+
+static replay_stream_t *find_replay_stream(uint64_t trace_id) {
+    for (uint32_t i = 0; i < replay_stream_count; i++) {
+        if (replay_streams[i].trace_id == trace_id) {
+            return &replay_streams[i];
+        }
+    }
+    return NULL;
+}
+
+static bool replay_open(const trace_record_t *record, uint64_t *duration_ns) {
+    if (record->argc < 9) {
+        return false;
+    }
+    if (replay_stream_count == replay_stream_capacity) {
+        uint32_t capacity = replay_stream_capacity ? replay_stream_capacity * 2 : 4;
+        replay_stream_t *streams = realloc(replay_streams, capacity * sizeof(*streams));
+        if (!streams) {
+            return false;
+        }
+        replay_streams = streams;
+        replay_stream_capacity = capacity;
+    }
+
+    audio_test_config_t config = {
+        .format = (audio_format_t)record->args[3],
+        .channels = (audio_channel_t)record->args[4],
+        .sample_rate = (uint32_t)record->args[5],
+        .periods = (uint32_t)record->args[6],
+        .period_size = (uint32_t)record->args[7],
+        .buffer_size = (uint32_t)record->args[8]
+    };
+    replay_stream_t *entry = &replay_streams[replay_stream_count];
+    uint64_t start = report_time_now_ns();
+    bool ok = open_stream(&entry->stream, (uint32_t)record->args[1], record->args[2] != 0, &config);
+    *duration_ns = report_time_now_ns() - start;
+    if (!ok) {
+        close_stream(&entry->stream);
+        return false;
+    }
+    entry->trace_id = (uint32_t)record->args[0];
+    replay_stream_count++;
+    return true;
+}
+
+static void replay_close(replay_stream_t *entry) {
+    close_stream(&entry->stream);
+    *entry = replay_streams[--replay_stream_count];
+}
+
+static bool replay_start(pcm_stream_t *s) {
+    // Linked to a stream that already started it
+    if (snd_pcm_state(s->pcm) == SND_PCM_STATE_RUNNING) {
+        return true;
+    }
+    s->restart = false;
+    return start_stream(s);
+}
+
+// Moves frames through the ring, from payload for playback; returns the
+// time spent in commits
+static bool replay_transfer(pcm_stream_t *s, snd_pcm_uframes_t frames, const uint8_t *payload,
+                            uint64_t *commit_ns) {
+    size_t frame_bytes = (size_t)snd_pcm_frames_to_bytes(s->pcm, 1);
+    *commit_ns = 0;
+    while (frames > 0) {
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(s->pcm);
+        if (avail < 0) {
+            if (!recover_stream(s, (int)avail)) {
+                return false;
+            }
+            if (!s->playback && !replay_start(s)) {
+                return false;
+            }
+            continue;
+        }
+        if (avail == 0) {
+            if (s->playback && snd_pcm_state(s->pcm) == SND_PCM_STATE_PREPARED) {
+                if (!replay_start(s)) {
+                    return false;
+                }
+                continue;
+            }
+            int ret = snd_pcm_wait(s->pcm, STREAM_TIMEOUT);
+            if (ret == 0) {
+                fprintf(stderr, "Timed out replaying %s stream\n", s->playback ? "playback" : "capture");
+                return false;
+            }
+            if (ret < 0 && !recover_stream(s, ret)) {
+                return false;
+            }
+            continue;
+        }
+
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t chunk = (snd_pcm_uframes_t)avail < frames ? (snd_pcm_uframes_t)avail : frames;
+        int err = snd_pcm_mmap_begin(s->pcm, &areas, &offset, &chunk);
+        if (err < 0) {
+            if (!recover_stream(s, err)) {
+                return false;
+            }
+            continue;
+        }
+        if (payload) {
+            memcpy(chunk_frames(areas, offset), payload, chunk * frame_bytes);
+            payload += chunk * frame_bytes;
+        }
+
+        uint64_t start = report_time_now_ns();
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(s->pcm, offset, chunk);
+        *commit_ns += report_time_now_ns() - start;
+        if (committed < 0 || (snd_pcm_uframes_t)committed != chunk) {
+            if (!recover_stream(s, committed < 0 ? (int)committed : -EPIPE)) {
+                return false;
+            }
+            continue;
+        }
+        s->position += chunk;
+        s->committed += chunk;
+        frames -= chunk;
+    }
+    return true;
+}
+
+bool audio_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns) {
+    (void)context;
+    if (record->op == TRACE_OP_PCM_OPEN) {
+        return replay_open(record, duration_ns);
+    }
+
+    replay_stream_t *entry = record->argc ? find_replay_stream(record->args[0]) : NULL;
+    if (!entry) {
+        return false;
+    }
+    pcm_stream_t *s = &entry->stream;
+    uint64_t start = report_time_now_ns();
+    bool ok;
+    switch (record->op) {
+        case TRACE_OP_PCM_CLOSE:
+            replay_close(entry);
+            ok = true;
+            break;
+        case TRACE_OP_PCM_START:
+            ok = replay_start(s);
+            break;
+        case TRACE_OP_PCM_LINK: {
+            replay_stream_t *other = record->argc > 1 ? find_replay_stream(record->args[1]) : NULL;
+            ok = other && snd_pcm_link(s->pcm, other->stream.pcm) == 0;
+            break;
+        }
+        case TRACE_OP_PCM_WRITE:
+        case TRACE_OP_PCM_READ: {
+            snd_pcm_uframes_t frames = record->argc > 1 ? (snd_pcm_uframes_t)record->args[1] : 0;
+            bool playback = record->op == TRACE_OP_PCM_WRITE;
+            if (playback != s->playback ||
+                (playback && (!record->payload ||
+                              record->payload_size < (size_t)snd_pcm_frames_to_bytes(s->pcm, frames)))) {
+                return false;
+            }
+            return replay_transfer(s, frames, playback ? record->payload : NULL, duration_ns);
+        }
+        default:
+            return false;
+    }
+    *duration_ns = report_time_now_ns() - start;
+    return ok;
+}
+
+void audio_trace_finish(void *context) {
+    (void)context;
+    while (replay_stream_count) {
+        replay_close(&replay_streams[0]);
+    }
+    free(replay_streams);
+    replay_streams = NULL;
+    replay_stream_capacity = 0;
+}
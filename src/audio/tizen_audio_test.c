@@ -17,244 +17,226 @@
  */
 
 #include "audio/tizen_audio_test.h"
+#include "audio/audio_convert.h"
+#include "common/test_pattern.h"
+#include "common/cap_cache.h"
+#include "common/worker_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
 #include <alsa/asoundlib.h>
 
-#define TEST_TIMEOUT 5000 // 5 seconds
+#define MAX_CARDS 32   // SNDRV_CARDS
 
-static snd_pcm_t *playback_handle = NULL;
-static snd_pcm_t *capture_handle = NULL;
-static audio_device_info_t *devices = NULL;
+// A card found at init. Opening its control and PCMs is left to the first
+// caller that needs the capabilities.
+typedef struct {
+    int card;                     // ALSA card number
+    pthread_mutex_t lock;         // Held while probing
+    bool probed;
+    bool valid;                   // Probe succeeded
+    audio_device_info_t info;
+} audio_device_slot_t;
+
+// Shared by every job testing an ALSA card; the list lives as long as any
+// of them holds the framework
+static pthread_mutex_t framework_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t framework_users = 0;
+static audio_device_slot_t *devices = NULL;
 static uint32_t device_count = 0;
 
-// Static helper functions
-static bool open_pcm_device(uint32_t device_index, snd_pcm_stream_t stream, snd_pcm_t **handle) {
-    char device_name[64];
-    snprintf(device_name, sizeof(device_name), "hw:%d,0", device_index);
+// Lists the cards in one pass without opening any of them
+static bool discover_audio_devices(void) {
+    int cards[MAX_CARDS];
+    int card = -1;
+    device_count = 0;
     
-    int err = snd_pcm_open(handle, device_name, stream, 0);
-    if (err < 0) {
-        fprintf(stderr, "Cannot open PCM device %s: %s\n", device_name, snd_strerror(err));
-        return false;
+    while (device_count < MAX_CARDS && snd_card_next(&card) >= 0 && card >= 0) {
+        cards[device_count++] = card;
     }
-    return true;
-}
-
-static bool set_pcm_params(snd_pcm_t *handle, const audio_test_config_t *config) {
-    snd_pcm_hw_params_t *params;
     
-    snd_pcm_hw_params_alloca(&params);
-    snd_pcm_hw_params_any(handle, params);
-    
-    int err;
-    
-    // Set access type
-    err = snd_pcm_hw_params_set_access(handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
-    if (err < 0) {
-        fprintf(stderr, "Cannot set access type: %s\n", snd_strerror(err));
+    if (device_count == 0) {
+        fprintf(stderr, "No sound cards found\n");
         return false;
     }
     
-    // Set format
-    snd_pcm_format_t format;
-    switch (config->format) {
-        case AUDIO_FORMAT_PCM_S16LE:
-            format = SND_PCM_FORMAT_S16_LE;
-            break;
-        case AUDIO_FORMAT_PCM_S24LE:
-            format = SND_PCM_FORMAT_S24_LE;
-            break;
-        case AUDIO_FORMAT_PCM_S32LE:
-            format = SND_PCM_FORMAT_S32_LE;
-            break;
-        default:
-            fprintf(stderr, "Unsupported format\n");
-            return false;
-    }
-    
-    err = snd_pcm_hw_params_set_format(handle, params, format);
-    if (err < 0) {
-        fprintf(stderr, "Cannot set format: %s\n", snd_strerror(err));
+    devices = calloc(device_count, sizeof(audio_device_slot_t));
+    if (!devices) {
+        fprintf(stderr, "Memory allocation failed\n");
+        device_count = 0;
         return false;
     }
     
-    // Set channels
-    unsigned int channels;
-    switch (config->channels) {
-        case AUDIO_CHANNEL_MONO:
-            channels = 1;
-            break;
-        case AUDIO_CHANNEL_STEREO:
-            channels = 2;
-            break;
-        case AUDIO_CHANNEL_2_1:
-            channels = 3;
-            break;
-        case AUDIO_CHANNEL_5_1:
-            channels = 6;
-            break;
-        case AUDIO_CHANNEL_7_1:
-            channels = 8;
-            break;
-        default:
-            fprintf(stderr, "Unsupported channel configuration\n");
-            return false;
+    for (uint32_t i = 0; i < device_count; i++) {
+        devices[i].card = cards[i];
+        pthread_mutex_init(&devices[i].lock, NULL);
     }
     
-    err = snd_pcm_hw_params_set_channels(handle, params, channels);
+    return true;
+}
+
+// A busy PCM exists but says nothing else; count it as present
+static bool pcm_present(const char *name, snd_pcm_stream_t stream, bool *busy) {
+    snd_pcm_t *pcm_handle;
+    int err = snd_pcm_open(&pcm_handle, name, stream, SND_PCM_NONBLOCK);
+    if (err >= 0) {
+        snd_pcm_close(pcm_handle);
+        return true;
+    }
+    if (err == -EBUSY || err == -EAGAIN) {
+        *busy = true;
+        return true;
+    }
+    return false;
+}
+
+// busy is set when a direction could not be probed because another
+// process holds it, so the result is not worth caching
+static bool get_device_capabilities(int card, audio_device_info_t *info, bool *busy) {
+    char name[64];
+    snprintf(name, sizeof(name), "hw:%d", card);
+    
+    // Get device info
+    snd_ctl_t *handle;
+    int err = snd_ctl_open(&handle, name, 0);
     if (err < 0) {
-        fprintf(stderr, "Cannot set channels: %s\n", snd_strerror(err));
+        fprintf(stderr, "Control open error: %s\n", snd_strerror(err));
         return false;
     }
     
-    // Set sample rate
-    unsigned int rate = config->sample_rate;
-    err = snd_pcm_hw_params_set_rate_near(handle, params, &rate, 0);
+    // Get device name
+    snd_ctl_card_info_t *card_info;
+    snd_ctl_card_info_alloca(&card_info);
+    err = snd_ctl_card_info(handle, card_info);
     if (err < 0) {
-        fprintf(stderr, "Cannot set sample rate: %s\n", snd_strerror(err));
+        fprintf(stderr, "Control info error: %s\n", snd_strerror(err));
+        snd_ctl_close(handle);
         return false;
     }
     
-    // Set buffer size
-    snd_pcm_uframes_t buffer_size = config->buffer_size;
-    err = snd_pcm_hw_params_set_buffer_size_near(handle, params, &buffer_size);
-    if (err < 0) {
-        fprintf(stderr, "Cannot set buffer size: %s\n", snd_strerror(err));
-        return false;
-    }
+    memset(info, 0, sizeof(*info));
+    strncpy(info->name, snd_ctl_card_info_get_name(card_info), sizeof(info->name) - 1);
     
-    // Apply params
-    err = snd_pcm_hw_params(handle, params);
-    if (err < 0) {
-        fprintf(stderr, "Cannot set parameters: %s\n", snd_strerror(err));
-        return false;
+    // Check device type; a card with neither direction is left as playback
+    info->type = AUDIO_DEVICE_PLAYBACK;
+    bool playback = pcm_present(name, SND_PCM_STREAM_PLAYBACK, busy);
+    if (pcm_present(name, SND_PCM_STREAM_CAPTURE, busy)) {
+        info->type = playback ? AUDIO_DEVICE_BOTH : AUDIO_DEVICE_CAPTURE;
     }
     
-    return true;
-}
-
-// Framework initialization/cleanup
-bool init_audio_test_framework(void) {
-    // Discover available devices
-    int card = -1;
-    int device = -1;
-    device_count = 0;
+    // Get supported sample rates and formats (simplified for brevity)
+    info->sample_rates[0] = 44100;
+    info->sample_rates[1] = 48000;
+    info->sample_rate_count = 2;
     
-    // Count devices first
-    while (snd_card_next(&card) >= 0 && card >= 0) {
-        device_count++;
-    }
+    info->formats[0] = AUDIO_FORMAT_PCM_S16LE;
+    info->formats[1] = AUDIO_FORMAT_PCM_S24LE;
+    info->format_count = 2;
     
-    if (device_count == 0) {
-        fprintf(stderr, "No sound cards found\n");
-        return false;
-    }
+    info->channels[0] = AUDIO_CHANNEL_MONO;
+    info->channels[1] = AUDIO_CHANNEL_STEREO;
+    info->channel_count = 2;
     
-    // Allocate device info array
-    devices = malloc(device_count * sizeof(audio_device_info_t));
-    if (!devices) {
-        fprintf(stderr, "Memory allocation failed\n");
-        return false;
-    }
-    
-    // Fill device info
-    card = -1;
-    int device_index = 0;
+    info->min_buffer_size = 1024;
+    info->max_buffer_size = 65536;
     
-    while (snd_card_next(&card) >= 0 && card >= 0) {
-        char name[64];
-        snprintf(name, sizeof(name), "hw:%d", card);
-        
-        // Get device info
-        snd_ctl_t *handle;
-        int err = snd_ctl_open(&handle, name, 0);
-        if (err < 0) {
-            fprintf(stderr, "Control open error: %s\n", snd_strerror(err));
-            continue;
-        }
-        
-        // Get device name
-        snd_ctl_card_info_t *info;
-        snd_ctl_card_info_alloca(&info);
-        err = snd_ctl_card_info(handle, info);
-        if (err < 0) {
-            fprintf(stderr, "Control info error: %s\n", snd_strerror(err));
-            snd_ctl_close(handle);
-            continue;
-        }
-        
-        strncpy(devices[device_index].name, snd_ctl_card_info_get_name(info), sizeof(devices[device_index].name));
-        
-        // Check device type
-        snd_pcm_t *pcm_handle;
-        err = snd_pcm_open(&pcm_handle, name, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
-        if (err >= 0) {
-            devices[device_index].type = AUDIO_DEVICE_PLAYBACK;
-            snd_pcm_close(pcm_handle);
-        }
+    snd_ctl_close(handle);
+    return true;
+}
+
+// Probes a card once, from the capability cache when its driver has not
+// changed since it was last probed. A probe that found a direction busy
+// is neither cached nor kept, so the next query tries again.
+static bool probe_device(audio_device_slot_t *slot) {
+    pthread_mutex_lock(&slot->lock);
+    if (!slot->probed) {
+        char sysfs_node[64];
+        char key[CAP_CACHE_KEY_SIZE];
+        snprintf(sysfs_node, sizeof(sysfs_node), "/sys/class/sound/card%d", slot->card);
+        bool keyed = cap_cache_device_key(sysfs_node, key, sizeof(key));
         
-        err = snd_pcm_open(&pcm_handle, name, SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK);
-        if (err >= 0) {
-            devices[device_index].type = devices[device_index].type == AUDIO_DEVICE_PLAYBACK ? 
-                                         AUDIO_DEVICE_BOTH : AUDIO_DEVICE_CAPTURE;
-            snd_pcm_close(pcm_handle);
+        bool busy = false;
+        if (keyed && cap_cache_lookup(key, &slot->info, sizeof(slot->info))) {
+            slot->valid = true;
+        } else {
+            slot->valid = get_device_capabilities(slot->card, &slot->info, &busy);
+            if (slot->valid && keyed && !busy) {
+                cap_cache_store(key, &slot->info, sizeof(slot->info));
+            }
         }
-        
-        // Get supported sample rates and formats (simplified for brevity)
-        devices[device_index].sample_rates[0] = 44100;
-        devices[device_index].sample_rates[1] = 48000;
-        devices[device_index].sample_rate_count = 2;
-        
-        devices[device_index].formats[0] = AUDIO_FORMAT_PCM_S16LE;
-        devices[device_index].formats[1] = AUDIO_FORMAT_PCM_S24LE;
-        devices[device_index].format_count = 2;
-        
-        devices[device_index].channels[0] = AUDIO_CHANNEL_MONO;
-        devices[device_index].channels[1] = AUDIO_CHANNEL_STEREO;
-        devices[device_index].channel_count = 2;
-        
-        devices[device_index].min_buffer_size = 1024;
-        devices[device_index].max_buffer_size = 65536;
-        
-        snd_ctl_close(handle);
-        device_index++;
+        slot->probed = !busy;
     }
+    bool valid = slot->valid;
+    pthread_mutex_unlock(&slot->lock);
     
-    return true;
+    return valid;
 }
 
-void cleanup_audio_test_framework(void) {
-    if (playback_handle) {
-        snd_pcm_close(playback_handle);
-        playback_handle = NULL;
+static bool probe_device_job(void *arg) {
+    return probe_device(arg);
+}
+
+// Probes every card still unknown at once, each on its own worker
+static void probe_all_devices(void) {
+    worker_job_t jobs[MAX_CARDS];
+    uint32_t count = 0;
+    
+    for (uint32_t i = 0; i < device_count; i++) {
+        if (!devices[i].probed) {
+            char name[32];
+            snprintf(name, sizeof(name), "probe card%d", devices[i].card);
+            worker_job_init(&jobs[count++], name, probe_device_job, &devices[i]);
+        }
     }
     
-    if (capture_handle) {
-        snd_pcm_close(capture_handle);
-        capture_handle = NULL;
+    if (count > 0) {
+        worker_pool_run(jobs, count, count);
     }
+}
+
+// Framework initialization/cleanup
+bool init_audio_test_framework(void) {
+    pthread_mutex_lock(&framework_lock);
+    bool result = framework_users > 0 || discover_audio_devices();
+    if (result) {
+        framework_users++;
+    }
+    pthread_mutex_unlock(&framework_lock);
     
-    if (devices) {
+    return result;
+}
+
+void cleanup_audio_test_framework(void) {
+    pthread_mutex_lock(&framework_lock);
+    if (framework_users > 0 && --framework_users == 0) {
+        for (uint32_t i = 0; i < device_count; i++) {
+            pthread_mutex_destroy(&devices[i].lock);
+        }
         free(devices);
         devices = NULL;
+        device_count = 0;
     }
-    
-    device_count = 0;
+    pthread_mutex_unlock(&framework_lock);
 }
 
 // Device enumeration and information
 uint32_t get_audio_device_count(audio_device_type_t type) {
-    uint32_t count = 0;
+    // Every card counts for AUDIO_DEVICE_BOTH, so only a direction filter
+    // has to open them
+    if (type == AUDIO_DEVICE_BOTH) {
+        return device_count;
+    }
     
+    probe_all_devices();
+    
+    uint32_t count = 0;
     for (uint32_t i = 0; i < device_count; i++) {
-        if (devices[i].type == type || 
-            devices[i].type == AUDIO_DEVICE_BOTH ||
-            type == AUDIO_DEVICE_BOTH) {
+        if (probe_device(&devices[i]) &&
+            (devices[i].info.type == type || devices[i].info.type == AUDIO_DEVICE_BOTH)) {
             count++;
         }
     }
@@ -263,11 +245,11 @@ uint32_t get_audio_device_count(audio_device_type_t type) {
 }
 
 bool get_audio_device_info(uint32_t device_index, audio_device_info_t *info) {
-    if (device_index >= device_count || !info) {
+    if (device_index >= device_count || !info || !probe_device(&devices[device_index])) {
         return false;
     }
     
-    memcpy(info, &devices[device_index], sizeof(audio_device_info_t));
+    memcpy(info, &devices[device_index].info, sizeof(audio_device_info_t));
     return true;
 }
 
@@ -283,37 +265,12 @@ audio_buffer_t *create_audio_buffer(const audio_test_config_t *config) {
     }
     
     // Calculate buffer size in bytes
-    uint32_t channels;
-    switch (config->channels) {
-        case AUDIO_CHANNEL_MONO: channels = 1; break;
-        case AUDIO_CHANNEL_STEREO: channels = 2; break;
-        case AUDIO_CHANNEL_2_1: channels = 3; break;
-        case AUDIO_CHANNEL_5_1: channels = 6; break;
-        case AUDIO_CHANNEL_7_1: channels = 8; break;
-        default: channels = 2; break;
-    }
+    uint32_t channels = audio_channel_count(config->channels);
     
-    uint32_t bytes_per_sample;
-    switch (config->format) {
-        case AUDIO_FORMAT_PCM_S8:
-        case AUDIO_FORMAT_PCM_U8:
-            bytes_per_sample = 1;
-            break;
-        case AUDIO_FORMAT_PCM_S16LE:
-        case AUDIO_FORMAT_PCM_S16BE:
-            bytes_per_sample = 2;
-            break;
-        case AUDIO_FORMAT_PCM_S24LE:
-        case AUDIO_FORMAT_PCM_S24BE:
-            bytes_per_sample = 3;
-            break;
-        case AUDIO_FORMAT_PCM_S32LE:
-        case AUDIO_FORMAT_PCM_S32BE:
-            bytes_per_sample = 4;
-            break;
-        default:
-            bytes_per_sample = 2;
-            break;
+    // Compressed formats are sized as S16
+    uint32_t bytes_per_sample = audio_format_sample_size(config->format);
+    if (!bytes_per_sample) {
+        bytes_per_sample = 2;
     }
     
     buffer->size = config->buffer_size * channels * bytes_per_sample;
@@ -336,9 +293,9 @@ bool fill_audio_buffer(audio_buffer_t *buffer, uint32_t pattern) {
         return false;
     }
     
-    // Simple pattern fill
-    memset(buffer->data, pattern & 0xFF, buffer->size);
-    return true;
+    // Byte pattern replicated across the buffer
+    test_pattern_t fill = pattern_solid_byte(pattern & 0xFF);
+    return pattern_fill(buffer->data, buffer->size, &fill, 0, 0);
 }
 
 bool verify_audio_buffer(audio_buffer_t *buffer, uint32_t pattern) {
@@ -346,12 +303,11 @@ bool verify_audio_buffer(audio_buffer_t *buffer, uint32_t pattern) {
         return false;
     }
     
-    // Simple pattern verification
-    uint8_t *data = (uint8_t *)buffer->data;
-    for (uint32_t i = 0; i < buffer->size; i++) {
-        if (data[i] != (pattern & 0xFF)) {
-            return false;
-        }
+    test_pattern_t expected = pattern_solid_byte(pattern & 0xFF);
+    size_t offset = 0;
+    if (!pattern_verify(buffer->data, buffer->size, &expected, 0, 0, &offset)) {
+        fprintf(stderr, "Audio buffer pattern mismatch at byte %zu\n", offset);
+        return false;
     }
     
     return true;
@@ -366,61 +322,12 @@ void destroy_audio_buffer(audio_buffer_t *buffer) {
     }
 }
 
-// Feature testing
-bool test_audio_playback(uint32_t device_index, const audio_test_config_t *config) {
-    if (!open_pcm_device(device_index, SND_PCM_STREAM_PLAYBACK, &playback_handle)) {
-        return false;
-    }
-    
-    if (!set_pcm_params(playback_handle, config)) {
-        snd_pcm_close(playback_handle);
-        playback_handle = NULL;
-        return false;
-    }
-    
-    // Create test buffer
-    audio_buffer_t *buffer = create_audio_buffer(config);
-    if (!buffer) {
-        snd_pcm_close(playback_handle);
-        playback_handle = NULL;
-        return false;
-    }
-    
-    // Fill buffer with test pattern
-    if (!fill_audio_buffer(buffer, 0x55)) {
-        destroy_audio_buffer(buffer);
-        snd_pcm_close(playback_handle);
-        playback_handle = NULL;
-        return false;
-    }
-    
-    // Play buffer
-    snd_pcm_uframes_t frames = buffer->frame_count;
-    int err = snd_pcm_writei(playback_handle, buffer->data, frames);
-    if (err < 0) {
-        fprintf(stderr, "Write error: %s\n", snd_strerror(err));
-        destroy_audio_buffer(buffer);
-        snd_pcm_close(playback_handle);
-        playback_handle = NULL;
-        return false;
-    }
-    
-    // Wait for playback to complete
-    snd_pcm_drain(playback_handle);
-    
-    // Cleanup
-    destroy_audio_buffer(buffer);
-    snd_pcm_close(playback_handle);
-    playback_handle = NULL;
-    
-    return true;
-}
-
 // Comprehensive testing
 bool test_all_audio_features(uint32_t device_index, const audio_test_config_t *config) {
     bool result = true;
     
     result &= test_audio_playback(device_index, config);
+    result &= test_audio_capture(device_index, config);
     
     // Add calls to other test functions here
     
@@ -482,6 +389,17 @@ const char *audio_feature_to_string(audio_feature_t feature) {
     }
 }
 
+uint32_t audio_channel_count(audio_channel_t channels) {
+    switch (channels) {
+        case AUDIO_CHANNEL_MONO: return 1;
+        case AUDIO_CHANNEL_STEREO: return 2;
+        case AUDIO_CHANNEL_2_1: return 3;
+        case AUDIO_CHANNEL_5_1: return 6;
+        case AUDIO_CHANNEL_7_1: return 8;
+        default: return 2;
+    }
+}
+
 audio_test_result_t convert_bool_to_test_result(bool result) {
     return result ? AUDIO_TEST_PASS : AUDIO_TEST_FAIL;
 }
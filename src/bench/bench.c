@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Benchmark harness: calibrated batches, median of repeated samples and
+// comparison against a stored baseline
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bench/bench.h"
+#include "common/test_pattern.h"
+#include "report/report_timing.h"
+
+#define BENCH_MAX_ITERATIONS (1ull << 32)
+#define BENCH_MAX_GROWTH 16
+// A regression must also clear this many MADs of either run
+#define BENCH_NOISE_MADS 3.0
+
+static bench_config_t config = {
+    .samples = 15,
+    .warmup_ns = 50000000ull,
+    .sample_ns = 2000000ull,
+    .filter = NULL,
+};
+static bench_result_t results[BENCH_MAX_CASES];
+static uint32_t result_count = 0;
+static double overhead_ns = 0.0;
+static double overhead_ratio = 0.0;
+
+static void run_nothing(void *context, uint64_t iterations) {
+    (void)context;
+    (void)iterations;
+}
+
+static uint64_t time_batch(const bench_case_t *bench, uint64_t iterations) {
+    uint64_t start = report_time_now_ns();
+    bench->run(bench->context, iterations);
+    return report_time_now_ns() - start;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_of(double *values, uint32_t count) {
+    qsort(values, count, sizeof(double), compare_double);
+    if (count % 2) {
+        return values[count / 2];
+    }
+    return (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+static void format_ns(double ns, char *text, size_t size) {
+    if (ns < 1e3) {
+        snprintf(text, size, "%.1f ns", ns);
+    } else if (ns < 1e6) {
+        snprintf(text, size, "%.2f us", ns / 1e3);
+    } else if (ns < 1e9) {
+        snprintf(text, size, "%.2f ms", ns / 1e6);
+    } else {
+        snprintf(text, size, "%.2f s", ns / 1e9);
+    }
+}
+
+// Grows the batch until one takes sample_ns, and keeps running it until
+// warmup_ns has passed so caches, page tables and clocks have settled
+static uint64_t calibrate(const bench_case_t *bench) {
+    uint64_t iterations = 1;
+    uint64_t start = report_time_now_ns();
+
+    for (;;) {
+        uint64_t elapsed = time_batch(bench, iterations);
+        if (elapsed < config.sample_ns && iterations < BENCH_MAX_ITERATIONS) {
+            uint64_t next = elapsed ? iterations * config.sample_ns / elapsed + 1 : iterations * BENCH_MAX_GROWTH;
+            if (next > iterations * BENCH_MAX_GROWTH) {
+                next = iterations * BENCH_MAX_GROWTH;
+            }
+            if (next > BENCH_MAX_ITERATIONS) {
+                next = BENCH_MAX_ITERATIONS;
+            }
+            iterations = next > iterations ? next : iterations + 1;
+            continue;
+        }
+        if (report_time_now_ns() - start >= config.warmup_ns) {
+            return iterations;
+        }
+    }
+}
+
+void bench_init(const bench_config_t *cfg) {
+    if (cfg) {
+        config = *cfg;
+    }
+    if (config.samples == 0) {
+        config.samples = 1;
+    }
+    if (config.samples > BENCH_MAX_SAMPLES) {
+        config.samples = BENCH_MAX_SAMPLES;
+    }
+    result_count = 0;
+    overhead_ratio = 0.0;
+
+    // An empty sample costs two clock reads and an indirect call
+    bench_case_t nothing = { .name = "overhead", .run = run_nothing };
+    double samples[BENCH_MAX_SAMPLES];
+    for (uint32_t i = 0; i < BENCH_MAX_SAMPLES; i++) {
+        samples[i] = (double)time_batch(&nothing, 1);
+    }
+    overhead_ns = median_of(samples, BENCH_MAX_SAMPLES);
+
+    printf("%-44s %12s %10s %12s %12s\n", "Benchmark", "Median", "MAD", "Iterations", "Throughput");
+}
+
+bool bench_run(const bench_case_t *bench) {
+    if (config.filter && !strstr(bench->name, config.filter)) {
+        return false;
+    }
+    if (result_count >= BENCH_MAX_CASES) {
+        fprintf(stderr, "Too many benchmarks, %s not run\n", bench->name);
+        return false;
+    }
+    if (bench->setup && !bench->setup(bench->context)) {
+        bench_skip(bench->name, "setup failed");
+        return false;
+    }
+
+    uint64_t iterations = calibrate(bench);
+    double samples[BENCH_MAX_SAMPLES];
+    double deviations[BENCH_MAX_SAMPLES];
+    uint64_t shortest = UINT64_MAX;
+    for (uint32_t i = 0; i < config.samples; i++) {
+        uint64_t elapsed = time_batch(bench, iterations);
+        if (elapsed < shortest) {
+            shortest = elapsed;
+        }
+        samples[i] = (double)elapsed / iterations;
+    }
+
+    if (bench->teardown) {
+        bench->teardown(bench->context);
+    }
+
+    bench_result_t *result = &results[result_count++];
+    snprintf(result->name, sizeof(result->name), "%s", bench->name);
+    result->iterations = iterations;
+    result->samples = config.samples;
+    result->bytes = bench->bytes;
+    result->median_ns = median_of(samples, config.samples);
+    result->min_ns = samples[0];            // Sorted by median_of()
+    for (uint32_t i = 0; i < config.samples; i++) {
+        deviations[i] = fabs(samples[i] - result->median_ns);
+    }
+    result->mad_ns = median_of(deviations, config.samples);
+
+    if (shortest > 0 && overhead_ns / shortest > overhead_ratio) {
+        overhead_ratio = overhead_ns / shortest;
+    }
+
+    char median[32], mad[32], throughput[32] = "";
+    format_ns(result->median_ns, median, sizeof(median));
+    format_ns(result->mad_ns, mad, sizeof(mad));
+    if (result->bytes && result->median_ns > 0) {
+        snprintf(throughput, sizeof(throughput), "%.1f MB/s", result->bytes * 1e3 / result->median_ns);
+    }
+    printf("%-44s %12s %10s %12llu %12s\n", result->name, median, mad,
+           (unsigned long long)result->iterations, throughput);
+    fflush(stdout);
+    return true;
+}
+
+void bench_skip(const char *name, const char *reason) {
+    if (config.filter && !strstr(name, config.filter)) {
+        return;
+    }
+    printf("%-44s %12s (%s)\n", name, "skipped", reason);
+}
+
+const bench_result_t *bench_results(uint32_t *count) {
+    *count = result_count;
+    return results;
+}
+
+double bench_overhead_ns(void) {
+    return overhead_ns;
+}
+
+double bench_overhead_ratio(void) {
+    return overhead_ratio;
+}
+
+// Baselines
+
+bool bench_save_baseline(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open baseline %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n  \"version\": 1,\n");
+    fprintf(file, "  \"isa\": \"%s\",\n", pattern_isa_to_string(pattern_get_isa()));
+    fprintf(file, "  \"samples\": %u,\n", config.samples);
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (uint32_t i = 0; i < result_count; i++) {
+        const bench_result_t *result = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"median_ns\": %.3f, \"mad_ns\": %.3f, \"iterations\": %llu}%s\n",
+                result->name, result->median_ns, result->mad_ns, (unsigned long long)result->iterations,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    bool ok = fclose(file) == 0;
+    if (!ok) {
+        fprintf(stderr, "Failed to write baseline %s\n", path);
+    }
+    return ok;
+}
+
+static char *read_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return NULL;
+    }
+    char *text = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+        rewind(file);
+    }
+    if (size >= 0) {
+        text = malloc(size + 1);
+    }
+    if (text) {
+        text[fread(text, 1, size, file)] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+// Only what bench_save_baseline() writes has to be understood: one flat
+// object per benchmark with a name and numeric fields
+static bool find_number(const char *object, const char *end, const char *key, double *value) {
+    const char *field = strstr(object, key);
+    if (!field || field > end) {
+        return false;
+    }
+    field = strchr(field + strlen(key), ':');
+    if (!field || field > end) {
+        return false;
+    }
+    char *parsed;
+    *value = strtod(field + 1, &parsed);
+    return parsed != field + 1;
+}
+
+static const bench_result_t *find_result(const char *name) {
+    for (uint32_t i = 0; i < result_count; i++) {
+        if (strcmp(results[i].name, name) == 0) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+int bench_compare_baseline(const char *path, double tolerance) {
+    char *text = read_file(path);
+    if (!text) {
+        fprintf(stderr, "Failed to read baseline %s\n", path);
+        return -1;
+    }
+
+    char isa[32] = "";
+    const char *isa_field = strstr(text, "\"isa\"");
+    if (isa_field && sscanf(isa_field, "\"isa\" : \"%31[^\"]\"", isa) == 1 &&
+        strcmp(isa, pattern_isa_to_string(pattern_get_isa())) != 0) {
+        printf("Warning: baseline was taken with %s kernels, this run uses %s\n",
+               isa, pattern_isa_to_string(pattern_get_isa()));
+    }
+
+    printf("\nBaseline comparison against %s (tolerance %.0f%%)\n", path, tolerance * 100.0);
+    printf("%-44s %12s %12s %9s\n", "Benchmark", "Baseline", "Current", "Change");
+
+    int regressions = 0;
+    uint32_t compared = 0;
+    const char *cursor = strstr(text, "\"benchmarks\"");
+    while (cursor && (cursor = strstr(cursor, "\"name\"")) != NULL) {
+        char name[BENCH_NAME_MAX];
+        const char *end = strchr(cursor, '}');
+        double base_median, base_mad = 0.0;
+        if (!end || sscanf(cursor, "\"name\" : \"%63[^\"]\"", name) != 1 ||
+            !find_number(cursor, end, "\"median_ns\"", &base_median)) {
+            fprintf(stderr, "Malformed baseline entry in %s\n", path);
+            free(text);
+            return -1;
+        }
+        find_number(cursor, end, "\"mad_ns\"", &base_mad);
+        cursor = end;
+
+        const bench_result_t *result = find_result(name);
+        if (!result) {
+            continue;
+        }
+        compared++;
+
+        double delta = result->median_ns - base_median;
+        double noise = BENCH_NOISE_MADS * (base_mad > result->mad_ns ? base_mad : result->mad_ns);
+        bool regressed = delta > tolerance * base_median && delta > noise;
+        char base_text[32], current_text[32];
+        format_ns(base_median, base_text, sizeof(base_text));
+        format_ns(result->median_ns, current_text, sizeof(current_text));
+        printf("%-44s %12s %12s %+8.1f%%%s\n", name, base_text, current_text,
+               base_median > 0 ? delta * 100.0 / base_median : 0.0, regressed ? "  REGRESSION" : "");
+        if (regressed) {
+            regressions++;
+        }
+    }
+    free(text);
+
+    printf("%u benchmarks compared, %d regressed\n", compared, regressions);
+    return regressions;
+}
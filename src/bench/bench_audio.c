@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Audio device enumeration benchmarks. Listing walks the sound cards; a
+// direction filter also probes each one (control and both PCMs).
+
+#ifdef _ENABLE_AUDIO
+
+#include <stdio.h>
+#include "audio/tizen_audio_test.h"
+#include "bench/bench.h"
+
+// Discovery complains when nothing is found, so look once up front.
+// Iterations then take and drop the only reference, discovering afresh.
+static bool has_devices(void) {
+    if (!init_audio_test_framework()) {
+        return false;
+    }
+    cleanup_audio_test_framework();
+    return true;
+}
+
+static void enumerate_run(void *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (init_audio_test_framework()) {
+            get_audio_device_count(AUDIO_DEVICE_BOTH);
+            cleanup_audio_test_framework();
+        }
+    }
+}
+
+static void probe_run(void *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (init_audio_test_framework()) {
+            get_audio_device_count(AUDIO_DEVICE_PLAYBACK);
+            cleanup_audio_test_framework();
+        }
+    }
+}
+
+void bench_audio_cases(void) {
+    if (!has_devices()) {
+        bench_skip("audio.enumerate", "no sound cards");
+        bench_skip("audio.probe", "no sound cards");
+        return;
+    }
+
+    bench_case_t enumerate_case = { "audio.enumerate", NULL, enumerate_run, NULL, NULL, 0 };
+    bench_run(&enumerate_case);
+
+    bench_case_t probe_case = { "audio.probe", NULL, probe_run, NULL, NULL, 0 };
+    bench_run(&probe_case);
+}
+
+#endif /* _ENABLE_AUDIO */
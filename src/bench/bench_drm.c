@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// DRM benchmarks: atomic request building and node enumeration need no
+// device; buffer create and dma-buf export/import run on card0
+
+#ifdef _ENABLE_DRM
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "tizen_drm_test.h"
+#include "drm/drm_device.h"
+#include "drm/drm_topology.h"
+#include "bench/bench.h"
+
+#define BENCH_ATOMIC_PLANES 3
+
+typedef struct {
+    drm_object_props_t plane_props;
+    drm_object_props_t crtc_props;
+    drm_object_props_t connector_props;
+} atomic_bench_t;
+
+typedef struct {
+    test_config_t config;
+    drm_buffer_t *buffer;                     // Exported by the export/import case
+} buffer_bench_t;
+
+// Property IDs only have to be nonzero for drm_atomic_add() to take them
+static bool atomic_setup(void *context) {
+    atomic_bench_t *bench = context;
+    memset(bench, 0, sizeof(*bench));
+    for (int prop = DRM_PROP_FB_ID; prop <= DRM_PROP_CRTC_H; prop++) {
+        bench->plane_props.ids[prop] = 100 + prop;
+    }
+    bench->crtc_props.ids[DRM_PROP_ACTIVE] = 200;
+    bench->crtc_props.ids[DRM_PROP_MODE_ID] = 201;
+    bench->connector_props.ids[DRM_PROP_CRTC_ID] = 300;
+    return true;
+}
+
+// The full-state request a modeset builds: connector, CRTC and every
+// property of three planes
+static void atomic_run(void *context, uint64_t iterations) {
+    atomic_bench_t *bench = context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        drmModeAtomicReq *req = drmModeAtomicAlloc();
+        if (!req) {
+            return;
+        }
+        drm_atomic_add(req, 30, &bench->connector_props, DRM_PROP_CRTC_ID, 20);
+        drm_atomic_add(req, 20, &bench->crtc_props, DRM_PROP_ACTIVE, 1);
+        drm_atomic_add(req, 20, &bench->crtc_props, DRM_PROP_MODE_ID, 40);
+        for (uint32_t plane = 0; plane < BENCH_ATOMIC_PLANES; plane++) {
+            const drm_object_props_t *props = &bench->plane_props;
+            uint32_t id = 10 + plane;
+            drm_atomic_add(req, id, props, DRM_PROP_FB_ID, 50 + plane);
+            drm_atomic_add(req, id, props, DRM_PROP_CRTC_ID, 20);
+            drm_atomic_add(req, id, props, DRM_PROP_SRC_X, 0);
+            drm_atomic_add(req, id, props, DRM_PROP_SRC_Y, 0);
+            drm_atomic_add(req, id, props, DRM_PROP_SRC_W, (uint64_t)TEST_WIDTH << 16);
+            drm_atomic_add(req, id, props, DRM_PROP_SRC_H, (uint64_t)TEST_HEIGHT << 16);
+            drm_atomic_add(req, id, props, DRM_PROP_CRTC_X, 0);
+            drm_atomic_add(req, id, props, DRM_PROP_CRTC_Y, 0);
+            drm_atomic_add(req, id, props, DRM_PROP_CRTC_W, TEST_WIDTH);
+            drm_atomic_add(req, id, props, DRM_PROP_CRTC_H, TEST_HEIGHT);
+        }
+        drmModeAtomicFree(req);
+    }
+}
+
+static void enumerate_run(void *context, uint64_t iterations) {
+    (void)context;
+    char paths[16][DRM_DEVICE_PATH_MAX];
+    for (uint64_t i = 0; i < iterations; i++) {
+        drm_device_enumerate(paths, 16);
+    }
+}
+
+static void buffer_create_run(void *context, uint64_t iterations) {
+    buffer_bench_t *bench = context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        destroy_drm_buffer(create_drm_buffer(&bench->config));
+    }
+}
+
+static bool buffer_export_setup(void *context) {
+    buffer_bench_t *bench = context;
+    bench->buffer = create_drm_buffer(&bench->config);
+    return bench->buffer != NULL;
+}
+
+// PRIME export, import with its mapping, and release of both
+static void buffer_export_run(void *context, uint64_t iterations) {
+    buffer_bench_t *bench = context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        int fd;
+        if (export_dma_buf(bench->buffer, &fd) != 0) {
+            return;
+        }
+        destroy_drm_buffer(import_dma_buf(fd));
+        close(fd);
+    }
+}
+
+static void buffer_export_teardown(void *context) {
+    buffer_bench_t *bench = context;
+    destroy_drm_buffer(bench->buffer);
+    bench->buffer = NULL;
+}
+
+void bench_drm_cases(void) {
+    atomic_bench_t atomic;
+    bench_case_t atomic_case = { "drm.atomic.build", atomic_setup, atomic_run, NULL, &atomic, 0 };
+    bench_run(&atomic_case);
+
+    bench_case_t enumerate_case = { "drm.enumerate", NULL, enumerate_run, NULL, NULL, 0 };
+    bench_run(&enumerate_case);
+
+    if (!init_test_framework()) {
+        bench_skip("drm.buffer.create.1080p", "no DRM device");
+        bench_skip("drm.buffer.export_import.1080p", "no DRM device");
+        return;
+    }
+
+    buffer_bench_t buffer = {
+        .config = { TEST_WIDTH, TEST_HEIGHT, DRM_FORMAT_XRGB8888, DRM_MODIFIER_LINEAR, DRM_COMPRESSION_NONE, 1 },
+    };
+    bench_case_t create_case = { "drm.buffer.create.1080p", NULL, buffer_create_run, NULL, &buffer, 0 };
+    bench_run(&create_case);
+
+    bench_case_t export_case = { "drm.buffer.export_import.1080p", buffer_export_setup, buffer_export_run,
+                                 buffer_export_teardown, &buffer, 0 };
+    bench_run(&export_case);
+
+    cleanup_test_framework();
+}
+
+#endif /* _ENABLE_DRM */
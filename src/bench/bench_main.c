@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Microbenchmarks of the framework's own hot paths: pattern kernels,
+// report output, buffer sharing, atomic request building and device
+// enumeration. Devices are only needed for the buffer cases.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include "bench/bench.h"
+#include "common/test_pattern.h"
+#include "report/test_report.h"
+
+#define BENCH_REPORT_ENTRIES 1000
+
+typedef struct {
+    void *buffer;
+    size_t size;
+    test_pattern_t pattern;
+    bool verify;
+} pattern_bench_t;
+
+typedef struct {
+    report_format_t format;
+    char path[256];
+    uint32_t entries;                         // Results and metrics per report, 0 to stream metrics
+} report_bench_t;
+
+static void usage(const char *program) {
+    printf("Usage: %s [OPTION]...\n", program);
+    printf("  -b, --baseline=FILE       Compare against a saved baseline; exit 1 on a regression\n");
+    printf("  -s, --save-baseline=FILE  Save this run's results as a baseline\n");
+    printf("  -t, --tolerance=PCT       Slowdown that counts as a regression (default 10)\n");
+    printf("  -n, --samples=N           Timed samples per benchmark (default 15, max %d)\n", BENCH_MAX_SAMPLES);
+    printf("  -w, --warmup=MS           Untimed warmup per benchmark (default 50)\n");
+    printf("  -f, --filter=TEXT         Only run benchmarks whose name contains TEXT\n");
+    printf("Baselines only mean something on the board, kernel and build that wrote them.\n");
+}
+
+// Pattern kernels
+
+static bool pattern_setup(void *context) {
+    pattern_bench_t *bench = context;
+    bench->buffer = aligned_alloc(64, bench->size);
+    if (!bench->buffer) {
+        return false;
+    }
+    // Fault every page in before warmup starts
+    return pattern_fill(bench->buffer, bench->size, &bench->pattern, 0, 0);
+}
+
+static void pattern_run(void *context, uint64_t iterations) {
+    pattern_bench_t *bench = context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (bench->verify) {
+            pattern_verify(bench->buffer, bench->size, &bench->pattern, 0, 0, NULL);
+        } else {
+            pattern_fill(bench->buffer, bench->size, &bench->pattern, 0, 0);
+        }
+    }
+}
+
+static void pattern_teardown(void *context) {
+    pattern_bench_t *bench = context;
+    free(bench->buffer);
+    bench->buffer = NULL;
+}
+
+static void bench_pattern_cases(void) {
+    static const struct {
+        const char *name;
+        size_t size;
+    } sizes[] = {
+        { "4k", 4096 },                       // Cache resident
+        { "4m", 4 * 1024 * 1024 },            // Out to memory on most boards
+    };
+    static const struct {
+        const char *name;
+        pattern_type_t type;
+        bool verify;
+    } ops[] = {
+        { "fill.solid", PATTERN_SOLID, false },
+        { "fill.checksum", PATTERN_CHECKSUM, false },
+        { "verify.checksum", PATTERN_CHECKSUM, true },
+    };
+
+    pattern_isa_t selected = pattern_get_isa();
+    for (int isa = 0; isa < PATTERN_ISA_MAX; isa++) {
+        if (!pattern_set_isa((pattern_isa_t)isa)) {
+            continue;
+        }
+        for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); o++) {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                char name[BENCH_NAME_MAX];
+                snprintf(name, sizeof(name), "pattern.%s.%s.%s", ops[o].name, sizes[s].name,
+                         pattern_isa_to_string((pattern_isa_t)isa));
+                pattern_bench_t context = {
+                    .size = sizes[s].size,
+                    .pattern = { ops[o].type, 0x5a5a0001, 1 },
+                    .verify = ops[o].verify,
+                };
+                bench_case_t bench = { name, pattern_setup, pattern_run, pattern_teardown, &context, sizes[s].size };
+                bench_run(&bench);
+            }
+        }
+    }
+    pattern_set_isa(selected);
+}
+
+// Report output
+
+static test_report_t *report_open(const report_bench_t *bench) {
+    report_config_t config;
+    memset(&config, 0, sizeof(config));
+    snprintf(config.report_file, sizeof(config.report_file), "%s", bench->path);
+    config.format = bench->format;
+    config.include_timestamp = true;
+    config.include_performance_metrics = true;
+    config.min_level = REPORT_LEVEL_INFO;
+    return report_create("Benchmark", "Report output benchmark", &config);
+}
+
+// Appending streams each record into the writer's buffer, so one report
+// per batch takes every append in it; creating and finishing it is
+// amortised over the batch
+static void report_append_run(void *context, uint64_t iterations) {
+    report_bench_t *bench = context;
+    test_report_t *report = report_open(bench);
+    if (!report) {
+        return;
+    }
+    for (uint64_t i = 0; i < iterations; i++) {
+        report_add_metric(report, "bench_metric", METRIC_TIME_US, (double)i, "us");
+    }
+    report_generate(report);
+    report_destroy(report);
+}
+
+// A whole report: results and metrics, then the summary and fsync
+static void report_generate_run(void *context, uint64_t iterations) {
+    report_bench_t *bench = context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        test_report_t *report = report_open(bench);
+        if (!report) {
+            return;
+        }
+        for (uint32_t e = 0; e < bench->entries; e++) {
+            report_add_test_result(report, "bench_test", REPORT_SUBSYSTEM_OTHER,
+                                   e % 10 ? TEST_RESULT_PASS : TEST_RESULT_FAIL, e, "Benchmark entry");
+            report_add_latency_metric(report, "bench_latency", e * 0.25);
+        }
+        report_generate(report);
+        report_destroy(report);
+    }
+}
+
+static void report_teardown(void *context) {
+    report_bench_t *bench = context;
+    unlink(bench->path);
+}
+
+static void bench_report_cases(void) {
+    static const report_format_t formats[] = { REPORT_FORMAT_TEXT, REPORT_FORMAT_JSON, REPORT_FORMAT_BINARY };
+
+    // Keep fsync out of the numbers where tmpfs is available
+    const char *dir = getenv("TMPDIR");
+    if (!dir) {
+        dir = access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp";
+    }
+
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        char format[16];
+        snprintf(format, sizeof(format), "%s", report_format_to_string(formats[f]));
+        for (char *p = format; *p; p++) {
+            *p = (*p >= 'A' && *p <= 'Z') ? *p - 'A' + 'a' : *p;
+        }
+
+        report_bench_t context = { .format = formats[f] };
+        snprintf(context.path, sizeof(context.path), "%s/tvts_bench_%d.%s", dir, (int)getpid(), format);
+
+        char name[BENCH_NAME_MAX];
+        snprintf(name, sizeof(name), "report.append.%s", format);
+        bench_case_t append = { name, NULL, report_append_run, report_teardown, &context, 0 };
+        bench_run(&append);
+
+        context.entries = BENCH_REPORT_ENTRIES;
+        snprintf(name, sizeof(name), "report.generate.%s.%d", format, BENCH_REPORT_ENTRIES);
+        bench_case_t generate = { name, NULL, report_generate_run, report_teardown, &context, 0 };
+        bench_run(&generate);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bench_config_t config = {
+        .samples = 15,
+        .warmup_ns = 50000000ull,
+        .sample_ns = 2000000ull,
+        .filter = NULL,
+    };
+    const char *baseline = NULL;
+    const char *save_baseline = NULL;
+    double tolerance = 0.10;
+
+    static struct option long_options[] = {
+        {"baseline", required_argument, 0, 'b'},
+        {"save-baseline", required_argument, 0, 's'},
+        {"tolerance", required_argument, 0, 't'},
+        {"samples", required_argument, 0, 'n'},
+        {"warmup", required_argument, 0, 'w'},
+        {"filter", required_argument, 0, 'f'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "b:s:t:n:w:f:h", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'b':
+                baseline = optarg;
+                break;
+            case 's':
+                save_baseline = optarg;
+                break;
+            case 't':
+                tolerance = atof(optarg) / 100.0;
+                if (tolerance <= 0) {
+                    fprintf(stderr, "Invalid tolerance: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'n':
+                config.samples = (uint32_t)atoi(optarg);
+                if (config.samples == 0 || config.samples > BENCH_MAX_SAMPLES) {
+                    fprintf(stderr, "Invalid sample count: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'w':
+                config.warmup_ns = (uint64_t)atoi(optarg) * 1000000ull;
+                break;
+            case 'f':
+                config.filter = optarg;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    pattern_init();
+    bench_init(&config);
+
+    bench_pattern_cases();
+    bench_report_cases();
+#ifdef _ENABLE_DRM
+    bench_drm_cases();
+#endif
+#ifdef _ENABLE_VIDEO
+    bench_video_cases();
+#endif
+#ifdef _ENABLE_AUDIO
+    bench_audio_cases();
+#endif
+
+    uint32_t count;
+    bench_results(&count);
+    printf("\nHarness overhead: %.0f ns per sample, at most %.3f%% of one\n",
+           bench_overhead_ns(), bench_overhead_ratio() * 100.0);
+    if (bench_overhead_ratio() > 0.01) {
+        printf("Warning: harness overhead above 1%% of a sample\n");
+    }
+
+    if (save_baseline) {
+        if (!bench_save_baseline(save_baseline)) {
+            return 1;
+        }
+        printf("Baseline of %u benchmarks saved to %s\n", count, save_baseline);
+    }
+    if (baseline && bench_compare_baseline(baseline, tolerance) != 0) {
+        return 1;
+    }
+    return 0;
+}
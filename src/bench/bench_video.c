@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// Video device enumeration benchmarks. Listing only stat()s the V4L2
+// nodes; a type filter also probes each one (QUERYCAP and format lists).
+
+#ifdef _ENABLE_VIDEO
+
+#include <stdio.h>
+#include "video/tizen_video_test.h"
+#include "bench/bench.h"
+
+// Discovery complains when nothing is found, so look once up front.
+// Iterations then take and drop the only reference, discovering afresh.
+static bool has_devices(void) {
+    if (!init_video_test_framework()) {
+        return false;
+    }
+    cleanup_video_test_framework();
+    return true;
+}
+
+static void enumerate_run(void *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (init_video_test_framework()) {
+            get_video_device_count(VIDEO_DEVICE_MAX);
+            cleanup_video_test_framework();
+        }
+    }
+}
+
+static void probe_run(void *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (init_video_test_framework()) {
+            get_video_device_count(VIDEO_DEVICE_CAMERA);
+            cleanup_video_test_framework();
+        }
+    }
+}
+
+void bench_video_cases(void) {
+    if (!has_devices()) {
+        bench_skip("video.enumerate", "no video devices");
+        bench_skip("video.probe", "no video devices");
+        return;
+    }
+
+    bench_case_t enumerate_case = { "video.enumerate", NULL, enumerate_run, NULL, NULL, 0 };
+    bench_run(&enumerate_case);
+
+    bench_case_t probe_case = { "video.probe", NULL, probe_run, NULL, NULL, 0 };
+    bench_run(&probe_case);
+}
+
+#endif /* _ENABLE_VIDEO */
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "common/cap_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/utsname.h>
+
+#define CAP_CACHE_MAGIC "TZCAP01"   // Bumped whenever the file layout changes
+#define CAP_CACHE_MAX_PAYLOAD 65536
+
+typedef struct {
+    char key[CAP_CACHE_KEY_SIZE];
+    uint32_t size;
+    void *data;
+} cap_cache_entry_t;
+
+// Probes of different devices run in parallel and store concurrently
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static char cache_path[PATH_MAX];
+static cap_cache_entry_t entries[CAP_CACHE_MAX_ENTRIES];
+static uint32_t entry_count = 0;
+static bool cache_dirty = false;
+
+static void clear_entries(void) {
+    for (uint32_t i = 0; i < entry_count; i++) {
+        free(entries[i].data);
+    }
+    entry_count = 0;
+    cache_dirty = false;
+}
+
+static cap_cache_entry_t *find_entry(const char *key) {
+    for (uint32_t i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].key, key) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// A missing or stale file just starts an empty cache
+static void load_entries(FILE *file) {
+    char magic[sizeof(CAP_CACHE_MAGIC)];
+    uint32_t count;
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, CAP_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        fread(&count, sizeof(count), 1, file) != 1) {
+        return;
+    }
+
+    while (count-- > 0 && entry_count < CAP_CACHE_MAX_ENTRIES) {
+        cap_cache_entry_t *entry = &entries[entry_count];
+        if (fread(entry->key, sizeof(entry->key), 1, file) != 1 ||
+            fread(&entry->size, sizeof(entry->size), 1, file) != 1 ||
+            entry->size > CAP_CACHE_MAX_PAYLOAD) {
+            return;
+        }
+        entry->key[sizeof(entry->key) - 1] = '\0';
+
+        entry->data = malloc(entry->size ? entry->size : 1);
+        if (!entry->data) {
+            return;
+        }
+        if (fread(entry->data, entry->size, 1, file) != 1 && entry->size > 0) {
+            free(entry->data);
+            return;
+        }
+        entry_count++;
+    }
+}
+
+bool cap_cache_open(const char *path) {
+    if (!path || !path[0] || strlen(path) >= sizeof(cache_path)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    clear_entries();
+    strcpy(cache_path, path);
+
+    FILE *file = fopen(path, "rb");
+    if (file) {
+        load_entries(file);
+        fclose(file);
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    return true;
+}
+
+// Written next to the old file and renamed over it, so an interrupted run
+// never leaves a truncated cache behind
+static bool save_entries(void) {
+    char tmp_path[PATH_MAX + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache_path);
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write capability cache %s\n", tmp_path);
+        return false;
+    }
+
+    bool ok = fwrite(CAP_CACHE_MAGIC, sizeof(CAP_CACHE_MAGIC), 1, file) == 1 &&
+              fwrite(&entry_count, sizeof(entry_count), 1, file) == 1;
+    for (uint32_t i = 0; ok && i < entry_count; i++) {
+        ok = fwrite(entries[i].key, sizeof(entries[i].key), 1, file) == 1 &&
+             fwrite(&entries[i].size, sizeof(entries[i].size), 1, file) == 1 &&
+             (entries[i].size == 0 || fwrite(entries[i].data, entries[i].size, 1, file) == 1);
+    }
+
+    if (fclose(file) != 0 || !ok || rename(tmp_path, cache_path) != 0) {
+        fprintf(stderr, "Cannot write capability cache %s\n", cache_path);
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+void cap_cache_close(void) {
+    pthread_mutex_lock(&cache_lock);
+    if (cache_path[0] && cache_dirty) {
+        save_entries();
+    }
+    clear_entries();
+    cache_path[0] = '\0';
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// Last component of the symlink at path/link, e.g. the driver's name
+static bool link_name(const char *path, const char *link, char *name, size_t size) {
+    char link_path[PATH_MAX];
+    char target[PATH_MAX];
+    snprintf(link_path, sizeof(link_path), "%s/%s", path, link);
+
+    ssize_t length = readlink(link_path, target, sizeof(target) - 1);
+    if (length < 0) {
+        return false;
+    }
+    target[length] = '\0';
+
+    const char *base = strrchr(target, '/');
+    base = base ? base + 1 : target;
+    if (strlen(base) >= size) {
+        return false;
+    }
+    strcpy(name, base);
+    return true;
+}
+
+static bool read_line(const char *path, char *buffer, size_t size) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    bool ok = fgets(buffer, size, file) != NULL;
+    fclose(file);
+
+    if (ok) {
+        buffer[strcspn(buffer, "\n")] = '\0';
+    }
+    return ok && buffer[0];
+}
+
+// A module's own version or source hash if it has one; built-in drivers
+// change with the kernel
+static void driver_version(const char *device, char *version, size_t size) {
+    char driver[PATH_MAX];
+    char module[128];
+    int length = snprintf(driver, sizeof(driver), "%s/driver", device);
+
+    if (length > 0 && (size_t)length < sizeof(driver) && link_name(driver, "module", module, sizeof(module))) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "/sys/module/%s/version", module);
+        if (read_line(path, version, size)) {
+            return;
+        }
+        snprintf(path, sizeof(path), "/sys/module/%s/srcversion", module);
+        if (read_line(path, version, size)) {
+            return;
+        }
+    }
+
+    struct utsname name;
+    snprintf(version, size, "%s", uname(&name) == 0 ? name.release : "unknown");
+}
+
+bool cap_cache_device_key(const char *sysfs_node, char *key, size_t size) {
+    if (!sysfs_node || !key || size == 0) {
+        return false;
+    }
+
+    char device_link[PATH_MAX];
+    char device[PATH_MAX];
+    snprintf(device_link, sizeof(device_link), "%s/device", sysfs_node);
+    if (!realpath(device_link, device)) {
+        return false;
+    }
+
+    char driver[128];
+    if (!link_name(device, "driver", driver, sizeof(driver))) {
+        strcpy(driver, "none");
+    }
+
+    char version[128];
+    driver_version(device, version, sizeof(version));
+
+    const char *node = strrchr(sysfs_node, '/');
+    int length = snprintf(key, size, "%s|%s|%s|%s", node ? node + 1 : sysfs_node, device, driver, version);
+    return length > 0 && (size_t)length < size;
+}
+
+bool cap_cache_lookup(const char *key, void *data, size_t size) {
+    if (!key || !data) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    cap_cache_entry_t *entry = find_entry(key);
+    bool hit = entry && entry->size == size;
+    if (hit) {
+        memcpy(data, entry->data, size);
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    return hit;
+}
+
+void cap_cache_store(const char *key, const void *data, size_t size) {
+    if (!key || !data || strlen(key) >= CAP_CACHE_KEY_SIZE || size > CAP_CACHE_MAX_PAYLOAD) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    if (cache_path[0]) {
+        cap_cache_entry_t *entry = find_entry(key);
+        if (!entry && entry_count < CAP_CACHE_MAX_ENTRIES) {
+            entry = &entries[entry_count++];
+            memset(entry, 0, sizeof(*entry));
+            strcpy(entry->key, key);
+        }
+
+        void *copy = entry ? malloc(size ? size : 1) : NULL;
+        if (copy) {
+            memcpy(copy, data, size);
+            free(entry->data);
+            entry->data = copy;
+            entry->size = size;
+            cache_dirty = true;
+        } else if (entry && !entry->data) {
+            // Drop the slot reserved above rather than keep an empty key
+            entry_count--;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
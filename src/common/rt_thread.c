@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "common/rt_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#define RT_STACK_PREFAULT (256 * 1024)
+#define RT_MAX_CPUS 64
+
+typedef struct {
+    const rt_config_t *config;
+    rt_thread_fn_t fn;
+    void *arg;
+    bool result;
+    rt_config_t applied;
+} rt_job_t;
+
+static bool memory_locked = false;
+
+static int to_sched_policy(rt_policy_t policy) {
+    switch (policy) {
+        case RT_POLICY_FIFO: return SCHED_FIFO;
+        case RT_POLICY_RR: return SCHED_RR;
+        default: return SCHED_OTHER;
+    }
+}
+
+static rt_policy_t from_sched_policy(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return RT_POLICY_FIFO;
+        case SCHED_RR: return RT_POLICY_RR;
+        default: return RT_POLICY_OTHER;
+    }
+}
+
+// Touch the stack the loop will use while it is still cheap to fault it in
+static void prefault_stack(void) {
+    volatile uint8_t stack[RT_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+static void *rt_thread_main(void *data) {
+    rt_job_t *job = data;
+
+    if (job->config->lock_memory) {
+        prefault_stack();
+    }
+
+    int policy;
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+        job->applied.policy = from_sched_policy(policy);
+        job->applied.priority = job->applied.policy == RT_POLICY_OTHER ? 0 : param.sched_priority;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (job->config->cpu_mask && pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < RT_MAX_CPUS; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                job->applied.cpu_mask |= 1ULL << cpu;
+            }
+        }
+    }
+    job->applied.lock_memory = job->config->lock_memory && memory_locked;
+
+    job->result = job->fn(job->arg);
+    return NULL;
+}
+
+static int create_thread(pthread_t *thread, const rt_config_t *config, bool realtime, rt_job_t *job) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if (realtime) {
+        int policy = to_sched_policy(config->policy);
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config->priority;
+        if (param.sched_priority < sched_get_priority_min(policy)) {
+            param.sched_priority = sched_get_priority_min(policy);
+        }
+        if (param.sched_priority > sched_get_priority_max(policy)) {
+            param.sched_priority = sched_get_priority_max(policy);
+        }
+
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, policy);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+    if (config->cpu_mask) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < RT_MAX_CPUS; cpu++) {
+            if (config->cpu_mask & (1ULL << cpu)) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+
+    int err = pthread_create(thread, &attr, rt_thread_main, job);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+bool rt_config_active(const rt_config_t *config) {
+    return config && (config->policy != RT_POLICY_OTHER || config->cpu_mask || config->lock_memory);
+}
+
+bool rt_lock_memory(void) {
+    if (memory_locked) {
+        return true;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        fprintf(stderr, "mlockall failed, streaming may page fault: %s\n", strerror(errno));
+        return false;
+    }
+    memory_locked = true;
+    return true;
+}
+
+bool rt_thread_run(const rt_config_t *config, rt_thread_fn_t fn, void *arg, rt_config_t *applied) {
+    if (!fn) {
+        return false;
+    }
+
+    if (!rt_config_active(config)) {
+        if (applied) {
+            memset(applied, 0, sizeof(rt_config_t));
+        }
+        return fn(arg);
+    }
+
+    rt_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.config = config;
+    job.fn = fn;
+    job.arg = arg;
+
+    pthread_t thread;
+    bool realtime = config->policy != RT_POLICY_OTHER;
+    int err = create_thread(&thread, config, realtime, &job);
+    if (err == EPERM && realtime) {
+        fprintf(stderr, "%s refused (needs CAP_SYS_NICE or RLIMIT_RTPRIO), using SCHED_OTHER\n",
+                rt_policy_to_string(config->policy));
+        err = create_thread(&thread, config, false, &job);
+    }
+    if (err != 0) {
+        fprintf(stderr, "Cannot create streaming thread: %s\n", strerror(err));
+        return false;
+    }
+
+    pthread_join(thread, NULL);
+
+    if (applied) {
+        memcpy(applied, &job.applied, sizeof(rt_config_t));
+    }
+    return job.result;
+}
+
+// Helpers
+bool rt_parse_policy(const char *name, rt_policy_t *policy) {
+    if (!name || !policy) {
+        return false;
+    }
+    if (strcmp(name, "fifo") == 0) {
+        *policy = RT_POLICY_FIFO;
+    } else if (strcmp(name, "rr") == 0) {
+        *policy = RT_POLICY_RR;
+    } else if (strcmp(name, "other") == 0) {
+        *policy = RT_POLICY_OTHER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// "0-3,6" style lists, as in taskset -c and /sys/devices/system/cpu
+bool rt_parse_cpu_list(const char *list, uint64_t *cpu_mask) {
+    if (!list || !cpu_mask) {
+        return false;
+    }
+
+    uint64_t mask = 0;
+    const char *p = list;
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= RT_MAX_CPUS) {
+            return false;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= RT_MAX_CPUS) {
+                return false;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            mask |= 1ULL << cpu;
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return false;
+        }
+    }
+
+    if (!mask) {
+        return false;
+    }
+    *cpu_mask = mask;
+    return true;
+}
+
+const char *rt_policy_to_string(rt_policy_t policy) {
+    switch (policy) {
+        case RT_POLICY_OTHER: return "SCHED_OTHER";
+        case RT_POLICY_FIFO: return "SCHED_FIFO";
+        case RT_POLICY_RR: return "SCHED_RR";
+        default: return "UNKNOWN";
+    }
+}
+
+// e.g. "SCHED_FIFO/80 cpus=2-3 mlock"
+void rt_config_describe(const rt_config_t *config, char *buffer, size_t size) {
+    if (!buffer || size == 0) {
+        return;
+    }
+    buffer[0] = '\0';
+    if (!config) {
+        return;
+    }
+
+    size_t len = 0;
+    if (config->policy == RT_POLICY_OTHER) {
+        len += snprintf(buffer + len, size - len, "%s", rt_policy_to_string(config->policy));
+    } else {
+        len += snprintf(buffer + len, size - len, "%s/%d", rt_policy_to_string(config->policy), config->priority);
+    }
+
+    if (config->cpu_mask && len < size) {
+        len += snprintf(buffer + len, size - len, " cpus=");
+        for (int cpu = 0; cpu < RT_MAX_CPUS && len < size; cpu++) {
+            if (!(config->cpu_mask & (1ULL << cpu)) || (cpu > 0 && (config->cpu_mask & (1ULL << (cpu - 1))))) {
+                continue;
+            }
+            int last = cpu;
+            while (last + 1 < RT_MAX_CPUS && (config->cpu_mask & (1ULL << (last + 1)))) {
+                last++;
+            }
+            const char *sep = buffer[len - 1] == '=' ? "" : ",";
+            if (last == cpu) {
+                len += snprintf(buffer + len, size - len, "%s%d", sep, cpu);
+            } else {
+                len += snprintf(buffer + len, size - len, "%s%d-%d", sep, cpu, last);
+            }
+        }
+    }
+
+    if (config->lock_memory && len < size) {
+        snprintf(buffer + len, size - len, " mlock");
+    }
+}
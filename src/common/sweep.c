@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "common/sweep.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void sweep_init(sweep_t *sweep, const char *title, const char *units) {
+    memset(sweep, 0, sizeof(sweep_t));
+    snprintf(sweep->title, sizeof(sweep->title), "%s", title);
+    snprintf(sweep->units, sizeof(sweep->units), "%s", units);
+}
+
+sweep_axis_t *sweep_add_axis(sweep_t *sweep, const char *name) {
+    if (sweep->axis_count >= SWEEP_MAX_AXES) {
+        return NULL;
+    }
+    sweep_axis_t *axis = &sweep->axes[sweep->axis_count++];
+    memset(axis, 0, sizeof(sweep_axis_t));
+    snprintf(axis->name, sizeof(axis->name), "%s", name);
+    return axis;
+}
+
+bool sweep_axis_add(sweep_axis_t *axis, uint64_t value, const char *label) {
+    for (uint32_t i = 0; i < axis->count; i++) {
+        if (axis->values[i] == value) {
+            return true;
+        }
+    }
+    if (axis->count >= SWEEP_MAX_VALUES) {
+        return false;
+    }
+    axis->values[axis->count] = value;
+    snprintf(axis->labels[axis->count], SWEEP_LABEL_SIZE, "%s", label);
+    axis->count++;
+    return true;
+}
+
+uint32_t sweep_point_count(const sweep_t *sweep) {
+    if (sweep->axis_count == 0) {
+        return 0;
+    }
+    uint32_t count = 1;
+    for (uint32_t a = 0; a < sweep->axis_count; a++) {
+        count *= sweep->axes[a].count;
+    }
+    return count;
+}
+
+void sweep_get_point(const sweep_t *sweep, uint32_t index, sweep_point_t *point) {
+    memset(point, 0, sizeof(sweep_point_t));
+    point->index = index;
+    for (uint32_t a = sweep->axis_count; a-- > 0;) {
+        const sweep_axis_t *axis = &sweep->axes[a];
+        uint32_t i = index % axis->count;
+        index /= axis->count;
+        point->values[a] = axis->values[i];
+        point->labels[a] = axis->labels[i];
+    }
+}
+
+bool sweep_run(const sweep_t *sweep, sweep_point_fn_t fn, void *context, sweep_result_t *result) {
+    memset(result, 0, sizeof(sweep_result_t));
+    result->point_count = sweep_point_count(sweep);
+    if (result->point_count == 0 || !fn) {
+        return false;
+    }
+
+    result->values = malloc(result->point_count * sizeof(double));
+    if (!result->values) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < result->point_count; i++) {
+        sweep_point_t point;
+        double value = 0.0;
+        sweep_get_point(sweep, i, &point);
+        if (fn(context, &point, &value)) {
+            result->values[i] = value;
+            result->measured++;
+        } else {
+            result->values[i] = NAN;
+        }
+    }
+
+    return result->measured > 0;
+}
+
+void sweep_result_free(sweep_result_t *result) {
+    free(result->values);
+    result->values = NULL;
+    result->point_count = 0;
+    result->measured = 0;
+}
+
+void sweep_print_matrix(const sweep_t *sweep, const sweep_result_t *result, FILE *out) {
+    if (sweep->axis_count == 0 || !result->values) {
+        return;
+    }
+
+    const sweep_axis_t *columns = &sweep->axes[sweep->axis_count - 1];
+    fprintf(out, "%s (%s)\n", sweep->title, sweep->units);
+
+    // Header: the leading axis names, then one column per last-axis value
+    char row_header[SWEEP_MAX_AXES * 18] = "";
+    for (uint32_t a = 0; a + 1 < sweep->axis_count; a++) {
+        size_t used = strlen(row_header);
+        snprintf(row_header + used, sizeof(row_header) - used, "%s%s", a ? " / " : "", sweep->axes[a].name);
+    }
+    fprintf(out, "  %-34s", row_header[0] ? row_header : "");
+    for (uint32_t c = 0; c < columns->count; c++) {
+        fprintf(out, " %12s", columns->labels[c]);
+    }
+    fputc('\n', out);
+
+    for (uint32_t row = 0; row * columns->count < result->point_count; row++) {
+        sweep_point_t point;
+        sweep_get_point(sweep, row * columns->count, &point);
+
+        char label[SWEEP_MAX_AXES * SWEEP_LABEL_SIZE] = "";
+        for (uint32_t a = 0; a + 1 < sweep->axis_count; a++) {
+            size_t used = strlen(label);
+            snprintf(label + used, sizeof(label) - used, "%s%s", a ? " / " : "", point.labels[a]);
+        }
+        fprintf(out, "  %-34s", label);
+
+        for (uint32_t c = 0; c < columns->count; c++) {
+            double value = result->values[row * columns->count + c];
+            if (isnan(value)) {
+                fprintf(out, " %12s", "-");
+            } else {
+                fprintf(out, " %12.1f", value);
+            }
+        }
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "common/test_pattern.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PATTERN_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define PATTERN_HAVE_NEON 1
+#include <arm_neon.h>
+#if !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+// Weyl increment for the checksum pattern; odd, so every position in a
+// 2^32-word range gets a distinct generator value
+#define PATTERN_CHECKSUM_STEP 0x9E3779B9u
+
+// Alignment required by the widest streaming store
+#define PATTERN_STREAM_ALIGN 32
+
+// Kernel signatures. Each word is generated as T(base + i * inc), where T is
+// the checksum mix for PATTERN_CHECKSUM and the identity otherwise. Kernels
+// process whole blocks only and return the number of words handled; verify
+// kernels stop at the first block containing a mismatch and leave the exact
+// position to the scalar code.
+typedef size_t (*pattern_fill_fn)(uint8_t *dst, size_t words, uint32_t base, uint32_t inc,
+                                  bool mix, bool nontemporal);
+typedef size_t (*pattern_verify_fn)(const uint8_t *src, size_t words, uint32_t base, uint32_t inc,
+                                    bool mix, bool nontemporal);
+
+// Active kernel state
+static bool pattern_initialized = false;
+static pthread_once_t pattern_once = PTHREAD_ONCE_INIT;
+static pattern_isa_t active_isa = PATTERN_ISA_SCALAR;
+static pattern_fill_fn active_fill = NULL;
+static pattern_verify_fn active_verify = NULL;
+
+static inline uint32_t mix_word(uint32_t x) {
+    x ^= x >> 15;
+    x ^= x << 7;
+    return x;
+}
+
+static inline uint32_t generate_word(uint32_t base, uint32_t inc, size_t index, bool mix) {
+    uint32_t value = base + (uint32_t)index * inc;
+    return mix ? mix_word(value) : value;
+}
+
+static inline void store_word(uint8_t *dst, uint32_t value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+static inline uint32_t load_word(const uint8_t *src) {
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+// Map a pattern onto generator parameters
+static void pattern_generator(const test_pattern_t *pattern, uint32_t first_word,
+                              uint32_t *base, uint32_t *inc, bool *mix) {
+    switch (pattern->type) {
+        case PATTERN_GRADIENT:
+            *inc = pattern->step;
+            *mix = false;
+            break;
+        case PATTERN_CHECKSUM:
+            *inc = PATTERN_CHECKSUM_STEP;
+            *mix = true;
+            break;
+        case PATTERN_SOLID:
+        default:
+            *inc = 0;
+            *mix = false;
+            break;
+    }
+    *base = pattern->value + first_word * *inc;
+}
+
+#ifdef PATTERN_HAVE_X86
+__attribute__((target("sse2")))
+static inline __m128i mix_sse2(__m128i x) {
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 7));
+}
+
+__attribute__((target("sse2")))
+static size_t fill_sse2(uint8_t *dst, size_t words, uint32_t base, uint32_t inc,
+                        bool mix, bool nontemporal) {
+    __m128i acc = _mm_setr_epi32((int)base, (int)(base + inc), (int)(base + 2 * inc), (int)(base + 3 * inc));
+    __m128i step = _mm_set1_epi32((int)(inc * 4));
+    size_t i;
+
+    // 64 bytes per iteration
+    for (i = 0; i + 16 <= words; i += 16) {
+        __m128i v0 = acc;
+        __m128i v1 = _mm_add_epi32(v0, step);
+        __m128i v2 = _mm_add_epi32(v1, step);
+        __m128i v3 = _mm_add_epi32(v2, step);
+        __m128i *out = (__m128i *)(dst + i * 4);
+
+        acc = _mm_add_epi32(v3, step);
+        if (mix) {
+            v0 = mix_sse2(v0);
+            v1 = mix_sse2(v1);
+            v2 = mix_sse2(v2);
+            v3 = mix_sse2(v3);
+        }
+        if (nontemporal) {
+            _mm_stream_si128(out, v0);
+            _mm_stream_si128(out + 1, v1);
+            _mm_stream_si128(out + 2, v2);
+            _mm_stream_si128(out + 3, v3);
+        } else {
+            _mm_storeu_si128(out, v0);
+            _mm_storeu_si128(out + 1, v1);
+            _mm_storeu_si128(out + 2, v2);
+            _mm_storeu_si128(out + 3, v3);
+        }
+    }
+
+    if (nontemporal) {
+        _mm_sfence();
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+static size_t verify_sse2(const uint8_t *src, size_t words, uint32_t base, uint32_t inc,
+                          bool mix, bool nontemporal) {
+    __m128i acc = _mm_setr_epi32((int)base, (int)(base + inc), (int)(base + 2 * inc), (int)(base + 3 * inc));
+    __m128i step = _mm_set1_epi32((int)(inc * 4));
+    size_t i;
+
+    (void)nontemporal;
+    for (i = 0; i + 16 <= words; i += 16) {
+        __m128i e0 = acc;
+        __m128i e1 = _mm_add_epi32(e0, step);
+        __m128i e2 = _mm_add_epi32(e1, step);
+        __m128i e3 = _mm_add_epi32(e2, step);
+        const __m128i *in = (const __m128i *)(src + i * 4);
+        __m128i diff;
+
+        acc = _mm_add_epi32(e3, step);
+        if (mix) {
+            e0 = mix_sse2(e0);
+            e1 = mix_sse2(e1);
+            e2 = mix_sse2(e2);
+            e3 = mix_sse2(e3);
+        }
+        diff = _mm_or_si128(_mm_or_si128(_mm_xor_si128(_mm_loadu_si128(in), e0),
+                                         _mm_xor_si128(_mm_loadu_si128(in + 1), e1)),
+                            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(in + 2), e2),
+                                         _mm_xor_si128(_mm_loadu_si128(in + 3), e3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i mix_avx2(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    return _mm256_xor_si256(x, _mm256_slli_epi32(x, 7));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i start_avx2(uint32_t base, uint32_t inc) {
+    return _mm256_add_epi32(_mm256_set1_epi32((int)base),
+                            _mm256_mullo_epi32(_mm256_set1_epi32((int)inc),
+                                               _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+
+__attribute__((target("avx2")))
+static size_t fill_avx2(uint8_t *dst, size_t words, uint32_t base, uint32_t inc,
+                        bool mix, bool nontemporal) {
+    __m256i acc = start_avx2(base, inc);
+    __m256i step = _mm256_set1_epi32((int)(inc * 8));
+    size_t i;
+
+    // 128 bytes per iteration
+    for (i = 0; i + 32 <= words; i += 32) {
+        __m256i v0 = acc;
+        __m256i v1 = _mm256_add_epi32(v0, step);
+        __m256i v2 = _mm256_add_epi32(v1, step);
+        __m256i v3 = _mm256_add_epi32(v2, step);
+        __m256i *out = (__m256i *)(dst + i * 4);
+
+        acc = _mm256_add_epi32(v3, step);
+        if (mix) {
+            v0 = mix_avx2(v0);
+            v1 = mix_avx2(v1);
+            v2 = mix_avx2(v2);
+            v3 = mix_avx2(v3);
+        }
+        if (nontemporal) {
+            _mm256_stream_si256(out, v0);
+            _mm256_stream_si256(out + 1, v1);
+            _mm256_stream_si256(out + 2, v2);
+            _mm256_stream_si256(out + 3, v3);
+        } else {
+            _mm256_storeu_si256(out, v0);
+            _mm256_storeu_si256(out + 1, v1);
+            _mm256_storeu_si256(out + 2, v2);
+            _mm256_storeu_si256(out + 3, v3);
+        }
+    }
+
+    if (nontemporal) {
+        _mm_sfence();
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t verify_avx2(const uint8_t *src, size_t words, uint32_t base, uint32_t inc,
+                          bool mix, bool nontemporal) {
+    __m256i acc = start_avx2(base, inc);
+    __m256i step = _mm256_set1_epi32((int)(inc * 8));
+    size_t i;
+
+    // Streaming loads (MOVNTDQA) are what make reads from write-combined
+    // mappings tolerable; they need 32-byte alignment
+    if (((uintptr_t)src & (PATTERN_STREAM_ALIGN - 1)) != 0) {
+        nontemporal = false;
+    }
+
+    for (i = 0; i + 32 <= words; i += 32) {
+        __m256i e0 = acc;
+        __m256i e1 = _mm256_add_epi32(e0, step);
+        __m256i e2 = _mm256_add_epi32(e1, step);
+        __m256i e3 = _mm256_add_epi32(e2, step);
+        const __m256i *in = (const __m256i *)(src + i * 4);
+        __m256i d0, d1, d2, d3;
+
+        acc = _mm256_add_epi32(e3, step);
+        if (mix) {
+            e0 = mix_avx2(e0);
+            e1 = mix_avx2(e1);
+            e2 = mix_avx2(e2);
+            e3 = mix_avx2(e3);
+        }
+        if (nontemporal) {
+            d0 = _mm256_stream_load_si256((__m256i *)in);
+            d1 = _mm256_stream_load_si256((__m256i *)(in + 1));
+            d2 = _mm256_stream_load_si256((__m256i *)(in + 2));
+            d3 = _mm256_stream_load_si256((__m256i *)(in + 3));
+        } else {
+            d0 = _mm256_loadu_si256(in);
+            d1 = _mm256_loadu_si256(in + 1);
+            d2 = _mm256_loadu_si256(in + 2);
+            d3 = _mm256_loadu_si256(in + 3);
+        }
+        d0 = _mm256_or_si256(_mm256_xor_si256(d0, e0), _mm256_xor_si256(d1, e1));
+        d2 = _mm256_or_si256(_mm256_xor_si256(d2, e2), _mm256_xor_si256(d3, e3));
+        d0 = _mm256_or_si256(d0, d2);
+        if (!_mm256_testz_si256(d0, d0)) {
+            break;
+        }
+    }
+
+    _mm256_zeroupper();
+    return i;
+}
+#endif /* PATTERN_HAVE_X86 */
+
+#ifdef PATTERN_HAVE_NEON
+static inline uint32x4_t mix_neon(uint32x4_t x) {
+    x = veorq_u32(x, vshrq_n_u32(x, 15));
+    return veorq_u32(x, vshlq_n_u32(x, 7));
+}
+
+static inline uint32x4_t start_neon(uint32_t base, uint32_t inc) {
+    static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+    return vmlaq_n_u32(vdupq_n_u32(base), vld1q_u32(lanes), inc);
+}
+
+static size_t fill_neon(uint8_t *dst, size_t words, uint32_t base, uint32_t inc,
+                        bool mix, bool nontemporal) {
+    uint32x4_t acc = start_neon(base, inc);
+    uint32x4_t step = vdupq_n_u32(inc * 4);
+    size_t i;
+
+#if !defined(__aarch64__)
+    // ARMv7 has no non-temporal store; write-combining still merges the
+    // full-line stores below
+    (void)nontemporal;
+#endif
+
+    // 64 bytes per iteration
+    for (i = 0; i + 16 <= words; i += 16) {
+        uint32x4_t v0 = acc;
+        uint32x4_t v1 = vaddq_u32(v0, step);
+        uint32x4_t v2 = vaddq_u32(v1, step);
+        uint32x4_t v3 = vaddq_u32(v2, step);
+        uint32_t *out = (uint32_t *)(dst + i * 4);
+
+        acc = vaddq_u32(v3, step);
+        if (mix) {
+            v0 = mix_neon(v0);
+            v1 = mix_neon(v1);
+            v2 = mix_neon(v2);
+            v3 = mix_neon(v3);
+        }
+#if defined(__aarch64__)
+        if (nontemporal) {
+            __asm__ volatile("stnp %q0, %q1, [%2]\n\t"
+                             "stnp %q3, %q4, [%2, #32]"
+                             : : "w"(v0), "w"(v1), "r"(out), "w"(v2), "w"(v3) : "memory");
+            continue;
+        }
+#endif
+        vst1q_u32(out, v0);
+        vst1q_u32(out + 4, v1);
+        vst1q_u32(out + 8, v2);
+        vst1q_u32(out + 12, v3);
+    }
+
+    return i;
+}
+
+static size_t verify_neon(const uint8_t *src, size_t words, uint32_t base, uint32_t inc,
+                          bool mix, bool nontemporal) {
+    uint32x4_t acc = start_neon(base, inc);
+    uint32x4_t step = vdupq_n_u32(inc * 4);
+    size_t i;
+
+    (void)nontemporal;
+    for (i = 0; i + 16 <= words; i += 16) {
+        uint32x4_t e0 = acc;
+        uint32x4_t e1 = vaddq_u32(e0, step);
+        uint32x4_t e2 = vaddq_u32(e1, step);
+        uint32x4_t e3 = vaddq_u32(e2, step);
+        const uint32_t *in = (const uint32_t *)(src + i * 4);
+        uint32x4_t diff;
+        uint32x2_t fold;
+
+        acc = vaddq_u32(e3, step);
+        if (mix) {
+            e0 = mix_neon(e0);
+            e1 = mix_neon(e1);
+            e2 = mix_neon(e2);
+            e3 = mix_neon(e3);
+        }
+        diff = vorrq_u32(vorrq_u32(veorq_u32(vld1q_u32(in), e0), veorq_u32(vld1q_u32(in + 4), e1)),
+                         vorrq_u32(veorq_u32(vld1q_u32(in + 8), e2), veorq_u32(vld1q_u32(in + 12), e3)));
+        fold = vorr_u32(vget_low_u32(diff), vget_high_u32(diff));
+        if ((vget_lane_u32(fold, 0) | vget_lane_u32(fold, 1)) != 0) {
+            break;
+        }
+    }
+
+    return i;
+}
+#endif /* PATTERN_HAVE_NEON */
+
+static bool isa_supported(pattern_isa_t isa) {
+    switch (isa) {
+        case PATTERN_ISA_SCALAR:
+            return true;
+#ifdef PATTERN_HAVE_X86
+        case PATTERN_ISA_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case PATTERN_ISA_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef PATTERN_HAVE_NEON
+        case PATTERN_ISA_NEON:
+#if defined(__aarch64__)
+            return true;
+#else
+            return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+#endif
+        default:
+            return false;
+    }
+}
+
+bool pattern_set_isa(pattern_isa_t isa) {
+    if (!isa_supported(isa)) {
+        fprintf(stderr, "Pattern kernel %s not supported on this CPU\n", pattern_isa_to_string(isa));
+        return false;
+    }
+
+    switch (isa) {
+#ifdef PATTERN_HAVE_X86
+        case PATTERN_ISA_SSE2:
+            active_fill = fill_sse2;
+            active_verify = verify_sse2;
+            break;
+        case PATTERN_ISA_AVX2:
+            active_fill = fill_avx2;
+            active_verify = verify_avx2;
+            break;
+#endif
+#ifdef PATTERN_HAVE_NEON
+        case PATTERN_ISA_NEON:
+            active_fill = fill_neon;
+            active_verify = verify_neon;
+            break;
+#endif
+        default:
+            active_fill = NULL;
+            active_verify = NULL;
+            break;
+    }
+
+    active_isa = isa;
+    pattern_initialized = true;
+    return true;
+}
+
+void pattern_init(void) {
+    const char *override = getenv("TVTS_PATTERN_ISA");
+    pattern_isa_t isa;
+
+    if (override) {
+        for (isa = PATTERN_ISA_SCALAR; isa < PATTERN_ISA_MAX; isa++) {
+            if (strcasecmp(override, pattern_isa_to_string(isa)) == 0 && pattern_set_isa(isa)) {
+                return;
+            }
+        }
+        fprintf(stderr, "Ignoring TVTS_PATTERN_ISA=%s\n", override);
+    }
+
+    // Widest supported kernel first
+    static const pattern_isa_t preference[] = {
+        PATTERN_ISA_AVX2, PATTERN_ISA_SSE2, PATTERN_ISA_NEON
+    };
+    for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+        if (isa_supported(preference[i])) {
+            pattern_set_isa(preference[i]);
+            return;
+        }
+    }
+    pattern_set_isa(PATTERN_ISA_SCALAR);
+}
+
+// Lazy selection may race between test jobs; an explicit pattern_set_isa()
+// beforehand still wins
+static void pattern_init_once(void) {
+    if (!pattern_initialized) {
+        pattern_init();
+    }
+}
+
+pattern_isa_t pattern_get_isa(void) {
+    pthread_once(&pattern_once, pattern_init_once);
+    return active_isa;
+}
+
+uint32_t pattern_word(const test_pattern_t *pattern, uint32_t index) {
+    uint32_t base, inc;
+    bool mix;
+
+    pattern_generator(pattern, index, &base, &inc, &mix);
+    return mix ? mix_word(base) : base;
+}
+
+bool pattern_fill(void *dst, size_t size, const test_pattern_t *pattern, uint32_t first_word, uint32_t flags) {
+    uint8_t *out = dst;
+    size_t words = size / 4;
+    size_t i = 0;
+    uint32_t base, inc;
+    bool mix;
+    bool nontemporal = (flags & PATTERN_FLAG_NONTEMPORAL) != 0;
+
+    if (!dst || !pattern || pattern->type >= PATTERN_MAX) {
+        fprintf(stderr, "Invalid pattern fill parameters\n");
+        return false;
+    }
+
+    pthread_once(&pattern_once, pattern_init_once);
+
+    pattern_generator(pattern, first_word, &base, &inc, &mix);
+
+    // Streaming stores need an aligned destination; bring it there word by
+    // word, or fall back to regular stores if it is not even word aligned
+    if (nontemporal) {
+        if (((uintptr_t)out & 3) != 0) {
+            nontemporal = false;
+        } else {
+            while (i < words && ((uintptr_t)(out + i * 4) & (PATTERN_STREAM_ALIGN - 1)) != 0) {
+                store_word(out + i * 4, generate_word(base, inc, i, mix));
+                i++;
+            }
+        }
+    }
+
+    if (active_fill && i < words) {
+        i += active_fill(out + i * 4, words - i, base + (uint32_t)i * inc, inc, mix, nontemporal);
+    }
+
+    for (; i < words; i++) {
+        store_word(out + i * 4, generate_word(base, inc, i, mix));
+    }
+
+    if (size % 4) {
+        uint32_t last = generate_word(base, inc, words, mix);
+        memcpy(out + words * 4, &last, size % 4);
+    }
+
+    return true;
+}
+
+bool pattern_verify(const void *src, size_t size, const test_pattern_t *pattern, uint32_t first_word,
+                    uint32_t flags, size_t *mismatch_offset) {
+    const uint8_t *in = src;
+    size_t words = size / 4;
+    size_t i = 0;
+    uint32_t base, inc, expected;
+    bool mix;
+
+    if (!src || !pattern || pattern->type >= PATTERN_MAX) {
+        fprintf(stderr, "Invalid pattern verify parameters\n");
+        return false;
+    }
+
+    pthread_once(&pattern_once, pattern_init_once);
+
+    pattern_generator(pattern, first_word, &base, &inc, &mix);
+
+    if (active_verify && words > 0) {
+        i = active_verify(in, words, base, inc, mix, (flags & PATTERN_FLAG_NONTEMPORAL) != 0);
+    }
+
+    // Finish the tail, or pin down the word inside the failing block
+    for (; i < words; i++) {
+        expected = generate_word(base, inc, i, mix);
+        if (load_word(in + i * 4) != expected) {
+            break;
+        }
+    }
+
+    if (i == words) {
+        if (size % 4 == 0) {
+            return true;
+        }
+        expected = generate_word(base, inc, words, mix);
+    }
+
+    // Locate the first differing byte; a tail may still match
+    const uint8_t *want = (const uint8_t *)&expected;
+    size_t len = (i == words) ? size % 4 : 4;
+    size_t byte = 0;
+
+    while (byte < len && in[i * 4 + byte] == want[byte]) {
+        byte++;
+    }
+    if (byte == len) {
+        return true;
+    }
+
+    if (mismatch_offset) {
+        *mismatch_offset = i * 4 + byte;
+    }
+    return false;
+}
+
+test_pattern_t pattern_solid(uint32_t value) {
+    test_pattern_t pattern = { PATTERN_SOLID, value, 0 };
+    return pattern;
+}
+
+test_pattern_t pattern_solid_byte(uint8_t value) {
+    return pattern_solid(0x01010101u * value);
+}
+
+const char *pattern_type_to_string(pattern_type_t type) {
+    switch (type) {
+        case PATTERN_SOLID: return "solid";
+        case PATTERN_GRADIENT: return "gradient";
+        case PATTERN_CHECKSUM: return "checksum";
+        default: return "unknown";
+    }
+}
+
+const char *pattern_isa_to_string(pattern_isa_t isa) {
+    switch (isa) {
+        case PATTERN_ISA_SCALAR: return "scalar";
+        case PATTERN_ISA_SSE2: return "sse2";
+        case PATTERN_ISA_AVX2: return "avx2";
+        case PATTERN_ISA_NEON: return "neon";
+        default: return "unknown";
+    }
+}
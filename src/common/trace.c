@@ -0,0 +1,587 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include "common/trace.h"
+#include "report/report_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Record header upper bound: op, argc, two times and the arguments as ten
+// byte varints, and the data length
+#define TRACE_RECORD_HEAD_MAX (2 + 10 * (TRACE_MAX_ARGS + 3))
+// Issued this long after its recorded offset, a replayed operation is late
+#define TRACE_LATE_NS 1000000ULL
+
+typedef struct {
+    uint64_t hash;
+    uint64_t size;
+    uint32_t id;                      // 0: free slot
+} trace_payload_entry_t;
+
+// Jobs on every worker record into the same file
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool recording = false;
+static atomic_uint next_id = 0;
+static report_writer_t writer;
+static uint64_t file_offset = 0;      // Bytes handed to the writer so far
+static uint64_t origin_ns = 0;
+static int64_t last_start_ns = 0;
+
+// Open addressed set of the payloads already in the file
+static trace_payload_entry_t *payloads = NULL;
+static uint32_t payload_capacity = 0;
+static uint32_t payload_count = 0;
+
+static trace_replayer_t replayers[TRACE_CLASS_MAX];
+
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+// Word-at-a-time multiply/xorshift hash; frames are hashed on the
+// recording thread, so this has to run at memory speed. Two payloads
+// share an entry only if both their size and all 64 bits agree.
+static uint64_t payload_hash(const void *data, size_t size) {
+    const uint8_t *p = data;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, sizeof(v));
+        h = (h ^ v) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    for (; i < size; i++) {
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static void emit(const void *data, size_t size) {
+    report_writer_write(&writer, data, size);
+    file_offset += size;
+}
+
+// Encodes everything up to and including the data length
+static size_t encode_head(uint8_t *out, uint8_t op, uint64_t start_ns, uint64_t duration_ns,
+                          const uint64_t *args, uint32_t argc, uint64_t data_size) {
+    size_t n = 0;
+    out[n++] = op;
+    out[n++] = (uint8_t)argc;
+    int64_t start = (int64_t)(start_ns - origin_ns);
+    n += put_varint(out + n, zigzag(start - last_start_ns));
+    last_start_ns = start;
+    n += put_varint(out + n, duration_ns);
+    for (uint32_t i = 0; i < argc; i++) {
+        n += put_varint(out + n, args[i]);
+    }
+    n += put_varint(out + n, data_size);
+    return n;
+}
+
+static void write_record(uint8_t op, uint64_t start_ns, uint64_t duration_ns,
+                         const uint64_t *args, uint32_t argc, const void *data, size_t size) {
+    uint8_t head[TRACE_RECORD_HEAD_MAX];
+    emit(head, encode_head(head, op, start_ns, duration_ns, args, argc, size));
+    if (size) {
+        emit(data, size);
+    }
+}
+
+// A BLOB record's padding argument and data length depend on where its
+// header ends, so settle them together. It does not move the clock.
+static void write_blob(const void *payload, size_t size) {
+    static const uint8_t zeros[TRACE_BLOB_ALIGN];
+    uint8_t head[TRACE_RECORD_HEAD_MAX];
+    uint64_t pad = 0;
+    size_t n = 0;
+    for (int pass = 0; pass < 3; pass++) {
+        int64_t saved = last_start_ns;
+        n = encode_head(head, TRACE_OP_BLOB, origin_ns + (uint64_t)last_start_ns, 0, &pad, 1, pad + size);
+        last_start_ns = saved;
+        uint64_t fit = (TRACE_BLOB_ALIGN - (file_offset + n) % TRACE_BLOB_ALIGN) % TRACE_BLOB_ALIGN;
+        if (fit == pad) {
+            break;
+        }
+        pad = fit;
+    }
+    emit(head, n);
+    emit(zeros, (size_t)pad);
+    emit(payload, size);
+}
+
+static bool grow_payloads(void) {
+    uint32_t capacity = payload_capacity ? payload_capacity * 2 : 1024;
+    trace_payload_entry_t *table = calloc(capacity, sizeof(*table));
+    if (!table) {
+        return false;
+    }
+    for (uint32_t i = 0; i < payload_capacity; i++) {
+        if (payloads[i].id) {
+            uint32_t slot = (uint32_t)payloads[i].hash & (capacity - 1);
+            while (table[slot].id) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            table[slot] = payloads[i];
+        }
+    }
+    free(payloads);
+    payloads = table;
+    payload_capacity = capacity;
+    return true;
+}
+
+// Id of the stored copy of payload, writing it first if it is new; 0 if
+// the table cannot grow
+static uint32_t store_payload(const void *payload, size_t size) {
+    uint64_t hash = payload_hash(payload, size);
+    if ((payload_count + 1) * 4 > payload_capacity * 3 && !grow_payloads()) {
+        return 0;
+    }
+    uint32_t slot = (uint32_t)hash & (payload_capacity - 1);
+    while (payloads[slot].id) {
+        if (payloads[slot].hash == hash && payloads[slot].size == size) {
+            return payloads[slot].id;
+        }
+        slot = (slot + 1) & (payload_capacity - 1);
+    }
+    write_blob(payload, size);
+    payloads[slot].hash = hash;
+    payloads[slot].size = size;
+    payloads[slot].id = ++payload_count;
+    return payload_count;
+}
+
+bool trace_record_start(const char *path) {
+    pthread_mutex_lock(&trace_lock);
+    if (atomic_load(&recording)) {
+        pthread_mutex_unlock(&trace_lock);
+        return true;
+    }
+    if (!report_writer_open(&writer, path, false)) {
+        pthread_mutex_unlock(&trace_lock);
+        fprintf(stderr, "Cannot record trace to %s\n", path);
+        return false;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE] = { 0 };
+    memcpy(header, TRACE_MAGIC, 4);
+    header[4] = TRACE_VERSION;
+    header[6] = TRACE_HEADER_SIZE;
+    file_offset = 0;
+    emit(header, sizeof(header));
+
+    origin_ns = report_time_now_ns();
+    last_start_ns = 0;
+    char host[64] = "";
+    gethostname(host, sizeof(host) - 1);
+    uint64_t wall = (uint64_t)time(NULL);
+    write_record(TRACE_OP_BEGIN, origin_ns, 0, &wall, 1, host, strlen(host));
+
+    atomic_store(&recording, true);
+    pthread_mutex_unlock(&trace_lock);
+    return true;
+}
+
+void trace_record_stop(void) {
+    pthread_mutex_lock(&trace_lock);
+    if (atomic_load(&recording)) {
+        atomic_store(&recording, false);
+        if (!report_writer_close(&writer, true)) {
+            fprintf(stderr, "Trace recording is incomplete\n");
+        }
+        free(payloads);
+        payloads = NULL;
+        payload_capacity = payload_count = 0;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+bool trace_recording(void) {
+    return atomic_load_explicit(&recording, memory_order_relaxed);
+}
+
+uint64_t trace_begin(void) {
+    return trace_recording() ? report_time_now_ns() : 0;
+}
+
+uint32_t trace_next_id(void) {
+    return atomic_fetch_add(&next_id, 1) + 1;
+}
+
+void trace_record(trace_op_t op, uint64_t start_ns, const uint64_t *args, uint32_t argc,
+                  const void *data, size_t size) {
+    uint64_t end = report_time_now_ns();
+    pthread_mutex_lock(&trace_lock);
+    if (atomic_load(&recording) && argc <= TRACE_MAX_ARGS && start_ns >= origin_ns) {
+        write_record((uint8_t)op, start_ns, end - start_ns, args, argc, data, size);
+        report_writer_checkpoint(&writer);
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+void trace_record_payload(trace_op_t op, uint64_t start_ns, const uint64_t *args, uint32_t argc,
+                          const void *payload, size_t size) {
+    uint64_t end = report_time_now_ns();
+    pthread_mutex_lock(&trace_lock);
+    if (atomic_load(&recording) && argc < TRACE_MAX_ARGS && start_ns >= origin_ns) {
+        uint64_t all[TRACE_MAX_ARGS];
+        memcpy(all, args, argc * sizeof(*args));
+        all[argc] = payload && size ? store_payload(payload, size) : 0;
+        if (all[argc]) {
+            write_record((uint8_t)op | TRACE_OP_PAYLOAD, start_ns, end - start_ns, all, argc + 1, NULL, 0);
+        } else {
+            write_record((uint8_t)op, start_ns, end - start_ns, args, argc, NULL, 0);
+        }
+        report_writer_checkpoint(&writer);
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+bool trace_reader_open(const char *path, trace_reader_t *reader) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < TRACE_HEADER_SIZE) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    reader->map = map;
+    reader->size = (size_t)st.st_size;
+    if (memcmp(reader->map, TRACE_MAGIC, 4) != 0 || reader->map[4] != TRACE_VERSION ||
+        reader->map[6] < TRACE_HEADER_SIZE) {
+        fprintf(stderr, "%s is not a version %d trace\n", path, TRACE_VERSION);
+        trace_reader_close(reader);
+        return false;
+    }
+    reader->offset = reader->map[6];
+    return true;
+}
+
+static bool get_varint(const trace_reader_t *reader, size_t *offset, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && *offset < reader->size; shift += 7) {
+        uint8_t byte = reader->map[(*offset)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool add_blob(trace_reader_t *reader, const void *data, size_t size) {
+    if (reader->blob_count == reader->blob_capacity) {
+        uint32_t capacity = reader->blob_capacity ? reader->blob_capacity * 2 : 256;
+        trace_blob_t *blobs = realloc(reader->blobs, capacity * sizeof(*blobs));
+        if (!blobs) {
+            return false;
+        }
+        reader->blobs = blobs;
+        reader->blob_capacity = capacity;
+    }
+    reader->blobs[reader->blob_count].data = data;
+    reader->blobs[reader->blob_count].size = size;
+    reader->blob_count++;
+    return true;
+}
+
+int trace_reader_next(trace_reader_t *reader, trace_record_t *record) {
+    for (;;) {
+        size_t offset = reader->offset;
+        if (offset == reader->size) {
+            return 0;
+        }
+        // From here on, running out of file means the record was cut short
+        if (offset + 2 > reader->size) {
+            return -1;
+        }
+        uint8_t op = reader->map[offset];
+        uint32_t argc = reader->map[offset + 1];
+        offset += 2;
+        if (argc > TRACE_MAX_ARGS) {
+            return -1;
+        }
+
+        uint64_t delta, duration, size;
+        memset(record, 0, sizeof(*record));
+        if (!get_varint(reader, &offset, &delta) || !get_varint(reader, &offset, &duration)) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < argc; i++) {
+            if (!get_varint(reader, &offset, &record->args[i])) {
+                return -1;
+            }
+        }
+        if (!get_varint(reader, &offset, &size) || size > reader->size - offset) {
+            return -1;
+        }
+
+        int64_t start = reader->clock_ns + (int64_t)((delta >> 1) ^ -(delta & 1));
+        const uint8_t *data = reader->map + offset;
+        reader->offset = offset + size;
+
+        record->op = (trace_op_t)(op & ~TRACE_OP_PAYLOAD);
+        record->start_ns = start > 0 ? (uint64_t)start : 0;
+        record->duration_ns = duration;
+        record->argc = argc;
+        record->data = data;
+        record->data_size = size;
+
+        if (record->op == TRACE_OP_BLOB) {
+            if (argc != 1 || record->args[0] > size || !add_blob(reader, data + record->args[0],
+                                                                size - record->args[0])) {
+                return -1;
+            }
+            continue;
+        }
+        reader->clock_ns = start;
+        if (record->op == TRACE_OP_BEGIN) {
+            reader->start_time = argc ? (time_t)record->args[0] : 0;
+            size_t length = size < sizeof(reader->device) - 1 ? size : sizeof(reader->device) - 1;
+            memcpy(reader->device, data, length);
+            reader->device[length] = '\0';
+            continue;
+        }
+        if (op & TRACE_OP_PAYLOAD) {
+            uint64_t id = argc ? record->args[argc - 1] : 0;
+            if (id == 0 || id > reader->blob_count) {
+                return -1;
+            }
+            record->argc = argc - 1;
+            record->payload = reader->blobs[id - 1].data;
+            record->payload_size = reader->blobs[id - 1].size;
+        }
+        return 1;
+    }
+}
+
+void trace_reader_close(trace_reader_t *reader) {
+    if (reader->map) {
+        munmap((void *)reader->map, reader->size);
+    }
+    free(reader->blobs);
+    memset(reader, 0, sizeof(*reader));
+}
+
+void trace_set_replayer(trace_class_t cls, const trace_replayer_t *replayer) {
+    if (cls < TRACE_CLASS_MAX) {
+        replayers[cls] = *replayer;
+    }
+}
+
+trace_class_t trace_op_class(trace_op_t op) {
+    uint32_t cls = ((uint32_t)op >> 4) & 7;
+    return cls < TRACE_CLASS_MAX ? (trace_class_t)cls : TRACE_CLASS_MAX;
+}
+
+static void sleep_until(uint64_t target_ns) {
+    for (;;) {
+        uint64_t now = report_time_now_ns();
+        if (now >= target_ns) {
+            return;
+        }
+        uint64_t wait = target_ns - now;
+        struct timespec ts = { (time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static trace_op_stats_t *op_stats(trace_replay_stats_t *stats, trace_op_t op) {
+    uint32_t index = (uint32_t)op & (TRACE_MAX_OPS - 1);
+    if (!stats->ops[index]) {
+        stats->ops[index] = calloc(1, sizeof(trace_op_stats_t));
+        if (stats->ops[index]) {
+            report_histogram_init(&stats->ops[index]->recorded);
+            report_histogram_init(&stats->ops[index]->replayed);
+        }
+    }
+    return stats->ops[index];
+}
+
+static void replay_session(trace_replay_stats_t *stats, const trace_record_t *record) {
+    int length = (int)(record->data_size < 200 ? record->data_size : 200);
+    if (record->op == TRACE_OP_JOB) {
+        stats->jobs++;
+        printf("Replaying %.*s\n", length, (const char *)record->data);
+    } else if (record->op == TRACE_OP_RESULT) {
+        stats->results++;
+        if (record->argc && record->args[0]) {
+            stats->passed++;
+        }
+    }
+}
+
+bool trace_replay(const char *path, trace_speed_t speed, trace_replay_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->speed = speed;
+
+    trace_reader_t reader;
+    if (!trace_reader_open(path, &reader)) {
+        return false;
+    }
+
+    trace_record_t record;
+    uint64_t first_ns = 0, last_end_ns = 0;
+    uint64_t base_ns = report_time_now_ns();
+    int status;
+    while ((status = trace_reader_next(&reader, &record)) > 0) {
+        if (stats->records++ == 0) {
+            first_ns = record.start_ns;
+            base_ns = report_time_now_ns();
+        }
+        uint64_t offset = record.start_ns > first_ns ? record.start_ns - first_ns : 0;
+        if (offset + record.duration_ns > last_end_ns) {
+            last_end_ns = offset + record.duration_ns;
+        }
+
+        if (speed == TRACE_SPEED_RECORDED) {
+            sleep_until(base_ns + offset);
+            uint64_t lag = report_time_now_ns() - (base_ns + offset);
+            if (lag > TRACE_LATE_NS) {
+                stats->late++;
+            }
+            if (lag > stats->max_lag_ns) {
+                stats->max_lag_ns = lag;
+            }
+        }
+
+        trace_class_t cls = trace_op_class(record.op);
+        if (cls == TRACE_CLASS_SESSION) {
+            replay_session(stats, &record);
+            continue;
+        }
+        trace_op_stats_t *op = op_stats(stats, record.op);
+        if (!op) {
+            continue;
+        }
+        op->count++;
+        report_histogram_record(&op->recorded, record.duration_ns);
+        if (cls == TRACE_CLASS_MAX || !replayers[cls].replay) {
+            op->skipped++;
+            continue;
+        }
+
+        uint64_t duration_ns = 0;
+        if (replayers[cls].replay(replayers[cls].context, &record, &duration_ns)) {
+            report_histogram_record(&op->replayed, duration_ns);
+            op->bytes += record.payload_size;
+        } else {
+            op->failed++;
+        }
+    }
+    stats->replayed_ns = report_time_now_ns() - base_ns;
+    stats->recorded_ns = last_end_ns;
+    stats->truncated = status < 0;
+    if (stats->truncated) {
+        fprintf(stderr, "Trace %s is corrupt or cut short after %llu records\n", path,
+                (unsigned long long)stats->records);
+    }
+
+    for (int cls = 0; cls < TRACE_CLASS_MAX; cls++) {
+        if (replayers[cls].finish) {
+            replayers[cls].finish(replayers[cls].context);
+        }
+    }
+    memcpy(stats->device, reader.device, sizeof(stats->device));
+    stats->start_time = reader.start_time;
+    trace_reader_close(&reader);
+    return true;
+}
+
+void trace_replay_stats_free(trace_replay_stats_t *stats) {
+    for (int i = 0; i < TRACE_MAX_OPS; i++) {
+        free(stats->ops[i]);
+        stats->ops[i] = NULL;
+    }
+}
+
+const char *trace_op_to_string(trace_op_t op) {
+    switch (op) {
+    case TRACE_OP_BEGIN:            return "begin";
+    case TRACE_OP_BLOB:             return "blob";
+    case TRACE_OP_JOB:              return "job";
+    case TRACE_OP_RESULT:           return "result";
+    case TRACE_OP_DRM_CREATE:       return "drm.create";
+    case TRACE_OP_DRM_DESTROY:      return "drm.destroy";
+    case TRACE_OP_DRM_FILL:         return "drm.fill";
+    case TRACE_OP_DRM_FRAMEBUFFER:  return "drm.framebuffer";
+    case TRACE_OP_DRM_COMMIT:       return "drm.commit";
+    case TRACE_OP_DRM_FLIP:         return "drm.flip";
+    case TRACE_OP_V4L2_OPEN:        return "v4l2.open";
+    case TRACE_OP_V4L2_CLOSE:       return "v4l2.close";
+    case TRACE_OP_V4L2_FORMAT:      return "v4l2.format";
+    case TRACE_OP_V4L2_GET_FORMAT:  return "v4l2.get_format";
+    case TRACE_OP_V4L2_CONTROL:     return "v4l2.control";
+    case TRACE_OP_V4L2_FRAMERATE:   return "v4l2.framerate";
+    case TRACE_OP_V4L2_SUBSCRIBE:   return "v4l2.subscribe";
+    case TRACE_OP_V4L2_EVENT:       return "v4l2.event";
+    case TRACE_OP_V4L2_STOP:        return "v4l2.stop";
+    case TRACE_OP_V4L2_ALLOC:       return "v4l2.alloc";
+    case TRACE_OP_V4L2_STREAM:      return "v4l2.stream";
+    case TRACE_OP_V4L2_QBUF:        return "v4l2.qbuf";
+    case TRACE_OP_V4L2_DQBUF:       return "v4l2.dqbuf";
+    case TRACE_OP_V4L2_WAIT:        return "v4l2.wait";
+    case TRACE_OP_PCM_OPEN:         return "pcm.open";
+    case TRACE_OP_PCM_CLOSE:        return "pcm.close";
+    case TRACE_OP_PCM_START:        return "pcm.start";
+    case TRACE_OP_PCM_LINK:         return "pcm.link";
+    case TRACE_OP_PCM_WRITE:        return "pcm.write";
+    case TRACE_OP_PCM_READ:         return "pcm.read";
+    default:                        return "unknown";
+    }
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "common/worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WORKER_MAX_THREADS 32
+
+typedef enum {
+    JOB_PENDING,
+    JOB_RUNNING,
+    JOB_DONE
+} job_state_t;
+
+typedef struct {
+    worker_job_t *jobs;
+    job_state_t *states;
+    uint32_t count;
+    uint32_t started;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} worker_pool_t;
+
+static uint64_t get_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static bool jobs_conflict(const worker_job_t *a, const worker_job_t *b) {
+    for (uint32_t i = 0; i < a->resource_count; i++) {
+        if (strcmp(a->resources[i], WORKER_RESOURCE_ALL) == 0) {
+            return true;
+        }
+        for (uint32_t j = 0; j < b->resource_count; j++) {
+            if (strcmp(b->resources[j], WORKER_RESOURCE_ALL) == 0 ||
+                strcmp(a->resources[i], b->resources[j]) == 0) {
+                return true;
+            }
+        }
+    }
+
+    // An exclusive job with nothing else declared still excludes the rest
+    for (uint32_t j = 0; j < b->resource_count; j++) {
+        if (strcmp(b->resources[j], WORKER_RESOURCE_ALL) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// First pending job that conflicts neither with a running job nor with an
+// earlier pending one, so each resource sees its jobs in submission order.
+// Caller holds the lock.
+static int pick_job(worker_pool_t *pool) {
+    for (uint32_t i = 0; i < pool->count; i++) {
+        if (pool->states[i] != JOB_PENDING) {
+            continue;
+        }
+
+        bool blocked = false;
+        for (uint32_t j = 0; j < pool->count && !blocked; j++) {
+            if (j == i || pool->states[j] == JOB_DONE) {
+                continue;
+            }
+            if ((pool->states[j] == JOB_RUNNING || j < i) && jobs_conflict(&pool->jobs[i], &pool->jobs[j])) {
+                blocked = true;
+            }
+        }
+        if (!blocked) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void run_job(worker_job_t *job) {
+    uint64_t start_ms = get_monotonic_ms();
+    job->result = job->fn(job->arg);
+    job->duration_ms = (uint32_t)(get_monotonic_ms() - start_ms);
+}
+
+static void *worker_main(void *data) {
+    worker_pool_t *pool = data;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->started < pool->count) {
+        int index = pick_job(pool);
+        if (index < 0) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+            continue;
+        }
+
+        pool->states[index] = JOB_RUNNING;
+        pool->started++;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_job(&pool->jobs[index]);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->states[index] = JOB_DONE;
+        pthread_cond_broadcast(&pool->changed);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+void worker_job_init(worker_job_t *job, const char *name, worker_fn_t fn, void *arg) {
+    if (!job) {
+        return;
+    }
+    memset(job, 0, sizeof(worker_job_t));
+    if (name) {
+        strncpy(job->name, name, sizeof(job->name) - 1);
+    }
+    job->fn = fn;
+    job->arg = arg;
+}
+
+bool worker_job_add_resource(worker_job_t *job, const char *resource) {
+    if (!job || !resource || job->resource_count >= WORKER_MAX_RESOURCES) {
+        return false;
+    }
+    strncpy(job->resources[job->resource_count], resource, sizeof(job->resources[0]) - 1);
+    job->resource_count++;
+    return true;
+}
+
+uint32_t worker_default_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (uint32_t)cpus : 1;
+}
+
+bool worker_pool_run(worker_job_t *jobs, uint32_t count, uint32_t workers) {
+    if (!jobs || count == 0) {
+        return true;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (!jobs[i].fn) {
+            return false;
+        }
+    }
+
+    if (workers == 0) {
+        workers = worker_default_count();
+    }
+    if (workers > count) {
+        workers = count;
+    }
+    if (workers > WORKER_MAX_THREADS) {
+        workers = WORKER_MAX_THREADS;
+    }
+
+    bool result = true;
+    if (workers == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            run_job(&jobs[i]);
+            result &= jobs[i].result;
+        }
+        return result;
+    }
+
+    worker_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.jobs = jobs;
+    pool.count = count;
+    pool.states = calloc(count, sizeof(job_state_t));
+    if (!pool.states) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+
+    pthread_t threads[WORKER_MAX_THREADS];
+    uint32_t created = 0;
+    for (uint32_t i = 0; i < workers; i++) {
+        int err = pthread_create(&threads[created], NULL, worker_main, &pool);
+        if (err != 0) {
+            fprintf(stderr, "Cannot create worker thread: %s\n", strerror(err));
+            break;
+        }
+        created++;
+    }
+
+    // Without any thread the jobs still run, just here
+    if (created == 0) {
+        worker_main(&pool);
+    }
+    for (uint32_t i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.states);
+
+    for (uint32_t i = 0; i < count; i++) {
+        result &= jobs[i].result;
+    }
+    return result;
+}
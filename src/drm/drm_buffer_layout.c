@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "drm/drm_buffer_layout.h"
+#include <stdio.h>
+#include <string.h>
+
+// Format description; hsub/vsub apply to the chroma planes, and to the
+// width of packed 4:2:2 formats
+typedef struct {
+    drm_format_t format;
+    uint32_t num_planes;
+    uint32_t cpp[DRM_MAX_PLANES];
+    uint32_t hsub;
+    uint32_t vsub;
+} format_info_t;
+
+static const format_info_t format_table[] = {
+    { DRM_FORMAT_ARGB32,   1, { 4 },       1, 1 },
+    { DRM_FORMAT_XRGB8888, 1, { 4 },       1, 1 },
+    // The XR24 value is the XR12 (XRGB4444) fourcc
+    { DRM_FORMAT_XR24,     1, { 2 },       1, 1 },
+    { DRM_FORMAT_RGB565,   1, { 2 },       1, 1 },
+    { DRM_FORMAT_UYVY,     1, { 2 },       2, 1 },
+    { DRM_FORMAT_YUYV,     1, { 2 },       2, 1 },
+    { DRM_FORMAT_YVYU,     1, { 2 },       2, 1 },
+    { DRM_FORMAT_VYUY,     1, { 2 },       2, 1 },
+    { DRM_FORMAT_NV12,     2, { 1, 2 },    2, 2 },
+    { DRM_FORMAT_NV21,     2, { 1, 2 },    2, 2 },
+    { DRM_FORMAT_YUV420,   3, { 1, 1, 1 }, 2, 2 },
+    { DRM_FORMAT_YUV422,   3, { 1, 1, 1 }, 2, 1 },
+    { DRM_FORMAT_YUV444,   3, { 1, 1, 1 }, 1, 1 }
+};
+
+// Tile geometry in bytes and rows
+typedef struct {
+    drm_modifier_t modifier;
+    uint64_t fourcc_mod;
+    uint32_t width;
+    uint32_t height;
+    uint32_t span;
+    bool z_order;
+} tile_info_t;
+
+static const tile_info_t tile_table[] = {
+    { DRM_MODIFIER_LINEAR,  DRM_FORMAT_MOD_LINEAR,             0,   0,  0,   false },
+    // Samsung 64x32 tiles (NV12MT), row-major inside the tile; the tiles
+    // themselves follow the Z-flip-Z order of 2x2 groups
+    { DRM_MODIFIER_TILED,   DRM_FORMAT_MOD_SAMSUNG_64_32_TILE, 64,  32, 64,  true },
+    { DRM_MODIFIER_X_TILED, I915_FORMAT_MOD_X_TILED,           512, 8,  512, false },
+    // Y tiles are stored as 16-byte columns, 32 rows deep
+    { DRM_MODIFIER_Y_TILED, I915_FORMAT_MOD_Y_TILED,           128, 32, 16,  false }
+};
+
+static const format_info_t *find_format(drm_format_t format) {
+    for (size_t i = 0; i < sizeof(format_table) / sizeof(format_table[0]); i++) {
+        if (format_table[i].format == format) {
+            return &format_table[i];
+        }
+    }
+    return NULL;
+}
+
+static const tile_info_t *find_tile(drm_modifier_t modifier) {
+    for (size_t i = 0; i < sizeof(tile_table) / sizeof(tile_table[0]); i++) {
+        if (tile_table[i].modifier == modifier) {
+            return &tile_table[i];
+        }
+    }
+    return NULL;
+}
+
+bool drm_modifier_from_fourcc(uint64_t fourcc_mod, drm_modifier_t *modifier) {
+    for (size_t i = 0; i < sizeof(tile_table) / sizeof(tile_table[0]); i++) {
+        if (tile_table[i].fourcc_mod == fourcc_mod) {
+            *modifier = tile_table[i].modifier;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+uint32_t drm_format_plane_count(drm_format_t format) {
+    const format_info_t *info = find_format(format);
+    return info ? info->num_planes : 0;
+}
+
+uint32_t drm_format_cpp(drm_format_t format, uint32_t plane) {
+    const format_info_t *info = find_format(format);
+    return (info && plane < info->num_planes) ? info->cpp[plane] : 0;
+}
+
+bool drm_buffer_layout_init(drm_buffer_layout_t *layout, drm_format_t format, drm_modifier_t modifier,
+                            uint32_t width, uint32_t height, uint32_t pitch) {
+    const format_info_t *info = find_format(format);
+    const tile_info_t *tile = find_tile(modifier);
+
+    if (!layout || !info || !tile) {
+        fprintf(stderr, "No layout for format 0x%08x modifier 0x%llx\n",
+                (uint32_t)format, (unsigned long long)modifier);
+        return false;
+    }
+    if (width == 0 || height == 0 || width % info->hsub || (info->num_planes > 1 && height % info->vsub)) {
+        fprintf(stderr, "Size %ux%u does not fit format 0x%08x subsampling\n", width, height, (uint32_t)format);
+        return false;
+    }
+
+    memset(layout, 0, sizeof(*layout));
+    layout->num_planes = info->num_planes;
+    layout->modifier = tile->fourcc_mod;
+    layout->tile_width = tile->width;
+    layout->tile_height = tile->height;
+    layout->tile_span = tile->span;
+    layout->tile_z_order = tile->z_order;
+
+    // Chroma pitches are a fixed fraction of the luma pitch; keep all of
+    // them whole and tile aligned when picking the minimum. Z order needs
+    // whole 2x2 groups across the row.
+    uint32_t row_align = tile->width ? tile->width * (tile->z_order ? 2 : 1) : 1;
+    uint32_t row_count_align = tile->height ? tile->height : 1;
+    if (pitch == 0) {
+        uint32_t factor = 1;
+        for (uint32_t p = 1; p < info->num_planes; p++) {
+            uint32_t f = (info->cpp[0] * info->hsub + info->cpp[p] - 1) / info->cpp[p];
+            factor = f > factor ? f : factor;
+        }
+        pitch = align_up(width * info->cpp[0], row_align * factor);
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t p = 0; p < info->num_planes; p++) {
+        uint32_t hsub = p ? info->hsub : 1;
+        uint32_t vsub = p ? info->vsub : 1;
+
+        layout->row_bytes[p] = width / hsub * info->cpp[p];
+        layout->rows[p] = height / vsub;
+        layout->pitches[p] = p ? align_up(pitch * info->cpp[p] / (info->cpp[0] * hsub), row_align) : pitch;
+        if (layout->pitches[p] < layout->row_bytes[p] || layout->pitches[p] % row_align) {
+            fprintf(stderr, "Pitch %u does not hold plane %u (%u bytes, %u alignment)\n",
+                    layout->pitches[p], p, layout->row_bytes[p], row_align);
+            return false;
+        }
+
+        layout->offsets[p] = offset;
+        offset += layout->pitches[p] * align_up(layout->rows[p], row_count_align);
+    }
+    layout->size = offset;
+
+    return true;
+}
+
+static uint8_t rgb_to_y(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static uint8_t rgb_to_u(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint8_t)(((-38 * (int32_t)r - 74 * (int32_t)g + 112 * (int32_t)b + 128) >> 8) + 128);
+}
+
+static uint8_t rgb_to_v(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint8_t)(((112 * (int32_t)r - 94 * (int32_t)g - 18 * (int32_t)b + 128) >> 8) + 128);
+}
+
+static uint32_t pack4(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+    return (uint32_t)b0 | ((uint32_t)b1 << 8) | ((uint32_t)b2 << 16) | ((uint32_t)b3 << 24);
+}
+
+bool drm_format_solid_patterns(drm_format_t format, uint32_t argb, test_pattern_t patterns[DRM_MAX_PLANES]) {
+    uint32_t r = (argb >> 16) & 0xFF;
+    uint32_t g = (argb >> 8) & 0xFF;
+    uint32_t b = argb & 0xFF;
+    uint8_t y = rgb_to_y(r, g, b);
+    uint8_t u = rgb_to_u(r, g, b);
+    uint8_t v = rgb_to_v(r, g, b);
+    uint32_t pixel16;
+
+    for (uint32_t p = 0; p < DRM_MAX_PLANES; p++) {
+        patterns[p] = pattern_solid(0);
+    }
+
+    // Words are little-endian, so the first byte in memory is the low byte
+    switch (format) {
+        case DRM_FORMAT_ARGB32:
+        case DRM_FORMAT_XRGB8888:
+            patterns[0] = pattern_solid(argb);
+            break;
+        case DRM_FORMAT_XR24:
+            pixel16 = 0xF000 | ((r >> 4) << 8) | ((g >> 4) << 4) | (b >> 4);
+            patterns[0] = pattern_solid(pixel16 | (pixel16 << 16));
+            break;
+        case DRM_FORMAT_RGB565:
+            pixel16 = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+            patterns[0] = pattern_solid(pixel16 | (pixel16 << 16));
+            break;
+        case DRM_FORMAT_YUYV:
+            patterns[0] = pattern_solid(pack4(y, u, y, v));
+            break;
+        case DRM_FORMAT_YVYU:
+            patterns[0] = pattern_solid(pack4(y, v, y, u));
+            break;
+        case DRM_FORMAT_UYVY:
+            patterns[0] = pattern_solid(pack4(u, y, v, y));
+            break;
+        case DRM_FORMAT_VYUY:
+            patterns[0] = pattern_solid(pack4(v, y, u, y));
+            break;
+        case DRM_FORMAT_NV12:
+            patterns[0] = pattern_solid_byte(y);
+            patterns[1] = pattern_solid(pack4(u, v, u, v));
+            break;
+        case DRM_FORMAT_NV21:
+            patterns[0] = pattern_solid_byte(y);
+            patterns[1] = pattern_solid(pack4(v, u, v, u));
+            break;
+        case DRM_FORMAT_YUV420:
+        case DRM_FORMAT_YUV422:
+        case DRM_FORMAT_YUV444:
+            patterns[0] = pattern_solid_byte(y);
+            patterns[1] = pattern_solid_byte(u);
+            patterns[2] = pattern_solid_byte(v);
+            break;
+        default:
+            fprintf(stderr, "No solid pattern for format 0x%08x\n", (uint32_t)format);
+            return false;
+    }
+
+    return true;
+}
+
+// Position of tile (x, y) in memory under Samsung's Z-flip-Z order: each
+// pair of tile rows is walked in 2x2 groups, alternating Z and mirrored Z
+// shapes, and an odd last tile row is stored linearly. x_tiles is even.
+static size_t z_order_tile(uint32_t x, uint32_t y, uint32_t x_tiles, uint32_t y_tiles) {
+    size_t index = (size_t)(y & ~1u) * x_tiles + x;
+
+    if (y & 1) {
+        index += (x & ~3u) + 2;
+    } else if (y_tiles % 2 == 0 || y != y_tiles - 1) {
+        index += (x + 2) & ~3u;
+    }
+    return index;
+}
+
+// Byte address of (x, y) in a plane; x is in bytes
+static size_t plane_address(const drm_buffer_layout_t *layout, uint32_t plane, uint32_t x, uint32_t y) {
+    size_t pitch = layout->pitches[plane];
+    size_t base = layout->offsets[plane];
+
+    if (!layout->tile_width) {
+        return base + (size_t)y * pitch + x;
+    }
+
+    uint32_t tw = layout->tile_width;
+    uint32_t th = layout->tile_height;
+    uint32_t span = layout->tile_span;
+    if (layout->tile_z_order) {
+        size_t tile = z_order_tile(x / tw, y / th, (uint32_t)(pitch / tw), (layout->rows[plane] + th - 1) / th);
+        return base + tile * tw * th + (size_t)(y % th) * tw + x % tw;
+    }
+    return base + (size_t)(y / th) * pitch * th + (size_t)(x / tw) * tw * th +
+           (size_t)((x % tw) / span) * span * th + (size_t)(y % th) * span + x % span;
+}
+
+// Walk a plane in contiguous segments: whole rows when linear, tile row
+// segments when tiled. The pattern index follows the pixel raster, so the
+// same content reads back identically under any tiling.
+static bool walk_plane(uint8_t *map, const drm_buffer_layout_t *layout, uint32_t plane,
+                       const test_pattern_t *pattern, uint32_t flags, bool verify,
+                       uint32_t *mismatch_x, uint32_t *mismatch_y) {
+    uint32_t row_bytes = layout->row_bytes[plane];
+    uint32_t rows = layout->rows[plane];
+    uint32_t row_words = (row_bytes + 3) / 4;
+    uint32_t segment = layout->tile_width ? layout->tile_span : row_bytes;
+
+    // Packed linear planes are one contiguous range
+    if (!layout->tile_width && layout->pitches[plane] == row_bytes && row_bytes % 4 == 0) {
+        row_bytes *= rows;
+        segment = row_bytes;
+        rows = 1;
+    }
+
+    for (uint32_t y = 0; y < rows; y++) {
+        for (uint32_t x = 0; x < row_bytes; x += segment) {
+            uint32_t len = row_bytes - x < segment ? row_bytes - x : segment;
+            uint8_t *ptr = map + plane_address(layout, plane, x, y);
+            uint32_t first_word = y * row_words + x / 4;
+            size_t offset = 0;
+
+            if (!verify) {
+                if (!pattern_fill(ptr, len, pattern, first_word, flags)) {
+                    return false;
+                }
+            } else if (!pattern_verify(ptr, len, pattern, first_word, flags, &offset)) {
+                offset += x;
+                if (mismatch_x) {
+                    *mismatch_x = (uint32_t)(offset % layout->row_bytes[plane]);
+                }
+                if (mismatch_y) {
+                    *mismatch_y = y + (uint32_t)(offset / layout->row_bytes[plane]);
+                }
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool drm_buffer_layout_fill(void *map, const drm_buffer_layout_t *layout, uint32_t plane,
+                            const test_pattern_t *pattern, uint32_t flags) {
+    if (!map || !layout || !pattern || plane >= layout->num_planes) {
+        return false;
+    }
+    return walk_plane(map, layout, plane, pattern, flags, false, NULL, NULL);
+}
+
+bool drm_buffer_layout_verify(const void *map, const drm_buffer_layout_t *layout, uint32_t plane,
+                              const test_pattern_t *pattern, uint32_t flags,
+                              uint32_t *mismatch_x, uint32_t *mismatch_y) {
+    if (!map || !layout || !pattern || plane >= layout->num_planes) {
+        return false;
+    }
+    return walk_plane((uint8_t *)map, layout, plane, pattern, flags, true, mismatch_x, mismatch_y);
+}
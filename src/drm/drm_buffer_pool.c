@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "drm/drm_buffer_pool.h"
+#include "report/report_live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One slot per buffer key, chained within a hash bucket
+typedef struct pool_slot {
+    uint32_t width;
+    uint32_t height;
+    drm_format_t format;
+    drm_modifier_t modifier;
+    drm_buffer_t *idle[DRM_BUFFER_POOL_MAX_IDLE];
+    uint32_t idle_count;
+    struct pool_slot *next;
+} pool_slot_t;
+
+static pool_slot_t *buckets[DRM_BUFFER_POOL_BUCKETS];
+static drm_buffer_pool_stats_t pool_stats;
+
+// Live metrics, registered on first use once an exporter is running
+static report_live_id_t live_hits = -1;
+static report_live_id_t live_misses = -1;
+static report_live_id_t live_evictions = -1;
+static report_live_id_t live_idle_buffers = -1;
+static report_live_id_t live_idle_bytes = -1;
+
+static void live_register(void) {
+    if (live_hits >= 0 || !report_live_active()) {
+        return;
+    }
+    live_hits = report_live_register("tvts_drm_pool_hits_total", NULL, REPORT_LIVE_COUNTER,
+                                     "Buffer acquires served from an idle buffer");
+    live_misses = report_live_register("tvts_drm_pool_misses_total", NULL, REPORT_LIVE_COUNTER,
+                                       "Buffer acquires that had to allocate");
+    live_evictions = report_live_register("tvts_drm_pool_evictions_total", NULL, REPORT_LIVE_COUNTER,
+                                          "Released buffers destroyed because the pool was full");
+    live_idle_buffers = report_live_register("tvts_drm_pool_idle_buffers", NULL, REPORT_LIVE_GAUGE,
+                                             "Buffers parked in the pool");
+    live_idle_bytes = report_live_register("tvts_drm_pool_idle_bytes", NULL, REPORT_LIVE_GAUGE,
+                                           "Memory held by parked buffers");
+}
+
+static void live_publish_idle(void) {
+    report_live_set(live_idle_buffers, pool_stats.idle_buffers);
+    report_live_set(live_idle_bytes, (double)pool_stats.idle_bytes);
+}
+
+static uint32_t hash_key(uint32_t width, uint32_t height, uint32_t format, uint64_t modifier) {
+    uint64_t words[4] = { width, height, format, modifier };
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (int i = 0; i < 4; i++) {
+        hash ^= words[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return (uint32_t)(hash ^ (hash >> 32)) % DRM_BUFFER_POOL_BUCKETS;
+}
+
+static pool_slot_t *find_slot(uint32_t width, uint32_t height, drm_format_t format,
+                              drm_modifier_t modifier, bool create) {
+    uint32_t bucket = hash_key(width, height, format, modifier);
+
+    for (pool_slot_t *slot = buckets[bucket]; slot; slot = slot->next) {
+        if (slot->width == width && slot->height == height &&
+            slot->format == format && slot->modifier == modifier) {
+            return slot;
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    pool_slot_t *slot = calloc(1, sizeof(pool_slot_t));
+    if (!slot) {
+        return NULL;
+    }
+
+    slot->width = width;
+    slot->height = height;
+    slot->format = format;
+    slot->modifier = modifier;
+    slot->next = buckets[bucket];
+    buckets[bucket] = slot;
+    return slot;
+}
+
+drm_buffer_t *drm_buffer_pool_acquire(const test_config_t *config) {
+    if (!config) {
+        return NULL;
+    }
+
+    live_register();
+
+    pool_slot_t *slot = find_slot(config->width, config->height, config->format, config->modifier, false);
+    if (slot && slot->idle_count > 0) {
+        drm_buffer_t *buf = slot->idle[--slot->idle_count];
+        pool_stats.hits++;
+        pool_stats.idle_buffers--;
+        pool_stats.idle_bytes -= buf->size;
+        report_live_add(live_hits, 1);
+        live_publish_idle();
+        buf->compression = config->compression;
+        return buf;
+    }
+
+    pool_stats.misses++;
+    report_live_add(live_misses, 1);
+    return create_drm_buffer(config);
+}
+
+void drm_buffer_pool_release(drm_buffer_t *buf) {
+    if (!buf) {
+        return;
+    }
+
+    // Imported buffers belong to their exporter and are never recycled;
+    // the pool only parks buffers of the display device it hands out
+    if (buf->imported || buf->device != drm_get_display_device()) {
+        destroy_drm_buffer(buf);
+        return;
+    }
+
+    pool_slot_t *slot = find_slot(buf->width, buf->height, buf->format, buf->modifier, true);
+    if (!slot || slot->idle_count >= DRM_BUFFER_POOL_MAX_IDLE ||
+        pool_stats.idle_bytes + buf->size > DRM_BUFFER_POOL_MAX_BYTES) {
+        pool_stats.evictions++;
+        report_live_add(live_evictions, 1);
+        destroy_drm_buffer(buf);
+        return;
+    }
+
+    slot->idle[slot->idle_count++] = buf;
+    pool_stats.idle_buffers++;
+    pool_stats.idle_bytes += buf->size;
+    live_publish_idle();
+}
+
+void drm_buffer_pool_trim(void) {
+    for (uint32_t i = 0; i < DRM_BUFFER_POOL_BUCKETS; i++) {
+        pool_slot_t *slot = buckets[i];
+        while (slot) {
+            pool_slot_t *next = slot->next;
+            for (uint32_t j = 0; j < slot->idle_count; j++) {
+                destroy_drm_buffer(slot->idle[j]);
+            }
+            free(slot);
+            slot = next;
+        }
+        buckets[i] = NULL;
+    }
+
+    // Hit/miss counters survive a trim so they can be reported afterwards
+    pool_stats.idle_buffers = 0;
+    pool_stats.idle_bytes = 0;
+    live_publish_idle();
+}
+
+void drm_buffer_pool_get_stats(drm_buffer_pool_stats_t *stats) {
+    if (stats) {
+        memcpy(stats, &pool_stats, sizeof(drm_buffer_pool_stats_t));
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "drm/drm_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <xf86drm.h>
+
+bool drm_device_open(drm_device_t *device, const char *path) {
+    memset(device, 0, sizeof(drm_device_t));
+    device->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (device->fd < 0) {
+        perror("Failed to open DRM device");
+        return false;
+    }
+    snprintf(device->path, sizeof(device->path), "%s", path);
+
+    device->node_type = drmGetNodeTypeFromFd(device->fd);
+    drmVersionPtr version = drmGetVersion(device->fd);
+    if (version) {
+        snprintf(device->driver, sizeof(device->driver), "%s", version->name);
+        drmFreeVersion(version);
+    }
+
+    uint64_t cap = 0;
+    if (drmGetCap(device->fd, DRM_CAP_PRIME, &cap) == 0) {
+        device->prime = cap;
+    }
+
+    // Render nodes reject the KMS and dumb buffer ioctls outright
+    if (device->node_type != DRM_NODE_PRIMARY) {
+        return true;
+    }
+    device->dumb = drmGetCap(device->fd, DRM_CAP_DUMB_BUFFER, &cap) == 0 && cap;
+    device->atomic = drmSetClientCap(device->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0 &&
+                     drmSetClientCap(device->fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+
+    // Render-only GPUs expose a primary node without mode resources
+    drmModeResPtr res = drmModeGetResources(device->fd);
+    if (!res) {
+        return true;
+    }
+    bool has_crtcs = res->count_crtcs > 0;
+    drmModeFreeResources(res);
+    if (!has_crtcs || !drm_topology_init(&device->topology, device->fd)) {
+        return true;
+    }
+    device->kms = true;
+
+    for (uint32_t i = 0; i < device->topology.plane_count; i++) {
+        if (!drm_format_set_merge(&device->formats, &device->topology.planes[i].formats)) {
+            fprintf(stderr, "Failed to collect formats of %s\n", path);
+            drm_device_close(device);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void drm_device_close(drm_device_t *device) {
+    drm_format_set_free(&device->formats);
+    if (device->kms) {
+        drm_topology_free(&device->topology);
+        device->kms = false;
+    }
+    if (device->fd >= 0) {
+        close(device->fd);
+        device->fd = -1;
+    }
+}
+
+const char *drm_device_name(const drm_device_t *device) {
+    const char *slash = strrchr(device->path, '/');
+    return slash ? slash + 1 : device->path;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+uint32_t drm_device_enumerate(char paths[][DRM_DEVICE_PATH_MAX], uint32_t max) {
+    DIR *dir = opendir(DRM_DIR_NAME);
+    if (!dir) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    struct dirent *entry;
+    while (count < max && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "card", 4) != 0 && strncmp(entry->d_name, "renderD", 7) != 0) {
+            continue;
+        }
+        snprintf(paths[count++], DRM_DEVICE_PATH_MAX, "%s/%.32s", DRM_DIR_NAME, entry->d_name);
+    }
+    closedir(dir);
+
+    qsort(paths, count, DRM_DEVICE_PATH_MAX, compare_paths);
+    return count;
+}
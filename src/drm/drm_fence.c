@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "drm/drm_fence.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <xf86drm.h>
+
+static int64_t deadline_ns(int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec + (int64_t)timeout_ms * 1000000LL;
+}
+
+bool drm_timeline_create(drm_timeline_t *timeline, drm_device_t *device) {
+    memset(timeline, 0, sizeof(drm_timeline_t));
+    timeline->device = device;
+
+    uint64_t cap = 0;
+    if (drmGetCap(device->fd, DRM_CAP_SYNCOBJ_TIMELINE, &cap) < 0 || !cap) {
+        fprintf(stderr, "%s has no timeline syncobjs\n", drm_device_name(device));
+        return false;
+    }
+    if (drmSyncobjCreate(device->fd, 0, &timeline->handle) < 0) {
+        perror("Failed to create timeline syncobj");
+        return false;
+    }
+    if (drmSyncobjCreate(device->fd, 0, &timeline->staging) < 0) {
+        perror("Failed to create syncobj");
+        drmSyncobjDestroy(device->fd, timeline->handle);
+        timeline->handle = 0;
+        return false;
+    }
+    return true;
+}
+
+void drm_timeline_destroy(drm_timeline_t *timeline) {
+    if (timeline->staging) {
+        drmSyncobjDestroy(timeline->device->fd, timeline->staging);
+        timeline->staging = 0;
+    }
+    if (timeline->handle) {
+        drmSyncobjDestroy(timeline->device->fd, timeline->handle);
+        timeline->handle = 0;
+    }
+}
+
+bool drm_timeline_signal(drm_timeline_t *timeline, uint64_t point) {
+    return drmSyncobjTimelineSignal(timeline->device->fd, &timeline->handle, &point, 1) == 0;
+}
+
+uint64_t drm_timeline_query(drm_timeline_t *timeline) {
+    uint64_t point = 0;
+    drmSyncobjQuery(timeline->device->fd, &timeline->handle, &point, 1);
+    return point;
+}
+
+int drm_timeline_wait(drm_timeline_t *timeline, uint64_t point, int timeout_ms) {
+    int ret = drmSyncobjTimelineWait(timeline->device->fd, &timeline->handle, &point, 1,
+                                     deadline_ns(timeout_ms), DRM_SYNCOBJ_WAIT_FLAGS_WAIT_FOR_SUBMIT, NULL);
+    return ret < 0 ? -errno : 0;
+}
+
+int drm_timeline_export_sync_file(drm_timeline_t *timeline, uint64_t point) {
+    int fd = timeline->device->fd;
+    int sync_file = -1;
+
+    // A sync_file holds one fence, so the point goes through the binary syncobj
+    if (drmSyncobjTransfer(fd, timeline->staging, 0, timeline->handle, point, 0) < 0 ||
+        drmSyncobjExportSyncFile(fd, timeline->staging, &sync_file) < 0) {
+        return -1;
+    }
+    return sync_file;
+}
+
+bool drm_timeline_import_sync_file(drm_timeline_t *timeline, uint64_t point, int fd) {
+    int dev = timeline->device->fd;
+    return drmSyncobjImportSyncFile(dev, timeline->staging, fd) == 0 &&
+           drmSyncobjTransfer(dev, timeline->handle, point, timeline->staging, 0, 0) == 0;
+}
+
+int drm_sync_file_wait(int fd, int timeout_ms) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+    for (;;) {
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret > 0) {
+            return (pfd.revents & (POLLERR | POLLNVAL)) ? -EINVAL : 0;
+        }
+        if (ret == 0) {
+            return -ETIME;
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+}
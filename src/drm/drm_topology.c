@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "drm/drm_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <xf86drm.h>
+#include <drm_fourcc.h>
+
+#define FORMAT_SET_MIN_CAPACITY 64
+
+static const char *prop_names[DRM_PROP_COUNT] = {
+    [DRM_PROP_FB_ID] = "FB_ID",
+    [DRM_PROP_CRTC_ID] = "CRTC_ID",
+    [DRM_PROP_SRC_X] = "SRC_X",
+    [DRM_PROP_SRC_Y] = "SRC_Y",
+    [DRM_PROP_SRC_W] = "SRC_W",
+    [DRM_PROP_SRC_H] = "SRC_H",
+    [DRM_PROP_CRTC_X] = "CRTC_X",
+    [DRM_PROP_CRTC_Y] = "CRTC_Y",
+    [DRM_PROP_CRTC_W] = "CRTC_W",
+    [DRM_PROP_CRTC_H] = "CRTC_H",
+    [DRM_PROP_TYPE] = "type",
+    [DRM_PROP_IN_FORMATS] = "IN_FORMATS",
+    [DRM_PROP_IN_FENCE_FD] = "IN_FENCE_FD",
+    [DRM_PROP_ZPOS] = "zpos",
+    [DRM_PROP_ROTATION] = "rotation",
+    [DRM_PROP_ACTIVE] = "ACTIVE",
+    [DRM_PROP_MODE_ID] = "MODE_ID",
+    [DRM_PROP_OUT_FENCE_PTR] = "OUT_FENCE_PTR",
+    [DRM_PROP_VRR_ENABLED] = "VRR_ENABLED",
+    [DRM_PROP_GAMMA_LUT] = "GAMMA_LUT",
+    [DRM_PROP_GAMMA_LUT_SIZE] = "GAMMA_LUT_SIZE",
+    [DRM_PROP_DEGAMMA_LUT] = "DEGAMMA_LUT",
+    [DRM_PROP_CTM] = "CTM",
+    [DRM_PROP_DPMS] = "DPMS",
+    [DRM_PROP_EDID] = "EDID",
+    [DRM_PROP_LINK_STATUS] = "link-status",
+};
+
+const char *drm_prop_name(drm_prop_t prop) {
+    return prop < DRM_PROP_COUNT ? prop_names[prop] : "UNKNOWN";
+}
+
+int drm_atomic_add(drmModeAtomicReq *req, uint32_t object_id, const drm_object_props_t *props,
+                   drm_prop_t prop, uint64_t value) {
+    if (prop >= DRM_PROP_COUNT || !props->ids[prop]) {
+        return -ENOENT;
+    }
+    return drmModeAtomicAddProperty(req, object_id, props->ids[prop], value);
+}
+
+// Format sets
+
+static uint32_t format_hash(uint32_t format, uint64_t modifier) {
+    uint64_t h = modifier ^ ((uint64_t)format * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+static drm_format_entry_t *format_slot(drm_format_entry_t *entries, uint32_t capacity,
+                                       uint32_t format, uint64_t modifier) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = format_hash(format, modifier) & mask;
+
+    while (entries[i].used && (entries[i].format != format || entries[i].modifier != modifier)) {
+        i = (i + 1) & mask;
+    }
+    return &entries[i];
+}
+
+static bool format_set_grow(drm_format_set_t *set) {
+    uint32_t capacity = set->capacity ? set->capacity * 2 : FORMAT_SET_MIN_CAPACITY;
+    drm_format_entry_t *entries = calloc(capacity, sizeof(drm_format_entry_t));
+    if (!entries) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < set->capacity; i++) {
+        if (set->entries[i].used) {
+            *format_slot(entries, capacity, set->entries[i].format, set->entries[i].modifier) = set->entries[i];
+        }
+    }
+
+    free(set->entries);
+    set->entries = entries;
+    set->capacity = capacity;
+    return true;
+}
+
+static bool format_set_insert(drm_format_set_t *set, uint32_t format, uint64_t modifier) {
+    // Keep the load factor under a half so probe runs stay short
+    if ((set->count + 1) * 2 > set->capacity && !format_set_grow(set)) {
+        return false;
+    }
+
+    drm_format_entry_t *slot = format_slot(set->entries, set->capacity, format, modifier);
+    if (slot->used) {
+        return false;
+    }
+    slot->format = format;
+    slot->modifier = modifier;
+    slot->used = 1;
+    set->count++;
+    return true;
+}
+
+static bool format_set_contains(const drm_format_set_t *set, uint32_t format, uint64_t modifier) {
+    if (!set || !set->capacity) {
+        return false;
+    }
+    return format_slot(set->entries, set->capacity, format, modifier)->used;
+}
+
+bool drm_format_set_add(drm_format_set_t *set, uint32_t format, uint64_t modifier) {
+    if (!set || !format || modifier == DRM_FORMAT_MOD_INVALID) {
+        return false;
+    }
+    if (format_set_contains(set, format, modifier)) {
+        return true;
+    }
+    if (!format_set_insert(set, format, modifier)) {
+        return false;
+    }
+    set->pair_count++;
+
+    // Single-key markers for format-only and modifier-only queries
+    if (!format_set_contains(set, format, DRM_FORMAT_MOD_INVALID)) {
+        format_set_insert(set, format, DRM_FORMAT_MOD_INVALID);
+    }
+    if (!format_set_contains(set, 0, modifier)) {
+        format_set_insert(set, 0, modifier);
+    }
+    return true;
+}
+
+bool drm_format_set_merge(drm_format_set_t *dst, const drm_format_set_t *src) {
+    for (uint32_t i = 0; i < src->capacity; i++) {
+        const drm_format_entry_t *e = &src->entries[i];
+        if (e->used && e->format && e->modifier != DRM_FORMAT_MOD_INVALID &&
+            !drm_format_set_add(dst, e->format, e->modifier)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool drm_format_set_has(const drm_format_set_t *set, uint32_t format, uint64_t modifier) {
+    return format && modifier != DRM_FORMAT_MOD_INVALID && format_set_contains(set, format, modifier);
+}
+
+bool drm_format_set_has_format(const drm_format_set_t *set, uint32_t format) {
+    return format && format_set_contains(set, format, DRM_FORMAT_MOD_INVALID);
+}
+
+bool drm_format_set_has_modifier(const drm_format_set_t *set, uint64_t modifier) {
+    return modifier != DRM_FORMAT_MOD_INVALID && format_set_contains(set, 0, modifier);
+}
+
+void drm_format_set_free(drm_format_set_t *set) {
+    free(set->entries);
+    memset(set, 0, sizeof(drm_format_set_t));
+}
+
+// Discovery
+
+static bool read_props(int fd, uint32_t object_id, uint32_t object_type, drm_object_props_t *out) {
+    memset(out, 0, sizeof(drm_object_props_t));
+
+    drmModeObjectPropertiesPtr props = drmModeObjectGetProperties(fd, object_id, object_type);
+    if (!props) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < props->count_props; i++) {
+        drmModePropertyPtr prop = drmModeGetProperty(fd, props->props[i]);
+        if (!prop) {
+            continue;
+        }
+        for (uint32_t p = 0; p < DRM_PROP_COUNT; p++) {
+            if (strcmp(prop->name, prop_names[p]) == 0) {
+                out->ids[p] = prop->prop_id;
+                out->values[p] = props->prop_values[i];
+                break;
+            }
+        }
+        drmModeFreeProperty(prop);
+    }
+
+    drmModeFreeObjectProperties(props);
+    return true;
+}
+
+// IN_FORMATS: a format table plus modifier entries, each carrying a 64-bit
+// mask over a window of the table starting at offset
+static bool parse_in_formats(int fd, uint32_t blob_id, drm_format_set_t *set) {
+    drmModePropertyBlobPtr blob = drmModeGetPropertyBlob(fd, blob_id);
+    if (!blob) {
+        return false;
+    }
+
+    const struct drm_format_modifier_blob *header = blob->data;
+    bool valid = blob->length >= sizeof(*header) &&
+                 header->formats_offset + (uint64_t)header->count_formats * sizeof(uint32_t) <= blob->length &&
+                 header->modifiers_offset +
+                 (uint64_t)header->count_modifiers * sizeof(struct drm_format_modifier) <= blob->length;
+    if (!valid) {
+        fprintf(stderr, "Malformed IN_FORMATS blob %u\n", blob_id);
+        drmModeFreePropertyBlob(blob);
+        return false;
+    }
+
+    const uint32_t *formats = (const uint32_t *)((const uint8_t *)blob->data + header->formats_offset);
+    const struct drm_format_modifier *modifiers =
+        (const struct drm_format_modifier *)((const uint8_t *)blob->data + header->modifiers_offset);
+
+    for (uint32_t m = 0; m < header->count_modifiers; m++) {
+        uint64_t mask = modifiers[m].formats;
+        for (uint32_t bit = 0; mask; bit++, mask >>= 1) {
+            uint64_t index = (uint64_t)modifiers[m].offset + bit;
+            if ((mask & 1) && index < header->count_formats) {
+                drm_format_set_add(set, formats[index], modifiers[m].modifier);
+            }
+        }
+    }
+
+    drmModeFreePropertyBlob(blob);
+    return true;
+}
+
+static bool read_plane(int fd, uint32_t plane_id, drm_topology_plane_t *plane) {
+    drmModePlanePtr p = drmModeGetPlane(fd, plane_id);
+    if (!p) {
+        return false;
+    }
+
+    plane->id = p->plane_id;
+    plane->possible_crtcs = p->possible_crtcs;
+    read_props(fd, plane->id, DRM_MODE_OBJECT_PLANE, &plane->props);
+    plane->type = (uint32_t)plane->props.values[DRM_PROP_TYPE];
+
+    // Drivers without modifier support only have the legacy list
+    bool parsed = plane->props.ids[DRM_PROP_IN_FORMATS] &&
+                  parse_in_formats(fd, (uint32_t)plane->props.values[DRM_PROP_IN_FORMATS], &plane->formats);
+    if (!parsed) {
+        for (uint32_t i = 0; i < p->count_formats; i++) {
+            drm_format_set_add(&plane->formats, p->formats[i], DRM_FORMAT_MOD_LINEAR);
+        }
+    }
+
+    drmModeFreePlane(p);
+    return true;
+}
+
+static bool read_crtc(int fd, uint32_t crtc_id, uint32_t index, drm_topology_crtc_t *crtc) {
+    drmModeCrtcPtr c = drmModeGetCrtc(fd, crtc_id);
+    if (!c) {
+        return false;
+    }
+
+    crtc->id = c->crtc_id;
+    crtc->index = index;
+    crtc->buffer_id = c->buffer_id;
+    crtc->x = c->x;
+    crtc->y = c->y;
+    crtc->width = c->width;
+    crtc->height = c->height;
+    crtc->mode_valid = c->mode_valid;
+    crtc->mode = c->mode;
+    drmModeFreeCrtc(c);
+
+    read_props(fd, crtc->id, DRM_MODE_OBJECT_CRTC, &crtc->props);
+    return true;
+}
+
+static bool read_connector(int fd, uint32_t connector_id, drm_topology_connector_t *connector) {
+    // The current state only; a forced probe can take hundreds of ms per connector
+    drmModeConnectorPtr c = drmModeGetConnectorCurrent(fd, connector_id);
+    if (!c) {
+        return false;
+    }
+
+    connector->id = c->connector_id;
+    connector->type = c->connector_type;
+    connector->connection = c->connection;
+    connector->width_mm = c->mmWidth;
+    connector->height_mm = c->mmHeight;
+
+    if (c->count_modes > 0) {
+        connector->modes = malloc(sizeof(drmModeModeInfo) * (size_t)c->count_modes);
+        if (connector->modes) {
+            memcpy(connector->modes, c->modes, sizeof(drmModeModeInfo) * (size_t)c->count_modes);
+            connector->mode_count = (uint32_t)c->count_modes;
+        }
+    }
+
+    for (int i = 0; i < c->count_encoders; i++) {
+        drmModeEncoderPtr encoder = drmModeGetEncoder(fd, c->encoders[i]);
+        if (!encoder) {
+            continue;
+        }
+        connector->possible_crtcs |= encoder->possible_crtcs;
+        if (encoder->encoder_id == c->encoder_id) {
+            connector->crtc_id = encoder->crtc_id;
+        }
+        drmModeFreeEncoder(encoder);
+    }
+    drmModeFreeConnector(c);
+
+    read_props(fd, connector->id, DRM_MODE_OBJECT_CONNECTOR, &connector->props);
+    return true;
+}
+
+bool drm_topology_init(drm_topology_t *topology, int fd) {
+    memset(topology, 0, sizeof(drm_topology_t));
+
+    drmModeResPtr res = drmModeGetResources(fd);
+    if (!res) {
+        perror("Failed to get DRM resources");
+        return false;
+    }
+    drmModePlaneResPtr plane_res = drmModeGetPlaneResources(fd);
+    if (!plane_res) {
+        fprintf(stderr, "Failed to get plane resources\n");
+        drmModeFreeResources(res);
+        return false;
+    }
+
+    topology->connectors = calloc(res->count_connectors ? res->count_connectors : 1, sizeof(drm_topology_connector_t));
+    topology->crtcs = calloc(res->count_crtcs ? res->count_crtcs : 1, sizeof(drm_topology_crtc_t));
+    topology->planes = calloc(plane_res->count_planes ? plane_res->count_planes : 1, sizeof(drm_topology_plane_t));
+    bool result = topology->connectors && topology->crtcs && topology->planes;
+
+    for (int i = 0; result && i < res->count_crtcs; i++) {
+        if (read_crtc(fd, res->crtcs[i], (uint32_t)i, &topology->crtcs[topology->crtc_count])) {
+            topology->crtc_count++;
+        }
+    }
+    for (int i = 0; result && i < res->count_connectors; i++) {
+        if (read_connector(fd, res->connectors[i], &topology->connectors[topology->connector_count])) {
+            topology->connector_count++;
+        }
+    }
+    for (uint32_t i = 0; result && i < plane_res->count_planes; i++) {
+        if (read_plane(fd, plane_res->planes[i], &topology->planes[topology->plane_count])) {
+            topology->plane_count++;
+        }
+    }
+
+    drmModeFreePlaneResources(plane_res);
+    drmModeFreeResources(res);
+
+    if (!result) {
+        fprintf(stderr, "Memory allocation failed\n");
+        drm_topology_free(topology);
+    }
+    return result;
+}
+
+void drm_topology_free(drm_topology_t *topology) {
+    for (uint32_t i = 0; topology->planes && i < topology->plane_count; i++) {
+        drm_format_set_free(&topology->planes[i].formats);
+    }
+    for (uint32_t i = 0; topology->connectors && i < topology->connector_count; i++) {
+        free(topology->connectors[i].modes);
+    }
+    free(topology->planes);
+    free(topology->crtcs);
+    free(topology->connectors);
+    memset(topology, 0, sizeof(drm_topology_t));
+}
+
+drm_topology_crtc_t *drm_topology_find_crtc(drm_topology_t *topology, uint32_t crtc_id) {
+    for (uint32_t i = 0; i < topology->crtc_count; i++) {
+        if (topology->crtcs[i].id == crtc_id) {
+            return &topology->crtcs[i];
+        }
+    }
+    return NULL;
+}
+
+drm_topology_plane_t *drm_topology_find_plane(drm_topology_t *topology, uint32_t plane_id) {
+    for (uint32_t i = 0; i < topology->plane_count; i++) {
+        if (topology->planes[i].id == plane_id) {
+            return &topology->planes[i];
+        }
+    }
+    return NULL;
+}
+
+drm_topology_plane_t *drm_topology_find_plane_for_crtc(drm_topology_t *topology, uint32_t crtc_index, uint32_t type) {
+    for (uint32_t i = 0; i < topology->plane_count; i++) {
+        drm_topology_plane_t *plane = &topology->planes[i];
+        if ((plane->possible_crtcs & (1u << crtc_index)) && plane->type == type) {
+            return plane;
+        }
+    }
+    return NULL;
+}
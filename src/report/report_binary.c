@@ -0,0 +1,458 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "report/report_binary.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Little-endian encoder over a fixed buffer that leaves room for the
+// record header in front; overflow drops the record
+typedef struct {
+    uint8_t data[REPORT_BINARY_RECORD_HEADER_SIZE + REPORT_BINARY_MAX_RECORD];
+    size_t length;
+    bool overflow;
+} record_buffer_t;
+
+static void record_init(record_buffer_t *b) {
+    b->length = REPORT_BINARY_RECORD_HEADER_SIZE;
+    b->overflow = false;
+}
+
+static void put_bytes(record_buffer_t *b, const void *data, size_t length) {
+    if (b->overflow || length > sizeof(b->data) - b->length) {
+        b->overflow = true;
+        return;
+    }
+    memcpy(b->data + b->length, data, length);
+    b->length += length;
+}
+
+static void store_uint(uint8_t *dst, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_uint(record_buffer_t *b, uint64_t value, size_t bytes) {
+    uint8_t le[8];
+    store_uint(le, value, bytes);
+    put_bytes(b, le, bytes);
+}
+
+static void put_u8(record_buffer_t *b, uint8_t value) { put_uint(b, value, 1); }
+static void put_u16(record_buffer_t *b, uint16_t value) { put_uint(b, value, 2); }
+static void put_u32(record_buffer_t *b, uint32_t value) { put_uint(b, value, 4); }
+static void put_u64(record_buffer_t *b, uint64_t value) { put_uint(b, value, 8); }
+
+static void put_f64(record_buffer_t *b, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u64(b, bits);
+}
+
+static void put_str(record_buffer_t *b, const char *s) {
+    size_t length = strlen(s);
+    if (length > UINT16_MAX) {
+        length = UINT16_MAX;
+    }
+    put_u16(b, (uint16_t)length);
+    put_bytes(b, s, length);
+}
+
+// Records go to the writer in one piece, so a flush never splits one
+static void emit_record(report_writer_t *writer, report_record_type_t type, record_buffer_t *b) {
+    if (b->overflow) {
+        fprintf(stderr, "Binary report record %d too large, dropped\n", (int)type);
+        return;
+    }
+
+    store_uint(b->data, (uint64_t)type, 2);
+    store_uint(b->data + 2, 0, 2);
+    store_uint(b->data + 4, b->length - REPORT_BINARY_RECORD_HEADER_SIZE, 4);
+    report_writer_write(writer, (const char *)b->data, b->length);
+}
+
+void report_binary_write_begin(report_writer_t *writer, const test_report_t *report) {
+    uint8_t header[REPORT_BINARY_HEADER_SIZE];
+    memcpy(header, REPORT_BINARY_MAGIC, 4);
+    store_uint(header + 4, REPORT_BINARY_VERSION, 2);
+    store_uint(header + 6, REPORT_BINARY_HEADER_SIZE, 2);
+    report_writer_write(writer, (const char *)header, sizeof(header));
+
+    char device[64] = "";
+    if (gethostname(device, sizeof(device) - 1) != 0) {
+        device[0] = '\0';
+    }
+
+    uint8_t flags = 0;
+    if (report->config.include_timestamp) {
+        flags |= REPORT_SESSION_TIMESTAMPS;
+    }
+    if (report->config.include_performance_metrics) {
+        flags |= REPORT_SESSION_METRICS;
+    }
+
+    record_buffer_t b;
+    record_init(&b);
+    put_u64(&b, (uint64_t)(int64_t)report->start_time);
+    put_u8(&b, flags);
+    put_str(&b, report->title);
+    put_str(&b, report->description);
+    put_str(&b, device);
+    emit_record(writer, REPORT_RECORD_BEGIN, &b);
+}
+
+void report_binary_write_test_result(report_writer_t *writer, const test_result_entry_t *entry) {
+    record_buffer_t b;
+    record_init(&b);
+    put_u8(&b, (uint8_t)entry->subsystem);
+    put_u8(&b, (uint8_t)entry->result);
+    put_u32(&b, entry->duration_ms);
+    put_u64(&b, (uint64_t)(int64_t)entry->timestamp);
+    put_str(&b, entry->test_name);
+    put_str(&b, entry->message);
+    emit_record(writer, REPORT_RECORD_TEST, &b);
+}
+
+void report_binary_write_metric(report_writer_t *writer, const perf_metric_entry_t *metric,
+                                const report_histogram_t *histogram) {
+    uint8_t flags = 0;
+    if (metric->has_distribution) {
+        flags |= REPORT_METRIC_DISTRIBUTION;
+    }
+    if (histogram && histogram->count > 0) {
+        flags |= REPORT_METRIC_HISTOGRAM;
+    }
+
+    // A static buffer would need a lock of its own; the stack is cheaper
+    record_buffer_t b;
+    record_init(&b);
+    put_u8(&b, (uint8_t)metric->type);
+    put_u8(&b, flags);
+    put_f64(&b, metric->value);
+    put_str(&b, metric->metric_name);
+    put_str(&b, metric->units);
+
+    if (flags & REPORT_METRIC_DISTRIBUTION) {
+        const report_distribution_t *d = &metric->distribution;
+        put_u64(&b, d->count);
+        put_f64(&b, d->min);
+        put_f64(&b, d->mean);
+        put_f64(&b, d->p50);
+        put_f64(&b, d->p90);
+        put_f64(&b, d->p99);
+        put_f64(&b, d->p999);
+        put_f64(&b, d->max);
+    }
+
+    // Raw buckets, sparse, so logs from many boards merge exactly
+    if (flags & REPORT_METRIC_HISTOGRAM) {
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < REPORT_HISTOGRAM_BUCKETS; i++) {
+            used += histogram->buckets[i] != 0;
+        }
+        put_u64(&b, histogram->count);
+        put_u64(&b, histogram->min_ns);
+        put_u64(&b, histogram->max_ns);
+        put_f64(&b, histogram->sum_ns);
+        put_u32(&b, used);
+        for (uint32_t i = 0; i < REPORT_HISTOGRAM_BUCKETS; i++) {
+            if (histogram->buckets[i]) {
+                put_u32(&b, i);
+                put_u32(&b, histogram->buckets[i]);
+            }
+        }
+    }
+
+    emit_record(writer, REPORT_RECORD_METRIC, &b);
+}
+
+void report_binary_write_property(report_writer_t *writer, const report_property_entry_t *property) {
+    record_buffer_t b;
+    record_init(&b);
+    put_str(&b, property->name);
+    put_str(&b, property->value);
+    emit_record(writer, REPORT_RECORD_PROPERTY, &b);
+}
+
+void report_binary_write_end(report_writer_t *writer, const test_report_t *report) {
+    record_buffer_t b;
+    record_init(&b);
+    put_u64(&b, (uint64_t)(int64_t)report->end_time);
+    emit_record(writer, REPORT_RECORD_END, &b);
+}
+
+// Bounds-checked little-endian decoder over one record's payload
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+    bool error;
+} record_reader_t;
+
+static uint64_t get_uint(record_reader_t *r, size_t bytes) {
+    if (r->error || bytes > r->length - r->offset) {
+        r->error = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)r->data[r->offset + i] << (8 * i);
+    }
+    r->offset += bytes;
+    return value;
+}
+
+static uint8_t get_u8(record_reader_t *r) { return (uint8_t)get_uint(r, 1); }
+static uint32_t get_u32(record_reader_t *r) { return (uint32_t)get_uint(r, 4); }
+static uint64_t get_u64(record_reader_t *r) { return get_uint(r, 8); }
+
+static double get_f64(record_reader_t *r) {
+    uint64_t bits = get_u64(r);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Copies into dst, truncating to its size
+static void get_str(record_reader_t *r, char *dst, size_t size) {
+    size_t length = (size_t)get_uint(r, 2);
+    if (r->error || length > r->length - r->offset) {
+        r->error = true;
+        dst[0] = '\0';
+        return;
+    }
+    size_t copy = length < size - 1 ? length : size - 1;
+    memcpy(dst, r->data + r->offset, copy);
+    dst[copy] = '\0';
+    r->offset += length;
+}
+
+static bool read_metric(record_reader_t *r, perf_metric_entry_t *metric, report_histogram_t *histogram,
+                        bool *has_histogram) {
+    memset(metric, 0, sizeof(perf_metric_entry_t));
+    metric->type = (metric_type_t)get_u8(r);
+    uint8_t flags = get_u8(r);
+    metric->value = get_f64(r);
+    get_str(r, metric->metric_name, sizeof(metric->metric_name));
+    get_str(r, metric->units, sizeof(metric->units));
+
+    if (flags & REPORT_METRIC_DISTRIBUTION) {
+        report_distribution_t *d = &metric->distribution;
+        metric->has_distribution = true;
+        d->count = get_u64(r);
+        d->min = get_f64(r);
+        d->mean = get_f64(r);
+        d->p50 = get_f64(r);
+        d->p90 = get_f64(r);
+        d->p99 = get_f64(r);
+        d->p999 = get_f64(r);
+        d->max = get_f64(r);
+    }
+
+    *has_histogram = false;
+    if (flags & REPORT_METRIC_HISTOGRAM) {
+        report_histogram_init(histogram);
+        histogram->count = get_u64(r);
+        histogram->min_ns = get_u64(r);
+        histogram->max_ns = get_u64(r);
+        histogram->sum_ns = get_f64(r);
+        uint32_t used = get_u32(r);
+        for (uint32_t i = 0; i < used && !r->error; i++) {
+            uint32_t index = get_u32(r);
+            uint32_t count = get_u32(r);
+            if (index >= REPORT_HISTOGRAM_BUCKETS) {
+                r->error = true;
+                break;
+            }
+            histogram->buckets[index] = count;
+        }
+        *has_histogram = !r->error;
+    }
+
+    return !r->error && metric->type < METRIC_MAX;
+}
+
+static bool read_file(const char *path, uint8_t **data, size_t *length) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    size_t capacity = 1 << 20;
+    size_t used = 0;
+    uint8_t *buffer = malloc(capacity);
+    while (buffer) {
+        used += fread(buffer + used, 1, capacity - used, f);
+        if (used < capacity) {
+            break;
+        }
+        uint8_t *grown = realloc(buffer, capacity * 2);
+        if (!grown) {
+            free(buffer);
+            buffer = NULL;
+            break;
+        }
+        buffer = grown;
+        capacity *= 2;
+    }
+
+    bool result = buffer && !ferror(f);
+    fclose(f);
+    if (!result) {
+        free(buffer);
+        return false;
+    }
+    *data = buffer;
+    *length = used;
+    return true;
+}
+
+bool report_binary_read(const char *path, const report_binary_visitor_t *visitor, void *context) {
+    if (!path || !visitor) {
+        return false;
+    }
+
+    uint8_t *data;
+    size_t length;
+    if (!read_file(path, &data, &length)) {
+        return false;
+    }
+
+    // Big enough for the histogram a metric may carry
+    report_histogram_t *histogram = malloc(sizeof(report_histogram_t));
+    if (!histogram) {
+        free(data);
+        return false;
+    }
+
+    report_session_t session;
+    bool in_session = false;
+    bool result = true;
+    size_t offset = 0;
+
+    while (offset < length) {
+        // A new session header, e.g. from an appended run
+        if (length - offset >= REPORT_BINARY_HEADER_SIZE && memcmp(data + offset, REPORT_BINARY_MAGIC, 4) == 0) {
+            uint16_t version = (uint16_t)(data[offset + 4] | data[offset + 5] << 8);
+            uint16_t header_size = (uint16_t)(data[offset + 6] | data[offset + 7] << 8);
+            if (version != REPORT_BINARY_VERSION || header_size < REPORT_BINARY_HEADER_SIZE) {
+                fprintf(stderr, "%s: unsupported binary report version %u\n", path, version);
+                result = false;
+                break;
+            }
+            if (in_session && visitor->end) {
+                visitor->end(context, &session);
+            }
+            in_session = false;
+            offset += header_size;
+            continue;
+        }
+
+        if (length - offset < REPORT_BINARY_RECORD_HEADER_SIZE) {
+            break;
+        }
+        uint16_t type = (uint16_t)(data[offset] | data[offset + 1] << 8);
+        uint32_t size = (uint32_t)data[offset + 4] | (uint32_t)data[offset + 5] << 8 |
+                        (uint32_t)data[offset + 6] << 16 | (uint32_t)data[offset + 7] << 24;
+        if (size > length - offset - REPORT_BINARY_RECORD_HEADER_SIZE) {
+            // Cut off by a crash; everything before it is good
+            break;
+        }
+
+        record_reader_t r = { data + offset + REPORT_BINARY_RECORD_HEADER_SIZE, size, 0, false };
+        offset += REPORT_BINARY_RECORD_HEADER_SIZE + size;
+
+        if (type == REPORT_RECORD_BEGIN) {
+            memset(&session, 0, sizeof(session));
+            session.start_time = (time_t)(int64_t)get_u64(&r);
+            session.flags = get_u8(&r);
+            get_str(&r, session.title, sizeof(session.title));
+            get_str(&r, session.description, sizeof(session.description));
+            get_str(&r, session.device, sizeof(session.device));
+            in_session = !r.error;
+            if (in_session && visitor->begin) {
+                visitor->begin(context, &session);
+            }
+            continue;
+        }
+
+        if (!in_session) {
+            continue;
+        }
+
+        switch (type) {
+            case REPORT_RECORD_TEST: {
+                test_result_entry_t entry;
+                memset(&entry, 0, sizeof(entry));
+                entry.subsystem = (report_subsystem_t)get_u8(&r);
+                entry.result = (test_result_t)get_u8(&r);
+                entry.duration_ms = get_u32(&r);
+                entry.timestamp = (time_t)(int64_t)get_u64(&r);
+                get_str(&r, entry.test_name, sizeof(entry.test_name));
+                get_str(&r, entry.message, sizeof(entry.message));
+                if (!r.error && entry.subsystem < REPORT_SUBSYSTEM_MAX && entry.result < TEST_RESULT_MAX &&
+                    visitor->test_result) {
+                    visitor->test_result(context, &session, &entry);
+                }
+                break;
+            }
+            case REPORT_RECORD_METRIC: {
+                perf_metric_entry_t metric;
+                bool has_histogram;
+                if (read_metric(&r, &metric, histogram, &has_histogram) && visitor->metric) {
+                    visitor->metric(context, &session, &metric, has_histogram ? histogram : NULL);
+                }
+                break;
+            }
+            case REPORT_RECORD_PROPERTY: {
+                char name[64];
+                char value[256];
+                get_str(&r, name, sizeof(name));
+                get_str(&r, value, sizeof(value));
+                if (!r.error && visitor->property) {
+                    visitor->property(context, &session, name, value);
+                }
+                break;
+            }
+            case REPORT_RECORD_END:
+                session.end_time = (time_t)(int64_t)get_u64(&r);
+                if (visitor->end) {
+                    visitor->end(context, &session);
+                }
+                in_session = false;
+                break;
+            default:
+                // Newer record type; its length lets us step over it
+                break;
+        }
+    }
+
+    // A session the writer never closed still gets its end callback
+    if (in_session && visitor->end) {
+        visitor->end(context, &session);
+    }
+
+    free(histogram);
+    free(data);
+    return result;
+}
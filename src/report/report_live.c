@@ -0,0 +1,699 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "report/report_live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+// Hot loops post events into a bounded multi-producer ring (one sequence
+// number per slot, so producers only contend on the claim counter). The
+// exporter thread is the single consumer: it folds events into per-metric
+// state that nothing else touches, and renders that state on request.
+
+typedef enum {
+    LIVE_EVENT_ADD,
+    LIVE_EVENT_SET,
+    LIVE_EVENT_OBSERVE
+} live_event_op_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t op;
+    union {
+        uint64_t u;
+        double d;
+    } value;
+} live_event_t;
+
+typedef struct {
+    atomic_size_t sequence;
+    live_event_t event;
+} live_slot_t;
+
+typedef struct {
+    char name[64];
+    char labels[96];
+    char help[128];
+    report_live_kind_t kind;
+
+    // Exporter thread only
+    uint64_t counter;
+    double gauge;
+    uint64_t observed_count;
+    uint64_t observed_sum_ns;
+    report_histogram_t *window[2];      // Current and previous quantile windows
+} live_metric_t;
+
+static live_slot_t ring[REPORT_LIVE_RING_SIZE];
+static atomic_size_t ring_head;
+static size_t ring_tail;
+static atomic_uint_fast64_t dropped_events;
+
+static live_metric_t metrics[REPORT_LIVE_MAX_METRICS];
+static atomic_uint metric_count;
+static pthread_mutex_t register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_bool live_running;
+static pthread_t exporter_thread;
+static report_live_config_t live_config;
+static int listen_fd = -1;
+static char unix_path[108];
+static uint64_t start_ns;
+static uint64_t window_start_ns;
+static report_histogram_t scratch;
+
+// Growable render buffer
+typedef struct {
+    char *data;
+    size_t used;
+    size_t size;
+} live_buffer_t;
+
+static void buffer_printf(live_buffer_t *buffer, const char *format, ...) {
+    for (;;) {
+        size_t room = buffer->size - buffer->used;
+        va_list args;
+        va_start(args, format);
+        int length = buffer->data ? vsnprintf(buffer->data + buffer->used, room, format, args) : -1;
+        va_end(args);
+
+        if (length >= 0 && (size_t)length < room) {
+            buffer->used += (size_t)length;
+            return;
+        }
+        if (length < 0 && buffer->data) {
+            return;
+        }
+
+        size_t size = buffer->size ? buffer->size * 2 : 16384;
+        while (length >= 0 && size - buffer->used <= (size_t)length) {
+            size *= 2;
+        }
+        char *data = realloc(buffer->data, size);
+        if (!data) {
+            return;
+        }
+        buffer->data = data;
+        buffer->size = size;
+    }
+}
+
+static bool ring_push(uint32_t id, live_event_op_t op, uint64_t u, double d) {
+    size_t pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    live_slot_t *slot;
+
+    for (;;) {
+        slot = &ring[pos & (REPORT_LIVE_RING_SIZE - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring_head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The exporter is a full ring behind
+            atomic_fetch_add_explicit(&dropped_events, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        }
+    }
+
+    slot->event.id = id;
+    slot->event.op = op;
+    if (op == LIVE_EVENT_SET) {
+        slot->event.value.d = d;
+    } else {
+        slot->event.value.u = u;
+    }
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+static bool ring_pop(live_event_t *event) {
+    live_slot_t *slot = &ring[ring_tail & (REPORT_LIVE_RING_SIZE - 1)];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != ring_tail + 1) {
+        return false;
+    }
+
+    *event = slot->event;
+    atomic_store_explicit(&slot->sequence, ring_tail + REPORT_LIVE_RING_SIZE, memory_order_release);
+    ring_tail++;
+    return true;
+}
+
+static inline bool live_accepts(report_live_id_t id) {
+    return id >= 0 && atomic_load_explicit(&live_running, memory_order_relaxed);
+}
+
+void report_live_add(report_live_id_t id, uint64_t delta) {
+    if (live_accepts(id)) {
+        ring_push((uint32_t)id, LIVE_EVENT_ADD, delta, 0.0);
+    }
+}
+
+void report_live_set(report_live_id_t id, double value) {
+    if (live_accepts(id)) {
+        ring_push((uint32_t)id, LIVE_EVENT_SET, 0, value);
+    }
+}
+
+void report_live_observe_ns(report_live_id_t id, uint64_t ns) {
+    if (live_accepts(id)) {
+        ring_push((uint32_t)id, LIVE_EVENT_OBSERVE, ns, 0.0);
+    }
+}
+
+void report_live_rate_init(report_live_rate_t *rate, report_live_id_t id) {
+    rate->id = id;
+    rate->window_start_ns = 0;
+    rate->events = 0;
+}
+
+void report_live_rate_tick(report_live_rate_t *rate, uint64_t now_ns) {
+    if (rate->id < 0) {
+        return;
+    }
+
+    // The first event opens the window, like the first frame of an FPS count
+    if (rate->window_start_ns == 0) {
+        rate->window_start_ns = now_ns;
+        rate->events = 0;
+        return;
+    }
+
+    rate->events++;
+    uint64_t elapsed = now_ns > rate->window_start_ns ? now_ns - rate->window_start_ns : 0;
+    if (elapsed >= REPORT_LIVE_RATE_WINDOW_NS) {
+        report_live_set(rate->id, (double)rate->events * 1000000000.0 / (double)elapsed);
+        rate->window_start_ns = now_ns;
+        rate->events = 0;
+    }
+}
+
+bool report_live_active(void) {
+    return atomic_load(&live_running);
+}
+
+report_live_id_t report_live_register(const char *name, const char *labels,
+                                      report_live_kind_t kind, const char *help) {
+    if (!name || kind >= REPORT_LIVE_KIND_MAX || !report_live_active()) {
+        return -1;
+    }
+    if (!labels) {
+        labels = "";
+    }
+
+    pthread_mutex_lock(&register_lock);
+
+    unsigned count = atomic_load_explicit(&metric_count, memory_order_relaxed);
+    for (unsigned i = 0; i < count; i++) {
+        if (strcmp(metrics[i].name, name) == 0 && strcmp(metrics[i].labels, labels) == 0) {
+            pthread_mutex_unlock(&register_lock);
+            return metrics[i].kind == kind ? (report_live_id_t)i : -1;
+        }
+    }
+
+    if (count >= REPORT_LIVE_MAX_METRICS) {
+        pthread_mutex_unlock(&register_lock);
+        fprintf(stderr, "Too many live metrics, dropping %s\n", name);
+        return -1;
+    }
+
+    live_metric_t *metric = &metrics[count];
+    memset(metric, 0, sizeof(live_metric_t));
+    snprintf(metric->name, sizeof(metric->name), "%s", name);
+    snprintf(metric->labels, sizeof(metric->labels), "%s", labels);
+    snprintf(metric->help, sizeof(metric->help), "%s", help ? help : "");
+    metric->kind = kind;
+
+    if (kind == REPORT_LIVE_HISTOGRAM) {
+        metric->window[0] = malloc(sizeof(report_histogram_t));
+        metric->window[1] = malloc(sizeof(report_histogram_t));
+        if (!metric->window[0] || !metric->window[1]) {
+            free(metric->window[0]);
+            free(metric->window[1]);
+            pthread_mutex_unlock(&register_lock);
+            return -1;
+        }
+        report_histogram_init(metric->window[0]);
+        report_histogram_init(metric->window[1]);
+    }
+
+    // Publish only once the entry is complete; the exporter reads the count first
+    atomic_store_explicit(&metric_count, count + 1, memory_order_release);
+    pthread_mutex_unlock(&register_lock);
+    return (report_live_id_t)count;
+}
+
+void report_live_label(char *labels, size_t size, const char *name, const char *value) {
+    size_t used = strnlen(labels, size);
+    if (used >= size) {
+        return;
+    }
+    int length = snprintf(labels + used, size - used, "%s%s=\"", used ? "," : "", name);
+    if (length < 0 || (size_t)length >= size - used) {
+        labels[used] = '\0';
+        return;
+    }
+    used += (size_t)length;
+
+    // Leave room for a two-byte escape, the closing quote and the NUL
+    for (const char *c = value ? value : ""; *c && used + 3 < size; c++) {
+        if (*c == '\\' || *c == '"' || *c == '\n') {
+            labels[used++] = '\\';
+            labels[used++] = *c == '\n' ? 'n' : *c;
+        } else {
+            labels[used++] = *c;
+        }
+    }
+    labels[used++] = '"';
+    labels[used] = '\0';
+}
+
+static void drain_events(void) {
+    live_event_t event;
+    unsigned count = atomic_load_explicit(&metric_count, memory_order_acquire);
+
+    while (ring_pop(&event)) {
+        if (event.id >= count) {
+            // Registered after the count was read
+            count = atomic_load_explicit(&metric_count, memory_order_acquire);
+            if (event.id >= count) {
+                continue;
+            }
+        }
+
+        live_metric_t *metric = &metrics[event.id];
+        switch (event.op) {
+            case LIVE_EVENT_ADD:
+                metric->counter += event.value.u;
+                break;
+            case LIVE_EVENT_SET:
+                metric->gauge = event.value.d;
+                break;
+            case LIVE_EVENT_OBSERVE:
+                if (metric->window[0]) {
+                    report_histogram_record(metric->window[0], event.value.u);
+                    metric->observed_count++;
+                    metric->observed_sum_ns += event.value.u;
+                }
+                break;
+        }
+    }
+
+    // Quantiles cover the current window plus the one before it, so they
+    // follow degradation instead of averaging it into the whole run
+    uint64_t now_ns = report_time_now_ns();
+    if (now_ns - window_start_ns >= REPORT_LIVE_QUANTILE_WINDOW_NS) {
+        for (unsigned i = 0; i < count; i++) {
+            live_metric_t *metric = &metrics[i];
+            if (metric->kind == REPORT_LIVE_HISTOGRAM) {
+                report_histogram_t *previous = metric->window[1];
+                metric->window[1] = metric->window[0];
+                metric->window[0] = previous;
+                report_histogram_init(previous);
+            }
+        }
+        window_start_ns = now_ns;
+    }
+}
+
+static const char *kind_to_type(report_live_kind_t kind) {
+    switch (kind) {
+        case REPORT_LIVE_COUNTER: return "counter";
+        case REPORT_LIVE_GAUGE: return "gauge";
+        case REPORT_LIVE_HISTOGRAM: return "summary";
+        default: return "untyped";
+    }
+}
+
+// Label set with an optional extra label appended
+static void format_labels(char *buffer, size_t size, const char *labels, const char *extra) {
+    if (labels[0] && extra) {
+        snprintf(buffer, size, "{%s,%s}", labels, extra);
+    } else if (labels[0] || extra) {
+        snprintf(buffer, size, "{%s}", labels[0] ? labels : extra);
+    } else {
+        buffer[0] = '\0';
+    }
+}
+
+static void render_metric(live_buffer_t *out, const live_metric_t *metric) {
+    char labels[160];
+
+    switch (metric->kind) {
+        case REPORT_LIVE_COUNTER:
+            format_labels(labels, sizeof(labels), metric->labels, NULL);
+            buffer_printf(out, "%s%s %llu\n", metric->name, labels, (unsigned long long)metric->counter);
+            break;
+        case REPORT_LIVE_GAUGE:
+            format_labels(labels, sizeof(labels), metric->labels, NULL);
+            buffer_printf(out, "%s%s %.6g\n", metric->name, labels, metric->gauge);
+            break;
+        case REPORT_LIVE_HISTOGRAM: {
+            static const struct { const char *label; double pct; } quantiles[] = {
+                { "quantile=\"0.5\"", 50.0 },
+                { "quantile=\"0.9\"", 90.0 },
+                { "quantile=\"0.99\"", 99.0 },
+                { "quantile=\"0.999\"", 99.9 },
+                { "quantile=\"1\"", 100.0 },
+            };
+
+            report_histogram_init(&scratch);
+            report_histogram_merge(&scratch, metric->window[0]);
+            report_histogram_merge(&scratch, metric->window[1]);
+            for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+                double seconds = scratch.count ?
+                                 (quantiles[i].pct >= 100.0 ? (double)scratch.max_ns :
+                                  report_histogram_percentile(&scratch, quantiles[i].pct)) / 1e9 : 0.0;
+                format_labels(labels, sizeof(labels), metric->labels, quantiles[i].label);
+                buffer_printf(out, "%s%s %.9g\n", metric->name, labels, seconds);
+            }
+            format_labels(labels, sizeof(labels), metric->labels, NULL);
+            buffer_printf(out, "%s_sum%s %.9g\n", metric->name, labels, (double)metric->observed_sum_ns / 1e9);
+            buffer_printf(out, "%s_count%s %llu\n", metric->name, labels,
+                          (unsigned long long)metric->observed_count);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Prometheus text exposition format 0.0.4
+static void render(live_buffer_t *out) {
+    unsigned count = atomic_load_explicit(&metric_count, memory_order_acquire);
+
+    for (unsigned i = 0; i < count; i++) {
+        // One HELP/TYPE block per name, covering every label set
+        bool seen = false;
+        for (unsigned j = 0; j < i && !seen; j++) {
+            seen = strcmp(metrics[j].name, metrics[i].name) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+
+        if (metrics[i].help[0]) {
+            buffer_printf(out, "# HELP %s %s\n", metrics[i].name, metrics[i].help);
+        }
+        buffer_printf(out, "# TYPE %s %s\n", metrics[i].name, kind_to_type(metrics[i].kind));
+        for (unsigned j = i; j < count; j++) {
+            if (strcmp(metrics[j].name, metrics[i].name) == 0) {
+                render_metric(out, &metrics[j]);
+            }
+        }
+    }
+
+    buffer_printf(out, "# HELP tvts_live_dropped_events_total Metric events lost to a full ring\n");
+    buffer_printf(out, "# TYPE tvts_live_dropped_events_total counter\n");
+    buffer_printf(out, "tvts_live_dropped_events_total %llu\n",
+                  (unsigned long long)atomic_load(&dropped_events));
+    buffer_printf(out, "# HELP tvts_uptime_seconds Time since the live exporter started\n");
+    buffer_printf(out, "# TYPE tvts_uptime_seconds gauge\n");
+    buffer_printf(out, "tvts_uptime_seconds %.3f\n", (double)(report_time_now_ns() - start_ns) / 1e9);
+}
+
+static bool write_snapshot(live_buffer_t *out) {
+    char tmp_path[sizeof(live_config.snapshot_file) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", live_config.snapshot_file);
+
+    // Readers see either the old snapshot or the new one, never a torn file
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to write live snapshot %s: %s\n", tmp_path, strerror(errno));
+        return false;
+    }
+    bool result = fwrite(out->data, 1, out->used, file) == out->used;
+    result = fclose(file) == 0 && result;
+    if (result && rename(tmp_path, live_config.snapshot_file) != 0) {
+        fprintf(stderr, "Failed to replace live snapshot %s: %s\n", live_config.snapshot_file, strerror(errno));
+        result = false;
+    }
+    return result;
+}
+
+static void send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t ret = send(fd, data, length, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return;
+        }
+        data += ret;
+        length -= (size_t)ret;
+    }
+}
+
+static void serve_client(live_buffer_t *out) {
+    int client = accept(listen_fd, NULL, NULL);
+    if (client < 0) {
+        return;
+    }
+
+    // A stuck scraper must not stall draining
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Any request gets the metrics page; read it so the peer sees a clean close
+    char request[1024];
+    ssize_t ret = recv(client, request, sizeof(request), 0);
+    (void)ret;
+
+    char header[160];
+    int length = snprintf(header, sizeof(header),
+                          "HTTP/1.0 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Content-Length: %zu\r\n"
+                          "Connection: close\r\n\r\n", out->used);
+    send_all(client, header, (size_t)length);
+    send_all(client, out->data, out->used);
+    close(client);
+}
+
+static bool open_unix_listener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Live metrics socket path too long: %s\n", path);
+        return false;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        fprintf(stderr, "Failed to create live metrics socket: %s\n", strerror(errno));
+        return false;
+    }
+
+    // A previous run's socket file would make bind fail
+    unlink(path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 4) < 0) {
+        fprintf(stderr, "Failed to listen on %s: %s\n", path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    snprintf(unix_path, sizeof(unix_path), "%s", path);
+    return true;
+}
+
+static bool open_tcp_listener(const char *spec) {
+    char host[128];
+    const char *colon = strrchr(spec, ':');
+    if (!colon || !colon[1]) {
+        fprintf(stderr, "Live metrics address needs a port: %s\n", spec);
+        return false;
+    }
+    snprintf(host, sizeof(host), "%.*s", (int)(colon - spec), spec);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *info = NULL;
+    int ret = getaddrinfo(host[0] ? host : NULL, colon + 1, &hints, &info);
+    if (ret != 0) {
+        fprintf(stderr, "Failed to resolve %s: %s\n", spec, gai_strerror(ret));
+        return false;
+    }
+
+    for (struct addrinfo *ai = info; ai && listen_fd < 0; ai = ai->ai_next) {
+        listen_fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (listen_fd < 0) {
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(listen_fd, ai->ai_addr, ai->ai_addrlen) < 0 || listen(listen_fd, 4) < 0) {
+            close(listen_fd);
+            listen_fd = -1;
+        }
+    }
+    freeaddrinfo(info);
+
+    if (listen_fd < 0) {
+        fprintf(stderr, "Failed to listen on %s: %s\n", spec, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void *exporter_main(void *arg) {
+    (void)arg;
+    live_buffer_t out = { 0 };
+    uint32_t interval_s = live_config.interval_s ? live_config.interval_s : REPORT_LIVE_DEFAULT_INTERVAL;
+    uint64_t next_snapshot_ns = report_time_now_ns() + (uint64_t)interval_s * 1000000000ULL;
+
+    while (atomic_load(&live_running)) {
+        struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+        int ret = poll(&pfd, listen_fd >= 0 ? 1 : 0, REPORT_LIVE_DRAIN_MS);
+
+        drain_events();
+
+        if (ret > 0 && (pfd.revents & POLLIN)) {
+            out.used = 0;
+            render(&out);
+            serve_client(&out);
+        }
+
+        if (live_config.snapshot_file[0] && report_time_now_ns() >= next_snapshot_ns) {
+            out.used = 0;
+            render(&out);
+            write_snapshot(&out);
+            next_snapshot_ns += (uint64_t)interval_s * 1000000000ULL;
+        }
+    }
+
+    // Final state, so the snapshot matches the end of the run
+    drain_events();
+    if (live_config.snapshot_file[0]) {
+        out.used = 0;
+        render(&out);
+        write_snapshot(&out);
+    }
+
+    free(out.data);
+    return NULL;
+}
+
+bool report_live_start(const report_live_config_t *config) {
+    if (!config || (!config->listen[0] && !config->snapshot_file[0])) {
+        return false;
+    }
+    if (report_live_active()) {
+        return true;
+    }
+
+    live_config = *config;
+    listen_fd = -1;
+    unix_path[0] = '\0';
+
+    if (config->listen[0]) {
+        bool listening;
+        if (strncmp(config->listen, "unix:", 5) == 0) {
+            listening = open_unix_listener(config->listen + 5);
+        } else if (config->listen[0] == '/') {
+            listening = open_unix_listener(config->listen);
+        } else {
+            listening = open_tcp_listener(config->listen);
+        }
+        if (!listening) {
+            return false;
+        }
+    }
+
+    // Reset the ring: slot n is free for the producer claiming position n
+    for (size_t i = 0; i < REPORT_LIVE_RING_SIZE; i++) {
+        atomic_init(&ring[i].sequence, i);
+    }
+    atomic_store(&ring_head, 0);
+    ring_tail = 0;
+    atomic_store(&dropped_events, 0);
+
+    // Callers cache their handles across runs, so the registry outlives a
+    // restart; only the values start over
+    unsigned count = atomic_load(&metric_count);
+    for (unsigned i = 0; i < count; i++) {
+        live_metric_t *metric = &metrics[i];
+        metric->counter = 0;
+        metric->gauge = 0.0;
+        metric->observed_count = 0;
+        metric->observed_sum_ns = 0;
+        if (metric->window[0]) {
+            report_histogram_init(metric->window[0]);
+            report_histogram_init(metric->window[1]);
+        }
+    }
+
+    start_ns = report_time_now_ns();
+    window_start_ns = start_ns;
+    atomic_store(&live_running, true);
+
+    if (pthread_create(&exporter_thread, NULL, exporter_main, NULL) != 0) {
+        fprintf(stderr, "Failed to start live metrics exporter\n");
+        atomic_store(&live_running, false);
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            listen_fd = -1;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void report_live_stop(void) {
+    if (!report_live_active()) {
+        return;
+    }
+
+    atomic_store(&live_running, false);
+    pthread_join(exporter_thread, NULL);
+
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    if (unix_path[0]) {
+        unlink(unix_path);
+        unix_path[0] = '\0';
+    }
+}
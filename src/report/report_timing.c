@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "report/report_timing.h"
+#include <string.h>
+#include <time.h>
+
+#define LINEAR_LIMIT (1ull << REPORT_HISTOGRAM_SUB_BITS)
+
+static uint32_t bucket_index(uint64_t value) {
+    if (value < LINEAR_LIMIT) {
+        return (uint32_t)value;
+    }
+    if (value >> REPORT_HISTOGRAM_MAX_BITS) {
+        return REPORT_HISTOGRAM_BUCKETS - 1;
+    }
+
+    // Keep the top SUB_BITS bits; the shift picks the power-of-two group
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t shift = msb - REPORT_HISTOGRAM_SUB_BITS + 1;
+    return shift * REPORT_HISTOGRAM_HALF + (uint32_t)(value >> shift);
+}
+
+// Smallest and largest value that land in a bucket
+static void bucket_range(uint32_t index, uint64_t *low, uint64_t *high) {
+    if (index < LINEAR_LIMIT) {
+        *low = *high = index;
+        return;
+    }
+
+    uint32_t shift = index / REPORT_HISTOGRAM_HALF - 1;
+    uint64_t sub = REPORT_HISTOGRAM_HALF + index % REPORT_HISTOGRAM_HALF;
+    *low = sub << shift;
+    *high = ((sub + 1) << shift) - 1;
+}
+
+void report_histogram_init(report_histogram_t *histogram) {
+    if (!histogram) {
+        return;
+    }
+    memset(histogram, 0, sizeof(report_histogram_t));
+    histogram->min_ns = UINT64_MAX;
+}
+
+void report_histogram_record(report_histogram_t *histogram, uint64_t value_ns) {
+    if (!histogram) {
+        return;
+    }
+
+    histogram->buckets[bucket_index(value_ns)]++;
+    histogram->count++;
+    histogram->sum_ns += (double)value_ns;
+    if (value_ns < histogram->min_ns) {
+        histogram->min_ns = value_ns;
+    }
+    if (value_ns > histogram->max_ns) {
+        histogram->max_ns = value_ns;
+    }
+}
+
+void report_histogram_merge(report_histogram_t *dst, const report_histogram_t *src) {
+    if (!dst || !src || src->count == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < REPORT_HISTOGRAM_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum_ns += src->sum_ns;
+    if (src->min_ns < dst->min_ns) {
+        dst->min_ns = src->min_ns;
+    }
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+}
+
+// Midpoint of the bucket holding the pct'th sample, clamped to what was
+// actually seen so p0 and p100 come out exact
+uint64_t report_histogram_percentile(const report_histogram_t *histogram, double pct) {
+    if (!histogram || histogram->count == 0) {
+        return 0;
+    }
+
+    if (pct <= 0.0) {
+        return histogram->min_ns;
+    }
+    if (pct >= 100.0) {
+        return histogram->max_ns;
+    }
+
+    uint64_t rank = (uint64_t)(pct / 100.0 * histogram->count + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < REPORT_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            uint64_t low, high;
+            bucket_range(i, &low, &high);
+            uint64_t value = low + (high - low) / 2;
+            if (value < histogram->min_ns) {
+                value = histogram->min_ns;
+            }
+            if (value > histogram->max_ns) {
+                value = histogram->max_ns;
+            }
+            return value;
+        }
+    }
+    return histogram->max_ns;
+}
+
+double report_histogram_mean(const report_histogram_t *histogram) {
+    if (!histogram || histogram->count == 0) {
+        return 0.0;
+    }
+    return histogram->sum_ns / histogram->count;
+}
+
+void report_histogram_summarize(const report_histogram_t *histogram, double unit_ns,
+                                report_distribution_t *distribution) {
+    if (!distribution) {
+        return;
+    }
+
+    memset(distribution, 0, sizeof(report_distribution_t));
+    if (!histogram || histogram->count == 0 || unit_ns <= 0.0) {
+        return;
+    }
+
+    distribution->count = histogram->count;
+    distribution->min = histogram->min_ns / unit_ns;
+    distribution->mean = report_histogram_mean(histogram) / unit_ns;
+    distribution->p50 = report_histogram_percentile(histogram, 50.0) / unit_ns;
+    distribution->p90 = report_histogram_percentile(histogram, 90.0) / unit_ns;
+    distribution->p99 = report_histogram_percentile(histogram, 99.0) / unit_ns;
+    distribution->p999 = report_histogram_percentile(histogram, 99.9) / unit_ns;
+    distribution->max = histogram->max_ns / unit_ns;
+}
+
+uint64_t report_time_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+report_timer_t report_timer_begin(void) {
+    report_timer_t timer = { report_time_now_ns(), false };
+    return timer;
+}
+
+uint64_t report_timer_elapsed_ns(const report_timer_t *timer) {
+    return timer ? report_time_now_ns() - timer->start_ns : 0;
+}
+
+uint64_t report_timer_stop(report_timer_t *timer, report_histogram_t *histogram) {
+    if (!timer) {
+        return 0;
+    }
+
+    uint64_t elapsed = report_time_now_ns() - timer->start_ns;
+    timer->done = true;
+    report_histogram_record(histogram, elapsed);
+    return elapsed;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "report/report_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t get_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Writes all of data, retrying short writes and interrupted calls
+static bool write_all(report_writer_t *writer, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t ret = write(writer->fd, data, length);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Report write failed: %s\n", strerror(errno));
+            writer->failed = true;
+            return false;
+        }
+        data += ret;
+        length -= (size_t)ret;
+        writer->bytes_written += (uint64_t)ret;
+    }
+    return true;
+}
+
+bool report_writer_open(report_writer_t *writer, const char *path, bool append) {
+    if (!writer || !path) {
+        return false;
+    }
+
+    memset(writer, 0, sizeof(report_writer_t));
+    writer->buffer = malloc(REPORT_WRITER_BUFFER_SIZE);
+    if (!writer->buffer) {
+        return false;
+    }
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+    writer->fd = open(path, flags, 0644);
+    if (writer->fd < 0) {
+        fprintf(stderr, "Failed to open report file %s: %s\n", path, strerror(errno));
+        free(writer->buffer);
+        writer->buffer = NULL;
+        return false;
+    }
+
+    writer->last_flush_ms = get_monotonic_ms();
+    return true;
+}
+
+bool report_writer_flush(report_writer_t *writer) {
+    if (!writer || writer->fd < 0 || !writer->buffer) {
+        return false;
+    }
+
+    bool result = !writer->failed && write_all(writer, writer->buffer, writer->used);
+    writer->used = 0;
+    writer->last_flush_ms = get_monotonic_ms();
+    return result;
+}
+
+bool report_writer_close(report_writer_t *writer, bool sync) {
+    if (!writer || !writer->buffer) {
+        return false;
+    }
+
+    bool result = report_writer_flush(writer);
+    if (sync && result && fsync(writer->fd) != 0) {
+        result = false;
+    }
+    close(writer->fd);
+    free(writer->buffer);
+    writer->fd = -1;
+    writer->buffer = NULL;
+    return result && !writer->failed;
+}
+
+void report_writer_write(report_writer_t *writer, const char *data, size_t length) {
+    if (!writer || !writer->buffer || writer->failed) {
+        return;
+    }
+
+    if (length > REPORT_WRITER_BUFFER_SIZE - writer->used) {
+        report_writer_flush(writer);
+    }
+
+    // Too big to buffer at all; the ordering is kept since we just flushed
+    if (length > REPORT_WRITER_BUFFER_SIZE) {
+        write_all(writer, data, length);
+        return;
+    }
+
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->used += length;
+}
+
+void report_writer_printf(report_writer_t *writer, const char *format, ...) {
+    if (!writer || !writer->buffer || writer->failed) {
+        return;
+    }
+
+    // Format straight into the buffer; only retry if it did not fit
+    va_list args;
+    size_t space = REPORT_WRITER_BUFFER_SIZE - writer->used;
+    va_start(args, format);
+    int length = vsnprintf(writer->buffer + writer->used, space, format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if ((size_t)length < space) {
+        writer->used += (size_t)length;
+        return;
+    }
+
+    report_writer_flush(writer);
+    if ((size_t)length < REPORT_WRITER_BUFFER_SIZE) {
+        va_start(args, format);
+        vsnprintf(writer->buffer, REPORT_WRITER_BUFFER_SIZE, format, args);
+        va_end(args);
+        writer->used = (size_t)length;
+        return;
+    }
+
+    char *large = malloc((size_t)length + 1);
+    if (!large) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(large, (size_t)length + 1, format, args);
+    va_end(args);
+    write_all(writer, large, (size_t)length);
+    free(large);
+}
+
+void report_writer_puts(report_writer_t *writer, const char *s) {
+    report_writer_write(writer, s, strlen(s));
+}
+
+void report_writer_putc(report_writer_t *writer, char c) {
+    report_writer_write(writer, &c, 1);
+}
+
+void report_writer_json_string(report_writer_t *writer, const char *s) {
+    report_writer_putc(writer, '"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            report_writer_printf(writer, "\\%c", c);
+        } else if (c == '\n') {
+            report_writer_puts(writer, "\\n");
+        } else if (c < 0x20) {
+            report_writer_printf(writer, "\\u%04x", c);
+        } else {
+            report_writer_putc(writer, (char)c);
+        }
+    }
+    report_writer_putc(writer, '"');
+}
+
+void report_writer_xml_string(report_writer_t *writer, const char *s) {
+    for (; *s; s++) {
+        switch (*s) {
+            case '<': report_writer_puts(writer, "&lt;"); break;
+            case '>': report_writer_puts(writer, "&gt;"); break;
+            case '&': report_writer_puts(writer, "&amp;"); break;
+            case '"': report_writer_puts(writer, "&quot;"); break;
+            default: report_writer_putc(writer, *s); break;
+        }
+    }
+}
+
+void report_writer_csv_string(report_writer_t *writer, const char *s) {
+    if (!strpbrk(s, ",\"\n")) {
+        report_writer_puts(writer, s);
+        return;
+    }
+    report_writer_putc(writer, '"');
+    for (; *s; s++) {
+        if (*s == '"') {
+            report_writer_putc(writer, '"');
+        }
+        report_writer_putc(writer, *s);
+    }
+    report_writer_putc(writer, '"');
+}
+
+void report_writer_checkpoint(report_writer_t *writer) {
+    if (!writer || !writer->buffer || writer->used == 0) {
+        return;
+    }
+
+    if (writer->used >= REPORT_WRITER_BUFFER_SIZE / 2 ||
+        get_monotonic_ms() - writer->last_flush_ms >= REPORT_WRITER_FLUSH_MS) {
+        report_writer_flush(writer);
+    }
+}
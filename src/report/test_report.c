@@ -17,13 +17,14 @@
  */
 
 #include "report/test_report.h"
+#include "report/report_binary.h"
+#include "report/report_live.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
-#include <sys/stat.h>
-#include <sys/types.h>
+#include <math.h>
 
 // Helper function implementations
 const char *report_format_to_string(report_format_t format) {
@@ -33,6 +34,7 @@ const char *report_format_to_string(report_format_t format) {
         case REPORT_FORMAT_HTML: return "HTML";
         case REPORT_FORMAT_XML: return "XML";
         case REPORT_FORMAT_CSV: return "CSV";
+        case REPORT_FORMAT_BINARY: return "BINARY";
         default: return "UNKNOWN";
     }
 }
@@ -73,194 +75,418 @@ const char *metric_type_to_string(metric_type_t type) {
         case METRIC_THROUGHPUT: return "THROUGHPUT";
         case METRIC_LATENCY_MS: return "LATENCY_MS";
         case METRIC_FRAME_RATE: return "FRAME_RATE";
+        case METRIC_COUNT: return "COUNT";
         default: return "UNKNOWN";
     }
 }
 
-// Report creation and destruction
-test_report_t *report_create(const char *title, const char *description, const report_config_t *config) {
-    test_report_t *report = (test_report_t *)malloc(sizeof(test_report_t));
-    if (!report) {
-        return NULL;
+// Entries are handed out on max_align_t boundaries from the chunk's tail
+#define ARENA_ALIGN (sizeof(max_align_t))
+#define ARENA_HEADER ((sizeof(report_arena_chunk_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+static bool arena_add_chunk(report_arena_t *arena, size_t min_size) {
+    size_t size = REPORT_ARENA_CHUNK_SIZE - ARENA_HEADER;
+    if (size < min_size) {
+        size = min_size;
     }
-    
-    memset(report, 0, sizeof(test_report_t));
-    
-    if (title) {
-        strncpy(report->title, title, sizeof(report->title) - 1);
+
+    report_arena_chunk_t *chunk = (report_arena_chunk_t *)malloc(ARENA_HEADER + size);
+    if (!chunk) {
+        return false;
+    }
+    chunk->next = arena->current;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->current = chunk;
+    arena->chunks++;
+    return true;
+}
+
+// Zeroed storage that lives until arena_release(); callers hold report->lock
+static void *arena_alloc(report_arena_t *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    report_arena_chunk_t *chunk = arena->current;
+    if (!chunk || chunk->size - chunk->used < size) {
+        if (!arena_add_chunk(arena, size)) {
+            return NULL;
+        }
+        chunk = arena->current;
+    }
+
+    void *ptr = (unsigned char *)chunk + ARENA_HEADER + chunk->used;
+    chunk->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+static void arena_release(report_arena_t *arena) {
+    report_arena_chunk_t *chunk = arena->current;
+    while (chunk) {
+        report_arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->current = NULL;
+    arena->chunks = 0;
+}
+
+static void format_time(time_t t, char *buffer, size_t size) {
+    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", localtime(&t));
+}
+
+// Writes a metric's figures the way the text report shows them
+static void write_metric_text(report_writer_t *w, const perf_metric_entry_t *metric) {
+    if (metric->has_distribution) {
+        const report_distribution_t *d = &metric->distribution;
+        report_writer_printf(w, "%s: n=%llu min %.3f mean %.3f p50 %.3f p90 %.3f p99 %.3f p99.9 %.3f max %.3f %s\n",
+                             metric->metric_name, (unsigned long long)d->count, d->min, d->mean,
+                             d->p50, d->p90, d->p99, d->p999, d->max, metric->units);
     } else {
-        strcpy(report->title, "Vendor Test Suite Report");
+        report_writer_printf(w, "%s = %.2f %s\n", metric->metric_name, metric->value, metric->units);
     }
+}
+
+// Text: one line per result and metric as it happens, environment and
+// summary at the end
+static void text_begin(test_report_t *report) {
+    report_writer_t *w = &report->writer;
+    char time_str[64];
     
-    if (description) {
-        strncpy(report->description, description, sizeof(report->description) - 1);
-    } else {
-        strcpy(report->description, "Automated test results");
+    report_writer_printf(w, "===== %s =====\n", report->title);
+    report_writer_printf(w, "%s\n", report->description);
+    if (report->config.include_timestamp) {
+        format_time(report->start_time, time_str, sizeof(time_str));
+        report_writer_printf(w, "Start Time: %s\n", time_str);
     }
+    report_writer_printf(w, "\n--- Test Log ---\n");
+}
+
+static void text_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    report_writer_printf(&report->writer, "[%s] %s: %s (%u ms) - %s\n",
+                         report_subsystem_to_string(entry->subsystem),
+                         entry->test_name,
+                         test_result_to_string(entry->result),
+                         entry->duration_ms,
+                         entry->message);
+}
+
+static void text_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                        const report_histogram_t *histogram) {
+    report_writer_puts(&report->writer, "METRIC: ");
+    write_metric_text(&report->writer, metric);
+}
+
+static void text_end(test_report_t *report) {
+    report_writer_t *w = &report->writer;
+    char time_str[64];
     
-    if (config) {
-        memcpy(&report->config, config, sizeof(report_config_t));
-    } else {
-        // Default configuration
-        strcpy(report->config.report_file, "test_report.txt");
-        report->config.format = REPORT_FORMAT_TEXT;
-        report->config.append = false;
-        report->config.include_timestamp = true;
-        report->config.include_system_info = true;
-        report->config.include_performance_metrics = true;
-        report->config.min_level = REPORT_LEVEL_INFO;
+    // Run environment
+    if (report->properties) {
+        report_writer_printf(w, "\n--- Environment ---\n");
+        report_property_entry_t *property = report->properties;
+        while (property) {
+            report_writer_printf(w, "%s: %s\n", property->name, property->value);
+            property = property->next;
+        }
     }
     
-    report->start_time = time(NULL);
-    report->test_results = NULL;
-    report->perf_metrics = NULL;
+    // Summary
+    report_writer_printf(w, "\n--- Summary ---\n");
+    report_writer_printf(w, "Total Tests: %u\n", report->total_tests);
+    report_writer_printf(w, "Passed Tests: %u\n", report->passed_tests);
+    report_writer_printf(w, "Failed Tests: %u\n", report->failed_tests);
+    report_writer_printf(w, "Skipped Tests: %u\n", report->skipped_tests);
+    report_writer_printf(w, "Error Tests: %u\n", report->error_tests);
+    if (report->config.include_timestamp) {
+        format_time(report->end_time, time_str, sizeof(time_str));
+        report_writer_printf(w, "End Time: %s\n", time_str);
+    }
+}
+
+// JSON: the records array grows on arrival; a cut-off file is valid up to
+// its last complete line, and the trailer closes it
+static void json_separator(test_report_t *report) {
+    report_writer_puts(&report->writer, report->streamed_records ? ",\n    " : "\n    ");
+}
+
+static void json_begin(test_report_t *report) {
+    report_writer_t *w = &report->writer;
+    char time_str[64];
     
-    // Open report file
-    const char *mode = report->config.append ? "a" : "w";
-    report->report_file = fopen(report->config.report_file, mode);
-    if (!report->report_file) {
-        free(report);
-        return NULL;
+    report_writer_puts(w, "{\n  \"title\": ");
+    report_writer_json_string(w, report->title);
+    report_writer_puts(w, ",\n  \"description\": ");
+    report_writer_json_string(w, report->description);
+    if (report->config.include_timestamp) {
+        format_time(report->start_time, time_str, sizeof(time_str));
+        report_writer_printf(w, ",\n  \"start_time\": \"%s\"", time_str);
     }
+    report_writer_puts(w, ",\n  \"records\": [");
+}
+
+static void json_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    report_writer_t *w = &report->writer;
     
-    return report;
+    json_separator(report);
+    report_writer_printf(w, "{ \"record\": \"test\", \"subsystem\": \"%s\", \"name\": ",
+                         report_subsystem_to_string(entry->subsystem));
+    report_writer_json_string(w, entry->test_name);
+    report_writer_printf(w, ", \"result\": \"%s\", \"duration_ms\": %u, \"message\": ",
+                         test_result_to_string(entry->result), entry->duration_ms);
+    report_writer_json_string(w, entry->message);
+    if (report->config.include_timestamp) {
+        char time_str[64];
+        format_time(entry->timestamp, time_str, sizeof(time_str));
+        report_writer_printf(w, ", \"timestamp\": \"%s\"", time_str);
+    }
+    report_writer_puts(w, " }");
 }
 
-void report_destroy(test_report_t *report) {
-    if (!report) {
-        return;
+// JSON has no NaN or infinity; an empty histogram or a zero-length run
+// would otherwise make the whole file unparseable
+static void json_number(report_writer_t *w, const char *name, double value) {
+    if (isfinite(value)) {
+        report_writer_printf(w, ", \"%s\": %.6g", name, value);
+    } else {
+        report_writer_printf(w, ", \"%s\": null", name);
     }
+}
+
+static void json_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                        const report_histogram_t *histogram) {
+    report_writer_t *w = &report->writer;
     
-    // Close report file
-    if (report->report_file) {
-        fclose(report->report_file);
-        report->report_file = NULL;
+    json_separator(report);
+    report_writer_puts(w, "{ \"record\": \"metric\", \"name\": ");
+    report_writer_json_string(w, metric->metric_name);
+    report_writer_printf(w, ", \"type\": \"%s\"", metric_type_to_string(metric->type));
+    json_number(w, "value", metric->value);
+    report_writer_puts(w, ", \"units\": ");
+    report_writer_json_string(w, metric->units);
+    if (metric->has_distribution) {
+        const report_distribution_t *d = &metric->distribution;
+        report_writer_printf(w, ", \"count\": %llu", (unsigned long long)d->count);
+        json_number(w, "min", d->min);
+        json_number(w, "mean", d->mean);
+        json_number(w, "p50", d->p50);
+        json_number(w, "p90", d->p90);
+        json_number(w, "p99", d->p99);
+        json_number(w, "p99_9", d->p999);
+        json_number(w, "max", d->max);
     }
+    report_writer_puts(w, " }");
+}
+
+static void json_end(test_report_t *report) {
+    report_writer_t *w = &report->writer;
     
-    // Free test result entries
-    test_result_entry_t *result_entry = report->test_results;
-    while (result_entry) {
-        test_result_entry_t *next = result_entry->next;
-        free(result_entry);
-        result_entry = next;
+    report_writer_puts(w, "\n  ],\n  \"environment\": {");
+    report_property_entry_t *property = report->properties;
+    while (property) {
+        report_writer_puts(w, "\n    ");
+        report_writer_json_string(w, property->name);
+        report_writer_puts(w, ": ");
+        report_writer_json_string(w, property->value);
+        property = property->next;
+        report_writer_puts(w, property ? "," : "\n  ");
     }
+    report_writer_puts(w, "},\n");
     
-    // Free performance metric entries
-    perf_metric_entry_t *metric_entry = report->perf_metrics;
-    while (metric_entry) {
-        perf_metric_entry_t *next = metric_entry->next;
-        free(metric_entry);
-        metric_entry = next;
+    report_writer_printf(w, "  \"summary\": { \"total\": %u, \"passed\": %u, \"failed\": %u, \"skipped\": %u, \"errors\": %u }",
+                         report->total_tests, report->passed_tests, report->failed_tests,
+                         report->skipped_tests, report->error_tests);
+    if (report->config.include_timestamp) {
+        char time_str[64];
+        format_time(report->end_time, time_str, sizeof(time_str));
+        report_writer_printf(w, ",\n  \"end_time\": \"%s\"", time_str);
     }
+    report_writer_puts(w, "\n}\n");
+}
+
+// XML: one element per record in arrival order, the totals at the end
+static void xml_begin(test_report_t *report) {
+    report_writer_t *w = &report->writer;
     
-    free(report);
+    report_writer_puts(w, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<report title=\"");
+    report_writer_xml_string(w, report->title);
+    report_writer_puts(w, "\"");
+    if (report->config.include_timestamp) {
+        char time_str[64];
+        format_time(report->start_time, time_str, sizeof(time_str));
+        report_writer_printf(w, " start_time=\"%s\"", time_str);
+    }
+    report_writer_puts(w, ">\n  <description>");
+    report_writer_xml_string(w, report->description);
+    report_writer_puts(w, "</description>\n");
 }
 
-// Test result reporting
-void report_add_test_result(test_report_t *report, const char *test_name, report_subsystem_t subsystem, 
-                            test_result_t result, uint32_t duration_ms, const char *message) {
-    if (!report || !test_name) {
-        return;
+static void xml_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    report_writer_t *w = &report->writer;
+    
+    report_writer_printf(w, "  <test subsystem=\"%s\" name=\"", report_subsystem_to_string(entry->subsystem));
+    report_writer_xml_string(w, entry->test_name);
+    report_writer_printf(w, "\" result=\"%s\" duration_ms=\"%u\"", test_result_to_string(entry->result), entry->duration_ms);
+    if (report->config.include_timestamp) {
+        char time_str[64];
+        format_time(entry->timestamp, time_str, sizeof(time_str));
+        report_writer_printf(w, " timestamp=\"%s\"", time_str);
     }
+    report_writer_puts(w, ">");
+    report_writer_xml_string(w, entry->message);
+    report_writer_puts(w, "</test>\n");
+}
+
+static void xml_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                       const report_histogram_t *histogram) {
+    report_writer_t *w = &report->writer;
     
-    // Update test counters
-    report->total_tests++;
-    switch (result) {
-        case TEST_RESULT_PASS:
-            report->passed_tests++;
-            break;
-        case TEST_RESULT_FAIL:
-            report->failed_tests++;
-            break;
-        case TEST_RESULT_SKIP:
-            report->skipped_tests++;
-            break;
-        case TEST_RESULT_ERROR:
-            report->error_tests++;
-            break;
-        default:
-            break;
+    report_writer_puts(w, "  <metric name=\"");
+    report_writer_xml_string(w, metric->metric_name);
+    report_writer_printf(w, "\" type=\"%s\" value=\"%.6g\" units=\"", metric_type_to_string(metric->type), metric->value);
+    report_writer_xml_string(w, metric->units);
+    report_writer_puts(w, "\"");
+    if (metric->has_distribution) {
+        const report_distribution_t *d = &metric->distribution;
+        report_writer_printf(w, " count=\"%llu\" min=\"%.6g\" mean=\"%.6g\" p50=\"%.6g\" p90=\"%.6g\" "
+                             "p99=\"%.6g\" p99_9=\"%.6g\" max=\"%.6g\"",
+                             (unsigned long long)d->count, d->min, d->mean, d->p50, d->p90, d->p99, d->p999, d->max);
     }
+    report_writer_puts(w, "/>\n");
+}
+
+static void xml_end(test_report_t *report) {
+    report_writer_t *w = &report->writer;
     
-    // Create new test result entry
-    test_result_entry_t *entry = (test_result_entry_t *)malloc(sizeof(test_result_entry_t));
-    if (!entry) {
-        return;
+    report_writer_puts(w, "  <environment>\n");
+    report_property_entry_t *property = report->properties;
+    while (property) {
+        report_writer_puts(w, "    <property name=\"");
+        report_writer_xml_string(w, property->name);
+        report_writer_puts(w, "\" value=\"");
+        report_writer_xml_string(w, property->value);
+        report_writer_puts(w, "\"/>\n");
+        property = property->next;
     }
+    report_writer_puts(w, "  </environment>\n");
     
-    memset(entry, 0, sizeof(test_result_entry_t));
-    strncpy(entry->test_name, test_name, sizeof(entry->test_name) - 1);
-    entry->subsystem = subsystem;
-    entry->result = result;
-    entry->duration_ms = duration_ms;
-    if (message) {
-        strncpy(entry->message, message, sizeof(entry->message) - 1);
+    report_writer_printf(w, "  <summary total=\"%u\" passed=\"%u\" failed=\"%u\" skipped=\"%u\" errors=\"%u\"",
+                         report->total_tests, report->passed_tests, report->failed_tests,
+                         report->skipped_tests, report->error_tests);
+    if (report->config.include_timestamp) {
+        char time_str[64];
+        format_time(report->end_time, time_str, sizeof(time_str));
+        report_writer_printf(w, " end_time=\"%s\"", time_str);
     }
-    entry->timestamp = time(NULL);
-    entry->next = NULL;
+    report_writer_puts(w, "/>\n</report>\n");
+}
+
+// CSV: one table, with the record column saying which fields of a row are
+// meaningful; the environment rows come last
+static void csv_begin(test_report_t *report) {
+    report_writer_puts(&report->writer, "record,subsystem,name,result,duration_ms,type,value,units,"
+                                        "count,min,mean,p50,p90,p99,p99.9,max,message\n");
+}
+
+static void csv_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    report_writer_t *w = &report->writer;
     
-    // Add to linked list
-    if (!report->test_results) {
-        report->test_results = entry;
+    report_writer_printf(w, "test,%s,", report_subsystem_to_string(entry->subsystem));
+    report_writer_csv_string(w, entry->test_name);
+    report_writer_printf(w, ",%s,%u,,,,,,,,,,,,", test_result_to_string(entry->result), entry->duration_ms);
+    report_writer_csv_string(w, entry->message);
+    report_writer_putc(w, '\n');
+}
+
+static void csv_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                       const report_histogram_t *histogram) {
+    report_writer_t *w = &report->writer;
+    
+    report_writer_puts(w, "metric,,");
+    report_writer_csv_string(w, metric->metric_name);
+    report_writer_printf(w, ",,,%s,%.6g,", metric_type_to_string(metric->type), metric->value);
+    report_writer_csv_string(w, metric->units);
+    if (metric->has_distribution) {
+        const report_distribution_t *d = &metric->distribution;
+        report_writer_printf(w, ",%llu,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,\n",
+                             (unsigned long long)d->count, d->min, d->mean, d->p50, d->p90, d->p99, d->p999, d->max);
     } else {
-        test_result_entry_t *tail = report->test_results;
-        while (tail->next) {
-            tail = tail->next;
-        }
-        tail->next = entry;
+        report_writer_puts(w, ",,,,,,,,,\n");
     }
+}
+
+static void csv_end(test_report_t *report) {
+    report_writer_t *w = &report->writer;
     
-    // Write to report file directly if it's text format
-    if (report->config.format == REPORT_FORMAT_TEXT && report->report_file) {
-        fprintf(report->report_file, "[%s] %s: %s (%u ms) - %s\n",
-                report_subsystem_to_string(subsystem),
-                test_name,
-                test_result_to_string(result),
-                duration_ms,
-                message ? message : "");
-        fflush(report->report_file);
+    report_property_entry_t *property = report->properties;
+    while (property) {
+        report_writer_puts(w, "property,,");
+        report_writer_csv_string(w, property->name);
+        report_writer_puts(w, ",,,,,,,,,,,,,,");
+        report_writer_csv_string(w, property->value);
+        report_writer_putc(w, '\n');
+        property = property->next;
     }
 }
 
-// Generate HTML report
-static bool generate_html_report(test_report_t *report) {
-    if (!report || !report->report_file) {
-        return false;
-    }
-    
-    FILE *f = report->report_file;
+// Binary: the record log from report/report_binary.h
+static void binary_begin(test_report_t *report) {
+    report_binary_write_begin(&report->writer, report);
+}
+
+static void binary_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    report_binary_write_test_result(&report->writer, entry);
+}
+
+static void binary_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                          const report_histogram_t *histogram) {
+    report_binary_write_metric(&report->writer, metric, histogram);
+}
+
+static void binary_property(test_report_t *report, const report_property_entry_t *property) {
+    report_binary_write_property(&report->writer, property);
+}
+
+static void binary_end(test_report_t *report) {
+    report_binary_write_end(&report->writer, report);
+}
+
+// HTML is laid out in sections, so it is rendered from the stored entries
+// once, when the report is finalised
+static void html_end(test_report_t *report) {
+    report_writer_t *w = &report->writer;
     
     // HTML header
-    fprintf(f, "<!DOCTYPE html>\n");
-    fprintf(f, "<html lang=\"en\">\n");
-    fprintf(f, "<head>\n");
-    fprintf(f, "  <meta charset=\"UTF-8\">\n");
-    fprintf(f, "  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n");
-    fprintf(f, "  <title>%s</title>\n", report->title);
-    fprintf(f, "  <style>\n");
-    fprintf(f, "    body { font-family: Arial, sans-serif; margin: 0; padding: 20px; }\n");
-    fprintf(f, "    .header { background-color: #f4f4f4; padding: 20px; border-radius: 5px; }\n");
-    fprintf(f, "    .summary { display: flex; margin: 20px 0; }\n");
-    fprintf(f, "    .summary-item { padding: 10px; margin-right: 10px; border-radius: 5px; flex: 1; }\n");
-    fprintf(f, "    .pass { background-color: #dff0d8; }\n");
-    fprintf(f, "    .fail { background-color: #f2dede; }\n");
-    fprintf(f, "    .skip { background-color: #fcf8e3; }\n");
-    fprintf(f, "    .error { background-color: #f2dede; }\n");
-    fprintf(f, "    table { width: 100%%; border-collapse: collapse; }\n");
-    fprintf(f, "    th, td { padding: 10px; text-align: left; border-bottom: 1px solid #ddd; }\n");
-    fprintf(f, "    th { background-color: #f4f4f4; }\n");
-    fprintf(f, "    tr.pass { background-color: #dff0d8; }\n");
-    fprintf(f, "    tr.fail { background-color: #f2dede; }\n");
-    fprintf(f, "    tr.skip { background-color: #fcf8e3; }\n");
-    fprintf(f, "    tr.error { background-color: #f2dede; }\n");
-    fprintf(f, "  </style>\n");
-    fprintf(f, "</head>\n");
-    fprintf(f, "<body>\n");
+    report_writer_printf(w, "<!DOCTYPE html>\n");
+    report_writer_printf(w, "<html lang=\"en\">\n");
+    report_writer_printf(w, "<head>\n");
+    report_writer_printf(w, "  <meta charset=\"UTF-8\">\n");
+    report_writer_printf(w, "  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n");
+    report_writer_printf(w, "  <title>%s</title>\n", report->title);
+    report_writer_printf(w, "  <style>\n");
+    report_writer_printf(w, "    body { font-family: Arial, sans-serif; margin: 0; padding: 20px; }\n");
+    report_writer_printf(w, "    .header { background-color: #f4f4f4; padding: 20px; border-radius: 5px; }\n");
+    report_writer_printf(w, "    .summary { display: flex; margin: 20px 0; }\n");
+    report_writer_printf(w, "    .summary-item { padding: 10px; margin-right: 10px; border-radius: 5px; flex: 1; }\n");
+    report_writer_printf(w, "    .pass { background-color: #dff0d8; }\n");
+    report_writer_printf(w, "    .fail { background-color: #f2dede; }\n");
+    report_writer_printf(w, "    .skip { background-color: #fcf8e3; }\n");
+    report_writer_printf(w, "    .error { background-color: #f2dede; }\n");
+    report_writer_printf(w, "    table { width: 100%%; border-collapse: collapse; }\n");
+    report_writer_printf(w, "    th, td { padding: 10px; text-align: left; border-bottom: 1px solid #ddd; }\n");
+    report_writer_printf(w, "    th { background-color: #f4f4f4; }\n");
+    report_writer_printf(w, "    tr.pass { background-color: #dff0d8; }\n");
+    report_writer_printf(w, "    tr.fail { background-color: #f2dede; }\n");
+    report_writer_printf(w, "    tr.skip { background-color: #fcf8e3; }\n");
+    report_writer_printf(w, "    tr.error { background-color: #f2dede; }\n");
+    report_writer_printf(w, "  </style>\n");
+    report_writer_printf(w, "</head>\n");
+    report_writer_printf(w, "<body>\n");
     
     // Header
-    fprintf(f, "  <div class=\"header\">\n");
-    fprintf(f, "    <h1>%s</h1>\n", report->title);
-    fprintf(f, "    <p>%s</p>\n", report->description);
+    report_writer_printf(w, "  <div class=\"header\">\n");
+    report_writer_printf(w, "    <h1>%s</h1>\n", report->title);
+    report_writer_printf(w, "    <p>%s</p>\n", report->description);
     
     // Timestamp
     if (report->config.include_timestamp) {
@@ -268,48 +494,63 @@ static bool generate_html_report(test_report_t *report) {
         char end_time_str[64];
         strftime(start_time_str, sizeof(start_time_str), "%Y-%m-%d %H:%M:%S", localtime(&report->start_time));
         strftime(end_time_str, sizeof(end_time_str), "%Y-%m-%d %H:%M:%S", localtime(&report->end_time));
-        fprintf(f, "    <p>Start Time: %s</p>\n", start_time_str);
-        fprintf(f, "    <p>End Time: %s</p>\n", end_time_str);
+        report_writer_printf(w, "    <p>Start Time: %s</p>\n", start_time_str);
+        report_writer_printf(w, "    <p>End Time: %s</p>\n", end_time_str);
+    }
+    report_writer_printf(w, "  </div>\n");
+    
+    // Run environment
+    if (report->properties) {
+        report_writer_printf(w, "  <h2>Environment</h2>\n");
+        report_writer_printf(w, "  <table>\n");
+        report_property_entry_t *property = report->properties;
+        while (property) {
+            report_writer_printf(w, "    <tr>\n");
+            report_writer_printf(w, "      <th>%s</th>\n", property->name);
+            report_writer_printf(w, "      <td>%s</td>\n", property->value);
+            report_writer_printf(w, "    </tr>\n");
+            property = property->next;
+        }
+        report_writer_printf(w, "  </table>\n");
     }
-    fprintf(f, "  </div>\n");
     
     // Summary
-    fprintf(f, "  <div class=\"summary\">\n");
-    fprintf(f, "    <div class=\"summary-item pass\">\n");
-    fprintf(f, "      <h2>Passed</h2>\n");
-    fprintf(f, "      <p>%u</p>\n", report->passed_tests);
-    fprintf(f, "    </div>\n");
-    fprintf(f, "    <div class=\"summary-item fail\">\n");
-    fprintf(f, "      <h2>Failed</h2>\n");
-    fprintf(f, "      <p>%u</p>\n", report->failed_tests);
-    fprintf(f, "    </div>\n");
-    fprintf(f, "    <div class=\"summary-item skip\">\n");
-    fprintf(f, "      <h2>Skipped</h2>\n");
-    fprintf(f, "      <p>%u</p>\n", report->skipped_tests);
-    fprintf(f, "    </div>\n");
-    fprintf(f, "    <div class=\"summary-item error\">\n");
-    fprintf(f, "      <h2>Errors</h2>\n");
-    fprintf(f, "      <p>%u</p>\n", report->error_tests);
-    fprintf(f, "    </div>\n");
-    fprintf(f, "    <div class=\"summary-item\">\n");
-    fprintf(f, "      <h2>Total</h2>\n");
-    fprintf(f, "      <p>%u</p>\n", report->total_tests);
-    fprintf(f, "    </div>\n");
-    fprintf(f, "  </div>\n");
+    report_writer_printf(w, "  <div class=\"summary\">\n");
+    report_writer_printf(w, "    <div class=\"summary-item pass\">\n");
+    report_writer_printf(w, "      <h2>Passed</h2>\n");
+    report_writer_printf(w, "      <p>%u</p>\n", report->passed_tests);
+    report_writer_printf(w, "    </div>\n");
+    report_writer_printf(w, "    <div class=\"summary-item fail\">\n");
+    report_writer_printf(w, "      <h2>Failed</h2>\n");
+    report_writer_printf(w, "      <p>%u</p>\n", report->failed_tests);
+    report_writer_printf(w, "    </div>\n");
+    report_writer_printf(w, "    <div class=\"summary-item skip\">\n");
+    report_writer_printf(w, "      <h2>Skipped</h2>\n");
+    report_writer_printf(w, "      <p>%u</p>\n", report->skipped_tests);
+    report_writer_printf(w, "    </div>\n");
+    report_writer_printf(w, "    <div class=\"summary-item error\">\n");
+    report_writer_printf(w, "      <h2>Errors</h2>\n");
+    report_writer_printf(w, "      <p>%u</p>\n", report->error_tests);
+    report_writer_printf(w, "    </div>\n");
+    report_writer_printf(w, "    <div class=\"summary-item\">\n");
+    report_writer_printf(w, "      <h2>Total</h2>\n");
+    report_writer_printf(w, "      <p>%u</p>\n", report->total_tests);
+    report_writer_printf(w, "    </div>\n");
+    report_writer_printf(w, "  </div>\n");
     
     // Test results table
-    fprintf(f, "  <h2>Test Results</h2>\n");
-    fprintf(f, "  <table>\n");
-    fprintf(f, "    <tr>\n");
-    fprintf(f, "      <th>Subsystem</th>\n");
-    fprintf(f, "      <th>Test Name</th>\n");
-    fprintf(f, "      <th>Result</th>\n");
-    fprintf(f, "      <th>Duration (ms)</th>\n");
-    fprintf(f, "      <th>Message</th>\n");
+    report_writer_printf(w, "  <h2>Test Results</h2>\n");
+    report_writer_printf(w, "  <table>\n");
+    report_writer_printf(w, "    <tr>\n");
+    report_writer_printf(w, "      <th>Subsystem</th>\n");
+    report_writer_printf(w, "      <th>Test Name</th>\n");
+    report_writer_printf(w, "      <th>Result</th>\n");
+    report_writer_printf(w, "      <th>Duration (ms)</th>\n");
+    report_writer_printf(w, "      <th>Message</th>\n");
     if (report->config.include_timestamp) {
-        fprintf(f, "      <th>Timestamp</th>\n");
+        report_writer_printf(w, "      <th>Timestamp</th>\n");
     }
-    fprintf(f, "    </tr>\n");
+    report_writer_printf(w, "    </tr>\n");
     
     // Add test results
     test_result_entry_t *entry = report->test_results;
@@ -323,78 +564,309 @@ static bool generate_html_report(test_report_t *report) {
             default: strcpy(result_class, ""); break;
         }
         
-        fprintf(f, "    <tr class=\"%s\">\n", result_class);
-        fprintf(f, "      <td>%s</td>\n", report_subsystem_to_string(entry->subsystem));
-        fprintf(f, "      <td>%s</td>\n", entry->test_name);
-        fprintf(f, "      <td>%s</td>\n", test_result_to_string(entry->result));
-        fprintf(f, "      <td>%u</td>\n", entry->duration_ms);
-        fprintf(f, "      <td>%s</td>\n", entry->message);
+        report_writer_printf(w, "    <tr class=\"%s\">\n", result_class);
+        report_writer_printf(w, "      <td>%s</td>\n", report_subsystem_to_string(entry->subsystem));
+        report_writer_printf(w, "      <td>%s</td>\n", entry->test_name);
+        report_writer_printf(w, "      <td>%s</td>\n", test_result_to_string(entry->result));
+        report_writer_printf(w, "      <td>%u</td>\n", entry->duration_ms);
+        report_writer_printf(w, "      <td>%s</td>\n", entry->message);
         
         if (report->config.include_timestamp) {
             char time_str[64];
             strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&entry->timestamp));
-            fprintf(f, "      <td>%s</td>\n", time_str);
+            report_writer_printf(w, "      <td>%s</td>\n", time_str);
         }
         
-        fprintf(f, "    </tr>\n");
+        report_writer_printf(w, "    </tr>\n");
         entry = entry->next;
     }
     
-    fprintf(f, "  </table>\n");
+    report_writer_printf(w, "  </table>\n");
     
     // Performance metrics
     if (report->config.include_performance_metrics && report->perf_metrics) {
-        fprintf(f, "  <h2>Performance Metrics</h2>\n");
-        fprintf(f, "  <table>\n");
-        fprintf(f, "    <tr>\n");
-        fprintf(f, "      <th>Metric</th>\n");
-        fprintf(f, "      <th>Type</th>\n");
-        fprintf(f, "      <th>Value</th>\n");
-        fprintf(f, "      <th>Units</th>\n");
-        fprintf(f, "    </tr>\n");
+        report_writer_printf(w, "  <h2>Performance Metrics</h2>\n");
+        report_writer_printf(w, "  <table>\n");
+        report_writer_printf(w, "    <tr>\n");
+        report_writer_printf(w, "      <th>Metric</th>\n");
+        report_writer_printf(w, "      <th>Type</th>\n");
+        report_writer_printf(w, "      <th>Value</th>\n");
+        report_writer_printf(w, "      <th>Units</th>\n");
+        report_writer_printf(w, "      <th>Samples</th>\n");
+        report_writer_printf(w, "      <th>Min</th>\n");
+        report_writer_printf(w, "      <th>P50</th>\n");
+        report_writer_printf(w, "      <th>P90</th>\n");
+        report_writer_printf(w, "      <th>P99</th>\n");
+        report_writer_printf(w, "      <th>P99.9</th>\n");
+        report_writer_printf(w, "      <th>Max</th>\n");
+        report_writer_printf(w, "    </tr>\n");
         
         perf_metric_entry_t *metric = report->perf_metrics;
         while (metric) {
-            fprintf(f, "    <tr>\n");
-            fprintf(f, "      <td>%s</td>\n", metric->metric_name);
-            fprintf(f, "      <td>%s</td>\n", metric_type_to_string(metric->type));
-            fprintf(f, "      <td>%.2f</td>\n", metric->value);
-            fprintf(f, "      <td>%s</td>\n", metric->units);
-            fprintf(f, "    </tr>\n");
+            report_writer_printf(w, "    <tr>\n");
+            report_writer_printf(w, "      <td>%s</td>\n", metric->metric_name);
+            report_writer_printf(w, "      <td>%s</td>\n", metric_type_to_string(metric->type));
+            report_writer_printf(w, "      <td>%.2f</td>\n", metric->value);
+            report_writer_printf(w, "      <td>%s</td>\n", metric->units);
+            if (metric->has_distribution) {
+                const report_distribution_t *d = &metric->distribution;
+                report_writer_printf(w, "      <td>%llu</td>\n", (unsigned long long)d->count);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->min);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->p50);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->p90);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->p99);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->p999);
+                report_writer_printf(w, "      <td>%.3f</td>\n", d->max);
+            } else {
+                report_writer_printf(w, "      <td colspan=\"7\"></td>\n");
+            }
+            report_writer_printf(w, "    </tr>\n");
             
             metric = metric->next;
         }
         
-        fprintf(f, "  </table>\n");
+        report_writer_printf(w, "  </table>\n");
     }
     
     // Footer
-    fprintf(f, "  <div class=\"footer\">\n");
-    fprintf(f, "    <p>Generated by Tizen Vendor Test Suite</p>\n");
-    fprintf(f, "  </div>\n");
-    fprintf(f, "</body>\n");
-    fprintf(f, "</html>\n");
+    report_writer_printf(w, "  <div class=\"footer\">\n");
+    report_writer_printf(w, "    <p>Generated by Tizen Vendor Test Suite</p>\n");
+    report_writer_printf(w, "  </div>\n");
+    report_writer_printf(w, "</body>\n");
+    report_writer_printf(w, "</html>\n");
+}
+
+// Serialisation for each report_format_t; unset hooks write nothing
+typedef struct {
+    void (*begin)(test_report_t *report);
+    void (*test_result)(test_report_t *report, const test_result_entry_t *entry);
+    void (*metric)(test_report_t *report, const perf_metric_entry_t *metric,
+                   const report_histogram_t *histogram);
+    void (*property)(test_report_t *report, const report_property_entry_t *property);
+    void (*end)(test_report_t *report);
+} report_formatter_t;
+
+static const report_formatter_t formatters[REPORT_FORMAT_MAX] = {
+    [REPORT_FORMAT_TEXT] = { text_begin, text_test_result, text_metric, NULL, text_end },
+    [REPORT_FORMAT_JSON] = { json_begin, json_test_result, json_metric, NULL, json_end },
+    [REPORT_FORMAT_HTML] = { NULL, NULL, NULL, NULL, html_end },
+    [REPORT_FORMAT_XML] = { xml_begin, xml_test_result, xml_metric, NULL, xml_end },
+    [REPORT_FORMAT_CSV] = { csv_begin, csv_test_result, csv_metric, NULL, csv_end },
+    [REPORT_FORMAT_BINARY] = { binary_begin, binary_test_result, binary_metric, binary_property, binary_end },
+};
+
+static const report_formatter_t *get_formatter(const test_report_t *report) {
+    report_format_t format = report->config.format;
+    return &formatters[format < REPORT_FORMAT_MAX ? format : REPORT_FORMAT_TEXT];
+}
+
+// True when a streamed record should be written; callers hold report->lock
+static bool report_streaming(const test_report_t *report) {
+    return report->writer_open && !report->finalized;
+}
+
+// Report creation and destruction
+test_report_t *report_create(const char *title, const char *description, const report_config_t *config) {
+    return report_create_at(title, description, config, time(NULL));
+}
+
+test_report_t *report_create_at(const char *title, const char *description, const report_config_t *config,
+                                time_t start_time) {
+    test_report_t *report = (test_report_t *)malloc(sizeof(test_report_t));
+    if (!report) {
+        return NULL;
+    }
     
-    return true;
+    memset(report, 0, sizeof(test_report_t));
+    
+    if (title) {
+        strncpy(report->title, title, sizeof(report->title) - 1);
+    } else {
+        strcpy(report->title, "Vendor Test Suite Report");
+    }
+    
+    if (description) {
+        strncpy(report->description, description, sizeof(report->description) - 1);
+    } else {
+        strcpy(report->description, "Automated test results");
+    }
+    
+    if (config) {
+        memcpy(&report->config, config, sizeof(report_config_t));
+    } else {
+        // Default configuration
+        strcpy(report->config.report_file, "test_report.txt");
+        report->config.format = REPORT_FORMAT_TEXT;
+        report->config.append = false;
+        report->config.include_timestamp = true;
+        report->config.include_system_info = true;
+        report->config.include_performance_metrics = true;
+        report->config.min_level = REPORT_LEVEL_INFO;
+    }
+    
+    report->start_time = start_time;
+    report->test_results = NULL;
+    report->perf_metrics = NULL;
+    
+    // The first chunk up front, so early entries never wait on malloc()
+    if (!arena_add_chunk(&report->arena, 0)) {
+        free(report);
+        return NULL;
+    }
+    
+    // Open report file
+    if (!report_writer_open(&report->writer, report->config.report_file, report->config.append)) {
+        arena_release(&report->arena);
+        free(report);
+        return NULL;
+    }
+    report->writer_open = true;
+    
+    pthread_mutex_init(&report->lock, NULL);
+    
+    // The header goes out now so even a run that dies at once leaves a file
+    const report_formatter_t *formatter = get_formatter(report);
+    if (formatter->begin) {
+        formatter->begin(report);
+    }
+    report_writer_flush(&report->writer);
+    
+    return report;
+}
+
+void report_destroy(test_report_t *report) {
+    if (!report) {
+        return;
+    }
+    
+    // Without report_generate() the file keeps whatever was streamed, just
+    // as it would after a crash
+    if (report->writer_open) {
+        report_writer_close(&report->writer, false);
+        report->writer_open = false;
+    }
+    
+    // Every entry lives in the arena
+    arena_release(&report->arena);
+    report->test_results = NULL;
+    report->test_results_tail = NULL;
+    report->perf_metrics = NULL;
+    report->perf_metrics_tail = NULL;
+    report->properties = NULL;
+    
+    pthread_mutex_destroy(&report->lock);
+    free(report);
+}
+
+// Test result reporting
+static void add_test_entry(test_report_t *report, const char *test_name, report_subsystem_t subsystem,
+                           test_result_t result, uint32_t duration_ms, const char *message, time_t timestamp) {
+    if (!report || !test_name) {
+        return;
+    }
+    
+    pthread_mutex_lock(&report->lock);
+    
+    // Create new test result entry
+    test_result_entry_t *entry = (test_result_entry_t *)arena_alloc(&report->arena, sizeof(test_result_entry_t));
+    if (!entry) {
+        pthread_mutex_unlock(&report->lock);
+        return;
+    }
+    
+    strncpy(entry->test_name, test_name, sizeof(entry->test_name) - 1);
+    entry->subsystem = subsystem;
+    entry->result = result;
+    entry->duration_ms = duration_ms;
+    if (message) {
+        strncpy(entry->message, message, sizeof(entry->message) - 1);
+    }
+    entry->timestamp = timestamp;
+    entry->next = NULL;
+    
+    // Update test counters
+    report->total_tests++;
+    switch (result) {
+        case TEST_RESULT_PASS:
+            report->passed_tests++;
+            break;
+        case TEST_RESULT_FAIL:
+            report->failed_tests++;
+            break;
+        case TEST_RESULT_SKIP:
+            report->skipped_tests++;
+            break;
+        case TEST_RESULT_ERROR:
+            report->error_tests++;
+            break;
+        default:
+            break;
+    }
+    
+    // Add to linked list
+    if (report->test_results_tail) {
+        report->test_results_tail->next = entry;
+    } else {
+        report->test_results = entry;
+    }
+    report->test_results_tail = entry;
+    
+    // Serialise once, now
+    const report_formatter_t *formatter = get_formatter(report);
+    if (report_streaming(report) && formatter->test_result) {
+        formatter->test_result(report, entry);
+        report->streamed_records++;
+        report_writer_checkpoint(&report->writer);
+    }
+    
+    pthread_mutex_unlock(&report->lock);
+}
+
+void report_add_test_result(test_report_t *report, const char *test_name, report_subsystem_t subsystem, 
+                            test_result_t result, uint32_t duration_ms, const char *message) {
+    add_test_entry(report, test_name, subsystem, result, duration_ms, message, time(NULL));
+
+    if (report && test_name && report_live_active()) {
+        char labels[64];
+        snprintf(labels, sizeof(labels), "subsystem=\"%s\",result=\"%s\"",
+                 report_subsystem_to_string(subsystem), test_result_to_string(result));
+        report_live_add(report_live_register("tvts_tests_total", labels, REPORT_LIVE_COUNTER,
+                                             "Test results recorded so far"), 1);
+    }
+}
+
+void report_import_test_result(test_report_t *report, const test_result_entry_t *entry) {
+    if (!entry) {
+        return;
+    }
+    add_test_entry(report, entry->test_name, entry->subsystem, entry->result, entry->duration_ms,
+                   entry->message, entry->timestamp);
 }
 
 // Performance metric reporting
-void report_add_metric(test_report_t *report, const char *metric_name, metric_type_t type, 
-                      double value, const char *units) {
+static void add_metric_entry(test_report_t *report, const char *metric_name, metric_type_t type,
+                             double value, const char *units, const report_distribution_t *distribution,
+                             const report_histogram_t *histogram) {
     if (!report || !metric_name) {
         return;
     }
     
+    pthread_mutex_lock(&report->lock);
+    
     // Create new performance metric entry
-    perf_metric_entry_t *entry = (perf_metric_entry_t *)malloc(sizeof(perf_metric_entry_t));
+    perf_metric_entry_t *entry = (perf_metric_entry_t *)arena_alloc(&report->arena, sizeof(perf_metric_entry_t));
     if (!entry) {
+        pthread_mutex_unlock(&report->lock);
         return;
     }
     
-    memset(entry, 0, sizeof(perf_metric_entry_t));
     strncpy(entry->metric_name, metric_name, sizeof(entry->metric_name) - 1);
     entry->type = type;
     entry->value = value;
+    if (distribution) {
+        entry->has_distribution = true;
+        entry->distribution = *distribution;
+    }
     if (units) {
         strncpy(entry->units, units, sizeof(entry->units) - 1);
     } else {
@@ -411,6 +883,9 @@ void report_add_metric(test_report_t *report, const char *metric_name, metric_ty
             case METRIC_FRAME_RATE:
                 strcpy(entry->units, "fps");
                 break;
+            case METRIC_COUNT:
+                strcpy(entry->units, "count");
+                break;
             default:
                 strcpy(entry->units, "");
                 break;
@@ -419,22 +894,55 @@ void report_add_metric(test_report_t *report, const char *metric_name, metric_ty
     entry->next = NULL;
     
     // Add to linked list
-    if (!report->perf_metrics) {
-        report->perf_metrics = entry;
+    if (report->perf_metrics_tail) {
+        report->perf_metrics_tail->next = entry;
     } else {
-        perf_metric_entry_t *tail = report->perf_metrics;
-        while (tail->next) {
-            tail = tail->next;
-        }
-        tail->next = entry;
+        report->perf_metrics = entry;
+    }
+    report->perf_metrics_tail = entry;
+    
+    // Serialise once, now
+    const report_formatter_t *formatter = get_formatter(report);
+    if (report_streaming(report) && formatter->metric && report->config.include_performance_metrics) {
+        formatter->metric(report, entry, histogram);
+        report->streamed_records++;
+        report_writer_checkpoint(&report->writer);
     }
     
-    // Write to report file directly if it's text format
-    if (report->config.format == REPORT_FORMAT_TEXT && report->report_file) {
-        fprintf(report->report_file, "METRIC: %s = %.2f %s\n",
-                metric_name, value, entry->units);
-        fflush(report->report_file);
+    pthread_mutex_unlock(&report->lock);
+}
+
+void report_add_metric(test_report_t *report, const char *metric_name, metric_type_t type, 
+                      double value, const char *units) {
+    add_metric_entry(report, metric_name, type, value, units, NULL, NULL);
+}
+
+void report_add_distribution_metric(test_report_t *report, const char *metric_name, metric_type_t type,
+                                    const report_distribution_t *distribution, const char *units) {
+    if (!distribution || distribution->count == 0) {
+        return;
+    }
+    add_metric_entry(report, metric_name, type, distribution->mean, units, distribution, NULL);
+}
+
+// Timings are recorded in nanoseconds and reported in microseconds
+void report_add_histogram_metric(test_report_t *report, const char *metric_name,
+                                 const report_histogram_t *histogram) {
+    report_distribution_t distribution;
+    report_histogram_summarize(histogram, REPORT_HISTOGRAM_UNIT_NS, &distribution);
+    if (distribution.count == 0) {
+        return;
     }
+    add_metric_entry(report, metric_name, METRIC_TIME_US, distribution.mean, "µs", &distribution, histogram);
+}
+
+void report_import_metric(test_report_t *report, const perf_metric_entry_t *metric,
+                          const report_histogram_t *histogram) {
+    if (!metric) {
+        return;
+    }
+    add_metric_entry(report, metric->metric_name, metric->type, metric->value, metric->units,
+                     metric->has_distribution ? &metric->distribution : NULL, histogram);
 }
 
 // Convenience functions for specific metric types
@@ -454,91 +962,82 @@ void report_add_frame_rate_metric(test_report_t *report, const char *metric_name
     report_add_metric(report, metric_name, METRIC_FRAME_RATE, fps, "fps");
 }
 
-// Report generation
+void report_add_count_metric(test_report_t *report, const char *metric_name, uint64_t count) {
+    report_add_metric(report, metric_name, METRIC_COUNT, (double)count, "count");
+}
+
+// Run environment
+void report_set_property(test_report_t *report, const char *name, const char *value) {
+    if (!report || !name || !value) {
+        return;
+    }
+    
+    pthread_mutex_lock(&report->lock);
+    
+    report_property_entry_t *entry = report->properties;
+    report_property_entry_t *tail = NULL;
+    while (entry && strcmp(entry->name, name) != 0) {
+        tail = entry;
+        entry = entry->next;
+    }
+    
+    if (!entry) {
+        entry = (report_property_entry_t *)arena_alloc(&report->arena, sizeof(report_property_entry_t));
+        if (!entry) {
+            pthread_mutex_unlock(&report->lock);
+            return;
+        }
+        strncpy(entry->name, name, sizeof(entry->name) - 1);
+        
+        // Add to linked list
+        if (tail) {
+            tail->next = entry;
+        } else {
+            report->properties = entry;
+        }
+    }
+    
+    memset(entry->value, 0, sizeof(entry->value));
+    strncpy(entry->value, value, sizeof(entry->value) - 1);
+    
+    const report_formatter_t *formatter = get_formatter(report);
+    if (report_streaming(report) && formatter->property) {
+        formatter->property(report, entry);
+        report_writer_checkpoint(&report->writer);
+    }
+    
+    pthread_mutex_unlock(&report->lock);
+}
+
+// Report generation: writes the trailer and makes the file durable. The
+// entries were serialised as they arrived, so this is cheap.
 bool report_generate(test_report_t *report) {
     if (!report) {
         return false;
     }
     
-    // Update end time
-    report->end_time = time(NULL);
-    
-    // Generate report based on format
-    bool result = false;
+    pthread_mutex_lock(&report->lock);
     
-    // Close and reopen file if needed
-    if (report->report_file) {
-        fclose(report->report_file);
-        report->report_file = NULL;
+    if (!report->writer_open) {
+        pthread_mutex_unlock(&report->lock);
+        return report->finalized;
     }
     
-    const char *mode = "w";
-    report->report_file = fopen(report->config.report_file, mode);
-    if (!report->report_file) {
-        return false;
+    // Update end time
+    if (report->end_time == 0) {
+        report->end_time = time(NULL);
     }
     
-    switch (report->config.format) {
-        case REPORT_FORMAT_TEXT:
-            // Simple text format
-            fprintf(report->report_file, "===== %s =====\n", report->title);
-            fprintf(report->report_file, "%s\n\n", report->description);
-            
-            // Summary
-            fprintf(report->report_file, "--- Summary ---\n");
-            fprintf(report->report_file, "Total Tests: %u\n", report->total_tests);
-            fprintf(report->report_file, "Passed Tests: %u\n", report->passed_tests);
-            fprintf(report->report_file, "Failed Tests: %u\n", report->failed_tests);
-            fprintf(report->report_file, "Skipped Tests: %u\n", report->skipped_tests);
-            fprintf(report->report_file, "Error Tests: %u\n\n", report->error_tests);
-            
-            // Test results
-            fprintf(report->report_file, "--- Test Results ---\n");
-            test_result_entry_t *entry = report->test_results;
-            while (entry) {
-                fprintf(report->report_file, "[%s] %s: %s (%u ms) - %s\n",
-                        report_subsystem_to_string(entry->subsystem),
-                        entry->test_name,
-                        test_result_to_string(entry->result),
-                        entry->duration_ms,
-                        entry->message);
-                entry = entry->next;
-            }
-            
-            // Performance metrics
-            if (report->config.include_performance_metrics && report->perf_metrics) {
-                fprintf(report->report_file, "\n--- Performance Metrics ---\n");
-                perf_metric_entry_t *metric = report->perf_metrics;
-                while (metric) {
-                    fprintf(report->report_file, "%s = %.2f %s\n",
-                            metric->metric_name, metric->value, metric->units);
-                    metric = metric->next;
-                }
-            }
-            
-            result = true;
-            break;
-            
-        case REPORT_FORMAT_JSON:
-            // TODO: Implement JSON format
-            break;
-            
-        case REPORT_FORMAT_HTML:
-            result = generate_html_report(report);
-            break;
-            
-        case REPORT_FORMAT_XML:
-            // TODO: Implement XML format
-            break;
-            
-        case REPORT_FORMAT_CSV:
-            // TODO: Implement CSV format
-            break;
-            
-        default:
-            break;
+    const report_formatter_t *formatter = get_formatter(report);
+    if (formatter->end) {
+        formatter->end(report);
     }
+    report->finalized = true;
+    
+    bool result = report_writer_close(&report->writer, true);
+    report->writer_open = false;
     
+    pthread_mutex_unlock(&report->lock);
     return result;
 }
 
@@ -548,6 +1047,8 @@ void report_print_summary(test_report_t *report, FILE *output) {
         return;
     }
     
+    pthread_mutex_lock(&report->lock);
+    
     fprintf(output, "===== Test Summary =====\n");
     fprintf(output, "Total Tests: %u\n", report->total_tests);
     fprintf(output, "Passed Tests: %u (%.1f%%)\n", 
@@ -573,6 +1074,8 @@ void report_print_summary(test_report_t *report, FILE *output) {
             entry = entry->next;
         }
     }
+    
+    pthread_mutex_unlock(&report->lock);
 }
 
 // Generate summary report
@@ -582,7 +1085,7 @@ bool report_generate_summary(test_report_t *report) {
     }
     
     // Create summary file
-    char summary_file[260];
+    char summary_file[sizeof(report->config.report_file) + sizeof(".summary")];
     snprintf(summary_file, sizeof(summary_file), "%s.summary", report->config.report_file);
     
     FILE *f = fopen(summary_file, "w");
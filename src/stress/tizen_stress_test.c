@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "stress/tizen_stress_test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "common/worker_pool.h"
+
+// One workload as handed to a thread
+typedef struct {
+    const stress_config_t *config;
+    stress_workload_t workload;
+    stress_run_t *run;
+} workload_arg_t;
+
+static uint64_t get_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool run_workload(void *arg) {
+    workload_arg_t *w = arg;
+    const stress_config_t *config = w->config;
+    stress_run_t *run = w->run;
+    uint64_t start = get_monotonic_ms();
+
+    memset(run, 0, sizeof(stress_run_t));
+
+    switch (w->workload) {
+        case STRESS_WORKLOAD_SCANOUT: {
+            // The flip benchmark counts frames, so size it to the phase
+            uint32_t frames = config->duration * drm_get_refresh_rate();
+            run->passed = test_page_flip_throughput(&config->scanout, STRESS_FLIP_RING_SIZE, frames, &run->flip);
+            break;
+        }
+        case STRESS_WORKLOAD_CAPTURE: {
+            video_test_config_t capture = config->capture;
+            capture.duration = config->duration;
+            run->passed = test_video_stream(config->video_device, &capture, &run->video);
+            break;
+        }
+        case STRESS_WORKLOAD_PLAYBACK: {
+            audio_test_config_t playback = config->playback;
+            playback.duration = config->duration;
+            run->passed = test_audio_stream(config->audio_device, AUDIO_DEVICE_PLAYBACK, &playback, &run->audio);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    run->ran = true;
+    run->duration_ms = (uint32_t)(get_monotonic_ms() - start);
+    return run->passed;
+}
+
+// Every workload streams on a thread of its own, scheduled as requested
+static bool run_workload_thread(void *arg) {
+    workload_arg_t *w = arg;
+    if (w->config->rt) {
+        return rt_thread_run(w->config->rt, run_workload, w, NULL);
+    }
+    return run_workload(w);
+}
+
+static double percent_drop(double alone, double combined) {
+    return alone > 0.0 ? (alone - combined) * 100.0 / alone : 0.0;
+}
+
+static double rate_per_second(uint32_t count, uint32_t duration_ms) {
+    return duration_ms ? (double)count * 1000.0 / duration_ms : 0.0;
+}
+
+static void compute_degradation(stress_stats_t *stats) {
+    stress_degradation_t *d = &stats->degradation;
+    const stress_run_t *alone = stats->alone;
+    const stress_run_t *combined = stats->combined;
+
+    memset(d, 0, sizeof(stress_degradation_t));
+
+    if (alone[STRESS_WORKLOAD_SCANOUT].ran && combined[STRESS_WORKLOAD_SCANOUT].ran) {
+        const drm_flip_stats_t *a = &alone[STRESS_WORKLOAD_SCANOUT].flip;
+        const drm_flip_stats_t *c = &combined[STRESS_WORKLOAD_SCANOUT].flip;
+        d->flip_fps_drop_pct = percent_drop(a->fps, c->fps);
+        d->flip_p99_increase_ms = c->latency_p99_ms - a->latency_p99_ms;
+        d->flip_max_increase_ms = c->latency_max_ms - a->latency_max_ms;
+    }
+
+    if (alone[STRESS_WORKLOAD_CAPTURE].ran && combined[STRESS_WORKLOAD_CAPTURE].ran) {
+        const stress_run_t *a = &alone[STRESS_WORKLOAD_CAPTURE];
+        const stress_run_t *c = &combined[STRESS_WORKLOAD_CAPTURE];
+        d->capture_fps_drop_pct = percent_drop(a->video.avg_fps, c->video.avg_fps);
+        d->capture_drop_rate_alone = rate_per_second(a->video.dropped_frames, a->duration_ms);
+        d->capture_drop_rate_combined = rate_per_second(c->video.dropped_frames, c->duration_ms);
+    }
+
+    if (alone[STRESS_WORKLOAD_PLAYBACK].ran && combined[STRESS_WORKLOAD_PLAYBACK].ran) {
+        const stress_run_t *a = &alone[STRESS_WORKLOAD_PLAYBACK];
+        const stress_run_t *c = &combined[STRESS_WORKLOAD_PLAYBACK];
+        d->playback_xrun_rate_alone = rate_per_second(a->audio.xruns, a->duration_ms) * 60.0;
+        d->playback_xrun_rate_combined = rate_per_second(c->audio.xruns, c->duration_ms) * 60.0;
+        d->playback_wakeup_increase_ms = c->audio.max_wakeup_ms - a->audio.max_wakeup_ms;
+    }
+}
+
+bool test_concurrent_stress(const stress_config_t *config, stress_stats_t *stats) {
+    if (!config || !stats || config->duration == 0) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(stress_stats_t));
+
+    uint32_t workloads = config->workloads & STRESS_WORKLOAD_ALL;
+    if (workloads == 0) {
+        return false;
+    }
+
+    if ((workloads & STRESS_WORKLOAD_BIT(STRESS_WORKLOAD_SCANOUT)) && drm_get_refresh_rate() == 0) {
+        fprintf(stderr, "Scanout stress needs an initialised DRM test framework\n");
+        return false;
+    }
+
+    bool result = true;
+    bool video = workloads & STRESS_WORKLOAD_BIT(STRESS_WORKLOAD_CAPTURE);
+    bool audio = workloads & STRESS_WORKLOAD_BIT(STRESS_WORKLOAD_PLAYBACK);
+    if (video && !init_video_test_framework()) {
+        fprintf(stderr, "Capture stress needs the video test framework\n");
+        return false;
+    }
+    if (audio && !init_audio_test_framework()) {
+        fprintf(stderr, "Playback stress needs the audio test framework\n");
+        if (video) {
+            cleanup_video_test_framework();
+        }
+        return false;
+    }
+
+    workload_arg_t args[STRESS_WORKLOAD_MAX];
+    worker_job_t jobs[STRESS_WORKLOAD_MAX];
+    uint32_t count = 0;
+
+    // Baseline: each workload with the machine to itself
+    for (int i = 0; i < STRESS_WORKLOAD_MAX; i++) {
+        if (!(workloads & STRESS_WORKLOAD_BIT(i))) {
+            continue;
+        }
+        workload_arg_t alone = { config, (stress_workload_t)i, &stats->alone[i] };
+        if (!run_workload_thread(&alone)) {
+            fprintf(stderr, "Stress baseline failed: %s\n", stress_workload_to_string((stress_workload_t)i));
+            result = false;
+        }
+    }
+
+    // Contended: every workload at once, each on its own worker, so they
+    // fight over memory bandwidth and CPU rather than over a device
+    for (int i = 0; i < STRESS_WORKLOAD_MAX; i++) {
+        if (!(workloads & STRESS_WORKLOAD_BIT(i))) {
+            continue;
+        }
+        args[count] = (workload_arg_t){ config, (stress_workload_t)i, &stats->combined[i] };
+        worker_job_init(&jobs[count], stress_workload_to_string((stress_workload_t)i), run_workload_thread, &args[count]);
+        worker_job_add_resource(&jobs[count], stress_workload_to_string((stress_workload_t)i));
+        count++;
+    }
+
+    if (!worker_pool_run(jobs, count, count)) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (!jobs[i].result) {
+                fprintf(stderr, "Stress workload failed under contention: %s\n", jobs[i].name);
+            }
+        }
+        result = false;
+    }
+
+    compute_degradation(stats);
+
+    if (audio) {
+        cleanup_audio_test_framework();
+    }
+    if (video) {
+        cleanup_video_test_framework();
+    }
+
+    return result;
+}
+
+const char *stress_workload_to_string(stress_workload_t workload) {
+    switch (workload) {
+        case STRESS_WORKLOAD_SCANOUT: return "scanout";
+        case STRESS_WORKLOAD_CAPTURE: return "capture";
+        case STRESS_WORKLOAD_PLAYBACK: return "playback";
+        default: return "unknown";
+    }
+}
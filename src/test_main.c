@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <time.h>
@@ -26,10 +27,30 @@
 
 // Include subsystem headers
 #include "tizen_drm_test.h"
+#include "drm/drm_buffer_pool.h"
+#include "drm/drm_device.h"
 #include "audio/tizen_audio_test.h"
+#include "audio/audio_stream.h"
+#include "audio/audio_convert.h"
 #include "video/tizen_video_test.h"
+#include "video/video_stream.h"
+#include "video/video_zero_copy.h"
+#include "video/video_convert.h"
+#include "video/video_codec.h"
+#include "video/video_m2m.h"
 #include "usb/tizen_usb_test.h"
+#include "usb/usb_storage.h"
+#include "usb/usb_transfer.h"
+#include "usb/usb_discovery.h"
+#include "stress/tizen_stress_test.h"
 #include "report/test_report.h"
+#include "report/report_live.h"
+#include "common/rt_thread.h"
+#include "common/worker_pool.h"
+#include "common/test_pattern.h"
+#include "common/sweep.h"
+#include "common/cap_cache.h"
+#include "common/trace.h"
 
 // Subsystem types
 typedef enum {
@@ -37,6 +58,7 @@ typedef enum {
     SUBSYSTEM_AUDIO,
     SUBSYSTEM_VIDEO,
     SUBSYSTEM_USB,
+    SUBSYSTEM_STRESS,               // Not part of "all"; needs every device at once
     SUBSYSTEM_ALL
 } subsystem_type_t;
 
@@ -49,7 +71,10 @@ typedef struct {
     uint32_t width;
     uint32_t height;
     uint32_t sample_rate;
+    uint32_t period_size;
+    uint32_t periods;
     uint32_t iterations;
+    uint32_t duration;
     bool verbose;
     bool help;
     
@@ -59,11 +84,33 @@ typedef struct {
     bool report_append;
     bool no_report;
     
+    // Live metrics options
+    report_live_config_t live;
+    
+    // Streaming thread options
+    rt_config_t rt;
+    
+    // Scheduling options
+    uint32_t jobs;
+    bool all_devices;
+    const char *cap_cache;
+    
+    // Trace options
+    const char *record_file;
+    const char *replay_file;
+    trace_speed_t replay_speed;
+    
+    // Video test options
+    const char *video_input;
+    
     // USB test options
     const char *usb_device_path;
     const char *usb_test_device_class;
     uint16_t usb_vendor_id;
     uint16_t usb_product_id;
+    uint32_t usb_block_size;
+    uint32_t usb_queue_depth;
+    const usb_device_entry_t *usb_device; // The --all-devices job's device, else NULL
 } cmd_options_t;
 
 // Global report handle
@@ -78,6 +125,12 @@ void print_test_result(const char *test_name, int result) {
         printf("\033[31mFAIL\033[0m\n");
     }
     
+    uint64_t start = trace_begin();
+    if (start) {
+        uint64_t args[] = { result != 0 };
+        trace_record(TRACE_OP_RESULT, start, args, TRACE_ARGC(args), test_name, strlen(test_name));
+    }
+    
     // Add to report if available
     if (g_report) {
         report_add_test_result(g_report, test_name, REPORT_SUBSYSTEM_DRM, 
@@ -86,13 +139,126 @@ void print_test_result(const char *test_name, int result) {
     }
 }
 
-// Function to print performance metrics
-void print_performance_metrics(const char *test_name, uint32_t time_us) {
-    printf("%s Performance: %u microseconds\n", test_name, time_us);
+// Function to print performance metrics from per-iteration timings
+void print_performance_metrics(const char *test_name, const report_histogram_t *histogram) {
+    report_distribution_t us;
+    report_histogram_summarize(histogram, REPORT_HISTOGRAM_UNIT_NS, &us);
+    printf("%s Performance: %llu samples, min %.3f mean %.3f p50 %.3f p90 %.3f p99 %.3f p99.9 %.3f max %.3f us\n",
+           test_name, (unsigned long long)us.count, us.min, us.mean, us.p50, us.p90, us.p99, us.p999, us.max);
     
     // Add to report if available
     if (g_report) {
-        report_add_time_metric(g_report, test_name, (double)time_us);
+        report_add_histogram_metric(g_report, test_name, histogram);
+    }
+}
+
+// CPU access rates through a mapping; a low ratio to cached memory points
+// at a driver mapping the buffer write-combined or uncached
+void print_bandwidth_metrics(const char *test_name, const map_bandwidth_t *bandwidth) {
+    printf("%s Bandwidth: read %.1f MB/s (%.2fx cached), write %.1f MB/s, memcpy %.1f MB/s%s\n",
+           test_name, bandwidth->read_bps / 1e6, bandwidth->cached_ratio, bandwidth->write_bps / 1e6,
+           bandwidth->copy_bps / 1e6, bandwidth->synced ? "" : " (unsynced)");
+
+    if (g_report) {
+        char metric[128];
+        snprintf(metric, sizeof(metric), "%s Read Bandwidth", test_name);
+        report_add_throughput_metric(g_report, metric, bandwidth->read_bps);
+        snprintf(metric, sizeof(metric), "%s Write Bandwidth", test_name);
+        report_add_throughput_metric(g_report, metric, bandwidth->write_bps);
+        snprintf(metric, sizeof(metric), "%s memcpy Bandwidth", test_name);
+        report_add_throughput_metric(g_report, metric, bandwidth->copy_bps);
+        snprintf(metric, sizeof(metric), "%s Read vs Cached (%%)", test_name);
+        report_add_metric(g_report, metric, METRIC_COUNT, bandwidth->cached_ratio * 100.0, "%");
+    }
+}
+
+// Function to print reference vs hardware conversion results
+void print_convert_metrics(const char *test_name, const video_convert_stats_t *stats) {
+    printf("%s: reference %.1f Mpix/s (%s, %u workers), round trip %.2f dB",
+           test_name, stats->cpu_mpix_per_sec, pattern_isa_to_string(stats->isa), stats->threads,
+           stats->reference_psnr_db);
+    if (stats->hardware) {
+        printf("; hardware %.1f Mpix/s (%.2fx), %.2f dB vs reference\n", stats->hw_mpix_per_sec,
+               stats->cpu_mpix_per_sec > 0.0 ? stats->hw_mpix_per_sec / stats->cpu_mpix_per_sec : 0.0,
+               stats->hw_psnr_db);
+    } else {
+        printf("; no hardware path\n");
+    }
+
+    if (g_report && stats->cpu_frames > 0) {
+        char metric[160];
+        snprintf(metric, sizeof(metric), "%s Reference", test_name);
+        report_add_metric(g_report, metric, METRIC_COUNT, stats->cpu_mpix_per_sec, "Mpix/s");
+        if (isfinite(stats->reference_psnr_db)) {
+            snprintf(metric, sizeof(metric), "%s Round Trip PSNR", test_name);
+            report_add_metric(g_report, metric, METRIC_COUNT, stats->reference_psnr_db, "dB");
+        }
+        if (stats->hardware) {
+            snprintf(metric, sizeof(metric), "%s Hardware", test_name);
+            report_add_metric(g_report, metric, METRIC_COUNT, stats->hw_mpix_per_sec, "Mpix/s");
+            if (isfinite(stats->hw_psnr_db)) {
+                snprintf(metric, sizeof(metric), "%s Hardware PSNR", test_name);
+                report_add_metric(g_report, metric, METRIC_COUNT, stats->hw_psnr_db, "dB");
+            }
+        }
+    }
+}
+
+// Function to print encoder/decoder throughput, latency and bitrate
+void print_codec_metrics(const char *test_name, const video_codec_stats_t *stats) {
+    report_distribution_t ms;
+    report_histogram_summarize(&stats->latency, 1e6, &ms);
+    printf("%s: /dev/video%u %ux%u, %u frames over %u+%u buffers, %.2f FPS, latency p50 %.2f p99 %.2f max %.2f ms, "
+           "%.0f kbit/s", test_name, stats->device_index, stats->width, stats->height, stats->frames,
+           stats->output_buffers, stats->capture_buffers, stats->fps, ms.p50, ms.p99, ms.max, stats->bitrate / 1e3);
+    if (stats->target_bitrate > 0) {
+        printf(" (%+.1f%% of target), %u keyframes", stats->bitrate_error * 100.0, stats->keyframes);
+    }
+    printf("%s\n", stats->errors ? ", with errors" : "");
+
+    if (g_report && stats->frames > 0) {
+        char metric[160];
+        snprintf(metric, sizeof(metric), "%s FPS", test_name);
+        report_add_frame_rate_metric(g_report, metric, stats->fps);
+        snprintf(metric, sizeof(metric), "%s Latency", test_name);
+        report_add_histogram_metric(g_report, metric, &stats->latency);
+        snprintf(metric, sizeof(metric), "%s Bitrate", test_name);
+        report_add_metric(g_report, metric, METRIC_COUNT, stats->bitrate / 1e3, "kbit/s");
+        if (stats->target_bitrate > 0) {
+            snprintf(metric, sizeof(metric), "%s Bitrate Error", test_name);
+            report_add_metric(g_report, metric, METRIC_COUNT, stats->bitrate_error * 100.0, "%");
+        }
+        snprintf(metric, sizeof(metric), "%s Errors", test_name);
+        report_add_count_metric(g_report, metric, stats->errors);
+    }
+}
+
+// Function to print PCM sample conversion throughput and accuracy
+void print_audio_convert_metrics(const char *test_name, const audio_convert_stats_t *stats) {
+    printf("%s: %.1f Msamples/s (%s), round trip within %.3f LSB\n", test_name, stats->msamples_per_sec,
+           pattern_isa_to_string(stats->isa), stats->max_error_lsb);
+
+    if (g_report && stats->samples > 0) {
+        char metric[160];
+        snprintf(metric, sizeof(metric), "%s Throughput", test_name);
+        report_add_metric(g_report, metric, METRIC_COUNT, stats->msamples_per_sec, "Msamples/s");
+    }
+}
+
+// Function to print resampler throughput and quality
+void print_resample_metrics(const char *test_name, const audio_resample_stats_t *stats) {
+    printf("%s: %u channels, %u phases x %u taps, %.2f Mframes/s (%s), %.0fx realtime, THD+N %.1f dB\n",
+           test_name, stats->channels, stats->phases, stats->taps, stats->mframes_per_sec,
+           pattern_isa_to_string(stats->isa), stats->realtime_factor, stats->thd_n_db);
+
+    if (g_report && stats->frames > 0) {
+        char metric[160];
+        snprintf(metric, sizeof(metric), "%s Realtime Factor", test_name);
+        report_add_metric(g_report, metric, METRIC_COUNT, stats->realtime_factor, "x");
+        if (isfinite(stats->thd_n_db)) {
+            snprintf(metric, sizeof(metric), "%s THD+N", test_name);
+            report_add_metric(g_report, metric, METRIC_COUNT, stats->thd_n_db, "dB");
+        }
     }
 }
 
@@ -111,28 +277,62 @@ void print_video_metrics(const char *test_name, uint32_t fps) {
     printf("%s Frame Rate: %u FPS\n", test_name, fps);
 }
 
+// Function to get a printable subsystem name
+const char *get_subsystem_name(subsystem_type_t subsystem) {
+    switch (subsystem) {
+        case SUBSYSTEM_DRM: return "DRM";
+        case SUBSYSTEM_AUDIO: return "Audio";
+        case SUBSYSTEM_VIDEO: return "Video";
+        case SUBSYSTEM_USB: return "USB";
+        case SUBSYSTEM_STRESS: return "Stress";
+        case SUBSYSTEM_ALL: return "All";
+        default: return "Unknown";
+    }
+}
+
 // Function to print usage information
 void print_usage(const char *program_name) {
     printf("Usage: %s [options]\n", program_name);
     printf("Options:\n");
-    printf("  -s, --subsystem=SUBSYSTEM   Subsystem to test (drm, audio, video, usb, all)\n");
+    printf("  -s, --subsystem=SUBSYSTEM   Subsystem to test (drm, audio, video, usb, stress, all)\n");
     printf("  -t, --test=TEST_NAME       Specific test to run\n");
     printf("  -d, --device=INDEX         Device index to test\n");
     printf("  -w, --width=WIDTH          Width for video/DRM tests\n");
     printf("  -h, --height=HEIGHT        Height for video/DRM tests\n");
     printf("  -r, --rate=SAMPLE_RATE     Sample rate for audio tests\n");
+    printf("  --period-size=FRAMES       ALSA period size for audio tests\n");
+    printf("  --periods=COUNT            ALSA periods per buffer for audio tests\n");
     printf("  -i, --iterations=COUNT     Number of test iterations\n");
+    printf("  --duration=SECONDS         Length of each stress phase (default %d)\n", STRESS_DEFAULT_DURATION);
     printf("  -v, --verbose              Enable verbose output\n");
-    printf("  --report-format=FORMAT     Report format (text, json, html, xml, csv)\n");
+    printf("  -j, --jobs=COUNT           Run independent subsystems/devices on COUNT workers (0: one per CPU)\n");
+    printf("  --all-devices              Test every enumerated audio/video device, not just --device\n");
+    printf("  --cap-cache=FILE           Reuse audio/video capabilities probed by earlier runs\n");
+    printf("  --record=FILE              Record every device operation of the run as a trace\n");
+    printf("  --replay=FILE              Replay a recorded trace instead of running the tests\n");
+    printf("  --replay-speed=SPEED       Replay at the recorded pace or back to back (recorded, max)\n");
+    printf("  --video-input=FILE         H.264/H.265 Annex B or VP8/VP9 IVF stream for the decode test\n");
+    printf("  --report-format=FORMAT     Report format (text, json, html, xml, csv, binary)\n");
     printf("  --report-file=FILE         Report file path\n");
     printf("  --report-append            Append to existing report file\n");
     printf("  --no-report                Disable report generation\n");
+    printf("  --live-metrics=ADDR        Serve Prometheus metrics while running (unix:PATH, HOST:PORT or :PORT)\n");
+    printf("  --live-snapshot=FILE       Rewrite FILE with the current metrics every interval\n");
+    printf("  --live-interval=SECONDS    Snapshot interval (default %d)\n", REPORT_LIVE_DEFAULT_INTERVAL);
+    printf("  --rt-policy=POLICY         Run streaming loops on a thread with this policy (fifo, rr, other)\n");
+    printf("  --rt-priority=PRIORITY     Priority for fifo/rr streaming threads (default %d)\n", RT_DEFAULT_PRIORITY);
+    printf("  --cpus=LIST                Pin streaming threads to these CPUs (e.g. 2-3)\n");
+    printf("  --mlock                    Lock memory and pre-fault streaming thread stacks\n");
     printf("  --help                     Show this help message\n\n");
     printf("USB Test Options:\n");
-    printf("  --usb-device-path PATH     Path to USB device (default: /dev/sda)\n");
+    printf("  --usb-device-path PATH     Path to USB disk (default: the discovered storage device's)\n");
     printf("  --usb-test-device-class CLASS  Test specific USB device class (msc, hid, audio, wireless)\n");
     printf("  --usb-vendor-id ID         Filter by USB vendor ID (hex)\n");
     printf("  --usb-product-id ID        Filter by USB product ID (hex)\n");
+    printf("  --usb-block-size BYTES     Request size for the mass storage benchmark (default %d)\n",
+           USB_STORAGE_DEFAULT_BLOCK_SIZE);
+    printf("  --usb-queue-depth COUNT    Requests in flight per device or endpoint (default %d)\n",
+           USB_STORAGE_DEFAULT_QUEUE_DEPTH);
 }
 
 // Function to parse command line options
@@ -144,16 +344,35 @@ cmd_options_t parse_options(int argc, char *argv[]) {
         .width = 1280,
         .height = 720,
         .sample_rate = 44100,
+        .period_size = 0,
+        .periods = 0,
         .iterations = 1,
+        .duration = STRESS_DEFAULT_DURATION,
         .verbose = false,
         .help = false,
         .report_format = REPORT_FORMAT_TEXT,
         .report_append = false,
         .no_report = false,
-        .usb_device_path = "/dev/sda",
+        .rt = {
+            .policy = RT_POLICY_OTHER,
+            .priority = RT_DEFAULT_PRIORITY,
+            .cpu_mask = 0,
+            .lock_memory = false
+        },
+        .jobs = 1,
+        .all_devices = false,
+        .cap_cache = NULL,
+        .record_file = NULL,
+        .replay_file = NULL,
+        .replay_speed = TRACE_SPEED_RECORDED,
+        .video_input = NULL,
+        .usb_device_path = NULL,
         .usb_test_device_class = NULL,
         .usb_vendor_id = 0,
-        .usb_product_id = 0
+        .usb_product_id = 0,
+        .usb_block_size = USB_STORAGE_DEFAULT_BLOCK_SIZE,
+        .usb_queue_depth = USB_STORAGE_DEFAULT_QUEUE_DEPTH,
+        .usb_device = NULL
     };
     
     // Set default report file
@@ -167,23 +386,42 @@ cmd_options_t parse_options(int argc, char *argv[]) {
         {"height", required_argument, 0, 'h'},
         {"rate", required_argument, 0, 'r'},
         {"iterations", required_argument, 0, 'i'},
+        {"duration", required_argument, 0, 0},
         {"verbose", no_argument, 0, 'v'},
+        {"jobs", required_argument, 0, 'j'},
+        {"all-devices", no_argument, 0, 0},
+        {"cap-cache", required_argument, 0, 0},
+        {"record", required_argument, 0, 0},
+        {"replay", required_argument, 0, 0},
+        {"replay-speed", required_argument, 0, 0},
+        {"video-input", required_argument, 0, 0},
+        {"period-size", required_argument, 0, 0},
+        {"periods", required_argument, 0, 0},
         {"report-format", required_argument, 0, 0},
         {"report-file", required_argument, 0, 0},
         {"report-append", no_argument, 0, 0},
         {"no-report", no_argument, 0, 0},
+        {"live-metrics", required_argument, 0, 0},
+        {"live-snapshot", required_argument, 0, 0},
+        {"live-interval", required_argument, 0, 0},
         {"help", no_argument, 0, 0},
+        {"rt-policy", required_argument, 0, 0},
+        {"rt-priority", required_argument, 0, 0},
+        {"cpus", required_argument, 0, 0},
+        {"mlock", no_argument, 0, 0},
         {"usb-device-path", required_argument, 0, 0},
         {"usb-test-device-class", required_argument, 0, 0},
         {"usb-vendor-id", required_argument, 0, 0},
         {"usb-product-id", required_argument, 0, 0},
+        {"usb-block-size", required_argument, 0, 0},
+        {"usb-queue-depth", required_argument, 0, 0},
         {0, 0, 0, 0}
     };
 
     int option_index = 0;
     int c;
 
-    while ((c = getopt_long(argc, argv, "s:t:d:w:h:r:i:v", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "s:t:d:w:h:r:i:j:v", long_options, &option_index)) != -1) {
         switch (c) {
             case 0:
                 if (strcmp(long_options[option_index].name, "help") == 0) {
@@ -199,15 +437,59 @@ cmd_options_t parse_options(int argc, char *argv[]) {
                         options.report_format = REPORT_FORMAT_XML;
                     } else if (strcmp(optarg, "csv") == 0) {
                         options.report_format = REPORT_FORMAT_CSV;
+                    } else if (strcmp(optarg, "binary") == 0) {
+                        options.report_format = REPORT_FORMAT_BINARY;
                     } else {
                         fprintf(stderr, "Unknown report format: %s\n", optarg);
                     }
+                } else if (strcmp(long_options[option_index].name, "duration") == 0) {
+                    options.duration = atoi(optarg);
+                } else if (strcmp(long_options[option_index].name, "period-size") == 0) {
+                    options.period_size = atoi(optarg);
+                } else if (strcmp(long_options[option_index].name, "periods") == 0) {
+                    options.periods = atoi(optarg);
                 } else if (strcmp(long_options[option_index].name, "report-file") == 0) {
                     strncpy(options.report_file, optarg, sizeof(options.report_file) - 1);
                 } else if (strcmp(long_options[option_index].name, "report-append") == 0) {
                     options.report_append = true;
                 } else if (strcmp(long_options[option_index].name, "no-report") == 0) {
                     options.no_report = true;
+                } else if (strcmp(long_options[option_index].name, "live-metrics") == 0) {
+                    strncpy(options.live.listen, optarg, sizeof(options.live.listen) - 1);
+                } else if (strcmp(long_options[option_index].name, "live-snapshot") == 0) {
+                    strncpy(options.live.snapshot_file, optarg, sizeof(options.live.snapshot_file) - 1);
+                } else if (strcmp(long_options[option_index].name, "live-interval") == 0) {
+                    options.live.interval_s = atoi(optarg);
+                } else if (strcmp(long_options[option_index].name, "rt-policy") == 0) {
+                    if (!rt_parse_policy(optarg, &options.rt.policy)) {
+                        fprintf(stderr, "Unknown scheduling policy: %s\n", optarg);
+                    }
+                } else if (strcmp(long_options[option_index].name, "rt-priority") == 0) {
+                    options.rt.priority = atoi(optarg);
+                } else if (strcmp(long_options[option_index].name, "cpus") == 0) {
+                    if (!rt_parse_cpu_list(optarg, &options.rt.cpu_mask)) {
+                        fprintf(stderr, "Invalid CPU list: %s\n", optarg);
+                    }
+                } else if (strcmp(long_options[option_index].name, "mlock") == 0) {
+                    options.rt.lock_memory = true;
+                } else if (strcmp(long_options[option_index].name, "all-devices") == 0) {
+                    options.all_devices = true;
+                } else if (strcmp(long_options[option_index].name, "cap-cache") == 0) {
+                    options.cap_cache = optarg;
+                } else if (strcmp(long_options[option_index].name, "record") == 0) {
+                    options.record_file = optarg;
+                } else if (strcmp(long_options[option_index].name, "replay") == 0) {
+                    options.replay_file = optarg;
+                } else if (strcmp(long_options[option_index].name, "replay-speed") == 0) {
+                    if (strcmp(optarg, "recorded") == 0) {
+                        options.replay_speed = TRACE_SPEED_RECORDED;
+                    } else if (strcmp(optarg, "max") == 0) {
+                        options.replay_speed = TRACE_SPEED_MAX;
+                    } else {
+                        fprintf(stderr, "Unknown replay speed: %s\n", optarg);
+                    }
+                } else if (strcmp(long_options[option_index].name, "video-input") == 0) {
+                    options.video_input = optarg;
                 } else if (strcmp(long_options[option_index].name, "usb-device-path") == 0) {
                     options.usb_device_path = optarg;
                 } else if (strcmp(long_options[option_index].name, "usb-test-device-class") == 0) {
@@ -216,6 +498,10 @@ cmd_options_t parse_options(int argc, char *argv[]) {
                     options.usb_vendor_id = (uint16_t)strtoul(optarg, NULL, 16);
                 } else if (strcmp(long_options[option_index].name, "usb-product-id") == 0) {
                     options.usb_product_id = (uint16_t)strtoul(optarg, NULL, 16);
+                } else if (strcmp(long_options[option_index].name, "usb-block-size") == 0) {
+                    options.usb_block_size = (uint32_t)strtoul(optarg, NULL, 0);
+                } else if (strcmp(long_options[option_index].name, "usb-queue-depth") == 0) {
+                    options.usb_queue_depth = (uint32_t)strtoul(optarg, NULL, 0);
                 }
                 break;
             case 's':
@@ -227,6 +513,8 @@ cmd_options_t parse_options(int argc, char *argv[]) {
                     options.subsystem = SUBSYSTEM_VIDEO;
                 } else if (strcmp(optarg, "usb") == 0) {
                     options.subsystem = SUBSYSTEM_USB;
+                } else if (strcmp(optarg, "stress") == 0) {
+                    options.subsystem = SUBSYSTEM_STRESS;
                 } else if (strcmp(optarg, "all") == 0) {
                     options.subsystem = SUBSYSTEM_ALL;
                 } else {
@@ -251,6 +539,9 @@ cmd_options_t parse_options(int argc, char *argv[]) {
             case 'i':
                 options.iterations = atoi(optarg);
                 break;
+            case 'j':
+                options.jobs = atoi(optarg);
+                break;
             case 'v':
                 options.verbose = true;
                 break;
@@ -270,6 +561,134 @@ uint32_t get_elapsed_ms(struct timeval *start, struct timeval *end) {
     return (end->tv_sec - start->tv_sec) * 1000 + (end->tv_usec - start->tv_usec) / 1000;
 }
 
+// Arguments for a streaming loop handed to rt_thread_run()
+typedef struct {
+    uint32_t device_index;
+    int mode;                       // Audio direction or zero-copy mode
+    const void *config;
+    void *stats;
+} stream_job_t;
+
+static bool audio_stream_job(void *arg) {
+    stream_job_t *job = arg;
+    return test_audio_stream(job->device_index, (audio_device_type_t)job->mode, job->config, job->stats);
+}
+
+static bool audio_latency_job(void *arg) {
+    stream_job_t *job = arg;
+    return test_audio_loopback_latency(job->device_index, job->config, job->stats);
+}
+
+static bool video_stream_job(void *arg) {
+    stream_job_t *job = arg;
+    return test_video_stream(job->device_index, job->config, job->stats);
+}
+
+#ifdef _ENABLE_DRM
+static bool video_zero_copy_job(void *arg) {
+    stream_job_t *job = arg;
+    return test_video_zero_copy(job->device_index, job->config, (video_zero_copy_mode_t)job->mode, job->stats);
+}
+#endif
+
+// Runs a streaming loop under the --rt-* scheduling and records in the
+// report what the thread actually got, so runs stay comparable
+static bool run_streaming(const cmd_options_t *options, rt_thread_fn_t fn, stream_job_t *job) {
+    rt_config_t applied;
+    bool result = rt_thread_run(&options->rt, fn, job, &applied);
+
+    if (g_report && rt_config_active(&options->rt)) {
+        char description[128];
+        rt_config_describe(&applied, description, sizeof(description));
+        report_set_property(g_report, "Streaming Scheduling", description);
+    }
+    return result;
+}
+
+// Measures every point of a sweep, prints the matrix and reports each
+// measured point as "<title> <label>/<label>/..."
+static bool run_sweep(const sweep_t *sweep, sweep_point_fn_t fn, void *context, metric_type_t type) {
+    sweep_result_t result;
+    sweep_run(sweep, fn, context, &result);
+    if (!result.values) {
+        return false;
+    }
+
+    sweep_print_matrix(sweep, &result, stdout);
+    for (uint32_t i = 0; g_report && i < result.point_count; i++) {
+        if (isnan(result.values[i])) {
+            continue;
+        }
+        sweep_point_t point;
+        sweep_get_point(sweep, i, &point);
+        char metric[128];
+        int length = snprintf(metric, sizeof(metric), "%s", sweep->title);
+        for (uint32_t a = 0; a < sweep->axis_count && length < (int)sizeof(metric); a++) {
+            length += snprintf(metric + length, sizeof(metric) - length, "%s%s", a ? "/" : " ", point.labels[a]);
+        }
+        report_add_metric(g_report, metric, type, result.values[i], sweep->units);
+    }
+
+    bool measured = result.measured > 0;
+    sweep_result_free(&result);
+    return measured;
+}
+
+// One line and three metrics per shared format x modifier pair
+static void print_cross_device_result(void *context, const drm_cross_device_result_t *result) {
+    const char *direction = context;
+    char name[160];
+    snprintf(name, sizeof(name), "Cross-Device %s %.4s:0x%llx", direction,
+             (const char *)&result->format, (unsigned long long)result->modifier);
+
+    if (!result->imported) {
+        printf("%s: import rejected\n", name);
+        return;
+    }
+    print_test_result(name, result->verified);
+    print_performance_metrics(name, &result->import_ns);
+    printf("%s: zero-copy %.1f MB/s, copy %.1f MB/s\n", name,
+           result->zero_copy_bps / 1e6, result->copy_bps / 1e6);
+
+    if (g_report) {
+        char metric[192];
+        snprintf(metric, sizeof(metric), "%s Zero-Copy Read", name);
+        report_add_throughput_metric(g_report, metric, result->zero_copy_bps);
+        snprintf(metric, sizeof(metric), "%s Copy", name);
+        report_add_throughput_metric(g_report, metric, result->copy_bps);
+    }
+}
+
+// Shares every common pair between the display device and each other
+// node, in both directions where the other node can allocate
+static bool run_cross_device_benchmark(const test_config_t *config) {
+    drm_device_t *display = drm_get_display_device();
+    char paths[DRM_DEVICE_MAX][DRM_DEVICE_PATH_MAX];
+    uint32_t path_count = drm_device_enumerate(paths, DRM_DEVICE_MAX);
+    bool result = true;
+    uint32_t peers = 0;
+
+    for (uint32_t i = 0; i < path_count; i++) {
+        drm_device_t peer;
+        if (strcmp(paths[i], display->path) == 0 || !drm_device_open(&peer, paths[i])) {
+            continue;
+        }
+        peers++;
+
+        char direction[64];
+        snprintf(direction, sizeof(direction), "%s -> %s", drm_device_name(display), drm_device_name(&peer));
+        result &= test_cross_device_dmabuf(display, &peer, config, print_cross_device_result, direction);
+        if (peer.dumb) {
+            snprintf(direction, sizeof(direction), "%s -> %s", drm_device_name(&peer), drm_device_name(display));
+            result &= test_cross_device_dmabuf(&peer, display, config, print_cross_device_result, direction);
+        }
+
+        drm_device_close(&peer);
+    }
+
+    return result && peers > 0;
+}
+
 // Function to run DRM tests
 void run_drm_tests(const cmd_options_t *options) {
     printf("\n===== Running DRM Tests =====\n\n");
@@ -300,6 +719,12 @@ void run_drm_tests(const cmd_options_t *options) {
         .iterations = options->iterations
     };
 
+    test_config_t xrgb_config = argb_config;
+    xrgb_config.format = DRM_FORMAT_XRGB8888;
+
+    test_config_t yuv420_config = argb_config;
+    yuv420_config.format = DRM_FORMAT_YUV420;
+
     if (options->test_name == NULL || strcmp(options->test_name, "buffer_sharing") == 0) {
         // Buffer Sharing Tests
         gettimeofday(&start_time, NULL);
@@ -331,18 +756,39 @@ void run_drm_tests(const cmd_options_t *options) {
 
     if (options->test_name == NULL || strcmp(options->test_name, "format_conversion") == 0) {
         // Format Conversion Tests
-        print_test_result("Format Conversion (ARGB -> XRGB8888)", test_format_conversion(&argb_config, &argb_config));
-        print_test_result("Format Conversion (ARGB -> YUV422)", test_format_conversion(&argb_config, &nv12_config));
+        print_test_result("Format Conversion (ARGB -> XRGB8888)", test_format_conversion(&argb_config, &xrgb_config));
+        print_test_result("Format Conversion (ARGB -> NV12 tiled)", test_format_conversion(&argb_config, &nv12_config));
+        print_test_result("Format Conversion (ARGB -> YUV420)", test_format_conversion(&argb_config, &yuv420_config));
     }
 
     if (options->test_name == NULL || strcmp(options->test_name, "performance") == 0) {
         // Performance Tests
-        uint32_t avg_time;
-        if (test_buffer_performance(&argb_config, &avg_time)) {
-            print_performance_metrics("Buffer Sharing", avg_time);
+        report_histogram_t export_import;
+        if (test_buffer_performance(&argb_config, &export_import)) {
+            print_performance_metrics("Buffer Sharing", &export_import);
         }
     }
 
+    if (options->test_name == NULL || strcmp(options->test_name, "bandwidth") == 0) {
+        // CPU access through dumb and dma-buf mappings
+        map_bandwidth_t dumb, prime;
+        bool result = test_buffer_bandwidth(&argb_config, &dumb, &prime);
+        print_test_result("Mapped Buffer Bandwidth", result);
+        if (result) {
+            print_bandwidth_metrics("DRM Dumb Mapping", &dumb);
+            print_bandwidth_metrics("DRM PRIME Import Mapping", &prime);
+        }
+    }
+
+    if (options->test_name != NULL && strcmp(options->test_name, "sweep") == 0) {
+        // Fill throughput over every advertised format x modifier x mode size;
+        // the device stays open and buffers stay pooled between points
+        sweep_t sweep;
+        bool result = drm_sweep_init(&sweep, &argb_config) &&
+                      run_sweep(&sweep, drm_sweep_fill_throughput, &argb_config, METRIC_THROUGHPUT);
+        print_test_result("DRM Parameter Sweep", result);
+    }
+
     if (options->test_name == NULL || strcmp(options->test_name, "plane_config") == 0) {
         // Plane Configuration Tests
         drm_plane_t plane = {
@@ -404,11 +850,79 @@ void run_drm_tests(const cmd_options_t *options) {
         print_test_result("VBLANK Handling", test_vblank_handling());
     }
 
+    if (options->test_name == NULL || strcmp(options->test_name, "flip") == 0) {
+        // Sustained page flip benchmark
+        drm_flip_stats_t flip_stats = { 0 };
+        uint32_t frames = options->iterations > 1 ? options->iterations : TEST_FLIP_FRAMES;
+        bool result = test_page_flip_throughput(&argb_config, TEST_FLIP_RING_SIZE, frames, &flip_stats);
+        print_test_result("Page Flip Throughput", result);
+        printf("Page Flip: %u frames, %.2f FPS, %u missed vblanks, latency p50 %.3f ms p99 %.3f ms max %.3f ms\n",
+               flip_stats.frames, flip_stats.fps, flip_stats.missed_vblanks,
+               flip_stats.latency_p50_ms, flip_stats.latency_p99_ms, flip_stats.latency_max_ms);
+
+        if (g_report && flip_stats.frames > 0) {
+            report_add_frame_rate_metric(g_report, "Page Flip FPS", flip_stats.fps);
+            report_add_count_metric(g_report, "Page Flip Missed VBlanks", flip_stats.missed_vblanks);
+            report_add_latency_metric(g_report, "Page Flip Latency p50", flip_stats.latency_p50_ms);
+            report_add_latency_metric(g_report, "Page Flip Latency p99", flip_stats.latency_p99_ms);
+            report_add_latency_metric(g_report, "Page Flip Latency max", flip_stats.latency_max_ms);
+        }
+    }
+
     if (options->test_name == NULL || strcmp(options->test_name, "sync") == 0) {
         // Sync Tests
         print_test_result("Sync Primitives", test_sync_primitives());
     }
 
+    if (options->test_name == NULL || strcmp(options->test_name, "fence") == 0) {
+        // Explicit-sync pipeline at increasing depths; past the depth where
+        // the producer stops stalling, more buffers buy nothing
+        uint32_t frames = options->iterations > 1 ? options->iterations : TEST_FLIP_FRAMES;
+        drm_fence_stats_t *fence_stats = malloc(sizeof(drm_fence_stats_t));
+        bool result = fence_stats != NULL;
+        double best_fps = 0.0;
+        uint32_t useful_depth = 0;
+
+        for (uint32_t depth = 1; result && depth <= TEST_FENCE_MAX_DEPTH; depth++) {
+            result = test_fence_pipeline(&argb_config, depth, frames, fence_stats);
+            if (!result) {
+                break;
+            }
+
+            char name[64];
+            printf("Fence Pipeline depth %u: %.2f FPS, %u/%u frames ready ahead, %u producer stalls\n",
+                   depth, fence_stats->fps, fence_stats->ready_frames, fence_stats->frames,
+                   fence_stats->producer_stalls);
+            snprintf(name, sizeof(name), "Fence Signal-to-Wake depth %u", depth);
+            print_performance_metrics(name, &fence_stats->signal_to_wake);
+            snprintf(name, sizeof(name), "Fence Release Wait depth %u", depth);
+            print_performance_metrics(name, &fence_stats->release_wait);
+            snprintf(name, sizeof(name), "Fence Commit-to-Out-Fence depth %u", depth);
+            print_performance_metrics(name, &fence_stats->commit_to_fence);
+            if (g_report) {
+                snprintf(name, sizeof(name), "Fence Pipeline FPS depth %u", depth);
+                report_add_frame_rate_metric(g_report, name, fence_stats->fps);
+                snprintf(name, sizeof(name), "Fence Producer Stalls depth %u", depth);
+                report_add_count_metric(g_report, name, fence_stats->producer_stalls);
+            }
+
+            // A deeper pipeline counts only if it gained at least 1% FPS
+            if (fence_stats->fps > best_fps * 1.01) {
+                best_fps = fence_stats->fps;
+                useful_depth = depth;
+            }
+        }
+
+        print_test_result("Fence Pipeline", result);
+        if (result) {
+            printf("Fence Pipeline: deepest useful depth %u (%.2f FPS)\n", useful_depth, best_fps);
+            if (g_report) {
+                report_add_count_metric(g_report, "Fence Pipeline Useful Depth", useful_depth);
+            }
+        }
+        free(fence_stats);
+    }
+
     if (options->test_name == NULL || strcmp(options->test_name, "color") == 0) {
         // Color Management Tests
         print_test_result("Color Management", test_color_management());
@@ -417,6 +931,7 @@ void run_drm_tests(const cmd_options_t *options) {
     if (options->test_name == NULL || strcmp(options->test_name, "cross_device") == 0) {
         // Cross-Device Tests
         print_test_result("Cross-Device Sharing", test_cross_device_sharing(&argb_config));
+        print_test_result("Cross-Device DMA-BUF Benchmark", run_cross_device_benchmark(&argb_config));
     }
 
     if (options->test_name == NULL || strcmp(options->test_name, "all") == 0) {
@@ -424,6 +939,19 @@ void run_drm_tests(const cmd_options_t *options) {
         print_test_result("All DRM Features", test_all_features());
     }
 
+    // Buffer pool effectiveness across all DRM tests
+    drm_buffer_pool_stats_t pool_stats;
+    drm_buffer_pool_get_stats(&pool_stats);
+    if (options->verbose) {
+        printf("DRM Buffer Pool: %llu hits, %llu misses, %llu evictions\n",
+               (unsigned long long)pool_stats.hits, (unsigned long long)pool_stats.misses,
+               (unsigned long long)pool_stats.evictions);
+    }
+    if (g_report) {
+        report_add_count_metric(g_report, "DRM Buffer Pool Hits", pool_stats.hits);
+        report_add_count_metric(g_report, "DRM Buffer Pool Misses", pool_stats.misses);
+    }
+
     // Cleanup
     cleanup_test_framework();
 }
@@ -443,7 +971,10 @@ void run_audio_tests(const cmd_options_t *options) {
         .format = AUDIO_FORMAT_PCM_S16LE,
         .channels = AUDIO_CHANNEL_STEREO,
         .buffer_size = 1024,
+        .period_size = options->period_size,
+        .periods = options->periods,
         .iterations = options->iterations,
+        .duration = AUDIO_STREAM_DEFAULT_DURATION,
         .timeout = 5000
     };
 
@@ -478,7 +1009,19 @@ void run_audio_tests(const cmd_options_t *options) {
     if (options->test_name == NULL || strcmp(options->test_name, "playback") == 0) {
         // Playback Tests
         if (device_info.type == AUDIO_DEVICE_PLAYBACK || device_info.type == AUDIO_DEVICE_BOTH) {
-            print_test_result("Audio Playback", test_audio_playback(options->device_index, &audio_config));
+            audio_stream_stats_t stats;
+            stream_job_t job = { options->device_index, AUDIO_DEVICE_PLAYBACK, &audio_config, &stats };
+            bool result = run_streaming(options, audio_stream_job, &job);
+            print_test_result("Audio Playback", result && stats.xruns == 0);
+            printf("Audio Playback: %llu frames, period %u / buffer %u frames at %u Hz, "
+                   "%u underruns, %.1f Hz measured, max wakeup gap %.3f ms\n",
+                   (unsigned long long)stats.frames, stats.period_size, stats.buffer_size, stats.rate,
+                   stats.xruns, stats.measured_rate, stats.max_wakeup_ms);
+
+            if (g_report && stats.frames > 0) {
+                report_add_count_metric(g_report, "Audio Playback Underruns", stats.xruns);
+                report_add_latency_metric(g_report, "Audio Playback Max Wakeup Gap", stats.max_wakeup_ms);
+            }
         } else {
             printf("Skipping playback test (device does not support playback)\n");
         }
@@ -487,7 +1030,19 @@ void run_audio_tests(const cmd_options_t *options) {
     if (options->test_name == NULL || strcmp(options->test_name, "capture") == 0) {
         // Capture Tests
         if (device_info.type == AUDIO_DEVICE_CAPTURE || device_info.type == AUDIO_DEVICE_BOTH) {
-            print_test_result("Audio Capture", test_audio_capture(options->device_index, &audio_config));
+            audio_stream_stats_t stats;
+            stream_job_t job = { options->device_index, AUDIO_DEVICE_CAPTURE, &audio_config, &stats };
+            bool result = run_streaming(options, audio_stream_job, &job);
+            print_test_result("Audio Capture", result && stats.xruns == 0);
+            printf("Audio Capture: %llu frames, period %u / buffer %u frames at %u Hz, "
+                   "%u overruns, %.1f Hz measured, max wakeup gap %.3f ms, peak %.1f dBFS\n",
+                   (unsigned long long)stats.frames, stats.period_size, stats.buffer_size, stats.rate,
+                   stats.xruns, stats.measured_rate, stats.max_wakeup_ms, stats.peak_dbfs);
+
+            if (g_report && stats.frames > 0) {
+                report_add_count_metric(g_report, "Audio Capture Overruns", stats.xruns);
+                report_add_latency_metric(g_report, "Audio Capture Max Wakeup Gap", stats.max_wakeup_ms);
+            }
         } else {
             printf("Skipping capture test (device does not support capture)\n");
         }
@@ -498,21 +1053,115 @@ void run_audio_tests(const cmd_options_t *options) {
         print_test_result("Audio Format Support", test_audio_format_support(options->device_index, &audio_config));
     }
 
+    if (options->test_name == NULL || strcmp(options->test_name, "convert") == 0) {
+        // CPU sample conversion from the stream format to every PCM format
+        bool all_passed = true;
+        for (audio_format_t format = 0; audio_format_is_pcm(format); format++) {
+            if (format == audio_config.format) {
+                continue;
+            }
+            char name[128];
+            audio_convert_stats_t stats;
+            snprintf(name, sizeof(name), "Audio Convert %s to %s", audio_format_to_string(audio_config.format),
+                     audio_format_to_string(format));
+            bool result = test_audio_format_conversion(&audio_config, format, &stats);
+            if (stats.samples > 0) {
+                print_audio_convert_metrics(name, &stats);
+            }
+            all_passed = all_passed && result;
+        }
+        print_test_result("Audio Format Conversion", all_passed);
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "resample") == 0) {
+        // The common rate pairs both ways, stereo and 7.1
+        const uint32_t rates[][2] = {
+            { 44100, 48000 }, { 48000, 44100 }, { 48000, 96000 },
+            { 96000, 48000 }, { 44100, 96000 }, { 96000, 44100 }
+        };
+        const audio_channel_t layouts[] = { AUDIO_CHANNEL_STEREO, AUDIO_CHANNEL_7_1 };
+        bool all_passed = true;
+        for (uint32_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+            for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+                audio_test_config_t config = audio_config;
+                config.sample_rate = rates[i][0];
+                config.channels = layouts[l];
+                char name[128];
+                audio_resample_stats_t stats;
+                snprintf(name, sizeof(name), "Audio Resample %u to %u Hz %s", rates[i][0], rates[i][1],
+                         audio_channel_to_string(layouts[l]));
+                bool result = test_audio_resampling(&config, rates[i][1], &stats);
+                if (stats.frames > 0) {
+                    print_resample_metrics(name, &stats);
+                }
+                all_passed = all_passed && result;
+            }
+        }
+        print_test_result("Audio Resampling", all_passed);
+    }
+
     if (options->test_name == NULL || strcmp(options->test_name, "latency") == 0) {
-        // Latency Tests
-        uint32_t latency_ms;
-        if (test_audio_latency(options->device_index, &audio_config, &latency_ms)) {
-            print_audio_metrics("Audio", latency_ms);
+        // Loopback round trip, impulse out and detected back in
+        audio_latency_stats_t stats;
+        stream_job_t job = { options->device_index, 0, &audio_config, &stats };
+        if (run_streaming(options, audio_latency_job, &job)) {
+            print_audio_metrics("Audio", (uint32_t)(stats.p50_ms + 0.5));
+            printf("Audio Round Trip: %u/%u impulses, period %u / buffer %u frames at %u Hz, "
+                   "min %.2f p50 %.2f p90 %.2f p99 %.2f max %.2f ms, %u xruns\n",
+                   stats.detected, stats.impulses, stats.period_size, stats.buffer_size, stats.rate,
+                   stats.min_ms, stats.p50_ms, stats.p90_ms, stats.p99_ms, stats.max_ms, stats.xruns);
+            if (stats.linked) {
+                printf("Audio Path Latency: %.2f ms\n", stats.path_ms);
+            }
+
+            if (g_report) {
+                report_add_latency_metric(g_report, "Audio Round Trip p50", stats.p50_ms);
+                report_add_latency_metric(g_report, "Audio Round Trip p99", stats.p99_ms);
+                report_add_latency_metric(g_report, "Audio Round Trip max", stats.max_ms);
+                report_add_count_metric(g_report, "Audio Loopback Xruns", stats.xruns);
+            }
         } else {
-            printf("Latency test failed\n");
+            printf("Latency test failed (is playback looped back into capture?)\n");
         }
     }
 
+    if (options->test_name != NULL && strcmp(options->test_name, "sweep") == 0) {
+        // Stream rate over every reported rate x channels x format
+        audio_sweep_context_t context = {
+            .device_index = options->device_index,
+            .direction = device_info.type == AUDIO_DEVICE_CAPTURE ? AUDIO_DEVICE_CAPTURE : AUDIO_DEVICE_PLAYBACK,
+            .config = audio_config
+        };
+        sweep_t sweep;
+        bool result = audio_sweep_init(&sweep, options->device_index, &audio_config) &&
+                      run_sweep(&sweep, audio_sweep_stream_rate, &context, METRIC_COUNT);
+        print_test_result("Audio Parameter Sweep", result);
+    }
+
     if (options->test_name == NULL || strcmp(options->test_name, "all") == 0) {
         // Comprehensive Test
         print_test_result("All Audio Features", test_all_audio_features(options->device_index, &audio_config));
     }
 
+    // Cleanup
+    cleanup_audio_test_framework();
+}
+
+// Video test configuration shared by the capture and zero-copy runs
+static video_test_config_t make_video_config(const cmd_options_t *options) {
+    video_test_config_t config = {
+        .width = options->width,
+        .height = options->height,
+        .format = VIDEO_FORMAT_YUYV,
+        .framerate = 30,
+        .bitrate = 0,
+        .duration = 10,
+        .iterations = options->iterations,
+        .timeout = 5000
+    };
+    return config;
+}
+
 // Function to run video tests
 void run_video_tests(const cmd_options_t *options)
 {
@@ -520,22 +1169,508 @@ void run_video_tests(const cmd_options_t *options)
     
     printf("\n=== Starting Video Tests ===\n");
     
-    // Initialize video test
-    if (!tizen_video_test_init()) {
-        fprintf(stderr, "Failed to initialize video test\n");
+    // Initialize video test framework
+    if (!init_video_test_framework()) {
+        fprintf(stderr, "Failed to initialize video test framework\n");
         return;
     }
     
+    video_test_config_t config = make_video_config(options);
+    
     // Run tests based on options
     if (options->test_name == NULL || strcmp(options->test_name, "all") == 0 ||
         strcmp(options->test_name, "capture") == 0) {
-        printf("\n[TEST] Video Capture...");
-        bool result = tizen_video_test_capture(options->width, options->height, options->iterations);
+        bool result = test_video_capture(options->device_index, &config);
         print_test_result("Video Capture Test", result);
     }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "bandwidth") == 0) {
+        // CPU access through an exported capture buffer
+        map_bandwidth_t bandwidth;
+        bool result = test_video_buffer_bandwidth(options->device_index, &config, &bandwidth);
+        print_test_result("Video Export Bandwidth", result);
+        if (result) {
+            print_bandwidth_metrics("V4L2 EXPBUF Mapping", &bandwidth);
+        }
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "stream") == 0) {
+        // Sustained streaming with every buffer kept queued
+        video_stream_stats_t stats;
+        stream_job_t job = { options->device_index, 0, &config, &stats };
+        bool result = run_streaming(options, video_stream_job, &job);
+        print_test_result("Video Streaming", result);
+        printf("Video Streaming: %u frames over %u buffers, %.2f FPS avg, %.2f FPS 1%% low, "
+               "%u dropped, jitter %.3f ms, max interval %.3f ms%s\n",
+               stats.frames, stats.buffers, stats.avg_fps, stats.low_1pct_fps, stats.dropped_frames,
+               stats.jitter_ms, stats.max_interval_ms,
+               stats.monotonic_timestamps ? "" : " (dequeue timestamps)");
+
+        if (g_report && stats.frames > 1) {
+            report_add_frame_rate_metric(g_report, "Video Streaming FPS avg", stats.avg_fps);
+            report_add_frame_rate_metric(g_report, "Video Streaming FPS 1% low", stats.low_1pct_fps);
+            report_add_count_metric(g_report, "Video Streaming Dropped Frames", stats.dropped_frames);
+            report_add_latency_metric(g_report, "Video Streaming Jitter", stats.jitter_ms);
+        }
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "convert") == 0) {
+        // CPU reference, and the device when it is a mem-to-mem converter
+        bool all_passed = true;
+        for (video_format_t format = 0; video_format_is_raw(format); format++) {
+            if (format == config.format) {
+                continue;
+            }
+            char name[128];
+            video_convert_stats_t stats;
+            snprintf(name, sizeof(name), "Video Convert %s to %s", video_format_to_string(config.format),
+                     video_format_to_string(format));
+            bool result = test_video_conversion(options->device_index, &config, format, &stats);
+            if (stats.cpu_frames > 0) {
+                print_convert_metrics(name, &stats);
+            }
+            all_passed = all_passed && result;
+        }
+        print_test_result("Video Format Conversion", all_passed);
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "scale") == 0) {
+        // Half size and one and a half times, through both filters
+        const uint32_t sizes[2][2] = {
+            { (config.width / 2) & ~1u, (config.height / 2) & ~1u },
+            { (config.width * 3 / 2) & ~1u, (config.height * 3 / 2) & ~1u }
+        };
+        bool all_passed = true;
+        for (video_scale_filter_t filter = 0; filter < VIDEO_SCALE_MAX; filter++) {
+            for (uint32_t i = 0; i < 2; i++) {
+                char name[128];
+                video_convert_stats_t stats;
+                snprintf(name, sizeof(name), "Video Scale %ux%u to %ux%u %s", config.width, config.height,
+                         sizes[i][0], sizes[i][1], video_scale_filter_to_string(filter));
+                bool result = test_video_scaling(options->device_index, &config, sizes[i][0], sizes[i][1],
+                                                 filter, &stats);
+                if (stats.cpu_frames > 0) {
+                    print_convert_metrics(name, &stats);
+                }
+                all_passed = all_passed && result;
+            }
+        }
+        print_test_result("Video Scaling", all_passed);
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "rotate") == 0) {
+        bool all_passed = true;
+        for (uint32_t angle = 90; angle < 360; angle += 90) {
+            char name[128];
+            video_convert_stats_t stats;
+            snprintf(name, sizeof(name), "Video Rotate %u", angle);
+            bool result = test_video_rotation(options->device_index, &config, angle, &stats);
+            if (stats.cpu_frames > 0) {
+                print_convert_metrics(name, &stats);
+            }
+            all_passed = all_passed && result;
+        }
+        print_test_result("Video Rotation", all_passed);
+    }
+
+    if (options->test_name == NULL || strcmp(options->test_name, "encode") == 0) {
+        // Every codec some mem-to-mem encoder takes, at three bitrates
+        const video_format_t codecs[] = { VIDEO_FORMAT_H264, VIDEO_FORMAT_H265, VIDEO_FORMAT_VP8, VIDEO_FORMAT_VP9 };
+        const uint32_t bitrates[] = { 1000000, 4000000, 10000000 };
+        bool all_passed = true;
+        bool any = false;
+        for (uint32_t c = 0; c < sizeof(codecs) / sizeof(codecs[0]); c++) {
+            uint32_t index;
+            if (!video_codec_find(options->device_index, codecs[c], true, !options->all_devices, &index)) {
+                continue;
+            }
+            for (uint32_t b = 0; b < sizeof(bitrates) / sizeof(bitrates[0]); b++) {
+                char name[128];
+                video_codec_stats_t stats;
+                video_test_config_t encode_config = config;
+                encode_config.bitrate = bitrates[b];
+                snprintf(name, sizeof(name), "Video Encode %s %u kbit/s", video_format_to_string(codecs[c]),
+                         bitrates[b] / 1000);
+                bool result = test_video_encoding_performance(index, &encode_config, codecs[c], &stats);
+                if (stats.frames > 0) {
+                    print_codec_metrics(name, &stats);
+                }
+                all_passed = all_passed && result;
+                any = true;
+            }
+        }
+        if (any) {
+            print_test_result("Video Encoding Performance", all_passed);
+        } else {
+            printf("Video Encoding Performance: no mem-to-mem encoder\n");
+        }
+    }
+
+    if (options->video_input &&
+        (options->test_name == NULL || strcmp(options->test_name, "decode") == 0)) {
+        video_bitstream_t probe;
+        uint32_t index = options->device_index;
+        bool result = video_bitstream_open(options->video_input, &probe);
+        if (result) {
+            video_format_t codec = probe.codec;
+            video_bitstream_close(&probe);
+            result = video_codec_find(options->device_index, codec, false, !options->all_devices, &index);
+            if (!result) {
+                printf("No mem-to-mem %s decoder\n", video_format_to_string(codec));
+            }
+        }
+
+        video_codec_stats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        result = result && test_video_decoding_performance(index, &config, options->video_input, &stats);
+        if (result || stats.frames > 0) {
+            char name[128];
+            snprintf(name, sizeof(name), "Video Decode %s", video_format_to_string(stats.codec));
+            print_codec_metrics(name, &stats);
+        }
+        print_test_result("Video Decoding Performance", result);
+    }
+
+    if (options->test_name != NULL && strcmp(options->test_name, "sweep") == 0) {
+        // Capture rate over every reported format x supported size
+        video_sweep_context_t context = { options->device_index, config };
+        sweep_t sweep;
+        bool result = video_sweep_init(&sweep, options->device_index, &config) &&
+                      run_sweep(&sweep, video_sweep_stream_fps, &context, METRIC_FRAME_RATE);
+        print_test_result("Video Parameter Sweep", result);
+    }
     
     // Cleanup
-    tizen_video_test_cleanup();
+    cleanup_video_test_framework();
+}
+
+#ifdef _ENABLE_DRM
+// Function to run camera-to-display tests; these hold a video device and
+// the DRM device at once, so they are scheduled apart from both
+void run_video_zero_copy_tests(const cmd_options_t *options)
+{
+    if (!options) return;
+    
+    if (options->test_name == NULL || strcmp(options->test_name, "zero_copy") == 0) {
+        printf("\n=== Starting Zero-Copy Capture Tests ===\n");
+        
+        video_test_config_t config = make_video_config(options);
+        
+        // Camera to display through shared dma-bufs
+        if (init_test_framework()) {
+            video_test_config_t zero_copy_config = config;
+            zero_copy_config.format = VIDEO_FORMAT_NV12;
+            if (zero_copy_config.iterations < 2) {
+                zero_copy_config.iterations = 300;
+            }
+
+            for (int mode = 0; mode < VIDEO_ZERO_COPY_MAX; mode++) {
+                video_zero_copy_stats_t stats;
+                char name[64];
+                snprintf(name, sizeof(name), "Zero-Copy Capture (%s)",
+                         video_zero_copy_mode_to_string((video_zero_copy_mode_t)mode));
+
+                stream_job_t job = { options->device_index, mode, &zero_copy_config, &stats };
+                bool result = run_streaming(options, video_zero_copy_job, &job);
+                print_test_result(name, result);
+                printf("%s: %u captured, %u displayed, %u skipped, %llu copies avoided (%llu MB), "
+                       "latency avg %.3f ms p99 %.3f ms max %.3f ms\n",
+                       name, stats.frames_captured, stats.frames_displayed, stats.frames_skipped,
+                       (unsigned long long)stats.copies_avoided,
+                       (unsigned long long)(stats.bytes_not_copied >> 20),
+                       stats.latency_avg_ms, stats.latency_p99_ms, stats.latency_max_ms);
+
+                if (g_report && stats.frames_displayed > 0) {
+                    char metric[96];
+                    snprintf(metric, sizeof(metric), "%s Latency avg", name);
+                    report_add_latency_metric(g_report, metric, stats.latency_avg_ms);
+                    snprintf(metric, sizeof(metric), "%s Latency p99", name);
+                    report_add_latency_metric(g_report, metric, stats.latency_p99_ms);
+                    snprintf(metric, sizeof(metric), "%s Copies Avoided", name);
+                    report_add_count_metric(g_report, metric, stats.copies_avoided);
+                    snprintf(metric, sizeof(metric), "%s Frames Skipped", name);
+                    report_add_count_metric(g_report, metric, stats.frames_skipped);
+                }
+            }
+
+            cleanup_test_framework();
+        } else {
+            fprintf(stderr, "Zero-copy capture needs the DRM test framework\n");
+        }
+    }
+}
+#endif
+
+#ifdef _ENABLE_STRESS
+// Workloads named in a comma separated --test list, all of them by default
+static uint32_t parse_stress_workloads(const char *list) {
+    uint32_t workloads = 0;
+    char buffer[128];
+
+    if (list == NULL || strcmp(list, "all") == 0) {
+        return STRESS_WORKLOAD_ALL;
+    }
+
+    strncpy(buffer, list, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    for (char *save = NULL, *name = strtok_r(buffer, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+        int i;
+        for (i = 0; i < STRESS_WORKLOAD_MAX; i++) {
+            if (strcmp(name, stress_workload_to_string((stress_workload_t)i)) == 0) {
+                workloads |= STRESS_WORKLOAD_BIT(i);
+                break;
+            }
+        }
+        if (i == STRESS_WORKLOAD_MAX) {
+            fprintf(stderr, "Unknown stress workload: %s\n", name);
+        }
+    }
+    return workloads;
+}
+
+// Function to run scanout, capture and playback alone and then together,
+// to see how much each one loses to the others
+void run_stress_tests(const cmd_options_t *options)
+{
+    if (!options) return;
+    
+    printf("\n=== Starting Concurrent Stress Tests ===\n");
+    
+    if (!init_test_framework()) {
+        fprintf(stderr, "Failed to initialize DRM test framework\n");
+        return;
+    }
+    
+    stress_config_t config = {
+        .duration = options->duration,
+        .workloads = parse_stress_workloads(options->test_name),
+        .scanout = {
+            .width = options->width,
+            .height = options->height,
+            .format = DRM_FORMAT_XRGB8888,
+            .modifier = DRM_MODIFIER_LINEAR,
+            .compression = DRM_COMPRESSION_NONE,
+            .iterations = 1
+        },
+        .video_device = options->device_index,
+        .capture = make_video_config(options),
+        .audio_device = options->device_index,
+        .playback = {
+            .sample_rate = options->sample_rate,
+            .format = AUDIO_FORMAT_PCM_S16LE,
+            .channels = AUDIO_CHANNEL_STEREO,
+            .buffer_size = 1024,
+            .period_size = options->period_size,
+            .periods = options->periods,
+            .iterations = 1,
+            .duration = options->duration,
+            .timeout = 5000
+        },
+        .rt = rt_config_active(&options->rt) ? &options->rt : NULL
+    };
+    
+    printf("Each phase runs for %u seconds\n", config.duration);
+    
+    stress_stats_t stats;
+    bool result = test_concurrent_stress(&config, &stats);
+    print_test_result("Concurrent Stress", result);
+    
+    const stress_degradation_t *d = &stats.degradation;
+    const stress_run_t *alone = stats.alone;
+    const stress_run_t *combined = stats.combined;
+    
+    if (alone[STRESS_WORKLOAD_SCANOUT].ran && combined[STRESS_WORKLOAD_SCANOUT].ran) {
+        const drm_flip_stats_t *a = &alone[STRESS_WORKLOAD_SCANOUT].flip;
+        const drm_flip_stats_t *c = &combined[STRESS_WORKLOAD_SCANOUT].flip;
+        printf("Stress Scanout: %.2f -> %.2f FPS (%.1f%% drop), missed vblanks %u -> %u, "
+               "latency p99 %.3f -> %.3f ms, max %.3f -> %.3f ms\n",
+               a->fps, c->fps, d->flip_fps_drop_pct, a->missed_vblanks, c->missed_vblanks,
+               a->latency_p99_ms, c->latency_p99_ms, a->latency_max_ms, c->latency_max_ms);
+
+        if (g_report) {
+            report_add_frame_rate_metric(g_report, "Stress Scanout FPS alone", a->fps);
+            report_add_frame_rate_metric(g_report, "Stress Scanout FPS combined", c->fps);
+            report_add_count_metric(g_report, "Stress Scanout Missed VBlanks combined", c->missed_vblanks);
+            report_add_latency_metric(g_report, "Stress Scanout Latency p99 combined", c->latency_p99_ms);
+            report_add_latency_metric(g_report, "Stress Scanout Latency p99 increase", d->flip_p99_increase_ms);
+            report_add_latency_metric(g_report, "Stress Scanout Latency max increase", d->flip_max_increase_ms);
+        }
+    }
+    
+    if (alone[STRESS_WORKLOAD_CAPTURE].ran && combined[STRESS_WORKLOAD_CAPTURE].ran) {
+        const video_stream_stats_t *a = &alone[STRESS_WORKLOAD_CAPTURE].video;
+        const video_stream_stats_t *c = &combined[STRESS_WORKLOAD_CAPTURE].video;
+        printf("Stress Capture: %.2f -> %.2f FPS (%.1f%% drop), 1%% low %.2f -> %.2f FPS, "
+               "dropped %.2f -> %.2f frames/s, max interval %.3f -> %.3f ms\n",
+               a->avg_fps, c->avg_fps, d->capture_fps_drop_pct, a->low_1pct_fps, c->low_1pct_fps,
+               d->capture_drop_rate_alone, d->capture_drop_rate_combined,
+               a->max_interval_ms, c->max_interval_ms);
+
+        if (g_report) {
+            report_add_frame_rate_metric(g_report, "Stress Capture FPS alone", a->avg_fps);
+            report_add_frame_rate_metric(g_report, "Stress Capture FPS combined", c->avg_fps);
+            report_add_frame_rate_metric(g_report, "Stress Capture FPS 1% low combined", c->low_1pct_fps);
+            report_add_count_metric(g_report, "Stress Capture Dropped Frames combined", c->dropped_frames);
+        }
+    }
+    
+    if (alone[STRESS_WORKLOAD_PLAYBACK].ran && combined[STRESS_WORKLOAD_PLAYBACK].ran) {
+        const audio_stream_stats_t *a = &alone[STRESS_WORKLOAD_PLAYBACK].audio;
+        const audio_stream_stats_t *c = &combined[STRESS_WORKLOAD_PLAYBACK].audio;
+        printf("Stress Playback: underruns %u -> %u (%.2f -> %.2f per minute), "
+               "max wakeup gap %.3f -> %.3f ms\n",
+               a->xruns, c->xruns, d->playback_xrun_rate_alone, d->playback_xrun_rate_combined,
+               a->max_wakeup_ms, c->max_wakeup_ms);
+
+        if (g_report) {
+            report_add_count_metric(g_report, "Stress Playback Underruns alone", a->xruns);
+            report_add_count_metric(g_report, "Stress Playback Underruns combined", c->xruns);
+            report_add_latency_metric(g_report, "Stress Playback Max Wakeup Gap combined", c->max_wakeup_ms);
+        }
+    }
+    
+    cleanup_test_framework();
+}
+#endif
+
+// One line and IOPS, throughput and latency metrics per storage run
+static void print_storage_result(const usb_storage_stats_t *stats) {
+    char name[64];
+    snprintf(name, sizeof(name), "USB Storage %s %s", usb_storage_engine_name(stats->engine),
+             usb_storage_pattern_name(stats->pattern));
+
+    report_distribution_t us;
+    report_histogram_summarize(&stats->latency, REPORT_HISTOGRAM_UNIT_NS, &us);
+    printf("%s: %u KiB x QD%u, %.1f MB/s, %.0f IOPS, latency p50 %.1f p99 %.1f max %.1f us, %u errors\n",
+           name, stats->block_size / 1024, stats->queue_depth, stats->mbps, stats->iops,
+           us.p50, us.p99, us.max, stats->errors);
+
+    if (g_report) {
+        char metric[96];
+        snprintf(metric, sizeof(metric), "%s Throughput", name);
+        report_add_throughput_metric(g_report, metric, stats->mbps * 1e6);
+        snprintf(metric, sizeof(metric), "%s IOPS", name);
+        report_add_metric(g_report, metric, METRIC_COUNT, stats->iops, "IOPS");
+        snprintf(metric, sizeof(metric), "%s Latency", name);
+        report_add_histogram_metric(g_report, metric, &stats->latency);
+    }
+}
+
+// Sequential and random reads through the sg node and through the block
+// layer, at the requested block size and queue depth
+static void run_storage_benchmark(const cmd_options_t *options, const char *device_path) {
+    usb_storage_config_t config = {
+        .device_path = device_path,
+        .block_size = options->usb_block_size,
+        .queue_depth = options->usb_queue_depth,
+        .duration = USB_STORAGE_DEFAULT_DURATION
+    };
+
+    uint64_t blocks;
+    uint32_t logical_block_size;
+    if (usb_storage_capacity(config.device_path, &blocks, &logical_block_size)) {
+        printf("USB Storage: %llu blocks of %u bytes (%.1f GB)\n", (unsigned long long)blocks,
+               logical_block_size, (double)blocks * logical_block_size / 1e9);
+    }
+
+    for (int pattern = USB_STORAGE_SEQUENTIAL; pattern <= USB_STORAGE_RANDOM; pattern++) {
+        usb_storage_stats_t stats;
+        bool result = usb_storage_bench_sg(&config, pattern, &stats);
+        print_test_result(pattern == USB_STORAGE_RANDOM ? "USB Storage SG_IO Random Read" :
+                          "USB Storage SG_IO Sequential Read", result);
+        if (result) {
+            print_storage_result(&stats);
+        }
+
+        result = usb_storage_bench_block(&config, pattern, &stats);
+        print_test_result(pattern == USB_STORAGE_RANDOM ? "USB Storage O_DIRECT Random Read" :
+                          "USB Storage O_DIRECT Sequential Read", result);
+        if (result) {
+            print_storage_result(&stats);
+        }
+    }
+}
+
+// Interrupt polling jitter, isochronous bandwidth and bulk throughput,
+// whichever applies to the endpoint's type
+static void print_transfer_result(const usb_transfer_target_t *target, const usb_transfer_stats_t *stats) {
+    char name[64];
+    snprintf(name, sizeof(name), "USB %04x:%04x %s 0x%02x", target->vendor_id, target->product_id,
+             usb_endpoint_type_name(target->type), target->endpoint);
+
+    report_distribution_t us;
+    report_histogram_summarize(&stats->interval, REPORT_HISTOGRAM_UNIT_NS, &us);
+    if (target->type == USB_ENDPOINT_INTERRUPT) {
+        printf("%s: %llu reports, interval %u us expected, p50 %.1f p99 %.1f max %.1f us, jitter %.1f us, "
+               "%u errors\n", name, (unsigned long long)stats->transfers, target->interval_us,
+               us.p50, us.p99, us.max, stats->jitter_us, stats->errors);
+    } else if (target->type == USB_ENDPOINT_ISOCHRONOUS) {
+        printf("%s: %.1f of %.1f KB/s, %llu/%llu packets missed, %u errors\n", name,
+               stats->bytes_per_sec / 1e3, stats->expected_bytes_per_sec / 1e3,
+               (unsigned long long)stats->missed_packets, (unsigned long long)stats->packets, stats->errors);
+    } else {
+        printf("%s: %.2f MB/s over %llu transfers, %u errors\n", name, stats->bytes_per_sec / 1e6,
+               (unsigned long long)stats->transfers, stats->errors);
+    }
+
+    if (g_report) {
+        char metric[96];
+        if (target->type == USB_ENDPOINT_INTERRUPT && stats->interval.count > 0) {
+            snprintf(metric, sizeof(metric), "%s Interval", name);
+            report_add_histogram_metric(g_report, metric, &stats->interval);
+            snprintf(metric, sizeof(metric), "%s Jitter", name);
+            report_add_latency_metric(g_report, metric, stats->jitter_us / 1000.0);
+        } else {
+            snprintf(metric, sizeof(metric), "%s Throughput", name);
+            report_add_throughput_metric(g_report, metric, stats->bytes_per_sec);
+        }
+        if (target->type == USB_ENDPOINT_ISOCHRONOUS) {
+            snprintf(metric, sizeof(metric), "%s Missed Packets", name);
+            report_add_count_metric(g_report, metric, stats->missed_packets);
+        }
+    }
+}
+
+// HID interrupt, audio streaming isochronous and wireless bulk endpoints of
+// the bound device, or of every matching one, all in flight at once
+static void run_transfer_benchmark(const cmd_options_t *options, const usb_test_config_t *config) {
+    usb_transfer_target_t targets[USB_TRANSFER_MAX_TARGETS];
+    uint8_t bus = config->device ? config->device->bus : 0;
+    uint8_t address = config->device ? config->device->address : 0;
+    uint32_t count = 0;
+    if (config->run_hid_tests) {
+        count += usb_transfer_find(USB_CLASS_HID, 0xFF, USB_ENDPOINT_INTERRUPT, config->vendor_id,
+                                   config->product_id, bus, address, targets + count,
+                                   USB_TRANSFER_MAX_TARGETS - count);
+    }
+    if (config->run_audio_tests) {
+        count += usb_transfer_find(USB_CLASS_AUDIO, 0x02, USB_ENDPOINT_ISOCHRONOUS, config->vendor_id,
+                                   config->product_id, bus, address, targets + count,
+                                   USB_TRANSFER_MAX_TARGETS - count);
+    }
+    if (config->run_wireless_tests) {
+        count += usb_transfer_find(USB_CLASS_WIRELESS, 0xFF, USB_ENDPOINT_BULK, config->vendor_id,
+                                   config->product_id, bus, address, targets + count,
+                                   USB_TRANSFER_MAX_TARGETS - count);
+    }
+    if (count == 0) {
+        printf("No HID, audio or wireless endpoints to stream from\n");
+        return;
+    }
+
+    usb_transfer_config_t transfer_config = {
+        .depth = options->usb_queue_depth ? options->usb_queue_depth : USB_TRANSFER_DEFAULT_DEPTH,
+        .iso_packets = USB_TRANSFER_ISO_PACKETS,
+        .bulk_size = USB_TRANSFER_BULK_SIZE,
+        .duration = USB_TRANSFER_DEFAULT_DURATION
+    };
+    usb_transfer_stats_t stats[USB_TRANSFER_MAX_TARGETS];
+    bool result = usb_transfer_run(targets, count, &transfer_config, stats);
+    print_test_result("USB Asynchronous Transfers", result);
+    for (uint32_t i = 0; result && i < count; i++) {
+        print_transfer_result(&targets[i], &stats[i]);
+    }
+    usb_transfer_release(targets, count);
 }
 
 // Function to run USB tests
@@ -566,10 +1701,51 @@ void run_usb_tests(const cmd_options_t *options)
         .vendor_id = options->usb_vendor_id,
         .product_id = options->usb_product_id
     };
+
+    // --all-devices runs one job per device snapshotted when the jobs were
+    // built; find that same attachment again (its disk may have appeared
+    // since) and test only the classes it actually has
+    usb_device_entry_t device;
+    if (options->usb_device) {
+        const usb_device_entry_t *snapshot = options->usb_device;
+        if (!usb_discovery_get_at(snapshot->bus, snapshot->address, &device)) {
+            printf("USB device %04x:%04x at %s is gone, skipping\n", snapshot->vendor_id, snapshot->product_id,
+                   snapshot->port_path);
+            usb_test_cleanup();
+            return;
+        }
+        printf("USB device %04x:%04x at %s (%s)\n", device.vendor_id, device.product_id, device.port_path,
+               device.dev_node);
+        config.device = &device;
+        config.vendor_id = device.vendor_id;
+        config.product_id = device.product_id;
+        config.run_mass_storage_tests &= usb_device_has_class(&device, USB_CLASS_MASS_STORAGE);
+        config.run_hid_tests &= usb_device_has_class(&device, USB_CLASS_HID);
+        config.run_audio_tests &= usb_device_has_class(&device, USB_CLASS_AUDIO);
+        config.run_wireless_tests &= usb_device_has_class(&device, USB_CLASS_WIRELESS);
+        if (!config.run_mass_storage_tests && !config.run_hid_tests && !config.run_audio_tests &&
+            !config.run_wireless_tests) {
+            printf("No tested class on %s, skipping\n", device.port_path);
+            usb_test_cleanup();
+            return;
+        }
+    }
+
+    // The benchmark reads the given disk, or the bound (else first
+    // matching) storage device's once usb-storage has bound it
+    usb_device_entry_t entry;
+    const char *storage_path = config.test_device_path;
+    if (!storage_path && config.device) {
+        storage_path = config.device->block_node[0] ? config.device->block_node : NULL;
+    } else if (!storage_path && config.run_mass_storage_tests &&
+               usb_discovery_find(config.vendor_id, config.product_id, USB_CLASS_MASS_STORAGE, &entry) &&
+               entry.block_node[0]) {
+        storage_path = entry.block_node;
+    }
     
     if (options->verbose) {
         printf("USB Test Configuration:\n");
-        printf("  Device Path: %s\n", config.test_device_path);
+        printf("  Device Path: %s\n", config.test_device_path ? config.test_device_path : "(discovered)");
         if (options->usb_test_device_class) {
             printf("  Test Class: %s\n", options->usb_test_device_class);
         }
@@ -584,11 +1760,287 @@ void run_usb_tests(const cmd_options_t *options)
     // Run USB tests
     int failed_tests = usb_test_run_all(&config);
     printf("\n=== USB Tests Completed: %d tests failed ===\n", failed_tests);
+
+    if (config.run_mass_storage_tests && storage_path &&
+        (options->test_name == NULL || strcmp(options->test_name, "mass_storage") == 0)) {
+        run_storage_benchmark(options, storage_path);
+    }
+    if (options->test_name == NULL || strcmp(options->test_name, "transfer") == 0) {
+        run_transfer_benchmark(options, &config);
+    }
     
     // Cleanup
     usb_test_cleanup();
 }
 
+#define MAX_TEST_JOBS 64
+
+// One subsystem runner on one device, as scheduled on the worker pool
+typedef struct {
+    void (*run)(const cmd_options_t *options);
+    cmd_options_t options;
+    char name[64];
+    usb_device_entry_t usb_device;      // What options.usb_device points at, when set
+} test_job_t;
+
+static bool run_test_job(void *arg) {
+    test_job_t *job = arg;
+    
+    // Marks where the job's operations begin in a recorded trace
+    uint64_t start = trace_begin();
+    if (start) {
+        const cmd_options_t *options = &job->options;
+        char description[256];
+        int length = snprintf(description, sizeof(description), "%s (test %s, %ux%u, %u Hz, %u iterations)",
+                              job->name, options->test_name ? options->test_name : "all", options->width,
+                              options->height, options->sample_rate, options->iterations);
+        uint64_t args[] = { options->device_index };
+        trace_record(TRACE_OP_JOB, start, args, TRACE_ARGC(args), description,
+                     length < (int)sizeof(description) ? (size_t)length : sizeof(description) - 1);
+    }
+    
+    job->run(&job->options);
+    return true;
+}
+
+// Returns the job's arguments, or NULL when there is no room for it
+static test_job_t *add_test_job(worker_job_t *jobs, test_job_t *args, uint32_t *count, const char *name,
+                                void (*run)(const cmd_options_t *), const cmd_options_t *options,
+                                uint32_t device_index, const char *resource, const char *extra_resource) {
+    if (*count >= MAX_TEST_JOBS) {
+        fprintf(stderr, "Too many test jobs, skipping %s\n", name);
+        return NULL;
+    }
+
+    test_job_t *arg = &args[*count];
+    arg->run = run;
+    arg->options = *options;
+    arg->options.device_index = device_index;
+    snprintf(arg->name, sizeof(arg->name), "%s", name);
+
+    worker_job_t *job = &jobs[*count];
+    worker_job_init(job, name, run_test_job, arg);
+    worker_job_add_resource(job, resource);
+    if (extra_resource) {
+        worker_job_add_resource(job, extra_resource);
+    }
+    (*count)++;
+    return arg;
+}
+
+// Devices a subsystem fans out over: every enumerated one with
+// --all-devices, otherwise just --device
+static uint32_t get_job_device_count(const cmd_options_t *options, subsystem_type_t subsystem) {
+    uint32_t count = 0;
+
+    if (!options->all_devices) {
+        return 0;
+    }
+    if (subsystem == SUBSYSTEM_AUDIO && init_audio_test_framework()) {
+        count = get_audio_device_count(AUDIO_DEVICE_BOTH);
+        cleanup_audio_test_framework();
+    } else if (subsystem == SUBSYSTEM_VIDEO && init_video_test_framework()) {
+        count = get_video_device_count(VIDEO_DEVICE_MAX);
+        cleanup_video_test_framework();
+    }
+    return count;
+}
+
+// Present USB devices, copied once so every job keeps the device it was
+// built for however discovery renumbers its slots between jobs
+static uint32_t snapshot_usb_devices(usb_device_entry_t *entries, uint32_t max) {
+    uint32_t count = 0;
+    if (!usb_test_init()) {
+        return 0;
+    }
+    uint32_t slots = usb_discovery_count();
+    for (uint32_t i = 0; i < slots && count < max; i++) {
+        if (usb_discovery_get(i, &entries[count])) {
+            count++;
+        }
+    }
+    usb_test_cleanup();
+    return count;
+}
+
+// Each job names the device nodes it holds, so only tests that would fight
+// over the same node are serialised
+static uint32_t build_test_jobs(const cmd_options_t *options, worker_job_t *jobs, test_job_t *args) {
+    uint32_t count = 0;
+    subsystem_type_t subsystem = options->subsystem;
+    bool all = subsystem == SUBSYSTEM_ALL;
+    char name[64];
+    char resource[32];
+
+    if (subsystem > SUBSYSTEM_ALL) {
+        return 0;
+    }
+
+    if (all || subsystem == SUBSYSTEM_DRM) {
+        add_test_job(jobs, args, &count, "DRM", run_drm_tests, options, options->device_index, "drm:0", NULL);
+    }
+
+    if (all || subsystem == SUBSYSTEM_AUDIO) {
+        uint32_t devices = get_job_device_count(options, SUBSYSTEM_AUDIO);
+        uint32_t first = devices ? 0 : options->device_index;
+        uint32_t last = devices ? devices - 1 : options->device_index;
+        for (uint32_t i = first; i <= last; i++) {
+            snprintf(name, sizeof(name), "Audio hw:%u", i);
+            snprintf(resource, sizeof(resource), "audio:%u", i);
+            add_test_job(jobs, args, &count, name, run_audio_tests, options, i, resource, NULL);
+        }
+    }
+
+    if (all || subsystem == SUBSYSTEM_VIDEO) {
+        uint32_t devices = get_job_device_count(options, SUBSYSTEM_VIDEO);
+        uint32_t first = devices ? 0 : options->device_index;
+        uint32_t last = devices ? devices - 1 : options->device_index;
+        for (uint32_t i = first; i <= last; i++) {
+            snprintf(name, sizeof(name), "Video /dev/video%u", i);
+            snprintf(resource, sizeof(resource), "video:%u", i);
+            add_test_job(jobs, args, &count, name, run_video_tests, options, i, resource, NULL);
+        }
+#ifdef _ENABLE_DRM
+        for (uint32_t i = first; i <= last; i++) {
+            snprintf(name, sizeof(name), "Zero-Copy /dev/video%u", i);
+            snprintf(resource, sizeof(resource), "video:%u", i);
+            add_test_job(jobs, args, &count, name, run_video_zero_copy_tests, options, i, resource, "drm:0");
+        }
+#endif
+    }
+
+    if (all || subsystem == SUBSYSTEM_USB) {
+        usb_device_entry_t entries[USB_DISCOVERY_MAX_DEVICES];
+        uint32_t devices = options->all_devices ? snapshot_usb_devices(entries, USB_DISCOVERY_MAX_DEVICES) : 0;
+        if (devices == 0) {
+            add_test_job(jobs, args, &count, "USB", run_usb_tests, options, options->device_index, "usb", NULL);
+        }
+        for (uint32_t i = 0; i < devices; i++) {
+            const usb_device_entry_t *entry = &entries[i];
+            snprintf(name, sizeof(name), "USB %04x:%04x at %s", entry->vendor_id, entry->product_id,
+                     entry->port_path);
+            snprintf(resource, sizeof(resource), "usb:%u-%u", entry->bus, entry->address);
+            // Streaming jobs share one key so their transfers never overlap
+            bool streams = usb_device_has_class(entry, USB_CLASS_HID) ||
+                           usb_device_has_class(entry, USB_CLASS_AUDIO) ||
+                           usb_device_has_class(entry, USB_CLASS_WIRELESS);
+            test_job_t *arg = add_test_job(jobs, args, &count, name, run_usb_tests, options, i, resource,
+                                           streams ? "usb:transfer" : NULL);
+            if (arg) {
+                arg->usb_device = *entry;
+                arg->options.usb_device = &arg->usb_device;
+            }
+        }
+    }
+
+#ifdef _ENABLE_STRESS
+    // Owns every device, and wants the rest of the machine quiet too
+    if (subsystem == SUBSYSTEM_STRESS) {
+        add_test_job(jobs, args, &count, "Stress", run_stress_tests, options, options->device_index,
+                     WORKER_RESOURCE_ALL, NULL);
+    }
+#endif
+
+    return count;
+}
+
+// Recorded against replayed latency per operation, and the pace of the
+// whole trace both times
+static void print_replay_metrics(const trace_replay_stats_t *stats) {
+    char started[32] = "unknown time";
+    struct tm tm;
+    if (stats->start_time && localtime_r(&stats->start_time, &tm)) {
+        strftime(started, sizeof(started), "%Y-%m-%d %H:%M:%S", &tm);
+    }
+    printf("\n--- Replay of %s recorded %s (%s speed) ---\n", stats->device[0] ? stats->device : "unknown board",
+           started, stats->speed == TRACE_SPEED_MAX ? "max" : "recorded");
+    printf("%-18s %8s %7s %8s %21s %21s %8s\n", "Operation", "Count", "Failed", "Skipped",
+           "Recorded p50/p99 us", "Replayed p50/p99 us", "p50");
+
+    uint64_t operations = 0, replayed = 0, bytes = 0;
+    for (int op = 0; op < TRACE_MAX_OPS; op++) {
+        const trace_op_stats_t *entry = stats->ops[op];
+        if (!entry) {
+            continue;
+        }
+        const char *name = trace_op_to_string((trace_op_t)op);
+        report_distribution_t recorded, actual;
+        report_histogram_summarize(&entry->recorded, REPORT_HISTOGRAM_UNIT_NS, &recorded);
+        report_histogram_summarize(&entry->replayed, REPORT_HISTOGRAM_UNIT_NS, &actual);
+        operations += entry->count;
+        replayed += actual.count;
+        bytes += entry->bytes;
+
+        printf("%-18s %8llu %7llu %8llu %10.1f/%-10.1f", name, (unsigned long long)entry->count,
+               (unsigned long long)entry->failed, (unsigned long long)entry->skipped, recorded.p50, recorded.p99);
+        if (actual.count == 0) {
+            printf(" %21s %8s\n", "-", "-");
+            continue;
+        }
+        double change = recorded.p50 > 0.0 ? (actual.p50 - recorded.p50) / recorded.p50 * 100.0 : 0.0;
+        printf(" %10.1f/%-10.1f %+7.1f%%\n", actual.p50, actual.p99, change);
+
+        if (g_report) {
+            char metric[160];
+            snprintf(metric, sizeof(metric), "Replay %s Latency", name);
+            report_add_histogram_metric(g_report, metric, &entry->replayed);
+            snprintf(metric, sizeof(metric), "Replay %s Recorded Latency", name);
+            report_add_histogram_metric(g_report, metric, &entry->recorded);
+            snprintf(metric, sizeof(metric), "Replay %s p50 Change", name);
+            report_add_metric(g_report, metric, METRIC_COUNT, change, "%");
+            snprintf(metric, sizeof(metric), "Replay %s Failures", name);
+            report_add_count_metric(g_report, metric, entry->failed);
+        }
+    }
+
+    double recorded_s = stats->recorded_ns / 1e9;
+    double replayed_s = stats->replayed_ns / 1e9;
+    double recorded_rate = recorded_s > 0.0 ? operations / recorded_s : 0.0;
+    double replayed_rate = replayed_s > 0.0 ? replayed / replayed_s : 0.0;
+    printf("Recorded: %llu operations in %.3f s (%.0f ops/s)\n", (unsigned long long)operations, recorded_s,
+           recorded_rate);
+    printf("Replayed: %llu operations in %.3f s (%.0f ops/s, %.1f MB/s of payload)\n", (unsigned long long)replayed,
+           replayed_s, replayed_rate, replayed_s > 0.0 ? bytes / replayed_s / 1e6 : 0.0);
+    if (stats->speed == TRACE_SPEED_RECORDED) {
+        printf("Issued late: %llu (max lag %.3f ms)\n", (unsigned long long)stats->late, stats->max_lag_ns / 1e6);
+    }
+    printf("Recorded results: %u of %u passed over %u jobs\n", stats->passed, stats->results, stats->jobs);
+
+    if (g_report) {
+        report_set_property(g_report, "Replay Source", stats->device);
+        report_set_property(g_report, "Replay Speed", stats->speed == TRACE_SPEED_MAX ? "max" : "recorded");
+        report_add_metric(g_report, "Replay Recorded Rate", METRIC_COUNT, recorded_rate, "ops/s");
+        report_add_metric(g_report, "Replay Rate", METRIC_COUNT, replayed_rate, "ops/s");
+        if (replayed_s > 0.0) {
+            report_add_throughput_metric(g_report, "Replay Payload Throughput", bytes / replayed_s);
+        }
+        if (stats->speed == TRACE_SPEED_RECORDED) {
+            report_add_count_metric(g_report, "Replay Late Operations", stats->late);
+        }
+    }
+}
+
+// Hands each subsystem's operations to its replayer; anything built
+// without one is counted as skipped
+static bool run_replay(const cmd_options_t *options) {
+#ifdef _ENABLE_DRM
+    trace_replayer_t drm = { .replay = drm_trace_replay, .finish = drm_trace_finish };
+    trace_set_replayer(TRACE_CLASS_DRM, &drm);
+#endif
+    trace_replayer_t video = { .replay = video_m2m_trace_replay, .finish = video_m2m_trace_finish };
+    trace_set_replayer(TRACE_CLASS_VIDEO, &video);
+    trace_replayer_t audio = { .replay = audio_trace_replay, .finish = audio_trace_finish };
+    trace_set_replayer(TRACE_CLASS_AUDIO, &audio);
+
+    trace_replay_stats_t stats;
+    if (!trace_replay(options->replay_file, options->replay_speed, &stats)) {
+        return false;
+    }
+    print_replay_metrics(&stats);
+    trace_replay_stats_free(&stats);
+    return !stats.truncated;
+}
+
 int main(int argc, char *argv[]) {
     // Parse command line options
     cmd_options_t options = parse_options(argc, argv);
@@ -605,44 +2057,102 @@ int main(int argc, char *argv[]) {
         snprintf(title, sizeof(title), "Tizen Vendor Test Suite - %s", 
                 get_subsystem_name(options.subsystem));
                 
-        report_config_t report_config = {
-            .format = options.report_format,
-            .filename = options.report_file,
-            .append = options.report_append
-        };
+        report_config_t report_config;
+        memset(&report_config, 0, sizeof(report_config));
+        strncpy(report_config.report_file, options.report_file, sizeof(report_config.report_file) - 1);
+        report_config.format = options.report_format;
+        report_config.append = options.report_append;
+        report_config.include_timestamp = true;
+        report_config.include_system_info = true;
+        report_config.include_performance_metrics = true;
+        report_config.min_level = REPORT_LEVEL_INFO;
         
         g_report = report_create(title, "Automated test execution results", &report_config);
     }
     
-    // Run tests based on subsystem
-    switch (options.subsystem) {
-        case SUBSYSTEM_DRM:
-            run_drm_tests(&options);
-            break;
-            
-        case SUBSYSTEM_AUDIO:
-            run_audio_tests(&options);
-            break;
-            
-        case SUBSYSTEM_VIDEO:
-            run_video_tests(&options);
-            break;
-            
-        case SUBSYSTEM_USB:
-            run_usb_tests(&options);
-            break;
-            
-        case SUBSYSTEM_ALL:
-            run_drm_tests(&options);
-            run_audio_tests(&options);
-            run_video_tests(&options);
-            run_usb_tests(&options);
-            break;
-            
-        default:
-            fprintf(stderr, "Unknown subsystem\n");
-            return 1;
+    // Streaming threads fault nothing in once they are running
+    if (options.rt.lock_memory) {
+        rt_lock_memory();
+    }
+    
+    if (g_report) {
+        char description[128];
+        if (rt_config_active(&options.rt)) {
+            rt_config_describe(&options.rt, description, sizeof(description));
+        } else {
+            snprintf(description, sizeof(description), "%s (main thread)", rt_policy_to_string(RT_POLICY_OTHER));
+        }
+        report_set_property(g_report, "Streaming Scheduling Requested", description);
+        report_set_property(g_report, "Streaming Scheduling", description);
+    }
+    
+    // Loaded before --all-devices enumeration can probe anything
+    if (options.cap_cache && !cap_cache_open(options.cap_cache)) {
+        fprintf(stderr, "Capability cache disabled\n");
+    }
+    
+    // Run tests based on subsystem, or the operations of a recorded run
+    worker_job_t jobs[MAX_TEST_JOBS];
+    test_job_t job_args[MAX_TEST_JOBS];
+    uint32_t job_count = options.replay_file ? 0 : build_test_jobs(&options, jobs, job_args);
+    if (job_count == 0 && !options.replay_file) {
+        fprintf(stderr, "Unknown subsystem\n");
+        return 1;
     }
+    
+    // Shared lazy state is settled before any worker can race for it
+    pattern_init();
+    
+    // The exporter has to be up before the workloads register their metrics
+    if (options.live.listen[0] || options.live.snapshot_file[0]) {
+        if (report_live_start(&options.live)) {
+            if (options.live.listen[0]) {
+                printf("Serving live metrics on %s\n", options.live.listen);
+            }
+            if (g_report) {
+                report_set_property(g_report, "Live Metrics",
+                                    options.live.listen[0] ? options.live.listen : options.live.snapshot_file);
+            }
+        } else {
+            fprintf(stderr, "Live metrics disabled\n");
+        }
+    }
+    
+    if (options.record_file) {
+        if (trace_record_start(options.record_file)) {
+            printf("Recording trace to %s\n", options.record_file);
+        } else {
+            fprintf(stderr, "Trace recording disabled\n");
+        }
+    }
+    
+    bool replay_failed = false;
+    uint32_t workers = options.jobs ? options.jobs : worker_default_count();
+    if (options.replay_file) {
+        replay_failed = !run_replay(&options);
+    } else {
+        if (workers > 1) {
+            printf("Running %u test jobs on up to %u workers\n", job_count, workers);
+        }
+        
+        worker_pool_run(jobs, job_count, workers);
+        
+        if (workers > 1) {
+            printf("\n--- Job Durations ---\n");
+            for (uint32_t i = 0; i < job_count; i++) {
+                printf("%s: %u ms\n", jobs[i].name, jobs[i].duration_ms);
+            }
+        }
+    }
+    
+    // Everything recorded is on disk before the report is written
+    trace_record_stop();
+
+    // Writes the final snapshot
+    report_live_stop();
+    
+    // Keeps what this run probed for the next one
+    cap_cache_close();
 
     printf("\nTests completed\n");
 
@@ -666,5 +2176,5 @@ int main(int argc, char *argv[]) {
         g_report = NULL;
     }
 
-    return 0;
+    return replay_failed ? 1 : 0;
 }
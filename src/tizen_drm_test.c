@@ -1,4 +1,12 @@
 #include "tizen_drm_test.h"
+#include "drm/drm_buffer_pool.h"
+#include "drm/drm_buffer_layout.h"
+#include "drm/drm_topology.h"
+#include "drm/drm_device.h"
+#include "drm/drm_fence.h"
+#include "report/report_live.h"
+#include "common/map_bandwidth.h"
+#include "common/sweep.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,362 +16,376 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <xf86drmMode.h>
 #include <xf86drm.h>
 
-static int drm_fd = -1;
-static drmModeRes *resources = NULL;
-static drmModeConnector *connector = NULL;
-static drmModeCrtc *crtc = NULL;
-static drmModePlaneRes *plane_resources = NULL;
-static drmModePlane *primary_plane = NULL;
-static drmModePlane *overlay_plane = NULL;
-static drmModePlane *cursor_plane = NULL;
-static uint32_t *format_list = NULL;
-static uint32_t format_count = 0;
-static uint32_t *compression_list = NULL;
-static uint32_t compression_count = 0;
-static uint64_t *modifier_list = NULL;
-static uint32_t modifier_count = 0;
+// KMS tests run on the display device, and buffers are created on it
+// unless another device is named. Its topology is discovered once at
+// init; nothing below re-enumerates or looks up properties by name.
+static drm_device_t display = { .fd = -1 };
+static drm_topology_connector_t *connector = NULL;
+static drm_topology_crtc_t *crtc = NULL;
+static drm_topology_plane_t *primary_plane = NULL;
+static drm_topology_plane_t *overlay_plane = NULL;
+static drm_topology_plane_t *cursor_plane = NULL;
+static drm_format_set_t display_formats;     // Union over the test CRTC's planes
 
 // Helper functions
-static bool is_format_supported(uint32_t format) {
-    for (uint32_t i = 0; i < format_count; i++) {
-        if (format_list[i] == format) {
-            return true;
-        }
-    }
-    return false;
+static bool is_layout_displayable(uint32_t format, uint64_t modifier) {
+    return drm_format_set_has(&display_formats, format, modifier);
 }
 
-static bool is_compression_supported(uint32_t compression) {
-    for (uint32_t i = 0; i < compression_count; i++) {
-        if (compression_list[i] == compression) {
-            return true;
-        }
+static drm_topology_plane_t *plane_for_type(uint32_t type) {
+    switch (type) {
+        case DRM_PLANE_TYPE_PRIMARY: return primary_plane;
+        case DRM_PLANE_TYPE_OVERLAY: return overlay_plane;
+        case DRM_PLANE_TYPE_CURSOR: return cursor_plane;
+        default: return NULL;
     }
-    return false;
 }
 
-static bool is_modifier_supported(uint64_t modifier) {
-    for (uint32_t i = 0; i < modifier_count; i++) {
-        if (modifier_list[i] == modifier) {
-            return true;
-        }
-    }
-    return false;
-}
+// Plane state written by a full commit
+static const drm_prop_t plane_state_props[] = {
+    DRM_PROP_FB_ID, DRM_PROP_CRTC_ID, DRM_PROP_SRC_X, DRM_PROP_SRC_Y, DRM_PROP_SRC_W, DRM_PROP_SRC_H,
+    DRM_PROP_CRTC_X, DRM_PROP_CRTC_Y, DRM_PROP_CRTC_W, DRM_PROP_CRTC_H
+};
 
-static bool get_plane_by_type(uint32_t type, drmModePlane **plane) {
-    if (!plane_resources) {
-        plane_resources = drmModeGetPlaneResources(drm_fd);
-        if (!plane_resources) {
+static bool has_plane_props(const drm_topology_plane_t *plane) {
+    for (size_t i = 0; i < sizeof(plane_state_props) / sizeof(plane_state_props[0]); i++) {
+        if (!plane->props.ids[plane_state_props[i]]) {
             return false;
         }
     }
-
-    for (uint32_t i = 0; i < plane_resources->count_planes; i++) {
-        drmModePlane *p = drmModeGetPlane(drm_fd, plane_resources->planes[i]);
-        if (p && p->type == type) {
-            *plane = p;
-            return true;
-        }
-        drmModeFreePlane(p);
-    }
-    return false;
-}
-
-static bool get_format_list(void) {
-    if (format_list) {
-        free(format_list);
-    }
-    format_count = 0;
-
-    // Get supported formats from DRM
-    drmModeConnector *conn = drmModeGetConnector(drm_fd, connector->connector_id);
-    if (!conn) {
-        return false;
-    }
-
-    format_count = conn->count_formats;
-    format_list = malloc(sizeof(uint32_t) * format_count);
-    if (!format_list) {
-        drmModeFreeConnector(conn);
-        return false;
-    }
-
-    memcpy(format_list, conn->formats, sizeof(uint32_t) * format_count);
-    drmModeFreeConnector(conn);
     return true;
 }
 
-static bool get_compression_list(void) {
-    if (compression_list) {
-        free(compression_list);
-    }
-    compression_count = 0;
-
-    // Get supported compression formats
-    drmModeConnector *conn = drmModeGetConnector(drm_fd, connector->connector_id);
-    if (!conn) {
-        return false;
-    }
-
-    compression_count = conn->count_encoders;
-    compression_list = malloc(sizeof(uint32_t) * compression_count);
-    if (!compression_list) {
-        drmModeFreeConnector(conn);
-        return false;
-    }
-
-    // TODO: Get actual compression support from DRM
-    compression_list[0] = DRM_COMPRESSION_NONE;
-    compression_list[1] = DRM_COMPRESSION_ETC1;
-    compression_list[2] = DRM_COMPRESSION_ETC2;
-    compression_list[3] = DRM_COMPRESSION_ASTC;
-    compression_list[4] = DRM_COMPRESSION_BC1;
-    drmModeFreeConnector(conn);
-    return true;
+static void add_plane_state(drmModeAtomicReq *req, const drm_topology_plane_t *plane, uint32_t fb_id,
+                            uint32_t src_w, uint32_t src_h, uint32_t crtc_x, uint32_t crtc_y,
+                            uint32_t crtc_w, uint32_t crtc_h) {
+    const drm_object_props_t *props = &plane->props;
+    drm_atomic_add(req, plane->id, props, DRM_PROP_FB_ID, fb_id);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_CRTC_ID, crtc->id);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_SRC_X, 0);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_SRC_Y, 0);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_SRC_W, (uint64_t)src_w << 16);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_SRC_H, (uint64_t)src_h << 16);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_CRTC_X, crtc_x);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_CRTC_Y, crtc_y);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_CRTC_W, crtc_w);
+    drm_atomic_add(req, plane->id, props, DRM_PROP_CRTC_H, crtc_h);
 }
 
-static bool get_modifier_list(void) {
-    if (modifier_list) {
-        free(modifier_list);
+static int commit_plane_fb(const drm_topology_plane_t *plane, uint32_t fb_id,
+                           uint32_t src_w, uint32_t src_h, uint32_t crtc_w, uint32_t crtc_h,
+                           bool full_state, uint32_t flags, void *user_data) {
+    drmModeAtomicReq *req = drmModeAtomicAlloc();
+    if (!req) {
+        return -ENOMEM;
     }
-    modifier_count = 0;
 
-    // Get supported modifiers from DRM
-    drmModeConnector *conn = drmModeGetConnector(drm_fd, connector->connector_id);
-    if (!conn) {
-        return false;
+    if (full_state) {
+        add_plane_state(req, plane, fb_id, src_w, src_h, 0, 0, crtc_w, crtc_h);
+    } else {
+        drm_atomic_add(req, plane->id, &plane->props, DRM_PROP_FB_ID, fb_id);
     }
 
-    modifier_count = conn->count_encoders;
-    modifier_list = malloc(sizeof(uint64_t) * modifier_count);
-    if (!modifier_list) {
-        drmModeFreeConnector(conn);
-        return false;
+    uint64_t start = trace_begin();
+    int ret = drmModeAtomicCommit(display.fd, req, flags, user_data);
+    drmModeAtomicFree(req);
+    if (start) {
+        uint64_t args[] = { plane->type, fb_id == crtc->buffer_id ? 0 : fb_id, src_w, src_h,
+                            crtc_w, crtc_h, full_state, flags, ret == 0 };
+        trace_record(TRACE_OP_DRM_COMMIT, start, args, TRACE_ARGC(args), NULL, 0);
     }
-
-    // TODO: Get actual modifier support from DRM
-    modifier_list[0] = DRM_MODIFIER_LINEAR;
-    modifier_list[1] = DRM_MODIFIER_TILED;
-    modifier_list[2] = DRM_MODIFIER_X_TILED;
-    modifier_list[3] = DRM_MODIFIER_Y_TILED;
-    modifier_list[4] = DRM_MODIFIER_XY_TILED;
-    drmModeFreeConnector(conn);
-    return true;
+    return ret;
 }
 
 bool init_test_framework(void) {
     // Open DRM device
-    drm_fd = open("/dev/dri/card0", O_RDWR);
-    if (drm_fd < 0) {
-        perror("Failed to open DRM device");
+    if (!drm_device_open(&display, "/dev/dri/card0")) {
         return false;
     }
 
-    // Get DRM resources
-    resources = drmModeGetResources(drm_fd);
-    if (!resources) {
-        perror("Failed to get DRM resources");
-        close(drm_fd);
+    // Atomic commits need the atomic and universal plane client caps
+    if (!display.atomic) {
+        fprintf(stderr, "DRM device does not support atomic modesetting\n");
+        drm_device_close(&display);
         return false;
     }
 
-    // Find a connected connector
-    for (int i = 0; i < resources->count_connectors; i++) {
-        connector = drmModeGetConnector(drm_fd, resources->connectors[i]);
-        if (connector && connector->connection == DRM_MODE_CONNECTED) {
-            break;
+    // Connectors, CRTCs, planes, their property IDs and format lists
+    if (!display.kms) {
+        fprintf(stderr, "DRM device has no display pipeline\n");
+        drm_device_close(&display);
+        return false;
+    }
+
+    // Find a connected connector, preferring one that is being driven
+    for (uint32_t i = 0; i < display.topology.connector_count && !crtc; i++) {
+        drm_topology_connector_t *c = &display.topology.connectors[i];
+        if (c->connection != DRM_MODE_CONNECTED) {
+            continue;
+        }
+        if (!connector) {
+            connector = c;
+        }
+        if (c->crtc_id) {
+            crtc = drm_topology_find_crtc(&display.topology, c->crtc_id);
+            if (crtc) {
+                connector = c;
+            }
         }
-        drmModeFreeConnector(connector);
     }
 
     if (!connector) {
         fprintf(stderr, "No connected display found\n");
-        drmModeFreeResources(resources);
-        close(drm_fd);
+        cleanup_test_framework();
         return false;
     }
 
-    // Find a CRTC
-    for (int i = 0; i < resources->count_crtcs; i++) {
-        if (connector->crtc_id == resources->crtcs[i]) {
-            crtc = drmModeGetCrtc(drm_fd, resources->crtcs[i]);
-            break;
-        }
-    }
-
     if (!crtc) {
         fprintf(stderr, "No CRTC found\n");
-        drmModeFreeConnector(connector);
-        drmModeFreeResources(resources);
-        close(drm_fd);
-        return false;
-    }
-
-    // Get plane resources
-    plane_resources = drmModeGetPlaneResources(drm_fd);
-    if (!plane_resources) {
-        fprintf(stderr, "Failed to get plane resources\n");
         cleanup_test_framework();
         return false;
     }
 
     // Get primary plane
-    if (!get_plane_by_type(DRM_PLANE_TYPE_PRIMARY, &primary_plane)) {
+    primary_plane = drm_topology_find_plane_for_crtc(&display.topology, crtc->index, DRM_PLANE_TYPE_PRIMARY);
+    if (!primary_plane) {
         fprintf(stderr, "Failed to get primary plane\n");
         cleanup_test_framework();
         return false;
     }
 
     // Get overlay plane
-    if (!get_plane_by_type(DRM_PLANE_TYPE_OVERLAY, &overlay_plane)) {
+    overlay_plane = drm_topology_find_plane_for_crtc(&display.topology, crtc->index, DRM_PLANE_TYPE_OVERLAY);
+    if (!overlay_plane) {
         fprintf(stderr, "Failed to get overlay plane\n");
         cleanup_test_framework();
         return false;
     }
 
     // Get cursor plane
-    if (!get_plane_by_type(DRM_PLANE_TYPE_CURSOR, &cursor_plane)) {
+    cursor_plane = drm_topology_find_plane_for_crtc(&display.topology, crtc->index, DRM_PLANE_TYPE_CURSOR);
+    if (!cursor_plane) {
         fprintf(stderr, "Failed to get cursor plane\n");
         cleanup_test_framework();
         return false;
     }
 
-    // Get supported formats
-    if (!get_format_list()) {
-        fprintf(stderr, "Failed to get supported formats\n");
-        cleanup_test_framework();
-        return false;
-    }
-
-    // Get supported compression formats
-    if (!get_compression_list()) {
-        fprintf(stderr, "Failed to get supported compression formats\n");
-        cleanup_test_framework();
-        return false;
-    }
-
-    // Get supported modifiers
-    if (!get_modifier_list()) {
-        fprintf(stderr, "Failed to get supported modifiers\n");
-        cleanup_test_framework();
-        return false;
+    // Get supported format x modifier pairs
+    for (uint32_t i = 0; i < display.topology.plane_count; i++) {
+        const drm_topology_plane_t *plane = &display.topology.planes[i];
+        if ((plane->possible_crtcs & (1u << crtc->index)) &&
+            !drm_format_set_merge(&display_formats, &plane->formats)) {
+            fprintf(stderr, "Failed to get supported formats\n");
+            cleanup_test_framework();
+            return false;
+        }
     }
 
     return true;
 }
 
 void cleanup_test_framework(void) {
-    if (primary_plane) {
-        drmModeFreePlane(primary_plane);
-    }
-    if (overlay_plane) {
-        drmModeFreePlane(overlay_plane);
-    }
-    if (cursor_plane) {
-        drmModeFreePlane(cursor_plane);
-    }
-    if (plane_resources) {
-        drmModeFreePlaneResources(plane_resources);
-    }
-    if (format_list) {
-        free(format_list);
-    }
-    if (compression_list) {
-        free(compression_list);
-    }
-    if (modifier_list) {
-        free(modifier_list);
-    }
-    if (crtc) {
-        drmModeFreeCrtc(crtc);
-    }
-    if (connector) {
-        drmModeFreeConnector(connector);
-    }
-    if (resources) {
-        drmModeFreeResources(resources);
-    }
-    if (drm_fd >= 0) {
-        close(drm_fd);
-    }
+    // Pooled buffers hold GEM handles and mappings on the display device
+    drm_buffer_pool_trim();
+
+    drm_format_set_free(&display_formats);
+    connector = NULL;
+    crtc = NULL;
+    primary_plane = NULL;
+    overlay_plane = NULL;
+    cursor_plane = NULL;
+    drm_device_close(&display);
+}
+
+struct drm_device *drm_get_display_device(void) {
+    return &display;
 }
 
 drm_buffer_t *create_drm_buffer(const test_config_t *config) {
+    return create_drm_buffer_on(&display, config);
+}
+
+drm_buffer_t *create_drm_buffer_on(drm_device_t *device, const test_config_t *config) {
+    if (!device || !device->dumb) {
+        return NULL;
+    }
+    uint64_t start = device == &display ? trace_begin() : 0;
+
     drm_buffer_t *buf = malloc(sizeof(drm_buffer_t));
     if (!buf) {
         return NULL;
     }
 
     memset(buf, 0, sizeof(drm_buffer_t));
+    buf->device = device;
     buf->width = config->width;
     buf->height = config->height;
     buf->format = config->format;
     buf->modifier = config->modifier;
     buf->compression = config->compression;
 
-    // Create GEM buffer
-    uint32_t handle;
-    if (drmPrimeFDToHandle(drm_fd, -1, &handle) < 0) {
+    // Dumb buffers are allocated in plane-0 rows; the other planes follow
+    // it inside the same object, as with modetest
+    drm_buffer_layout_t layout;
+    if (!drm_buffer_layout_init(&layout, config->format, config->modifier, config->width, config->height, 0)) {
         free(buf);
         return NULL;
     }
-    buf->handle = handle;
+    uint32_t cpp = drm_format_cpp(config->format, 0);
 
-    // Get buffer size
-    uint64_t size;
-    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_GETFB2, &size) < 0) {
-        drmDestroyPropertyBlob(drm_fd, handle);
+    // Create GEM buffer
+    struct drm_mode_create_dumb create = {
+        .width = layout.pitches[0] / cpp,
+        .height = (layout.size + layout.pitches[0] - 1) / layout.pitches[0],
+        .bpp = cpp * 8
+    };
+    if (drmIoctl(device->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+        perror("Failed to create dumb buffer");
         free(buf);
         return NULL;
     }
-    buf->size = size;
+    buf->handle = create.handle;
+    buf->size = create.size;
+
+    // Re-derive the layout from the pitch the driver chose
+    if (!drm_buffer_layout_init(&buf->layout, config->format, config->modifier,
+                                config->width, config->height, create.pitch) ||
+        buf->layout.size > buf->size) {
+        fprintf(stderr, "Dumb buffer (pitch %u, %u bytes) cannot hold the layout\n", create.pitch, buf->size);
+        destroy_drm_buffer(buf);
+        return NULL;
+    }
+    buf->pitch = buf->layout.pitches[0];
 
     // Map buffer
-    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, 0);
+    struct drm_mode_map_dumb map = { .handle = buf->handle };
+    if (drmIoctl(device->fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+        perror("Failed to prepare dumb buffer mapping");
+        destroy_drm_buffer(buf);
+        return NULL;
+    }
+
+    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, device->fd, map.offset);
     if (buf->map == MAP_FAILED) {
-        drmDestroyPropertyBlob(drm_fd, handle);
-        free(buf);
+        perror("Failed to map dumb buffer");
+        buf->map = NULL;
+        destroy_drm_buffer(buf);
         return NULL;
     }
 
+    if (start) {
+        buf->trace_id = trace_next_id();
+        uint64_t args[] = { buf->trace_id, buf->width, buf->height, buf->format, buf->modifier, buf->compression };
+        trace_record(TRACE_OP_DRM_CREATE, start, args, TRACE_ARGC(args), NULL, 0);
+    }
     return buf;
 }
 
 void destroy_drm_buffer(drm_buffer_t *buf) {
+    if (!buf) {
+        return;
+    }
+    uint64_t start = buf->trace_id ? trace_begin() : 0;
     if (buf->map) {
         munmap(buf->map, buf->size);
     }
-    if (buf->handle > 0) {
-        drmDestroyPropertyBlob(drm_fd, buf->handle);
+    if (buf->fb_id) {
+        drmModeRmFB(buf->device->fd, buf->fb_id);
+    }
+    // GEM handles are per file and not refcounted per import: re-importing
+    // one of our own dumb buffers on its file hands back the creator's
+    // handle, which must outlive this buffer. Imports of anyone else's
+    // object own their handle and go through destroy_foreign_import().
+    if (buf->handle > 0 && !buf->imported) {
+        struct drm_mode_destroy_dumb destroy = { .handle = buf->handle };
+        drmIoctl(buf->device->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    }
+    if (start) {
+        uint64_t args[] = { buf->trace_id };
+        trace_record(TRACE_OP_DRM_DESTROY, start, args, TRACE_ARGC(args), NULL, 0);
     }
     free(buf);
 }
 
-bool fill_drm_buffer(drm_buffer_t *buf, uint32_t color) {
-    if (!buf || !buf->map) {
+// A handle imported from another device or driver is that file's own
+// reference to the object, unlike a same-file import, so it is closed with
+// the buffer
+void destroy_foreign_import(drm_buffer_t *buf) {
+    if (!buf) {
+        return;
+    }
+    if (buf->handle) {
+        struct drm_gem_close gem_close = { .handle = buf->handle };
+        drmIoctl(buf->device->fd, DRM_IOCTL_GEM_CLOSE, &gem_close);
+    }
+    destroy_drm_buffer(buf);
+}
+
+bool add_drm_framebuffer(drm_buffer_t *buf) {
+    if (!buf || !buf->handle) {
+        return false;
+    }
+    if (buf->fb_id) {
+        return true;
+    }
+
+    uint64_t start = buf->trace_id ? trace_begin() : 0;
+    uint32_t handles[4] = { 0 };
+    uint64_t modifiers[4] = { 0 };
+    for (uint32_t p = 0; p < buf->layout.num_planes; p++) {
+        handles[p] = buf->handle;
+        modifiers[p] = buf->layout.modifier;
+    }
+
+    int ret;
+    if (buf->layout.modifier != DRM_FORMAT_MOD_LINEAR) {
+        ret = drmModeAddFB2WithModifiers(buf->device->fd, buf->width, buf->height, buf->format, handles,
+                                         buf->layout.pitches, buf->layout.offsets, modifiers,
+                                         &buf->fb_id, DRM_MODE_FB_MODIFIERS);
+    } else {
+        ret = drmModeAddFB2(buf->device->fd, buf->width, buf->height, buf->format, handles,
+                            buf->layout.pitches, buf->layout.offsets, &buf->fb_id, 0);
+    }
+    if (ret < 0) {
+        perror("Failed to add framebuffer");
+        buf->fb_id = 0;
         return false;
     }
 
-    uint32_t *data = (uint32_t *)buf->map;
-    for (uint32_t i = 0; i < (buf->width * buf->height); i++) {
-        data[i] = color;
+    if (start) {
+        uint64_t args[] = { buf->trace_id, buf->fb_id };
+        trace_record(TRACE_OP_DRM_FRAMEBUFFER, start, args, TRACE_ARGC(args), NULL, 0);
     }
+    return true;
+}
 
+// Buffers without a layout (raw imports) or whose layout overruns the
+// object cannot be walked
+static bool has_valid_layout(const drm_buffer_t *buf) {
+    if (!buf || !buf->map || buf->layout.num_planes == 0) {
+        return false;
+    }
+    if (buf->layout.size > buf->size) {
+        fprintf(stderr, "Buffer layout (%u bytes) exceeds object size (%u bytes)\n", buf->layout.size, buf->size);
+        return false;
+    }
     return true;
 }
 
-bool verify_drm_buffer(drm_buffer_t *buf, uint32_t expected_color) {
-    if (!buf || !buf->map) {
+static bool fill_planes(drm_buffer_t *buf, const test_pattern_t *patterns, bool per_plane) {
+    if (!has_valid_layout(buf)) {
         return false;
     }
 
-    uint32_t *data = (uint32_t *)buf->map;
-    for (uint32_t i = 0; i < (buf->width * buf->height); i++) {
-        if (data[i] != expected_color) {
+    // Dumb buffer mappings are usually write-combined, so stream the stores
+    for (uint32_t p = 0; p < buf->layout.num_planes; p++) {
+        if (!drm_buffer_layout_fill(buf->map, &buf->layout, p, &patterns[per_plane ? p : 0],
+                                    PATTERN_FLAG_NONTEMPORAL)) {
             return false;
         }
     }
@@ -371,6 +393,71 @@ bool verify_drm_buffer(drm_buffer_t *buf, uint32_t expected_color) {
     return true;
 }
 
+static bool verify_planes(drm_buffer_t *buf, const test_pattern_t *patterns, bool per_plane) {
+    if (!has_valid_layout(buf)) {
+        return false;
+    }
+
+    for (uint32_t p = 0; p < buf->layout.num_planes; p++) {
+        const test_pattern_t *pattern = &patterns[per_plane ? p : 0];
+        uint32_t x = 0, y = 0;
+        if (!drm_buffer_layout_verify(buf->map, &buf->layout, p, pattern, PATTERN_FLAG_NONTEMPORAL, &x, &y)) {
+            fprintf(stderr, "Buffer %ux%u %s pattern mismatch in plane %u at byte %u of row %u\n",
+                    buf->width, buf->height, pattern_type_to_string(pattern->type), p, x, y);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void record_fill(const drm_buffer_t *buf, uint64_t start, bool solid, const test_pattern_t *pattern) {
+    uint64_t args[] = { buf->trace_id, solid, pattern->value, pattern->type, pattern->step };
+    trace_record(TRACE_OP_DRM_FILL, start, args, TRACE_ARGC(args), NULL, 0);
+}
+
+bool fill_drm_buffer(drm_buffer_t *buf, uint32_t color) {
+    test_pattern_t patterns[DRM_MAX_PLANES];
+    if (!buf || !drm_format_solid_patterns(buf->format, color, patterns)) {
+        return false;
+    }
+    uint64_t start = buf->trace_id ? trace_begin() : 0;
+    if (!fill_planes(buf, patterns, true)) {
+        return false;
+    }
+    if (start) {
+        test_pattern_t solid = { .type = PATTERN_SOLID, .value = color };
+        record_fill(buf, start, true, &solid);
+    }
+    return true;
+}
+
+bool verify_drm_buffer(drm_buffer_t *buf, uint32_t expected_color) {
+    test_pattern_t patterns[DRM_MAX_PLANES];
+    if (!buf || !drm_format_solid_patterns(buf->format, expected_color, patterns)) {
+        return false;
+    }
+    return verify_planes(buf, patterns, true);
+}
+
+bool fill_drm_buffer_pattern(drm_buffer_t *buf, const test_pattern_t *pattern) {
+    if (!pattern || !buf) {
+        return false;
+    }
+    uint64_t start = buf->trace_id ? trace_begin() : 0;
+    if (!fill_planes(buf, pattern, false)) {
+        return false;
+    }
+    if (start) {
+        record_fill(buf, start, false, pattern);
+    }
+    return true;
+}
+
+bool verify_drm_buffer_pattern(drm_buffer_t *buf, const test_pattern_t *pattern) {
+    return pattern && verify_planes(buf, pattern, false);
+}
+
 bool export_gem_handle(drm_buffer_t *buf, uint32_t *handle) {
     if (!buf || !handle) {
         return false;
@@ -381,12 +468,23 @@ bool export_gem_handle(drm_buffer_t *buf, uint32_t *handle) {
 }
 
 drm_buffer_t *import_gem_handle(uint32_t handle) {
-    if (drm_fd < 0) {
+    if (display.fd < 0) {
+        return NULL;
+    }
+
+    // A temporary dma-buf is the only generic way to learn the object size
+    int prime_fd;
+    if (drmPrimeHandleToFD(display.fd, handle, DRM_CLOEXEC, &prime_fd) < 0) {
+        return NULL;
+    }
+    off_t size = lseek(prime_fd, 0, SEEK_END);
+    close(prime_fd);
+    if (size <= 0) {
         return NULL;
     }
 
-    uint64_t size;
-    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_GETFB2, &size) < 0) {
+    struct drm_mode_map_dumb map = { .handle = handle };
+    if (drmIoctl(display.fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
         return NULL;
     }
 
@@ -398,9 +496,11 @@ drm_buffer_t *import_gem_handle(uint32_t handle) {
     memset(buf, 0, sizeof(drm_buffer_t));
     buf->handle = handle;
     buf->size = size;
+    buf->imported = true;
+    buf->device = &display;
 
     // Map buffer
-    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, 0);
+    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, display.fd, map.offset);
     if (buf->map == MAP_FAILED) {
         free(buf);
         return NULL;
@@ -410,12 +510,12 @@ drm_buffer_t *import_gem_handle(uint32_t handle) {
 }
 
 int export_dma_buf(drm_buffer_t *buf, int *fd) {
-    if (!buf || !fd) {
+    if (!buf || !fd || !buf->device) {
         return -1;
     }
 
-    *fd = drmPrimeHandleToFD(drm_fd, buf->handle, 0);
-    if (*fd < 0) {
+    if (drmPrimeHandleToFD(buf->device->fd, buf->handle, DRM_CLOEXEC | DRM_RDWR, fd) < 0) {
+        *fd = -1;
         return -1;
     }
 
@@ -423,149 +523,251 @@ int export_dma_buf(drm_buffer_t *buf, int *fd) {
 }
 
 drm_buffer_t *import_dma_buf(int fd) {
-    if (drm_fd < 0 || fd < 0) {
+    return import_dma_buf_on(&display, fd);
+}
+
+drm_buffer_t *import_dma_buf_on(drm_device_t *device, int fd) {
+    if (!device || device->fd < 0 || fd < 0) {
+        return NULL;
+    }
+
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size <= 0) {
+        return NULL;
+    }
+
+    drm_buffer_t *buf = malloc(sizeof(drm_buffer_t));
+    if (!buf) {
+        return NULL;
+    }
+
+    memset(buf, 0, sizeof(drm_buffer_t));
+    buf->size = size;
+    buf->imported = true;
+    buf->device = device;
+
+    // CPU access goes through the dma-buf itself, as any importer would
+    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (buf->map == MAP_FAILED) {
+        free(buf);
         return NULL;
     }
 
-    uint32_t handle;
-    if (drmPrimeFDToHandle(drm_fd, fd, &handle) < 0) {
+    // The handle is taken last so no failure path holds one. A re-import
+    // of our own buffer returns its creator's handle, which an error path
+    // here could not tell apart and must not close.
+    if (drmPrimeFDToHandle(device->fd, fd, &buf->handle) < 0) {
+        munmap(buf->map, buf->size);
+        free(buf);
         return NULL;
     }
 
-    return import_gem_handle(handle);
+    return buf;
+}
+
+static void copy_buffer_geometry(drm_buffer_t *dst, const drm_buffer_t *src) {
+    dst->width = src->width;
+    dst->height = src->height;
+    dst->pitch = src->pitch;
+    dst->layout = src->layout;
+    dst->format = src->format;
+    dst->modifier = src->modifier;
+    dst->compression = src->compression;
 }
 
-bool test_buffer_performance(const test_config_t *config, uint32_t *avg_time) {
-    if (!config || !avg_time) {
+// Records one export + import round per iteration into export_import
+bool test_buffer_performance(const test_config_t *config, report_histogram_t *export_import) {
+    if (!config || !export_import) {
         return false;
     }
 
-    uint64_t total_time = 0;
+    report_histogram_init(export_import);
     for (uint32_t i = 0; i < config->iterations; i++) {
-        struct timespec start, end;
-        
-        // Create buffer
-        drm_buffer_t *buf = create_drm_buffer(config);
+        // Buffers come from the pool so allocation stays out of the timed region
+        drm_buffer_t *buf = drm_buffer_pool_acquire(config);
         if (!buf) {
             return false;
         }
 
-        // Start timer
-        clock_gettime(CLOCK_MONOTONIC, &start);
-
-        // Export and import
+        // Export and import, timed on the raw monotonic clock
+        report_timer_t timer = report_timer_begin();
         int fd;
         if (export_dma_buf(buf, &fd) < 0) {
-            destroy_drm_buffer(buf);
+            drm_buffer_pool_release(buf);
             return false;
         }
 
         drm_buffer_t *imported = import_dma_buf(fd);
         if (!imported) {
             close(fd);
-            destroy_drm_buffer(buf);
+            drm_buffer_pool_release(buf);
             return false;
         }
 
-        // End timer
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        total_time += (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+        report_timer_stop(&timer, export_import);
 
         // Cleanup
-        destroy_drm_buffer(buf);
         destroy_drm_buffer(imported);
         close(fd);
+        drm_buffer_pool_release(buf);
     }
 
-    *avg_time = total_time / (config->iterations * 1000000);
     return true;
 }
 
-bool test_format_conversion(const test_config_t *src_config, const test_config_t *dst_config) {
-    if (!src_config || !dst_config) {
+// CPU bandwidth through the dumb mapping (DRM fd) and through the mapping
+// of the same object as an imported dma-buf; both are synced on the dma-buf
+bool test_buffer_bandwidth(const test_config_t *config, map_bandwidth_t *dumb, map_bandwidth_t *prime) {
+    if (!config || !dumb || !prime) {
         return false;
     }
 
-    // Create source buffer
-    drm_buffer_t *src_buf = create_drm_buffer(src_config);
-    if (!src_buf) {
+    drm_buffer_t *buf = drm_buffer_pool_acquire(config);
+    if (!buf) {
         return false;
     }
 
-    // Fill source buffer
-    if (!fill_drm_buffer(src_buf, 0xFF0000FF)) {
-        destroy_drm_buffer(src_buf);
+    int fd;
+    if (export_dma_buf(buf, &fd) < 0) {
+        drm_buffer_pool_release(buf);
         return false;
     }
 
-    // Export as DMA-BUF
+    bool result = map_bandwidth_measure(buf->map, buf->size, fd, MAP_BANDWIDTH_PASSES, dumb);
+    drm_buffer_t *imported = import_dma_buf(fd);
+    result = imported && map_bandwidth_measure(imported->map, imported->size, fd, MAP_BANDWIDTH_PASSES, prime) &&
+             result;
+
+    destroy_drm_buffer(imported);
+    close(fd);
+    drm_buffer_pool_release(buf);
+    return result;
+}
+
+// Share a buffer through a dma-buf and check what the importer sees. With
+// write_through, the importer writes the colour and the owner verifies it.
+static bool verify_shared_buffer(drm_buffer_t *buf, uint32_t color, bool write_through) {
     int fd;
-    if (export_dma_buf(src_buf, &fd) < 0) {
-        destroy_drm_buffer(src_buf);
+    if (export_dma_buf(buf, &fd) < 0) {
         return false;
     }
 
-    // Import with target format
-    drm_buffer_t *dst_buf = import_dma_buf(fd);
-    if (!dst_buf) {
+    drm_buffer_t *imported = import_dma_buf(fd);
+    if (!imported) {
         close(fd);
-        destroy_drm_buffer(src_buf);
         return false;
     }
+    copy_buffer_geometry(imported, buf);
 
-    // Verify conversion
-    bool result = verify_drm_buffer(dst_buf, 0xFF0000FF);
+    bool result;
+    if (write_through) {
+        result = fill_drm_buffer(imported, color) && verify_drm_buffer(buf, color);
+    } else {
+        result = verify_drm_buffer(imported, color);
+    }
 
-    // Cleanup
-    destroy_drm_buffer(src_buf);
-    destroy_drm_buffer(dst_buf);
+    destroy_drm_buffer(imported);
     close(fd);
+    return result;
+}
+
+bool test_format_conversion(const test_config_t *src_config, const test_config_t *dst_config) {
+    if (!src_config || !dst_config) {
+        return false;
+    }
+
+    drm_buffer_t *src_buf = drm_buffer_pool_acquire(src_config);
+    if (!src_buf) {
+        return false;
+    }
+    drm_buffer_t *dst_buf = drm_buffer_pool_acquire(dst_config);
+    if (!dst_buf) {
+        drm_buffer_pool_release(src_buf);
+        return false;
+    }
+
+    // The source colour is converted to the destination format's plane
+    // values; each side is written by one mapping and read back by the
+    // other, so every plane is checked at its real pitch and offset
+    bool result = fill_drm_buffer(src_buf, 0xFF0000FF) &&
+                  verify_shared_buffer(src_buf, 0xFF0000FF, false) &&
+                  verify_shared_buffer(dst_buf, 0xFF0000FF, true);
+
+    // Let the kernel validate the layouts the display would scan out
+    if (result && is_layout_displayable(src_buf->format, src_buf->layout.modifier)) {
+        result = add_drm_framebuffer(src_buf);
+    }
+    if (result && is_layout_displayable(dst_buf->format, dst_buf->layout.modifier)) {
+        result = add_drm_framebuffer(dst_buf);
+    }
 
+    drm_buffer_pool_release(dst_buf);
+    drm_buffer_pool_release(src_buf);
     return result;
 }
 
-bool test_crtc_configuration(drm_crtc_t *crtc, const test_config_t *config) {
-    if (!crtc || !config) {
+// Checks a full CRTC configuration with TEST_ONLY: the kernel validates
+// the mode and plane state without changing what is on screen
+bool test_crtc_configuration(drm_crtc_t *crtc_config, const test_config_t *config) {
+    if (!crtc_config || !config || !crtc || !primary_plane) {
+        return false;
+    }
+
+    // ID 0 means the CRTC under test
+    drm_topology_crtc_t *target = crtc_config->id ? drm_topology_find_crtc(&display.topology, crtc_config->id) : crtc;
+    if (!target || !target->mode_valid || !target->props.ids[DRM_PROP_ACTIVE] ||
+        !target->props.ids[DRM_PROP_MODE_ID] || !has_plane_props(primary_plane)) {
+        fprintf(stderr, "CRTC lacks an active mode or atomic properties\n");
         return false;
     }
 
     // Create buffer
-    drm_buffer_t *buf = create_drm_buffer(config);
+    drm_buffer_t *buf = drm_buffer_pool_acquire(config);
     if (!buf) {
         return false;
     }
 
     // Fill buffer
-    if (!fill_drm_buffer(buf, 0xFF0000FF)) {
-        destroy_drm_buffer(buf);
+    if (!fill_drm_buffer(buf, 0xFF0000FF) || !add_drm_framebuffer(buf)) {
+        drm_buffer_pool_release(buf);
+        return false;
+    }
+
+    // A mode blob, unless the caller passed one in
+    uint32_t mode_id = crtc_config->mode;
+    if (!mode_id && drmModeCreatePropertyBlob(display.fd, &target->mode, sizeof(target->mode), &mode_id) != 0) {
+        drm_buffer_pool_release(buf);
         return false;
     }
 
     // Configure CRTC
     drmModeAtomicReq *req = drmModeAtomicAlloc();
     if (!req) {
-        destroy_drm_buffer(buf);
+        if (!crtc_config->mode) {
+            drmModeDestroyPropertyBlob(display.fd, mode_id);
+        }
+        drm_buffer_pool_release(buf);
         return false;
     }
 
-    // Add properties
-    if (!drmModeAtomicAddProperty(req, crtc->id, "ACTIVE", 1) ||
-        !drmModeAtomicAddProperty(req, crtc->id, "MODE_ID", crtc->mode) ||
-        !drmModeAtomicAddProperty(req, crtc->id, "X", crtc->x) ||
-        !drmModeAtomicAddProperty(req, crtc->id, "Y", crtc->y) ||
-        !drmModeAtomicAddProperty(req, crtc->id, "WIDTH", crtc->width) ||
-        !drmModeAtomicAddProperty(req, crtc->id, "HEIGHT", crtc->height)) {
-        drmModeAtomicFree(req);
-        destroy_drm_buffer(buf);
-        return false;
-    }
+    // Position and size are plane state; the CRTC only carries the mode
+    uint32_t width = crtc_config->width ? crtc_config->width : config->width;
+    uint32_t height = crtc_config->height ? crtc_config->height : config->height;
+    bool result = drm_atomic_add(req, target->id, &target->props, DRM_PROP_ACTIVE, 1) >= 0 &&
+                  drm_atomic_add(req, target->id, &target->props, DRM_PROP_MODE_ID, mode_id) >= 0;
+    add_plane_state(req, primary_plane, buf->fb_id, config->width, config->height,
+                    crtc_config->x, crtc_config->y, width, height);
 
     // Commit
-    bool result = drmModeAtomicCommit(drm_fd, req, DRM_MODE_ATOMIC_NONBLOCK, NULL) == 0;
+    result = result && drmModeAtomicCommit(display.fd, req, DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_ALLOW_MODESET,
+                                           NULL) == 0;
     
     // Cleanup
     drmModeAtomicFree(req);
-    destroy_drm_buffer(buf);
+    if (!crtc_config->mode) {
+        drmModeDestroyPropertyBlob(display.fd, mode_id);
+    }
+    drm_buffer_pool_release(buf);
 
     return result;
 }
@@ -576,7 +778,7 @@ bool test_connector_properties(drm_connector_t *connector) {
     }
 
     // Get connector properties
-    drmModeConnector *conn = drmModeGetConnector(drm_fd, connector->id);
+    drmModeConnector *conn = drmModeGetConnector(display.fd, connector->id);
     if (!conn) {
         return false;
     }
@@ -599,7 +801,7 @@ bool test_mode_setting(drm_mode_t *mode) {
     }
 
     // Get mode info
-    drmModeModeInfo *info = drmModeGetModeInfo(drm_fd, mode->id);
+    drmModeModeInfo *info = drmModeGetModeInfo(display.fd, mode->id);
     if (!info) {
         return false;
     }
@@ -621,13 +823,13 @@ bool test_vblank_handling(void) {
     int ret;
 
     // Request VBLANK event
-    ret = drmWaitVBlank(drm_fd, &sequence);
+    ret = drmWaitVBlank(display.fd, &sequence);
     if (ret < 0) {
         return false;
     }
 
     // Wait for VBLANK event
-    fds[0].fd = drm_fd;
+    fds[0].fd = display.fd;
     fds[0].events = POLLIN;
     ret = poll(fds, 1, TEST_TIMEOUT);
     if (ret <= 0) {
@@ -637,45 +839,724 @@ bool test_vblank_handling(void) {
     return true;
 }
 
-bool test_sync_primitives(void) {
-    // Create sync object
-    uint32_t sync_obj;
-    if (drmSyncobjCreate(drm_fd, 0, &sync_obj) < 0) {
-        return false;
-    }
+// Page flip benchmark
+typedef struct {
+    bool pending;
+    bool monotonic_events;
+    uint64_t commit_ns;
+    uint64_t first_flip_ns;
+    uint64_t last_flip_ns;
+    uint32_t last_sequence;
+    uint32_t frames;
+    uint32_t missed_vblanks;
+    double *latencies_ms;
+    report_live_id_t live_latency;
+    report_live_id_t live_flips;
+    report_live_id_t live_missed;
+    report_live_rate_t live_fps;
+} flip_context_t;
+
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
-    // Signal sync object
-    if (drmSyncobjSignal(drm_fd, &sync_obj, 1) < 0) {
-        drmSyncobjDestroy(drm_fd, sync_obj);
-        return false;
-    }
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec,
+                              unsigned int tv_usec, void *user_data) {
+    flip_context_t *ctx = (flip_context_t *)user_data;
+    (void)fd;
+
+    // Event timestamps are the vblank the flip landed on
+    uint64_t flip_ns = ctx->monotonic_events ?
+                       (uint64_t)tv_sec * 1000000000ULL + (uint64_t)tv_usec * 1000ULL :
+                       get_monotonic_ns();
+
+    if (ctx->frames == 0) {
+        ctx->first_flip_ns = flip_ns;
+    } else if (sequence - ctx->last_sequence > 1) {
+        ctx->missed_vblanks += sequence - ctx->last_sequence - 1;
+        report_live_add(ctx->live_missed, sequence - ctx->last_sequence - 1);
+    }
+
+    uint64_t latency_ns = flip_ns > ctx->commit_ns ? flip_ns - ctx->commit_ns : 0;
+    ctx->latencies_ms[ctx->frames] = (double)latency_ns / 1000000.0;
+    report_live_observe_ns(ctx->live_latency, latency_ns);
+    report_live_add(ctx->live_flips, 1);
+    report_live_rate_tick(&ctx->live_fps, flip_ns);
+    ctx->frames++;
+    ctx->last_sequence = sequence;
+    ctx->last_flip_ns = flip_ns;
+    ctx->pending = false;
+}
 
-    // Wait for sync object
-    uint32_t timeout = TEST_TIMEOUT;
-    if (drmSyncobjWait(drm_fd, &sync_obj, 1, timeout, NULL, NULL) < 0) {
-        drmSyncobjDestroy(drm_fd, sync_obj);
-        return false;
+static bool wait_for_flip(flip_context_t *ctx) {
+    drmEventContext evctx = {
+        .version = 2,
+        .page_flip_handler = page_flip_handler
+    };
+    struct pollfd fds[1] = { { .fd = display.fd, .events = POLLIN } };
+    uint64_t start = trace_begin();
+
+    while (ctx->pending) {
+        int ret = poll(fds, 1, TEST_TIMEOUT);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            fprintf(stderr, "Timed out waiting for page flip event\n");
+            return false;
+        }
+        if (drmHandleEvent(display.fd, &evctx) != 0) {
+            fprintf(stderr, "Failed to handle DRM event\n");
+            return false;
+        }
     }
 
-    // Cleanup
-    drmSyncobjDestroy(drm_fd, sync_obj);
+    if (start) {
+        trace_record(TRACE_OP_DRM_FLIP, start, NULL, 0, NULL, 0);
+    }
+    return true;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static double sorted_percentile(const double *values, uint32_t count, double pct) {
+    if (count == 0) {
+        return 0.0;
+    }
+    uint32_t index = (uint32_t)((pct / 100.0) * (count - 1) + 0.5);
+    return values[index];
+}
+
+bool test_page_flip_throughput(const test_config_t *config, uint32_t ring_size, uint32_t frame_count, drm_flip_stats_t *stats) {
+    if (!stats) {
+        return false;
+    }
+    memset(stats, 0, sizeof(drm_flip_stats_t));
+
+    if (!config || ring_size < 2 || frame_count == 0 || !crtc || !primary_plane) {
+        return false;
+    }
+
+    if (config->format != DRM_FORMAT_ARGB32 && config->format != DRM_FORMAT_XRGB8888) {
+        fprintf(stderr, "Page flip benchmark needs a 32bpp RGB format\n");
+        return false;
+    }
+
+    // Primary planes usually have to cover the whole CRTC, so flip at mode size
+    uint32_t width = crtc->mode.hdisplay;
+    uint32_t height = crtc->mode.vdisplay;
+
+    if (!has_plane_props(primary_plane)) {
+        fprintf(stderr, "Primary plane lacks atomic properties\n");
+        return false;
+    }
+
+    drm_buffer_t **ring = calloc(ring_size, sizeof(drm_buffer_t *));
+    flip_context_t ctx = { 0 };
+    ctx.latencies_ms = calloc(frame_count, sizeof(double));
+    if (!ring || !ctx.latencies_ms) {
+        free(ring);
+        free(ctx.latencies_ms);
+        return false;
+    }
+
+    uint64_t cap = 0;
+    ctx.monotonic_events = drmGetCap(display.fd, DRM_CAP_TIMESTAMP_MONOTONIC, &cap) == 0 && cap;
+
+    // Live view for soak runs; every update is a no-op without an exporter
+    char labels[32];
+    snprintf(labels, sizeof(labels), "crtc=\"%u\"", crtc->id);
+    ctx.live_latency = report_live_register("tvts_drm_flip_latency_seconds", labels, REPORT_LIVE_HISTOGRAM,
+                                            "Atomic commit to page flip event");
+    ctx.live_flips = report_live_register("tvts_drm_flips_total", labels, REPORT_LIVE_COUNTER,
+                                          "Completed page flips");
+    ctx.live_missed = report_live_register("tvts_drm_missed_vblanks_total", labels, REPORT_LIVE_COUNTER,
+                                           "Vblanks skipped between consecutive flips");
+    report_live_rate_init(&ctx.live_fps, report_live_register("tvts_drm_flip_fps", labels, REPORT_LIVE_GAUGE,
+                                                              "Page flips per second over the last second"));
+
+    test_config_t ring_config = *config;
+    ring_config.width = width;
+    ring_config.height = height;
+
+    // Distinct colour per ring slot so tearing or a stuck buffer is visible
+    bool result = true;
+    for (uint32_t i = 0; i < ring_size && result; i++) {
+        uint32_t color = 0xFF000000 | (0x00FFFFFF / ring_size) * (i + 1);
+        ring[i] = drm_buffer_pool_acquire(&ring_config);
+        result = ring[i] && add_drm_framebuffer(ring[i]) && fill_drm_buffer(ring[i], color);
+    }
+
+    // Install the plane state once; it is not part of the measurement
+    if (result && commit_plane_fb(primary_plane, ring[0]->fb_id,
+                                  width, height, width, height, true, 0, NULL) != 0) {
+        fprintf(stderr, "Initial plane commit failed\n");
+        result = false;
+    }
+
+    // Flip back-to-back: the next commit goes out as soon as the previous flip lands
+    for (uint32_t frame = 0; result && frame < frame_count; frame++) {
+        drm_buffer_t *fb = ring[(frame + 1) % ring_size];
+
+        ctx.pending = true;
+        ctx.commit_ns = get_monotonic_ns();
+        int ret = commit_plane_fb(primary_plane, fb->fb_id, width, height, width, height,
+                                  false, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, &ctx);
+        if (ret != 0) {
+            fprintf(stderr, "Page flip commit failed: %s\n", strerror(-ret));
+            result = false;
+            break;
+        }
+
+        result = wait_for_flip(&ctx);
+    }
+
+    stats->frames = ctx.frames;
+    stats->missed_vblanks = ctx.missed_vblanks;
+    if (ctx.frames > 1 && ctx.last_flip_ns > ctx.first_flip_ns) {
+        stats->fps = (double)(ctx.frames - 1) * 1000000000.0 / (double)(ctx.last_flip_ns - ctx.first_flip_ns);
+    }
+    if (ctx.frames > 0) {
+        qsort(ctx.latencies_ms, ctx.frames, sizeof(double), compare_double);
+        stats->latency_p50_ms = sorted_percentile(ctx.latencies_ms, ctx.frames, 50.0);
+        stats->latency_p99_ms = sorted_percentile(ctx.latencies_ms, ctx.frames, 99.0);
+        stats->latency_max_ms = ctx.latencies_ms[ctx.frames - 1];
+    }
+
+    // Put the original scanout buffer back before the ring is freed
+    if (crtc->buffer_id) {
+        commit_plane_fb(primary_plane, crtc->buffer_id,
+                        crtc->width, crtc->height, crtc->width, crtc->height, true, 0, NULL);
+    }
+
+    for (uint32_t i = 0; i < ring_size; i++) {
+        if (ring[i]) {
+            drm_buffer_pool_release(ring[i]);
+        }
+    }
+    free(ring);
+    free(ctx.latencies_ms);
+
+    return result && ctx.frames == frame_count;
+}
+
+// Explicit-sync pipeline. Acquire point n signals when frame n is
+// rendered; release point n signals with frame n's OUT_FENCE, i.e. when
+// frame n - 1 has left the screen and its buffer may be rendered again.
+typedef struct {
+    drm_timeline_t acquire;
+    drm_timeline_t release;
+    drm_buffer_t **ring;
+    uint32_t ring_size;
+    uint32_t frame_count;
+    _Atomic uint64_t *signal_ns;      // Per frame, stored before its acquire point
+    atomic_bool abort;
+    bool producer_ok;
+    drm_fence_stats_t *stats;         // release_wait and producer_stalls belong to the producer
+} fence_pipeline_t;
+
+static uint32_t ring_color(uint32_t slot, uint32_t ring_size) {
+    return 0xFF000000 | (0x00FFFFFF / ring_size) * (slot + 1);
+}
+
+static void *fence_producer_main(void *arg) {
+    fence_pipeline_t *p = arg;
+
+    for (uint32_t n = 1; n <= p->frame_count && !atomic_load(&p->abort); n++) {
+        uint32_t slot = n % p->ring_size;
+
+        // The slot's previous frame must be off screen before it is redrawn
+        if (n >= p->ring_size) {
+            uint64_t point = n - p->ring_size + 1;
+            if (drm_timeline_query(&p->release) < point) {
+                p->stats->producer_stalls++;
+                report_timer_t timer = report_timer_begin();
+                if (drm_timeline_wait(&p->release, point, TEST_TIMEOUT) != 0) {
+                    fprintf(stderr, "Timed out waiting for release fence %llu\n", (unsigned long long)point);
+                    p->producer_ok = false;
+                    break;
+                }
+                report_timer_stop(&timer, &p->stats->release_wait);
+            }
+        }
+
+        if (!fill_drm_buffer(p->ring[slot], ring_color(slot, p->ring_size))) {
+            p->producer_ok = false;
+            break;
+        }
+        atomic_store_explicit(&p->signal_ns[n], report_time_now_ns(), memory_order_release);
+        if (!drm_timeline_signal(&p->acquire, n)) {
+            p->producer_ok = false;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// Flips frame n with its acquire point as IN_FENCE_FD and hands back its
+// OUT_FENCE as the release point
+static bool present_fenced_frame(fence_pipeline_t *p, uint32_t n) {
+    drm_fence_stats_t *stats = p->stats;
+
+    uint64_t wait_start = report_time_now_ns();
+    if (drm_timeline_query(&p->acquire) >= n) {
+        stats->ready_frames++;
+    } else {
+        if (drm_timeline_wait(&p->acquire, n, TEST_TIMEOUT) != 0) {
+            fprintf(stderr, "Timed out waiting for frame %u\n", n);
+            return false;
+        }
+        uint64_t wake_ns = report_time_now_ns();
+        uint64_t signal_ns = atomic_load_explicit(&p->signal_ns[n], memory_order_acquire);
+        if (signal_ns > wait_start && wake_ns > signal_ns) {
+            report_histogram_record(&stats->signal_to_wake, wake_ns - signal_ns);
+        }
+    }
+
+    int in_fence = drm_timeline_export_sync_file(&p->acquire, n);
+    drmModeAtomicReq *req = drmModeAtomicAlloc();
+    if (in_fence < 0 || !req) {
+        if (in_fence >= 0) {
+            close(in_fence);
+        }
+        drmModeAtomicFree(req);
+        return false;
+    }
+
+    int32_t out_fence = -1;
+    const drm_buffer_t *fb = p->ring[n % p->ring_size];
+    drm_atomic_add(req, primary_plane->id, &primary_plane->props, DRM_PROP_FB_ID, fb->fb_id);
+    drm_atomic_add(req, primary_plane->id, &primary_plane->props, DRM_PROP_IN_FENCE_FD, (uint64_t)in_fence);
+    drm_atomic_add(req, crtc->id, &crtc->props, DRM_PROP_OUT_FENCE_PTR, (uint64_t)(uintptr_t)&out_fence);
+
+    uint64_t commit_ns = report_time_now_ns();
+    int ret = drmModeAtomicCommit(display.fd, req, DRM_MODE_ATOMIC_NONBLOCK, NULL);
+    drmModeAtomicFree(req);
+    close(in_fence);
+    if (ret != 0 || out_fence < 0) {
+        fprintf(stderr, "Fenced commit failed: %s\n", strerror(ret ? -ret : EINVAL));
+        return false;
+    }
+
+    // Publish the release before waiting, so the producer wakes on the
+    // flip itself rather than on this thread
+    bool result = drm_timeline_import_sync_file(&p->release, n, out_fence);
+    if (result && drm_sync_file_wait(out_fence, TEST_TIMEOUT) != 0) {
+        fprintf(stderr, "Timed out waiting for out fence of frame %u\n", n);
+        result = false;
+    }
+    if (result) {
+        report_histogram_record(&stats->commit_to_fence, report_time_now_ns() - commit_ns);
+    }
+    close(out_fence);
+    return result;
+}
+
+bool test_fence_pipeline(const test_config_t *config, uint32_t depth, uint32_t frame_count, drm_fence_stats_t *stats) {
+    if (!config || !stats || depth == 0 || frame_count == 0 || !crtc || !primary_plane) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(drm_fence_stats_t));
+    report_histogram_init(&stats->signal_to_wake);
+    report_histogram_init(&stats->release_wait);
+    report_histogram_init(&stats->commit_to_fence);
+    stats->depth = depth;
+
+    if (config->format != DRM_FORMAT_ARGB32 && config->format != DRM_FORMAT_XRGB8888) {
+        fprintf(stderr, "Fence pipeline benchmark needs a 32bpp RGB format\n");
+        return false;
+    }
+    if (!has_plane_props(primary_plane) || !primary_plane->props.ids[DRM_PROP_IN_FENCE_FD] ||
+        !crtc->props.ids[DRM_PROP_OUT_FENCE_PTR]) {
+        fprintf(stderr, "Driver lacks IN_FENCE_FD/OUT_FENCE_PTR\n");
+        return false;
+    }
+
+    fence_pipeline_t p = { .ring_size = depth + 1, .frame_count = frame_count, .producer_ok = true, .stats = stats };
+    atomic_init(&p.abort, false);
+    if (!drm_timeline_create(&p.acquire, &display)) {
+        return false;
+    }
+    if (!drm_timeline_create(&p.release, &display)) {
+        drm_timeline_destroy(&p.acquire);
+        return false;
+    }
+
+    // One buffer on screen plus depth frames the producer may run ahead
+    uint32_t width = crtc->mode.hdisplay;
+    uint32_t height = crtc->mode.vdisplay;
+    test_config_t ring_config = *config;
+    ring_config.width = width;
+    ring_config.height = height;
+
+    p.ring = calloc(p.ring_size, sizeof(drm_buffer_t *));
+    p.signal_ns = calloc(frame_count + 1, sizeof(*p.signal_ns));
+    bool result = p.ring && p.signal_ns;
+    for (uint32_t i = 0; result && i < p.ring_size; i++) {
+        p.ring[i] = drm_buffer_pool_acquire(&ring_config);
+        result = p.ring[i] && add_drm_framebuffer(p.ring[i]);
+    }
+
+    // Frame 0 goes up unfenced and installs the plane state
+    result = result && fill_drm_buffer(p.ring[0], ring_color(0, p.ring_size)) &&
+             commit_plane_fb(primary_plane, p.ring[0]->fb_id, width, height, width, height, true, 0, NULL) == 0;
+
+    pthread_t producer;
+    bool producer_started = result && pthread_create(&producer, NULL, fence_producer_main, &p) == 0;
+    result = producer_started;
+
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    for (uint32_t n = 1; result && n <= frame_count; n++) {
+        result = present_fenced_frame(&p, n);
+        if (!result) {
+            break;
+        }
+        last_ns = report_time_now_ns();
+        if (n == 1) {
+            first_ns = last_ns;
+        }
+        stats->frames++;
+    }
+
+    if (producer_started) {
+        atomic_store(&p.abort, true);
+        pthread_join(producer, NULL);
+        result = result && p.producer_ok;
+    }
+    if (stats->frames > 1 && last_ns > first_ns) {
+        stats->fps = (double)(stats->frames - 1) * 1000000000.0 / (double)(last_ns - first_ns);
+    }
+
+    // Put the original scanout buffer back before the ring is freed
+    if (crtc->buffer_id) {
+        commit_plane_fb(primary_plane, crtc->buffer_id,
+                        crtc->width, crtc->height, crtc->width, crtc->height, true, 0, NULL);
+    }
+
+    for (uint32_t i = 0; p.ring && i < p.ring_size; i++) {
+        drm_buffer_pool_release(p.ring[i]);
+    }
+    free(p.ring);
+    free(p.signal_ns);
+    drm_timeline_destroy(&p.release);
+    drm_timeline_destroy(&p.acquire);
+
+    return result && stats->frames == frame_count;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t va = *(const uint64_t *)a;
+    uint64_t vb = *(const uint64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// Axis values from the display format set's marker entries, sorted so the
+// matrix reads the same from run to run
+static void add_sorted_axis(sweep_axis_t *axis, uint64_t *values, uint32_t count, bool modifiers) {
+    qsort(values, count, sizeof(uint64_t), compare_u64);
+    for (uint32_t i = 0; i < count; i++) {
+        char label[SWEEP_LABEL_SIZE];
+        if (!modifiers) {
+            uint32_t format = (uint32_t)values[i];
+            snprintf(label, sizeof(label), "%.4s", (const char *)&format);
+        } else if (values[i] == DRM_FORMAT_MOD_LINEAR) {
+            snprintf(label, sizeof(label), "linear");
+        } else {
+            snprintf(label, sizeof(label), "0x%llx", (unsigned long long)values[i]);
+        }
+        sweep_axis_add(axis, values[i], label);
+    }
+}
+
+bool drm_sweep_init(sweep_t *sweep, const test_config_t *base) {
+    if (!sweep || !base || !connector) {
+        return false;
+    }
+
+    sweep_init(sweep, "DRM Buffer Fill Throughput", "MB/s");
+    sweep_axis_t *formats = sweep_add_axis(sweep, "format");
+    sweep_axis_t *modifiers = sweep_add_axis(sweep, "modifier");
+    sweep_axis_t *sizes = sweep_add_axis(sweep, "size");
+
+    // Only what the planes advertise and this tree can lay out
+    uint64_t format_values[SWEEP_MAX_VALUES];
+    uint64_t modifier_values[SWEEP_MAX_VALUES];
+    uint32_t format_count = 0;
+    uint32_t modifier_count = 0;
+    for (uint32_t i = 0; i < display_formats.capacity; i++) {
+        const drm_format_entry_t *entry = &display_formats.entries[i];
+        drm_modifier_t modifier;
+        if (!entry->used) {
+            continue;
+        }
+        if (entry->modifier == DRM_FORMAT_MOD_INVALID && format_count < SWEEP_MAX_VALUES &&
+            drm_format_plane_count((drm_format_t)entry->format)) {
+            format_values[format_count++] = entry->format;
+        } else if (entry->format == 0 && modifier_count < SWEEP_MAX_VALUES &&
+                   drm_modifier_from_fourcc(entry->modifier, &modifier)) {
+            modifier_values[modifier_count++] = entry->modifier;
+        }
+    }
+    add_sorted_axis(formats, format_values, format_count, false);
+    add_sorted_axis(modifiers, modifier_values, modifier_count, true);
+
+    // The connector's distinct mode sizes, then the requested size
+    for (uint32_t i = 0; i < connector->mode_count; i++) {
+        const drmModeModeInfo *mode = &connector->modes[i];
+        char label[SWEEP_LABEL_SIZE];
+        snprintf(label, sizeof(label), "%ux%u", mode->hdisplay, mode->vdisplay);
+        sweep_axis_add(sizes, (uint64_t)mode->hdisplay << 32 | mode->vdisplay, label);
+    }
+    char label[SWEEP_LABEL_SIZE];
+    snprintf(label, sizeof(label), "%ux%u", base->width, base->height);
+    sweep_axis_add(sizes, (uint64_t)base->width << 32 | base->height, label);
+
+    return sweep_point_count(sweep) > 0;
+}
+
+// context is the base test_config_t; its iterations are the fills per point.
+// Buffers come from the pool, so a point re-run or a shared key costs no
+// allocation.
+bool drm_sweep_fill_throughput(void *context, const sweep_point_t *point, double *value) {
+    const test_config_t *base = context;
+    test_config_t config = *base;
+    config.format = (drm_format_t)point->values[0];
+    config.width = (uint32_t)(point->values[2] >> 32);
+    config.height = (uint32_t)point->values[2];
+
+    if (!is_layout_displayable(config.format, point->values[1]) ||
+        !drm_modifier_from_fourcc(point->values[1], &config.modifier)) {
+        return false;
+    }
+
+    uint32_t iterations = config.iterations ? config.iterations : 1;
+    uint64_t bytes = 0;
+    uint64_t elapsed_ns = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        drm_buffer_t *buf = drm_buffer_pool_acquire(&config);
+        if (!buf) {
+            return false;
+        }
+        report_timer_t timer = report_timer_begin();
+        bool filled = fill_drm_buffer(buf, 0xFF336699);
+        elapsed_ns += report_timer_elapsed_ns(&timer);
+        bytes += buf->layout.size;
+        drm_buffer_pool_release(buf);
+        if (!filled) {
+            return false;
+        }
+    }
+
+    *value = elapsed_ns ? (double)bytes * 1e3 / (double)elapsed_ns : 0.0;
     return true;
 }
 
+// Refresh rate of the mode on the test CRTC, 0 before init_test_framework()
+uint32_t drm_get_refresh_rate(void) {
+    return crtc && crtc->mode_valid ? crtc->mode.vrefresh : 0;
+}
+
+// Scanout of buffers produced elsewhere, e.g. by a capture device
+static bool scanout_active = false;
+static bool scanout_monotonic = false;
+static uint32_t scanout_src_w = 0;
+static uint32_t scanout_src_h = 0;
+static uint32_t scanout_crtc_w = 0;
+static uint32_t scanout_crtc_h = 0;
+static drm_scanout_handler_t scanout_handler = NULL;
+static void *scanout_context = NULL;
+static report_live_id_t scanout_live_flips = -1;
+static report_live_rate_t scanout_live_fps;
+
+static void scanout_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec,
+                                 unsigned int tv_usec, void *user_data) {
+    (void)fd;
+    (void)sequence;
+
+    uint64_t flip_ns = scanout_monotonic ?
+                       (uint64_t)tv_sec * 1000000000ULL + (uint64_t)tv_usec * 1000ULL :
+                       get_monotonic_ns();
+    report_live_add(scanout_live_flips, 1);
+    report_live_rate_tick(&scanout_live_fps, flip_ns);
+    if (scanout_handler) {
+        scanout_handler(scanout_context, user_data, flip_ns);
+    }
+}
+
+int drm_scanout_get_fd(void) {
+    return display.fd;
+}
+
+bool drm_scanout_start(drm_buffer_t *buf) {
+    if (!buf || !crtc || !primary_plane || scanout_active) {
+        return false;
+    }
+    if (!has_plane_props(primary_plane)) {
+        fprintf(stderr, "Primary plane lacks atomic properties\n");
+        return false;
+    }
+    if (!add_drm_framebuffer(buf)) {
+        return false;
+    }
+
+    uint64_t cap = 0;
+    scanout_monotonic = drmGetCap(display.fd, DRM_CAP_TIMESTAMP_MONOTONIC, &cap) == 0 && cap;
+    scanout_src_w = buf->width;
+    scanout_src_h = buf->height;
+
+    // Scale to the full mode when the plane can, otherwise show it 1:1
+    scanout_crtc_w = crtc->mode.hdisplay;
+    scanout_crtc_h = crtc->mode.vdisplay;
+    if (commit_plane_fb(primary_plane, buf->fb_id, scanout_src_w, scanout_src_h,
+                        scanout_crtc_w, scanout_crtc_h, true, DRM_MODE_ATOMIC_TEST_ONLY, NULL) != 0) {
+        scanout_crtc_w = buf->width < crtc->mode.hdisplay ? buf->width : crtc->mode.hdisplay;
+        scanout_crtc_h = buf->height < crtc->mode.vdisplay ? buf->height : crtc->mode.vdisplay;
+        scanout_src_w = scanout_crtc_w;
+        scanout_src_h = scanout_crtc_h;
+    }
+
+    int ret = commit_plane_fb(primary_plane, buf->fb_id, scanout_src_w, scanout_src_h,
+                              scanout_crtc_w, scanout_crtc_h, true, 0, NULL);
+    if (ret != 0) {
+        fprintf(stderr, "Scanout commit failed: %s\n", strerror(-ret));
+        return false;
+    }
+
+    char labels[32];
+    snprintf(labels, sizeof(labels), "crtc=\"%u\"", crtc->id);
+    scanout_live_flips = report_live_register("tvts_drm_scanout_flips_total", labels, REPORT_LIVE_COUNTER,
+                                              "Externally produced buffers put on screen");
+    report_live_rate_init(&scanout_live_fps, report_live_register("tvts_drm_scanout_fps", labels, REPORT_LIVE_GAUGE,
+                                                                  "Scanout flips per second over the last second"));
+
+    scanout_active = true;
+    return true;
+}
+
+bool drm_scanout_queue(drm_buffer_t *buf, void *user_data) {
+    if (!buf || !scanout_active || !add_drm_framebuffer(buf)) {
+        return false;
+    }
+
+    int ret = commit_plane_fb(primary_plane, buf->fb_id, scanout_src_w, scanout_src_h,
+                              scanout_crtc_w, scanout_crtc_h, false,
+                              DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, user_data);
+    if (ret != 0) {
+        fprintf(stderr, "Scanout flip failed: %s\n", strerror(-ret));
+        return false;
+    }
+
+    return true;
+}
+
+bool drm_scanout_dispatch(drm_scanout_handler_t handler, void *context) {
+    drmEventContext evctx = {
+        .version = 2,
+        .page_flip_handler = scanout_flip_handler
+    };
+
+    scanout_handler = handler;
+    scanout_context = context;
+    uint64_t start = trace_begin();
+    int ret = drmHandleEvent(display.fd, &evctx);
+    scanout_handler = NULL;
+    scanout_context = NULL;
+
+    if (ret != 0) {
+        fprintf(stderr, "Failed to handle DRM event\n");
+        return false;
+    }
+    if (start) {
+        trace_record(TRACE_OP_DRM_FLIP, start, NULL, 0, NULL, 0);
+    }
+    return true;
+}
+
+void drm_scanout_stop(void) {
+    if (!scanout_active) {
+        return;
+    }
+
+    // Drop any flip still in flight, then put the original buffer back
+    struct pollfd fds[1] = { { .fd = display.fd, .events = POLLIN } };
+    while (poll(fds, 1, 100) > 0) {
+        if (!drm_scanout_dispatch(NULL, NULL)) {
+            break;
+        }
+    }
+    if (crtc->buffer_id) {
+        commit_plane_fb(primary_plane, crtc->buffer_id,
+                        crtc->width, crtc->height, crtc->width, crtc->height, true, 0, NULL);
+    }
+
+    scanout_active = false;
+}
+
+bool test_sync_primitives(void) {
+    // Create sync object
+    uint32_t sync_obj;
+    if (drmSyncobjCreate(display.fd, 0, &sync_obj) < 0) {
+        return false;
+    }
+
+    // Signal sync object
+    if (drmSyncobjSignal(display.fd, &sync_obj, 1) < 0) {
+        drmSyncobjDestroy(display.fd, sync_obj);
+        return false;
+    }
+
+    // Wait for sync object; the timeout is an absolute CLOCK_MONOTONIC time
+    int64_t deadline = (int64_t)get_monotonic_ns() + (int64_t)TEST_TIMEOUT * 1000000;
+    if (drmSyncobjWait(display.fd, &sync_obj, 1, deadline, 0, NULL) < 0) {
+        drmSyncobjDestroy(display.fd, sync_obj);
+        return false;
+    }
+
+    // Cleanup
+    drmSyncobjDestroy(display.fd, sync_obj);
+
+    // Timeline points, and their round trip through a sync_file
+    drm_timeline_t timeline;
+    if (!drm_timeline_create(&timeline, &display)) {
+        return false;
+    }
+    bool result = drm_timeline_signal(&timeline, 2) && drm_timeline_query(&timeline) == 2 &&
+                  drm_timeline_wait(&timeline, 1, TEST_TIMEOUT) == 0;
+    int sync_file = result ? drm_timeline_export_sync_file(&timeline, 2) : -1;
+    result = sync_file >= 0 && drm_sync_file_wait(sync_file, TEST_TIMEOUT) == 0 &&
+             drm_timeline_import_sync_file(&timeline, 3, sync_file) &&
+             drm_timeline_wait(&timeline, 3, TEST_TIMEOUT) == 0;
+    if (sync_file >= 0) {
+        close(sync_file);
+    }
+    drm_timeline_destroy(&timeline);
+
+    return result;
+}
+
 bool test_color_management(void) {
     // Test gamma ramp
     uint16_t gamma[3][4096];
     memset(gamma, 0, sizeof(gamma));
 
     // Set gamma ramp
-    if (drmModeSetCrtcGamma(drm_fd, crtc->id, 4096, gamma[0], gamma[1], gamma[2]) < 0) {
+    if (drmModeSetCrtcGamma(display.fd, crtc->id, 4096, gamma[0], gamma[1], gamma[2]) < 0) {
         return false;
     }
 
     // Get gamma ramp
     uint16_t size;
     uint16_t red[4096], green[4096], blue[4096];
-    if (drmModeGetCrtcGamma(drm_fd, crtc->id, &size, red, green, blue) < 0) {
+    if (drmModeGetCrtcGamma(display.fd, crtc->id, &size, red, green, blue) < 0) {
         return false;
     }
 
@@ -705,9 +1586,18 @@ bool test_all_features(void) {
     bool result = true;
     result &= test_buffer_sharing(&config);
     result &= test_format_conversion(&config, &config);
-    result &= test_plane_configuration(primary_plane, &config);
-    result &= test_crtc_configuration((drm_crtc_t *)crtc, &config);
-    result &= test_connector_properties((drm_connector_t *)connector);
+    drm_plane_t plane = { .id = primary_plane->id, .type = primary_plane->type };
+    drm_crtc_t crtc_config = { .id = crtc->id, .width = config.width, .height = config.height };
+    drm_connector_t connector_config = {
+        .id = connector->id,
+        .type = connector->type,
+        .connection = connector->connection,
+        .width_mm = connector->width_mm,
+        .height_mm = connector->height_mm
+    };
+    result &= test_plane_configuration(&plane, &config);
+    result &= test_crtc_configuration(&crtc_config, &config);
+    result &= test_connector_properties(&connector_config);
     result &= test_mode_setting((drm_mode_t *)crtc);
     result &= test_vblank_handling();
     result &= test_sync_primitives();
@@ -717,48 +1607,47 @@ bool test_all_features(void) {
     return result;
 }
 
+// Like the CRTC check, validated with TEST_ONLY and left off screen
 bool test_plane_configuration(drm_plane_t *plane, const test_config_t *config) {
-    if (!plane || !config) {
+    if (!plane || !config || !crtc) {
+        return false;
+    }
+
+    // ID 0 means the test CRTC's plane of that type
+    drm_topology_plane_t *target = plane->id ? drm_topology_find_plane(&display.topology, plane->id) : plane_for_type(plane->type);
+    if (!target || !has_plane_props(target)) {
+        fprintf(stderr, "Plane lacks atomic properties\n");
         return false;
     }
 
     // Create buffer
-    drm_buffer_t *buf = create_drm_buffer(config);
+    drm_buffer_t *buf = drm_buffer_pool_acquire(config);
     if (!buf) {
         return false;
     }
 
     // Fill buffer
-    if (!fill_drm_buffer(buf, 0x0000FFFF)) {
-        destroy_drm_buffer(buf);
+    if (!fill_drm_buffer(buf, 0x0000FFFF) || !add_drm_framebuffer(buf)) {
+        drm_buffer_pool_release(buf);
         return false;
     }
 
     // Configure plane
     drmModeAtomicReq *req = drmModeAtomicAlloc();
     if (!req) {
-        destroy_drm_buffer(buf);
+        drm_buffer_pool_release(buf);
         return false;
     }
 
     // Add properties
-    drmModeAtomicAddProperty(req, plane->id, "FB_ID", buf->handle);
-    drmModeAtomicAddProperty(req, plane->id, "CRTC_ID", crtc->crtc_id);
-    drmModeAtomicAddProperty(req, plane->id, "CRTC_X", 0);
-    drmModeAtomicAddProperty(req, plane->id, "CRTC_Y", 0);
-    drmModeAtomicAddProperty(req, plane->id, "CRTC_W", config->width);
-    drmModeAtomicAddProperty(req, plane->id, "CRTC_H", config->height);
-    drmModeAtomicAddProperty(req, plane->id, "SRC_X", 0);
-    drmModeAtomicAddProperty(req, plane->id, "SRC_Y", 0);
-    drmModeAtomicAddProperty(req, plane->id, "SRC_W", config->width << 16);
-    drmModeAtomicAddProperty(req, plane->id, "SRC_H", config->height << 16);
+    add_plane_state(req, target, buf->fb_id, config->width, config->height, 0, 0, config->width, config->height);
 
     // Commit
-    bool result = drmModeAtomicCommit(drm_fd, req, DRM_MODE_ATOMIC_NONBLOCK, NULL) == 0;
+    bool result = drmModeAtomicCommit(display.fd, req, DRM_MODE_ATOMIC_TEST_ONLY, NULL) == 0;
     
     // Cleanup
     drmModeAtomicFree(req);
-    destroy_drm_buffer(buf);
+    drm_buffer_pool_release(buf);
 
     return result;
 }
@@ -768,56 +1657,423 @@ bool test_cross_device_sharing(const test_config_t *config) {
         return false;
     }
 
+    // Any other node will do: a second GPU, or this GPU's render node
+    char paths[DRM_DEVICE_MAX][DRM_DEVICE_PATH_MAX];
+    uint32_t path_count = drm_device_enumerate(paths, DRM_DEVICE_MAX);
+    drm_device_t peer = { .fd = -1 };
+    for (uint32_t i = 0; i < path_count && peer.fd < 0; i++) {
+        if (strcmp(paths[i], display.path) != 0 && !drm_device_open(&peer, paths[i])) {
+            peer.fd = -1;
+        }
+    }
+    if (peer.fd < 0) {
+        fprintf(stderr, "No second DRM device to share with\n");
+        return false;
+    }
+
     // Create buffer
-    drm_buffer_t *buf = create_drm_buffer(config);
+    drm_buffer_t *buf = drm_buffer_pool_acquire(config);
     if (!buf) {
+        drm_device_close(&peer);
         return false;
     }
 
-    // Fill buffer
-    if (!fill_drm_buffer(buf, 0xFF00FF00)) {
-        destroy_drm_buffer(buf);
+    // Fill buffer and export as DMA-BUF
+    int fd;
+    if (!fill_drm_buffer(buf, 0xFF00FF00) || export_dma_buf(buf, &fd) < 0) {
+        drm_buffer_pool_release(buf);
+        drm_device_close(&peer);
         return false;
     }
 
-    // Export as DMA-BUF
+    // Import and verify on the second device
+    drm_buffer_t *imported = import_dma_buf_on(&peer, fd);
+    bool result = imported != NULL;
+    if (result) {
+        copy_buffer_geometry(imported, buf);
+        result = verify_drm_buffer(imported, 0xFF00FF00);
+        destroy_foreign_import(imported);
+    }
+
+    // Cleanup
+    close(fd);
+    drm_buffer_pool_release(buf);
+    drm_device_close(&peer);
+
+    return result;
+}
+
+// Reads the whole mapping a word at a time; the sum keeps the loads alive
+static uint64_t read_mapping(const void *map, uint32_t size) {
+    const uint64_t *words = map;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < size / sizeof(uint64_t); i++) {
+        sum += words[i];
+    }
+    return sum;
+}
+
+static double bytes_per_sec(uint64_t bytes, uint64_t elapsed_ns) {
+    return elapsed_ns ? (double)bytes * 1e9 / (double)elapsed_ns : 0.0;
+}
+
+// Shares one exporter buffer with the importer: the exporter's colour is
+// checked through the importer's mapping and the importer's colour back
+// through the exporter's, then import latency and both access paths are
+// measured
+static void share_pair(drm_device_t *importer, drm_buffer_t *buf, const test_config_t *config,
+                       drm_cross_device_result_t *result) {
     int fd;
-    if (export_dma_buf(buf, &fd) < 0) {
-        destroy_drm_buffer(buf);
+    if (!fill_drm_buffer(buf, 0xFF00FF00) || export_dma_buf(buf, &fd) < 0) {
+        return;
+    }
+
+    // Import latency; every round drops its handle so the next one is a
+    // fresh import rather than a lookup of the existing handle
+    for (uint32_t i = 0; i < config->iterations; i++) {
+        report_timer_t timer = report_timer_begin();
+        drm_buffer_t *imported = import_dma_buf_on(importer, fd);
+        if (!imported) {
+            close(fd);
+            return;
+        }
+        report_timer_stop(&timer, &result->import_ns);
+        destroy_foreign_import(imported);
+    }
+
+    drm_buffer_t *imported = import_dma_buf_on(importer, fd);
+    close(fd);
+    if (!imported) {
+        return;
+    }
+    result->imported = true;
+    copy_buffer_geometry(imported, buf);
+    result->verified = verify_drm_buffer(imported, 0xFF00FF00) &&
+                       fill_drm_buffer(imported, 0xFF0000FF) &&
+                       verify_drm_buffer(buf, 0xFF0000FF);
+
+    // The copy lands in a dumb buffer when the importer can allocate one,
+    // otherwise in ordinary memory as a render-only importer would use
+    uint32_t bytes = buf->layout.size;
+    drm_buffer_t *staging = importer->dumb ? create_drm_buffer_on(importer, config) : NULL;
+    void *copy = staging && staging->size >= bytes ? staging->map : malloc(bytes);
+
+    if (copy) {
+        volatile uint64_t sink = 0;
+        report_timer_t timer = report_timer_begin();
+        for (uint32_t pass = 0; pass < TEST_BANDWIDTH_PASSES; pass++) {
+            sink += read_mapping(imported->map, bytes);
+        }
+        result->zero_copy_bps = bytes_per_sec((uint64_t)bytes * TEST_BANDWIDTH_PASSES,
+                                              report_timer_elapsed_ns(&timer));
+
+        timer = report_timer_begin();
+        for (uint32_t pass = 0; pass < TEST_BANDWIDTH_PASSES; pass++) {
+            memcpy(copy, imported->map, bytes);
+            sink += read_mapping(copy, bytes);
+        }
+        result->copy_bps = bytes_per_sec((uint64_t)bytes * TEST_BANDWIDTH_PASSES,
+                                         report_timer_elapsed_ns(&timer));
+        (void)sink;
+    }
+
+    if (!staging || copy != staging->map) {
+        free(copy);
+    }
+    destroy_drm_buffer(staging);
+    destroy_foreign_import(imported);
+}
+
+bool test_cross_device_dmabuf(drm_device_t *exporter, drm_device_t *importer,
+                              const test_config_t *config, drm_cross_device_handler_t handler,
+                              void *context) {
+    if (!exporter || !importer || exporter == importer || !config || !exporter->dumb) {
+        return false;
+    }
+    if (!(exporter->prime & DRM_PRIME_CAP_EXPORT) || !(importer->prime & DRM_PRIME_CAP_IMPORT)) {
+        fprintf(stderr, "%s cannot share dma-bufs with %s\n", drm_device_name(exporter), drm_device_name(importer));
         return false;
     }
 
-    // Open second DRM device
-    int second_drm_fd = open("/dev/dri/card1", O_RDWR);
-    if (second_drm_fd < 0) {
-        close(fd);
-        destroy_drm_buffer(buf);
+    drm_cross_device_result_t *result = malloc(sizeof(drm_cross_device_result_t));
+    if (!result) {
         return false;
     }
 
-    // Import on second device
-    uint32_t handle;
-    if (drmPrimeFDToHandle(second_drm_fd, fd, &handle) < 0) {
-        close(second_drm_fd);
-        close(fd);
+    // An importer without planes (a render node) advertises nothing and
+    // takes whatever the exporter lays out
+    bool importer_any = importer->formats.pair_count == 0;
+    bool all_verified = true;
+    uint32_t shared = 0;
+
+    for (uint32_t i = 0; i < exporter->formats.capacity; i++) {
+        const drm_format_entry_t *entry = &exporter->formats.entries[i];
+        if (!entry->used || !entry->format || entry->modifier == DRM_FORMAT_MOD_INVALID) {
+            continue;
+        }
+        if (!importer_any && !drm_format_set_has(&importer->formats, entry->format, entry->modifier)) {
+            continue;
+        }
+
+        // Only pairs this tree can lay out for CPU access
+        test_config_t pair_config = *config;
+        pair_config.format = (drm_format_t)entry->format;
+        if (!drm_format_plane_count(pair_config.format) ||
+            !drm_modifier_from_fourcc(entry->modifier, &pair_config.modifier)) {
+            continue;
+        }
+
+        drm_buffer_t *buf = create_drm_buffer_on(exporter, &pair_config);
+        if (!buf) {
+            continue;
+        }
+
+        memset(result, 0, sizeof(drm_cross_device_result_t));
+        result->format = entry->format;
+        result->modifier = entry->modifier;
+        report_histogram_init(&result->import_ns);
+        share_pair(importer, buf, &pair_config, result);
         destroy_drm_buffer(buf);
+
+        if (result->imported) {
+            shared++;
+            all_verified &= result->verified;
+        }
+        if (handler) {
+            handler(context, result);
+        }
+    }
+
+    free(result);
+    return shared > 0 && all_verified;
+}
+
+// Trace replay. Recorded buffers are recreated on this display under
+// their trace ids, and commits find them by the fb id they had when
+// recorded. Flips are waited for with a handler of our own, since the
+// recorded user_data means nothing here.
+typedef struct {
+    uint32_t trace_id;
+    uint32_t recorded_fb;
+    drm_buffer_t *buf;
+} replay_buffer_t;
+
+static replay_buffer_t *replay_buffers = NULL;
+static uint32_t replay_buffer_count = 0;
+static uint32_t replay_buffer_capacity = 0;
+static bool replay_started = false;
+static bool replay_opened = false;           // The replay brought the framework up
+static bool replay_unavailable = false;
+static bool replay_committed = false;
+static bool replay_flip_pending = false;
+
+static void replay_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec,
+                                unsigned int tv_usec, void *user_data) {
+    (void)fd;
+    (void)sequence;
+    (void)tv_sec;
+    (void)tv_usec;
+    (void)user_data;
+    replay_flip_pending = false;
+}
+
+static bool replay_wait_flip(void) {
+    drmEventContext evctx = {
+        .version = 2,
+        .page_flip_handler = replay_flip_handler
+    };
+    struct pollfd fds[1] = { { .fd = display.fd, .events = POLLIN } };
+
+    while (replay_flip_pending) {
+        int ret = poll(fds, 1, TEST_TIMEOUT);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0 || drmHandleEvent(display.fd, &evctx) != 0) {
+            fprintf(stderr, "Lost the page flip event of a replayed commit\n");
+            replay_flip_pending = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+static replay_buffer_t *find_replay_buffer(uint64_t trace_id) {
+    for (uint32_t i = 0; i < replay_buffer_count; i++) {
+        if (replay_buffers[i].trace_id == trace_id) {
+            return &replay_buffers[i];
+        }
+    }
+    return NULL;
+}
+
+static replay_buffer_t *find_replay_fb(uint64_t recorded_fb) {
+    for (uint32_t i = 0; i < replay_buffer_count; i++) {
+        if (replay_buffers[i].recorded_fb == recorded_fb) {
+            return &replay_buffers[i];
+        }
+    }
+    return NULL;
+}
+
+static bool replay_create(const trace_record_t *record, uint64_t *duration_ns) {
+    if (record->argc < 6) {
         return false;
     }
+    if (replay_buffer_count == replay_buffer_capacity) {
+        uint32_t capacity = replay_buffer_capacity ? replay_buffer_capacity * 2 : 16;
+        replay_buffer_t *buffers = realloc(replay_buffers, capacity * sizeof(*buffers));
+        if (!buffers) {
+            return false;
+        }
+        replay_buffers = buffers;
+        replay_buffer_capacity = capacity;
+    }
 
-    // Verify on second device
-    drm_buffer_t *imported = import_gem_handle(handle);
-    if (!imported || !verify_drm_buffer(imported, 0xFF00FF00)) {
-        close(second_drm_fd);
-        close(fd);
-        destroy_drm_buffer(buf);
+    test_config_t config = {
+        .width = (uint32_t)record->args[1],
+        .height = (uint32_t)record->args[2],
+        .format = (drm_format_t)record->args[3],
+        .modifier = (drm_modifier_t)record->args[4],
+        .compression = (drm_compression_t)record->args[5],
+        .iterations = 1
+    };
+    uint64_t start = report_time_now_ns();
+    drm_buffer_t *buf = create_drm_buffer(&config);
+    *duration_ns = report_time_now_ns() - start;
+    if (!buf) {
         return false;
     }
 
-    // Cleanup
-    close(second_drm_fd);
-    close(fd);
-    destroy_drm_buffer(buf);
-    destroy_drm_buffer(imported);
+    replay_buffer_t *entry = &replay_buffers[replay_buffer_count++];
+    entry->trace_id = (uint32_t)record->args[0];
+    entry->recorded_fb = 0;
+    entry->buf = buf;
+    return true;
+}
+
+static void replay_destroy(replay_buffer_t *entry) {
+    destroy_drm_buffer(entry->buf);
+    *entry = replay_buffers[--replay_buffer_count];
+}
 
+static bool replay_commit(const trace_record_t *record, uint64_t *duration_ns) {
+    if (record->argc < 9) {
+        return false;
+    }
+    const drm_topology_plane_t *plane = plane_for_type((uint32_t)record->args[0]);
+    uint32_t fb_id = crtc->buffer_id;
+    if (record->args[1]) {
+        replay_buffer_t *entry = find_replay_fb(record->args[1]);
+        fb_id = entry ? entry->buf->fb_id : 0;
+    }
+    if (!plane || !fb_id) {
+        return false;
+    }
+
+    // A nonblocking commit while the last flip is in flight would only
+    // measure -EBUSY, and the recording could not have done that
+    if (replay_flip_pending) {
+        replay_wait_flip();
+    }
+
+    uint32_t flags = (uint32_t)record->args[7];
+    uint64_t start = report_time_now_ns();
+    int ret = commit_plane_fb(plane, fb_id, (uint32_t)record->args[2], (uint32_t)record->args[3],
+                              (uint32_t)record->args[4], (uint32_t)record->args[5],
+                              record->args[6] != 0, flags, NULL);
+    *duration_ns = report_time_now_ns() - start;
+    if (ret == 0 && !(flags & DRM_MODE_ATOMIC_TEST_ONLY)) {
+        replay_committed = true;
+        replay_flip_pending = (flags & DRM_MODE_PAGE_FLIP_EVENT) != 0;
+    }
+    return (ret == 0) == (record->args[8] != 0);
+}
+
+bool drm_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns) {
+    (void)context;
+    if (replay_unavailable) {
+        return false;
+    }
+    if (!replay_started) {
+        if (!crtc) {
+            if (!init_test_framework()) {
+                fprintf(stderr, "No display to replay DRM operations on\n");
+                replay_unavailable = true;
+                return false;
+            }
+            replay_opened = true;
+        }
+        replay_started = true;
+    }
+
+    replay_buffer_t *entry = record->argc ? find_replay_buffer(record->args[0]) : NULL;
+    uint64_t start = report_time_now_ns();
+    bool ok;
+    switch (record->op) {
+        case TRACE_OP_DRM_CREATE:
+            return replay_create(record, duration_ns);
+        case TRACE_OP_DRM_DESTROY:
+            if (!entry) {
+                return false;
+            }
+            replay_destroy(entry);
+            break;
+        case TRACE_OP_DRM_FILL:
+            if (!entry || record->argc < 5) {
+                return false;
+            }
+            if (record->args[1]) {
+                ok = fill_drm_buffer(entry->buf, (uint32_t)record->args[2]);
+            } else {
+                test_pattern_t pattern = {
+                    .type = (pattern_type_t)record->args[3],
+                    .value = (uint32_t)record->args[2],
+                    .step = (uint32_t)record->args[4]
+                };
+                ok = fill_drm_buffer_pattern(entry->buf, &pattern);
+            }
+            if (!ok) {
+                return false;
+            }
+            break;
+        case TRACE_OP_DRM_FRAMEBUFFER:
+            if (!entry || record->argc < 2 || !add_drm_framebuffer(entry->buf)) {
+                return false;
+            }
+            entry->recorded_fb = (uint32_t)record->args[1];
+            break;
+        case TRACE_OP_DRM_COMMIT:
+            return replay_commit(record, duration_ns);
+        case TRACE_OP_DRM_FLIP:
+            if (!replay_wait_flip()) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    *duration_ns = report_time_now_ns() - start;
     return true;
 }
+
+void drm_trace_finish(void *context) {
+    (void)context;
+    if (replay_started) {
+        replay_wait_flip();
+        if (replay_committed && crtc->buffer_id) {
+            commit_plane_fb(primary_plane, crtc->buffer_id,
+                            crtc->width, crtc->height, crtc->width, crtc->height, true, 0, NULL);
+        }
+        while (replay_buffer_count) {
+            replay_destroy(&replay_buffers[0]);
+        }
+        if (replay_opened) {
+            cleanup_test_framework();
+        }
+    }
+    free(replay_buffers);
+    replay_buffers = NULL;
+    replay_buffer_count = replay_buffer_capacity = 0;
+    replay_started = replay_opened = replay_unavailable = replay_committed = false;
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+// Host-side converter: renders binary report logs from one or more boards
+// as a text, JSON, HTML, XML, CSV or merged binary report
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <libgen.h>
+#include "report/test_report.h"
+#include "report/report_binary.h"
+
+// Histograms gathered by metric name across every session
+typedef struct merged_histogram {
+    char name[128];
+    uint32_t sessions;
+    report_histogram_t histogram;
+    struct merged_histogram *next;
+} merged_histogram_t;
+
+typedef struct {
+    test_report_t *report;
+    const char *path;               // Input being read
+    uint32_t sessions;
+    bool prefix;                    // Several sessions: label every entry
+    char title[128];
+    char description[256];
+    time_t start_time;
+    time_t end_time;
+    merged_histogram_t *histograms;
+} convert_context_t;
+
+static void usage(const char *program) {
+    printf("Usage: %s [-f FORMAT] [-o FILE] LOG...\n", program);
+    printf("  -f, --format=FORMAT   Output format (text, json, html, xml, csv, binary; default text)\n");
+    printf("  -o, --output=FILE     Output file (default: report.<format>)\n");
+    printf("  -t, --title=TITLE     Report title (default: the first log's)\n");
+    printf("Entries from several logs, or several runs in one log, are prefixed with\n");
+    printf("the board that wrote them, and latency histograms with the same name are\n");
+    printf("merged across boards.\n");
+}
+
+static bool parse_format(const char *name, report_format_t *format) {
+    static const char *names[REPORT_FORMAT_MAX] = {
+        [REPORT_FORMAT_TEXT] = "text",
+        [REPORT_FORMAT_JSON] = "json",
+        [REPORT_FORMAT_HTML] = "html",
+        [REPORT_FORMAT_XML] = "xml",
+        [REPORT_FORMAT_CSV] = "csv",
+        [REPORT_FORMAT_BINARY] = "binary",
+    };
+    for (int i = 0; i < REPORT_FORMAT_MAX; i++) {
+        if (names[i] && strcmp(name, names[i]) == 0) {
+            *format = (report_format_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Board label for a session: its hostname, else the log's file name
+static void session_label(const convert_context_t *ctx, const report_session_t *session,
+                          char *label, size_t size) {
+    if (session->device[0]) {
+        snprintf(label, size, "%s", session->device);
+    } else {
+        char path[256];
+        snprintf(path, sizeof(path), "%s", ctx->path);
+        snprintf(label, size, "%s", basename(path));
+    }
+}
+
+static void prefixed_name(const convert_context_t *ctx, const report_session_t *session,
+                          const char *name, char *buffer, size_t size) {
+    if (ctx->prefix) {
+        char label[64];
+        session_label(ctx, session, label, sizeof(label));
+        snprintf(buffer, size, "%s: %s", label, name);
+    } else {
+        snprintf(buffer, size, "%s", name);
+    }
+}
+
+// First pass: how many sessions, and the time span they cover
+static void scan_begin(void *context, const report_session_t *session) {
+    convert_context_t *ctx = context;
+    if (ctx->sessions == 0) {
+        snprintf(ctx->title, sizeof(ctx->title), "%s", session->title);
+        snprintf(ctx->description, sizeof(ctx->description), "%s", session->description);
+    }
+    if (ctx->sessions == 0 || session->start_time < ctx->start_time) {
+        ctx->start_time = session->start_time;
+    }
+    ctx->sessions++;
+}
+
+static void scan_end(void *context, const report_session_t *session) {
+    convert_context_t *ctx = context;
+    if (session->end_time > ctx->end_time) {
+        ctx->end_time = session->end_time;
+    }
+}
+
+// Second pass: replay every entry into the output report
+static void replay_test_result(void *context, const report_session_t *session, const test_result_entry_t *entry) {
+    convert_context_t *ctx = context;
+    test_result_entry_t copy = *entry;
+    prefixed_name(ctx, session, entry->test_name, copy.test_name, sizeof(copy.test_name));
+    report_import_test_result(ctx->report, &copy);
+}
+
+static void merge_histogram(convert_context_t *ctx, const char *name, const report_histogram_t *histogram) {
+    merged_histogram_t *merged = ctx->histograms;
+    merged_histogram_t *tail = NULL;
+    while (merged && strcmp(merged->name, name) != 0) {
+        tail = merged;
+        merged = merged->next;
+    }
+
+    if (!merged) {
+        merged = calloc(1, sizeof(merged_histogram_t));
+        if (!merged) {
+            return;
+        }
+        snprintf(merged->name, sizeof(merged->name), "%s", name);
+        report_histogram_init(&merged->histogram);
+        if (tail) {
+            tail->next = merged;
+        } else {
+            ctx->histograms = merged;
+        }
+    }
+
+    report_histogram_merge(&merged->histogram, histogram);
+    merged->sessions++;
+}
+
+static void replay_metric(void *context, const report_session_t *session, const perf_metric_entry_t *metric,
+                          const report_histogram_t *histogram) {
+    convert_context_t *ctx = context;
+    perf_metric_entry_t copy = *metric;
+    prefixed_name(ctx, session, metric->metric_name, copy.metric_name, sizeof(copy.metric_name));
+    report_import_metric(ctx->report, &copy, histogram);
+
+    if (histogram && ctx->prefix) {
+        merge_histogram(ctx, metric->metric_name, histogram);
+    }
+}
+
+static void replay_property(void *context, const report_session_t *session, const char *name, const char *value) {
+    convert_context_t *ctx = context;
+    char key[64];
+    prefixed_name(ctx, session, name, key, sizeof(key));
+    report_set_property(ctx->report, key, value);
+}
+
+int main(int argc, char *argv[]) {
+    report_format_t format = REPORT_FORMAT_TEXT;
+    const char *output = NULL;
+    const char *title = NULL;
+
+    static struct option long_options[] = {
+        {"format", required_argument, 0, 'f'},
+        {"output", required_argument, 0, 'o'},
+        {"title", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "f:o:t:h", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'f':
+                if (!parse_format(optarg, &format)) {
+                    fprintf(stderr, "Unknown report format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 't':
+                title = optarg;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    convert_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+
+    report_binary_visitor_t scan = { scan_begin, NULL, NULL, NULL, scan_end };
+    for (int i = optind; i < argc; i++) {
+        ctx.path = argv[i];
+        if (!report_binary_read(argv[i], &scan, &ctx)) {
+            return 1;
+        }
+    }
+    if (ctx.sessions == 0) {
+        fprintf(stderr, "No report sessions found\n");
+        return 1;
+    }
+    ctx.prefix = ctx.sessions > 1;
+
+    report_config_t config;
+    memset(&config, 0, sizeof(config));
+    if (output) {
+        snprintf(config.report_file, sizeof(config.report_file), "%s", output);
+    } else {
+        const char *ext = report_format_to_string(format);
+        snprintf(config.report_file, sizeof(config.report_file), "report.%s", ext);
+        for (char *p = config.report_file; *p; p++) {
+            *p = (*p >= 'A' && *p <= 'Z') ? *p - 'A' + 'a' : *p;
+        }
+    }
+    config.format = format;
+    config.include_timestamp = true;
+    config.include_system_info = true;
+    config.include_performance_metrics = true;
+    config.min_level = REPORT_LEVEL_INFO;
+
+    char merged_title[160];
+    if (!title && ctx.prefix) {
+        snprintf(merged_title, sizeof(merged_title), "%s (%u runs)", ctx.title, ctx.sessions);
+        title = merged_title;
+    }
+
+    ctx.report = report_create_at(title ? title : ctx.title, ctx.description, &config, ctx.start_time);
+    if (!ctx.report) {
+        fprintf(stderr, "Failed to create %s\n", config.report_file);
+        return 1;
+    }
+
+    report_binary_visitor_t replay = { NULL, replay_test_result, replay_metric, replay_property, NULL };
+    for (int i = optind; i < argc; i++) {
+        ctx.path = argv[i];
+        report_binary_read(argv[i], &replay, &ctx);
+    }
+
+    // Fleet-wide tails, from the raw buckets rather than averaged percentiles
+    merged_histogram_t *merged = ctx.histograms;
+    while (merged) {
+        merged_histogram_t *next = merged->next;
+        if (merged->sessions > 1) {
+            char name[160];
+            snprintf(name, sizeof(name), "%s (merged, %u runs)", merged->name, merged->sessions);
+            report_add_histogram_metric(ctx.report, name, &merged->histogram);
+        }
+        free(merged);
+        merged = next;
+    }
+
+    ctx.report->end_time = ctx.end_time;
+    bool result = report_generate(ctx.report);
+    if (result) {
+        printf("%u run(s), %u tests, %u failed: %s\n", ctx.sessions, ctx.report->total_tests,
+               ctx.report->failed_tests + ctx.report->error_tests, config.report_file);
+    } else {
+        fprintf(stderr, "Failed to write %s\n", config.report_file);
+    }
+    report_destroy(ctx.report);
+
+    return result ? 0 : 1;
+}
@@ -34,29 +34,67 @@ struct sdata {
 #define SCSI_IOCTL_SEND_COMMAND  _IOWR('S', 0x18, struct sdata)
 #endif
 #include "../../include/usb/tizen_usb_test.h"
+#include "../../include/usb/usb_discovery.h"
 #include "../../include/report/test_report.h"
 
 // Private function declarations
 static usb_test_result_t get_usb_device_class(const char *device_path, uint8_t *device_class);
 static bool is_usb_device_connected(uint16_t vendor_id, uint16_t product_id);
 
-// Test configurations
-static const uint16_t MASS_STORAGE_VID = 0x0781;  // SanDisk
-static const uint16_t MASS_STORAGE_PID = 0x5591;  // Example: Cruzer Blade
-
 bool usb_test_init(void) {
     int rc = libusb_init(NULL);
     if (rc < 0) {
         fprintf(stderr, "Failed to initialize libusb: %s\n", libusb_error_name(rc));
         return false;
     }
+    if (!usb_discovery_start()) {
+        libusb_exit(NULL);
+        return false;
+    }
     return true;
 }
 
 void usb_test_cleanup(void) {
+    usb_discovery_stop();
     libusb_exit(NULL);
 }
 
+// Whether the requested VID/PID (if any) names a device with an interface
+// of this class, from its descriptors rather than a hardcoded ID
+static bool filter_has_class(const usb_test_config_t *config, uint8_t device_class) {
+    if (config->device) {
+        return usb_device_has_class(config->device, device_class);
+    }
+    if (config->vendor_id == 0 && config->product_id == 0) {
+        return true;
+    }
+    return usb_discovery_find(config->vendor_id, config->product_id, device_class, NULL);
+}
+
+// The configured path, or the node of the bound device (or else the first
+// discovered one) of the class: its disk for mass storage, its usbfs node
+// otherwise. NULL (and a skip) when there is none.
+static const char *class_device_path(const usb_test_config_t *config, uint8_t device_class,
+                                     usb_device_entry_t *entry) {
+    if (config->test_device_path) {
+        return config->test_device_path;
+    }
+    if (config->device) {
+        *entry = *config->device;
+    } else if (!usb_discovery_find(config->vendor_id, config->product_id, device_class, entry)) {
+        printf("\n[SKIP] No device of class 0x%02x found\n", device_class);
+        return NULL;
+    }
+    if (device_class != USB_CLASS_MASS_STORAGE) {
+        return entry->dev_node;
+    }
+    if (!entry->block_node[0]) {
+        printf("\n[SKIP] %s has no disk yet\n", entry->port_path);
+        return NULL;
+    }
+    return entry->block_node;
+}
+
 int usb_test_run_all(const usb_test_config_t *config) {
     if (!config) {
         return -1;
@@ -66,8 +104,9 @@ int usb_test_run_all(const usb_test_config_t *config) {
     usb_test_result_t result;
     bool device_found = true;
 
-    // Check if a specific vendor/product ID was requested
-    if (config->vendor_id != 0 || config->product_id != 0) {
+    // Check if a specific vendor/product ID was requested; a bound device
+    // was found already
+    if (!config->device && (config->vendor_id != 0 || config->product_id != 0)) {
         device_found = is_usb_device_connected(config->vendor_id, config->product_id);
         if (!device_found) {
             printf("\n[WARNING] Requested USB device %04x:%04x not found.\n", 
@@ -82,11 +121,11 @@ int usb_test_run_all(const usb_test_config_t *config) {
     // Test USB Mass Storage
     if (config->run_mass_storage_tests) {
         printf("\n[TEST] USB Mass Storage...");
-        if (config->vendor_id == 0 || 
-            (config->vendor_id == MASS_STORAGE_VID && 
-             (config->product_id == 0 || config->product_id == MASS_STORAGE_PID))) {
-            result = test_usb_mass_storage(config->test_device_path);
-            if (result != USB_TEST_PASSED) {
+        if (filter_has_class(config, USB_CLASS_MASS_STORAGE)) {
+            usb_device_entry_t entry;
+            const char *device_path = class_device_path(config, USB_CLASS_MASS_STORAGE, &entry);
+            result = device_path ? test_usb_mass_storage(device_path) : USB_TEST_SKIPPED;
+            if (result != USB_TEST_PASSED && result != USB_TEST_SKIPPED) {
                 failed_tests++;
             }
         } else {
@@ -98,10 +137,11 @@ int usb_test_run_all(const usb_test_config_t *config) {
     if (config->run_hid_tests) {
         printf("\n[TEST] USB HID Devices...");
         // Only run HID test if no specific device is requested or if it matches the HID class
-        if (config->vendor_id == 0 || 
-            (config->vendor_id != MASS_STORAGE_VID)) {  // Simple example, should check HID VID/PID
-            result = test_usb_hid(config->test_device_path);
-            if (result != USB_TEST_PASSED) {
+        if (filter_has_class(config, USB_CLASS_HID)) {
+            usb_device_entry_t entry;
+            const char *device_path = class_device_path(config, USB_CLASS_HID, &entry);
+            result = device_path ? test_usb_hid(device_path) : USB_TEST_SKIPPED;
+            if (result != USB_TEST_PASSED && result != USB_TEST_SKIPPED) {
                 failed_tests++;
             }
         } else {
@@ -112,10 +152,11 @@ int usb_test_run_all(const usb_test_config_t *config) {
     // Test USB Audio Devices
     if (config->run_audio_tests) {
         printf("\n[TEST] USB Audio Devices...");
-        if (config->vendor_id == 0 || 
-            (config->vendor_id != MASS_STORAGE_VID)) {  // Simple example, should check Audio VID/PID
-            result = test_usb_audio(config->test_device_path);
-            if (result != USB_TEST_PASSED) {
+        if (filter_has_class(config, USB_CLASS_AUDIO)) {
+            usb_device_entry_t entry;
+            const char *device_path = class_device_path(config, USB_CLASS_AUDIO, &entry);
+            result = device_path ? test_usb_audio(device_path) : USB_TEST_SKIPPED;
+            if (result != USB_TEST_PASSED && result != USB_TEST_SKIPPED) {
                 failed_tests++;
             }
         } else {
@@ -126,10 +167,11 @@ int usb_test_run_all(const usb_test_config_t *config) {
     // Test USB Wireless Devices
     if (config->run_wireless_tests) {
         printf("\n[TEST] USB Wireless Devices...");
-        if (config->vendor_id == 0 || 
-            (config->vendor_id != MASS_STORAGE_VID)) {  // Simple example, should check Wireless VID/PID
-            result = test_usb_wireless(config->test_device_path);
-            if (result != USB_TEST_PASSED) {
+        if (filter_has_class(config, USB_CLASS_WIRELESS)) {
+            usb_device_entry_t entry;
+            const char *device_path = class_device_path(config, USB_CLASS_WIRELESS, &entry);
+            result = device_path ? test_usb_wireless(device_path) : USB_TEST_SKIPPED;
+            if (result != USB_TEST_PASSED && result != USB_TEST_SKIPPED) {
                 failed_tests++;
             }
         } else {
@@ -266,9 +308,8 @@ usb_test_result_t test_usb_mass_storage(const char *device_path) {
     // Clean up
     close(fd);
     
-    // TODO: Add more comprehensive tests (e.g., mount, filesystem operations)
-    printf("[INFO] Additional mass storage tests not implemented yet\n");
-    
+    // Throughput, IOPS and latency come from the usb_storage benchmark,
+    // which the test runner drives with its block size and queue depth
     return USB_TEST_PASSED;
 }
 
@@ -288,9 +329,8 @@ usb_test_result_t test_usb_hid(const char *device_path) {
     }
     printf("PASSED\n");
     
-    // TODO: Implement actual HID device tests
-    printf("[INFO] HID device test not fully implemented yet\n");
-    
+    // Endpoint traffic is measured by the usb_transfer engine, which the
+    // test runner drives for every matching device at once
     return USB_TEST_PASSED;
 }
 
@@ -310,9 +350,8 @@ usb_test_result_t test_usb_audio(const char *device_path) {
     }
     printf("PASSED\n");
     
-    // TODO: Implement actual audio device tests
-    printf("[INFO] USB Audio device test not fully implemented yet\n");
-    
+    // Endpoint traffic is measured by the usb_transfer engine, which the
+    // test runner drives for every matching device at once
     return USB_TEST_PASSED;
 }
 
@@ -332,9 +371,8 @@ usb_test_result_t test_usb_wireless(const char *device_path) {
     }
     printf("PASSED\n");
     
-    // TODO: Implement actual wireless device tests
-    printf("[INFO] USB Wireless device test not fully implemented yet\n");
-    
+    // Endpoint traffic is measured by the usb_transfer engine, which the
+    // test runner drives for every matching device at once
     return USB_TEST_PASSED;
 }
 
@@ -350,61 +388,22 @@ static usb_test_result_t get_usb_device_class(const char *device_path, uint8_t *
     return USB_TEST_ERROR;
 }
 
-// Helper function to check if a specific USB device is connected
+// Helper function to check if a specific USB device is connected. Answered
+// from the hotplug-maintained cache; a device that is re-enumerating gets a
+// few seconds to come back.
 static bool is_usb_device_connected(uint16_t vendor_id, uint16_t product_id) {
-    libusb_device **devs = NULL;
-    libusb_device *dev = NULL;
-    int i = 0;
-    bool found = false;
-
     if (vendor_id == 0 && product_id == 0) {
         printf("[WARNING] No vendor or product ID specified for device check\n");
         return false;
     }
 
-    // Get the list of USB devices
-    ssize_t cnt = libusb_get_device_list(NULL, &devs);
-    if (cnt < 0) {
-        printf("[ERROR] Failed to get USB device list: %s\n", libusb_error_name((int)cnt));
-        return false;
-    }
-
-    if (cnt == 0) {
-        printf("[INFO] No USB devices found\n");
-        libusb_free_device_list(devs, 1);
+    usb_device_entry_t entry;
+    if (!usb_discovery_wait(vendor_id, product_id, 0, USB_DISCOVERY_ARRIVAL_WAIT_MS, &entry)) {
+        printf("[DEBUG] No matching device found for %04x:%04x\n", vendor_id, product_id);
         return false;
     }
 
-    printf("[DEBUG] Scanning %zd USB devices...\n", cnt);
-
-    // Iterate through all USB devices
-    while ((dev = devs[i++]) != NULL) {
-        struct libusb_device_descriptor desc;
-        int r = libusb_get_device_descriptor(dev, &desc);
-        if (r < 0) {
-            printf("[WARNING] Failed to get device descriptor: %s\n", libusb_error_name(r));
-            continue;
-        }
-
-        // If vendor_id is 0, match any vendor; same for product_id
-        bool vendor_match = (vendor_id == 0) || (desc.idVendor == vendor_id);
-        bool product_match = (product_id == 0) || (desc.idProduct == product_id);
-
-        if (vendor_match && product_match) {
-            printf("[DEBUG] Found matching device: %04x:%04x\n", 
-                   desc.idVendor, desc.idProduct);
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
-        printf("[DEBUG] No matching device found for %04x:%04x\n", 
-               vendor_id, product_id);
-    }
-
-    // Free the device list
-    libusb_free_device_list(devs, 1);
-    
-    return found;
+    printf("[DEBUG] Found matching device: %04x:%04x at %s (%s)\n",
+           entry.vendor_id, entry.product_id, entry.port_path, entry.dev_node);
+    return true;
 }
@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "usb/usb_discovery.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <glob.h>
+#include <time.h>
+#include <pthread.h>
+#include <libusb-1.0/libusb.h>
+
+#define USB_CLASS_MASS_STORAGE_ID 0x08
+#define EVENT_TIMEOUT_US 100000
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t arrived = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t ready_changed = PTHREAD_COND_INITIALIZER;
+static usb_device_entry_t devices[USB_DISCOVERY_MAX_DEVICES];
+static uint32_t device_count;
+static uint32_t users;
+static bool ready;                 // The first start has filled the cache
+static bool hotplug;
+static libusb_hotplug_callback_handle hotplug_handle;
+static pthread_t event_thread;
+static int stop_events;
+static uint64_t last_scan_ns;
+
+static void describe_device(libusb_device *device, usb_device_entry_t *entry) {
+    memset(entry, 0, sizeof(usb_device_entry_t));
+    entry->bus = libusb_get_bus_number(device);
+    entry->address = libusb_get_device_address(device);
+
+    uint8_t ports[7];
+    int port_count = libusb_get_port_numbers(device, ports, sizeof(ports));
+    if (port_count <= 0) {
+        snprintf(entry->port_path, sizeof(entry->port_path), "usb%u", entry->bus);
+    } else {
+        int length = snprintf(entry->port_path, sizeof(entry->port_path), "%u-%u", entry->bus, ports[0]);
+        for (int i = 1; i < port_count && length < (int)sizeof(entry->port_path); i++) {
+            length += snprintf(entry->port_path + length, sizeof(entry->port_path) - length, ".%u", ports[i]);
+        }
+    }
+    snprintf(entry->sysfs_path, sizeof(entry->sysfs_path), "/sys/bus/usb/devices/%s", entry->port_path);
+    snprintf(entry->dev_node, sizeof(entry->dev_node), "/dev/bus/usb/%03u/%03u", entry->bus, entry->address);
+
+    struct libusb_device_descriptor desc;
+    if (libusb_get_device_descriptor(device, &desc) == 0) {
+        entry->vendor_id = desc.idVendor;
+        entry->product_id = desc.idProduct;
+        entry->device_class = desc.bDeviceClass;
+    }
+
+    // Descriptors come from the kernel's cached copy, so this is safe in a
+    // hotplug callback
+    struct libusb_config_descriptor *config;
+    if (libusb_get_active_config_descriptor(device, &config) == 0) {
+        for (uint8_t i = 0; i < config->bNumInterfaces && entry->interface_count < USB_DISCOVERY_MAX_INTERFACES; i++) {
+            if (config->interface[i].num_altsetting > 0) {
+                entry->interface_classes[entry->interface_count++] = config->interface[i].altsetting[0].bInterfaceClass;
+            }
+        }
+        libusb_free_config_descriptor(config);
+    }
+}
+
+// Caller holds the lock
+static usb_device_entry_t *slot_for_port(const char *port_path) {
+    for (uint32_t i = 0; i < device_count; i++) {
+        if (strcmp(devices[i].port_path, port_path) == 0) {
+            return &devices[i];
+        }
+    }
+    if (device_count == USB_DISCOVERY_MAX_DEVICES) {
+        return NULL;
+    }
+    return &devices[device_count++];
+}
+
+// Returns the slot, or NULL when the cache is full. Caller holds the lock.
+static usb_device_entry_t *add_device(libusb_device *device) {
+    usb_device_entry_t entry;
+    describe_device(device, &entry);
+    usb_device_entry_t *slot = slot_for_port(entry.port_path);
+    if (!slot) {
+        fprintf(stderr, "USB discovery cache full, ignoring %s\n", entry.port_path);
+        return NULL;
+    }
+    entry.generation = slot->generation + 1;
+    entry.present = true;
+    *slot = entry;
+    pthread_cond_broadcast(&arrived);
+    return slot;
+}
+
+// Caller holds the lock
+static void remove_device(uint8_t bus, uint8_t address) {
+    for (uint32_t i = 0; i < device_count; i++) {
+        if (devices[i].present && devices[i].bus == bus && devices[i].address == address) {
+            devices[i].present = false;
+            devices[i].block_node[0] = '\0';
+        }
+    }
+}
+
+static int LIBUSB_CALL hotplug_event(libusb_context *context, libusb_device *device,
+                                     libusb_hotplug_event event, void *user_data) {
+    (void)context;
+    (void)user_data;
+    pthread_mutex_lock(&lock);
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+        add_device(device);
+    } else {
+        remove_device(libusb_get_bus_number(device), libusb_get_device_address(device));
+    }
+    pthread_mutex_unlock(&lock);
+    return 0;                     // Stay registered
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Full bus walk, only where libusb cannot deliver hotplug events. Caller
+// holds the lock.
+static void rescan(void) {
+    libusb_device **list = NULL;
+    ssize_t count = libusb_get_device_list(NULL, &list);
+    if (count < 0) {
+        fprintf(stderr, "Failed to get USB device list: %s\n", libusb_error_name((int)count));
+        return;
+    }
+
+    bool seen[USB_DISCOVERY_MAX_DEVICES] = { false };
+    for (ssize_t i = 0; i < count; i++) {
+        uint8_t bus = libusb_get_bus_number(list[i]);
+        uint8_t address = libusb_get_device_address(list[i]);
+        bool known = false;
+        for (uint32_t d = 0; d < device_count; d++) {
+            if (devices[d].present && devices[d].bus == bus && devices[d].address == address) {
+                seen[d] = known = true;
+            }
+        }
+        usb_device_entry_t *slot = known ? NULL : add_device(list[i]);
+        if (slot) {
+            seen[slot - devices] = true;
+        }
+    }
+    for (uint32_t d = 0; d < device_count; d++) {
+        if (!seen[d]) {
+            devices[d].present = false;
+            devices[d].block_node[0] = '\0';
+        }
+    }
+    libusb_free_device_list(list, 1);
+    last_scan_ns = monotonic_ns();
+}
+
+// Without hotplug events the cache is only as fresh as the last walk.
+// Caller holds the lock.
+static void refresh(void) {
+    if (!hotplug && users > 0 && monotonic_ns() - last_scan_ns >= USB_DISCOVERY_RESCAN_MS * 1000000ULL) {
+        rescan();
+    }
+}
+
+static void *event_thread_main(void *arg) {
+    (void)arg;
+    struct timeval tv = { 0, EVENT_TIMEOUT_US };
+    while (!__atomic_load_n(&stop_events, __ATOMIC_ACQUIRE)) {
+        libusb_handle_events_timeout_completed(NULL, &tv, &stop_events);
+    }
+    return NULL;
+}
+
+// Caller holds the lock
+static void set_ready(void) {
+    ready = true;
+    pthread_cond_broadcast(&ready_changed);
+}
+
+bool usb_discovery_start(void) {
+    pthread_mutex_lock(&lock);
+    if (users++ > 0) {
+        // The first caller registers with the lock dropped, since the
+        // enumeration callbacks take it; wait until they have all run
+        while (!ready) {
+            pthread_cond_wait(&ready_changed, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+        return true;
+    }
+
+    hotplug = libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG);
+    if (!hotplug) {
+        rescan();
+        set_ready();
+        pthread_mutex_unlock(&lock);
+        return true;
+    }
+    pthread_mutex_unlock(&lock);
+
+    // ENUMERATE delivers the devices already present as arrivals, before
+    // the register call returns
+    int rc = libusb_hotplug_register_callback(NULL, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                              LIBUSB_HOTPLUG_ENUMERATE, LIBUSB_HOTPLUG_MATCH_ANY,
+                                              LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                              hotplug_event, NULL, &hotplug_handle);
+    pthread_mutex_lock(&lock);
+    if (rc != LIBUSB_SUCCESS) {
+        fprintf(stderr, "USB hotplug registration failed (%s), scanning instead\n", libusb_error_name(rc));
+        hotplug = false;
+        rescan();
+        set_ready();
+        pthread_mutex_unlock(&lock);
+        return true;
+    }
+
+    __atomic_store_n(&stop_events, 0, __ATOMIC_RELEASE);
+    if (pthread_create(&event_thread, NULL, event_thread_main, NULL) != 0) {
+        fprintf(stderr, "Cannot start the USB event thread\n");
+        libusb_hotplug_deregister_callback(NULL, hotplug_handle);
+        hotplug = false;
+        rescan();
+    }
+    set_ready();
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+void usb_discovery_stop(void) {
+    pthread_mutex_lock(&lock);
+    if (users == 0 || --users > 0) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    bool had_hotplug = hotplug;
+    hotplug = false;
+    ready = false;
+    pthread_mutex_unlock(&lock);
+
+    if (had_hotplug) {
+        libusb_hotplug_deregister_callback(NULL, hotplug_handle);
+        __atomic_store_n(&stop_events, 1, __ATOMIC_RELEASE);
+        pthread_join(event_thread, NULL);
+    }
+
+    pthread_mutex_lock(&lock);
+    memset(devices, 0, sizeof(devices));
+    device_count = 0;
+    pthread_mutex_unlock(&lock);
+}
+
+bool usb_device_has_class(const usb_device_entry_t *entry, uint8_t device_class) {
+    if (device_class == 0 || entry->device_class == device_class) {
+        return true;
+    }
+    for (uint8_t i = 0; i < entry->interface_count; i++) {
+        if (entry->interface_classes[i] == device_class) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The disk appears some time after the device does, once usb-storage and
+// the SCSI scan have bound, so it is looked up at query time. Caller holds
+// the lock.
+static void resolve_block_node(usb_device_entry_t *entry) {
+    if (!entry->present || entry->block_node[0] || !usb_device_has_class(entry, USB_CLASS_MASS_STORAGE_ID)) {
+        return;
+    }
+
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "%s:*/host*/target*/*:*/block/*", entry->sysfs_path);
+    glob_t matches;
+    if (glob(pattern, 0, NULL, &matches) == 0 && matches.gl_pathc > 0) {
+        const char *name = strrchr(matches.gl_pathv[0], '/');
+        snprintf(entry->block_node, sizeof(entry->block_node), "/dev/%.24s", name + 1);
+    }
+    globfree(&matches);
+}
+
+uint32_t usb_discovery_count(void) {
+    pthread_mutex_lock(&lock);
+    refresh();
+    uint32_t count = device_count;
+    pthread_mutex_unlock(&lock);
+    return count;
+}
+
+bool usb_discovery_get(uint32_t index, usb_device_entry_t *entry) {
+    pthread_mutex_lock(&lock);
+    refresh();
+    bool found = index < device_count && devices[index].present;
+    if (found) {
+        resolve_block_node(&devices[index]);
+        *entry = devices[index];
+    }
+    pthread_mutex_unlock(&lock);
+    return found;
+}
+
+bool usb_discovery_get_at(uint8_t bus, uint8_t address, usb_device_entry_t *entry) {
+    pthread_mutex_lock(&lock);
+    refresh();
+    bool found = false;
+    for (uint32_t i = 0; i < device_count && !found; i++) {
+        found = devices[i].present && devices[i].bus == bus && devices[i].address == address;
+        if (found) {
+            resolve_block_node(&devices[i]);
+            *entry = devices[i];
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return found;
+}
+
+// Caller holds the lock
+static bool find_locked(uint16_t vendor_id, uint16_t product_id, uint8_t device_class, usb_device_entry_t *entry) {
+    for (uint32_t i = 0; i < device_count; i++) {
+        usb_device_entry_t *device = &devices[i];
+        if (device->present && (!vendor_id || device->vendor_id == vendor_id) &&
+            (!product_id || device->product_id == product_id) && usb_device_has_class(device, device_class)) {
+            resolve_block_node(device);
+            if (entry) {
+                *entry = *device;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool usb_discovery_find(uint16_t vendor_id, uint16_t product_id, uint8_t device_class,
+                        usb_device_entry_t *entry) {
+    pthread_mutex_lock(&lock);
+    refresh();
+    bool found = find_locked(vendor_id, product_id, device_class, entry);
+    pthread_mutex_unlock(&lock);
+    return found;
+}
+
+bool usb_discovery_wait(uint16_t vendor_id, uint16_t product_id, uint8_t device_class,
+                        uint32_t timeout_ms, usb_device_entry_t *entry) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&lock);
+    refresh();
+    bool found = find_locked(vendor_id, product_id, device_class, entry);
+    while (!found) {
+        int rc;
+        if (hotplug) {
+            rc = pthread_cond_timedwait(&arrived, &lock, &deadline);
+        } else {
+            // Nothing will signal; poll the bus instead
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            rc = now.tv_sec > deadline.tv_sec ||
+                 (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec) ? ETIMEDOUT : 0;
+            if (rc == 0) {
+                pthread_mutex_unlock(&lock);
+                struct timespec pause = { 0, USB_DISCOVERY_RESCAN_MS * 1000000L };
+                nanosleep(&pause, NULL);
+                pthread_mutex_lock(&lock);
+                rescan();
+            }
+        }
+        found = find_locked(vendor_id, product_id, device_class, entry);
+        if (rc == ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return found;
+}
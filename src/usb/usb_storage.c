@@ -0,0 +1,723 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "usb/usb_storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#include <linux/fs.h>
+#include <linux/aio_abi.h>
+#include <scsi/sg.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#define SG_TIMEOUT_MS 5000
+#define SENSE_SIZE 32
+#define MAX_ERRORS 8              // Then stop submitting and drain
+#define DIRECT_ALIGN 4096
+
+// One request buffer and what is in flight on it
+typedef struct {
+    void *buffer;
+    uint64_t offset;              // Bytes
+    uint64_t submit_ns;
+} io_slot_t;
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t logical_block_size;
+    uint64_t requests_per_device; // block_size requests that fit
+    uint64_t next;                // Sequential cursor, in requests
+    uint64_t rng;
+    usb_storage_pattern_t pattern;
+    io_slot_t slots[USB_STORAGE_MAX_QUEUE_DEPTH];
+    uint32_t depth;
+    usb_storage_stats_t *stats;
+} storage_run_t;
+
+// submit() may only queue; reap() pushes anything queued and waits for one
+// completion, returning its slot and the bytes it moved (or -errno)
+typedef struct {
+    bool (*submit)(void *engine, storage_run_t *run, uint32_t slot);
+    bool (*reap)(void *engine, storage_run_t *run, uint32_t *slot, int64_t *result);
+} storage_ops_t;
+
+static uint64_t next_offset(storage_run_t *run) {
+    uint64_t request;
+    if (run->pattern == USB_STORAGE_RANDOM) {
+        // xorshift64*, plenty for spreading requests over the device
+        run->rng ^= run->rng >> 12;
+        run->rng ^= run->rng << 25;
+        run->rng ^= run->rng >> 27;
+        request = (run->rng * 2685821657736338717ULL) % run->requests_per_device;
+    } else {
+        request = run->next++ % run->requests_per_device;
+    }
+    return request * run->block_size;
+}
+
+static bool alloc_slots(storage_run_t *run) {
+    for (uint32_t i = 0; i < run->depth; i++) {
+        if (posix_memalign(&run->slots[i].buffer, DIRECT_ALIGN, run->block_size) != 0) {
+            run->slots[i].buffer = NULL;
+            fprintf(stderr, "Cannot allocate %u byte request buffer\n", run->block_size);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void free_slots(storage_run_t *run) {
+    for (uint32_t i = 0; i < run->depth; i++) {
+        free(run->slots[i].buffer);
+        run->slots[i].buffer = NULL;
+    }
+}
+
+static bool init_run(storage_run_t *run, const usb_storage_config_t *config, usb_storage_pattern_t pattern,
+                     uint32_t max_depth, uint64_t device_bytes, uint32_t logical_block_size,
+                     usb_storage_stats_t *stats) {
+    memset(run, 0, sizeof(storage_run_t));
+    run->block_size = config->block_size ? config->block_size : USB_STORAGE_DEFAULT_BLOCK_SIZE;
+    run->logical_block_size = logical_block_size;
+    run->pattern = pattern;
+    run->rng = 0x9E3779B97F4A7C15ULL;
+    run->depth = config->queue_depth ? config->queue_depth : USB_STORAGE_DEFAULT_QUEUE_DEPTH;
+    if (run->depth > max_depth) {
+        run->depth = max_depth;
+    }
+    run->stats = stats;
+
+    if (logical_block_size == 0 || run->block_size % logical_block_size || run->block_size % DIRECT_ALIGN) {
+        fprintf(stderr, "Block size %u is not a multiple of the %u byte logical block and %u byte alignment\n",
+                run->block_size, logical_block_size, DIRECT_ALIGN);
+        return false;
+    }
+    run->requests_per_device = device_bytes / run->block_size;
+    if (run->requests_per_device == 0) {
+        fprintf(stderr, "Device of %llu bytes is smaller than one request\n", (unsigned long long)device_bytes);
+        return false;
+    }
+
+    stats->pattern = pattern;
+    stats->block_size = run->block_size;
+    stats->queue_depth = run->depth;
+    report_histogram_init(&stats->latency);
+    return alloc_slots(run);
+}
+
+// Keeps every slot in flight until the deadline, then drains
+static bool run_queue(storage_run_t *run, const storage_ops_t *ops, void *engine, uint32_t duration) {
+    usb_storage_stats_t *stats = run->stats;
+    uint64_t start_ns = report_time_now_ns();
+    uint64_t end_ns = start_ns + (uint64_t)(duration ? duration : USB_STORAGE_DEFAULT_DURATION) * 1000000000ULL;
+    uint32_t inflight = 0;
+    bool result = true;
+
+    for (uint32_t i = 0; i < run->depth; i++) {
+        run->slots[i].offset = next_offset(run);
+        run->slots[i].submit_ns = report_time_now_ns();
+        if (!ops->submit(engine, run, i)) {
+            result = false;
+            break;
+        }
+        inflight++;
+    }
+
+    while (inflight > 0) {
+        uint32_t slot;
+        int64_t bytes;
+        if (!ops->reap(engine, run, &slot, &bytes)) {
+            result = false;
+            break;
+        }
+        uint64_t now_ns = report_time_now_ns();
+        inflight--;
+
+        if (bytes == run->block_size) {
+            report_histogram_record(&stats->latency, now_ns - run->slots[slot].submit_ns);
+            stats->requests++;
+            stats->bytes += (uint64_t)bytes;
+        } else if (stats->errors++ == 0) {
+            fprintf(stderr, "Read at offset %llu returned %lld\n",
+                    (unsigned long long)run->slots[slot].offset, (long long)bytes);
+        }
+
+        if (!result || now_ns >= end_ns || stats->errors >= MAX_ERRORS) {
+            continue;
+        }
+        run->slots[slot].offset = next_offset(run);
+        run->slots[slot].submit_ns = now_ns;
+        if (!ops->submit(engine, run, slot)) {
+            result = false;
+            continue;
+        }
+        inflight++;
+    }
+
+    uint64_t elapsed_ns = report_time_now_ns() - start_ns;
+    if (elapsed_ns > 0) {
+        stats->mbps = (double)stats->bytes * 1e3 / (double)elapsed_ns;
+        stats->iops = (double)stats->requests * 1e9 / (double)elapsed_ns;
+    }
+    return result && stats->requests > 0;
+}
+
+// ---------------------------------------------------------------------------
+// SCSI generic
+
+static bool sg_command(int fd, const uint8_t *cdb, uint8_t cdb_len, void *data, uint32_t length) {
+    uint8_t sense[SENSE_SIZE];
+    sg_io_hdr_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.interface_id = 'S';
+    hdr.cmd_len = cdb_len;
+    hdr.cmdp = (uint8_t *)cdb;
+    hdr.mx_sb_len = sizeof(sense);
+    hdr.sbp = sense;
+    hdr.dxfer_direction = SG_DXFER_FROM_DEV;
+    hdr.dxfer_len = length;
+    hdr.dxferp = data;
+    hdr.timeout = SG_TIMEOUT_MS;
+
+    if (ioctl(fd, SG_IO, &hdr) < 0) {
+        fprintf(stderr, "SG_IO failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (hdr.status || hdr.host_status || hdr.driver_status) {
+        fprintf(stderr, "SCSI command 0x%02x failed: status 0x%02x host 0x%02x driver 0x%02x\n",
+                cdb[0], hdr.status, hdr.host_status, hdr.driver_status);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static void put_be(uint8_t *p, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        p[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+static bool read_capacity(int fd, uint64_t *blocks, uint32_t *logical_block_size) {
+    uint8_t cdb10[10] = { 0x25 };
+    uint8_t data[32];
+    memset(data, 0, sizeof(data));
+    if (!sg_command(fd, cdb10, sizeof(cdb10), data, 8)) {
+        return false;
+    }
+
+    uint32_t last = get_be32(data);
+    *logical_block_size = get_be32(data + 4);
+    if (last != 0xFFFFFFFF) {
+        *blocks = (uint64_t)last + 1;
+        return true;
+    }
+
+    // SERVICE ACTION IN(16) / READ CAPACITY(16)
+    uint8_t cdb16[16] = { 0x9E, 0x10 };
+    put_be(cdb16 + 10, sizeof(data), 4);
+    memset(data, 0, sizeof(data));
+    if (!sg_command(fd, cdb16, sizeof(cdb16), data, sizeof(data))) {
+        return false;
+    }
+    *blocks = ((uint64_t)get_be32(data) << 32 | get_be32(data + 4)) + 1;
+    *logical_block_size = get_be32(data + 8);
+    return true;
+}
+
+bool usb_storage_capacity(const char *device_path, uint64_t *blocks, uint32_t *logical_block_size) {
+    if (!device_path || !blocks || !logical_block_size) {
+        return false;
+    }
+
+    int fd = open(device_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", device_path, strerror(errno));
+        return false;
+    }
+    bool result = read_capacity(fd, blocks, logical_block_size) && *logical_block_size > 0;
+    close(fd);
+    return result;
+}
+
+// /dev/sgN as given, or the sg node sysfs lists under a /dev/sdX disk (or
+// under the disk a partition belongs to)
+static bool find_sg_node(const char *device_path, char *sg_path, size_t size) {
+    struct stat st;
+    if (stat(device_path, &st) < 0) {
+        fprintf(stderr, "Cannot stat %s: %s\n", device_path, strerror(errno));
+        return false;
+    }
+    if (S_ISCHR(st.st_mode)) {
+        snprintf(sg_path, size, "%s", device_path);
+        return true;
+    }
+    if (!S_ISBLK(st.st_mode)) {
+        fprintf(stderr, "%s is not a block or sg device\n", device_path);
+        return false;
+    }
+
+    static const char *const layouts[] = { "%s/device/scsi_generic", "%s/../device/scsi_generic" };
+    char base[64];
+    snprintf(base, sizeof(base), "/sys/dev/block/%u:%u", major(st.st_rdev), minor(st.st_rdev));
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+        char dir_path[128];
+        snprintf(dir_path, sizeof(dir_path), layouts[i], base);
+        DIR *dir = opendir(dir_path);
+        if (!dir) {
+            continue;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] != '.') {
+                snprintf(sg_path, size, "/dev/%.32s", entry->d_name);
+                closedir(dir);
+                return true;
+            }
+        }
+        closedir(dir);
+    }
+
+    fprintf(stderr, "No sg node for %s (is the sg module loaded?)\n", device_path);
+    return false;
+}
+
+typedef struct {
+    int fd;
+    sg_io_hdr_t hdrs[SG_MAX_QUEUE];
+    uint8_t cdbs[SG_MAX_QUEUE][16];
+    uint8_t sense[SG_MAX_QUEUE][SENSE_SIZE];
+} sg_engine_t;
+
+static bool sg_submit(void *engine, storage_run_t *run, uint32_t slot) {
+    sg_engine_t *sg = engine;
+    uint64_t lba = run->slots[slot].offset / run->logical_block_size;
+    uint32_t count = run->block_size / run->logical_block_size;
+    uint8_t *cdb = sg->cdbs[slot];
+    sg_io_hdr_t *hdr = &sg->hdrs[slot];
+
+    memset(cdb, 0, 16);
+    memset(hdr, 0, sizeof(sg_io_hdr_t));
+    if (lba + count > 0xFFFFFFFFULL || count > 0xFFFF) {
+        cdb[0] = 0x88;                    // READ(16)
+        put_be(cdb + 2, lba, 8);
+        put_be(cdb + 10, count, 4);
+        hdr->cmd_len = 16;
+        run->stats->read16++;
+    } else {
+        cdb[0] = 0x28;                    // READ(10)
+        put_be(cdb + 2, lba, 4);
+        put_be(cdb + 7, count, 2);
+        hdr->cmd_len = 10;
+    }
+
+    hdr->interface_id = 'S';
+    hdr->cmdp = cdb;
+    hdr->mx_sb_len = SENSE_SIZE;
+    hdr->sbp = sg->sense[slot];
+    hdr->dxfer_direction = SG_DXFER_FROM_DEV;
+    hdr->dxfer_len = run->block_size;
+    hdr->dxferp = run->slots[slot].buffer;
+    hdr->timeout = SG_TIMEOUT_MS;
+    hdr->pack_id = (int)slot;
+    hdr->usr_ptr = (void *)(uintptr_t)slot;
+
+    while (write(sg->fd, hdr, sizeof(sg_io_hdr_t)) < 0) {
+        if (errno != EINTR) {
+            fprintf(stderr, "sg write failed: %s\n", strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sg_reap(void *engine, storage_run_t *run, uint32_t *slot, int64_t *result) {
+    sg_engine_t *sg = engine;
+    sg_io_hdr_t done;
+    memset(&done, 0, sizeof(done));
+    done.interface_id = 'S';
+    done.pack_id = -1;                    // Whichever finishes first
+
+    while (read(sg->fd, &done, sizeof(done)) < 0) {
+        if (errno != EINTR) {
+            fprintf(stderr, "sg read failed: %s\n", strerror(errno));
+            return false;
+        }
+    }
+
+    *slot = (uint32_t)(uintptr_t)done.usr_ptr;
+    if (*slot >= run->depth) {
+        fprintf(stderr, "sg returned unknown request %u\n", *slot);
+        return false;
+    }
+    bool ok = !done.status && !done.host_status && !done.driver_status;
+    *result = ok ? (int64_t)run->block_size - done.resid : -EIO;
+    return true;
+}
+
+static const storage_ops_t sg_ops = { sg_submit, sg_reap };
+
+bool usb_storage_bench_sg(const usb_storage_config_t *config, usb_storage_pattern_t pattern,
+                          usb_storage_stats_t *stats) {
+    if (!config || !config->device_path || !stats) {
+        return false;
+    }
+    memset(stats, 0, sizeof(usb_storage_stats_t));
+    stats->engine = USB_STORAGE_SG_IO;
+
+    char sg_path[64];
+    if (!find_sg_node(config->device_path, sg_path, sizeof(sg_path))) {
+        return false;
+    }
+
+    // write() queues a command on sg, so even reads need the node writable
+    sg_engine_t sg;
+    sg.fd = open(sg_path, O_RDWR | O_CLOEXEC);
+    if (sg.fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", sg_path, strerror(errno));
+        return false;
+    }
+
+    uint64_t blocks;
+    uint32_t logical_block_size;
+    storage_run_t run;
+    memset(&run, 0, sizeof(run));
+    bool result = read_capacity(sg.fd, &blocks, &logical_block_size) &&
+                  init_run(&run, config, pattern, SG_MAX_QUEUE, blocks * logical_block_size,
+                           logical_block_size, stats) &&
+                  run_queue(&run, &sg_ops, &sg, config->duration);
+
+    free_slots(&run);
+    close(sg.fd);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// O_DIRECT block reads
+
+typedef struct {
+    int fd;                                   // Target block device
+    struct iovec iov[USB_STORAGE_MAX_QUEUE_DEPTH];
+} block_target_t;
+
+#ifdef HAVE_IO_URING
+typedef struct {
+    block_target_t *target;
+    int ring_fd;
+    unsigned pending;                         // Queued SQEs not yet entered
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+} uring_engine_t;
+
+static void uring_destroy(uring_engine_t *ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->ring_fd >= 0) {
+        close(ring->ring_fd);
+    }
+}
+
+// Raw syscalls, so the suite does not need liburing on the target
+static bool uring_create(uring_engine_t *ring, block_target_t *target, uint32_t entries) {
+    memset(ring, 0, sizeof(uring_engine_t));
+    ring->target = target;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->ring_fd < 0) {
+        fprintf(stderr, "io_uring unavailable (%s), using AIO\n", strerror(errno));
+        return false;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        fprintf(stderr, "Cannot map io_uring SQ ring: %s\n", strerror(errno));
+        uring_destroy(ring);
+        return false;
+    }
+    ring->cq_ring = single_mmap ? ring->sq_ring :
+                    mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->ring_fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED) {
+        ring->cq_ring = NULL;
+        fprintf(stderr, "Cannot map io_uring CQ ring: %s\n", strerror(errno));
+        uring_destroy(ring);
+        return false;
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        fprintf(stderr, "Cannot map io_uring SQEs: %s\n", strerror(errno));
+        uring_destroy(ring);
+        return false;
+    }
+
+    uint8_t *sq = ring->sq_ring;
+    uint8_t *cq = ring->cq_ring;
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return true;
+}
+
+static bool uring_submit(void *engine, storage_run_t *run, uint32_t slot) {
+    uring_engine_t *ring = engine;
+    block_target_t *target = ring->target;
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    target->iov[slot].iov_base = run->slots[slot].buffer;
+    target->iov[slot].iov_len = run->block_size;
+
+    // READV rather than READ keeps this working back to 5.1
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = target->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&target->iov[slot];
+    sqe->len = 1;
+    sqe->off = run->slots[slot].offset;
+    sqe->user_data = slot;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+    return true;
+}
+
+static bool uring_reap(void *engine, storage_run_t *run, uint32_t *slot, int64_t *result) {
+    uring_engine_t *ring = engine;
+    for (;;) {
+        unsigned head = *ring->cq_head;
+        if (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            *slot = (uint32_t)cqe->user_data;
+            *result = cqe->res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+            return *slot < run->depth;
+        }
+
+        int ret = (int)syscall(__NR_io_uring_enter, ring->ring_fd, ring->pending, 1,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "io_uring_enter failed: %s\n", strerror(errno));
+            return false;
+        }
+        ring->pending -= (unsigned)ret;
+    }
+}
+
+static const storage_ops_t uring_ops = { uring_submit, uring_reap };
+#endif
+
+typedef struct {
+    block_target_t *target;
+    aio_context_t context;
+    struct iocb iocbs[USB_STORAGE_MAX_QUEUE_DEPTH];
+    struct iocb *pending[USB_STORAGE_MAX_QUEUE_DEPTH];
+    uint32_t pending_count;       // Queued, not yet io_submit()ed
+    uint32_t submitted;           // In the kernel, not yet reaped
+} aio_engine_t;
+
+static bool aio_submit(void *engine, storage_run_t *run, uint32_t slot) {
+    aio_engine_t *aio = engine;
+    struct iocb *iocb = &aio->iocbs[slot];
+    memset(iocb, 0, sizeof(struct iocb));
+    iocb->aio_fildes = (uint32_t)aio->target->fd;
+    iocb->aio_lio_opcode = IOCB_CMD_PREAD;
+    iocb->aio_buf = (uint64_t)(uintptr_t)run->slots[slot].buffer;
+    iocb->aio_nbytes = run->block_size;
+    iocb->aio_offset = (int64_t)run->slots[slot].offset;
+    iocb->aio_data = slot;
+    aio->pending[aio->pending_count++] = iocb;
+    return true;
+}
+
+static bool aio_reap(void *engine, storage_run_t *run, uint32_t *slot, int64_t *result) {
+    aio_engine_t *aio = engine;
+    while (aio->pending_count > 0) {
+        long ret = syscall(__NR_io_submit, aio->context, (long)aio->pending_count, aio->pending);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0 && errno == EAGAIN && aio->submitted > 0) {
+            break;                        // Reap something first, then retry
+        }
+        if (ret < 0) {
+            fprintf(stderr, "io_submit failed: %s\n", strerror(errno));
+            return false;
+        }
+        aio->submitted += (uint32_t)ret;
+        aio->pending_count -= (uint32_t)ret;
+        memmove(aio->pending, aio->pending + ret, aio->pending_count * sizeof(struct iocb *));
+    }
+
+    struct io_event event;
+    for (;;) {
+        long ret = syscall(__NR_io_getevents, aio->context, 1L, 1L, &event, NULL);
+        if (ret == 1) {
+            aio->submitted--;
+            break;
+        }
+        if (ret < 0 && errno != EINTR) {
+            fprintf(stderr, "io_getevents failed: %s\n", strerror(errno));
+            return false;
+        }
+    }
+    *slot = (uint32_t)event.data;
+    *result = event.res;
+    return *slot < run->depth;
+}
+
+static const storage_ops_t aio_ops = { aio_submit, aio_reap };
+
+bool usb_storage_bench_block(const usb_storage_config_t *config, usb_storage_pattern_t pattern,
+                             usb_storage_stats_t *stats) {
+    if (!config || !config->device_path || !stats) {
+        return false;
+    }
+    memset(stats, 0, sizeof(usb_storage_stats_t));
+
+    block_target_t target;
+    target.fd = open(config->device_path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (target.fd < 0) {
+        fprintf(stderr, "Cannot open %s for O_DIRECT: %s\n", config->device_path, strerror(errno));
+        return false;
+    }
+
+    uint64_t device_bytes = 0;
+    int logical_block_size = 0;
+    if (ioctl(target.fd, BLKGETSIZE64, &device_bytes) < 0 || ioctl(target.fd, BLKSSZGET, &logical_block_size) < 0) {
+        fprintf(stderr, "%s is not a block device: %s\n", config->device_path, strerror(errno));
+        close(target.fd);
+        return false;
+    }
+
+    storage_run_t run;
+    if (!init_run(&run, config, pattern, USB_STORAGE_MAX_QUEUE_DEPTH, device_bytes,
+                  (uint32_t)logical_block_size, stats)) {
+        free_slots(&run);
+        close(target.fd);
+        return false;
+    }
+
+    bool result = false;
+    bool ran = false;
+#ifdef HAVE_IO_URING
+    uring_engine_t ring;
+    if (uring_create(&ring, &target, run.depth)) {
+        stats->engine = USB_STORAGE_IO_URING;
+        result = run_queue(&run, &uring_ops, &ring, config->duration);
+        uring_destroy(&ring);
+        ran = true;
+    }
+#endif
+    if (!ran) {
+        aio_engine_t aio;
+        memset(&aio, 0, sizeof(aio));
+        aio.target = &target;
+        if (syscall(__NR_io_setup, (long)run.depth, &aio.context) < 0) {
+            fprintf(stderr, "io_setup failed: %s\n", strerror(errno));
+        } else {
+            stats->engine = USB_STORAGE_AIO;
+            result = run_queue(&run, &aio_ops, &aio, config->duration);
+            syscall(__NR_io_destroy, aio.context);
+        }
+    }
+
+    free_slots(&run);
+    close(target.fd);
+    return result;
+}
+
+const char *usb_storage_engine_name(usb_storage_engine_t engine) {
+    switch (engine) {
+        case USB_STORAGE_SG_IO:
+            return "SG_IO";
+        case USB_STORAGE_IO_URING:
+            return "io_uring";
+        case USB_STORAGE_AIO:
+            return "AIO";
+        default:
+            return "Unknown";
+    }
+}
+
+const char *usb_storage_pattern_name(usb_storage_pattern_t pattern) {
+    return pattern == USB_STORAGE_RANDOM ? "Random" : "Sequential";
+}
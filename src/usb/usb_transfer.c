@@ -0,0 +1,497 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "usb/usb_transfer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <libusb-1.0/libusb.h>
+
+#define EVENT_TIMEOUT_US 100000
+#define DRAIN_TIMEOUT_MS 2000     // For cancelled transfers to come back
+#define MAX_ERRORS 16             // Then the stream stops resubmitting
+#define HALT_POLL_NS 10000000ULL  // How often the run loop looks for stalled endpoints
+
+typedef struct {
+    int stopping;                 // Callbacks stop resubmitting
+    int done;                     // libusb's completed flag for the event loop
+} transfer_run_t;
+
+typedef struct transfer_stream {
+    transfer_run_t *run;          // Every stream of one usb_transfer_run() call
+    const usb_transfer_target_t *target;
+    usb_transfer_stats_t *stats;
+    libusb_device_handle *handle;
+    struct libusb_transfer **transfers;
+    uint32_t transfer_count;
+    int inflight;                 // Touched by the event thread and the stopper
+    pthread_mutex_t lock;         // Guards the parked transfers
+    struct libusb_transfer **parked;    // Stalled, waiting for the halt to be cleared
+    struct libusb_transfer **clearing;  // Swapped with parked by the run loop
+    uint32_t parked_count;
+    bool claimed;
+    uint64_t last_data_ns;
+    double interval_sum;          // us, for the jitter
+    double interval_sum_sq;
+    uint64_t interval_count;
+} transfer_stream_t;
+
+static void *event_thread_main(void *arg) {
+    transfer_run_t *run = arg;
+    struct timeval tv = { 0, EVENT_TIMEOUT_US };
+    while (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE)) {
+        libusb_handle_events_timeout_completed(NULL, &tv, &run->done);
+    }
+    return NULL;
+}
+
+static void record_data(transfer_stream_t *stream, uint64_t now_ns, uint32_t bytes) {
+    usb_transfer_stats_t *stats = stream->stats;
+    stats->bytes += bytes;
+    if (bytes == 0) {
+        return;
+    }
+    if (stream->last_data_ns) {
+        uint64_t interval_ns = now_ns - stream->last_data_ns;
+        double interval_us = (double)interval_ns / 1000.0;
+        report_histogram_record(&stats->interval, interval_ns);
+        stream->interval_sum += interval_us;
+        stream->interval_sum_sq += interval_us * interval_us;
+        stream->interval_count++;
+    }
+    stream->last_data_ns = now_ns;
+}
+
+static void LIBUSB_CALL transfer_done(struct libusb_transfer *transfer) {
+    transfer_stream_t *stream = transfer->user_data;
+    usb_transfer_stats_t *stats = stream->stats;
+    uint64_t now_ns = report_time_now_ns();
+
+    switch (transfer->status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            stats->transfers++;
+            if (transfer->type == LIBUSB_TRANSFER_TYPE_ISOCHRONOUS) {
+                uint32_t bytes = 0;
+                for (int i = 0; i < transfer->num_iso_packets; i++) {
+                    const struct libusb_iso_packet_descriptor *packet = &transfer->iso_packet_desc[i];
+                    stats->packets++;
+                    if (packet->status != LIBUSB_TRANSFER_COMPLETED) {
+                        stats->missed_packets++;
+                    }
+                    bytes += packet->actual_length;
+                }
+                record_data(stream, now_ns, bytes);
+            } else {
+                record_data(stream, now_ns, (uint32_t)transfer->actual_length);
+            }
+            break;
+        case LIBUSB_TRANSFER_CANCELLED:
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            stats->disconnected = true;
+            break;
+        default:
+            if (stats->errors++ == 0) {
+                fprintf(stderr, "USB %03u:%03u endpoint 0x%02x: %s\n", stream->target->bus,
+                        stream->target->address, stream->target->endpoint,
+                        libusb_error_name(transfer->status == LIBUSB_TRANSFER_STALL ? LIBUSB_ERROR_PIPE :
+                                          transfer->status == LIBUSB_TRANSFER_OVERFLOW ? LIBUSB_ERROR_OVERFLOW :
+                                          LIBUSB_ERROR_IO));
+            }
+            break;
+    }
+
+    bool resubmit = !__atomic_load_n(&stream->run->stopping, __ATOMIC_ACQUIRE) && !stats->disconnected &&
+                    stats->errors < MAX_ERRORS && transfer->status != LIBUSB_TRANSFER_CANCELLED;
+    if (resubmit && transfer->status == LIBUSB_TRANSFER_STALL) {
+        // CLEAR_FEATURE is synchronous and would wait on the very event
+        // handling this callback runs in; the run loop clears the halt and
+        // resubmits
+        pthread_mutex_lock(&stream->lock);
+        stream->parked[stream->parked_count++] = transfer;
+        pthread_mutex_unlock(&stream->lock);
+        __atomic_sub_fetch(&stream->inflight, 1, __ATOMIC_RELEASE);
+        return;
+    }
+    if (resubmit && libusb_submit_transfer(transfer) == 0) {
+        return;
+    }
+    if (resubmit) {
+        stats->errors++;
+    }
+    __atomic_sub_fetch(&stream->inflight, 1, __ATOMIC_RELEASE);
+}
+
+static bool open_stream(transfer_stream_t *stream, const usb_transfer_config_t *config) {
+    const usb_transfer_target_t *target = stream->target;
+    int rc = libusb_open(target->device, &stream->handle);
+    if (rc < 0) {
+        fprintf(stderr, "Cannot open USB %03u:%03u: %s\n", target->bus, target->address, libusb_error_name(rc));
+        return false;
+    }
+
+    // The kernel driver comes back when the interface is released
+    libusb_set_auto_detach_kernel_driver(stream->handle, 1);
+    rc = libusb_claim_interface(stream->handle, target->interface);
+    if (rc < 0) {
+        fprintf(stderr, "Cannot claim interface %u of USB %03u:%03u: %s\n", target->interface,
+                target->bus, target->address, libusb_error_name(rc));
+        return false;
+    }
+    stream->claimed = true;
+    if (target->alt_setting) {
+        rc = libusb_set_interface_alt_setting(stream->handle, target->interface, target->alt_setting);
+        if (rc < 0) {
+            fprintf(stderr, "Cannot select alt setting %u: %s\n", target->alt_setting, libusb_error_name(rc));
+            return false;
+        }
+    }
+
+    stream->transfer_count = config->depth ? config->depth : USB_TRANSFER_DEFAULT_DEPTH;
+    stream->transfers = calloc(stream->transfer_count, sizeof(struct libusb_transfer *));
+    stream->parked = calloc(stream->transfer_count, sizeof(struct libusb_transfer *));
+    stream->clearing = calloc(stream->transfer_count, sizeof(struct libusb_transfer *));
+    if (!stream->transfers || !stream->parked || !stream->clearing) {
+        return false;
+    }
+
+    int packets = target->type == USB_ENDPOINT_ISOCHRONOUS ?
+                  (int)(config->iso_packets ? config->iso_packets : USB_TRANSFER_ISO_PACKETS) : 0;
+    int length = target->type == USB_ENDPOINT_ISOCHRONOUS ? (int)target->max_packet * packets :
+                 target->type == USB_ENDPOINT_BULK ? (int)(config->bulk_size ? config->bulk_size : USB_TRANSFER_BULK_SIZE) :
+                 (int)target->max_packet;
+
+    for (uint32_t i = 0; i < stream->transfer_count; i++) {
+        struct libusb_transfer *transfer = libusb_alloc_transfer(packets);
+        uint8_t *buffer = calloc(1, (size_t)length);
+        if (!transfer || !buffer) {
+            libusb_free_transfer(transfer);
+            free(buffer);
+            return false;
+        }
+        // Timeouts of 0: interrupt endpoints may stay quiet, cancelled at the end
+        if (target->type == USB_ENDPOINT_ISOCHRONOUS) {
+            // OUT buffers stay zeroed, i.e. silence
+            libusb_fill_iso_transfer(transfer, stream->handle, target->endpoint, buffer, length, packets,
+                                     transfer_done, stream, 0);
+            libusb_set_iso_packet_lengths(transfer, target->max_packet);
+        } else if (target->type == USB_ENDPOINT_BULK) {
+            libusb_fill_bulk_transfer(transfer, stream->handle, target->endpoint, buffer, length,
+                                      transfer_done, stream, 0);
+        } else {
+            libusb_fill_interrupt_transfer(transfer, stream->handle, target->endpoint, buffer, length,
+                                           transfer_done, stream, 0);
+        }
+        transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+        stream->transfers[i] = transfer;
+    }
+    return true;
+}
+
+static void close_stream(transfer_stream_t *stream) {
+    for (uint32_t i = 0; stream->transfers && i < stream->transfer_count; i++) {
+        libusb_free_transfer(stream->transfers[i]);
+    }
+    free(stream->transfers);
+    stream->transfers = NULL;
+    free(stream->parked);
+    free(stream->clearing);
+    stream->parked = NULL;
+    stream->clearing = NULL;
+    if (stream->claimed) {
+        libusb_release_interface(stream->handle, stream->target->interface);
+    }
+    if (stream->handle) {
+        libusb_close(stream->handle);
+    }
+}
+
+static void finish_stats(transfer_stream_t *stream, uint64_t elapsed_ns) {
+    usb_transfer_stats_t *stats = stream->stats;
+    const usb_transfer_target_t *target = stream->target;
+    if (elapsed_ns > 0) {
+        stats->bytes_per_sec = (double)stats->bytes * 1e9 / (double)elapsed_ns;
+    }
+    if (target->type == USB_ENDPOINT_ISOCHRONOUS && target->interval_us) {
+        stats->expected_bytes_per_sec = (double)target->max_packet * 1e6 / target->interval_us;
+    }
+    if (stream->interval_count > 1) {
+        double n = (double)stream->interval_count;
+        double mean = stream->interval_sum / n;
+        double variance = stream->interval_sum_sq / n - mean * mean;
+        stats->jitter_us = variance > 0.0 ? sqrt(variance) : 0.0;
+    }
+}
+
+// Clears a stalled endpoint outside event handling and puts its parked
+// transfers back in flight
+static void clear_stalled(transfer_stream_t *stream) {
+    pthread_mutex_lock(&stream->lock);
+    struct libusb_transfer **parked = stream->parked;
+    uint32_t count = stream->parked_count;
+    stream->parked = stream->clearing;
+    stream->clearing = parked;
+    stream->parked_count = 0;
+    pthread_mutex_unlock(&stream->lock);
+    if (count == 0) {
+        return;
+    }
+
+    int rc = libusb_clear_halt(stream->handle, stream->target->endpoint);
+    for (uint32_t i = 0; i < count; i++) {
+        if (rc == 0 && !__atomic_load_n(&stream->run->stopping, __ATOMIC_ACQUIRE)) {
+            __atomic_add_fetch(&stream->inflight, 1, __ATOMIC_RELEASE);
+            if (libusb_submit_transfer(parked[i]) == 0) {
+                continue;
+            }
+            __atomic_sub_fetch(&stream->inflight, 1, __ATOMIC_RELEASE);
+        }
+        // Stays with the stream until close_stream() frees it
+        stream->stats->errors++;
+    }
+}
+
+bool usb_transfer_run(const usb_transfer_target_t *targets, uint32_t count,
+                      const usb_transfer_config_t *config, usb_transfer_stats_t *stats) {
+    if (!targets || !config || !stats || count == 0 || count > USB_TRANSFER_MAX_TARGETS) {
+        return false;
+    }
+
+    // Everything a callback touches hangs off its stream, so runs on
+    // different devices can go on concurrently
+    transfer_run_t run = { 0, 0 };
+    transfer_stream_t streams[USB_TRANSFER_MAX_TARGETS];
+    memset(streams, 0, sizeof(streams));
+
+    uint32_t started = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        transfer_stream_t *stream = &streams[i];
+        stream->run = &run;
+        pthread_mutex_init(&stream->lock, NULL);
+        stream->target = &targets[i];
+        stream->stats = &stats[i];
+        memset(&stats[i], 0, sizeof(usb_transfer_stats_t));
+        report_histogram_init(&stats[i].interval);
+        if (!open_stream(stream, config)) {
+            stats[i].errors++;
+            continue;
+        }
+        for (uint32_t t = 0; t < stream->transfer_count; t++) {
+            int rc = libusb_submit_transfer(stream->transfers[t]);
+            if (rc < 0) {
+                fprintf(stderr, "Cannot submit to endpoint 0x%02x: %s\n", targets[i].endpoint,
+                        libusb_error_name(rc));
+                stats[i].errors++;
+                break;
+            }
+            __atomic_add_fetch(&stream->inflight, 1, __ATOMIC_RELEASE);
+        }
+        if (stream->inflight > 0) {
+            started++;
+        }
+    }
+
+    pthread_t thread;
+    bool have_thread = started > 0 && pthread_create(&thread, NULL, event_thread_main, &run) == 0;
+    uint64_t start_ns = report_time_now_ns();
+
+    if (have_thread) {
+        uint32_t duration = config->duration ? config->duration : USB_TRANSFER_DEFAULT_DURATION;
+        uint64_t end_ns = start_ns + (uint64_t)duration * 1000000000ULL;
+        for (uint64_t now_ns = start_ns; now_ns < end_ns; now_ns = report_time_now_ns()) {
+            uint64_t wait_ns = end_ns - now_ns < HALT_POLL_NS ? end_ns - now_ns : HALT_POLL_NS;
+            struct timespec pause = { 0, (long)wait_ns };
+            nanosleep(&pause, NULL);
+            for (uint32_t i = 0; i < count; i++) {
+                clear_stalled(&streams[i]);
+            }
+        }
+    }
+    uint64_t elapsed_ns = report_time_now_ns() - start_ns;
+
+    // Stop resubmitting, cancel what is still queued and wait for every
+    // callback before freeing anything it touches. A callback that read
+    // stopping just before it was set resubmits after the first cancel, so
+    // cancel again until everything is back.
+    __atomic_store_n(&run.stopping, 1, __ATOMIC_RELEASE);
+    uint64_t drain_end_ns = report_time_now_ns() + (uint64_t)DRAIN_TIMEOUT_MS * 1000000ULL;
+    bool drained = false;
+    while (have_thread && !drained && report_time_now_ns() < drain_end_ns) {
+        drained = true;
+        for (uint32_t i = 0; i < count; i++) {
+            if (__atomic_load_n(&streams[i].inflight, __ATOMIC_ACQUIRE) == 0) {
+                continue;
+            }
+            drained = false;
+            for (uint32_t t = 0; t < streams[i].transfer_count; t++) {
+                libusb_cancel_transfer(streams[i].transfers[t]);
+            }
+        }
+        if (!drained) {
+            struct timespec pause = { 0, 10000000 };
+            nanosleep(&pause, NULL);
+        }
+    }
+    if (have_thread) {
+        // The event loop sees done within EVENT_TIMEOUT_US
+        __atomic_store_n(&run.done, 1, __ATOMIC_RELEASE);
+        pthread_join(thread, NULL);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        finish_stats(&streams[i], elapsed_ns);
+        if (streams[i].inflight > 0) {
+            // libusb still owns these; leaking beats a use-after-free
+            fprintf(stderr, "Endpoint 0x%02x did not return %d transfers\n", targets[i].endpoint,
+                    streams[i].inflight);
+            free(streams[i].transfers);
+            streams[i].transfers = NULL;
+        }
+        close_stream(&streams[i]);
+        pthread_mutex_destroy(&streams[i].lock);
+    }
+
+    return started > 0;
+}
+
+// bInterval is frames at low/full speed interrupt, 2^(n-1) frames for full
+// speed isochronous and 2^(n-1) microframes at high speed and up
+static uint32_t service_interval_us(libusb_device *device, usb_endpoint_type_t type, uint8_t interval) {
+    int speed = libusb_get_device_speed(device);
+    if (interval == 0) {
+        interval = 1;
+    }
+    if (speed >= LIBUSB_SPEED_HIGH) {
+        return 125u << (interval > 16 ? 15 : interval - 1);
+    }
+    if (type == USB_ENDPOINT_INTERRUPT) {
+        return 1000u * interval;
+    }
+    return 1000u << (interval > 16 ? 15 : interval - 1);
+}
+
+static bool find_endpoint(libusb_device *device, const struct libusb_config_descriptor *config,
+                          uint8_t interface_class, uint8_t interface_subclass, usb_endpoint_type_t type,
+                          usb_transfer_target_t *target) {
+    bool found = false;
+    for (uint8_t i = 0; i < config->bNumInterfaces; i++) {
+        const struct libusb_interface *interface = &config->interface[i];
+        for (int a = 0; a < interface->num_altsetting; a++) {
+            const struct libusb_interface_descriptor *alt = &interface->altsetting[a];
+            if (alt->bInterfaceClass != interface_class ||
+                (interface_subclass != 0xFF && alt->bInterfaceSubClass != interface_subclass)) {
+                continue;
+            }
+            for (uint8_t e = 0; e < alt->bNumEndpoints; e++) {
+                const struct libusb_endpoint_descriptor *ep = &alt->endpoint[e];
+                bool in = ep->bEndpointAddress & LIBUSB_ENDPOINT_IN;
+                if ((ep->bmAttributes & 0x03) != type || (!in && type != USB_ENDPOINT_ISOCHRONOUS)) {
+                    continue;
+                }
+                // Isochronous: the widest alt setting, IN before OUT
+                uint32_t max_packet = (uint32_t)(ep->wMaxPacketSize & 0x7FF) * (1 + ((ep->wMaxPacketSize >> 11) & 3));
+                bool better = !found || (type == USB_ENDPOINT_ISOCHRONOUS &&
+                              ((in && !(target->endpoint & LIBUSB_ENDPOINT_IN)) ||
+                               (in == !!(target->endpoint & LIBUSB_ENDPOINT_IN) && max_packet > target->max_packet)));
+                if (!better) {
+                    continue;
+                }
+                target->interface = alt->bInterfaceNumber;
+                target->alt_setting = alt->bAlternateSetting;
+                target->endpoint = ep->bEndpointAddress;
+                target->max_packet = max_packet;
+                target->interval_us = service_interval_us(device, type, ep->bInterval);
+                found = true;
+            }
+            if (found && type != USB_ENDPOINT_ISOCHRONOUS) {
+                return true;
+            }
+        }
+    }
+    return found;
+}
+
+uint32_t usb_transfer_find(uint8_t interface_class, uint8_t interface_subclass, usb_endpoint_type_t type,
+                           uint16_t vendor_id, uint16_t product_id, uint8_t bus, uint8_t address,
+                           usb_transfer_target_t *targets, uint32_t max) {
+    libusb_device **devices = NULL;
+    ssize_t device_count = libusb_get_device_list(NULL, &devices);
+    if (device_count < 0) {
+        fprintf(stderr, "Failed to get USB device list: %s\n", libusb_error_name((int)device_count));
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (ssize_t i = 0; i < device_count && count < max; i++) {
+        libusb_device *device = devices[i];
+        if ((bus && libusb_get_bus_number(device) != bus) ||
+            (address && libusb_get_device_address(device) != address)) {
+            continue;
+        }
+        struct libusb_device_descriptor desc;
+        struct libusb_config_descriptor *config;
+        if (libusb_get_device_descriptor(device, &desc) < 0 ||
+            (vendor_id && desc.idVendor != vendor_id) || (product_id && desc.idProduct != product_id) ||
+            libusb_get_active_config_descriptor(device, &config) < 0) {
+            continue;
+        }
+
+        usb_transfer_target_t *target = &targets[count];
+        memset(target, 0, sizeof(usb_transfer_target_t));
+        if (find_endpoint(device, config, interface_class, interface_subclass, type, target)) {
+            target->device = libusb_ref_device(device);
+            target->vendor_id = desc.idVendor;
+            target->product_id = desc.idProduct;
+            target->bus = libusb_get_bus_number(device);
+            target->address = libusb_get_device_address(device);
+            target->type = type;
+            count++;
+        }
+        libusb_free_config_descriptor(config);
+    }
+
+    libusb_free_device_list(devices, 1);
+    return count;
+}
+
+void usb_transfer_release(usb_transfer_target_t *targets, uint32_t count) {
+    for (uint32_t i = 0; targets && i < count; i++) {
+        if (targets[i].device) {
+            libusb_unref_device(targets[i].device);
+            targets[i].device = NULL;
+        }
+    }
+}
+
+const char *usb_endpoint_type_name(usb_endpoint_type_t type) {
+    switch (type) {
+        case USB_ENDPOINT_ISOCHRONOUS:
+            return "isochronous";
+        case USB_ENDPOINT_BULK:
+            return "bulk";
+        case USB_ENDPOINT_INTERRUPT:
+            return "interrupt";
+        default:
+            return "unknown";
+    }
+}
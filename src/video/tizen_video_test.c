@@ -17,40 +17,60 @@
  */
 
 #include "video/tizen_video_test.h"
+#include "video/video_convert.h"
+#include "common/test_pattern.h"
+#include "common/cap_cache.h"
+#include "common/worker_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <linux/videodev2.h>
 
 #define TEST_TIMEOUT 5000 // 5 seconds
 #define MAX_DEVICES 16
 
-static int video_fd = -1;
-static video_device_info_t *devices = NULL;
+// A /dev/videoN node found at init. Its capabilities are only queried the
+// first time something asks for them, since opening a node can power up a
+// sensor or load firmware.
+typedef struct {
+    uint32_t node;                 // N of /dev/videoN
+    pthread_mutex_t lock;          // Held while probing
+    bool probed;
+    bool valid;                    // Probe succeeded
+    video_device_info_t info;
+} video_device_slot_t;
+
+// Shared by every job testing a video device; the list lives as long as
+// any of them holds the framework
+static pthread_mutex_t framework_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t framework_users = 0;
+static video_device_slot_t *devices = NULL;
 static uint32_t device_count = 0;
 
 // Static helper functions
-static bool open_video_device(uint32_t device_index) {
+static int open_video_device(uint32_t device_index) {
     char device_name[32];
     snprintf(device_name, sizeof(device_name), "/dev/video%d", device_index);
     
-    video_fd = open(device_name, O_RDWR);
-    if (video_fd < 0) {
+    int fd = open(device_name, O_RDWR);
+    if (fd < 0) {
         fprintf(stderr, "Cannot open video device %s: %s\n", device_name, strerror(errno));
-        return false;
     }
     
-    return true;
+    return fd;
 }
 
 static bool get_device_capabilities(uint32_t device_index, video_device_info_t *info) {
-    if (!open_video_device(device_index)) {
+    int video_fd = open_video_device(device_index);
+    if (video_fd < 0) {
         return false;
     }
     
@@ -58,7 +78,6 @@ static bool get_device_capabilities(uint32_t device_index, video_device_info_t *
     if (ioctl(video_fd, VIDIOC_QUERYCAP, &cap) < 0) {
         fprintf(stderr, "VIDIOC_QUERYCAP failed: %s\n", strerror(errno));
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -113,6 +132,15 @@ static bool get_device_capabilities(uint32_t device_index, video_device_info_t *
             case V4L2_PIX_FMT_H264:
                 info->formats[format_index] = VIDEO_FORMAT_H264;
                 break;
+            case V4L2_PIX_FMT_HEVC:
+                info->formats[format_index] = VIDEO_FORMAT_H265;
+                break;
+            case V4L2_PIX_FMT_VP8:
+                info->formats[format_index] = VIDEO_FORMAT_VP8;
+                break;
+            case V4L2_PIX_FMT_VP9:
+                info->formats[format_index] = VIDEO_FORMAT_VP9;
+                break;
             default:
                 // Unsupported format, skip
                 fmt.index++;
@@ -141,25 +169,22 @@ static bool get_device_capabilities(uint32_t device_index, video_device_info_t *
     info->max_bitrate = 10000000;  // 10 Mbps
     
     close(video_fd);
-    video_fd = -1;
     
     return true;
 }
 
-// Framework initialization/cleanup
-bool init_video_test_framework(void) {
-    // Discover available devices
+// Lists the nodes without opening them; probe_device() does the rest
+static bool discover_video_devices(void) {
+    uint32_t nodes[MAX_DEVICES];
     device_count = 0;
     
-    // Count devices first
-    for (int i = 0; i < MAX_DEVICES; i++) {
+    for (uint32_t i = 0; i < MAX_DEVICES; i++) {
         char device_name[32];
-        snprintf(device_name, sizeof(device_name), "/dev/video%d", i);
+        snprintf(device_name, sizeof(device_name), "/dev/video%u", i);
         
-        int fd = open(device_name, O_RDWR);
-        if (fd >= 0) {
-            close(fd);
-            device_count++;
+        struct stat st;
+        if (stat(device_name, &st) == 0 && S_ISCHR(st.st_mode)) {
+            nodes[device_count++] = i;
         }
     }
     
@@ -168,54 +193,109 @@ bool init_video_test_framework(void) {
         return false;
     }
     
-    // Allocate device info array
-    devices = malloc(device_count * sizeof(video_device_info_t));
+    devices = calloc(device_count, sizeof(video_device_slot_t));
     if (!devices) {
         fprintf(stderr, "Memory allocation failed\n");
+        device_count = 0;
         return false;
     }
     
-    // Fill device info
-    uint32_t device_index = 0;
-    for (int i = 0; i < MAX_DEVICES && device_index < device_count; i++) {
-        char device_name[32];
-        snprintf(device_name, sizeof(device_name), "/dev/video%d", i);
+    for (uint32_t i = 0; i < device_count; i++) {
+        devices[i].node = nodes[i];
+        pthread_mutex_init(&devices[i].lock, NULL);
+    }
+    
+    return true;
+}
+
+// Queries a node once, from the capability cache when its driver has not
+// changed since it was last probed
+static bool probe_device(video_device_slot_t *slot) {
+    pthread_mutex_lock(&slot->lock);
+    if (!slot->probed) {
+        char sysfs_node[64];
+        char key[CAP_CACHE_KEY_SIZE];
+        snprintf(sysfs_node, sizeof(sysfs_node), "/sys/class/video4linux/video%u", slot->node);
+        bool keyed = cap_cache_device_key(sysfs_node, key, sizeof(key));
         
-        int fd = open(device_name, O_RDWR);
-        if (fd >= 0) {
-            close(fd);
-            // Get device capabilities
-            if (!get_device_capabilities(i, &devices[device_index])) {
-                fprintf(stderr, "Failed to get capabilities for %s\n", device_name);
-                continue;
+        if (keyed && cap_cache_lookup(key, &slot->info, sizeof(slot->info))) {
+            slot->valid = true;
+        } else {
+            slot->valid = get_device_capabilities(slot->node, &slot->info);
+            if (!slot->valid) {
+                fprintf(stderr, "Failed to get capabilities for /dev/video%u\n", slot->node);
+            } else if (keyed) {
+                cap_cache_store(key, &slot->info, sizeof(slot->info));
             }
-            device_index++;
         }
+        slot->probed = true;
     }
+    bool valid = slot->valid;
+    pthread_mutex_unlock(&slot->lock);
     
-    return true;
+    return valid;
 }
 
-void cleanup_video_test_framework(void) {
-    if (video_fd >= 0) {
-        close(video_fd);
-        video_fd = -1;
+static bool probe_device_job(void *arg) {
+    return probe_device(arg);
+}
+
+// Probes every node still unknown at once, each on its own worker
+static void probe_all_devices(void) {
+    worker_job_t jobs[MAX_DEVICES];
+    uint32_t count = 0;
+    
+    for (uint32_t i = 0; i < device_count; i++) {
+        if (!devices[i].probed) {
+            char name[32];
+            snprintf(name, sizeof(name), "probe video%u", devices[i].node);
+            worker_job_init(&jobs[count++], name, probe_device_job, &devices[i]);
+        }
+    }
+    
+    if (count > 0) {
+        worker_pool_run(jobs, count, count);
+    }
+}
+
+// Framework initialization/cleanup
+bool init_video_test_framework(void) {
+    pthread_mutex_lock(&framework_lock);
+    bool result = framework_users > 0 || discover_video_devices();
+    if (result) {
+        framework_users++;
     }
+    pthread_mutex_unlock(&framework_lock);
     
-    if (devices) {
+    return result;
+}
+
+void cleanup_video_test_framework(void) {
+    pthread_mutex_lock(&framework_lock);
+    if (framework_users > 0 && --framework_users == 0) {
+        for (uint32_t i = 0; i < device_count; i++) {
+            pthread_mutex_destroy(&devices[i].lock);
+        }
         free(devices);
         devices = NULL;
+        device_count = 0;
     }
-    
-    device_count = 0;
+    pthread_mutex_unlock(&framework_lock);
 }
 
 // Device enumeration and information
 uint32_t get_video_device_count(video_device_type_t type) {
-    uint32_t count = 0;
+    // Every node counts without being opened; only a type filter has to
+    // look inside them
+    if (type == VIDEO_DEVICE_MAX) {
+        return device_count;
+    }
     
+    probe_all_devices();
+    
+    uint32_t count = 0;
     for (uint32_t i = 0; i < device_count; i++) {
-        if (devices[i].type == type || type == VIDEO_DEVICE_MAX) {
+        if (probe_device(&devices[i]) && devices[i].info.type == type) {
             count++;
         }
     }
@@ -224,11 +304,11 @@ uint32_t get_video_device_count(video_device_type_t type) {
 }
 
 bool get_video_device_info(uint32_t device_index, video_device_info_t *info) {
-    if (device_index >= device_count || !info) {
+    if (device_index >= device_count || !info || !probe_device(&devices[device_index])) {
         return false;
     }
     
-    memcpy(info, &devices[device_index], sizeof(video_device_info_t));
+    memcpy(info, &devices[device_index].info, sizeof(video_device_info_t));
     return true;
 }
 
@@ -243,43 +323,23 @@ video_buffer_t *create_video_buffer(const video_test_config_t *config) {
         return NULL;
     }
     
-    // Calculate buffer size based on format
-    uint32_t bytes_per_pixel;
-    switch (config->format) {
-        case VIDEO_FORMAT_RGB565:
-            bytes_per_pixel = 2;
-            break;
-        case VIDEO_FORMAT_RGB888:
-            bytes_per_pixel = 3;
-            break;
-        case VIDEO_FORMAT_RGBA8888:
-        case VIDEO_FORMAT_ARGB8888:
-            bytes_per_pixel = 4;
-            break;
-        case VIDEO_FORMAT_NV12:
-        case VIDEO_FORMAT_YUV420:
-            bytes_per_pixel = 3/2; // 12 bits per pixel
-            break;
-        case VIDEO_FORMAT_YUV422:
-        case VIDEO_FORMAT_YUYV:
-        case VIDEO_FORMAT_UYVY:
-            bytes_per_pixel = 2;
-            break;
-        default:
-            // Default to RGB888
-            bytes_per_pixel = 3;
-            break;
+    // Raw formats take the frame layout the converter uses, chroma planes
+    // included; compressed ones get room for an RGB888 frame
+    video_frame_t layout;
+    if (!video_frame_wrap(&layout, config->format, config->width, config->height, NULL, 0) &&
+        !video_frame_wrap(&layout, VIDEO_FORMAT_RGB888, config->width, config->height, NULL, 0)) {
+        free(buffer);
+        return NULL;
     }
     
     buffer->width = config->width;
     buffer->height = config->height;
     buffer->format = config->format;
-    buffer->stride = config->width * bytes_per_pixel;
+    buffer->stride = layout.strides[0];
     buffer->framerate = config->framerate;
     buffer->timestamp = 0;
     
-    // For planar formats, sizing is more complex, but simplified here
-    buffer->size = buffer->stride * buffer->height;
+    buffer->size = layout.size;
     buffer->data = malloc(buffer->size);
     
     if (!buffer->data) {
@@ -295,9 +355,9 @@ bool fill_video_buffer(video_buffer_t *buffer, uint32_t pattern) {
         return false;
     }
     
-    // Simple pattern fill
-    memset(buffer->data, pattern & 0xFF, buffer->size);
-    return true;
+    // Byte pattern replicated across the buffer
+    test_pattern_t fill = pattern_solid_byte(pattern & 0xFF);
+    return pattern_fill(buffer->data, buffer->size, &fill, 0, 0);
 }
 
 bool verify_video_buffer(video_buffer_t *buffer, uint32_t pattern) {
@@ -305,12 +365,11 @@ bool verify_video_buffer(video_buffer_t *buffer, uint32_t pattern) {
         return false;
     }
     
-    // Simple pattern verification
-    uint8_t *data = (uint8_t *)buffer->data;
-    for (uint32_t i = 0; i < buffer->size; i++) {
-        if (data[i] != (pattern & 0xFF)) {
-            return false;
-        }
+    test_pattern_t expected = pattern_solid_byte(pattern & 0xFF);
+    size_t offset = 0;
+    if (!pattern_verify(buffer->data, buffer->size, &expected, 0, 0, &offset)) {
+        fprintf(stderr, "Video buffer pattern mismatch at byte %zu\n", offset);
+        return false;
     }
     
     return true;
@@ -327,7 +386,8 @@ void destroy_video_buffer(video_buffer_t *buffer) {
 
 // Feature testing
 bool test_video_capture(uint32_t device_index, const video_test_config_t *config) {
-    if (!open_video_device(device_index)) {
+    int video_fd = open_video_device(device_index);
+    if (video_fd < 0) {
         return false;
     }
     
@@ -338,43 +398,13 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
     fmt.fmt.pix.width = config->width;
     fmt.fmt.pix.height = config->height;
     
-    // Map format to V4L2
-    switch (config->format) {
-        case VIDEO_FORMAT_RGB565:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB565;
-            break;
-        case VIDEO_FORMAT_RGB888:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
-            break;
-        case VIDEO_FORMAT_RGBA8888:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB32;
-            break;
-        case VIDEO_FORMAT_NV12:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV12;
-            break;
-        case VIDEO_FORMAT_YUV420:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
-            break;
-        case VIDEO_FORMAT_YUV422:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV422P;
-            break;
-        case VIDEO_FORMAT_YUYV:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
-            break;
-        case VIDEO_FORMAT_UYVY:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_UYVY;
-            break;
-        default:
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
-            break;
-    }
+    fmt.fmt.pix.pixelformat = video_format_to_v4l2(config->format);
     
     fmt.fmt.pix.field = V4L2_FIELD_NONE;
     
     if (ioctl(video_fd, VIDIOC_S_FMT, &fmt) < 0) {
         fprintf(stderr, "VIDIOC_S_FMT failed: %s\n", strerror(errno));
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -388,7 +418,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
     if (ioctl(video_fd, VIDIOC_S_PARM, &parm) < 0) {
         fprintf(stderr, "VIDIOC_S_PARM failed: %s\n", strerror(errno));
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -402,7 +431,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
     if (ioctl(video_fd, VIDIOC_REQBUFS, &req) < 0) {
         fprintf(stderr, "VIDIOC_REQBUFS failed: %s\n", strerror(errno));
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -418,7 +446,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
         if (ioctl(video_fd, VIDIOC_QUERYBUF, &buf) < 0) {
             fprintf(stderr, "VIDIOC_QUERYBUF failed: %s\n", strerror(errno));
             close(video_fd);
-            video_fd = -1;
             return false;
         }
         
@@ -426,7 +453,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
         if (buffers[i] == MAP_FAILED) {
             fprintf(stderr, "mmap failed: %s\n", strerror(errno));
             close(video_fd);
-            video_fd = -1;
             return false;
         }
     }
@@ -447,7 +473,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
             }
             
             close(video_fd);
-            video_fd = -1;
             return false;
         }
     }
@@ -463,7 +488,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
         }
         
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -484,7 +508,6 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
         }
         
         close(video_fd);
-        video_fd = -1;
         return false;
     }
     
@@ -508,11 +531,77 @@ bool test_video_capture(uint32_t device_index, const video_test_config_t *config
     
     // Cleanup
     close(video_fd);
-    video_fd = -1;
     
     return true;
 }
 
+// CPU bandwidth through a capture buffer exported with VIDIOC_EXPBUF and
+// mapped as a dma-buf, the way a consumer of the export would touch it
+bool test_video_buffer_bandwidth(uint32_t device_index, const video_test_config_t *config, map_bandwidth_t *result) {
+    if (!config || !result) {
+        return false;
+    }
+
+    int video_fd = open_video_device(device_index);
+    if (video_fd < 0) {
+        return false;
+    }
+
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = config->width;
+    fmt.fmt.pix.height = config->height;
+    fmt.fmt.pix.pixelformat = video_format_to_v4l2(config->format);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (ioctl(video_fd, VIDIOC_S_FMT, &fmt) < 0 || ioctl(video_fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 1) {
+        fprintf(stderr, "Cannot allocate a capture buffer: %s\n", strerror(errno));
+        close(video_fd);
+        return false;
+    }
+
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    struct v4l2_exportbuffer expbuf;
+    memset(&expbuf, 0, sizeof(expbuf));
+    expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    expbuf.flags = O_RDWR | O_CLOEXEC;
+    expbuf.fd = -1;
+
+    bool ok = ioctl(video_fd, VIDIOC_QUERYBUF, &buf) == 0 && ioctl(video_fd, VIDIOC_EXPBUF, &expbuf) == 0;
+    if (!ok) {
+        fprintf(stderr, "VIDIOC_EXPBUF failed: %s\n", strerror(errno));
+    }
+
+    void *map = ok ? mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, expbuf.fd, 0) : MAP_FAILED;
+    if (ok && map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map exported capture buffer: %s\n", strerror(errno));
+        ok = false;
+    }
+    if (ok) {
+        ok = map_bandwidth_measure(map, buf.length, expbuf.fd, MAP_BANDWIDTH_PASSES, result);
+        munmap(map, buf.length);
+    }
+
+    if (expbuf.fd >= 0) {
+        close(expbuf.fd);
+    }
+    req.count = 0;
+    ioctl(video_fd, VIDIOC_REQBUFS, &req);
+    close(video_fd);
+    return ok;
+}
+
 // Comprehensive testing
 bool test_all_video_features(uint32_t device_index, const video_test_config_t *config) {
     bool result = true;
@@ -525,6 +614,41 @@ bool test_all_video_features(uint32_t device_index, const video_test_config_t *c
 }
 
 // Utilities
+uint32_t video_format_to_v4l2(video_format_t format) {
+    switch (format) {
+        case VIDEO_FORMAT_RGB565:
+            return V4L2_PIX_FMT_RGB565;
+        case VIDEO_FORMAT_RGB888:
+            return V4L2_PIX_FMT_RGB24;
+        case VIDEO_FORMAT_RGBA8888:
+            return V4L2_PIX_FMT_RGBA32;
+        case VIDEO_FORMAT_ARGB8888:
+            return V4L2_PIX_FMT_ARGB32;
+        case VIDEO_FORMAT_NV12:
+            return V4L2_PIX_FMT_NV12;
+        case VIDEO_FORMAT_YUV420:
+            return V4L2_PIX_FMT_YUV420;
+        case VIDEO_FORMAT_YUV422:
+            return V4L2_PIX_FMT_YUV422P;
+        case VIDEO_FORMAT_YUYV:
+            return V4L2_PIX_FMT_YUYV;
+        case VIDEO_FORMAT_UYVY:
+            return V4L2_PIX_FMT_UYVY;
+        case VIDEO_FORMAT_MJPEG:
+            return V4L2_PIX_FMT_MJPEG;
+        case VIDEO_FORMAT_H264:
+            return V4L2_PIX_FMT_H264;
+        case VIDEO_FORMAT_H265:
+            return V4L2_PIX_FMT_HEVC;
+        case VIDEO_FORMAT_VP8:
+            return V4L2_PIX_FMT_VP8;
+        case VIDEO_FORMAT_VP9:
+            return V4L2_PIX_FMT_VP9;
+        default:
+            return V4L2_PIX_FMT_YUYV;
+    }
+}
+
 const char *video_format_to_string(video_format_t format) {
     switch (format) {
         case VIDEO_FORMAT_RGB565: return "RGB565";
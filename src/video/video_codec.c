@@ -0,0 +1,674 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "video/video_codec.h"
+#include "video/video_m2m.h"
+#include "video/video_convert.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/videodev2.h>
+
+#define IVF_HEADER_SIZE 32
+#define IVF_FRAME_HEADER_SIZE 12
+#define LATENCY_SLOTS 256              // Frames in flight tracked for latency
+#define MOTION_STEP 4                  // Pixels the encoder's test image moves per frame
+
+static inline uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Offset of the next 00 00 01 at or after pos, taking in the zero byte of
+// a four-byte start code above floor; size if there is none
+static size_t find_start_code(const uint8_t *data, size_t size, size_t pos, size_t floor) {
+    size_t i = pos + 2;
+    while (i < size) {
+        const uint8_t *one = memchr(data + i, 0x01, size - i);
+        if (!one) {
+            break;
+        }
+        i = (size_t)(one - data);
+        if (data[i - 1] == 0 && data[i - 2] == 0) {
+            size_t start = i - 2;
+            return start > floor && data[start - 1] == 0 ? start - 1 : start;
+        }
+        i++;
+    }
+    return size;
+}
+
+// Whether a NAL unit opens a new access unit once the current one holds a
+// picture; the first slice of a picture has first_mb_in_slice 0 (H.264) or
+// first_slice_segment_in_pic_flag set (H.265)
+static bool nal_starts_access_unit(video_format_t codec, const uint8_t *nal, size_t size, bool *vcl) {
+    if (codec == VIDEO_FORMAT_H265) {
+        if (size < 3) {
+            *vcl = false;
+            return false;
+        }
+        uint32_t type = (nal[0] >> 1) & 0x3F;
+        *vcl = type < 32;
+        return (*vcl && (nal[2] & 0x80)) || (type >= 32 && type <= 35) || type == 39 ||
+               (type >= 41 && type <= 44) || (type >= 48 && type <= 55);
+    }
+
+    if (size < 2) {
+        *vcl = false;
+        return false;
+    }
+    uint32_t type = nal[0] & 0x1F;
+    *vcl = type >= 1 && type <= 5;
+    return (*vcl && (nal[1] & 0x80)) || (type >= 6 && type <= 9) || (type >= 14 && type <= 18);
+}
+
+static bool next_access_unit(video_bitstream_t *stream, const uint8_t **frame, size_t *size) {
+    const uint8_t *data = stream->data;
+    size_t start = stream->offset;
+    size_t nal = start;
+    bool picture = false;
+
+    while (nal < stream->size) {
+        // Skip the start code to the NAL header
+        size_t header = nal;
+        while (header < stream->size && data[header] == 0) {
+            header++;
+        }
+        header++;
+        if (header >= stream->size) {
+            nal = stream->size;
+            break;
+        }
+
+        size_t next = find_start_code(data, stream->size, header, header);
+        bool vcl;
+        if (nal_starts_access_unit(stream->codec, data + header, next - header, &vcl) && picture) {
+            break;
+        }
+        picture = picture || vcl;
+        nal = next;
+    }
+
+    if (nal == start) {
+        return false;
+    }
+    *frame = data + start;
+    *size = nal - start;
+    stream->offset = nal;
+    return true;
+}
+
+static bool next_ivf_frame(video_bitstream_t *stream, const uint8_t **frame, size_t *size) {
+    if (stream->offset + IVF_FRAME_HEADER_SIZE > stream->size) {
+        return false;
+    }
+    uint32_t length = read_le32(stream->data + stream->offset);
+    size_t start = stream->offset + IVF_FRAME_HEADER_SIZE;
+    if (length == 0 || length > stream->size - start) {
+        fprintf(stderr, "Truncated IVF frame at offset %zu\n", stream->offset);
+        return false;
+    }
+    *frame = stream->data + start;
+    *size = length;
+    stream->offset = start + length;
+    return true;
+}
+
+bool video_bitstream_next(video_bitstream_t *stream, const uint8_t **frame, size_t *size) {
+    if (stream->codec == VIDEO_FORMAT_H264 || stream->codec == VIDEO_FORMAT_H265) {
+        return next_access_unit(stream, frame, size);
+    }
+    return next_ivf_frame(stream, frame, size);
+}
+
+// IVF by its signature, otherwise Annex B by the first NAL header: an
+// H.265 parameter set or delimiter has layer 0, temporal id 1
+static bool detect_codec(video_bitstream_t *stream) {
+    const uint8_t *data = stream->data;
+    if (stream->size >= IVF_HEADER_SIZE && memcmp(data, "DKIF", 4) == 0) {
+        uint16_t header_size = read_le16(data + 6);
+        if (memcmp(data + 8, "VP90", 4) == 0) {
+            stream->codec = VIDEO_FORMAT_VP9;
+        } else if (memcmp(data + 8, "VP80", 4) == 0) {
+            stream->codec = VIDEO_FORMAT_VP8;
+        } else {
+            fprintf(stderr, "Unsupported IVF codec %.4s\n", (const char *)data + 8);
+            return false;
+        }
+        stream->width = read_le16(data + 12);
+        stream->height = read_le16(data + 14);
+        stream->offset = header_size >= IVF_HEADER_SIZE ? header_size : IVF_HEADER_SIZE;
+        return true;
+    }
+
+    size_t start = find_start_code(data, stream->size, 0, 0);
+    size_t header = start;
+    while (header < stream->size && data[header] == 0) {
+        header++;
+    }
+    header++;
+    if (start != 0 || header + 1 >= stream->size) {
+        fprintf(stderr, "Neither IVF nor an Annex B stream\n");
+        return false;
+    }
+
+    uint32_t hevc_type = (data[header] >> 1) & 0x3F;
+    uint32_t avc_type = data[header] & 0x1F;
+    if (((hevc_type >= 32 && hevc_type <= 35) || hevc_type == 39) && data[header + 1] == 0x01) {
+        stream->codec = VIDEO_FORMAT_H265;
+    } else if (!(data[header] & 0x80) && ((avc_type >= 1 && avc_type <= 9) || avc_type == 14)) {
+        stream->codec = VIDEO_FORMAT_H264;
+    } else {
+        fprintf(stderr, "Unknown NAL unit header 0x%02x\n", data[header]);
+        return false;
+    }
+    stream->offset = 0;
+    return true;
+}
+
+bool video_bitstream_open(const char *path, video_bitstream_t *stream) {
+    memset(stream, 0, sizeof(*stream));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    stream->data = map;
+    stream->size = stream->map_size = (size_t)st.st_size;
+    if (!detect_codec(stream)) {
+        video_bitstream_close(stream);
+        return false;
+    }
+    return true;
+}
+
+void video_bitstream_close(video_bitstream_t *stream) {
+    if (stream->data) {
+        munmap((void *)stream->data, stream->map_size);
+    }
+    memset(stream, 0, sizeof(*stream));
+}
+
+static bool device_has_codec(const video_m2m_t *m2m, uint32_t fourcc, bool encoder) {
+    return video_m2m_has_format(m2m, encoder ? &m2m->capture : &m2m->output, fourcc);
+}
+
+bool video_codec_find(uint32_t device_index, video_format_t codec, bool encoder, bool scan, uint32_t *found) {
+    uint32_t fourcc = video_format_to_v4l2(codec);
+    video_m2m_t m2m;
+
+    bool ok;
+    if (scan) {
+        ok = video_m2m_find(device_index, encoder ? 0 : fourcc, encoder ? fourcc : 0, 0, &m2m);
+    } else {
+        ok = video_m2m_open(device_index, 0, &m2m);
+        if (ok && !device_has_codec(&m2m, fourcc, encoder)) {
+            video_m2m_close(&m2m);
+            ok = false;
+        }
+    }
+    if (ok) {
+        *found = m2m.device_index;
+        video_m2m_close(&m2m);
+    }
+    return ok;
+}
+
+// One encode or decode through the device's two queues
+typedef struct codec_run codec_run_t;
+struct codec_run {
+    video_m2m_t m2m;
+    bool encoder;
+    video_codec_stats_t *stats;
+    // Puts the next input into an OUTPUT buffer; false at the end of input
+    bool (*fill)(codec_run_t *run, video_m2m_buffer_t *buffer, uint32_t *bytesused);
+    uint32_t frame_limit;          // Encoder frames to submit
+    uint32_t submitted;            // OUTPUT buffers queued with input; also their timestamps
+    uint64_t submit_ns[LATENCY_SLOTS];
+    bool end_of_input;
+    bool draining;                 // End of input reached and the stop command sent
+    bool stop_accepted;
+    bool finished;                 // The last CAPTURE buffer is back
+    bool capture_ready;            // Decoders set CAPTURE up after the first source change
+    uint64_t start_ns;
+    uint64_t last_ns;
+
+    // Encoder input
+    video_frame_t source;
+    video_format_t raw_format;
+
+    // Decoder input
+    video_bitstream_t bitstream;
+};
+
+static bool feed(codec_run_t *run, uint32_t index) {
+    video_m2m_t *m2m = &run->m2m;
+    uint32_t bytesused = 0;
+    if (!run->fill(run, &m2m->output.buffers[index], &bytesused)) {
+        run->end_of_input = true;
+        return true;
+    }
+
+    run->submit_ns[run->submitted % LATENCY_SLOTS] = report_time_now_ns();
+    if (!video_m2m_queue(m2m, &m2m->output, index, bytesused, run->submitted)) {
+        return false;
+    }
+    run->submitted++;
+    return true;
+}
+
+static bool feed_all(codec_run_t *run) {
+    int index;
+    while (!run->end_of_input && (index = video_m2m_free_buffer(&run->m2m.output)) >= 0) {
+        if (!feed(run, (uint32_t)index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Recycles finished OUTPUT buffers
+static bool collect_output(codec_run_t *run) {
+    video_m2m_done_t done;
+    int ret;
+    while ((ret = video_m2m_dequeue(&run->m2m, &run->m2m.output, &done)) > 0) {
+        if (done.flags & V4L2_BUF_FLAG_ERROR) {
+            run->stats->errors++;
+        }
+    }
+    return ret == 0;
+}
+
+static bool collect_capture(codec_run_t *run) {
+    video_m2m_t *m2m = &run->m2m;
+    video_codec_stats_t *stats = run->stats;
+    video_m2m_done_t done;
+    int ret;
+
+    while (!run->finished && (ret = video_m2m_dequeue(m2m, &m2m->capture, &done)) > 0) {
+        uint64_t now = report_time_now_ns();
+        if (done.flags & V4L2_BUF_FLAG_ERROR) {
+            stats->errors++;
+        } else if (done.bytesused > 0) {
+            stats->frames++;
+            if (run->encoder) {
+                stats->bytes += done.bytesused;
+            }
+            if (done.flags & V4L2_BUF_FLAG_KEYFRAME) {
+                stats->keyframes++;
+            }
+            // Frames are only tracked while they are among the last LATENCY_SLOTS queued
+            if (done.timestamp_us < run->submitted && run->submitted - done.timestamp_us <= LATENCY_SLOTS) {
+                report_histogram_record(&stats->latency, now - run->submit_ns[done.timestamp_us % LATENCY_SLOTS]);
+            }
+            run->last_ns = now;
+        }
+
+        if (done.flags & V4L2_BUF_FLAG_LAST) {
+            run->finished = true;
+        } else if (!video_m2m_queue(m2m, &m2m->capture, done.index, 0, 0)) {
+            return false;
+        }
+    }
+
+    if (!run->finished && ret < 0) {
+        // Past the last buffer the queue reports EPIPE
+        if (errno != EPIPE) {
+            return false;
+        }
+        run->finished = true;
+    }
+    return true;
+}
+
+static bool queue_all_capture(codec_run_t *run) {
+    video_m2m_t *m2m = &run->m2m;
+    for (uint32_t i = 0; i < m2m->capture.count; i++) {
+        if (!video_m2m_queue(m2m, &m2m->capture, i, 0, 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Drains pending events; a source change after CAPTURE is running would
+// need the queue reallocated, which a benchmark has no use for
+static bool handle_events(codec_run_t *run, bool *source_change) {
+    uint32_t type;
+    while (video_m2m_next_event(&run->m2m, &type)) {
+        if (type == V4L2_EVENT_SOURCE_CHANGE) {
+            if (run->capture_ready) {
+                fprintf(stderr, "Stream changed resolution after %u frames\n", run->stats->frames);
+                return false;
+            }
+            *source_change = true;
+        }
+    }
+    return true;
+}
+
+// Keeps every OUTPUT buffer holding input and every CAPTURE buffer queued
+// until the device hands back its last buffer
+static bool run_pipeline(codec_run_t *run) {
+    video_m2m_t *m2m = &run->m2m;
+    run->start_ns = run->last_ns = report_time_now_ns();
+
+    while (!run->finished) {
+        if (!feed_all(run)) {
+            return false;
+        }
+        if (run->end_of_input && !run->draining) {
+            run->draining = true;
+            run->stop_accepted = video_m2m_stop(m2m, run->encoder);
+            if (!run->stop_accepted) {
+                printf("No %s stop command; waiting for %u frames\n", run->encoder ? "encoder" : "decoder",
+                       run->submitted);
+            }
+        }
+
+        if (!collect_output(run) || !collect_capture(run)) {
+            return false;
+        }
+        // Without a stop command, count frames instead
+        if (run->finished || (run->draining && !run->stop_accepted && run->stats->frames >= run->submitted)) {
+            break;
+        }
+
+        int events = video_m2m_wait(m2m);
+        if (events < 0) {
+            return false;
+        }
+        if (events == 0) {
+            fprintf(stderr, "Codec timed out after %u of %u frames\n", run->stats->frames, run->submitted);
+            return false;
+        }
+        bool source_change = false;
+        if ((events & POLLPRI) && !handle_events(run, &source_change)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void finish_stats(codec_run_t *run, const video_test_config_t *config) {
+    video_codec_stats_t *stats = run->stats;
+    uint64_t elapsed = run->last_ns - run->start_ns;
+    uint32_t framerate = config->framerate ? config->framerate : 30;
+
+    stats->device_index = run->m2m.device_index;
+    stats->output_buffers = run->m2m.output.count;
+    stats->capture_buffers = run->m2m.capture.count;
+    stats->fps = elapsed > 0 ? stats->frames * 1e9 / elapsed : 0.0;
+    if (stats->frames > 0) {
+        stats->bitrate = (double)stats->bytes * 8.0 * framerate / stats->frames;
+    }
+    if (stats->target_bitrate > 0) {
+        stats->bitrate_error = (stats->bitrate - stats->target_bitrate) / stats->target_bitrate;
+    }
+}
+
+// The test image, moved MOTION_STEP pixels left per frame so the encoder
+// has motion to search for
+static bool fill_raw_frame(codec_run_t *run, video_m2m_buffer_t *buffer, uint32_t *bytesused) {
+    if (run->submitted >= run->frame_limit) {
+        return false;
+    }
+
+    const video_m2m_queue_t *output = &run->m2m.output;
+    const video_frame_t *src = &run->source;
+    video_frame_t dst;
+    video_frame_wrap(&dst, run->raw_format, src->width, src->height, buffer->map, output->bytesperline);
+
+    uint32_t shift = (run->submitted * MOTION_STEP) % src->width;
+    for (uint32_t p = 0; p < src->plane_count; p++) {
+        bool subsampled = p > 0 && run->raw_format == VIDEO_FORMAT_YUV420;
+        uint32_t row_bytes = subsampled ? src->width / 2 : src->width;
+        uint32_t offset = subsampled ? shift / 2 : shift;
+        uint32_t rows = p > 0 ? src->height / 2 : src->height;
+        for (uint32_t y = 0; y < rows; y++) {
+            const uint8_t *s = src->planes[p] + (size_t)y * src->strides[p];
+            uint8_t *d = dst.planes[p] + (size_t)y * dst.strides[p];
+            memcpy(d, s + offset, row_bytes - offset);
+            memcpy(d + row_bytes - offset, s, offset);
+        }
+    }
+
+    *bytesused = output->sizeimage <= buffer->length ? output->sizeimage : (uint32_t)dst.size;
+    return true;
+}
+
+// One frame or access unit per OUTPUT buffer
+static bool fill_bitstream(codec_run_t *run, video_m2m_buffer_t *buffer, uint32_t *bytesused) {
+    const uint8_t *frame;
+    size_t size;
+    while (video_bitstream_next(&run->bitstream, &frame, &size)) {
+        if (size > buffer->length) {
+            fprintf(stderr, "Skipping a %zu byte frame; OUTPUT buffers hold %zu\n", size, buffer->length);
+            run->stats->errors++;
+            continue;
+        }
+        memcpy(buffer->map, frame, size);
+        *bytesused = (uint32_t)size;
+        run->stats->bytes += size;
+        return true;
+    }
+    return false;
+}
+
+bool test_video_encoding_performance(uint32_t device_index, const video_test_config_t *config,
+                                     video_format_t codec, video_codec_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    report_histogram_init(&stats->latency);
+    stats->codec = codec;
+    stats->device_index = device_index;
+    stats->target_bitrate = config->bitrate ? config->bitrate : VIDEO_CODEC_DEFAULT_BITRATE;
+    uint32_t framerate = config->framerate ? config->framerate : 30;
+
+    codec_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.encoder = true;
+    run.stats = stats;
+    run.fill = fill_raw_frame;
+    run.frame_limit = (config->duration ? config->duration : 10) * framerate;
+
+    video_m2m_t *m2m = &run.m2m;
+    uint32_t fourcc = video_format_to_v4l2(codec);
+    bool result = video_m2m_open(device_index, config->timeout, m2m);
+    if (result && !device_has_codec(m2m, fourcc, true)) {
+        video_m2m_close(m2m);
+        result = false;
+    }
+    if (!result) {
+        fprintf(stderr, "/dev/video%u cannot encode %s\n", device_index, video_format_to_string(codec));
+        return false;
+    }
+
+    // The coded format goes first: it decides what the raw side accepts
+    run.raw_format = video_m2m_has_format(m2m, &m2m->output, V4L2_PIX_FMT_NV12) ? VIDEO_FORMAT_NV12
+                                                                                 : VIDEO_FORMAT_YUV420;
+    result = video_m2m_set_format(m2m, &m2m->capture, fourcc, config->width, config->height,
+                                  VIDEO_CODEC_BITSTREAM_BUFFER, false) &&
+             video_m2m_set_format(m2m, &m2m->output, video_format_to_v4l2(run.raw_format), config->width,
+                                  config->height, 0, false);
+    if (result && (m2m->output.width < config->width || m2m->output.height < config->height)) {
+        printf("Encoder limited %ux%u to %ux%u\n", config->width, config->height, m2m->output.width,
+               m2m->output.height);
+        result = false;
+    }
+    if (result && !video_m2m_set_control(m2m, V4L2_CID_MPEG_VIDEO_BITRATE, (int32_t)stats->target_bitrate)) {
+        fprintf(stderr, "Encoder rejected %u bit/s: %s\n", stats->target_bitrate, strerror(errno));
+        result = false;
+    }
+
+    if (result) {
+        // Not every encoder has these; the bitrate it reaches shows what it did
+        video_m2m_set_control(m2m, V4L2_CID_MPEG_VIDEO_FRAME_RC_ENABLE, 1);
+        video_m2m_set_control(m2m, V4L2_CID_MPEG_VIDEO_BITRATE_MODE, V4L2_MPEG_VIDEO_BITRATE_MODE_CBR);
+        video_m2m_set_control(m2m, V4L2_CID_MPEG_VIDEO_GOP_SIZE, (int32_t)framerate);
+        video_m2m_set_framerate(m2m, framerate);
+
+        // Aligned sizes grow the frame; the extra rows carry more of the image
+        stats->width = m2m->output.width;
+        stats->height = m2m->output.height;
+        result = video_frame_alloc(&run.source, run.raw_format, stats->width, stats->height) &&
+                 video_frame_fill_test_image(&run.source);
+    }
+
+    video_frame_t layout;
+    result = result &&
+             video_m2m_alloc(m2m, &m2m->output, VIDEO_M2M_DEFAULT_BUFFERS) &&
+             video_m2m_alloc(m2m, &m2m->capture, VIDEO_M2M_DEFAULT_BUFFERS) &&
+             video_frame_wrap(&layout, run.raw_format, stats->width, stats->height, NULL,
+                              m2m->output.bytesperline) &&
+             layout.size <= m2m->output.buffers[0].length &&
+             queue_all_capture(&run) &&
+             video_m2m_stream(m2m, &m2m->output, true) &&
+             video_m2m_stream(m2m, &m2m->capture, true);
+
+    if (result) {
+        result = run_pipeline(&run);
+        finish_stats(&run, config);
+        result = result && run.submitted == run.frame_limit && stats->frames > 0 && stats->errors == 0;
+    }
+
+    video_frame_free(&run.source);
+    video_m2m_close(m2m);
+    return result;
+}
+
+// Feeds the headers until the decoder knows the stream's format
+static bool wait_source_change(codec_run_t *run) {
+    bool source_change = false;
+    while (!source_change) {
+        int events = video_m2m_wait(&run->m2m);
+        if (events <= 0) {
+            if (events == 0) {
+                fprintf(stderr, "No source change after %u frames of input\n", run->submitted);
+            }
+            return false;
+        }
+        if ((events & POLLPRI) && !handle_events(run, &source_change)) {
+            return false;
+        }
+        if (!collect_output(run) || !feed_all(run)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sizes CAPTURE from the decoded format, with two buffers beyond what the
+// decoder keeps for reference so it never waits on the reader
+static bool setup_capture(codec_run_t *run) {
+    video_m2m_t *m2m = &run->m2m;
+    if (!video_m2m_get_format(m2m, &m2m->capture)) {
+        return false;
+    }
+
+    int32_t min_buffers = 0;
+    if (!video_m2m_get_control(m2m, V4L2_CID_MIN_BUFFERS_FOR_CAPTURE, &min_buffers) || min_buffers <= 0) {
+        min_buffers = VIDEO_M2M_DEFAULT_BUFFERS;
+    }
+    run->capture_ready = video_m2m_alloc(m2m, &m2m->capture, (uint32_t)min_buffers + 2) &&
+                         queue_all_capture(run) &&
+                         video_m2m_stream(m2m, &m2m->capture, true);
+    return run->capture_ready;
+}
+
+bool test_video_decoding_performance(uint32_t device_index, const video_test_config_t *config,
+                                     const char *input_path, video_codec_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    report_histogram_init(&stats->latency);
+    stats->device_index = device_index;
+
+    if (!input_path) {
+        fprintf(stderr, "Decoding needs an input bitstream\n");
+        return false;
+    }
+
+    codec_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.stats = stats;
+    run.fill = fill_bitstream;
+    if (!video_bitstream_open(input_path, &run.bitstream)) {
+        return false;
+    }
+    stats->codec = run.bitstream.codec;
+
+    video_m2m_t *m2m = &run.m2m;
+    uint32_t fourcc = video_format_to_v4l2(stats->codec);
+    bool result = video_m2m_open(device_index, config->timeout, m2m);
+    if (result && !device_has_codec(m2m, fourcc, false)) {
+        video_m2m_close(m2m);
+        result = false;
+    }
+    if (!result) {
+        fprintf(stderr, "/dev/video%u cannot decode %s\n", device_index, video_format_to_string(stats->codec));
+        video_bitstream_close(&run.bitstream);
+        return false;
+    }
+
+    // The size is only a hint until the decoder has parsed the headers.
+    // Drivers that send no source change report the format straight away.
+    uint32_t width = run.bitstream.width ? run.bitstream.width : config->width;
+    uint32_t height = run.bitstream.height ? run.bitstream.height : config->height;
+    bool events = video_m2m_subscribe(m2m, V4L2_EVENT_SOURCE_CHANGE);
+    result = video_m2m_set_format(m2m, &m2m->output, fourcc, width, height, VIDEO_CODEC_BITSTREAM_BUFFER, false) &&
+             video_m2m_alloc(m2m, &m2m->output, VIDEO_M2M_DEFAULT_BUFFERS) &&
+             feed_all(&run) &&
+             video_m2m_stream(m2m, &m2m->output, true) &&
+             (!events || wait_source_change(&run)) &&
+             setup_capture(&run);
+
+    if (result) {
+        stats->width = m2m->capture.width;
+        stats->height = m2m->capture.height;
+        result = run_pipeline(&run);
+        finish_stats(&run, config);
+        result = result && stats->frames > 0 && stats->errors == 0;
+    }
+
+    video_m2m_close(m2m);
+    video_bitstream_close(&run.bitstream);
+    return result;
+}
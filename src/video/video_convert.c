@@ -0,0 +1,1406 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "video/video_convert.h"
+#include "video/video_m2m.h"
+#include "common/worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <linux/videodev2.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CONVERT_HAVE_X86 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define CONVERT_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Output rows per band; even, so 4:2:0 row pairs never straddle two bands
+#define CONVERT_BAND_ROWS 16
+
+// Every operation unpacks into 4:4:4 planes of the source's colour family
+// (Y/U/V or R/G/B, plus alpha), filters there, converts the family if the
+// destination needs the other one and packs. Planes are width-strided.
+typedef struct {
+    uint32_t width;
+    uint32_t rows;
+    uint8_t *plane[4];
+    uint8_t *data;
+} pivot_t;
+
+// Row kernels. The colour kernels convert count pixels of three planes in
+// place; blend writes (a * (256 - weight) + b * weight + 128) >> 8 for a
+// weight in 1..255. Vector paths give the same bytes as the scalar ones.
+typedef void (*color_row_fn)(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count);
+typedef void (*blend_row_fn)(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t weight, size_t count);
+
+typedef struct {
+    color_row_fn yuv_to_rgb;
+    color_row_fn rgb_to_yuv;
+    blend_row_fn blend;
+} convert_kernels_t;
+
+// Row kernels per format. unpack writes source row y into one pivot row,
+// repeating 4:2:0 chroma on both rows of its pair and 4:2:2 chroma on both
+// pixels; pack writes pack_rows frame rows from as many pivot rows. The
+// packed layouts are generated from their byte offsets, so every loop has
+// a constant pixel size and the compiler vectorises it for that size.
+typedef void (*unpack_row_fn)(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row);
+typedef void (*pack_row_fn)(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row);
+
+typedef struct {
+    unpack_row_fn unpack;
+    pack_row_fn pack;
+    uint32_t pack_rows;
+} format_rows_t;
+
+typedef enum {
+    OP_FILL,
+    OP_CONVERT,
+    OP_SCALE,
+    OP_UNPACK,
+    OP_ROTATE
+} op_kind_t;
+
+// Source coverage of one output axis for the area filter; output i takes
+// count[i] source pixels from start[i] with weights[i * taps + k]
+typedef struct {
+    uint32_t *start;
+    uint32_t *count;
+    float *weights;
+    uint32_t taps;
+} area_axis_t;
+
+typedef struct {
+    op_kind_t kind;
+    const video_frame_t *src;
+    video_frame_t *dst;
+    const convert_kernels_t *kernels;
+    const format_rows_t *src_rows;
+    const format_rows_t *dst_rows;
+
+    // Bilinear: source index, clamped next index and 1/256 weight per
+    // output column and row
+    video_scale_filter_t filter;
+    uint32_t *x_index;
+    uint32_t *x_next;
+    uint8_t *x_weight;
+    uint32_t *y_index;
+    uint8_t *y_weight;
+    area_axis_t x_area;
+    area_axis_t y_area;
+
+    // Rotation reads the whole source, unpacked once up front
+    uint32_t angle;
+    pivot_t full;
+} convert_op_t;
+
+typedef struct {
+    convert_op_t *op;
+    uint32_t y0;                   // Output rows (source rows for OP_UNPACK)
+    uint32_t y1;
+} band_t;
+
+static uint32_t convert_threads = 0;
+
+static inline uint8_t clamp_u8(int value) {
+    return value < 0 ? 0 : value > 255 ? 255 : (uint8_t)value;
+}
+
+// BT.601 limited range, 8-bit fixed point
+static void yuv_to_rgb_scalar(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int c = c0[i] - 16;
+        int d = c1[i] - 128;
+        int e = c2[i] - 128;
+
+        c0[i] = clamp_u8((298 * c + 409 * e + 128) >> 8);
+        c1[i] = clamp_u8((298 * c - 100 * d - 208 * e + 128) >> 8);
+        c2[i] = clamp_u8((298 * c + 516 * d + 128) >> 8);
+    }
+}
+
+static void rgb_to_yuv_scalar(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int r = c0[i];
+        int g = c1[i];
+        int b = c2[i];
+
+        c0[i] = clamp_u8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        c1[i] = clamp_u8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        c2[i] = clamp_u8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+static void blend_scalar(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t weight, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (uint8_t)((a[i] * (256 - weight) + b[i] * weight + 128) >> 8);
+    }
+}
+
+static const convert_kernels_t scalar_kernels = {
+    yuv_to_rgb_scalar, rgb_to_yuv_scalar, blend_scalar
+};
+
+#ifdef CONVERT_HAVE_X86
+#define SSE2_PAIR(a, b) _mm_setr_epi16((a), (b), (a), (b), (a), (b), (a), (b))
+
+// 8-bit lanes to 16-bit, minus bias
+__attribute__((target("sse2")))
+static inline __m128i widen_sse2(const uint8_t *src, int bias) {
+    __m128i value = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+    return _mm_sub_epi16(value, _mm_set1_epi16((short)bias));
+}
+
+// Shifts two halves of 32-bit sums down and stores them saturated to 8 bits
+__attribute__((target("sse2")))
+static inline void narrow_sse2(uint8_t *dst, __m128i lo, __m128i hi) {
+    __m128i value = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+    _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(value, value));
+}
+
+__attribute__((target("sse2")))
+static void yuv_to_rgb_sse2(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i round = _mm_set1_epi32(128);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i c = widen_sse2(c0 + i, 16);
+        __m128i d = widen_sse2(c1 + i, 128);
+        __m128i e = widen_sse2(c2 + i, 128);
+        __m128i ce_lo = _mm_unpacklo_epi16(c, e), ce_hi = _mm_unpackhi_epi16(c, e);
+        __m128i cd_lo = _mm_unpacklo_epi16(c, d), cd_hi = _mm_unpackhi_epi16(c, d);
+        __m128i e1_lo = _mm_unpacklo_epi16(e, one), e1_hi = _mm_unpackhi_epi16(e, one);
+
+        narrow_sse2(c0 + i, _mm_add_epi32(_mm_madd_epi16(ce_lo, SSE2_PAIR(298, 409)), round),
+                    _mm_add_epi32(_mm_madd_epi16(ce_hi, SSE2_PAIR(298, 409)), round));
+        narrow_sse2(c1 + i, _mm_add_epi32(_mm_madd_epi16(cd_lo, SSE2_PAIR(298, -100)),
+                                          _mm_madd_epi16(e1_lo, SSE2_PAIR(-208, 128))),
+                    _mm_add_epi32(_mm_madd_epi16(cd_hi, SSE2_PAIR(298, -100)),
+                                  _mm_madd_epi16(e1_hi, SSE2_PAIR(-208, 128))));
+        narrow_sse2(c2 + i, _mm_add_epi32(_mm_madd_epi16(cd_lo, SSE2_PAIR(298, 516)), round),
+                    _mm_add_epi32(_mm_madd_epi16(cd_hi, SSE2_PAIR(298, 516)), round));
+    }
+
+    yuv_to_rgb_scalar(c0 + i, c1 + i, c2 + i, count - i);
+}
+
+// The output offsets are folded into the rounding term, (16 << 8) + 128
+// for Y and (128 << 8) + 128 for chroma
+__attribute__((target("sse2")))
+static void rgb_to_yuv_sse2(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    const __m128i one = _mm_set1_epi16(1);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i r = widen_sse2(c0 + i, 0);
+        __m128i g = widen_sse2(c1 + i, 0);
+        __m128i b = widen_sse2(c2 + i, 0);
+        __m128i rg_lo = _mm_unpacklo_epi16(r, g), rg_hi = _mm_unpackhi_epi16(r, g);
+        __m128i b1_lo = _mm_unpacklo_epi16(b, one), b1_hi = _mm_unpackhi_epi16(b, one);
+
+        narrow_sse2(c0 + i, _mm_add_epi32(_mm_madd_epi16(rg_lo, SSE2_PAIR(66, 129)),
+                                          _mm_madd_epi16(b1_lo, SSE2_PAIR(25, 4224))),
+                    _mm_add_epi32(_mm_madd_epi16(rg_hi, SSE2_PAIR(66, 129)),
+                                  _mm_madd_epi16(b1_hi, SSE2_PAIR(25, 4224))));
+        narrow_sse2(c1 + i, _mm_add_epi32(_mm_madd_epi16(rg_lo, SSE2_PAIR(-38, -74)),
+                                          _mm_add_epi32(_mm_madd_epi16(b1_lo, SSE2_PAIR(112, 128)),
+                                                        _mm_set1_epi32(32768))),
+                    _mm_add_epi32(_mm_madd_epi16(rg_hi, SSE2_PAIR(-38, -74)),
+                                  _mm_add_epi32(_mm_madd_epi16(b1_hi, SSE2_PAIR(112, 128)),
+                                                _mm_set1_epi32(32768))));
+        narrow_sse2(c2 + i, _mm_add_epi32(_mm_madd_epi16(rg_lo, SSE2_PAIR(112, -94)),
+                                          _mm_add_epi32(_mm_madd_epi16(b1_lo, SSE2_PAIR(-18, 128)),
+                                                        _mm_set1_epi32(32768))),
+                    _mm_add_epi32(_mm_madd_epi16(rg_hi, SSE2_PAIR(112, -94)),
+                                  _mm_add_epi32(_mm_madd_epi16(b1_hi, SSE2_PAIR(-18, 128)),
+                                                _mm_set1_epi32(32768))));
+    }
+
+    rgb_to_yuv_scalar(c0 + i, c1 + i, c2 + i, count - i);
+}
+
+// Products stay below 2^16: the weights sum to 256
+__attribute__((target("sse2")))
+static void blend_sse2(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t weight, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16((short)(256 - weight));
+    const __m128i wb = _mm_set1_epi16((short)weight);
+    const __m128i round = _mm_set1_epi16(128);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                                 _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb)), round);
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                                 _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb)), round);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+
+    blend_scalar(dst + i, a + i, b + i, weight, count - i);
+}
+
+static const convert_kernels_t sse2_kernels = {
+    yuv_to_rgb_sse2, rgb_to_yuv_sse2, blend_sse2
+};
+#endif /* CONVERT_HAVE_X86 */
+
+#ifdef CONVERT_HAVE_NEON
+static inline int16x8_t widen_neon(const uint8_t *src, int bias) {
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src))), vdupq_n_s16((int16_t)bias));
+}
+
+static inline uint8x8_t narrow_neon(int32x4_t lo, int32x4_t hi) {
+    return vqmovun_s16(vcombine_s16(vmovn_s32(vshrq_n_s32(lo, 8)), vmovn_s32(vshrq_n_s32(hi, 8))));
+}
+
+// Three-term dot product per half, on top of a bias
+#define NEON_DOT(x, y, z, kx, ky, kz, bias, half)                                            \
+    vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vdupq_n_s32(bias), vget_##half##_s16(x), (kx)),    \
+                            vget_##half##_s16(y), (ky)), vget_##half##_s16(z), (kz))
+
+static void yuv_to_rgb_neon(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        int16x8_t c = widen_neon(c0 + i, 16);
+        int16x8_t d = widen_neon(c1 + i, 128);
+        int16x8_t e = widen_neon(c2 + i, 128);
+
+        vst1_u8(c0 + i, narrow_neon(NEON_DOT(c, d, e, 298, 0, 409, 128, low),
+                                    NEON_DOT(c, d, e, 298, 0, 409, 128, high)));
+        vst1_u8(c1 + i, narrow_neon(NEON_DOT(c, d, e, 298, -100, -208, 128, low),
+                                    NEON_DOT(c, d, e, 298, -100, -208, 128, high)));
+        vst1_u8(c2 + i, narrow_neon(NEON_DOT(c, d, e, 298, 516, 0, 128, low),
+                                    NEON_DOT(c, d, e, 298, 516, 0, 128, high)));
+    }
+
+    yuv_to_rgb_scalar(c0 + i, c1 + i, c2 + i, count - i);
+}
+
+static void rgb_to_yuv_neon(uint8_t *c0, uint8_t *c1, uint8_t *c2, size_t count) {
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        int16x8_t r = widen_neon(c0 + i, 0);
+        int16x8_t g = widen_neon(c1 + i, 0);
+        int16x8_t b = widen_neon(c2 + i, 0);
+
+        vst1_u8(c0 + i, narrow_neon(NEON_DOT(r, g, b, 66, 129, 25, 4224, low),
+                                    NEON_DOT(r, g, b, 66, 129, 25, 4224, high)));
+        vst1_u8(c1 + i, narrow_neon(NEON_DOT(r, g, b, -38, -74, 112, 32896, low),
+                                    NEON_DOT(r, g, b, -38, -74, 112, 32896, high)));
+        vst1_u8(c2 + i, narrow_neon(NEON_DOT(r, g, b, 112, -94, -18, 32896, low),
+                                    NEON_DOT(r, g, b, 112, -94, -18, 32896, high)));
+    }
+
+    rgb_to_yuv_scalar(c0 + i, c1 + i, c2 + i, count - i);
+}
+
+static void blend_neon(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t weight, size_t count) {
+    const uint8x8_t wa = vdup_n_u8((uint8_t)(256 - weight));
+    const uint8x8_t wb = vdup_n_u8((uint8_t)weight);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        uint8x16_t va = vld1q_u8(a + i);
+        uint8x16_t vb = vld1q_u8(b + i);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), wa), vget_low_u8(vb), wb);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), wa), vget_high_u8(vb), wb);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+
+    blend_scalar(dst + i, a + i, b + i, weight, count - i);
+}
+
+static const convert_kernels_t neon_kernels = {
+    yuv_to_rgb_neon, rgb_to_yuv_neon, blend_neon
+};
+#endif /* CONVERT_HAVE_NEON */
+
+pattern_isa_t video_convert_isa(void) {
+    switch (pattern_get_isa()) {
+#ifdef CONVERT_HAVE_X86
+        case PATTERN_ISA_SSE2:
+        case PATTERN_ISA_AVX2:
+            return PATTERN_ISA_SSE2;
+#endif
+#ifdef CONVERT_HAVE_NEON
+        case PATTERN_ISA_NEON:
+            return PATTERN_ISA_NEON;
+#endif
+        default:
+            return PATTERN_ISA_SCALAR;
+    }
+}
+
+static const convert_kernels_t *select_kernels(void) {
+    switch (video_convert_isa()) {
+#ifdef CONVERT_HAVE_X86
+        case PATTERN_ISA_SSE2:
+            return &sse2_kernels;
+#endif
+#ifdef CONVERT_HAVE_NEON
+        case PATTERN_ISA_NEON:
+            return &neon_kernels;
+#endif
+        default:
+            return &scalar_kernels;
+    }
+}
+
+void video_convert_set_threads(uint32_t threads) {
+    convert_threads = threads;
+}
+
+static uint32_t worker_count(void) {
+    return convert_threads ? convert_threads : worker_default_count();
+}
+
+// Frame geometry
+bool video_format_is_raw(video_format_t format) {
+    return format < VIDEO_FORMAT_MJPEG;
+}
+
+static bool format_is_yuv(video_format_t format) {
+    return format >= VIDEO_FORMAT_NV12 && format <= VIDEO_FORMAT_UYVY;
+}
+
+static bool format_is_420(video_format_t format) {
+    return format == VIDEO_FORMAT_NV12 || format == VIDEO_FORMAT_YUV420;
+}
+
+static uint32_t packed_stride(video_format_t format, uint32_t width) {
+    switch (format) {
+        case VIDEO_FORMAT_RGB565:
+        case VIDEO_FORMAT_YUYV:
+        case VIDEO_FORMAT_UYVY:
+            return width * 2;
+        case VIDEO_FORMAT_RGB888:
+            return width * 3;
+        case VIDEO_FORMAT_RGBA8888:
+        case VIDEO_FORMAT_ARGB8888:
+            return width * 4;
+        default:
+            return width;
+    }
+}
+
+bool video_frame_wrap(video_frame_t *frame, video_format_t format, uint32_t width, uint32_t height,
+                      void *data, uint32_t stride) {
+    if (!frame || !video_format_is_raw(format) || width == 0 || height == 0) {
+        return false;
+    }
+    // Chroma is sited on pixel pairs
+    if (format_is_yuv(format) && (width % 2 || height % 2)) {
+        fprintf(stderr, "%s needs an even width and height, not %ux%u\n",
+                video_format_to_string(format), width, height);
+        return false;
+    }
+
+    uint32_t min_stride = packed_stride(format, width);
+    if (stride == 0) {
+        stride = min_stride;
+    }
+    if (stride < min_stride || (format_is_yuv(format) && format != VIDEO_FORMAT_NV12 &&
+                                format != VIDEO_FORMAT_YUYV && format != VIDEO_FORMAT_UYVY && stride % 2)) {
+        fprintf(stderr, "Stride %u too small for %ux%u %s\n", stride, width, height,
+                video_format_to_string(format));
+        return false;
+    }
+
+    memset(frame, 0, sizeof(*frame));
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->plane_count = 1;
+    frame->planes[0] = data;
+    frame->strides[0] = stride;
+
+    size_t luma = (size_t)stride * height;
+    switch (format) {
+        case VIDEO_FORMAT_NV12:
+            frame->plane_count = 2;
+            frame->strides[1] = stride;
+            frame->size = luma + luma / 2;
+            break;
+        case VIDEO_FORMAT_YUV420:
+            frame->plane_count = 3;
+            frame->strides[1] = frame->strides[2] = stride / 2;
+            frame->size = luma + luma / 2;
+            break;
+        case VIDEO_FORMAT_YUV422:
+            frame->plane_count = 3;
+            frame->strides[1] = frame->strides[2] = stride / 2;
+            frame->size = luma * 2;
+            break;
+        default:
+            frame->size = luma;
+            break;
+    }
+
+    if (data) {
+        uint8_t *next = (uint8_t *)data + luma;
+        for (uint32_t i = 1; i < frame->plane_count; i++) {
+            frame->planes[i] = next;
+            next += (size_t)frame->strides[i] * (format_is_420(format) ? height / 2 : height);
+        }
+    }
+    return true;
+}
+
+size_t video_frame_size(video_format_t format, uint32_t width, uint32_t height, uint32_t stride) {
+    video_frame_t frame;
+    return video_frame_wrap(&frame, format, width, height, NULL, stride) ? frame.size : 0;
+}
+
+bool video_frame_alloc(video_frame_t *frame, video_format_t format, uint32_t width, uint32_t height) {
+    size_t size = video_frame_size(format, width, height, 0);
+    if (size == 0) {
+        return false;
+    }
+
+    void *data = malloc(size);
+    if (!data) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+
+    video_frame_wrap(frame, format, width, height, data, 0);
+    frame->allocation = data;
+    return true;
+}
+
+void video_frame_free(video_frame_t *frame) {
+    if (frame) {
+        free(frame->allocation);
+        memset(frame, 0, sizeof(*frame));
+    }
+}
+
+static void plane_geometry(const video_frame_t *frame, uint32_t plane, uint32_t *row_bytes, uint32_t *rows) {
+    *row_bytes = packed_stride(frame->format, frame->width);
+    *rows = frame->height;
+    if (plane > 0) {
+        if (frame->format != VIDEO_FORMAT_NV12) {
+            *row_bytes /= 2;
+        }
+        if (format_is_420(frame->format)) {
+            *rows /= 2;
+        }
+    }
+}
+
+bool video_frame_copy(video_frame_t *dst, const video_frame_t *src) {
+    if (!dst || !src || dst->format != src->format || dst->width != src->width || dst->height != src->height) {
+        return false;
+    }
+
+    for (uint32_t plane = 0; plane < src->plane_count; plane++) {
+        uint32_t row_bytes, rows;
+        plane_geometry(src, plane, &row_bytes, &rows);
+        for (uint32_t y = 0; y < rows; y++) {
+            memcpy(dst->planes[plane] + (size_t)y * dst->strides[plane],
+                   src->planes[plane] + (size_t)y * src->strides[plane], row_bytes);
+        }
+    }
+    return true;
+}
+
+// Pivot planes
+static bool pivot_alloc(pivot_t *pivot, uint32_t width, uint32_t rows) {
+    size_t plane_size = (size_t)width * rows;
+    pivot->width = width;
+    pivot->rows = rows;
+    pivot->data = malloc(plane_size * 4);
+    if (!pivot->data) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        pivot->plane[i] = pivot->data + plane_size * i;
+    }
+    return true;
+}
+
+static void pivot_free(pivot_t *pivot) {
+    free(pivot->data);
+    memset(pivot, 0, sizeof(*pivot));
+}
+
+static inline uint8_t *pivot_row(const pivot_t *pivot, uint32_t plane, uint32_t row) {
+    return pivot->plane[plane] + (size_t)row * pivot->width;
+}
+
+static inline uint8_t average2(uint8_t a, uint8_t b) {
+    return (uint8_t)((a + b + 1) >> 1);
+}
+
+static inline uint8_t average4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    return (uint8_t)((a + b + c + d + 2) >> 2);
+}
+
+#define PIVOT_ROWS(qualifier)                          \
+    qualifier uint8_t *c0 = pivot_row(pivot, 0, row);  \
+    qualifier uint8_t *c1 = pivot_row(pivot, 1, row);  \
+    qualifier uint8_t *c2 = pivot_row(pivot, 2, row);  \
+    qualifier uint8_t *a = pivot_row(pivot, 3, row);   \
+    size_t width = frame->width
+
+// R, G, B and alpha at byte offsets r, g, b and alpha of a bpp-byte pixel
+#define DEFINE_RGB_ROWS(name, bpp, r, g, b, has_alpha, alpha)                                                \
+    static void unpack_##name(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {  \
+        PIVOT_ROWS();                                                                                        \
+        const uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];                                 \
+        for (size_t x = 0; x < width; x++) {                                                                 \
+            c0[x] = p[bpp * x + r];                                                                          \
+            c1[x] = p[bpp * x + g];                                                                          \
+            c2[x] = p[bpp * x + b];                                                                          \
+            if (has_alpha) {                                                                                 \
+                a[x] = p[bpp * x + alpha];                                                                   \
+            }                                                                                                \
+        }                                                                                                    \
+        if (!has_alpha) {                                                                                    \
+            memset(a, 0xFF, width);                                                                          \
+        }                                                                                                    \
+    }                                                                                                        \
+    static void pack_##name(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {          \
+        PIVOT_ROWS(const);                                                                                   \
+        uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];                                       \
+        for (size_t x = 0; x < width; x++) {                                                                 \
+            p[bpp * x + r] = c0[x];                                                                          \
+            p[bpp * x + g] = c1[x];                                                                          \
+            p[bpp * x + b] = c2[x];                                                                          \
+            if (has_alpha) {                                                                                 \
+                p[bpp * x + alpha] = a[x];                                                                   \
+            }                                                                                                \
+        }                                                                                                    \
+        (void)a;                                                                                             \
+    }
+
+DEFINE_RGB_ROWS(rgb888, 3, 0, 1, 2, false, 0)
+DEFINE_RGB_ROWS(rgba8888, 4, 0, 1, 2, true, 3)
+DEFINE_RGB_ROWS(argb8888, 4, 1, 2, 3, true, 0)
+
+// Interleaved 4:2:2 with luma at byte luma of each pair, chroma at chroma
+// and chroma + 2: Y0 U Y1 V or U Y0 V Y1
+#define DEFINE_YUV422_PACKED_ROWS(name, luma, chroma)                                                        \
+    static void unpack_##name(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {  \
+        PIVOT_ROWS();                                                                                        \
+        const uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];                                 \
+        for (size_t x = 0; x < width; x += 2) {                                                              \
+            c0[x] = p[2 * x + luma];                                                                         \
+            c0[x + 1] = p[2 * x + luma + 2];                                                                 \
+            c1[x] = c1[x + 1] = p[2 * x + chroma];                                                           \
+            c2[x] = c2[x + 1] = p[2 * x + chroma + 2];                                                       \
+        }                                                                                                    \
+        memset(a, 0xFF, width);                                                                              \
+    }                                                                                                        \
+    static void pack_##name(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {          \
+        PIVOT_ROWS(const);                                                                                   \
+        uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];                                       \
+        for (size_t x = 0; x < width; x += 2) {                                                              \
+            p[2 * x + luma] = c0[x];                                                                         \
+            p[2 * x + luma + 2] = c0[x + 1];                                                                 \
+            p[2 * x + chroma] = average2(c1[x], c1[x + 1]);                                                  \
+            p[2 * x + chroma + 2] = average2(c2[x], c2[x + 1]);                                              \
+        }                                                                                                    \
+        (void)a;                                                                                             \
+    }
+
+DEFINE_YUV422_PACKED_ROWS(yuyv, 0, 1)
+DEFINE_YUV422_PACKED_ROWS(uyvy, 1, 0)
+
+// Planar Y, U and V with chroma_rows luma rows per chroma row
+#define DEFINE_YUV_PLANAR_UNPACK(name, chroma_rows)                                                          \
+    static void unpack_##name(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {  \
+        PIVOT_ROWS();                                                                                        \
+        const uint8_t *u = frame->planes[1] + (size_t)(y / chroma_rows) * frame->strides[1];                 \
+        const uint8_t *v = frame->planes[2] + (size_t)(y / chroma_rows) * frame->strides[2];                 \
+        memcpy(c0, frame->planes[0] + (size_t)y * frame->strides[0], width);                                 \
+        for (size_t x = 0; x < width; x += 2) {                                                              \
+            c1[x] = c1[x + 1] = u[x / 2];                                                                    \
+            c2[x] = c2[x + 1] = v[x / 2];                                                                    \
+        }                                                                                                    \
+        memset(a, 0xFF, width);                                                                              \
+    }
+
+DEFINE_YUV_PLANAR_UNPACK(yuv420, 2)
+DEFINE_YUV_PLANAR_UNPACK(yuv422, 1)
+
+static void unpack_rgb565(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {
+    PIVOT_ROWS();
+    const uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];
+    for (size_t x = 0; x < width; x++) {
+        uint32_t v = p[2 * x] | (uint32_t)p[2 * x + 1] << 8;
+        uint32_t r = v >> 11, g = (v >> 5) & 0x3F, b = v & 0x1F;
+        c0[x] = (uint8_t)(r << 3 | r >> 2);
+        c1[x] = (uint8_t)(g << 2 | g >> 4);
+        c2[x] = (uint8_t)(b << 3 | b >> 2);
+    }
+    memset(a, 0xFF, width);
+}
+
+static void pack_rgb565(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {
+    PIVOT_ROWS(const);
+    uint8_t *p = frame->planes[0] + (size_t)y * frame->strides[0];
+    for (size_t x = 0; x < width; x++) {
+        uint32_t r = (c0[x] * 31 + 127) / 255;
+        uint32_t g = (c1[x] * 63 + 127) / 255;
+        uint32_t b = (c2[x] * 31 + 127) / 255;
+        uint32_t v = r << 11 | g << 5 | b;
+        p[2 * x] = (uint8_t)v;
+        p[2 * x + 1] = (uint8_t)(v >> 8);
+    }
+    (void)a;
+}
+
+static void unpack_nv12(const video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {
+    PIVOT_ROWS();
+    const uint8_t *uv = frame->planes[1] + (size_t)(y / 2) * frame->strides[1];
+    memcpy(c0, frame->planes[0] + (size_t)y * frame->strides[0], width);
+    for (size_t x = 0; x < width; x += 2) {
+        c1[x] = c1[x + 1] = uv[x];
+        c2[x] = c2[x + 1] = uv[x + 1];
+    }
+    memset(a, 0xFF, width);
+}
+
+static void pack_yuv422(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {
+    PIVOT_ROWS(const);
+    uint8_t *u = frame->planes[1] + (size_t)y * frame->strides[1];
+    uint8_t *v = frame->planes[2] + (size_t)y * frame->strides[2];
+    memcpy(frame->planes[0] + (size_t)y * frame->strides[0], c0, width);
+    for (size_t x = 0; x < width; x += 2) {
+        u[x / 2] = average2(c1[x], c1[x + 1]);
+        v[x / 2] = average2(c2[x], c2[x + 1]);
+    }
+    (void)a;
+}
+
+// 4:2:0 packs frame rows y and y + 1 from pivot rows row and row + 1, with
+// chroma at byte chroma_step * i of its plane (U) and U + v_offset (V)
+#define DEFINE_YUV420_PACK(name, chroma_step, v_plane, v_offset)                                              \
+    static void pack_##name(video_frame_t *frame, uint32_t y, const pivot_t *pivot, uint32_t row) {           \
+        const uint8_t *u0 = pivot_row(pivot, 1, row), *u1 = pivot_row(pivot, 1, row + 1);                     \
+        const uint8_t *v0 = pivot_row(pivot, 2, row), *v1 = pivot_row(pivot, 2, row + 1);                     \
+        uint8_t *u = frame->planes[1] + (size_t)(y / 2) * frame->strides[1];                                  \
+        uint8_t *v = frame->planes[v_plane] + (size_t)(y / 2) * frame->strides[v_plane] + v_offset;           \
+        size_t width = frame->width;                                                                          \
+        memcpy(frame->planes[0] + (size_t)y * frame->strides[0], pivot_row(pivot, 0, row), width);            \
+        memcpy(frame->planes[0] + (size_t)(y + 1) * frame->strides[0], pivot_row(pivot, 0, row + 1), width);  \
+        for (size_t x = 0; x < width; x += 2) {                                                               \
+            u[chroma_step * (x / 2)] = average4(u0[x], u0[x + 1], u1[x], u1[x + 1]);                          \
+            v[chroma_step * (x / 2)] = average4(v0[x], v0[x + 1], v1[x], v1[x + 1]);                          \
+        }                                                                                                     \
+    }
+
+DEFINE_YUV420_PACK(nv12, 2, 1, 1)
+DEFINE_YUV420_PACK(yuv420, 1, 2, 0)
+
+// One table, indexed by format, picked once per operation
+static const format_rows_t format_rows[VIDEO_FORMAT_MJPEG] = {
+    [VIDEO_FORMAT_RGB565] = { unpack_rgb565, pack_rgb565, 1 },
+    [VIDEO_FORMAT_RGB888] = { unpack_rgb888, pack_rgb888, 1 },
+    [VIDEO_FORMAT_RGBA8888] = { unpack_rgba8888, pack_rgba8888, 1 },
+    [VIDEO_FORMAT_ARGB8888] = { unpack_argb8888, pack_argb8888, 1 },
+    [VIDEO_FORMAT_NV12] = { unpack_nv12, pack_nv12, 2 },
+    [VIDEO_FORMAT_YUV420] = { unpack_yuv420, pack_yuv420, 2 },
+    [VIDEO_FORMAT_YUV422] = { unpack_yuv422, pack_yuv422, 1 },
+    [VIDEO_FORMAT_YUYV] = { unpack_yuyv, pack_yuyv, 1 },
+    [VIDEO_FORMAT_UYVY] = { unpack_uyvy, pack_uyvy, 1 },
+};
+
+static void pack_band(const convert_op_t *op, uint32_t y0, uint32_t y1, const pivot_t *pivot) {
+    for (uint32_t y = y0; y < y1; y += op->dst_rows->pack_rows) {
+        op->dst_rows->pack(op->dst, y, pivot, y - y0);
+    }
+}
+
+// Bars across the top half; gradients and fine detail below
+static void generate_rows(const video_frame_t *frame, uint32_t y0, const pivot_t *pivot) {
+    static const uint8_t bars[8][3] = {
+        { 235, 235, 235 }, { 235, 235, 16 }, { 16, 235, 235 }, { 16, 235, 16 },
+        { 235, 16, 235 }, { 235, 16, 16 }, { 16, 16, 235 }, { 16, 16, 16 }
+    };
+    uint32_t width = frame->width;
+    uint32_t height = frame->height;
+
+    for (uint32_t row = 0; row < pivot->rows; row++) {
+        uint32_t y = y0 + row;
+        uint8_t *c0 = pivot_row(pivot, 0, row);
+        uint8_t *c1 = pivot_row(pivot, 1, row);
+        uint8_t *c2 = pivot_row(pivot, 2, row);
+
+        for (uint32_t x = 0; x < width; x++) {
+            if (y < height / 2) {
+                const uint8_t *bar = bars[(uint64_t)x * 8 / width];
+                c0[x] = bar[0];
+                c1[x] = bar[1];
+                c2[x] = bar[2];
+            } else if (x < width / 2) {
+                c0[x] = (uint8_t)((uint64_t)x * 510 / width);
+                c1[x] = (uint8_t)((uint64_t)(y - height / 2) * 510 / height);
+                c2[x] = (uint8_t)(255 - c0[x] / 2);
+            } else {
+                uint8_t level = ((x ^ y) & 4) ? 220 : 32;
+                c0[x] = level;
+                c1[x] = (uint8_t)(level / 2 + ((x + y) & 63));
+                c2[x] = (uint8_t)(255 - level);
+            }
+        }
+        memset(pivot_row(pivot, 3, row), 0xFF, width);
+    }
+}
+
+static void scale_rows_bilinear(const convert_op_t *op, const pivot_t *in, uint32_t lo, const band_t *band,
+                                const pivot_t *out, uint8_t *tmp) {
+    uint32_t src_height = op->src->height;
+
+    for (uint32_t plane = 0; plane < 4; plane++) {
+        for (uint32_t y = band->y0; y < band->y1; y++) {
+            uint32_t index = op->y_index[y];
+            uint32_t weight = op->y_weight[y];
+            const uint8_t *row0 = pivot_row(in, plane, index - lo);
+            const uint8_t *row = row0;
+
+            if (weight > 0) {
+                uint32_t next = index + 1 < src_height ? index + 1 : index;
+                op->kernels->blend(tmp, row0, pivot_row(in, plane, next - lo), weight, in->width);
+                row = tmp;
+            }
+
+            uint8_t *dst = pivot_row(out, plane, y - band->y0);
+            for (uint32_t x = 0; x < out->width; x++) {
+                uint32_t wx = op->x_weight[x];
+                dst[x] = (uint8_t)((row[op->x_index[x]] * (256 - wx) + row[op->x_next[x]] * wx + 128) >> 8);
+            }
+        }
+    }
+}
+
+static void scale_rows_area(const convert_op_t *op, const pivot_t *in, uint32_t lo, const band_t *band,
+                            const pivot_t *out, float *acc) {
+    const area_axis_t *ax = &op->x_area;
+    const area_axis_t *ay = &op->y_area;
+
+    for (uint32_t plane = 0; plane < 4; plane++) {
+        for (uint32_t y = band->y0; y < band->y1; y++) {
+            memset(acc, 0, out->width * sizeof(float));
+
+            for (uint32_t k = 0; k < ay->count[y]; k++) {
+                const uint8_t *row = pivot_row(in, plane, ay->start[y] + k - lo);
+                float wy = ay->weights[(size_t)y * ay->taps + k];
+
+                for (uint32_t x = 0; x < out->width; x++) {
+                    const uint8_t *src = row + ax->start[x];
+                    const float *wx = ax->weights + (size_t)x * ax->taps;
+                    float sum = 0.0f;
+                    for (uint32_t t = 0; t < ax->count[x]; t++) {
+                        sum += wx[t] * src[t];
+                    }
+                    acc[x] += wy * sum;
+                }
+            }
+
+            uint8_t *dst = pivot_row(out, plane, y - band->y0);
+            for (uint32_t x = 0; x < out->width; x++) {
+                dst[x] = clamp_u8((int)(acc[x] + 0.5f));
+            }
+        }
+    }
+}
+
+// Clockwise: 90 puts the source's left column on the top row
+static void rotate_rows(const convert_op_t *op, const band_t *band, const pivot_t *out) {
+    const pivot_t *full = &op->full;
+    uint32_t src_width = full->width;
+    uint32_t src_height = full->rows;
+
+    for (uint32_t plane = 0; plane < 4; plane++) {
+        const uint8_t *src = full->plane[plane];
+
+        if (op->angle == 90 || op->angle == 270) {
+            // Column-major over the band: each source row read is reused
+            // by every output row of the band
+            for (uint32_t x = 0; x < out->width; x++) {
+                for (uint32_t y = band->y0; y < band->y1; y++) {
+                    size_t offset = op->angle == 90 ?
+                                    (size_t)(src_height - 1 - x) * src_width + y :
+                                    (size_t)x * src_width + (src_width - 1 - y);
+                    pivot_row(out, plane, y - band->y0)[x] = src[offset];
+                }
+            }
+        } else {
+            for (uint32_t y = band->y0; y < band->y1; y++) {
+                uint8_t *dst = pivot_row(out, plane, y - band->y0);
+                if (op->angle == 180) {
+                    const uint8_t *row = src + (size_t)(src_height - 1 - y) * src_width;
+                    for (uint32_t x = 0; x < out->width; x++) {
+                        dst[x] = row[src_width - 1 - x];
+                    }
+                } else {
+                    memcpy(dst, src + (size_t)y * src_width, out->width);
+                }
+            }
+        }
+    }
+}
+
+static bool band_job(void *arg) {
+    band_t *band = arg;
+    convert_op_t *op = band->op;
+    uint32_t rows = band->y1 - band->y0;
+
+    if (op->kind == OP_UNPACK) {
+        for (uint32_t y = band->y0; y < band->y1; y++) {
+            op->src_rows->unpack(op->src, y, &op->full, y);
+        }
+        return true;
+    }
+
+    pivot_t out;
+    if (!pivot_alloc(&out, op->dst->width, rows)) {
+        return false;
+    }
+
+    bool yuv = op->src && format_is_yuv(op->src->format);
+    bool result = true;
+
+    switch (op->kind) {
+        case OP_FILL:
+            generate_rows(op->dst, band->y0, &out);
+            yuv = false;
+            break;
+        case OP_CONVERT:
+            for (uint32_t y = band->y0; y < band->y1; y++) {
+                op->src_rows->unpack(op->src, y, &out, y - band->y0);
+            }
+            break;
+        case OP_SCALE: {
+            // Only the source rows this band's taps reach
+            uint32_t lo, hi;
+            if (op->filter == VIDEO_SCALE_AREA) {
+                lo = op->y_area.start[band->y0];
+                hi = op->y_area.start[band->y1 - 1] + op->y_area.count[band->y1 - 1] - 1;
+            } else {
+                lo = op->y_index[band->y0];
+                hi = op->y_index[band->y1 - 1] + 1;
+                if (hi >= op->src->height) {
+                    hi = op->src->height - 1;
+                }
+            }
+
+            pivot_t in;
+            void *scratch = op->filter == VIDEO_SCALE_AREA ? malloc(out.width * sizeof(float)) :
+                                                             malloc(op->src->width);
+            result = scratch && pivot_alloc(&in, op->src->width, hi - lo + 1);
+            if (result) {
+                for (uint32_t y = lo; y <= hi; y++) {
+                    op->src_rows->unpack(op->src, y, &in, y - lo);
+                }
+                if (op->filter == VIDEO_SCALE_AREA) {
+                    scale_rows_area(op, &in, lo, band, &out, scratch);
+                } else {
+                    scale_rows_bilinear(op, &in, lo, band, &out, scratch);
+                }
+                pivot_free(&in);
+            }
+            free(scratch);
+            break;
+        }
+        case OP_ROTATE:
+            rotate_rows(op, band, &out);
+            break;
+        default:
+            break;
+    }
+
+    if (result) {
+        bool dst_yuv = format_is_yuv(op->dst->format);
+        size_t count = (size_t)out.width * rows;
+        if (yuv && !dst_yuv) {
+            op->kernels->yuv_to_rgb(out.plane[0], out.plane[1], out.plane[2], count);
+        } else if (!yuv && dst_yuv) {
+            op->kernels->rgb_to_yuv(out.plane[0], out.plane[1], out.plane[2], count);
+        }
+        pack_band(op, band->y0, band->y1, &out);
+    }
+
+    pivot_free(&out);
+    return result;
+}
+
+// Splits rows into bands and runs them on the worker pool
+static bool run_bands(convert_op_t *op, uint32_t rows) {
+    op->src_rows = op->src ? &format_rows[op->src->format] : NULL;
+    op->dst_rows = &format_rows[op->dst->format];
+
+    uint32_t count = (rows + CONVERT_BAND_ROWS - 1) / CONVERT_BAND_ROWS;
+    worker_job_t *jobs = calloc(count, sizeof(worker_job_t));
+    band_t *bands = calloc(count, sizeof(band_t));
+    bool result = jobs && bands;
+
+    if (result) {
+        for (uint32_t i = 0; i < count; i++) {
+            bands[i].op = op;
+            bands[i].y0 = i * CONVERT_BAND_ROWS;
+            bands[i].y1 = bands[i].y0 + CONVERT_BAND_ROWS < rows ? bands[i].y0 + CONVERT_BAND_ROWS : rows;
+            worker_job_init(&jobs[i], "convert band", band_job, &bands[i]);
+        }
+        result = worker_pool_run(jobs, count, worker_count());
+    } else {
+        fprintf(stderr, "Memory allocation failed\n");
+    }
+
+    free(jobs);
+    free(bands);
+    return result;
+}
+
+static bool valid_frame(const video_frame_t *frame) {
+    return frame && frame->planes[0] && video_format_is_raw(frame->format) && frame->width > 0 && frame->height > 0;
+}
+
+bool video_frame_fill_test_image(video_frame_t *frame) {
+    if (!valid_frame(frame)) {
+        return false;
+    }
+
+    convert_op_t op = { .kind = OP_FILL, .dst = frame, .kernels = select_kernels() };
+    return run_bands(&op, frame->height);
+}
+
+bool video_convert_frame(const video_frame_t *src, video_frame_t *dst) {
+    if (!valid_frame(src) || !valid_frame(dst) || src->width != dst->width || src->height != dst->height) {
+        return false;
+    }
+
+    convert_op_t op = { .kind = OP_CONVERT, .src = src, .dst = dst, .kernels = select_kernels() };
+    return run_bands(&op, dst->height);
+}
+
+// Centre-aligned source positions in 1/256 pixel
+static void bilinear_axis(uint32_t src, uint32_t dst, uint32_t *index, uint32_t *next, uint8_t *weight) {
+    for (uint32_t i = 0; i < dst; i++) {
+        int64_t pos = ((int64_t)(2 * i + 1) * src * 256) / (2 * (int64_t)dst) - 128;
+        if (pos < 0) {
+            pos = 0;
+        }
+
+        index[i] = (uint32_t)(pos >> 8);
+        weight[i] = (uint8_t)(pos & 0xFF);
+        if (index[i] >= src - 1) {
+            index[i] = src - 1;
+            weight[i] = 0;
+        }
+        if (next) {
+            next[i] = index[i] + 1 < src ? index[i] + 1 : index[i];
+        }
+    }
+}
+
+static bool area_axis(uint32_t src, uint32_t dst, area_axis_t *axis) {
+    double scale = (double)src / dst;
+    axis->taps = (uint32_t)ceil(scale) + 1;
+    axis->start = calloc(dst, sizeof(uint32_t));
+    axis->count = calloc(dst, sizeof(uint32_t));
+    axis->weights = calloc((size_t)dst * axis->taps, sizeof(float));
+    if (!axis->start || !axis->count || !axis->weights) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < dst; i++) {
+        double lo = i * scale;
+        double hi = (i + 1) * scale;
+        uint32_t first = (uint32_t)floor(lo);
+        uint32_t last = (uint32_t)ceil(hi);
+        if (last > src) {
+            last = src;
+        }
+        if (last - first > axis->taps) {
+            last = first + axis->taps;
+        }
+
+        axis->start[i] = first;
+        axis->count[i] = last - first;
+        for (uint32_t j = first; j < last; j++) {
+            double overlap = fmin(hi, j + 1.0) - fmax(lo, (double)j);
+            axis->weights[(size_t)i * axis->taps + (j - first)] = (float)(overlap / scale);
+        }
+    }
+    return true;
+}
+
+static void area_free(area_axis_t *axis) {
+    free(axis->start);
+    free(axis->count);
+    free(axis->weights);
+}
+
+bool video_scale_frame(const video_frame_t *src, video_frame_t *dst, video_scale_filter_t filter) {
+    if (!valid_frame(src) || !valid_frame(dst) || filter >= VIDEO_SCALE_MAX) {
+        return false;
+    }
+
+    convert_op_t op = {
+        .kind = OP_SCALE, .src = src, .dst = dst, .kernels = select_kernels(), .filter = filter
+    };
+    bool result;
+
+    if (filter == VIDEO_SCALE_AREA) {
+        result = area_axis(src->width, dst->width, &op.x_area) && area_axis(src->height, dst->height, &op.y_area);
+    } else {
+        op.x_index = malloc(dst->width * sizeof(uint32_t));
+        op.x_next = malloc(dst->width * sizeof(uint32_t));
+        op.x_weight = malloc(dst->width);
+        op.y_index = malloc(dst->height * sizeof(uint32_t));
+        op.y_weight = malloc(dst->height);
+        result = op.x_index && op.x_next && op.x_weight && op.y_index && op.y_weight;
+        if (result) {
+            bilinear_axis(src->width, dst->width, op.x_index, op.x_next, op.x_weight);
+            bilinear_axis(src->height, dst->height, op.y_index, NULL, op.y_weight);
+        }
+    }
+
+    if (result) {
+        result = run_bands(&op, dst->height);
+    } else {
+        fprintf(stderr, "Memory allocation failed\n");
+    }
+
+    free(op.x_index);
+    free(op.x_next);
+    free(op.x_weight);
+    free(op.y_index);
+    free(op.y_weight);
+    area_free(&op.x_area);
+    area_free(&op.y_area);
+    return result;
+}
+
+bool video_rotate_frame(const video_frame_t *src, video_frame_t *dst, uint32_t angle) {
+    if (!valid_frame(src) || !valid_frame(dst) || angle % 90 != 0 || angle >= 360) {
+        return false;
+    }
+
+    bool swapped = angle == 90 || angle == 270;
+    if (dst->width != (swapped ? src->height : src->width) || dst->height != (swapped ? src->width : src->height)) {
+        fprintf(stderr, "Rotating %ux%u by %u needs a %ux%u destination\n", src->width, src->height, angle,
+                swapped ? src->height : src->width, swapped ? src->width : src->height);
+        return false;
+    }
+
+    convert_op_t op = { .kind = OP_UNPACK, .src = src, .dst = dst, .kernels = select_kernels(), .angle = angle };
+    if (!pivot_alloc(&op.full, src->width, src->height)) {
+        return false;
+    }
+
+    bool result = run_bands(&op, src->height);
+    if (result) {
+        op.kind = OP_ROTATE;
+        result = run_bands(&op, dst->height);
+    }
+
+    pivot_free(&op.full);
+    return result;
+}
+
+double video_frame_psnr(const video_frame_t *a, const video_frame_t *b) {
+    if (!valid_frame(a) || !valid_frame(b) || a->format != b->format ||
+        a->width != b->width || a->height != b->height) {
+        return -1.0;
+    }
+
+    pivot_t pa, pb;
+    if (!pivot_alloc(&pa, a->width, 1)) {
+        return -1.0;
+    }
+    if (!pivot_alloc(&pb, b->width, 1)) {
+        pivot_free(&pa);
+        return -1.0;
+    }
+
+    const format_rows_t *rows = &format_rows[a->format];
+    uint64_t sum = 0;
+    for (uint32_t y = 0; y < a->height; y++) {
+        rows->unpack(a, y, &pa, 0);
+        rows->unpack(b, y, &pb, 0);
+        for (uint32_t plane = 0; plane < 3; plane++) {
+            for (uint32_t x = 0; x < a->width; x++) {
+                int diff = pa.plane[plane][x] - pb.plane[plane][x];
+                sum += (uint64_t)(diff * diff);
+            }
+        }
+    }
+
+    pivot_free(&pa);
+    pivot_free(&pb);
+
+    if (sum == 0) {
+        return INFINITY;
+    }
+    double mse = (double)sum / (3.0 * a->width * a->height);
+    return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+// Single-buffer converter session: one OUTPUT (source) and one CAPTURE
+// (result) buffer, one frame in flight
+typedef struct {
+    video_m2m_t m2m;
+    video_frame_t out_frame;       // Over the OUTPUT buffer, in the driver's stride
+    video_frame_t cap_frame;
+} m2m_session_t;
+
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Opens device_index as a converter from src to dst's format and size.
+// Any device that is not mem-to-mem, or cannot do exactly this, is left
+// to the reference alone.
+static bool m2m_open(uint32_t device_index, const video_frame_t *src, const video_frame_t *dst, uint32_t angle,
+                     uint32_t timeout_ms, m2m_session_t *session) {
+    memset(session, 0, sizeof(*session));
+    video_m2m_t *m2m = &session->m2m;
+    if (!video_m2m_open(device_index, timeout_ms, m2m)) {
+        return false;
+    }
+
+    if (angle && !video_m2m_set_control(m2m, V4L2_CID_ROTATE, (int32_t)angle)) {
+        printf("Converter cannot rotate by %u: %s\n", angle, strerror(errno));
+        video_m2m_close(m2m);
+        return false;
+    }
+
+    bool ok = video_m2m_set_format(m2m, &m2m->output, video_format_to_v4l2(src->format), src->width,
+                                   src->height, 0, true) &&
+              video_m2m_set_format(m2m, &m2m->capture, video_format_to_v4l2(dst->format), dst->width,
+                                   dst->height, 0, true) &&
+              video_m2m_alloc(m2m, &m2m->output, 1) &&
+              video_m2m_alloc(m2m, &m2m->capture, 1) &&
+              video_frame_wrap(&session->out_frame, src->format, src->width, src->height,
+                               m2m->output.buffers[0].map, m2m->output.bytesperline) &&
+              video_frame_wrap(&session->cap_frame, dst->format, dst->width, dst->height,
+                               m2m->capture.buffers[0].map, m2m->capture.bytesperline) &&
+              session->out_frame.size <= m2m->output.buffers[0].length &&
+              session->cap_frame.size <= m2m->capture.buffers[0].length &&
+              video_m2m_stream(m2m, &m2m->output, true) &&
+              video_m2m_stream(m2m, &m2m->capture, true);
+
+    if (!ok) {
+        video_m2m_close(m2m);
+    }
+    return ok;
+}
+
+static bool m2m_collect(m2m_session_t *session, video_m2m_queue_t *queue) {
+    video_m2m_done_t done;
+    for (;;) {
+        int ret = video_m2m_dequeue(&session->m2m, queue, &done);
+        if (ret != 0) {
+            return ret > 0;
+        }
+        if (video_m2m_wait(&session->m2m) <= 0) {
+            fprintf(stderr, "Converter timed out\n");
+            return false;
+        }
+    }
+}
+
+static bool m2m_process(m2m_session_t *session) {
+    video_m2m_t *m2m = &session->m2m;
+    return video_m2m_queue(m2m, &m2m->output, 0, m2m->output.sizeimage, 0) &&
+           video_m2m_queue(m2m, &m2m->capture, 0, 0, 0) &&
+           m2m_collect(session, &m2m->output) &&
+           m2m_collect(session, &m2m->capture);
+}
+
+typedef enum {
+    TASK_CONVERT,
+    TASK_SCALE,
+    TASK_ROTATE
+} convert_task_kind_t;
+
+typedef struct {
+    convert_task_kind_t kind;
+    video_scale_filter_t filter;
+    uint32_t angle;
+} convert_task_t;
+
+static bool run_task(const convert_task_t *task, const video_frame_t *src, video_frame_t *dst, bool inverse) {
+    switch (task->kind) {
+        case TASK_SCALE:
+            return video_scale_frame(src, dst, task->filter);
+        case TASK_ROTATE:
+            return video_rotate_frame(src, dst, inverse ? (360 - task->angle) % 360 : task->angle);
+        default:
+            return video_convert_frame(src, dst);
+    }
+}
+
+// Repeats the task for at least VIDEO_CONVERT_BENCH_MS and iterations runs, and
+// returns output megapixels per second
+static double bench_reference(const convert_task_t *task, const video_frame_t *src, video_frame_t *dst,
+                              uint32_t iterations, uint32_t *frames) {
+    uint64_t start = get_monotonic_ns();
+    uint64_t elapsed = 0;
+    *frames = 0;
+
+    do {
+        if (!run_task(task, src, dst, false)) {
+            return 0.0;
+        }
+        (*frames)++;
+        elapsed = get_monotonic_ns() - start;
+    } while (elapsed < VIDEO_CONVERT_BENCH_MS * 1000000ULL || *frames < iterations);
+
+    return (double)*frames * dst->width * dst->height * 1000.0 / elapsed;
+}
+
+static double bench_hardware(m2m_session_t *session, uint32_t iterations, uint32_t *frames) {
+    uint64_t start = get_monotonic_ns();
+    uint64_t elapsed = 0;
+    *frames = 0;
+
+    do {
+        if (!m2m_process(session)) {
+            return 0.0;
+        }
+        (*frames)++;
+        elapsed = get_monotonic_ns() - start;
+    } while (elapsed < VIDEO_CONVERT_BENCH_MS * 1000000ULL || *frames < iterations);
+
+    return (double)*frames * session->cap_frame.width * session->cap_frame.height * 1000.0 / elapsed;
+}
+
+static bool run_benchmark(uint32_t device_index, const video_test_config_t *config, const convert_task_t *task,
+                          video_format_t dst_format, uint32_t dst_width, uint32_t dst_height,
+                          video_convert_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->isa = video_convert_isa();
+    stats->threads = worker_count();
+
+    if (!video_format_is_raw(config->format) || !video_format_is_raw(dst_format)) {
+        fprintf(stderr, "Conversion needs raw formats, not %s to %s\n",
+                video_format_to_string(config->format), video_format_to_string(dst_format));
+        return false;
+    }
+
+    video_frame_t src, dst, back;
+    if (!video_frame_alloc(&src, config->format, config->width, config->height)) {
+        return false;
+    }
+    if (!video_frame_alloc(&dst, dst_format, dst_width, dst_height)) {
+        video_frame_free(&src);
+        return false;
+    }
+    if (!video_frame_alloc(&back, config->format, config->width, config->height)) {
+        video_frame_free(&src);
+        video_frame_free(&dst);
+        return false;
+    }
+
+    bool result = video_frame_fill_test_image(&src);
+    if (result) {
+        stats->cpu_mpix_per_sec = bench_reference(task, &src, &dst, config->iterations, &stats->cpu_frames) / 1e6;
+        result = stats->cpu_frames > 0 && stats->cpu_mpix_per_sec > 0.0;
+    }
+    if (result) {
+        // What the operation itself loses, taken back to where it started
+        result = run_task(task, &dst, &back, true);
+        stats->reference_psnr_db = result ? video_frame_psnr(&src, &back) : -1.0;
+    }
+
+    m2m_session_t session;
+    if (result && m2m_open(device_index, &src, &dst, task->kind == TASK_ROTATE ? task->angle : 0,
+                           config->timeout, &session)) {
+        video_frame_copy(&session.out_frame, &src);
+        stats->hw_mpix_per_sec = bench_hardware(&session, config->iterations, &stats->hw_frames) / 1e6;
+        stats->hardware = stats->hw_frames > 0 && stats->hw_mpix_per_sec > 0.0;
+        if (stats->hardware) {
+            stats->hw_psnr_db = video_frame_psnr(&session.cap_frame, &dst);
+            if (stats->hw_psnr_db < VIDEO_CONVERT_MIN_PSNR) {
+                fprintf(stderr, "Converter output is %.2f dB from the reference\n", stats->hw_psnr_db);
+                result = false;
+            }
+        } else {
+            result = false;
+        }
+        video_m2m_close(&session.m2m);
+    }
+
+    video_frame_free(&src);
+    video_frame_free(&dst);
+    video_frame_free(&back);
+    return result;
+}
+
+bool test_video_conversion(uint32_t device_index, const video_test_config_t *config, video_format_t target_format,
+                           video_convert_stats_t *stats) {
+    if (!config || !stats) {
+        return false;
+    }
+
+    convert_task_t task = { .kind = TASK_CONVERT };
+    return run_benchmark(device_index, config, &task, target_format, config->width, config->height, stats);
+}
+
+bool test_video_scaling(uint32_t device_index, const video_test_config_t *config, uint32_t target_width,
+                        uint32_t target_height, video_scale_filter_t filter, video_convert_stats_t *stats) {
+    if (!config || !stats || filter >= VIDEO_SCALE_MAX) {
+        return false;
+    }
+
+    convert_task_t task = { .kind = TASK_SCALE, .filter = filter };
+    return run_benchmark(device_index, config, &task, config->format, target_width, target_height, stats);
+}
+
+bool test_video_rotation(uint32_t device_index, const video_test_config_t *config, uint32_t rotation_angle,
+                         video_convert_stats_t *stats) {
+    if (!config || !stats || rotation_angle % 90 != 0 || rotation_angle >= 360) {
+        return false;
+    }
+
+    bool swapped = rotation_angle == 90 || rotation_angle == 270;
+    convert_task_t task = { .kind = TASK_ROTATE, .angle = rotation_angle };
+    return run_benchmark(device_index, config, &task, config->format,
+                         swapped ? config->height : config->width,
+                         swapped ? config->width : config->height, stats);
+}
+
+const char *video_scale_filter_to_string(video_scale_filter_t filter) {
+    switch (filter) {
+        case VIDEO_SCALE_BILINEAR: return "bilinear";
+        case VIDEO_SCALE_AREA: return "area";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,743 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "video/video_m2m.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+// Mem-to-mem devices take data on their OUTPUT queue and hand results
+// back on CAPTURE. Both queues are mmap'ed and single-plane; the callers
+// keep as many buffers in flight as the driver grants.
+
+static bool is_output(const video_m2m_queue_t *queue) {
+    return queue->type == V4L2_BUF_TYPE_VIDEO_OUTPUT || queue->type == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+}
+
+static const char *queue_name(const video_m2m_queue_t *queue) {
+    return is_output(queue) ? "OUTPUT" : "CAPTURE";
+}
+
+// Queue number in a trace
+static uint64_t queue_trace_id(const video_m2m_queue_t *queue) {
+    return is_output(queue) ? 0 : 1;
+}
+
+static uint64_t trace_start(const video_m2m_t *m2m) {
+    return m2m->trace_id ? trace_begin() : 0;
+}
+
+const char *video_m2m_fourcc_to_string(uint32_t fourcc, char buffer[5]) {
+    for (int i = 0; i < 4; i++) {
+        char c = (char)((fourcc >> (8 * i)) & 0xFF);
+        buffer[i] = c >= 0x20 && c < 0x7F ? c : '.';
+    }
+    buffer[4] = '\0';
+    return buffer;
+}
+
+bool video_m2m_open(uint32_t device_index, uint32_t timeout_ms, video_m2m_t *m2m) {
+    char device_name[32];
+    snprintf(device_name, sizeof(device_name), "/dev/video%u", device_index);
+
+    uint64_t start = trace_begin();
+    memset(m2m, 0, sizeof(*m2m));
+    m2m->device_index = device_index;
+    m2m->timeout_ms = timeout_ms ? timeout_ms : 5000;
+    m2m->fd = open(device_name, O_RDWR | O_NONBLOCK);
+    if (m2m->fd < 0) {
+        return false;
+    }
+
+    struct v4l2_capability cap;
+    if (ioctl(m2m->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        video_m2m_close(m2m);
+        return false;
+    }
+    uint32_t caps = cap.capabilities & V4L2_CAP_DEVICE_CAPS ? cap.device_caps : cap.capabilities;
+    if (!(caps & (V4L2_CAP_VIDEO_M2M | V4L2_CAP_VIDEO_M2M_MPLANE)) || !(caps & V4L2_CAP_STREAMING)) {
+        video_m2m_close(m2m);
+        return false;
+    }
+
+    m2m->mplane = !(caps & V4L2_CAP_VIDEO_M2M);
+    m2m->output.type = m2m->mplane ? V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE : V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    m2m->capture.type = m2m->mplane ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (start) {
+        m2m->trace_id = trace_next_id();
+        uint64_t args[] = { m2m->trace_id, device_index, timeout_ms };
+        trace_record(TRACE_OP_V4L2_OPEN, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+static void release_buffers(video_m2m_t *m2m, video_m2m_queue_t *queue) {
+    for (uint32_t i = 0; i < queue->count; i++) {
+        if (queue->buffers[i].map) {
+            munmap(queue->buffers[i].map, queue->buffers[i].length);
+        }
+    }
+    memset(queue->buffers, 0, sizeof(queue->buffers));
+    queue->count = 0;
+}
+
+void video_m2m_close(video_m2m_t *m2m) {
+    if (m2m->fd < 0) {
+        return;
+    }
+
+    uint64_t start = trace_start(m2m);
+    video_m2m_stream(m2m, &m2m->output, false);
+    video_m2m_stream(m2m, &m2m->capture, false);
+    release_buffers(m2m, &m2m->output);
+    release_buffers(m2m, &m2m->capture);
+    close(m2m->fd);
+    m2m->fd = -1;
+    if (start) {
+        uint64_t args[] = { m2m->trace_id };
+        trace_record(TRACE_OP_V4L2_CLOSE, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    m2m->trace_id = 0;
+}
+
+bool video_m2m_has_format(const video_m2m_t *m2m, const video_m2m_queue_t *queue, uint32_t fourcc) {
+    struct v4l2_fmtdesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.type = queue->type;
+
+    while (ioctl(m2m->fd, VIDIOC_ENUM_FMT, &desc) == 0) {
+        if (fourcc == 0 || desc.pixelformat == fourcc) {
+            return true;
+        }
+        desc.index++;
+    }
+    return false;
+}
+
+bool video_m2m_find(uint32_t device_index, uint32_t output_fourcc, uint32_t capture_fourcc,
+                    uint32_t timeout_ms, video_m2m_t *m2m) {
+    for (uint32_t i = 0; i <= VIDEO_M2M_MAX_DEVICES; i++) {
+        // The requested node first, then the rest in order
+        uint32_t index = i == 0 ? device_index : i - 1;
+        if (i > 0 && index == device_index) {
+            continue;
+        }
+        if (!video_m2m_open(index, timeout_ms, m2m)) {
+            continue;
+        }
+        if (video_m2m_has_format(m2m, &m2m->output, output_fourcc) &&
+            video_m2m_has_format(m2m, &m2m->capture, capture_fourcc)) {
+            return true;
+        }
+        video_m2m_close(m2m);
+    }
+    return false;
+}
+
+static void store_format(video_m2m_t *m2m, video_m2m_queue_t *queue, const struct v4l2_format *fmt) {
+    if (m2m->mplane) {
+        queue->fourcc = fmt->fmt.pix_mp.pixelformat;
+        queue->width = fmt->fmt.pix_mp.width;
+        queue->height = fmt->fmt.pix_mp.height;
+        queue->bytesperline = fmt->fmt.pix_mp.plane_fmt[0].bytesperline;
+        queue->sizeimage = fmt->fmt.pix_mp.plane_fmt[0].sizeimage;
+        queue->planes = fmt->fmt.pix_mp.num_planes ? fmt->fmt.pix_mp.num_planes : 1;
+    } else {
+        queue->fourcc = fmt->fmt.pix.pixelformat;
+        queue->width = fmt->fmt.pix.width;
+        queue->height = fmt->fmt.pix.height;
+        queue->bytesperline = fmt->fmt.pix.bytesperline;
+        queue->sizeimage = fmt->fmt.pix.sizeimage;
+        queue->planes = 1;
+    }
+}
+
+bool video_m2m_set_format(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t fourcc, uint32_t width,
+                          uint32_t height, uint32_t sizeimage, bool exact) {
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = queue->type;
+    if (m2m->mplane) {
+        fmt.fmt.pix_mp.width = width;
+        fmt.fmt.pix_mp.height = height;
+        fmt.fmt.pix_mp.pixelformat = fourcc;
+        fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+        fmt.fmt.pix_mp.num_planes = 1;
+        fmt.fmt.pix_mp.plane_fmt[0].sizeimage = sizeimage;
+    } else {
+        fmt.fmt.pix.width = width;
+        fmt.fmt.pix.height = height;
+        fmt.fmt.pix.pixelformat = fourcc;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        fmt.fmt.pix.sizeimage = sizeimage;
+    }
+
+    char name[5];
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_S_FMT, &fmt) < 0) {
+        fprintf(stderr, "VIDIOC_S_FMT %s %s failed: %s\n", queue_name(queue),
+                video_m2m_fourcc_to_string(fourcc, name), strerror(errno));
+        return false;
+    }
+    if (m2m->mplane && fmt.fmt.pix_mp.num_planes != 1) {
+        printf("%s %s needs %u planes\n", queue_name(queue), video_m2m_fourcc_to_string(fourcc, name),
+               fmt.fmt.pix_mp.num_planes);
+        return false;
+    }
+
+    store_format(m2m, queue, &fmt);
+    if (queue->fourcc != fourcc ||
+        (exact && width && height && (queue->width != width || queue->height != height))) {
+        char got[5];
+        printf("%s adjusted %ux%u %s to %ux%u %s\n", queue_name(queue), width, height,
+               video_m2m_fourcc_to_string(fourcc, name), queue->width, queue->height,
+               video_m2m_fourcc_to_string(queue->fourcc, got));
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue), fourcc, width, height, sizeimage, exact };
+        trace_record(TRACE_OP_V4L2_FORMAT, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_get_format(video_m2m_t *m2m, video_m2m_queue_t *queue) {
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = queue->type;
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_G_FMT, &fmt) < 0) {
+        fprintf(stderr, "VIDIOC_G_FMT %s failed: %s\n", queue_name(queue), strerror(errno));
+        return false;
+    }
+    store_format(m2m, queue, &fmt);
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue) };
+        trace_record(TRACE_OP_V4L2_GET_FORMAT, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_set_control(video_m2m_t *m2m, uint32_t id, int32_t value) {
+    struct v4l2_control control = { .id = id, .value = value };
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_S_CTRL, &control) < 0) {
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, id, (uint32_t)value };
+        trace_record(TRACE_OP_V4L2_CONTROL, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_get_control(video_m2m_t *m2m, uint32_t id, int32_t *value) {
+    struct v4l2_control control = { .id = id };
+    if (ioctl(m2m->fd, VIDIOC_G_CTRL, &control) < 0) {
+        return false;
+    }
+    *value = control.value;
+    return true;
+}
+
+bool video_m2m_set_framerate(video_m2m_t *m2m, uint32_t fps) {
+    struct v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = m2m->output.type;
+    parm.parm.output.timeperframe.numerator = 1;
+    parm.parm.output.timeperframe.denominator = fps;
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_S_PARM, &parm) < 0) {
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, fps };
+        trace_record(TRACE_OP_V4L2_FRAMERATE, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_subscribe(video_m2m_t *m2m, uint32_t event_type) {
+    struct v4l2_event_subscription sub;
+    memset(&sub, 0, sizeof(sub));
+    sub.type = event_type;
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_SUBSCRIBE_EVENT, &sub) < 0) {
+        fprintf(stderr, "VIDIOC_SUBSCRIBE_EVENT %u failed: %s\n", event_type, strerror(errno));
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, event_type };
+        trace_record(TRACE_OP_V4L2_SUBSCRIBE, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_next_event(video_m2m_t *m2m, uint32_t *event_type) {
+    struct v4l2_event event;
+    memset(&event, 0, sizeof(event));
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_DQEVENT, &event) < 0) {
+        return false;
+    }
+    *event_type = event.type;
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, event.type };
+        trace_record(TRACE_OP_V4L2_EVENT, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_stop(video_m2m_t *m2m, bool encoder) {
+    uint64_t start = trace_start(m2m);
+    int ret;
+    if (encoder) {
+        struct v4l2_encoder_cmd cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.cmd = V4L2_ENC_CMD_STOP;
+        ret = ioctl(m2m->fd, VIDIOC_ENCODER_CMD, &cmd);
+    } else {
+        struct v4l2_decoder_cmd cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.cmd = V4L2_DEC_CMD_STOP;
+        ret = ioctl(m2m->fd, VIDIOC_DECODER_CMD, &cmd);
+    }
+    if (ret < 0) {
+        return false;
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, encoder };
+        trace_record(TRACE_OP_V4L2_STOP, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+static void record_alloc(const video_m2m_t *m2m, const video_m2m_queue_t *queue, uint64_t start,
+                         uint32_t count) {
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue), count };
+        trace_record(TRACE_OP_V4L2_ALLOC, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+}
+
+bool video_m2m_alloc(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t count) {
+    uint64_t start = trace_start(m2m);
+    release_buffers(m2m, queue);
+    if (count > VIDEO_M2M_MAX_BUFFERS) {
+        count = VIDEO_M2M_MAX_BUFFERS;
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = count;
+    req.type = queue->type;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (ioctl(m2m->fd, VIDIOC_REQBUFS, &req) < 0) {
+        fprintf(stderr, "VIDIOC_REQBUFS %s failed: %s\n", queue_name(queue), strerror(errno));
+        return false;
+    }
+    if (count == 0) {
+        record_alloc(m2m, queue, start, 0);
+        return true;
+    }
+    if (req.count == 0) {
+        fprintf(stderr, "No %s buffers granted\n", queue_name(queue));
+        return false;
+    }
+    if (req.count > VIDEO_M2M_MAX_BUFFERS) {
+        req.count = VIDEO_M2M_MAX_BUFFERS;
+    }
+
+    for (uint32_t i = 0; i < req.count; i++) {
+        struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+        memset(&buf, 0, sizeof(buf));
+        memset(planes, 0, sizeof(planes));
+        buf.type = queue->type;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (m2m->mplane) {
+            buf.m.planes = planes;
+            buf.length = VIDEO_MAX_PLANES;
+        }
+        if (ioctl(m2m->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            fprintf(stderr, "VIDIOC_QUERYBUF %s %u failed: %s\n", queue_name(queue), i, strerror(errno));
+            release_buffers(m2m, queue);
+            return false;
+        }
+
+        video_m2m_buffer_t *buffer = &queue->buffers[i];
+        buffer->length = m2m->mplane ? planes[0].length : buf.length;
+        off_t offset = m2m->mplane ? planes[0].m.mem_offset : buf.m.offset;
+        buffer->map = mmap(NULL, buffer->length, PROT_READ | PROT_WRITE, MAP_SHARED, m2m->fd, offset);
+        queue->count = i + 1;
+        if (buffer->map == MAP_FAILED) {
+            fprintf(stderr, "Cannot map %s buffer %u: %s\n", queue_name(queue), i, strerror(errno));
+            buffer->map = NULL;
+            release_buffers(m2m, queue);
+            return false;
+        }
+    }
+    record_alloc(m2m, queue, start, count);
+    return true;
+}
+
+bool video_m2m_stream(video_m2m_t *m2m, video_m2m_queue_t *queue, bool on) {
+    if (queue->streaming == on) {
+        return true;
+    }
+
+    uint32_t type = queue->type;
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, on ? VIDIOC_STREAMON : VIDIOC_STREAMOFF, &type) < 0) {
+        fprintf(stderr, "%s %s failed: %s\n", on ? "VIDIOC_STREAMON" : "VIDIOC_STREAMOFF", queue_name(queue),
+                strerror(errno));
+        return false;
+    }
+    queue->streaming = on;
+    if (!on) {
+        // STREAMOFF hands every buffer back
+        for (uint32_t i = 0; i < queue->count; i++) {
+            queue->buffers[i].queued = false;
+        }
+    }
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue), on };
+        trace_record(TRACE_OP_V4L2_STREAM, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return true;
+}
+
+bool video_m2m_queue(video_m2m_t *m2m, video_m2m_queue_t *queue, uint32_t index, uint32_t bytesused,
+                     uint64_t timestamp_us) {
+    if (index >= queue->count || queue->buffers[index].queued) {
+        fprintf(stderr, "%s buffer %u is not free\n", queue_name(queue), index);
+        return false;
+    }
+
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    memset(&buf, 0, sizeof(buf));
+    memset(planes, 0, sizeof(planes));
+    buf.type = queue->type;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    buf.timestamp.tv_sec = (time_t)(timestamp_us / 1000000);
+    buf.timestamp.tv_usec = (suseconds_t)(timestamp_us % 1000000);
+    if (m2m->mplane) {
+        planes[0].bytesused = bytesused;
+        buf.m.planes = planes;
+        buf.length = queue->planes && queue->planes <= VIDEO_MAX_PLANES ? queue->planes : 1;
+    } else {
+        buf.bytesused = bytesused;
+    }
+
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_QBUF, &buf) < 0) {
+        fprintf(stderr, "VIDIOC_QBUF %s %u failed: %s\n", queue_name(queue), index, strerror(errno));
+        return false;
+    }
+    queue->buffers[index].queued = true;
+    if (start) {
+        // What the caller filled into an OUTPUT buffer is the workload
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue), index, bytesused, timestamp_us };
+        bool payload = is_output(queue) && bytesused <= queue->buffers[index].length;
+        trace_record_payload(TRACE_OP_V4L2_QBUF, start, args, TRACE_ARGC(args),
+                             payload ? queue->buffers[index].map : NULL, payload ? bytesused : 0);
+    }
+    return true;
+}
+
+int video_m2m_dequeue(video_m2m_t *m2m, video_m2m_queue_t *queue, video_m2m_done_t *done) {
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    memset(&buf, 0, sizeof(buf));
+    memset(planes, 0, sizeof(planes));
+    buf.type = queue->type;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (m2m->mplane) {
+        buf.m.planes = planes;
+        buf.length = VIDEO_MAX_PLANES;
+    }
+
+    uint64_t start = trace_start(m2m);
+    if (ioctl(m2m->fd, VIDIOC_DQBUF, &buf) < 0) {
+        if (errno == EAGAIN) {
+            return 0;
+        }
+        if (errno != EPIPE) {
+            fprintf(stderr, "VIDIOC_DQBUF %s failed: %s\n", queue_name(queue), strerror(errno));
+        }
+        return -1;
+    }
+    if (buf.index >= queue->count) {
+        fprintf(stderr, "VIDIOC_DQBUF %s returned unknown buffer %u\n", queue_name(queue), buf.index);
+        errno = EINVAL;
+        return -1;
+    }
+
+    queue->buffers[buf.index].queued = false;
+    done->index = buf.index;
+    done->bytesused = m2m->mplane ? planes[0].bytesused : buf.bytesused;
+    done->flags = buf.flags;
+    done->timestamp_us = (uint64_t)buf.timestamp.tv_sec * 1000000ULL + (uint64_t)buf.timestamp.tv_usec;
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, queue_trace_id(queue), done->index, done->bytesused, done->flags };
+        trace_record(TRACE_OP_V4L2_DQBUF, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return 1;
+}
+
+int video_m2m_free_buffer(const video_m2m_queue_t *queue) {
+    for (uint32_t i = 0; i < queue->count; i++) {
+        if (!queue->buffers[i].queued) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int video_m2m_wait(video_m2m_t *m2m) {
+    struct pollfd pfd = { .fd = m2m->fd, .events = POLLIN | POLLOUT | POLLPRI };
+    uint64_t start = trace_start(m2m);
+    int ready;
+    do {
+        ready = poll(&pfd, 1, (int)m2m->timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0) {
+        fprintf(stderr, "poll on /dev/video%u failed: %s\n", m2m->device_index, strerror(errno));
+        return -1;
+    }
+    int events = ready == 0 ? 0 : pfd.revents;
+    if (start) {
+        uint64_t args[] = { m2m->trace_id, (uint64_t)events };
+        trace_record(TRACE_OP_V4L2_WAIT, start, args, TRACE_ARGC(args), NULL, 0);
+    }
+    return events;
+}
+
+// Trace replay. Buffers come back from this device in its own order, so
+// a queue whose recorded buffer is still held takes any free one, waiting
+// for the device if it must; a dequeue done that way early is banked and
+// stands in for the next recorded one.
+typedef struct {
+    uint32_t trace_id;
+    video_m2m_t m2m;
+    uint32_t banked[2];            // Dequeues already done, per queue
+    uint64_t banked_ns[2];
+} replay_session_t;
+
+static replay_session_t *replay_sessions = NULL;
+static uint32_t replay_session_count = 0;
+static uint32_t replay_session_capacity = 0;
+
+static replay_session_t *find_replay_session(uint64_t trace_id) {
+    for (uint32_t i = 0; i < replay_session_count; i++) {
+        if (replay_sessions[i].trace_id == trace_id) {
+            return &replay_sessions[i];
+        }
+    }
+    return NULL;
+}
+
+static bool replay_open(const trace_record_t *record, uint64_t *duration_ns) {
+    if (record->argc < 3) {
+        return false;
+    }
+    if (replay_session_count == replay_session_capacity) {
+        uint32_t capacity = replay_session_capacity ? replay_session_capacity * 2 : 4;
+        replay_session_t *sessions = realloc(replay_sessions, capacity * sizeof(*sessions));
+        if (!sessions) {
+            return false;
+        }
+        replay_sessions = sessions;
+        replay_session_capacity = capacity;
+    }
+
+    replay_session_t *session = &replay_sessions[replay_session_count];
+    memset(session, 0, sizeof(*session));
+    uint64_t start = report_time_now_ns();
+    bool ok = video_m2m_open((uint32_t)record->args[1], (uint32_t)record->args[2], &session->m2m);
+    *duration_ns = report_time_now_ns() - start;
+    if (!ok) {
+        fprintf(stderr, "Cannot reopen /dev/video%u for replay\n", (uint32_t)record->args[1]);
+        return false;
+    }
+    session->trace_id = (uint32_t)record->args[0];
+    replay_session_count++;
+    return true;
+}
+
+static void replay_close(replay_session_t *session) {
+    video_m2m_close(&session->m2m);
+    *session = replay_sessions[--replay_session_count];
+}
+
+// Dequeues one buffer, waiting up to the session timeout for it
+static bool replay_dequeue(replay_session_t *session, video_m2m_queue_t *queue) {
+    video_m2m_done_t done;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int ret = video_m2m_dequeue(&session->m2m, queue, &done);
+        if (ret != 0) {
+            return ret > 0;
+        }
+        if (video_m2m_wait(&session->m2m) <= 0) {
+            break;
+        }
+    }
+    return false;
+}
+
+static bool replay_qbuf(replay_session_t *session, video_m2m_queue_t *queue, uint32_t q,
+                        const trace_record_t *record, uint64_t *duration_ns) {
+    if (record->argc < 5) {
+        return false;
+    }
+    int index = (int)record->args[2];
+    if (index >= (int)queue->count || queue->buffers[index].queued) {
+        index = video_m2m_free_buffer(queue);
+    }
+    if (index < 0) {
+        uint64_t start = report_time_now_ns();
+        if (!replay_dequeue(session, queue)) {
+            return false;
+        }
+        session->banked[q]++;
+        session->banked_ns[q] += report_time_now_ns() - start;
+        index = video_m2m_free_buffer(queue);
+    }
+
+    uint32_t bytesused = (uint32_t)record->args[3];
+    if (record->payload) {
+        if (record->payload_size > queue->buffers[index].length) {
+            return false;
+        }
+        memcpy(queue->buffers[index].map, record->payload, record->payload_size);
+    }
+
+    uint64_t start = report_time_now_ns();
+    bool ok = video_m2m_queue(&session->m2m, queue, (uint32_t)index, bytesused, record->args[4]);
+    *duration_ns = report_time_now_ns() - start;
+    return ok;
+}
+
+static bool replay_dqbuf(replay_session_t *session, video_m2m_queue_t *queue, uint32_t q,
+                         uint64_t *duration_ns) {
+    if (session->banked[q]) {
+        *duration_ns = session->banked_ns[q] / session->banked[q];
+        session->banked_ns[q] -= *duration_ns;
+        session->banked[q]--;
+        return true;
+    }
+    uint64_t start = report_time_now_ns();
+    bool ok = replay_dequeue(session, queue);
+    *duration_ns = report_time_now_ns() - start;
+    return ok;
+}
+
+bool video_m2m_trace_replay(void *context, const trace_record_t *record, uint64_t *duration_ns) {
+    (void)context;
+    if (record->op == TRACE_OP_V4L2_OPEN) {
+        return replay_open(record, duration_ns);
+    }
+
+    replay_session_t *session = record->argc ? find_replay_session(record->args[0]) : NULL;
+    if (!session) {
+        return false;
+    }
+    video_m2m_t *m2m = &session->m2m;
+    uint32_t q = record->argc > 1 && record->args[1] ? 1 : 0;
+    video_m2m_queue_t *queue = q ? &m2m->capture : &m2m->output;
+    const uint64_t *args = record->args;
+    uint32_t event_type;
+
+    uint64_t start = report_time_now_ns();
+    bool ok;
+    switch (record->op) {
+        case TRACE_OP_V4L2_CLOSE:
+            replay_close(session);
+            ok = true;
+            break;
+        case TRACE_OP_V4L2_FORMAT:
+            ok = record->argc >= 7 &&
+                 video_m2m_set_format(m2m, queue, (uint32_t)args[2], (uint32_t)args[3], (uint32_t)args[4],
+                                      (uint32_t)args[5], args[6] != 0);
+            break;
+        case TRACE_OP_V4L2_GET_FORMAT:
+            ok = video_m2m_get_format(m2m, queue);
+            break;
+        case TRACE_OP_V4L2_CONTROL:
+            ok = record->argc >= 3 && video_m2m_set_control(m2m, (uint32_t)args[1], (int32_t)(uint32_t)args[2]);
+            break;
+        case TRACE_OP_V4L2_FRAMERATE:
+            ok = record->argc >= 2 && video_m2m_set_framerate(m2m, (uint32_t)args[1]);
+            break;
+        case TRACE_OP_V4L2_SUBSCRIBE:
+            ok = record->argc >= 2 && video_m2m_subscribe(m2m, (uint32_t)args[1]);
+            break;
+        case TRACE_OP_V4L2_EVENT:
+            ok = video_m2m_next_event(m2m, &event_type) ||
+                 (video_m2m_wait(m2m) > 0 && video_m2m_next_event(m2m, &event_type));
+            break;
+        case TRACE_OP_V4L2_STOP:
+            ok = record->argc >= 2 && video_m2m_stop(m2m, args[1] != 0);
+            break;
+        case TRACE_OP_V4L2_ALLOC:
+            ok = record->argc >= 3 && video_m2m_alloc(m2m, queue, (uint32_t)args[2]);
+            session->banked[q] = 0;
+            session->banked_ns[q] = 0;
+            break;
+        case TRACE_OP_V4L2_STREAM:
+            ok = record->argc >= 3 && video_m2m_stream(m2m, queue, args[2] != 0);
+            if (!args[2]) {
+                session->banked[q] = 0;
+                session->banked_ns[q] = 0;
+            }
+            break;
+        case TRACE_OP_V4L2_QBUF:
+            return replay_qbuf(session, queue, q, record, duration_ns);
+        case TRACE_OP_V4L2_DQBUF:
+            return replay_dqbuf(session, queue, q, duration_ns);
+        case TRACE_OP_V4L2_WAIT:
+            // A banked buffer is what the recording waited for
+            ok = session->banked[0] || session->banked[1] || video_m2m_wait(m2m) >= 0;
+            break;
+        default:
+            return false;
+    }
+    *duration_ns = report_time_now_ns() - start;
+    return ok;
+}
+
+void video_m2m_trace_finish(void *context) {
+    (void)context;
+    while (replay_session_count) {
+        replay_close(&replay_sessions[0]);
+    }
+    free(replay_sessions);
+    replay_sessions = NULL;
+    replay_session_capacity = 0;
+}
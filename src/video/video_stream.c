@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "video/video_stream.h"
+#include "report/report_live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <math.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/videodev2.h>
+
+#define STREAM_TIMEOUT 5000 // 5 seconds
+
+typedef struct {
+    int fd;
+    uint32_t buffers;
+    uint64_t *intervals_ns;
+    uint32_t interval_count;
+    uint32_t interval_capacity;
+    uint64_t last_ns;
+    uint64_t first_ns;
+    uint32_t last_sequence;
+    video_stream_stats_t *stats;
+    report_live_id_t live_interval;
+    report_live_id_t live_frames;
+    report_live_id_t live_dropped;
+    report_live_rate_t live_fps;
+} stream_context_t;
+
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool queue_buffer(int fd, uint32_t index) {
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+
+    if (ioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+        fprintf(stderr, "VIDIOC_QBUF failed: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool record_interval(stream_context_t *ctx, uint64_t interval_ns) {
+    if (ctx->interval_count == ctx->interval_capacity) {
+        uint32_t capacity = ctx->interval_capacity ? ctx->interval_capacity * 2 : 1024;
+        uint64_t *intervals = realloc(ctx->intervals_ns, capacity * sizeof(uint64_t));
+        if (!intervals) {
+            return false;
+        }
+        ctx->intervals_ns = intervals;
+        ctx->interval_capacity = capacity;
+    }
+    ctx->intervals_ns[ctx->interval_count++] = interval_ns;
+    return true;
+}
+
+// Dequeue everything that is ready and hand each buffer straight back, so
+// the driver never runs dry because of us
+static bool drain_buffers(stream_context_t *ctx) {
+    video_stream_stats_t *stats = ctx->stats;
+
+    for (;;) {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+
+        if (ioctl(ctx->fd, VIDIOC_DQBUF, &buf) < 0) {
+            if (errno == EAGAIN) {
+                return true;
+            }
+            fprintf(stderr, "VIDIOC_DQBUF failed: %s\n", strerror(errno));
+            return false;
+        }
+
+        uint64_t ts_ns;
+        if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+            ts_ns = (uint64_t)buf.timestamp.tv_sec * 1000000000ULL + (uint64_t)buf.timestamp.tv_usec * 1000ULL;
+            stats->monotonic_timestamps = true;
+        } else {
+            ts_ns = get_monotonic_ns();
+            stats->monotonic_timestamps = false;
+        }
+
+        if (stats->frames == 0) {
+            ctx->first_ns = ts_ns;
+        } else {
+            if (buf.sequence - ctx->last_sequence > 1) {
+                stats->dropped_frames += buf.sequence - ctx->last_sequence - 1;
+                report_live_add(ctx->live_dropped, buf.sequence - ctx->last_sequence - 1);
+            }
+            uint64_t interval_ns = ts_ns > ctx->last_ns ? ts_ns - ctx->last_ns : 0;
+            if (!record_interval(ctx, interval_ns)) {
+                return false;
+            }
+            report_live_observe_ns(ctx->live_interval, interval_ns);
+        }
+        report_live_add(ctx->live_frames, 1);
+        report_live_rate_tick(&ctx->live_fps, ts_ns);
+        if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+            fprintf(stderr, "Frame %u flagged corrupt by the driver\n", buf.sequence);
+        }
+
+        stats->frames++;
+        ctx->last_sequence = buf.sequence;
+        ctx->last_ns = ts_ns;
+
+        if (!queue_buffer(ctx->fd, buf.index)) {
+            return false;
+        }
+    }
+}
+
+static int compare_u64_desc(const void *a, const void *b) {
+    uint64_t ua = *(const uint64_t *)a;
+    uint64_t ub = *(const uint64_t *)b;
+    return (ua < ub) - (ua > ub);
+}
+
+static void summarize(stream_context_t *ctx) {
+    video_stream_stats_t *stats = ctx->stats;
+    uint32_t count = ctx->interval_count;
+    if (count == 0) {
+        return;
+    }
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += (double)ctx->intervals_ns[i];
+    }
+    double mean = sum / count;
+    double variance = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        double d = (double)ctx->intervals_ns[i] - mean;
+        variance += d * d;
+    }
+
+    if (ctx->last_ns > ctx->first_ns) {
+        stats->avg_fps = (double)count * 1000000000.0 / (double)(ctx->last_ns - ctx->first_ns);
+    }
+    stats->jitter_ms = sqrt(variance / count) / 1000000.0;
+
+    // 1% low: the rate implied by the slowest 1% of frame intervals
+    qsort(ctx->intervals_ns, count, sizeof(uint64_t), compare_u64_desc);
+    stats->max_interval_ms = (double)ctx->intervals_ns[0] / 1000000.0;
+
+    uint32_t worst = count / 100 ? count / 100 : 1;
+    double worst_sum = 0.0;
+    for (uint32_t i = 0; i < worst; i++) {
+        worst_sum += (double)ctx->intervals_ns[i];
+    }
+    if (worst_sum > 0.0) {
+        stats->low_1pct_fps = (double)worst * 1000000000.0 / worst_sum;
+    }
+}
+
+static bool setup_stream(stream_context_t *ctx, const video_test_config_t *config) {
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = config->width;
+    fmt.fmt.pix.height = config->height;
+    fmt.fmt.pix.pixelformat = video_format_to_v4l2(config->format);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+    if (ioctl(ctx->fd, VIDIOC_S_FMT, &fmt) < 0) {
+        fprintf(stderr, "VIDIOC_S_FMT failed: %s\n", strerror(errno));
+        return false;
+    }
+    ctx->stats->adjusted = fmt.fmt.pix.width != config->width || fmt.fmt.pix.height != config->height ||
+                           fmt.fmt.pix.pixelformat != video_format_to_v4l2(config->format);
+
+    // Not every driver takes a frame interval; measure whatever it delivers
+    struct v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = config->framerate;
+    if (config->framerate && ioctl(ctx->fd, VIDIOC_S_PARM, &parm) < 0) {
+        fprintf(stderr, "VIDIOC_S_PARM failed, using driver frame rate: %s\n", strerror(errno));
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = VIDEO_STREAM_BUFFERS;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (ioctl(ctx->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        fprintf(stderr, "VIDIOC_REQBUFS failed: %s\n", strerror(errno));
+        return false;
+    }
+    ctx->buffers = req.count;
+    ctx->stats->buffers = req.count;
+
+    for (uint32_t i = 0; i < ctx->buffers; i++) {
+        if (!queue_buffer(ctx->fd, i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_video_stream(uint32_t device_index, const video_test_config_t *config, video_stream_stats_t *stats) {
+    if (!config || !stats) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(video_stream_stats_t));
+
+    char device_name[32];
+    snprintf(device_name, sizeof(device_name), "/dev/video%u", device_index);
+
+    stream_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.stats = stats;
+
+    char labels[48] = "";
+    report_live_label(labels, sizeof(labels), "device", device_name);
+    ctx.live_interval = report_live_register("tvts_video_frame_interval_seconds", labels, REPORT_LIVE_HISTOGRAM,
+                                             "Time between consecutive captured frames");
+    ctx.live_frames = report_live_register("tvts_video_frames_total", labels, REPORT_LIVE_COUNTER,
+                                           "Frames dequeued");
+    ctx.live_dropped = report_live_register("tvts_video_dropped_frames_total", labels, REPORT_LIVE_COUNTER,
+                                            "Sequence gaps reported by the driver");
+    report_live_rate_init(&ctx.live_fps, report_live_register("tvts_video_capture_fps", labels, REPORT_LIVE_GAUGE,
+                                                              "Captured frames per second over the last second"));
+
+    ctx.fd = open(device_name, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (ctx.fd < 0) {
+        fprintf(stderr, "Cannot open video device %s: %s\n", device_name, strerror(errno));
+        return false;
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    bool result = setup_stream(&ctx, config);
+    bool streaming = result && ioctl(ctx.fd, VIDIOC_STREAMON, &type) == 0;
+    if (result && !streaming) {
+        fprintf(stderr, "VIDIOC_STREAMON failed: %s\n", strerror(errno));
+        result = false;
+    }
+
+    uint32_t duration = config->duration ? config->duration : VIDEO_STREAM_DEFAULT_DURATION;
+    int timeout = config->timeout ? (int)config->timeout : STREAM_TIMEOUT;
+    uint64_t end_ns = get_monotonic_ns() + (uint64_t)duration * 1000000000ULL;
+    struct pollfd pfd = { .fd = ctx.fd, .events = POLLIN };
+
+    while (result && get_monotonic_ns() < end_ns) {
+        int ret = poll(&pfd, 1, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            fprintf(stderr, "No frame within %d ms\n", timeout);
+            result = false;
+            break;
+        }
+        if (pfd.revents & POLLERR) {
+            fprintf(stderr, "Capture device reported an error\n");
+            result = false;
+            break;
+        }
+        result = drain_buffers(&ctx);
+    }
+
+    if (streaming) {
+        ioctl(ctx.fd, VIDIOC_STREAMOFF, &type);
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ioctl(ctx.fd, VIDIOC_REQBUFS, &req);
+    close(ctx.fd);
+
+    summarize(&ctx);
+    free(ctx.intervals_ns);
+
+    return result && stats->frames > 1;
+}
+
+bool test_video_capture_performance(uint32_t device_index, const video_test_config_t *config, uint32_t *avg_fps) {
+    video_stream_stats_t stats;
+    if (!avg_fps) {
+        return false;
+    }
+
+    bool result = test_video_stream(device_index, config, &stats);
+    *avg_fps = (uint32_t)(stats.avg_fps + 0.5);
+    return result;
+}
+
+static const struct {
+    uint32_t width;
+    uint32_t height;
+} sweep_sizes[] = {
+    { 320, 240 }, { 640, 480 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 }
+};
+
+bool video_sweep_init(sweep_t *sweep, uint32_t device_index, const video_test_config_t *base) {
+    video_device_info_t info;
+    if (!sweep || !base || !get_video_device_info(device_index, &info)) {
+        return false;
+    }
+
+    sweep_init(sweep, "V4L2 Capture Rate", "FPS");
+    sweep_axis_t *formats = sweep_add_axis(sweep, "format");
+    sweep_axis_t *sizes = sweep_add_axis(sweep, "size");
+
+    for (uint32_t i = 0; i < info.format_count; i++) {
+        sweep_axis_add(formats, info.formats[i], video_format_to_string(info.formats[i]));
+    }
+
+    char label[SWEEP_LABEL_SIZE];
+    for (size_t i = 0; i < sizeof(sweep_sizes) / sizeof(sweep_sizes[0]); i++) {
+        uint32_t width = sweep_sizes[i].width;
+        uint32_t height = sweep_sizes[i].height;
+        if (width < info.min_width || width > info.max_width ||
+            height < info.min_height || height > info.max_height) {
+            continue;
+        }
+        snprintf(label, sizeof(label), "%ux%u", width, height);
+        sweep_axis_add(sizes, (uint64_t)width << 32 | height, label);
+    }
+    snprintf(label, sizeof(label), "%ux%u", base->width, base->height);
+    sweep_axis_add(sizes, (uint64_t)base->width << 32 | base->height, label);
+
+    return sweep_point_count(sweep) > 0;
+}
+
+// Each point reopens the stream: S_FMT with a new format or size needs the
+// queue torn down anyway
+bool video_sweep_stream_fps(void *context, const sweep_point_t *point, double *value) {
+    const video_sweep_context_t *sweep_context = context;
+    video_test_config_t config = sweep_context->config;
+    config.format = (video_format_t)point->values[0];
+    config.width = (uint32_t)(point->values[1] >> 32);
+    config.height = (uint32_t)point->values[1];
+    config.duration = VIDEO_SWEEP_DURATION;
+
+    video_stream_stats_t stats;
+    // A point the driver rewrote to another format or size is not that point
+    if (!test_video_stream(sweep_context->device_index, &config, &stats) || stats.adjusted || stats.frames < 2) {
+        return false;
+    }
+
+    *value = stats.avg_fps;
+    return true;
+}
@@ -0,0 +1,481 @@
+/*
+ * Copyright (C) 2025 Sumit Panwar <sumit.panwar@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "video/video_zero_copy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/videodev2.h>
+
+#ifdef _ENABLE_DRM
+#include "tizen_drm_test.h"
+#include "drm/drm_buffer_pool.h"
+#include "drm/drm_buffer_layout.h"
+#endif
+
+#define ZERO_COPY_BUFFERS 4
+#define ZERO_COPY_TIMEOUT 5000 // 5 seconds
+
+const char *video_zero_copy_mode_to_string(video_zero_copy_mode_t mode) {
+    switch (mode) {
+        case VIDEO_ZERO_COPY_DMABUF_IMPORT: return "DMABUF import";
+        case VIDEO_ZERO_COPY_EXPBUF: return "EXPBUF export";
+        default: return "Unknown";
+    }
+}
+
+#ifdef _ENABLE_DRM
+
+// One capture buffer and its display-side view
+typedef struct {
+    uint32_t index;           // V4L2 buffer index
+    int dmabuf_fd;            // Shared dma-buf
+    drm_buffer_t *drm;        // DRM view of the same memory
+    uint64_t capture_ns;      // Timestamp of the frame it holds
+} zero_copy_slot_t;
+
+typedef struct {
+    int video_fd;
+    video_zero_copy_mode_t mode;
+    zero_copy_slot_t slots[ZERO_COPY_BUFFERS];
+    uint32_t slot_count;
+    zero_copy_slot_t *on_screen;   // Being scanned out
+    zero_copy_slot_t *pending;     // Flip in flight
+    zero_copy_slot_t *ready;       // Newest frame waiting for the flip to land
+    double *latencies_ms;
+    uint32_t target_frames;
+    bool failed;
+    video_zero_copy_stats_t *stats;
+} zero_copy_context_t;
+
+static uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool video_to_drm_format(video_format_t format, drm_format_t *drm_format) {
+    switch (format) {
+        case VIDEO_FORMAT_NV12: *drm_format = DRM_FORMAT_NV12; return true;
+        case VIDEO_FORMAT_YUV420: *drm_format = DRM_FORMAT_YUV420; return true;
+        case VIDEO_FORMAT_YUV422: *drm_format = DRM_FORMAT_YUV422; return true;
+        case VIDEO_FORMAT_YUYV: *drm_format = DRM_FORMAT_YUYV; return true;
+        case VIDEO_FORMAT_UYVY: *drm_format = DRM_FORMAT_UYVY; return true;
+        case VIDEO_FORMAT_RGB565: *drm_format = DRM_FORMAT_RGB565; return true;
+        case VIDEO_FORMAT_RGBA8888: *drm_format = DRM_FORMAT_XRGB8888; return true;
+        default: return false;
+    }
+}
+
+static bool queue_slot(zero_copy_context_t *ctx, zero_copy_slot_t *slot) {
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.index = slot->index;
+    if (ctx->mode == VIDEO_ZERO_COPY_DMABUF_IMPORT) {
+        buf.memory = V4L2_MEMORY_DMABUF;
+        buf.m.fd = slot->dmabuf_fd;
+        buf.length = slot->drm->size;
+    } else {
+        buf.memory = V4L2_MEMORY_MMAP;
+    }
+
+    if (ioctl(ctx->video_fd, VIDIOC_QBUF, &buf) < 0) {
+        fprintf(stderr, "VIDIOC_QBUF failed: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool set_capture_format(int fd, uint32_t width, uint32_t height, uint32_t pixelformat,
+                               uint32_t bytesperline, struct v4l2_format *fmt) {
+    memset(fmt, 0, sizeof(*fmt));
+    fmt->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt->fmt.pix.width = width;
+    fmt->fmt.pix.height = height;
+    fmt->fmt.pix.pixelformat = pixelformat;
+    fmt->fmt.pix.bytesperline = bytesperline;
+    fmt->fmt.pix.field = V4L2_FIELD_NONE;
+
+    if (ioctl(fd, VIDIOC_S_FMT, fmt) < 0) {
+        fprintf(stderr, "VIDIOC_S_FMT failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (fmt->fmt.pix.pixelformat != pixelformat) {
+        fprintf(stderr, "Capture device does not support the requested format\n");
+        return false;
+    }
+    return true;
+}
+
+// DRM allocates, V4L2 captures into the imported dma-bufs
+static bool setup_dmabuf_import(zero_copy_context_t *ctx, const struct v4l2_format *probe, drm_format_t drm_format) {
+    test_config_t drm_config = {
+        .width = probe->fmt.pix.width,
+        .height = probe->fmt.pix.height,
+        .format = drm_format,
+        .modifier = DRM_MODIFIER_LINEAR,
+        .compression = DRM_COMPRESSION_NONE,
+        .iterations = 1
+    };
+
+    for (uint32_t i = 0; i < ZERO_COPY_BUFFERS; i++) {
+        zero_copy_slot_t *slot = &ctx->slots[i];
+        slot->index = i;
+        slot->drm = drm_buffer_pool_acquire(&drm_config);
+        if (!slot->drm || export_dma_buf(slot->drm, &slot->dmabuf_fd) < 0) {
+            fprintf(stderr, "Failed to export DRM buffer %u\n", i);
+            return false;
+        }
+        ctx->slot_count++;
+    }
+
+    // The capture engine has to write at the pitch the display allocated
+    struct v4l2_format fmt;
+    if (!set_capture_format(ctx->video_fd, drm_config.width, drm_config.height, probe->fmt.pix.pixelformat,
+                            ctx->slots[0].drm->pitch, &fmt)) {
+        return false;
+    }
+    if (fmt.fmt.pix.bytesperline != ctx->slots[0].drm->pitch || fmt.fmt.pix.sizeimage > ctx->slots[0].drm->size) {
+        fprintf(stderr, "Capture device cannot use the DRM layout (pitch %u, %u bytes)\n",
+                ctx->slots[0].drm->pitch, ctx->slots[0].drm->size);
+        return false;
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = ZERO_COPY_BUFFERS;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_DMABUF;
+    if (ioctl(ctx->video_fd, VIDIOC_REQBUFS, &req) < 0 || req.count < ZERO_COPY_BUFFERS) {
+        fprintf(stderr, "VIDIOC_REQBUFS (DMABUF) failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+// V4L2 allocates and exports, DRM imports the dma-bufs for scanout
+static bool setup_expbuf(zero_copy_context_t *ctx, const struct v4l2_format *fmt, drm_format_t drm_format) {
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = ZERO_COPY_BUFFERS;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (ioctl(ctx->video_fd, VIDIOC_REQBUFS, &req) < 0 || req.count < ZERO_COPY_BUFFERS) {
+        fprintf(stderr, "VIDIOC_REQBUFS (MMAP) failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    for (uint32_t i = 0; i < ZERO_COPY_BUFFERS; i++) {
+        zero_copy_slot_t *slot = &ctx->slots[i];
+        struct v4l2_exportbuffer expbuf;
+        memset(&expbuf, 0, sizeof(expbuf));
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        expbuf.flags = O_RDWR | O_CLOEXEC;
+        if (ioctl(ctx->video_fd, VIDIOC_EXPBUF, &expbuf) < 0) {
+            fprintf(stderr, "VIDIOC_EXPBUF failed: %s\n", strerror(errno));
+            return false;
+        }
+
+        slot->index = i;
+        slot->dmabuf_fd = expbuf.fd;
+        ctx->slot_count++;
+
+        slot->drm = import_dma_buf(expbuf.fd);
+        if (!slot->drm) {
+            fprintf(stderr, "DRM cannot import capture buffer %u\n", i);
+            return false;
+        }
+
+        // The imported object takes the capture device's layout
+        slot->drm->width = fmt->fmt.pix.width;
+        slot->drm->height = fmt->fmt.pix.height;
+        slot->drm->format = drm_format;
+        if (!drm_buffer_layout_init(&slot->drm->layout, drm_format, DRM_MODIFIER_LINEAR,
+                                    fmt->fmt.pix.width, fmt->fmt.pix.height, fmt->fmt.pix.bytesperline) ||
+            slot->drm->layout.size > slot->drm->size) {
+            fprintf(stderr, "Capture buffer %u does not match a DRM layout\n", i);
+            return false;
+        }
+        slot->drm->pitch = slot->drm->layout.pitches[0];
+    }
+
+    return true;
+}
+
+static void teardown(zero_copy_context_t *ctx) {
+    for (uint32_t i = 0; i < ctx->slot_count; i++) {
+        zero_copy_slot_t *slot = &ctx->slots[i];
+        if (slot->drm) {
+            // An EXPBUF slot is the capture driver's memory imported on the
+            // display fd; its handle pins that memory until closed
+            if (ctx->mode == VIDEO_ZERO_COPY_DMABUF_IMPORT) {
+                drm_buffer_pool_release(slot->drm);
+            } else {
+                destroy_foreign_import(slot->drm);
+            }
+        }
+        if (slot->dmabuf_fd >= 0) {
+            close(slot->dmabuf_fd);
+        }
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = ctx->mode == VIDEO_ZERO_COPY_DMABUF_IMPORT ? V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP;
+    ioctl(ctx->video_fd, VIDIOC_REQBUFS, &req);
+}
+
+static bool flip_to(zero_copy_context_t *ctx, zero_copy_slot_t *slot) {
+    if (!drm_scanout_queue(slot->drm, slot)) {
+        return false;
+    }
+    ctx->pending = slot;
+    return true;
+}
+
+static void on_flip(void *context, void *user_data, uint64_t flip_ns) {
+    zero_copy_context_t *ctx = (zero_copy_context_t *)context;
+    zero_copy_slot_t *slot = (zero_copy_slot_t *)user_data;
+    video_zero_copy_stats_t *stats = ctx->stats;
+
+    if (!slot || slot != ctx->pending) {
+        return;
+    }
+
+    if (stats->frames_displayed < ctx->target_frames) {
+        ctx->latencies_ms[stats->frames_displayed] = flip_ns > slot->capture_ns ?
+                                                     (double)(flip_ns - slot->capture_ns) / 1000000.0 : 0.0;
+    }
+    stats->frames_displayed++;
+    stats->copies_avoided++;
+    stats->bytes_not_copied += slot->drm->layout.size;
+
+    // The previous frame has left the screen and can be captured into again
+    if (ctx->on_screen && !queue_slot(ctx, ctx->on_screen)) {
+        ctx->failed = true;
+    }
+    ctx->on_screen = slot;
+    ctx->pending = NULL;
+
+    if (ctx->ready) {
+        zero_copy_slot_t *next = ctx->ready;
+        ctx->ready = NULL;
+        if (!flip_to(ctx, next)) {
+            ctx->failed = true;
+        }
+    }
+}
+
+static bool dequeue_frame(zero_copy_context_t *ctx) {
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = ctx->mode == VIDEO_ZERO_COPY_DMABUF_IMPORT ? V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP;
+
+    if (ioctl(ctx->video_fd, VIDIOC_DQBUF, &buf) < 0) {
+        if (errno == EAGAIN) {
+            return true;
+        }
+        fprintf(stderr, "VIDIOC_DQBUF failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (buf.index >= ctx->slot_count) {
+        return false;
+    }
+
+    zero_copy_slot_t *slot = &ctx->slots[buf.index];
+    ctx->stats->frames_captured++;
+
+    // Driver timestamps mark when the sensor delivered the frame; without a
+    // monotonic one the dequeue time is the best available bound
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        slot->capture_ns = (uint64_t)buf.timestamp.tv_sec * 1000000000ULL + (uint64_t)buf.timestamp.tv_usec * 1000ULL;
+    } else {
+        slot->capture_ns = get_monotonic_ns();
+    }
+
+    if (!ctx->on_screen) {
+        // First frame installs the plane state
+        if (!drm_scanout_start(slot->drm)) {
+            return false;
+        }
+        ctx->on_screen = slot;
+        return true;
+    }
+
+    if (ctx->pending) {
+        // Latest frame wins; an older waiting frame goes back unseen
+        if (ctx->ready) {
+            ctx->stats->frames_skipped++;
+            if (!queue_slot(ctx, ctx->ready)) {
+                return false;
+            }
+        }
+        ctx->ready = slot;
+        return true;
+    }
+
+    return flip_to(ctx, slot);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void summarize_latency(zero_copy_context_t *ctx) {
+    video_zero_copy_stats_t *stats = ctx->stats;
+    uint32_t count = stats->frames_displayed < ctx->target_frames ? stats->frames_displayed : ctx->target_frames;
+    if (count == 0) {
+        return;
+    }
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += ctx->latencies_ms[i];
+    }
+    qsort(ctx->latencies_ms, count, sizeof(double), compare_double);
+
+    stats->latency_avg_ms = sum / count;
+    stats->latency_p99_ms = ctx->latencies_ms[(uint32_t)(0.99 * (count - 1) + 0.5)];
+    stats->latency_max_ms = ctx->latencies_ms[count - 1];
+}
+
+bool test_video_zero_copy(uint32_t device_index, const video_test_config_t *config,
+                          video_zero_copy_mode_t mode, video_zero_copy_stats_t *stats) {
+    if (!config || !stats || mode >= VIDEO_ZERO_COPY_MAX || drm_scanout_get_fd() < 0) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(video_zero_copy_stats_t));
+
+    drm_format_t drm_format;
+    if (!video_to_drm_format(config->format, &drm_format)) {
+        fprintf(stderr, "No DRM scanout format for %s\n", video_format_to_string(config->format));
+        return false;
+    }
+
+    char device_name[32];
+    snprintf(device_name, sizeof(device_name), "/dev/video%u", device_index);
+
+    zero_copy_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.stats = stats;
+    ctx.target_frames = config->iterations ? config->iterations : 1;
+    for (uint32_t i = 0; i < ZERO_COPY_BUFFERS; i++) {
+        ctx.slots[i].dmabuf_fd = -1;
+    }
+
+    ctx.video_fd = open(device_name, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (ctx.video_fd < 0) {
+        fprintf(stderr, "Cannot open video device %s: %s\n", device_name, strerror(errno));
+        return false;
+    }
+
+    ctx.latencies_ms = calloc(ctx.target_frames, sizeof(double));
+    if (!ctx.latencies_ms) {
+        close(ctx.video_fd);
+        return false;
+    }
+
+    struct v4l2_format fmt;
+    bool result = set_capture_format(ctx.video_fd, config->width, config->height,
+                                     video_format_to_v4l2(config->format), 0, &fmt);
+    if (result) {
+        result = mode == VIDEO_ZERO_COPY_DMABUF_IMPORT ? setup_dmabuf_import(&ctx, &fmt, drm_format) :
+                                                         setup_expbuf(&ctx, &fmt, drm_format);
+    }
+
+    for (uint32_t i = 0; result && i < ctx.slot_count; i++) {
+        result = queue_slot(&ctx, &ctx.slots[i]);
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    bool streaming = result && ioctl(ctx.video_fd, VIDIOC_STREAMON, &type) == 0;
+    if (result && !streaming) {
+        fprintf(stderr, "VIDIOC_STREAMON failed: %s\n", strerror(errno));
+        result = false;
+    }
+
+    // Capture and flip completions are both event driven
+    int timeout = config->timeout ? (int)config->timeout : ZERO_COPY_TIMEOUT;
+    struct pollfd fds[2] = {
+        { .fd = ctx.video_fd, .events = POLLIN },
+        { .fd = drm_scanout_get_fd(), .events = POLLIN }
+    };
+    while (result && !ctx.failed && stats->frames_displayed < ctx.target_frames) {
+        int ret = poll(fds, 2, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            fprintf(stderr, "Timed out waiting for capture or flip\n");
+            result = false;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            result = drm_scanout_dispatch(on_flip, &ctx);
+        }
+        if (result && (fds[0].revents & POLLIN)) {
+            result = dequeue_frame(&ctx);
+        }
+        if (fds[0].revents & POLLERR) {
+            fprintf(stderr, "Capture device reported an error\n");
+            result = false;
+        }
+    }
+
+    drm_scanout_stop();
+    if (streaming) {
+        ioctl(ctx.video_fd, VIDIOC_STREAMOFF, &type);
+    }
+    teardown(&ctx);
+    close(ctx.video_fd);
+
+    summarize_latency(&ctx);
+    free(ctx.latencies_ms);
+
+    return result && !ctx.failed && stats->frames_displayed >= ctx.target_frames;
+}
+
+#else
+
+bool test_video_zero_copy(uint32_t device_index, const video_test_config_t *config,
+                          video_zero_copy_mode_t mode, video_zero_copy_stats_t *stats) {
+    (void)device_index;
+    (void)config;
+    (void)mode;
+    (void)stats;
+    fprintf(stderr, "Zero-copy capture requires the DRM subsystem\n");
+    return false;
+}
+
+#endif /* _ENABLE_DRM */
@@ -28,16 +28,19 @@ Development files for %{name}, including headers and libraries.
 
 %build
 make
+make bench
 
 %install
 mkdir -p %{buildroot}%{_bindir}
 install -m 755 test_suite %{buildroot}%{_bindir}/
+install -m 755 test_bench %{buildroot}%{_bindir}/
 
 mkdir -p %{buildroot}%{_includedir}/tizen_drm_test
 install -m 644 include/tizen_drm_test.h %{buildroot}%{_includedir}/tizen_drm_test/
 
 %files
 %{_bindir}/test_suite
+%{_bindir}/test_bench
 
 %files devel
 %{_includedir}/tizen_drm_test/tizen_drm_test.h